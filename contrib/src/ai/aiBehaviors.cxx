@@ -23,6 +23,9 @@
 #include "pursue.h"
 #include "seek.h"
 #include "wander.h"
+#include "aiWorld.h"
+
+#include <algorithm>
 
 using std::cout;
 using std::endl;
@@ -738,34 +741,60 @@ LVecBase3 AIBehaviors::do_flock() {
   LVecBase3 avg_center_of_mass = LVecBase3(0.0, 0.0, 0.0);
   LVecBase3 total_center_of_mass = LVecBase3(0.0, 0.0, 0.0);
 
-  // ! Loop through all the other AI units in the flock to check if they are
-  // neigbours.
-  for(unsigned int i = 0; i < _flock_group->_ai_char_list.size(); i++) {
-    if(_flock_group->_ai_char_list[i]->_name != _ai_char->_name) {
-
-      // ! Using visibilty cone to detect neighbors.
-      LVecBase3 dist_vect = _flock_group->_ai_char_list[i]->_ai_char_np.get_pos() - _ai_char->_ai_char_np.get_pos();
-      LVecBase3 ai_char_heading = _ai_char->get_velocity();
-      ai_char_heading.normalize();
-
-      // ! Check if the current unit is a neighbor.
-      if(dist_vect.dot(ai_char_heading) > ((dist_vect.length()) * (ai_char_heading.length()) * cos(_flock_group->_flock_vcone_angle * (_PI / 180)))
-        && (dist_vect.length() < _flock_group->_flock_vcone_radius)) {
-          // ! Separation force calculation.
-          LVecBase3 ai_char_to_units = _ai_char->_ai_char_np.get_pos() - _flock_group->_ai_char_list[i]->_ai_char_np.get_pos();
-          float to_units_dist = ai_char_to_units.length();
-          ai_char_to_units.normalize();
-          separation_force += (ai_char_to_units / to_units_dist);
-
-          // ! Calculating the total heading and center of mass of all the
-          // neighbors.
-          LVecBase3 neighbor_heading = _flock_group->_ai_char_list[i]->get_velocity();
-          neighbor_heading.normalize();
-          total_neighbor_heading += neighbor_heading;
-          total_center_of_mass += _flock_group->_ai_char_list[i]->_ai_char_np.get_pos();
-
-          // ! Update the neighbor count.
-          ++neighbor_count;
+  LVecBase3 ai_char_pos = _ai_char->_ai_char_np.get_pos();
+  LVecBase3 ai_char_heading = _ai_char->get_velocity();
+  ai_char_heading.normalize();
+  double cos_vcone_angle = cos(_flock_group->_flock_vcone_angle * (_PI / 180));
+
+  // ! Checks whether the other AI unit, at the indicated position and with
+  // the indicated velocity, is a neighbor, and if so, adds it to the totals.
+  auto consider_unit = [&](const LVecBase3 &unit_pos, const LVecBase3 &unit_velocity) {
+    // ! Using visibilty cone to detect neighbors.
+    LVecBase3 dist_vect = unit_pos - ai_char_pos;
+
+    // ! Check if the current unit is a neighbor.
+    if(dist_vect.dot(ai_char_heading) > ((dist_vect.length()) * (ai_char_heading.length()) * cos_vcone_angle)
+      && (dist_vect.length() < _flock_group->_flock_vcone_radius)) {
+        // ! Separation force calculation.
+        LVecBase3 ai_char_to_units = ai_char_pos - unit_pos;
+        float to_units_dist = ai_char_to_units.length();
+        ai_char_to_units.normalize();
+        separation_force += (ai_char_to_units / to_units_dist);
+
+        // ! Calculating the total heading and center of mass of all the
+        // neighbors.
+        LVecBase3 neighbor_heading = unit_velocity;
+        neighbor_heading.normalize();
+        total_neighbor_heading += neighbor_heading;
+        total_center_of_mass += unit_pos;
+
+        // ! Update the neighbor count.
+        ++neighbor_count;
+    }
+  };
+
+  AIWorld *world = _ai_char->_world;
+  if(world != nullptr && world->_neighbors_valid) {
+    // ! The world has sorted all the AI units into a grid at the start of
+    // the update, so only the ones within the visibility radius need to be
+    // checked.
+    pvector<int> nearby;
+    world->_char_grid.find_near(LPoint3(ai_char_pos), _flock_group->_flock_vcone_radius, nearby);
+    std::sort(nearby.begin(), nearby.end());
+    for(int n : nearby) {
+      AICharacter *unit = world->get_ai_char(n);
+      if(unit->_steering->_flock_group == _flock_group && unit->_name != _ai_char->_name) {
+        consider_unit(world->_char_grid.get_point(n), world->_char_velocities[n]);
+      }
+    }
+  }
+  else {
+    // ! Loop through all the other AI units in the flock to check if they
+    // are neigbours.
+    for(unsigned int i = 0; i < _flock_group->_ai_char_list.size(); i++) {
+      AICharacter *unit = _flock_group->_ai_char_list[i];
+      if(unit->_name != _ai_char->_name) {
+        consider_unit(unit->_ai_char_np.get_pos(), unit->get_velocity());
       }
     }
   }
@@ -887,6 +916,18 @@ void AIBehaviors::add_dynamic_obstacle(NodePath obstacle) {
   _path_find_obj->dynamic_avoid(obstacle);
 }
 
+/**
+ * This function returns the grid that the path finding searches, which is
+ * built from the navigation mesh passed to init_path_find(), or NULL if path
+ * finding hasn't been initialized.
+ */
+AINavGrid *AIBehaviors::get_nav_grid() const {
+  if(_path_find_obj == nullptr || _path_find_obj->_path_finder_obj == nullptr) {
+    return nullptr;
+  }
+  return _path_find_obj->_path_finder_obj->_nav_grid;
+}
+
 /**
  * This function returns the status of an AI Type whether it is active, paused
  * or disabled.  It returns -1 if an invalid string is passed.
@@ -27,6 +27,7 @@ class Wander;
 class PathFollow;
 class PathFind;
 class ObstacleAvoidance;
+class AINavGrid;
 
 #include "flee.h"
 #include "evade.h"
@@ -161,6 +162,7 @@ PUBLISHED:
   void path_find_to(NodePath target, std::string type = "normal");
   void add_static_obstacle(NodePath obstacle);
   void add_dynamic_obstacle(NodePath obstacle);
+  AINavGrid *get_nav_grid() const;
 
 
   void remove_ai(std::string ai_type);
@@ -12,6 +12,7 @@
  */
 
 #include "aiCharacter.h"
+#include "pathFollow.h"
 
 AICharacter::AICharacter(std::string model_name, NodePath model_np, double mass, double movt_force, double max_force) {
   _name = model_name;
@@ -44,23 +45,7 @@ AICharacter::~AICharacter() {
 void AICharacter::
 update() {
   if (!_steering->is_off(_steering->_none)) {
-    LVecBase3 old_pos = _ai_char_np.get_pos();
-    LVecBase3 steering_force = _steering->calculate_prioritized();
-    LVecBase3 acceleration = steering_force / _mass;
-
-    _velocity = acceleration;
-
-    LVecBase3 direction = _steering->_steering_force;
-    direction.normalize();
-
-    _ai_char_np.set_pos(old_pos + _velocity) ;
-
-    if (steering_force.length() > 0) {
-      _ai_char_np.look_at(old_pos + (direction * 5));
-      _ai_char_np.set_h(_ai_char_np.get_h() + 180);
-      _ai_char_np.set_p(-_ai_char_np.get_p());
-      _ai_char_np.set_r(-_ai_char_np.get_r());
-    }
+    apply_steering(_steering->calculate_prioritized());
   } else {
     _steering->_steering_force = LVecBase3(0.0, 0.0, 0.0);
     _steering->_seek_force = LVecBase3(0.0, 0.0, 0.0);
@@ -73,6 +58,46 @@ update() {
   }
 }
 
+/**
+ * This moves the character according to the steering force calculated by
+ * AIBehaviors::calculate_prioritized(), and makes it look in the direction
+ * of the force.
+ */
+void AICharacter::
+apply_steering(const LVecBase3 &steering_force) {
+  LVecBase3 old_pos = _ai_char_np.get_pos();
+  LVecBase3 acceleration = steering_force / _mass;
+
+  _velocity = acceleration;
+
+  LVecBase3 direction = _steering->_steering_force;
+  direction.normalize();
+
+  _ai_char_np.set_pos(old_pos + _velocity) ;
+
+  if (steering_force.length() > 0) {
+    _ai_char_np.look_at(old_pos + (direction * 5));
+    _ai_char_np.set_h(_ai_char_np.get_h() + 180);
+    _ai_char_np.set_p(-_ai_char_np.get_p());
+    _ai_char_np.set_r(-_ai_char_np.get_r());
+  }
+}
+
+/**
+ * Returns true if the character's steering force may be calculated at the
+ * same time as that of other characters.  This is not the case if it is
+ * following a path, since that may change the navigation mesh and the scene
+ * graph, or if it has no behaviors on, since then update() resets it.
+ */
+bool AICharacter::
+is_independent() const {
+  if (_steering->is_off(_steering->_none)) {
+    return false;
+  }
+  PathFollow *path_follow = _steering->_path_follow_obj;
+  return path_follow == nullptr || !path_follow->_start;
+}
+
 LVecBase3 AICharacter::get_velocity() {
   return _velocity;
 }
@@ -42,6 +42,8 @@ class EXPCL_PANDAAI AICharacter : public ReferenceCount {
   bool _pf_guide;
 
   void update();
+  void apply_steering(const LVecBase3 &steering_force);
+  bool is_independent() const;
   void set_velocity(LVecBase3 vel);
   void set_char_render(NodePath render);
   NodePath get_char_render();
@@ -0,0 +1,412 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file aiNavGrid.cxx
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#include "aiNavGrid.h"
+#include "config_ai.h"
+#include "lightMutexHolder.h"
+
+/**
+ * Creates a copy of the indicated navigation mesh, as read by PathFind, in
+ * which the node at nav_mesh[y][x] becomes cell (x, y).
+ */
+AINavGrid::AINavGrid(const NavMesh &nav_mesh) :
+  _size_x(0),
+  _size_y((int)nav_mesh.size()),
+  _origin(0.0f, 0.0f, 0.0f),
+  _cell_size(0.0f, 0.0f),
+  _regular(true),
+  _cache_version(0)
+{
+  for (const NodeArray &row : nav_mesh) {
+    _size_x = std::max(_size_x, (int)row.size());
+  }
+
+  size_t num_cells = (size_t)_size_x * _size_y;
+  _snapshot = new Snapshot;
+  _snapshot->_version = 0;
+  _snapshot->_flags.assign(num_cells, 0);
+  _positions.assign(num_cells, LVecBase3(0.0f, 0.0f, 0.0f));
+  _dimensions.assign(num_cells, LVecBase2(0.0f, 0.0f));
+  _neighbors.assign(num_cells * num_neighbors, -1);
+
+  bool have_origin = false;
+  for (int y = 0; y < _size_y; ++y) {
+    const NodeArray &row = nav_mesh[y];
+    for (int x = 0; x < (int)row.size(); ++x) {
+      Node *node = row[x];
+      if (node == nullptr) {
+        continue;
+      }
+      int cell = y * _size_x + x;
+      _snapshot->_flags[cell] = F_present | (node->_type ? F_walkable : 0);
+      _positions[cell] = node->_position;
+      _dimensions[cell].set(node->_width, node->_length);
+
+      if (!have_origin) {
+        // Assume the nodes are laid out evenly, like the first one.
+        _cell_size.set(node->_width, node->_length);
+        _origin = node->_position - LVecBase3(x * node->_width, y * node->_length, 0.0f);
+        have_origin = true;
+      }
+      LVecBase3 expected = _origin + LVecBase3(x * _cell_size[0], y * _cell_size[1], 0.0f);
+      if (!IS_THRESHOLD_EQUAL(expected[0], node->_position[0], 0.001f) ||
+          !IS_THRESHOLD_EQUAL(expected[1], node->_position[1], 0.001f)) {
+        _regular = false;
+      }
+
+      for (int i = 0; i < num_neighbors; ++i) {
+        Node *neighbor = node->_neighbours[i];
+        if (neighbor != nullptr &&
+            neighbor->_grid_x >= 0 && neighbor->_grid_x < _size_x &&
+            neighbor->_grid_y >= 0 && neighbor->_grid_y < _size_y) {
+          _neighbors[cell * num_neighbors + i] = neighbor->_grid_y * _size_x + neighbor->_grid_x;
+        }
+      }
+    }
+  }
+
+  if (_cell_size[0] <= 0.0f || _cell_size[1] <= 0.0f) {
+    _regular = false;
+  }
+}
+
+/**
+ * Creates a regular grid of size_x by size_y walkable cells, each cell_size
+ * units across, with the corner of cell (0, 0) at the origin.  Each cell is
+ * connected to its eight neighbors.
+ */
+AINavGrid::AINavGrid(int size_x, int size_y, PN_stdfloat cell_size) :
+  _size_x(std::max(size_x, 0)),
+  _size_y(std::max(size_y, 0)),
+  _origin(cell_size * 0.5f, cell_size * 0.5f, 0.0f),
+  _cell_size(cell_size, cell_size),
+  _regular(cell_size > 0.0f),
+  _cache_version(0)
+{
+  size_t num_cells = (size_t)_size_x * _size_y;
+  _snapshot = new Snapshot;
+  _snapshot->_version = 0;
+  _snapshot->_flags.assign(num_cells, F_present | F_walkable);
+  _positions.resize(num_cells);
+  _dimensions.assign(num_cells, LVecBase2(cell_size, cell_size));
+  _neighbors.assign(num_cells * num_neighbors, -1);
+
+  // Anti-clockwise from the top left corner, as in Node::_neighbours.
+  static const int offsets[num_neighbors][2] = {
+    {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1},
+  };
+
+  for (int y = 0; y < _size_y; ++y) {
+    for (int x = 0; x < _size_x; ++x) {
+      int cell = y * _size_x + x;
+      _positions[cell] = _origin + LVecBase3(x * cell_size, y * cell_size, 0.0f);
+      for (int i = 0; i < num_neighbors; ++i) {
+        int nx = x + offsets[i][0];
+        int ny = y + offsets[i][1];
+        if (nx >= 0 && nx < _size_x && ny >= 0 && ny < _size_y) {
+          _neighbors[cell * num_neighbors + i] = ny * _size_x + nx;
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Returns the number of cells along the X axis.
+ */
+int AINavGrid::get_size_x() const {
+  return _size_x;
+}
+
+/**
+ * Returns the number of cells along the Y axis.
+ */
+int AINavGrid::get_size_y() const {
+  return _size_y;
+}
+
+/**
+ * Returns the total number of cells, including the ones that are not part of
+ * the mesh.
+ */
+int AINavGrid::get_num_cells() const {
+  return _size_x * _size_y;
+}
+
+/**
+ * Returns the index of cell (x, y), or -1 if it is outside the grid.
+ */
+int AINavGrid::get_cell(int x, int y) const {
+  if (x < 0 || x >= _size_x || y < 0 || y >= _size_y) {
+    return -1;
+  }
+  return y * _size_x + x;
+}
+
+/**
+ * Returns the X coordinate of the indicated cell in the grid.
+ */
+int AINavGrid::get_cell_x(int cell) const {
+  nassertr(cell >= 0 && cell < get_num_cells(), -1);
+  return cell % _size_x;
+}
+
+/**
+ * Returns the Y coordinate of the indicated cell in the grid.
+ */
+int AINavGrid::get_cell_y(int cell) const {
+  nassertr(cell >= 0 && cell < get_num_cells(), -1);
+  return cell / _size_x;
+}
+
+/**
+ * Returns the position of the center of the indicated cell.
+ */
+LPoint3 AINavGrid::get_cell_position(int cell) const {
+  nassertr(cell >= 0 && cell < get_num_cells(), LPoint3::zero());
+  return LPoint3(_positions[cell]);
+}
+
+/**
+ * Returns true if the indicated cell is part of the mesh.
+ */
+bool AINavGrid::has_cell(int cell) const {
+  if (cell < 0 || cell >= get_num_cells()) {
+    return false;
+  }
+  return (_snapshot->_flags[cell] & F_present) != 0;
+}
+
+/**
+ * Marks the indicated cell as walkable or not, e.g.  because an obstacle has
+ * moved onto it.  This forgets all the paths that were found so far.
+ */
+void AINavGrid::set_walkable(int cell, bool walkable) {
+  nassertv(cell >= 0 && cell < get_num_cells());
+  Change change;
+  change._cell = cell;
+  change._walkable = walkable;
+  apply_delta(Delta(1, change));
+}
+
+/**
+ * Returns true if the indicated cell is part of the mesh and may be walked
+ * on.
+ */
+bool AINavGrid::is_walkable(int cell) const {
+  if (cell < 0 || cell >= get_num_cells()) {
+    return false;
+  }
+  const unsigned char passable = F_present | F_walkable;
+  return (_snapshot->_flags[cell] & passable) == passable;
+}
+
+/**
+ * Returns a number that is incremented every time a cell changes between
+ * walkable and not.
+ */
+unsigned int AINavGrid::get_version() const {
+  return _snapshot->_version;
+}
+
+/**
+ * Returns the index of the cell that contains the indicated point, looking
+ * only at its X and Y coordinates, or -1 if there is none.  If the point is
+ * on the border of several cells, the one with the lowest index is returned.
+ */
+int AINavGrid::find_cell(const LPoint3 &pos) const {
+  const unsigned char *flags = _snapshot->_flags.data();
+  PN_stdfloat x = pos[0];
+  PN_stdfloat y = pos[1];
+
+  if (_cell_size[0] > 0.0f && _cell_size[1] > 0.0f) {
+    // Work out which cell it ought to be in, and check that one and the ones
+    // around it.
+    int gx = (int)std::floor((x - _origin[0]) / _cell_size[0] + 0.5f);
+    int gy = (int)std::floor((y - _origin[1]) / _cell_size[1] + 0.5f);
+    for (int cy = gy - 1; cy <= gy + 1; ++cy) {
+      for (int cx = gx - 1; cx <= gx + 1; ++cx) {
+        int cell = get_cell(cx, cy);
+        if (cell != -1 && (flags[cell] & F_present) != 0 &&
+            cell_contains(cell, x, y)) {
+          return cell;
+        }
+      }
+    }
+    if (_regular) {
+      return -1;
+    }
+  }
+
+  // The cells are not laid out evenly, so we have to look at all of them.
+  int num_cells = get_num_cells();
+  for (int cell = 0; cell < num_cells; ++cell) {
+    if ((flags[cell] & F_present) != 0 && cell_contains(cell, x, y)) {
+      return cell;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Returns the shortest path from the src cell to the dst cell, as a list of
+ * cell indices, including both.  Returns an empty list if there is no path.
+ */
+PTA_int AINavGrid::find_path(int src, int dst) {
+  nassertr(src >= 0 && src < get_num_cells(), PTA_int());
+  nassertr(dst >= 0 && dst < get_num_cells(), PTA_int());
+
+  Path path;
+  {
+    LightMutexHolder holder(_search_lock);
+    find_path(_search, src, dst, path);
+  }
+
+  PTA_int result;
+  result.v().assign(path.begin(), path.end());
+  return result;
+}
+
+/**
+ * Returns the number of paths currently remembered by the grid.
+ */
+size_t AINavGrid::get_num_cached_paths() const {
+  LightMutexHolder holder(_cache_lock);
+  if (_cache_version != get_version()) {
+    return 0;
+  }
+  return _path_cache.get_num_entries();
+}
+
+/**
+ * Forgets all of the paths found so far.
+ */
+void AINavGrid::clear_path_cache() {
+  LightMutexHolder holder(_cache_lock);
+  _path_cache.clear();
+}
+
+/**
+ * Changes several cells between walkable and not at once, e.g.  to move an
+ * obstacle from one place to another.  The version is incremented only once
+ * for the whole delta, and not at all if it doesn't change anything, so the
+ * paths found so far are not forgotten needlessly.
+ *
+ * Searches that are already running on other threads are not affected; they
+ * continue to see the cells as they were when they started.
+ */
+void AINavGrid::apply_delta(const Delta &delta) {
+  // Find the first change that actually changes something.
+  int num_cells = get_num_cells();
+  Delta::const_iterator first = delta.end();
+  for (Delta::const_iterator di = delta.begin(); di != delta.end(); ++di) {
+    nassertv(di->_cell >= 0 && di->_cell < num_cells);
+    if (first == delta.end() &&
+        ((_snapshot->_flags[di->_cell] & F_walkable) != 0) != di->_walkable) {
+      first = di;
+    }
+  }
+  if (first == delta.end()) {
+    return;
+  }
+
+  LightMutexHolder holder(_snapshot_lock);
+  if (_snapshot->get_ref_count() > 1) {
+    // Someone is still searching the old cells, so leave those alone.
+    _snapshot = new Snapshot(*_snapshot);
+  }
+
+  pvector<unsigned char> &flags = _snapshot->_flags;
+  for (Delta::const_iterator di = first; di != delta.end(); ++di) {
+    if (di->_walkable) {
+      flags[di->_cell] |= F_walkable;
+    } else {
+      flags[di->_cell] &= ~F_walkable;
+    }
+  }
+  ++_snapshot->_version;
+}
+
+/**
+ * Returns the walkable cells as they are now.  The snapshot doesn't change
+ * when the grid does, so a search on another thread may use it without
+ * holding any lock.
+ */
+CPT(AINavGrid::Snapshot) AINavGrid::get_snapshot() const {
+  LightMutexHolder holder(_snapshot_lock);
+  return _snapshot.p();
+}
+
+/**
+ * Finds the shortest path from the src cell to the dst cell, using the
+ * indicated search state, or returns the path found earlier if the same path
+ * was asked for before, and no cells have changed since.  See
+ * AIPathSearch::find_path().
+ *
+ * Different threads may call this at the same time, as long as each one
+ * uses its own AIPathSearch, and the cells are not being changed.
+ */
+bool AINavGrid::find_path(AIPathSearch &search, int src, int dst, Path &path) const {
+  return find_path(search, _snapshot, src, dst, path);
+}
+
+/**
+ * Finds the shortest path from the src cell to the dst cell as above, but
+ * through the cells as they were in the indicated snapshot.  This may be
+ * called from any thread, while the cells are being changed.  Only the paths
+ * for the latest version are remembered.
+ */
+bool AINavGrid::find_path(AIPathSearch &search, const Snapshot *snapshot,
+                          int src, int dst, Path &path) const {
+  uint64_t key = ((uint64_t)(uint32_t)src << 32) | (uint32_t)dst;
+  unsigned int version = snapshot->_version;
+  {
+    LightMutexHolder holder(_cache_lock);
+    if ((int)(version - _cache_version) > 0) {
+      _path_cache.clear();
+      _cache_version = version;
+    }
+    if (_cache_version == version) {
+      int slot = _path_cache.find(key);
+      if (slot != -1) {
+        path = _path_cache.get_data(slot);
+        return !path.empty();
+      }
+    }
+  }
+
+  bool found = search.find_path(this, snapshot->_flags.data(), src, dst, path);
+
+  int capacity = ai_path_cache_size;
+  if (capacity > 0) {
+    LightMutexHolder holder(_cache_lock);
+    if (_cache_version == version) {
+      if (_path_cache.get_num_entries() >= (size_t)capacity) {
+        _path_cache.clear();
+      }
+      _path_cache.store(key, path);
+    }
+  }
+  return found;
+}
+
+/**
+ * Returns true if the point is within the indicated cell, like
+ * Node::contains().
+ */
+bool AINavGrid::cell_contains(int cell, PN_stdfloat x, PN_stdfloat y) const {
+  const LVecBase3 &pos = _positions[cell];
+  const LVecBase2 &dim = _dimensions[cell];
+  return pos[0] - dim[0] / 2 <= x && pos[0] + dim[0] / 2 >= x &&
+         pos[1] - dim[1] / 2 <= y && pos[1] + dim[1] / 2 >= y;
+}
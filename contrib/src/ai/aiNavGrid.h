@@ -0,0 +1,134 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file aiNavGrid.h
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#ifndef _AINAVGRID_H
+#define _AINAVGRID_H
+
+#include "aiGlobals.h"
+#include "meshNode.h"
+#include "aiPathSearch.h"
+#include "referenceCount.h"
+#include "pta_int.h"
+#include "pointerTo.h"
+#include "simpleHashMap.h"
+#include "lightMutex.h"
+#include "pvector.h"
+
+/**
+ * A navigation mesh stored as flat arrays, indexed by cell, for fast
+ * pathfinding.  Cell (x, y) has the index y * size_x + x.  This is built from
+ * the NavMesh read by PathFind, or may be created directly as a regular grid
+ * in which each cell is connected to its eight neighbors.
+ *
+ * The grid also remembers the paths it has found, so that asking again for a
+ * path between the same two cells costs nothing, until the walkable cells
+ * change.
+ *
+ * The walkable cells are kept in a Snapshot, which is copied on write: a
+ * search that is running on another thread keeps the Snapshot it started
+ * with, and doesn't see the cells change underneath it.  Only one thread may
+ * change the cells, however.
+ */
+class EXPCL_PANDAAI AINavGrid : public ReferenceCount {
+public:
+  typedef AIPathSearch::Path Path;
+
+  // The flags of every cell, as they were at one version of the grid.
+  class EXPCL_PANDAAI Snapshot : public ReferenceCount {
+  public:
+    pvector<unsigned char> _flags;
+    unsigned int _version;
+  };
+
+  // A change to one cell, see apply_delta().
+  class Change {
+  public:
+    int _cell;
+    bool _walkable;
+  };
+  typedef pvector<Change> Delta;
+
+  explicit AINavGrid(const NavMesh &nav_mesh);
+
+PUBLISHED:
+  explicit AINavGrid(int size_x, int size_y, PN_stdfloat cell_size = 1.0f);
+
+  int get_size_x() const;
+  int get_size_y() const;
+  int get_num_cells() const;
+
+  int get_cell(int x, int y) const;
+  int get_cell_x(int cell) const;
+  int get_cell_y(int cell) const;
+  LPoint3 get_cell_position(int cell) const;
+  bool has_cell(int cell) const;
+
+  void set_walkable(int cell, bool walkable);
+  bool is_walkable(int cell) const;
+  unsigned int get_version() const;
+
+  int find_cell(const LPoint3 &pos) const;
+
+  PTA_int find_path(int src, int dst);
+  size_t get_num_cached_paths() const;
+  void clear_path_cache();
+
+public:
+  void apply_delta(const Delta &delta);
+  CPT(Snapshot) get_snapshot() const;
+
+  bool find_path(AIPathSearch &search, int src, int dst, Path &path) const;
+  bool find_path(AIPathSearch &search, const Snapshot *snapshot,
+                 int src, int dst, Path &path) const;
+
+private:
+  bool cell_contains(int cell, PN_stdfloat x, PN_stdfloat y) const;
+
+  enum CellFlags {
+    F_present  = 0x01,
+    F_walkable = 0x02,
+  };
+
+  int _size_x;
+  int _size_y;
+
+  // One entry per cell.  The snapshot is replaced, rather than modified, if
+  // anyone else is holding on to it.
+  mutable LightMutex _snapshot_lock;
+  PT(Snapshot) _snapshot;
+  pvector<LVecBase3> _positions;
+  pvector<LVecBase2> _dimensions;
+
+  // num_neighbors entries per cell, with -1 for no neighbor, in the same
+  // order as Node::_neighbours.
+  static const int num_neighbors = 8;
+  pvector<int> _neighbors;
+
+  // Used to guess which cell contains a point, before checking it.
+  LVecBase3 _origin;
+  LVecBase2 _cell_size;
+  bool _regular;
+
+  typedef SimpleHashMap<uint64_t, Path, integer_hash<uint64_t> > PathCache;
+  mutable LightMutex _cache_lock;
+  mutable PathCache _path_cache;
+  mutable unsigned int _cache_version;
+
+  // Used by the published find_path().
+  LightMutex _search_lock;
+  AIPathSearch _search;
+
+  friend class AIPathSearch;
+};
+
+#endif
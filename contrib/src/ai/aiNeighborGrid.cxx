@@ -0,0 +1,249 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file aiNeighborGrid.cxx
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#include "aiNeighborGrid.h"
+
+#include <algorithm>
+
+// The cell indices are packed into 21 bits each.
+static const int neighbor_cell_offset = 0x100000;
+static const int max_neighbor_cell = 0xfffff;
+
+AINeighborGrid::AINeighborGrid() :
+  _cell_size(1.0f)
+{
+  for (int i = 0; i < 3; ++i) {
+    _min[i] = 0;
+    _max[i] = -1;
+  }
+}
+
+/**
+ * Removes all of the points.
+ */
+void AINeighborGrid::clear() {
+  _points.clear();
+  _entries.clear();
+  _cells.clear();
+  for (int i = 0; i < 3; ++i) {
+    _min[i] = 0;
+    _max[i] = -1;
+  }
+}
+
+/**
+ * Adds a point, and returns its number.  The point can't be found until
+ * build() has been called.
+ */
+int AINeighborGrid::add_point(const LPoint3 &point) {
+  _points.push_back(point);
+  return (int)_points.size() - 1;
+}
+
+/**
+ * Sorts the points into cells of the indicated size.  This should be about
+ * the radius that find_near() will be called with.
+ */
+void AINeighborGrid::build(PN_stdfloat cell_size) {
+  _cell_size = (cell_size > 0.0f) ? cell_size : 1.0f;
+  _entries.resize(_points.size());
+  _cells.clear();
+
+  for (int i = 0; i < 3; ++i) {
+    _min[i] = max_neighbor_cell;
+    _max[i] = -max_neighbor_cell;
+  }
+
+  for (size_t n = 0; n < _points.size(); ++n) {
+    int c[3];
+    for (int i = 0; i < 3; ++i) {
+      c[i] = get_cell(_points[n][i]);
+      _min[i] = std::min(_min[i], c[i]);
+      _max[i] = std::max(_max[i], c[i]);
+    }
+    _entries[n]._key = get_key(c[0], c[1], c[2]);
+    _entries[n]._point = (int)n;
+  }
+  std::sort(_entries.begin(), _entries.end());
+
+  int num_entries = (int)_entries.size();
+  int begin = 0;
+  while (begin < num_entries) {
+    int end = begin + 1;
+    while (end < num_entries && _entries[end]._key == _entries[begin]._key) {
+      ++end;
+    }
+    Range range;
+    range._begin = begin;
+    range._end = end;
+    _cells.store(_entries[begin]._key, range);
+    begin = end;
+  }
+}
+
+/**
+ * Returns the number of points that have been added.
+ */
+int AINeighborGrid::get_num_points() const {
+  return (int)_points.size();
+}
+
+/**
+ * Returns the nth point that was added.
+ */
+const LPoint3 &AINeighborGrid::get_point(int n) const {
+  nassertr(n >= 0 && n < (int)_points.size(), LPoint3::zero());
+  return _points[n];
+}
+
+/**
+ * Returns the size of the cells, as passed to build().
+ */
+PN_stdfloat AINeighborGrid::get_cell_size() const {
+  return _cell_size;
+}
+
+/**
+ * Returns the number of cells that contain at least one point.
+ */
+int AINeighborGrid::get_num_cells() const {
+  return (int)_cells.get_num_entries();
+}
+
+/**
+ * Adds the numbers of all the points within the indicated distance of the
+ * center to the result, including any point at the center itself.
+ */
+void AINeighborGrid::find_near(const LPoint3 &center, PN_stdfloat radius,
+                               pvector<int> &result) const {
+  if (_entries.empty() || radius < 0.0f) {
+    return;
+  }
+
+  int lo[3], hi[3];
+  uint64_t num_cells = 1;
+  for (int i = 0; i < 3; ++i) {
+    lo[i] = std::max(get_cell(center[i] - radius), _min[i]);
+    hi[i] = std::min(get_cell(center[i] + radius), _max[i]);
+    if (lo[i] > hi[i]) {
+      return;
+    }
+    num_cells *= (uint64_t)(hi[i] - lo[i] + 1);
+  }
+
+  PN_stdfloat radius_sq = radius * radius;
+  if (num_cells > (uint64_t)_cells.get_num_entries()) {
+    // The sphere covers more cells than there are points in, so it's quicker
+    // to look at all of the points.
+    for (const Entry &entry : _entries) {
+      if ((_points[entry._point] - center).length_squared() <= radius_sq) {
+        result.push_back(entry._point);
+      }
+    }
+    return;
+  }
+
+  for (int x = lo[0]; x <= hi[0]; ++x) {
+    for (int y = lo[1]; y <= hi[1]; ++y) {
+      for (int z = lo[2]; z <= hi[2]; ++z) {
+        int slot = _cells.find(get_key(x, y, z));
+        if (slot == -1) {
+          continue;
+        }
+        const Range &range = _cells.get_data(slot);
+        for (int e = range._begin; e < range._end; ++e) {
+          int point = _entries[e]._point;
+          if ((_points[point] - center).length_squared() <= radius_sq) {
+            result.push_back(point);
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Returns the number of the point nearest to the center, leaving out any
+ * point at the center itself, or -1 if there is none.  Of several points at
+ * the same distance, the one that was added first is returned.
+ */
+int AINeighborGrid::find_nearest(const LPoint3 &center) const {
+  if (_entries.empty()) {
+    return -1;
+  }
+
+  // No point is further away than the furthest corner of the occupied cells.
+  PN_stdfloat max_radius = 0.0f;
+  {
+    LVector3 extent;
+    for (int i = 0; i < 3; ++i) {
+      PN_stdfloat a = _min[i] * _cell_size - center[i];
+      PN_stdfloat b = (_max[i] + 1) * _cell_size - center[i];
+      extent[i] = std::max(std::abs(a), std::abs(b));
+    }
+    max_radius = extent.length();
+  }
+
+  // Look further and further away, until we've found a point inside the
+  // sphere we've searched, which must then be the nearest.
+  pvector<int> nearby;
+  PN_stdfloat radius = _cell_size;
+  while (true) {
+    nearby.clear();
+    find_near(center, radius, nearby);
+
+    int best = -1;
+    PN_stdfloat best_dist_sq = 0.0f;
+    for (int point : nearby) {
+      if (_points[point] == center) {
+        continue;
+      }
+      PN_stdfloat dist_sq = (_points[point] - center).length_squared();
+      if (best == -1 || dist_sq < best_dist_sq ||
+          (dist_sq == best_dist_sq && point < best)) {
+        best = point;
+        best_dist_sq = dist_sq;
+      }
+    }
+
+    if ((best != -1 && best_dist_sq <= radius * radius) ||
+        nearby.size() == _points.size() || !(radius < max_radius)) {
+      return best;
+    }
+    radius *= 2.0f;
+  }
+}
+
+/**
+ * Returns the key of the indicated cell in _cells.
+ */
+uint64_t AINeighborGrid::get_key(int x, int y, int z) const {
+  return ((uint64_t)(x + neighbor_cell_offset) << 42) |
+         ((uint64_t)(y + neighbor_cell_offset) << 21) |
+         (uint64_t)(z + neighbor_cell_offset);
+}
+
+/**
+ * Returns the index of the cell containing the indicated coordinate, along
+ * any axis.
+ */
+int AINeighborGrid::get_cell(PN_stdfloat coord) const {
+  PN_stdfloat cell = std::floor(coord / _cell_size);
+  if (!(cell > -max_neighbor_cell)) {
+    return -max_neighbor_cell;
+  }
+  if (!(cell < max_neighbor_cell)) {
+    return max_neighbor_cell;
+  }
+  return (int)cell;
+}
@@ -0,0 +1,83 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file aiNeighborGrid.h
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#ifndef _AINEIGHBORGRID_H
+#define _AINEIGHBORGRID_H
+
+#include "aiGlobals.h"
+#include "luse.h"
+#include "pvector.h"
+#include "simpleHashMap.h"
+
+/**
+ * A set of points sorted into a uniform grid of cubic cells, so that the
+ * points near a given point can be found without looking at all of them.
+ * The AIWorld fills one of these with the positions of its characters, and
+ * one with the positions of its obstacles, at the start of every update.
+ *
+ * The points are numbered in the order they were added.  Once build() has
+ * been called, any number of threads may query the grid at the same time.
+ */
+class EXPCL_PANDAAI AINeighborGrid {
+PUBLISHED:
+  AINeighborGrid();
+
+  void clear();
+  int add_point(const LPoint3 &point);
+  void build(PN_stdfloat cell_size);
+
+  int get_num_points() const;
+  const LPoint3 &get_point(int n) const;
+  PN_stdfloat get_cell_size() const;
+  int get_num_cells() const;
+
+  int find_nearest(const LPoint3 &center) const;
+
+public:
+  void find_near(const LPoint3 &center, PN_stdfloat radius,
+                 pvector<int> &result) const;
+
+private:
+  uint64_t get_key(int x, int y, int z) const;
+  int get_cell(PN_stdfloat coord) const;
+
+  PN_stdfloat _cell_size;
+  pvector<LPoint3> _points;
+
+  // The point numbers, sorted by cell.
+  class Entry {
+  public:
+    uint64_t _key;
+    int _point;
+
+    bool operator < (const Entry &other) const {
+      return _key < other._key || (_key == other._key && _point < other._point);
+    }
+  };
+  pvector<Entry> _entries;
+
+  // The range of _entries that are in each occupied cell.
+  class Range {
+  public:
+    int _begin;
+    int _end;
+  };
+  typedef SimpleHashMap<uint64_t, Range, integer_hash<uint64_t> > Cells;
+  Cells _cells;
+
+  // The bounding box of the points, in cells.
+  int _min[3];
+  int _max[3];
+};
+
+#endif
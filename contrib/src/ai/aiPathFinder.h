@@ -15,43 +15,41 @@
 #define _PATHFINDER_H
 
 #include "meshNode.h"
+#include "aiNavGrid.h"
+#include "aiPathSearch.h"
 #include "cmath.h"
 #include "lineSegs.h"
 
-typedef std::vector<Node *> NodeArray;
-typedef std::vector<NodeArray> NavMesh;
-
-Node* find_in_mesh(NavMesh nav_mesh, LVecBase3 pos, int grid_size);
+Node* find_in_mesh(const NavMesh &nav_mesh, LVecBase3 pos, int grid_size);
 
 /**
- * This class implements pathfinding using A* algorithm.  It also uses a
- * Binary Heap search to search the open list.  The heuristics are calculated
- * using the manhattan method.
+ * This class implements pathfinding using A* algorithm.  The mesh is copied
+ * into an AINavGrid, which stores it in flat arrays, and searched with an
+ * AIPathSearch, which keeps its open list in an indexed binary heap.  The
+ * heuristics are calculated using the octile distance.
  */
 class EXPCL_PANDAAI PathFinder {
 public:
   Node *_src_node;
   Node *_dest_node;
-  std::vector<Node*> _open_list;
-  std::vector<Node*> _closed_list;
-
-  NavMesh _grid;
 
-  void identify_neighbors(Node *nd);
-  int calc_cost_frm_src(Node *nd);
-  int calc_heuristic(Node *nd);
-  void calc_node_score(Node *nd);
-  bool is_diagonal_node(Node *nd);
+  // The path found by the last call to find_path(), from the destination
+  // node back to the node after the source.
+  std::vector<Node*> _path;
 
-  void add_to_olist(Node *nd);
-  void remove_from_olist();
-
-  void add_to_clist(Node *nd);
-  void remove_from_clist(int r, int c);
-
-  void generate_path();
-  void find_path(Node *src_node, Node *dest_node);
-  PathFinder(NavMesh nav_mesh);
+  NavMesh _grid;
+  PT(AINavGrid) _nav_grid;
+  AIPathSearch _search;
+
+  bool find_path(Node *src_node, Node *dest_node);
+  bool set_path(const AINavGrid::Path &cells);
+  Node *find_node(const LVecBase3 &pos) const;
+  int find_cell(Node *nd) const;
+  void set_walkable(Node *nd, bool walkable);
+  void move_obstacles(const std::vector<Node*> &cleared,
+                      const std::vector<Node*> &blocked);
+
+  PathFinder(const NavMesh &nav_mesh);
   ~PathFinder();
 };
 
@@ -0,0 +1,208 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file aiPathRequest.cxx
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#include "aiPathRequest.h"
+#include "lightMutexHolder.h"
+
+TypeHandle AIPath::_type_handle;
+TypeHandle AIPathRequest::_type_handle;
+
+/**
+ * Frees the searches that are in the pool.  The requests that are using one
+ * keep the pool alive until they are done with it.
+ */
+AIPathSearchPool::~AIPathSearchPool() {
+  for (AIPathSearch *search : _searches) {
+    delete search;
+  }
+}
+
+/**
+ * Returns a search state that no other thread is using.
+ */
+AIPathSearch *AIPathSearchPool::acquire_search() {
+  {
+    LightMutexHolder holder(_lock);
+    if (!_searches.empty()) {
+      AIPathSearch *search = _searches.back();
+      _searches.pop_back();
+      return search;
+    }
+  }
+  return new AIPathSearch;
+}
+
+/**
+ * Hands back a search state obtained from acquire_search(), for the next
+ * request to use.
+ */
+void AIPathSearchPool::release_search(AIPathSearch *search) {
+  LightMutexHolder holder(_lock);
+  _searches.push_back(search);
+}
+
+/**
+ *
+ */
+AIPath::AIPath(int src, int dst, unsigned int version,
+               bool found, const AINavGrid::Path &cells) :
+  _src(src),
+  _dst(dst),
+  _version(version),
+  _found(found),
+  _cells(cells)
+{
+}
+
+/**
+ * Returns the cell the path starts from.
+ */
+int AIPath::get_src() const {
+  return _src;
+}
+
+/**
+ * Returns the cell the path leads to.
+ */
+int AIPath::get_dst() const {
+  return _dst;
+}
+
+/**
+ * Returns the version of the grid that was searched.  If this is no longer
+ * the grid's current version, an obstacle may have moved onto the path since.
+ */
+unsigned int AIPath::get_version() const {
+  return _version;
+}
+
+/**
+ * Returns true if the destination could be reached.
+ */
+bool AIPath::is_found() const {
+  return _found;
+}
+
+/**
+ * Returns the cells along the path, including the source and destination, or
+ * an empty list if there is no path.
+ */
+PTA_int AIPath::get_cells() const {
+  PTA_int result;
+  result.v().assign(_cells.begin(), _cells.end());
+  return result;
+}
+
+/**
+ * Returns the cells along the path, without copying them.
+ */
+const AINavGrid::Path &AIPath::get_path() const {
+  return _cells;
+}
+
+/**
+ * Creates a request for the shortest path from the src cell to the dst cell,
+ * through the walkable cells of the grid as they are now.
+ */
+AIPathRequest::AIPathRequest(AINavGrid *grid, int src, int dst) :
+  AIPathRequest(grid, src, dst, nullptr)
+{
+}
+
+/**
+ * Like the above, but the search state is taken from the indicated pool, and
+ * handed back to it afterwards, rather than being allocated for this request
+ * alone.
+ */
+AIPathRequest::AIPathRequest(AINavGrid *grid, int src, int dst,
+                             AIPathSearchPool *searches) :
+  AsyncTask("ai_path"),
+  _grid(grid),
+  _snapshot(grid->get_snapshot()),
+  _version(_snapshot->_version),
+  _src(src),
+  _dst(dst),
+  _searches(searches)
+{
+}
+
+/**
+ * Returns the grid being searched.
+ */
+AINavGrid *AIPathRequest::get_grid() const {
+  return _grid;
+}
+
+/**
+ * Returns the cell the path starts from.
+ */
+int AIPathRequest::get_src() const {
+  return _src;
+}
+
+/**
+ * Returns the cell the path leads to.
+ */
+int AIPathRequest::get_dst() const {
+  return _dst;
+}
+
+/**
+ * Returns the version of the grid that is being searched, which was the
+ * current version when the request was made.
+ */
+unsigned int AIPathRequest::get_version() const {
+  return _version;
+}
+
+/**
+ * Returns true if the path has been found, or found not to exist, in which
+ * case it may be retrieved with get_path().  Equivalent to `req.done() and
+ * not req.cancelled()`.
+ */
+bool AIPathRequest::is_ready() const {
+  return done() && !cancelled();
+}
+
+/**
+ * Returns the path that was found.  It is an error to call this unless
+ * is_ready() returns true.
+ */
+AIPath *AIPathRequest::get_path() const {
+  nassertr_always(is_ready(), nullptr);
+  return DCAST(AIPath, get_result());
+}
+
+/**
+ * Performs the search, on whichever thread the task chain runs it.
+ */
+AsyncTask::DoneStatus AIPathRequest::do_task() {
+  AINavGrid::Path cells;
+  bool found;
+  if (_searches != nullptr) {
+    AIPathSearch *search = _searches->acquire_search();
+    found = _grid->find_path(*search, _snapshot, _src, _dst, cells);
+    _searches->release_search(search);
+  } else {
+    AIPathSearch search;
+    found = _grid->find_path(search, _snapshot, _src, _dst, cells);
+  }
+
+  set_result(new AIPath(_src, _dst, _version, found, cells));
+
+  // We don't need to keep the old cells or the pool around any longer, now
+  // that we're done with them.
+  _snapshot.clear();
+  _searches.clear();
+  return DS_done;
+}
@@ -0,0 +1,154 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file aiPathRequest.h
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#ifndef _AIPATHREQUEST_H
+#define _AIPATHREQUEST_H
+
+#include "aiGlobals.h"
+#include "aiNavGrid.h"
+#include "aiPathSearch.h"
+#include "asyncTask.h"
+#include "typedReferenceCount.h"
+#include "referenceCount.h"
+#include "pta_int.h"
+#include "lightMutex.h"
+#include "pvector.h"
+
+/**
+ * The AIPathSearch objects that are not in use, shared by the AIPathRequests
+ * of one AIWorld.  The search state isn't tied to a request, but kept for the
+ * next one, so that each thread ends up reusing the arrays of one
+ * AIPathSearch.  They are freed along with the pool, which the pending
+ * requests keep alive even if the AIWorld is gone.
+ */
+class EXPCL_PANDAAI AIPathSearchPool : public ReferenceCount {
+public:
+  AIPathSearchPool() = default;
+  ~AIPathSearchPool();
+
+  AIPathSearch *acquire_search();
+  void release_search(AIPathSearch *search);
+
+private:
+  LightMutex _lock;
+  pvector<AIPathSearch *> _searches;
+};
+
+/**
+ * The result of an AIPathRequest: the cells along the shortest path between
+ * two cells of an AINavGrid, as they were at the indicated version of the
+ * grid.
+ */
+class EXPCL_PANDAAI AIPath : public TypedReferenceCount {
+public:
+  AIPath(int src, int dst, unsigned int version,
+         bool found, const AINavGrid::Path &cells);
+
+PUBLISHED:
+  int get_src() const;
+  int get_dst() const;
+  unsigned int get_version() const;
+  bool is_found() const;
+  PTA_int get_cells() const;
+
+  MAKE_PROPERTY(src, get_src);
+  MAKE_PROPERTY(dst, get_dst);
+  MAKE_PROPERTY(version, get_version);
+  MAKE_PROPERTY(found, is_found);
+  MAKE_PROPERTY(cells, get_cells);
+
+public:
+  const AINavGrid::Path &get_path() const;
+
+private:
+  int _src;
+  int _dst;
+  unsigned int _version;
+  bool _found;
+  AINavGrid::Path _cells;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    TypedReferenceCount::init_type();
+    register_type(_type_handle, "AIPath",
+                  TypedReferenceCount::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+/**
+ * A request to find a path through an AINavGrid on one of the AIWorld's
+ * threads; see AIWorld::request_path().  The search sees the walkable cells
+ * as they were when the request was made, even if they change while it is
+ * running.  When it is done, the result of the request is an AIPath.
+ */
+class EXPCL_PANDAAI AIPathRequest : public AsyncTask {
+public:
+  explicit AIPathRequest(AINavGrid *grid, int src, int dst,
+                         AIPathSearchPool *searches);
+
+PUBLISHED:
+  explicit AIPathRequest(AINavGrid *grid, int src, int dst);
+
+  AINavGrid *get_grid() const;
+  int get_src() const;
+  int get_dst() const;
+  unsigned int get_version() const;
+
+  bool is_ready() const;
+  AIPath *get_path() const;
+
+  MAKE_PROPERTY(grid, get_grid);
+  MAKE_PROPERTY(src, get_src);
+  MAKE_PROPERTY(dst, get_dst);
+  MAKE_PROPERTY(version, get_version);
+
+protected:
+  virtual DoneStatus do_task();
+
+private:
+  PT(AINavGrid) _grid;
+  CPT(AINavGrid::Snapshot) _snapshot;
+  unsigned int _version;
+  int _src;
+  int _dst;
+  PT(AIPathSearchPool) _searches;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    AsyncTask::init_type();
+    register_type(_type_handle, "AIPathRequest",
+                  AsyncTask::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#endif
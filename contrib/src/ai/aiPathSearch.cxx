@@ -0,0 +1,245 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file aiPathSearch.cxx
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#include "aiPathSearch.h"
+#include "aiNavGrid.h"
+
+#include <algorithm>
+
+AIPathSearch::AIPathSearch() :
+  _generation(0),
+  _num_visited(0)
+{
+}
+
+/**
+ * Finds the shortest path from the src cell to the dst cell of the grid,
+ * using the A* algorithm.  Orthogonal steps cost 10 and diagonal steps 14,
+ * and the heuristic is the octile distance, which never overestimates this.
+ *
+ * Fills path with the cells along the way, including src and dst, and returns
+ * true, or returns false with an empty path if dst cannot be reached.  The
+ * src cell itself need not be walkable.
+ *
+ * The flags are those of the snapshot of the grid's cells that is to be
+ * searched, see AINavGrid::get_snapshot().
+ */
+bool AIPathSearch::find_path(const AINavGrid *grid, const unsigned char *flags,
+                             int src, int dst, Path &path) {
+  path.clear();
+
+  int num_cells = grid->get_num_cells();
+  nassertr(src >= 0 && src < num_cells && dst >= 0 && dst < num_cells, false);
+
+  const unsigned char passable = AINavGrid::F_present | AINavGrid::F_walkable;
+  if ((flags[src] & AINavGrid::F_present) == 0) {
+    return false;
+  }
+  if (src == dst) {
+    path.push_back(src);
+    return true;
+  }
+  if ((flags[dst] & passable) != passable) {
+    return false;
+  }
+
+  reset(num_cells);
+
+  const int size_x = grid->_size_x;
+  const int dst_x = dst % size_x;
+  const int dst_y = dst / size_x;
+  const int *neighbors = grid->_neighbors.data();
+
+  CellState &src_state = _cells[src];
+  src_state._stamp = _generation;
+  src_state._cost = 0;
+  {
+    int dx = std::abs(src % size_x - dst_x);
+    int dy = std::abs(src / size_x - dst_y);
+    src_state._score = 10 * std::max(dx, dy) + 4 * std::min(dx, dy);
+  }
+  src_state._parent = -1;
+  heap_push(src);
+
+  while (!_heap.empty()) {
+    int cell = heap_pop();
+    ++_num_visited;
+
+    if (cell == dst) {
+      // Walk back along the parents to recover the path.
+      for (int c = dst; c != -1; c = _cells[c]._parent) {
+        path.push_back(c);
+      }
+      std::reverse(path.begin(), path.end());
+      return true;
+    }
+
+    const CellState &state = _cells[cell];
+    const int cx = cell % size_x;
+    const int cy = cell / size_x;
+    const int *nb = neighbors + (size_t)cell * AINavGrid::num_neighbors;
+
+    for (int i = 0; i < AINavGrid::num_neighbors; ++i) {
+      int next = nb[i];
+      if (next < 0 || (flags[next] & passable) != passable) {
+        continue;
+      }
+
+      int nx = next % size_x;
+      int ny = next / size_x;
+      int cost = state._cost + ((nx != cx && ny != cy) ? 14 : 10);
+
+      CellState &next_state = _cells[next];
+      if (next_state._stamp != _generation) {
+        // First time we've seen this cell in this search.
+        int dx = std::abs(nx - dst_x);
+        int dy = std::abs(ny - dst_y);
+        next_state._stamp = _generation;
+        next_state._cost = cost;
+        next_state._score = cost + 10 * std::max(dx, dy) + 4 * std::min(dx, dy);
+        next_state._parent = cell;
+        heap_push(next);
+
+      } else if (next_state._heap_index >= 0 && cost < next_state._cost) {
+        // A shorter way to a cell still on the open list.  Since the
+        // heuristic is consistent, a closed cell never needs reopening.
+        next_state._score += cost - next_state._cost;
+        next_state._cost = cost;
+        next_state._parent = cell;
+        heap_up(next_state._heap_index);
+      }
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Returns the number of cells that were expanded by the last search.
+ */
+size_t AIPathSearch::get_num_visited() const {
+  return _num_visited;
+}
+
+/**
+ * Prepares for a new search over a grid with the indicated number of cells.
+ * This only touches every cell when the grid size changes, or once every four
+ * billion searches, when the generation counter wraps around.
+ */
+void AIPathSearch::reset(size_t num_cells) {
+  if (_cells.size() != num_cells) {
+    CellState blank;
+    blank._stamp = 0;
+    blank._cost = 0;
+    blank._score = 0;
+    blank._parent = -1;
+    blank._heap_index = -1;
+    _cells.assign(num_cells, blank);
+    _generation = 0;
+  }
+
+  ++_generation;
+  if (_generation == 0) {
+    for (CellState &state : _cells) {
+      state._stamp = 0;
+    }
+    _generation = 1;
+  }
+
+  _heap.clear();
+  _num_visited = 0;
+}
+
+/**
+ * Adds the cell to the open list.
+ */
+void AIPathSearch::heap_push(int cell) {
+  _heap.push_back(cell);
+  heap_up((int)_heap.size() - 1);
+}
+
+/**
+ * Removes the cell with the lowest score from the open list, marks it closed,
+ * and returns it.
+ */
+int AIPathSearch::heap_pop() {
+  int top = _heap[0];
+  int last = _heap.back();
+  _heap.pop_back();
+  if (!_heap.empty()) {
+    _heap[0] = last;
+    _cells[last]._heap_index = 0;
+    heap_down(0);
+  }
+  _cells[top]._heap_index = -1;
+  return top;
+}
+
+/**
+ * Moves the cell at the indicated position of the heap up towards the top,
+ * until it is in order.
+ */
+void AIPathSearch::heap_up(int pos) {
+  int cell = _heap[pos];
+  while (pos > 0) {
+    int parent = (pos - 1) / 2;
+    if (!heap_less(cell, _heap[parent])) {
+      break;
+    }
+    _heap[pos] = _heap[parent];
+    _cells[_heap[pos]]._heap_index = pos;
+    pos = parent;
+  }
+  _heap[pos] = cell;
+  _cells[cell]._heap_index = pos;
+}
+
+/**
+ * Moves the cell at the indicated position of the heap down towards the
+ * bottom, until it is in order.
+ */
+void AIPathSearch::heap_down(int pos) {
+  int size = (int)_heap.size();
+  int cell = _heap[pos];
+  while (true) {
+    int child = pos * 2 + 1;
+    if (child >= size) {
+      break;
+    }
+    if (child + 1 < size && heap_less(_heap[child + 1], _heap[child])) {
+      ++child;
+    }
+    if (!heap_less(_heap[child], cell)) {
+      break;
+    }
+    _heap[pos] = _heap[child];
+    _cells[_heap[pos]]._heap_index = pos;
+    pos = child;
+  }
+  _heap[pos] = cell;
+  _cells[cell]._heap_index = pos;
+}
+
+/**
+ * Returns true if cell a should be expanded before cell b.  Of two cells with
+ * the same score, the one furthest from the source is preferred, since it is
+ * likely to be closer to the destination.
+ */
+bool AIPathSearch::heap_less(int a, int b) const {
+  const CellState &sa = _cells[a];
+  const CellState &sb = _cells[b];
+  if (sa._score != sb._score) {
+    return sa._score < sb._score;
+  }
+  return sa._cost > sb._cost;
+}
@@ -0,0 +1,71 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file aiPathSearch.h
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#ifndef _AIPATHSEARCH_H
+#define _AIPATHSEARCH_H
+
+#include "aiGlobals.h"
+#include "pvector.h"
+
+class AINavGrid;
+
+/**
+ * The working state of an A* search over an AINavGrid.  This is kept from one
+ * search to the next, so that the arrays need not be reallocated.  Rather
+ * than clearing the state of every cell before each search, each cell is
+ * stamped with the number of the search that last touched it; a cell with an
+ * old stamp is simply treated as unvisited.
+ *
+ * One of these may only be used by one thread at a time, but any number of
+ * them may search the same grid at once.
+ */
+class EXPCL_PANDAAI AIPathSearch {
+public:
+  typedef pvector<int> Path;
+
+  AIPathSearch();
+
+  bool find_path(const AINavGrid *grid, const unsigned char *flags,
+                 int src, int dst, Path &path);
+
+  size_t get_num_visited() const;
+
+private:
+  void reset(size_t num_cells);
+
+  void heap_push(int cell);
+  int heap_pop();
+  void heap_up(int pos);
+  void heap_down(int pos);
+  bool heap_less(int a, int b) const;
+
+  // The state of a cell in the current search, valid only if _stamp matches
+  // _generation.  _heap_index is -1 once the cell has been closed.
+  class CellState {
+  public:
+    uint32_t _stamp;
+    int _cost;
+    int _score;
+    int _parent;
+    int _heap_index;
+  };
+  pvector<CellState> _cells;
+
+  // The open list, as a binary heap of cell indices ordered by score.
+  pvector<int> _heap;
+
+  uint32_t _generation;
+  size_t _num_visited;
+};
+
+#endif
@@ -12,9 +12,21 @@
  */
 
 #include "aiWorld.h"
+#include "aiBehaviors.h"
+#include "pathFollow.h"
+#include "jobSystem.h"
 
 AIWorld::AIWorld(NodePath render) {
   _render = std::move(render);
+  _neighbors_valid = false;
+  _path_searches = new AIPathSearchPool;
+
+  _task_manager = AsyncTaskManager::get_global_ptr();
+  _task_chain = "ai_path";
+  if (_task_manager->find_task_chain(_task_chain) == nullptr) {
+    PT(AsyncTaskChain) chain = _task_manager->make_task_chain(_task_chain);
+    chain->set_num_threads(ai_path_threads);
+  }
 }
 
 AIWorld::~AIWorld() {
@@ -69,11 +81,83 @@ void AIWorld::print_list() {
 /**
  * The AIWorld update function calls the update function of all the AI
  * characters which have been added to the AIWorld.
+ *
+ * The characters all steer by the world as it was at the start of the
+ * update.  The steering forces of the characters that don't change anything
+ * but themselves are calculated first, in parallel if ai-parallel-update is
+ * on; then all the characters are moved, in order.  The result is the same
+ * either way.
  */
 void AIWorld::update() {
+  remove_finished_path_requests();
+  update_neighbors();
+
+  size_t num_chars = _ai_char_pool.size();
+  pvector<LVecBase3> forces(num_chars);
+  pvector<unsigned char> calculated(num_chars, 0);
+
+  auto calculate_steering = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      AICharacter *ai_char = _ai_char_pool[i];
+      if (ai_char->is_independent()) {
+        forces[i] = ai_char->_steering->calculate_prioritized();
+        calculated[i] = 1;
+      }
+    }
+  };
+
+  if (ai_parallel_update && num_chars > 1) {
+    JobSystem::get_global_ptr()->parallel_process(num_chars, calculate_steering, 16);
+  } else {
+    calculate_steering(0, num_chars);
+  }
+
+  for (size_t i = 0; i < num_chars; ++i) {
+    AICharacter *ai_char = _ai_char_pool[i];
+    if (calculated[i]) {
+      ai_char->apply_steering(forces[i]);
+    } else {
+      ai_char->update();
+    }
+  }
+
+  _neighbors_valid = false;
+}
+
+/**
+ * This function sorts the positions of the characters and obstacles into the
+ * grids that are used during update() to find the ones nearby.
+ */
+void AIWorld::update_neighbors() {
+  PN_stdfloat radius = 0.0f;
+  for (Flock *flock : _flock_pool) {
+    radius = std::max(radius, (PN_stdfloat)flock->_flock_vcone_radius);
+  }
+
+  _char_grid.clear();
+  _char_velocities.clear();
+  _char_velocities.reserve(_ai_char_pool.size());
   for (AICharacter *ai_char : _ai_char_pool) {
-    ai_char->update();
+    _char_grid.add_point(LPoint3(ai_char->_ai_char_np.get_pos()));
+    _char_velocities.push_back(ai_char->_velocity);
+  }
+  _char_grid.build(radius);
+
+  _obstacle_grid.clear();
+  for (const NodePath &obstacle : _obstacles) {
+    _obstacle_grid.add_point(LPoint3(obstacle.get_pos()));
   }
+  _obstacle_grid.build(ai_obstacle_cell_size);
+
+  _neighbors_valid = true;
+}
+
+/**
+ * Returns the nth AI character that was added to the world.
+ */
+AICharacter *AIWorld::get_ai_char(size_t n) const {
+  nassertr(n < _ai_char_pool.size(), nullptr);
+  return _ai_char_pool[n];
 }
 
 /**
@@ -170,3 +254,79 @@ void AIWorld::remove_obstacle(NodePath obstacle) {
     }
   }
 }
+
+/**
+ * This function asks for the shortest path from the src cell to the dst cell
+ * of the grid to be found on one of the world's threads, see ai-path-threads.
+ * It returns the request, which is an AsyncFuture whose result will be an
+ * AIPath.  The search sees the walkable cells as they are now, even if they
+ * are changed before it is done.
+ *
+ * If the same path was asked for before on the same version of the grid, and
+ * that search isn't done yet, the same request is returned again.
+ */
+PT(AIPathRequest) AIWorld::request_path(AINavGrid *grid, int src, int dst) {
+  nassertr(grid != nullptr, nullptr);
+  nassertr(src >= 0 && src < grid->get_num_cells(), nullptr);
+  nassertr(dst >= 0 && dst < grid->get_num_cells(), nullptr);
+
+  PathKey key;
+  key._grid = grid;
+  key._version = grid->get_version();
+  key._src = src;
+  key._dst = dst;
+
+  PathRequests::iterator it = _path_requests.find(key);
+  if (it != _path_requests.end()) {
+    if (!(*it).second->done()) {
+      return (*it).second;
+    }
+    _path_requests.erase(it);
+  }
+
+  PT(AIPathRequest) request = new AIPathRequest(grid, src, dst, _path_searches);
+  request->set_task_chain(_task_chain);
+  _task_manager->add(request);
+  _path_requests[key] = request;
+  return request;
+}
+
+/**
+ * This function returns the number of path requests that have been made with
+ * request_path() and are not done yet.
+ */
+size_t AIWorld::get_num_path_requests() {
+  remove_finished_path_requests();
+  return _path_requests.size();
+}
+
+/**
+ * Forgets the path requests that are done, so that they may be freed once
+ * their callers are done with them too.
+ */
+void AIWorld::remove_finished_path_requests() {
+  PathRequests::iterator it = _path_requests.begin();
+  while (it != _path_requests.end()) {
+    if ((*it).second->done()) {
+      it = _path_requests.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+/**
+ *
+ */
+bool AIWorld::PathKey::operator < (const PathKey &other) const {
+  if (_grid != other._grid) {
+    return _grid < other._grid;
+  }
+  if (_version != other._version) {
+    return _version < other._version;
+  }
+  if (_src != other._src) {
+    return _src < other._src;
+  }
+  return _dst < other._dst;
+}
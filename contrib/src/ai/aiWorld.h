@@ -17,6 +17,10 @@
 #include "aiGlobals.h"
 #include "aiCharacter.h"
 #include "flock.h"
+#include "aiNavGrid.h"
+#include "aiPathRequest.h"
+#include "aiNeighborGrid.h"
+#include "pmap.h"
 
 class AICharacter;
 class Flock;
@@ -33,12 +37,43 @@ class EXPCL_PANDAAI AIWorld {
     typedef std::vector<PT(AICharacter)> AICharPool;
     AICharPool _ai_char_pool;
     NodePath _render;
+
+    // The path requests that are still pending, so that asking for the same
+    // path again, before the first request is done, doesn't search twice.
+    class PathKey {
+    public:
+      bool operator < (const PathKey &other) const;
+
+      AINavGrid *_grid;
+      unsigned int _version;
+      int _src;
+      int _dst;
+    };
+    typedef pmap<PathKey, PT(AIPathRequest)> PathRequests;
+    PathRequests _path_requests;
+    PT(AIPathSearchPool) _path_searches;
+    PT(AsyncTaskManager) _task_manager;
+    std::string _task_chain;
+
+    void remove_finished_path_requests();
+    void update_neighbors();
   public:
     std::vector<NodePath> _obstacles;
     typedef std::vector<Flock*> FlockPool;
     FlockPool _flock_pool;
     void remove_ai_char_from_flock(std::string name);
 
+    // The positions of the characters, with their velocities, and of the
+    // obstacles, as they were at the start of the current update(), sorted
+    // into grids so that the ones near a point can be found quickly.  These
+    // are only valid during update().
+    bool _neighbors_valid;
+    AINeighborGrid _char_grid;
+    pvector<LVecBase3> _char_velocities;
+    AINeighborGrid _obstacle_grid;
+
+    AICharacter *get_ai_char(size_t n) const;
+
 PUBLISHED:
     AIWorld(NodePath render);
     ~AIWorld();
@@ -55,6 +90,9 @@ PUBLISHED:
     void add_obstacle(NodePath obstacle);
     void remove_obstacle(NodePath obstacle);
 
+    PT(AIPathRequest) request_path(AINavGrid *grid, int src, int dst);
+    size_t get_num_path_requests();
+
     void print_list();
     void update();
 };
@@ -27,6 +27,8 @@
 #include "pathFind.h"
 #include "aiNode.h"
 #include "aiPathFinder.h"
+#include "aiNavGrid.h"
+#include "aiPathRequest.h"
 #include "dconfig.h"
 
 Configure(config_ai);
@@ -36,6 +38,37 @@ ConfigureFn(config_ai) {
   init_libai();
 }
 
+ConfigVariableInt ai_path_cache_size
+("ai-path-cache-size", 256,
+ PRC_DESC("The number of paths that each navigation mesh remembers, so that "
+          "asking again for the path between the same two nodes doesn't "
+          "need another search.  The paths are forgotten when an obstacle "
+          "is added to or removed from the mesh.  Set this to 0 to disable "
+          "the cache."));
+
+ConfigVariableInt ai_path_threads
+("ai-path-threads", 1,
+ PRC_DESC("The number of threads that are started to find the paths asked "
+          "for with AIWorld::request_path(), which is also used by the "
+          "characters to find their way around moving obstacles.  Set this "
+          "to 0 to find the paths on the main thread instead, whenever the "
+          "task manager is polled."));
+
+ConfigVariableBool ai_parallel_update
+("ai-parallel-update", true,
+ PRC_DESC("Set this true to let AIWorld::update() calculate the steering "
+          "forces of the characters on the JobSystem's worker threads.  "
+          "Characters that are following a path are still updated on the "
+          "main thread.  The characters end up in the same places either "
+          "way."));
+
+ConfigVariableDouble ai_obstacle_cell_size
+("ai-obstacle-cell-size", 10.0,
+ PRC_DESC("The size of the cells of the grid that AIWorld sorts its obstacles "
+          "into at each update, so that each character only needs to look "
+          "at the obstacles around it to find the nearest one.  This should "
+          "be about the distance between neighboring obstacles."));
+
 /**
  * Initializes the library.  This must be called at least once before any of
  * the functions or classes in this library can be used.  Normally it will be
@@ -49,4 +82,7 @@ init_libai() {
     return;
   }
   initialized = true;
+
+  AIPath::init_type();
+  AIPathRequest::init_type();
 }
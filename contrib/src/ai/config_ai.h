@@ -16,9 +16,17 @@
 
 #include "contribbase.h"
 #include "notifyCategoryProxy.h"
+#include "configVariableInt.h"
+#include "configVariableBool.h"
+#include "configVariableDouble.h"
 
 NotifyCategoryDecl(ai, EXPCL_PANDAAI, EXPTP_PANDAAI);
 
+extern EXPCL_PANDAAI ConfigVariableInt ai_path_cache_size;
+extern EXPCL_PANDAAI ConfigVariableInt ai_path_threads;
+extern EXPCL_PANDAAI ConfigVariableBool ai_parallel_update;
+extern EXPCL_PANDAAI ConfigVariableDouble ai_obstacle_cell_size;
+
 extern EXPCL_PANDAAI void init_libai();
 
 #endif
@@ -61,4 +61,7 @@ public:
     bool contains(float x, float y);
 };
 
+typedef std::vector<Node *> NodeArray;
+typedef std::vector<NodeArray> NavMesh;
+
 #endif
@@ -38,18 +38,34 @@ obstacle_detection() {
   double distance = 0x7fff ;
   double expanded_radius = 0;
   LVecBase3 to_obstacle;
-  for(unsigned int i = 0; i < _ai_char->_world->_obstacles.size(); ++i) {
-    PT(BoundingVolume) bounds = _ai_char->_world->_obstacles[i].get_bounds();
-    CPT(BoundingSphere) bsphere = bounds->as_bounding_sphere();
-    LVecBase3 near_obstacle = _ai_char->_world->_obstacles[i].get_pos() - _ai_char->get_node_path().get_pos();
-    // Check if it's the nearest obstacle, If so initialize as the nearest
-    // obstacle
-    if((near_obstacle.length() < distance) && (_ai_char->_world->_obstacles[i].get_pos() != _ai_char->get_node_path().get_pos())) {
-      _nearest_obstacle = _ai_char->_world->_obstacles[i];
-      distance = near_obstacle.length();
-      expanded_radius = bsphere->get_radius() + np_sphere->get_radius();
+  AIWorld *world = _ai_char->_world;
+  LVecBase3 ai_char_pos = _ai_char->get_node_path().get_pos();
+  int nearest = -1;
+  if(world->_neighbors_valid) {
+    // The world has sorted the obstacles into a grid, so we only need to
+    // look at the ones around us.
+    nearest = world->_obstacle_grid.find_nearest(LPoint3(ai_char_pos));
+    if(nearest != -1 && (world->_obstacle_grid.get_point(nearest) - ai_char_pos).length() >= distance) {
+      nearest = -1;
+    }
+  }
+  else {
+    for(unsigned int i = 0; i < world->_obstacles.size(); ++i) {
+      LVecBase3 near_obstacle = world->_obstacles[i].get_pos() - ai_char_pos;
+      // Check if it's the nearest obstacle, If so initialize as the nearest
+      // obstacle
+      if((near_obstacle.length() < distance) && (world->_obstacles[i].get_pos() != ai_char_pos)) {
+        nearest = i;
+        distance = near_obstacle.length();
+      }
     }
   }
+  if(nearest != -1) {
+    _nearest_obstacle = world->_obstacles[nearest];
+    PT(BoundingVolume) bounds = _nearest_obstacle.get_bounds();
+    CPT(BoundingSphere) bsphere = bounds->as_bounding_sphere();
+    expanded_radius = bsphere->get_radius() + np_sphere->get_radius();
+  }
 
   LVecBase3 feeler = _feeler * _ai_char->get_char_render().get_relative_vector(_ai_char->get_node_path(), LVector3::forward());
   feeler.normalize();
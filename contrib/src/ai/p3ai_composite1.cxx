@@ -18,4 +18,8 @@
 #include "aiNode.cxx"
 
 #include "aiPathFinder.cxx"
+#include "aiPathSearch.cxx"
+#include "aiNavGrid.cxx"
+#include "aiPathRequest.cxx"
+#include "aiNeighborGrid.cxx"
 #include "meshNode.cxx"
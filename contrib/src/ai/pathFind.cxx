@@ -14,6 +14,10 @@
 #include "pathFind.h"
 
 #include "pathFollow.h"
+#include "aiWorld.h"
+
+#include <algorithm>
+#include <iterator>
 
 using std::cout;
 using std::endl;
@@ -211,13 +215,13 @@ void PathFind::path_find(LVecBase3 pos, string type) {
 
   clear_path();
 
-  Node* src = find_in_mesh(_nav_mesh, _ai_char->_ai_char_np.get_pos(_ai_char->_window_render), _grid_size);
+  Node* src = _path_finder_obj->find_node(_ai_char->_ai_char_np.get_pos(_ai_char->_window_render));
 
   if(src == nullptr) {
     cout<<"couldnt find source"<<endl;
   }
 
-  Node* dst = find_in_mesh(_nav_mesh, pos, _grid_size);
+  Node* dst = _path_finder_obj->find_node(pos);
 
   if(dst == nullptr) {
     cout<<"couldnt find destination"<<endl;
@@ -252,13 +256,13 @@ void PathFind::path_find(NodePath target, string type) {
   _path_find_target = target;
   _prev_position = target.get_pos(_ai_char->_window_render);
 
-  Node* src = find_in_mesh(_nav_mesh, _ai_char->_ai_char_np.get_pos(_ai_char->_window_render), _grid_size);
+  Node* src = _path_finder_obj->find_node(_ai_char->_ai_char_np.get_pos(_ai_char->_window_render));
 
   if(src == nullptr) {
     cout<<"couldnt find source"<<endl;
   }
 
-  Node* dst = find_in_mesh(_nav_mesh, _prev_position, _grid_size);
+  Node* dst = _path_finder_obj->find_node(_prev_position);
 
   if(dst == nullptr) {
     cout<<"couldnt find destination"<<endl;
@@ -277,25 +281,67 @@ void PathFind::path_find(NodePath target, string type) {
 }
 
 /**
- * Helper function to restore the path and mesh to its initial state
+ * This function is like path_find(), but asks the AIWorld to find the path on
+ * one of its threads, rather than waiting for it.  The path is handed to the
+ * path follower by finish_path_request(), once it has been found.  If the
+ * character isn't in a world, the path is found right away instead.
  */
-void PathFind::clear_path() {
-  // Initialize to zero
-  for(int i = 0; i < _grid_size; ++i) {
-    for(int j = 0; j < _grid_size; ++j) {
-      if(_nav_mesh[i][j] != nullptr) {
-        _nav_mesh[i][j]->_status = _nav_mesh[i][j]->neutral;
-        _nav_mesh[i][j]->_cost = 0;
-        _nav_mesh[i][j]->_heuristic = 0;
-        _nav_mesh[i][j]->_score = 0;
-        _nav_mesh[i][j]->_prv_node = nullptr;
-      }
-    }
+void PathFind::path_find_async(NodePath target) {
+  if(_ai_char->_world == nullptr) {
+    path_find(target);
+    return;
+  }
+
+  _path_find_target = target;
+  _prev_position = target.get_pos(_ai_char->_window_render);
+
+  Node* src = _path_finder_obj->find_node(_ai_char->_ai_char_np.get_pos(_ai_char->_window_render));
+  Node* dst = _path_finder_obj->find_node(_prev_position);
+  if(src == nullptr || dst == nullptr) {
+    return;
+  }
+
+  // If an earlier request is still pending, its path is out of date now;
+  // another character may be waiting for it, though, so let it finish.
+  _path_request = _ai_char->_world->request_path(_path_finder_obj->_nav_grid,
+                                                 _path_finder_obj->find_cell(src),
+                                                 _path_finder_obj->find_cell(dst));
+}
+
+/**
+ * This function hands the path found for the last call to path_find_async()
+ * to the path follower, once it is done.  Returns true if it did so, in which
+ * case the path follower has a new path, which may be empty if the target
+ * couldn't be reached.
+ */
+bool PathFind::finish_path_request() {
+  if(_path_request == nullptr || !_path_request->done()) {
+    return false;
+  }
+
+  PT(AIPathRequest) request = _path_request;
+  _path_request = nullptr;
+  if(!request->is_ready() || request->get_grid() != _path_finder_obj->_nav_grid) {
+    // It was cancelled, or the mesh has been replaced since.
+    return false;
+  }
+
+  _ai_char->_steering->_path_follow_obj->_path.clear();
+  clear_path();
+  if(_path_finder_obj->set_path(request->get_path()->get_path())) {
+    trace_path(_path_finder_obj->_src_node);
   }
+  return true;
+}
 
+/**
+ * Helper function to restore the path and mesh to its initial state
+ */
+void PathFind::clear_path() {
+  // The search state doesn't need to be reset on the nodes; the PathFinder
+  // keeps its own, and knows which of it is left over from the last search.
   if(_path_finder_obj) {
-    _path_finder_obj->_open_list.clear();
-    _path_finder_obj->_closed_list.clear();
+    _path_finder_obj->_path.clear();
   }
 }
 
@@ -312,18 +358,18 @@ void PathFind::trace_path(Node* src) {
       _parent->remove_all_children();
     }
 
-    if(_path_finder_obj->_closed_list.size() > 0) {
-      Node *traversor = _path_finder_obj->_closed_list[_path_finder_obj->_closed_list.size() - 0.5];
-      while(traversor != src) {
-        if(_ai_char->_pf_guide) {
-          _pen->move_to(traversor->_position.get_x(), traversor->_position.get_y(), 1);
-          _pen->draw_to(traversor->_prv_node->_position.get_x(), traversor->_prv_node->_position.get_y(), 0.5);
-          PT(GeomNode) gnode = _pen->create();
-          _parent->add_child(gnode);
-        }
-        _ai_char->_steering->add_to_path(traversor->_position);
-        traversor = traversor->_prv_node;
+    // The path runs from the destination back to the source.
+    const std::vector<Node*> &path = _path_finder_obj->_path;
+    for(size_t i = 0; i < path.size(); ++i) {
+      Node *traversor = path[i];
+      Node *prv_node = (i + 1 < path.size()) ? path[i + 1] : src;
+      if(_ai_char->_pf_guide) {
+        _pen->move_to(traversor->_position.get_x(), traversor->_position.get_y(), 1);
+        _pen->draw_to(prv_node->_position.get_x(), prv_node->_position.get_y(), 0.5);
+        PT(GeomNode) gnode = _pen->create();
+        _parent->add_child(gnode);
       }
+      _ai_char->_steering->add_to_path(traversor->_position);
     }
 }
 
@@ -334,10 +380,35 @@ void PathFind::trace_path(Node* src) {
  * pathfinding algorithm.
  */
 void PathFind::add_obstacle_to_mesh(NodePath obstacle) {
+  std::vector<int> covered;
+  find_obstacle_nodes(obstacle, covered, std::vector<int>());
+
+  for(size_t k = 0; k < covered.size(); ++k) {
+    int i = covered[k] / _grid_size;
+    int j = covered[k] % _grid_size;
+    set_walkable(_nav_mesh[i][j], false);
+    _previous_obstacles.insert(_previous_obstacles.end(), i);
+    _previous_obstacles.insert(_previous_obstacles.end(), j);
+  }
+}
+
+/**
+ * Helper function that adds the walkable nodes within the bounding volume of
+ * the obstacle to the list, as i * _grid_size + j for _nav_mesh[i][j].  The
+ * nodes in the sorted ignored_obstacles list are treated as walkable, too.
+ */
+void PathFind::find_obstacle_nodes(NodePath obstacle, std::vector<int> &nodes,
+                                   const std::vector<int> &ignored_obstacles) {
   PT(BoundingVolume) np_bounds = obstacle.get_bounds();
   CPT(BoundingSphere) np_sphere = np_bounds->as_bounding_sphere();
 
-  Node* temp = find_in_mesh(_nav_mesh, obstacle.get_pos(), _grid_size);
+  Node* temp;
+  if(_path_finder_obj) {
+    temp = _path_finder_obj->find_node(obstacle.get_pos());
+  }
+  else {
+    temp = find_in_mesh(_nav_mesh, obstacle.get_pos(), _grid_size);
+  }
 
   if(temp != nullptr) {
     float left = temp->_position.get_x() - np_sphere->get_radius();
@@ -347,12 +418,13 @@ void PathFind::add_obstacle_to_mesh(NodePath obstacle) {
 
     for(int i = 0; i < _grid_size; ++i) {
         for(int j = 0; j < _grid_size; ++j) {
-          if(_nav_mesh[i][j] != nullptr && _nav_mesh[i][j]->_type == true) {
-            if(_nav_mesh[i][j]->_position.get_x() >= left && _nav_mesh[i][j]->_position.get_x() <= right &&
-               _nav_mesh[i][j]->_position.get_y() >= down && _nav_mesh[i][j]->_position.get_y() <= top) {
-              _nav_mesh[i][j]->_type = false;
-              _previous_obstacles.insert(_previous_obstacles.end(), i);
-              _previous_obstacles.insert(_previous_obstacles.end(), j);
+          Node *nd = _nav_mesh[i][j];
+          int key = i * _grid_size + j;
+          if(nd != nullptr && (nd->_type == true ||
+             std::binary_search(ignored_obstacles.begin(), ignored_obstacles.end(), key))) {
+            if(nd->_position.get_x() >= left && nd->_position.get_x() <= right &&
+               nd->_position.get_y() >= down && nd->_position.get_y() <= top) {
+              nodes.push_back(key);
             }
           }
         }
@@ -362,13 +434,55 @@ void PathFind::add_obstacle_to_mesh(NodePath obstacle) {
 
 /**
  * This function does the updation of the collisions to the mesh based on the
- * new positions of the obstacles.
+ * new positions of the obstacles.  Only the nodes that the obstacles have
+ * moved on to or off of are changed, all at once, so that the paths found so
+ * far are not forgotten if the obstacles haven't moved.
  */
 void PathFind::do_dynamic_avoid() {
-  clear_previous_obstacles();
-  _previous_obstacles.clear();
+  std::vector<int> previous;
+  for(unsigned int i = 0; i < _previous_obstacles.size(); i = i + 2) {
+    previous.push_back(_previous_obstacles[i] * _grid_size + _previous_obstacles[i + 1]);
+  }
+  std::sort(previous.begin(), previous.end());
+  previous.erase(std::unique(previous.begin(), previous.end()), previous.end());
+
+  std::vector<int> current;
   for(unsigned int i = 0; i < _dynamic_obstacle.size(); ++i) {
-    add_obstacle_to_mesh(_dynamic_obstacle[i]);
+    find_obstacle_nodes(_dynamic_obstacle[i], current, previous);
+  }
+  std::sort(current.begin(), current.end());
+  current.erase(std::unique(current.begin(), current.end()), current.end());
+
+  std::vector<int> cleared_keys, blocked_keys;
+  std::set_difference(previous.begin(), previous.end(), current.begin(), current.end(),
+                      std::back_inserter(cleared_keys));
+  std::set_difference(current.begin(), current.end(), previous.begin(), previous.end(),
+                      std::back_inserter(blocked_keys));
+
+  std::vector<Node*> cleared, blocked;
+  for(int key : cleared_keys) {
+    cleared.push_back(_nav_mesh[key / _grid_size][key % _grid_size]);
+  }
+  for(int key : blocked_keys) {
+    blocked.push_back(_nav_mesh[key / _grid_size][key % _grid_size]);
+  }
+
+  if(_path_finder_obj) {
+    _path_finder_obj->move_obstacles(cleared, blocked);
+  }
+  else {
+    for(Node *nd : cleared) {
+      nd->_type = true;
+    }
+    for(Node *nd : blocked) {
+      nd->_type = false;
+    }
+  }
+
+  _previous_obstacles.clear();
+  for(int key : current) {
+    _previous_obstacles.insert(_previous_obstacles.end(), key / _grid_size);
+    _previous_obstacles.insert(_previous_obstacles.end(), key % _grid_size);
   }
 }
 
@@ -378,7 +492,20 @@ void PathFind::do_dynamic_avoid() {
  */
 void PathFind::clear_previous_obstacles(){
   for(unsigned int i = 0; i < _previous_obstacles.size(); i = i + 2) {
-      _nav_mesh[_previous_obstacles[i]][_previous_obstacles[i + 1]]->_type = true;
+      set_walkable(_nav_mesh[_previous_obstacles[i]][_previous_obstacles[i + 1]], true);
+  }
+}
+
+/**
+ * Helper function to mark a node as an obstacle or not, in the mesh as well as
+ * in the PathFinder's copy of it.
+ */
+void PathFind::set_walkable(Node *nd, bool walkable) {
+  if(_path_finder_obj) {
+    _path_finder_obj->set_walkable(nd, walkable);
+  }
+  else {
+    nd->_type = walkable;
   }
 }
 
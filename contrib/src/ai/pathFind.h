@@ -17,6 +17,7 @@
 #include "aiGlobals.h"
 #include "aiCharacter.h"
 #include "aiPathFinder.h"
+#include "aiPathRequest.h"
 #include "boundingSphere.h"
 
 class AICharacter;
@@ -43,6 +44,7 @@ public:
   std::vector<int> _previous_obstacles;
   bool _dynamic_avoid;
   std::vector<NodePath> _dynamic_obstacle;
+  PT(AIPathRequest) _path_request;
 
   PathFind(AICharacter *ai_ch);
   ~PathFind();
@@ -52,12 +54,17 @@ public:
 
   void create_nav_mesh(const char* navmesh_filename);
   void assign_neighbor_nodes(const char* navmesh_filename);
+  void find_obstacle_nodes(NodePath obstacle, std::vector<int> &nodes,
+                           const std::vector<int> &ignored_obstacles);
   void do_dynamic_avoid();
   void clear_previous_obstacles();
+  void set_walkable(Node *nd, bool walkable);
 
   void set_path_find(const char* navmesh_filename);
   void path_find(LVecBase3 pos, std::string type = "normal");
   void path_find(NodePath target, std::string type = "normal");
+  void path_find_async(NodePath target);
+  bool finish_path_request();
   void add_obstacle_to_mesh(NodePath obstacle);
   void dynamic_avoid(NodePath obstacle);
 };
@@ -58,44 +58,30 @@ void PathFollow::start(std::string type) {
  * other ai chars.  More computationally expensive.
  */
 void PathFollow::do_follow() {
+  PathFind *path_find = _ai_char->_steering->_path_find_obj;
+  if(path_find != nullptr && path_find->finish_path_request()) {
+    // A path asked for earlier has been found.
+    restart_path();
+  }
+
   if((_myClock->get_real_time() - _time) > 0.5) {
       if(_type=="pathfind") {
       // This 'if' statement when 'true' causes the path to be re-calculated
       // irrespective of target position.  This is done when _dynamice_avoid
       // is active.  More computationally expensive.
-      if(_ai_char->_steering->_path_find_obj->_dynamic_avoid) {
-        _ai_char->_steering->_path_find_obj->do_dynamic_avoid();
+      if(path_find->_dynamic_avoid) {
+        path_find->do_dynamic_avoid();
         if(check_if_possible()) {
-          _path.clear();
-          _ai_char->_steering->_path_find_obj->path_find(_ai_char->_steering->_path_find_obj->_path_find_target);
-          // Ensure that the path size is not 0.
-          if(_path.size() > 0) {
-            _curr_path_waypoint = _path.size() - 1;
-            _dummy.set_pos(_path[_curr_path_waypoint]);
-          }
-          else {
-          // Refresh the _curr_path_waypoint value if path size is <= 0.
-          _curr_path_waypoint = -1;
-          }
+          find_new_path();
         }
       }
       // This 'if' statement causes the path to be re-calculated only when
       // there is a change in target position.  Less computationally
       // expensive.
-      else if(_ai_char->_steering->_path_find_obj->_path_find_target.get_pos(_ai_char->_window_render)
-        != _ai_char->_steering->_path_find_obj->_prev_position) {
+      else if(path_find->_path_find_target.get_pos(_ai_char->_window_render)
+        != path_find->_prev_position) {
         if(check_if_possible()) {
-          _path.clear();
-          _ai_char->_steering->_path_find_obj->path_find(_ai_char->_steering->_path_find_obj->_path_find_target);
-          // Ensure that the path size is not 0.
-          if(_path.size() > 0) {
-            _curr_path_waypoint = _path.size() - 1;
-            _dummy.set_pos(_path[_curr_path_waypoint]);
-          }
-          else {
-            // Refresh the _curr_path_waypoint value if path size is 0.
-            _curr_path_waypoint = -1;
-          }
+          find_new_path();
         }
       }
       _time = _myClock->get_real_time();
@@ -112,14 +98,49 @@ void PathFollow::do_follow() {
   }
 }
 
+/**
+ * This function re-calculates the path to the pathfinding target.  If the
+ * character is in an AIWorld, the path is found on one of the world's threads
+ * and picked up by a later do_follow(); the character keeps following the old
+ * path until then.
+ */
+void PathFollow::find_new_path() {
+  PathFind *path_find = _ai_char->_steering->_path_find_obj;
+  if(_ai_char->_world != nullptr) {
+    path_find->path_find_async(path_find->_path_find_target);
+  }
+  else {
+    _path.clear();
+    path_find->path_find(path_find->_path_find_target);
+    restart_path();
+  }
+}
+
+/**
+ * This function starts again from the beginning of the path, after it has
+ * been replaced.
+ */
+void PathFollow::restart_path() {
+  // Ensure that the path size is not 0.
+  if(_path.size() > 0) {
+    _curr_path_waypoint = _path.size() - 1;
+    _dummy.set_pos(_path[_curr_path_waypoint]);
+  }
+  else {
+    // Refresh the _curr_path_waypoint value if path size is 0.
+    _curr_path_waypoint = -1;
+  }
+}
+
 /**
  * This function checks if the current positions of the ai char and the target
  * char can be used to generate an optimal path.
  */
 bool PathFollow::check_if_possible() {
-  Node* src = find_in_mesh(_ai_char->_steering->_path_find_obj->_nav_mesh, _ai_char->_ai_char_np.get_pos(_ai_char->_window_render), _ai_char->_steering->_path_find_obj->_grid_size);
+  PathFinder *path_finder = _ai_char->_steering->_path_find_obj->_path_finder_obj;
+  Node* src = path_finder->find_node(_ai_char->_ai_char_np.get_pos(_ai_char->_window_render));
   LVecBase3 _prev_position = _ai_char->_steering->_path_find_obj->_path_find_target.get_pos(_ai_char->_window_render);
-  Node* dst = find_in_mesh(_ai_char->_steering->_path_find_obj->_nav_mesh, _prev_position, _ai_char->_steering->_path_find_obj->_grid_size);
+  Node* dst = path_finder->find_node(_prev_position);
 
   if(src && dst) {
     return true;
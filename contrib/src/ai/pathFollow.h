@@ -26,6 +26,8 @@ public:
   void add_to_path(LVecBase3 pos);
   void start(std::string type);
   void do_follow();
+  void find_new_path();
+  void restart_path();
   bool check_if_possible();
 };
 
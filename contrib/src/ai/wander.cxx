@@ -24,11 +24,12 @@ double rand_float() {
 /**
  * This function returns a random floating point number in the range -1 to 1.
  */
-double random_clamped() {
-  return  (rand_float() - rand_float());
+static double random_clamped(Randomizer &random) {
+  return  (random.random_real_unit() - random.random_real_unit());
 }
 
-Wander::Wander(AICharacter *ai_ch, double wander_radius,int flag, double aoe, float wander_weight) {
+Wander::Wander(AICharacter *ai_ch, double wander_radius,int flag, double aoe, float wander_weight) :
+  _random(rand()) {
   _ai_char = ai_ch;
   _wander_radius = wander_radius ;
   _wander_weight = wander_weight;
@@ -77,9 +78,9 @@ LVecBase3 Wander::do_wander() {
   LVecBase3 present_pos = _ai_char->get_node_path().get_pos(_ai_char->get_char_render());
   // Create the random slices to enable random movement of wander for x,y,z
   // respectively
-  double time_slice_1 = random_clamped() * 1.5;
-  double time_slice_2 = random_clamped() * 1.5;
-  double time_slice_3 = random_clamped() * 1.5;
+  double time_slice_1 = random_clamped(_random) * 1.5;
+  double time_slice_2 = random_clamped(_random) * 1.5;
+  double time_slice_3 = random_clamped(_random) * 1.5;
   switch(_flag) {
   case 0: {
             _wander_target += LVecBase3(time_slice_1, time_slice_2, 0);
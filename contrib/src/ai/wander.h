@@ -15,6 +15,7 @@
 #define _WANDER_H
 
 #include "aiCharacter.h"
+#include "randomizer.h"
 
 class AICharacter;
 
@@ -28,6 +29,10 @@ class EXPCL_PANDAAI Wander {
     LVecBase3 _init_pos;
     double _area_of_effect;
 
+    // Each character has its own random numbers, so that characters may
+    // wander at the same time on different threads.
+    Randomizer _random;
+
     Wander(AICharacter *ai_ch, double wander_radius, int flag, double aoe, float wander_weight);
     LVecBase3 do_wander();
     ~Wander();
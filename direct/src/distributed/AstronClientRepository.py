@@ -127,6 +127,7 @@ class AstronClientRepository(ClientRepositoryBase):
             assert distObj.dclass == dclass
             # put it in the dictionary:
             self.doId2ownerView[doId] = distObj
+            self.addDOToNativeTable(distObj, ownerView=True)
             # and update it.
             distObj.generate()
             distObj.updateRequiredFields(dclass, di)
@@ -143,6 +144,7 @@ class AstronClientRepository(ClientRepositoryBase):
             distObj.doId = doId
             # Put the new do in the dictionary
             self.doId2ownerView[doId] = distObj
+            self.addDOToNativeTable(distObj, ownerView=True)
             # Update the required fields
             distObj.generateInit()  # Only called when constructed
             distObj.generate()
@@ -213,6 +215,7 @@ class AstronClientRepository(ClientRepositoryBase):
             obj = self.doId2do[doId]
             # Remove it from the dictionary
             del self.doId2do[doId]
+            self.removeDOFromNativeTable(doId)
             # Disable, announce, and delete the object itself...
             # unless delayDelete is on...
             obj.deleteOrDelay()
@@ -216,6 +216,7 @@ class AsyncRequest(DirectObject):
             # here and again later when it was noticed the doId was not in
             # the doId2do list yet.
             self.air.doId2do.pop(doId, None)
+            self.air.removeDOFromNativeTable(doId)
         self._checkCompletion(name, None, distObj)
 
     def _checkCompletion(self, name, context, distObj):
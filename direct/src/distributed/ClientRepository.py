@@ -225,6 +225,7 @@ class ClientRepository(ClientRepositoryBase):
         distObj.dclass = dclass
         distObj.doId = doId
         self.doId2do[doId] = distObj
+        self.addDOToNativeTable(distObj)
         distObj.generateInit()
         distObj._retrieveCachedData()
         distObj.generate()
@@ -390,6 +391,7 @@ class ClientRepository(ClientRepositoryBase):
             obj = self.doId2do[doId]
             # Remove it from the dictionary
             del self.doId2do[doId]
+            self.removeDOFromNativeTable(doId)
             # Disable, announce, and delete the object itself...
             # unless delayDelete is on...
             obj.deleteOrDelay()
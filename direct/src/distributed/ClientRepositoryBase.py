@@ -242,6 +242,7 @@ class ClientRepositoryBase(ConnectionRepository):
             assert distObj.dclass == dclass
             # put it in the dictionary:
             self.doId2do[doId] = distObj
+            self.addDOToNativeTable(distObj)
             # and update it.
             distObj.generate()
             # make sure we don't have a stale location
@@ -262,6 +263,7 @@ class ClientRepositoryBase(ConnectionRepository):
             distObj.doId = doId
             # Put the new do in the dictionary
             self.doId2do[doId] = distObj
+            self.addDOToNativeTable(distObj)
             # Update the required fields
             distObj.generateInit()  # Only called when constructed
             distObj._retrieveCachedData()
@@ -290,6 +292,7 @@ class ClientRepositoryBase(ConnectionRepository):
             assert distObj.dclass == dclass
             # put it in the dictionary:
             self.doId2do[doId] = distObj
+            self.addDOToNativeTable(distObj)
             # and update it.
             distObj.generate()
             # make sure we don't have a stale location
@@ -310,6 +313,7 @@ class ClientRepositoryBase(ConnectionRepository):
             distObj.doId = doId
             # Put the new do in the dictionary
             self.doId2do[doId] = distObj
+            self.addDOToNativeTable(distObj)
             # Update the required fields
             distObj.generateInit()  # Only called when constructed
             distObj._retrieveCachedData()
@@ -337,6 +341,7 @@ class ClientRepositoryBase(ConnectionRepository):
             assert distObj.dclass == dclass
             # put it in the dictionary:
             self.doId2ownerView[doId] = distObj
+            self.addDOToNativeTable(distObj, ownerView=True)
             # and update it.
             distObj.generate()
             distObj.updateRequiredOtherFields(dclass, di)
@@ -353,6 +358,7 @@ class ClientRepositoryBase(ConnectionRepository):
             distObj.doId = doId
             # Put the new do in the dictionary
             self.doId2ownerView[doId] = distObj
+            self.addDOToNativeTable(distObj, ownerView=True)
             # Update the required fields
             distObj.generateInit()  # Only called when constructed
             distObj.generate()
@@ -368,6 +374,7 @@ class ClientRepositoryBase(ConnectionRepository):
             distObj = table[doId]
             # remove the object from the dictionary
             del table[doId]
+            self.removeDOFromNativeTable(doId, ownerView)
 
             # Only cache the object if it is a "cacheable" type
             # object; this way we don't clutter up the caches with
@@ -196,6 +196,7 @@ class ConnectionRepository(
         distObj.doId = doId
         # Put the new do in the dictionary
         self.doId2do[doId] = distObj
+        self.addDOToNativeTable(distObj)
         # Update the required fields
         distObj.generateInit()  # Only called when constructed
         distObj.generate()
@@ -143,6 +143,10 @@ class DistributedObject(DistributedObjectBase):
     def setNeverDisable(self, boolean):
         assert boolean == 1 or boolean == 0
         self.neverDisable = boolean
+        # Keep the flag in the C++ repository's table up to date.
+        doId = getattr(self, 'doId', None)
+        if self.cr and doId is not None and self.cr.doId2do.get(doId) is self:
+            self.cr.addDOToNativeTable(self)
 
     def getNeverDisable(self):
         return self.neverDisable
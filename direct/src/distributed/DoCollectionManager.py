@@ -266,6 +266,8 @@ class DoCollectionManager:
         # Get rid of all the distributed objects
         for do in list(self.doId2do.values()):
             self.deleteDistObject(do)
+        if hasattr(self, 'clearRegisteredDos'):
+            self.clearRegisteredDos()
 
         # Get rid of everything that manages distributed objects
         self.deleteObjects()
@@ -387,6 +389,7 @@ class DoCollectionManager:
                 doTable[do.doId].__class__.__name__))
 
         doTable[do.doId]=do
+        self.addDOToNativeTable(do, ownerView)
 
         if not ownerView:
             if self.isValidLocationTuple(location):
@@ -428,8 +431,38 @@ class DoCollectionManager:
         ##         if len(self.zoneId2doIds[location]) == 0:
         ##             del self.zoneId2doIds[location]
         if do.doId in self.doId2do:
+            # Leave the native table alone if it's since been taken over by
+            # another object with the same doId.
+            if self.doId2do[do.doId] is do:
+                self.removeDOFromNativeTable(do.doId)
             del self.doId2do[do.doId]
 
+    def addDOToNativeTable(self, do, ownerView=False):
+        """
+        Tells the C++ repository about the object, so that it can dispatch
+        field updates to it without looking it up in doId2do (or
+        doId2ownerView).  Call this whenever an object is put in one of
+        those tables directly, rather than through addDOToTables().
+        """
+        if not hasattr(self, 'registerDo'):
+            return
+        dclass = getattr(do, 'dclass', None)
+        if dclass is None:
+            return
+        flags = 0
+        if getattr(do, 'neverDisable', 0):
+            flags |= self.OFNeverDisable
+        self.registerDo(do.doId, do, dclass, flags, ownerView)
+
+    def removeDOFromNativeTable(self, doId, ownerView=False):
+        """
+        The counterpart of addDOToNativeTable().  This must be called
+        whenever an object is taken out of doId2do (or doId2ownerView),
+        or the C++ repository will keep sending it field updates.
+        """
+        if hasattr(self, 'unregisterDo'):
+            self.unregisterDo(doId, ownerView)
+
     ## def changeDOZoneInTables(self, do, newParentId, newZoneId, oldParentId, oldZoneId):
     ##     if 1:
     ##         self.storeObjectLocation(do.doId, newParentId, newZoneId)
@@ -38,6 +38,30 @@ const string CConnectionRepository::_overflow_event_name = "CRDatagramOverflow";
 PStatCollector CConnectionRepository::_update_pcollector("App:Tasks:readerPollTask:Update");
 #endif  // CPPPARSER
 
+#if defined(HAVE_PYTHON) && defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
+/**
+ * Holds the Python GIL for as long as it exists, if it was asked to.  Used by
+ * check_datagram() in batch update mode.
+ */
+class BatchGILHolder {
+public:
+  BatchGILHolder(bool hold) : _hold(hold) {
+    if (_hold) {
+      _gstate = PyGILState_Ensure();
+    }
+  }
+  ~BatchGILHolder() {
+    if (_hold) {
+      PyGILState_Release(_gstate);
+    }
+  }
+
+private:
+  bool _hold;
+  PyGILState_STATE _gstate;
+};
+#endif
+
 /**
  *
  */
@@ -65,6 +89,7 @@ CConnectionRepository(bool has_owner_view, bool threaded_net) :
   _simulated_disconnect(false),
   _verbose(distributed_cat.is_spam()),
   _in_quiet_zone(0),
+  _batch_updates(batch_datagram_updates),
   _time_warning(0.0),
   _msg_sender(0),
   _msg_type(0),
@@ -85,6 +110,9 @@ CConnectionRepository(bool has_owner_view, bool threaded_net) :
 CConnectionRepository::
 ~CConnectionRepository() {
   disconnect();
+#ifdef HAVE_PYTHON
+  clear_registered_dos();
+#endif
 }
 
 /**
@@ -109,6 +137,127 @@ set_tcp_header_size(int tcp_header_size) {
 #endif
 }
 
+#ifdef HAVE_PYTHON
+/**
+ * Tells the repository about a distributed object, so that field updates for
+ * it can be dispatched without looking it up in the Python repository's
+ * doId2do (or doId2ownerView) table.  This is normally called by the
+ * DoCollectionManager whenever it adds an object to one of those tables.
+ * flags is the union of ObjectFlags that apply to the object.
+ *
+ * Replaces any object previously registered with the same doId.  Objects
+ * that are not registered are still found through the Python tables, just
+ * more slowly.
+ */
+void CConnectionRepository::
+register_do(unsigned int do_id, PyObject *distobj, DCClass *dclass,
+            int flags, bool owner_view) {
+  ReMutexHolder holder(_lock);
+  nassertv(distobj != nullptr && dclass != nullptr);
+
+#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
+  PyGILState_STATE gstate;
+  gstate = PyGILState_Ensure();
+#endif
+
+  RegisteredDos &table = owner_view ? _registered_owner_views : _registered_dos;
+  RegisteredDo entry;
+  entry._distobj = distobj;
+  entry._dclass = dclass;
+  entry._flags = flags;
+  Py_INCREF(distobj);
+
+  PyObject *old_distobj = nullptr;
+  std::pair<RegisteredDos::iterator, bool> result =
+    table.insert(RegisteredDos::value_type(do_id, entry));
+  if (!result.second) {
+    old_distobj = (*result.first).second._distobj;
+    (*result.first).second = entry;
+  }
+
+  // Do this last, since it may run arbitrary code.
+  Py_XDECREF(old_distobj);
+
+#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
+  PyGILState_Release(gstate);
+#endif
+}
+
+/**
+ * Forgets a distributed object previously passed to register_do().  This must
+ * be called when the object is removed from the corresponding Python table,
+ * or it will go on receiving updates.
+ */
+void CConnectionRepository::
+unregister_do(unsigned int do_id, bool owner_view) {
+  ReMutexHolder holder(_lock);
+
+  RegisteredDos &table = owner_view ? _registered_owner_views : _registered_dos;
+  RegisteredDos::iterator ri = table.find(do_id);
+  if (ri == table.end()) {
+    return;
+  }
+
+  PyObject *distobj = (*ri).second._distobj;
+  table.erase(ri);
+
+#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
+  PyGILState_STATE gstate;
+  gstate = PyGILState_Ensure();
+#endif
+
+  Py_DECREF(distobj);
+
+#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
+  PyGILState_Release(gstate);
+#endif
+}
+
+/**
+ * Forgets all of the distributed objects passed to register_do().
+ */
+void CConnectionRepository::
+clear_registered_dos() {
+  ReMutexHolder holder(_lock);
+
+  if (_registered_dos.empty() && _registered_owner_views.empty()) {
+    return;
+  }
+
+  // Empty the tables before letting go of the objects, in case releasing one
+  // of them calls back into this repository.
+  RegisteredDos dos, owner_views;
+  dos.swap(_registered_dos);
+  owner_views.swap(_registered_owner_views);
+
+#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
+  PyGILState_STATE gstate;
+  gstate = PyGILState_Ensure();
+#endif
+
+  for (const RegisteredDos::value_type &item : dos) {
+    Py_DECREF(item.second._distobj);
+  }
+  for (const RegisteredDos::value_type &item : owner_views) {
+    Py_DECREF(item.second._distobj);
+  }
+
+#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
+  PyGILState_Release(gstate);
+#endif
+}
+
+/**
+ * Returns the number of distributed objects currently registered with
+ * register_do(), either for the visible views or for the owner views.
+ */
+size_t CConnectionRepository::
+get_num_registered_dos(bool owner_view) const {
+  ReMutexHolder holder(_lock);
+  return owner_view ? _registered_owner_views.size() : _registered_dos.size();
+}
+#endif  // HAVE_PYTHON
+
 #ifdef HAVE_OPENSSL
 /**
  * Once a connection has been established via the HTTP interface, gets the
@@ -260,6 +409,12 @@ check_datagram() {
     _bdc.Flush();
   #endif //WANT_NATIVE_NET
 
+#if defined(HAVE_PYTHON) && defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
+  // In batch mode, we take the GIL once for the whole loop, so that the
+  // PyGILState_Ensure() calls made for each update below are nearly free.
+  BatchGILHolder gil(_batch_updates && _python_repository != nullptr);
+#endif
+
   while (do_check_datagram()) {
     if (get_verbose()) {
       describe_message(nout, "RECV", _dg);
@@ -665,6 +820,76 @@ do_check_datagram() {
   return false;
 }
 
+#ifdef HAVE_PYTHON
+/**
+ * Looks up the distributed object with the indicated doId, first among the
+ * objects passed to register_do(), then in the Python repository's doId2do
+ * (or doId2ownerView) table.  Returns a new reference to the object and fills
+ * in its dclass and flags, or returns nullptr if there is no such object.
+ *
+ * For an unregistered object, OF_never_disable is only looked up when in
+ * quiet zone mode.  Assumes the GIL is held.
+ */
+PyObject *CConnectionRepository::
+find_do(unsigned int do_id, bool owner_view, DCClass *&dclass, int &flags) const {
+  const RegisteredDos &table = owner_view ? _registered_owner_views : _registered_dos;
+  RegisteredDos::const_iterator ri = table.find(do_id);
+  if (ri != table.end()) {
+    const RegisteredDo &entry = (*ri).second;
+    dclass = entry._dclass;
+    flags = entry._flags;
+    Py_INCREF(entry._distobj);
+    return entry._distobj;
+  }
+
+  PyObject *doTable =
+    PyObject_GetAttrString(_python_repository, owner_view ? "doId2ownerView" : "doId2do");
+  nassertr(doTable != nullptr, nullptr);
+
+  PyObject *doId = PyLong_FromUnsignedLong(do_id);
+  PyObject *distobj;
+  int result = PyDict_GetItemRef(doTable, doId, &distobj);
+  Py_DECREF(doId);
+  Py_DECREF(doTable);
+
+  if (result <= 0) {
+    return nullptr;
+  }
+
+  PyObject *dclass_obj = PyObject_GetAttrString(distobj, "dclass");
+  nassertd(dclass_obj != nullptr) {
+    Py_DECREF(distobj);
+    return nullptr;
+  }
+
+  PyObject *dclass_this = PyObject_GetAttrString(dclass_obj, "this");
+  Py_DECREF(dclass_obj);
+  nassertd(dclass_this != nullptr) {
+    Py_DECREF(distobj);
+    return nullptr;
+  }
+
+  dclass = (DCClass *)PyLong_AsVoidPtr(dclass_this);
+  Py_DECREF(dclass_this);
+
+  flags = 0;
+  if (_in_quiet_zone && !owner_view) {
+    PyObject *neverDisable = PyObject_GetAttrString(distobj, "neverDisable");
+    nassertd(neverDisable != nullptr) {
+      Py_DECREF(distobj);
+      return nullptr;
+    }
+
+    if (PyLong_AsLong(neverDisable) != 0) {
+      flags |= OF_never_disable;
+    }
+    Py_DECREF(neverDisable);
+  }
+
+  return distobj;
+}
+#endif  // HAVE_PYTHON
+
 /**
  * Directly handles an update message on a field.  Python never touches the
  * datagram; it just gets its distributed method called with the appropriate
@@ -681,67 +906,29 @@ handle_update_field() {
 
   PStatTimer timer(_update_pcollector);
   unsigned int do_id = _di.get_uint32();
-  if (_python_repository != nullptr)
-  {
-    PyObject *doId2do =
-      PyObject_GetAttrString(_python_repository, "doId2do");
-    nassertr(doId2do != nullptr, false);
-
-    PyObject *doId = PyLong_FromUnsignedLong(do_id);
-    PyObject *distobj;
-    int result = PyDict_GetItemRef(doId2do, doId, &distobj);
-    Py_DECREF(doId);
-    Py_DECREF(doId2do);
-
-    if (result > 0) {
-      PyObject *dclass_obj = PyObject_GetAttrString(distobj, "dclass");
-      nassertr(dclass_obj != nullptr, false);
-
-
-      PyObject *dclass_this = PyObject_GetAttrString(dclass_obj, "this");
-      Py_DECREF(dclass_obj);
-      nassertr(dclass_this != nullptr, false);
-
-      DCClass *dclass = (DCClass *)PyLong_AsVoidPtr(dclass_this);
-      Py_DECREF(dclass_this);
-
-      // If in quiet zone mode, throw update away unless distobj has
-      // 'neverDisable' attribute set to non-zero
-      if (_in_quiet_zone) {
-        PyObject *neverDisable = PyObject_GetAttrString(distobj, "neverDisable");
-        nassertr(neverDisable != nullptr, false);
-
-        unsigned int cNeverDisable = PyLong_AsLong(neverDisable);
-        Py_DECREF(neverDisable);
-        if (!cNeverDisable) {
-          // in quiet zone and distobj is disable-able drop update on the
-          // floor
-          Py_DECREF(distobj);
-#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
-          PyGILState_Release(gstate);
-#endif
-          return true;
-        }
-      }
-
+  bool okflag = true;
+  if (_python_repository != nullptr) {
+    DCClass *dclass;
+    int flags;
+    PyObject *distobj = find_do(do_id, false, dclass, flags);
+
+    // If in quiet zone mode, throw update away unless distobj has
+    // 'neverDisable' attribute set to non-zero
+    if (distobj != nullptr &&
+        (!_in_quiet_zone || (flags & OF_never_disable) != 0)) {
       invoke_extension(dclass).receive_update(distobj, _di);
-      Py_DECREF(distobj);
-
-      if (PyErr_Occurred()) {
-#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
-        PyGILState_Release(gstate);
-#endif
-        return false;
-      }
+      okflag = (PyErr_Occurred() == nullptr);
     }
-
+    Py_XDECREF(distobj);
   }
 
 #if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
   PyGILState_Release(gstate);
 #endif
-  #endif  // HAVE_PYTHON
+  return okflag;
+#else
   return true;
+#endif  // HAVE_PYTHON
 }
 
 
@@ -763,101 +950,45 @@ handle_update_field_owner() {
 
   PStatTimer timer(_update_pcollector);
   unsigned int do_id = _di.get_uint32();
+  bool okflag = true;
   if (_python_repository != nullptr) {
-    PyObject *doId2do =
-      PyObject_GetAttrString(_python_repository, "doId2do");
-    nassertr(doId2do != nullptr, false);
-
-    PyObject *doId2ownerView =
-      PyObject_GetAttrString(_python_repository, "doId2ownerView");
-    nassertr(doId2ownerView != nullptr, false);
-
-    PyObject *doId = PyLong_FromUnsignedLong(do_id);
+    DCClass *dclass;
+    int flags;
 
     // pass the update to the owner view first
-    PyObject *distobjOV;
-    int result = PyDict_GetItemRef(doId2ownerView, doId, &distobjOV);
-    Py_DECREF(doId2ownerView);
-
-    if (result > 0) {
-      PyObject *dclass_obj = PyObject_GetAttrString(distobjOV, "dclass");
-      nassertr(dclass_obj != nullptr, false);
-
-      PyObject *dclass_this = PyObject_GetAttrString(dclass_obj, "this");
-      Py_DECREF(dclass_obj);
-      nassertr(dclass_this != nullptr, false);
-
-      DCClass *dclass = (DCClass *)PyLong_AsVoidPtr(dclass_this);
-      Py_DECREF(dclass_this);
-
-      // check if we should forward this update to the owner view
-      vector_uchar data = _di.get_remaining_bytes();
-      DCPacker packer;
-      packer.set_unpack_data((const char *)data.data(), data.size(), false);
-      int field_id = packer.raw_unpack_uint16();
+    PyObject *distobjOV = find_do(do_id, true, dclass, flags);
+    if (distobjOV != nullptr) {
+      // check if we should forward this update to the owner view.  Make a
+      // copy of the datagram iterator so that we can use the main iterator
+      // for the non-owner update.
+      DatagramIterator odi(_di);
+      int field_id = DatagramIterator(odi).get_uint16();
       DCField *field = dclass->get_field_by_index(field_id);
-      if (field->is_ownrecv()) {
-        // make a copy of the datagram iterator so that we can use the main
-        // iterator for the non-owner update
-        DatagramIterator _odi(_di);
-        invoke_extension(dclass).receive_update(distobjOV, _odi);
-
-        if (PyErr_Occurred()) {
-          Py_DECREF(distobjOV);
-#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
-          PyGILState_Release(gstate);
-#endif
-          return false;
-        }
+      if (field != nullptr && field->is_ownrecv()) {
+        invoke_extension(dclass).receive_update(distobjOV, odi);
+        okflag = (PyErr_Occurred() == nullptr);
       }
       Py_DECREF(distobjOV);
     }
 
     // now pass the update to the visible view
-    PyObject *distobj;
-    result = PyDict_GetItemRef(doId2do, doId, &distobj);
-    Py_DECREF(doId);
-    Py_DECREF(doId2do);
-
-    if (result > 0) {
-      PyObject *dclass_obj = PyObject_GetAttrString(distobj, "dclass");
-      nassertr(dclass_obj != nullptr, false);
-
-      PyObject *dclass_this = PyObject_GetAttrString(dclass_obj, "this");
-      Py_DECREF(dclass_obj);
-      nassertr(dclass_this != nullptr, false);
-
-      DCClass *dclass = (DCClass *)PyLong_AsVoidPtr(dclass_this);
-      Py_DECREF(dclass_this);
-
-      // check if we should forward this update to the owner view
-      vector_uchar data = _di.get_remaining_bytes();
-      DCPacker packer;
-      packer.set_unpack_data((const char *)data.data(), data.size(), false);
-
-      //int field_id = packer.raw_unpack_uint16();
-      //DCField *field = dclass->get_field_by_index(field_id);
-      if (true) {//field->is_broadcast()) {
+    if (okflag) {
+      PyObject *distobj = find_do(do_id, false, dclass, flags);
+      if (distobj != nullptr) {
         invoke_extension(dclass).receive_update(distobj, _di);
-
-        if (PyErr_Occurred()) {
-          Py_DECREF(distobj);
-#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
-          PyGILState_Release(gstate);
-#endif
-          return false;
-        }
+        okflag = (PyErr_Occurred() == nullptr);
+        Py_DECREF(distobj);
       }
-      Py_DECREF(distobj);
     }
   }
 
 #if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
   PyGILState_Release(gstate);
 #endif
-#endif  // HAVE_PYTHON
-
+  return okflag;
+#else
   return true;
+#endif  // HAVE_PYTHON
 }
 
 /**
@@ -943,27 +1074,11 @@ describe_message(std::ostream &out, const string &prefix,
       gstate = PyGILState_Ensure();
 #endif
 
-      PyObject *doId2do =
-        PyObject_GetAttrString(_python_repository, "doId2do");
-      nassertv(doId2do != nullptr);
-
-      PyObject *doId = PyLong_FromUnsignedLong(do_id);
-      PyObject *distobj;
-      int result = PyDict_GetItemRef(doId2do, doId, &distobj);
-      Py_DECREF(doId);
-      Py_DECREF(doId2do);
-
-      if (result > 0) {
-        PyObject *dclass_obj = PyObject_GetAttrString(distobj, "dclass");
-        Py_DECREF(distobj);
-        nassertv(dclass_obj != nullptr);
-
-        PyObject *dclass_this = PyObject_GetAttrString(dclass_obj, "this");
-        Py_DECREF(dclass_obj);
-        nassertv(dclass_this != nullptr);
-
-        dclass = (DCClass *)PyLong_AsVoidPtr(dclass_this);
-        Py_DECREF(dclass_this);
+      int flags;
+      PyObject *distobj = find_do(do_id, false, dclass, flags);
+      Py_XDECREF(distobj);
+      if (distobj == nullptr) {
+        dclass = nullptr;
       }
 
 #if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
@@ -25,6 +25,7 @@
 #include "clockObject.h"
 #include "reMutex.h"
 #include "reMutexHolder.h"
+#include "pmap.h"
 
 #ifdef HAVE_NET
 #include "queuedConnectionManager.h"
@@ -88,8 +89,22 @@ PUBLISHED:
 
 #ifdef HAVE_PYTHON
   INLINE void set_python_repository(PyObject *python_repository);
+
+  enum ObjectFlags {
+    OF_never_disable = 0x0001,
+  };
+
+  BLOCKING void register_do(unsigned int do_id, PyObject *distobj,
+                            DCClass *dclass, int flags = 0,
+                            bool owner_view = false);
+  BLOCKING void unregister_do(unsigned int do_id, bool owner_view = false);
+  BLOCKING void clear_registered_dos();
+  BLOCKING size_t get_num_registered_dos(bool owner_view = false) const;
 #endif
 
+  BLOCKING INLINE void set_batch_updates(bool flag);
+  BLOCKING INLINE bool get_batch_updates() const;
+
 #ifdef HAVE_OPENSSL
   BLOCKING void set_connection_http(HTTPChannel *channel);
   BLOCKING SocketStream *get_stream();
@@ -160,6 +175,10 @@ private:
   bool do_check_datagram();
   bool handle_update_field();
   bool handle_update_field_owner();
+#ifdef HAVE_PYTHON
+  PyObject *find_do(unsigned int do_id, bool owner_view,
+                    DCClass *&dclass, int &flags) const;
+#endif
 
   void describe_message(std::ostream &out, const std::string &prefix,
                         const Datagram &dg) const;
@@ -169,6 +188,19 @@ private:
 
 #ifdef HAVE_PYTHON
   PyObject *_python_repository;
+
+  // The objects handed to register_do(), so that field updates can be
+  // dispatched without looking anything up on the Python side.  Each entry
+  // holds a reference to its object.
+  class RegisteredDo {
+  public:
+    PyObject *_distobj;
+    DCClass *_dclass;
+    int _flags;
+  };
+  typedef pmap<unsigned int, RegisteredDo> RegisteredDos;
+  RegisteredDos _registered_dos;
+  RegisteredDos _registered_owner_views;
 #endif
 
 #ifdef HAVE_OPENSSL
@@ -196,6 +228,7 @@ private:
   bool _simulated_disconnect;
   bool _verbose;
   bool _in_quiet_zone;
+  bool _batch_updates;
   float _time_warning;
 
   Datagram _dg;
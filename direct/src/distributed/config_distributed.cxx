@@ -50,6 +50,14 @@ ConfigVariableBool handle_datagrams_internally
           "for performance reasons.  When it is false, all datagrams "
           "are handled by the Python implementation."));
 
+ConfigVariableBool batch_datagram_updates
+("batch-datagram-updates", false,
+ PRC_DESC("When this is true, the cConnectionRepository holds on to the "
+          "Python GIL while it handles all of the pending field updates, "
+          "rather than acquiring it once for each update.  This is faster "
+          "when many updates arrive at once, but other Python threads cannot "
+          "run in the meantime."));
+
 /**
  * Initializes the library.  This must be called at least once before any of
  * the functions or classes in this library can be used.  Normally it will be
@@ -27,6 +27,7 @@ extern EXPCL_DIRECT_DISTRIBUTED ConfigVariableInt game_server_timeout_ms;
 extern EXPCL_DIRECT_DISTRIBUTED ConfigVariableDouble min_lag;
 extern EXPCL_DIRECT_DISTRIBUTED ConfigVariableDouble max_lag;
 extern EXPCL_DIRECT_DISTRIBUTED ConfigVariableBool handle_datagrams_internally;
+extern EXPCL_DIRECT_DISTRIBUTED ConfigVariableBool batch_datagram_updates;
 
 extern EXPCL_DIRECT_DISTRIBUTED void init_libdistributed();
 
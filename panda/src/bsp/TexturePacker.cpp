@@ -2,6 +2,10 @@
 #include <assert.h>
 
 #include <cstdlib>
+#include <climits>
+#include <cmath>
+#include <algorithm>
+#include <vector>
 #include <iostream>
 #pragma warning(disable:4100 4244)
 
@@ -208,6 +212,7 @@ public:
                 mTotalArea = 0;
                 mTextureIndex = 0;
                 mFreeList = 0;
+                mEfficiency = 0.0f;
         }
         ~MyTexturePacker( void )
         {
@@ -253,7 +258,7 @@ public:
 
                 // Pack it
                 PackResult new_pack = tp->packTextures( forcePowerOfTwo, onePixelBorder );
-                delete ( tp );
+                releaseTexturePacker( tp );
 
                 return ( new_pack.get_width() <= max_wid && new_pack.get_height() <= max_hit );
         }
@@ -572,9 +577,16 @@ public:
                         height = nextPow2( height );
                 }
 
+                mEfficiency = ( width * height ) > 0 ? (float)mTotalArea / (float)( width * height ) : 0.0f;
+
                 return PackResult( width, height, ( width*height ) - mTotalArea );
         }
 
+        virtual float getPackingEfficiency( void )
+        {
+                return mEfficiency;
+        }
+
         bool mergeNodes( void )
         {
                 Node *f = mFreeList;
@@ -659,17 +671,547 @@ public:
         Texture *mTextures;
         int    mLongestEdge;
         int    mTotalArea;
+        float  mEfficiency;
+};
+
+
+/**
+ * Skyline bottom-left packer.
+ *
+ * The packed area is described by its "skyline": a list of horizontal
+ * segments sorted by x, each holding the height of the topmost texture
+ * below it.  A texture is placed at the segment position (in either
+ * orientation) that leaves its top edge lowest, then the skyline is raised
+ * over the width it covers.  Finding a spot only walks the skyline, which
+ * is much shorter than the list of placed textures, so it is cheap to keep
+ * one open and ask it whether more textures fit.
+ */
+class SkylineTexturePacker : public TexturePacker
+{
+public:
+        struct Rect
+        {
+                int mWidth;
+                int mHeight;
+                int mX;
+                int mY;
+                bool mFlipped;
+                bool mPlaced;
+        };
+
+        struct Segment
+        {
+                int mX;
+                int mY;
+                int mWidth;
+        };
+
+        struct Placement
+        {
+                int mSegment;
+                int mX;
+                int mY;
+                bool mFlipped;
+        };
+
+        SkylineTexturePacker( void )
+        {
+                reset();
+        }
+
+        void reset( void )
+        {
+                mTextures.clear();
+                mSkyline.clear();
+                mIncremental = false;
+                mBorder = false;
+                mBinWidth = 0;
+                mBinHeight = 0;
+                mTotalArea = 0;
+                mEfficiency = 0.0f;
+                mPendingValid = false;
+        }
+
+        virtual int getTextureCount( void )
+        {
+                return (int)mTextures.size();
+        }
+
+        virtual void setTextureCount( int tcount )
+        {
+                reset();
+                mTextures.reserve( tcount );
+        }
+
+        virtual void addTexture( int wid, int hit )
+        {
+                Rect r;
+                r.mWidth = wid;
+                r.mHeight = hit;
+                r.mX = 0;
+                r.mY = 0;
+                r.mFlipped = false;
+                r.mPlaced = false;
+                mTextures.push_back( r );
+                mTotalArea += wid * hit;
+        }
+
+        virtual void addNewTexture( int wid, int hit )
+        {
+                addTexture( wid, hit );
+
+                if ( !mIncremental )
+                {
+                        return;
+                }
+
+                // Use the spot found by the last fit query if it was for this texture.
+                Placement p;
+                bool found;
+                if ( mPendingValid && mPendingWidth == wid && mPendingHeight == hit )
+                {
+                        p = mPending;
+                        found = true;
+                }
+                else
+                {
+                        found = findPlacement( wid + border(), hit + border(), mBinWidth, mBinHeight, p );
+                }
+                mPendingValid = false;
+
+                if ( found )
+                {
+                        place( mTextures.back(), p );
+                }
+                else
+                {
+                        // Doesn't fit in the bin, we'll have to re-pack from scratch.
+                        mIncremental = false;
+                }
+        }
+
+        virtual bool wouldTextureFit( int wid, int hit,
+                                      bool forcePowerOfTwo, bool onePixelBorder,
+                                      int max_wid, int max_hit )
+        {
+                if ( forcePowerOfTwo )
+                {
+                        // The final size gets rounded up, so stay within the
+                        // largest power of two that is allowed.
+                        max_wid = prevPow2( max_wid );
+                        max_hit = prevPow2( max_hit );
+                }
+
+                if ( !mIncremental || mBinWidth != max_wid || mBinHeight != max_hit || mBorder != onePixelBorder )
+                {
+                        if ( !beginIncremental( max_wid, max_hit, onePixelBorder ) )
+                        {
+                                return false;
+                        }
+                }
+
+                mPendingValid = findPlacement( wid + border(), hit + border(), mBinWidth, mBinHeight, mPending );
+                mPendingWidth = wid;
+                mPendingHeight = hit;
+                return mPendingValid;
+        }
+
+        virtual PackResult packTextures( bool forcePowerOfTwo, bool onePixelBorder )
+        {
+                if ( !mIncremental || mBorder != onePixelBorder || !allPlaced() )
+                {
+                        fullPack( forcePowerOfTwo, onePixelBorder );
+                }
+
+                int width, height;
+                calcExtents( width, height );
+                if ( forcePowerOfTwo )
+                {
+                        width = nextPow2( width );
+                        height = nextPow2( height );
+                }
+
+                mEfficiency = ( width * height ) > 0 ? (float)mTotalArea / (float)( width * height ) : 0.0f;
+
+                return PackResult( width, height, ( width * height ) - mTotalArea );
+        }
+
+        virtual TextureLocation getTextureLocation( int index )
+        {
+                assert( index < getTextureCount() );
+                if ( index >= getTextureCount() )
+                {
+                        return TextureLocation( false, 0, 0, 0, 0 );
+                }
+
+                const Rect &r = mTextures[index];
+                int offset = mBorder ? 1 : 0;
+                if ( r.mFlipped )
+                {
+                        return TextureLocation( true, r.mX + offset, r.mY + offset, r.mHeight, r.mWidth );
+                }
+                return TextureLocation( false, r.mX + offset, r.mY + offset, r.mWidth, r.mHeight );
+        }
+
+        virtual float getPackingEfficiency( void )
+        {
+                return mEfficiency;
+        }
+
+private:
+        int border( void ) const
+        {
+                return mBorder ? 2 : 0;
+        }
+
+        int nextPow2( int v ) const
+        {
+                int p = 1;
+                while ( p < v )
+                {
+                        p = p * 2;
+                }
+                return p;
+        }
+
+        bool allPlaced( void ) const
+        {
+                for ( size_t i = 0; i < mTextures.size(); i++ )
+                {
+                        if ( !mTextures[i].mPlaced )
+                        {
+                                return false;
+                        }
+                }
+                return true;
+        }
+
+        int prevPow2( int v ) const
+        {
+                int p = 1;
+                while ( p * 2 <= v )
+                {
+                        p = p * 2;
+                }
+                return p;
+        }
+
+        void resetSkyline( int binWidth, int binHeight )
+        {
+                mBinWidth = binWidth;
+                mBinHeight = binHeight;
+                mSkyline.clear();
+                Segment seg;
+                seg.mX = 0;
+                seg.mY = 0;
+                seg.mWidth = binWidth;
+                mSkyline.push_back( seg );
+
+                for ( size_t i = 0; i < mTextures.size(); i++ )
+                {
+                        mTextures[i].mPlaced = false;
+                }
+        }
+
+        /**
+         * Returns the y at which a texture of the given width would rest if its
+         * left edge is at the start of the indicated segment, or -1 if it would
+         * hang off the right side of the bin.
+         */
+        int restingHeight( int segment, int wid ) const
+        {
+                const Segment &start = mSkyline[segment];
+                if ( start.mX + wid > mBinWidth )
+                {
+                        return -1;
+                }
+
+                int y = 0;
+                int widthLeft = wid;
+                for ( size_t i = segment; widthLeft > 0 && i < mSkyline.size(); i++ )
+                {
+                        y = std::max( y, mSkyline[i].mY );
+                        widthLeft -= mSkyline[i].mWidth;
+                }
+                return y;
+        }
+
+        bool findPlacement( int wid, int hit, int binWidth, int binHeight, Placement &p ) const
+        {
+                int bestTop = INT_MAX;
+                int bestX = INT_MAX;
+                bool found = false;
+
+                for ( size_t i = 0; i < mSkyline.size(); i++ )
+                {
+                        if ( mSkyline[i].mX + std::min( wid, hit ) > binWidth )
+                        {
+                                // Segments are sorted by x, nothing further along fits either.
+                                break;
+                        }
+
+                        for ( int flip = 0; flip < 2; flip++ )
+                        {
+                                int w = flip ? hit : wid;
+                                int h = flip ? wid : hit;
+                                if ( flip && w == h )
+                                {
+                                        continue;
+                                }
+
+                                int y = restingHeight( (int)i, w );
+                                if ( y < 0 || y + h > binHeight )
+                                {
+                                        continue;
+                                }
+
+                                int top = y + h;
+                                if ( top < bestTop || ( top == bestTop && mSkyline[i].mX < bestX ) )
+                                {
+                                        bestTop = top;
+                                        bestX = mSkyline[i].mX;
+                                        p.mSegment = (int)i;
+                                        p.mX = mSkyline[i].mX;
+                                        p.mY = y;
+                                        p.mFlipped = flip != 0;
+                                        found = true;
+                                }
+                        }
+                }
+
+                return found;
+        }
+
+        void place( Rect &r, const Placement &p )
+        {
+                int wid = ( p.mFlipped ? r.mHeight : r.mWidth ) + border();
+                int hit = ( p.mFlipped ? r.mWidth : r.mHeight ) + border();
+
+                r.mX = p.mX;
+                r.mY = p.mY;
+                r.mFlipped = p.mFlipped;
+                r.mPlaced = true;
+
+                // Raise the skyline over the new texture.
+                Segment seg;
+                seg.mX = p.mX;
+                seg.mY = p.mY + hit;
+                seg.mWidth = wid;
+                mSkyline.insert( mSkyline.begin() + p.mSegment, seg );
+
+                int right = p.mX + wid;
+                size_t i = p.mSegment + 1;
+                while ( i < mSkyline.size() && mSkyline[i].mX < right )
+                {
+                        int segRight = mSkyline[i].mX + mSkyline[i].mWidth;
+                        if ( segRight <= right )
+                        {
+                                mSkyline.erase( mSkyline.begin() + i );
+                        }
+                        else
+                        {
+                                mSkyline[i].mX = right;
+                                mSkyline[i].mWidth = segRight - right;
+                                break;
+                        }
+                }
+
+                // Merge neighbors at the same height.
+                for ( i = 0; i + 1 < mSkyline.size(); )
+                {
+                        if ( mSkyline[i].mY == mSkyline[i + 1].mY )
+                        {
+                                mSkyline[i].mWidth += mSkyline[i + 1].mWidth;
+                                mSkyline.erase( mSkyline.begin() + i + 1 );
+                        }
+                        else
+                        {
+                                i++;
+                        }
+                }
+        }
+
+        /**
+         * Places the textures in the indicated order into a bin of the given
+         * size.  Returns false if any of them did not fit.
+         */
+        bool packInto( const std::vector<int> &order, int binWidth, int binHeight )
+        {
+                resetSkyline( binWidth, binHeight );
+                for ( size_t i = 0; i < order.size(); i++ )
+                {
+                        Rect &r = mTextures[order[i]];
+                        Placement p;
+                        if ( !findPlacement( r.mWidth + border(), r.mHeight + border(), binWidth, binHeight, p ) )
+                        {
+                                return false;
+                        }
+                        place( r, p );
+                }
+                return true;
+        }
+
+        /**
+         * Returns the texture indices sorted by longest edge, then by area,
+         * largest first.
+         */
+        std::vector<int> sortedOrder( void ) const
+        {
+                std::vector<int> order( mTextures.size() );
+                for ( size_t i = 0; i < order.size(); i++ )
+                {
+                        order[i] = (int)i;
+                }
+
+                const std::vector<Rect> &textures = mTextures;
+                std::stable_sort( order.begin(), order.end(), [&textures]( int a, int b )
+                {
+                        const Rect &ra = textures[a];
+                        const Rect &rb = textures[b];
+                        int longA = std::max( ra.mWidth, ra.mHeight );
+                        int longB = std::max( rb.mWidth, rb.mHeight );
+                        if ( longA != longB )
+                        {
+                                return longA > longB;
+                        }
+                        return ra.mWidth * ra.mHeight > rb.mWidth * rb.mHeight;
+                } );
+
+                return order;
+        }
+
+        /**
+         * Opens a bin of the given size for incremental placement, and places
+         * the textures we already have in it.
+         */
+        bool beginIncremental( int binWidth, int binHeight, bool onePixelBorder )
+        {
+                mBorder = onePixelBorder;
+                mIncremental = packInto( sortedOrder(), binWidth, binHeight );
+                mPendingValid = false;
+                return mIncremental;
+        }
+
+        /**
+         * Packs all the textures from scratch, trying a handful of bin widths
+         * around the square root of the total area and keeping whichever
+         * gives the smallest final size.
+         */
+        void fullPack( bool forcePowerOfTwo, bool onePixelBorder )
+        {
+                mBorder = onePixelBorder;
+                mIncremental = false;
+
+                std::vector<int> order = sortedOrder();
+
+                int longestEdge = 0;
+                int paddedArea = 0;
+                for ( size_t i = 0; i < mTextures.size(); i++ )
+                {
+                        const Rect &r = mTextures[i];
+                        longestEdge = std::max( longestEdge, std::max( r.mWidth, r.mHeight ) + border() );
+                        paddedArea += ( r.mWidth + border() ) * ( r.mHeight + border() );
+                }
+                if ( mTextures.empty() )
+                {
+                        resetSkyline( 0, 0 );
+                        return;
+                }
+
+                int side = (int)ceil( sqrt( (double)paddedArea ) );
+
+                std::vector<int> candidates;
+                if ( forcePowerOfTwo )
+                {
+                        int w = nextPow2( std::max( longestEdge, side / 2 ) );
+                        for ( int i = 0; i < 4; i++, w *= 2 )
+                        {
+                                candidates.push_back( w );
+                        }
+                }
+                else
+                {
+                        static const float scales[] = { 0.75f, 1.0f, 1.1f, 1.25f, 1.5f, 2.0f };
+                        for ( size_t i = 0; i < sizeof( scales ) / sizeof( scales[0] ); i++ )
+                        {
+                                candidates.push_back( std::max( longestEdge, (int)( side * scales[i] ) ) );
+                        }
+                }
+
+                int bestWidth = -1;
+                long long bestArea = 0;
+                int bestLong = 0;
+                for ( size_t i = 0; i < candidates.size(); i++ )
+                {
+                        packInto( order, candidates[i], INT_MAX );
+
+                        int width, height;
+                        calcExtents( width, height );
+                        if ( forcePowerOfTwo )
+                        {
+                                width = nextPow2( width );
+                                height = nextPow2( height );
+                        }
+
+                        long long area = (long long)width * height;
+                        int longSide = std::max( width, height );
+                        if ( bestWidth < 0 || area < bestArea || ( area == bestArea && longSide < bestLong ) )
+                        {
+                                bestWidth = candidates[i];
+                                bestArea = area;
+                                bestLong = longSide;
+                        }
+                }
+
+                packInto( order, bestWidth, INT_MAX );
+        }
+
+        void calcExtents( int &width, int &height ) const
+        {
+                width = 0;
+                height = 0;
+                for ( size_t i = 0; i < mTextures.size(); i++ )
+                {
+                        const Rect &r = mTextures[i];
+                        if ( !r.mPlaced )
+                        {
+                                continue;
+                        }
+                        int wid = ( r.mFlipped ? r.mHeight : r.mWidth ) + border();
+                        int hit = ( r.mFlipped ? r.mWidth : r.mHeight ) + border();
+                        width = std::max( width, r.mX + wid );
+                        height = std::max( height, r.mY + hit );
+                }
+        }
+
+private:
+        std::vector<Rect> mTextures;
+        std::vector<Segment> mSkyline;
+        bool mIncremental;
+        bool mBorder;
+        int mBinWidth;
+        int mBinHeight;
+        int mTotalArea;
+        float mEfficiency;
+
+        // The result of the last wouldTextureFit() query.
+        Placement mPending;
+        int mPendingWidth;
+        int mPendingHeight;
+        bool mPendingValid;
 };
 
 
-TexturePacker * TexturePacker::createTexturePacker( void )
+TexturePacker * TexturePacker::createTexturePacker( PackerType type )
 {
-        MyTexturePacker *m = new MyTexturePacker;
-        return static_cast< TexturePacker *>( m );
+        if ( type == PT_skyline )
+        {
+                return new SkylineTexturePacker;
+        }
+        return new MyTexturePacker;
 }
 
 void            TexturePacker::releaseTexturePacker( TexturePacker *tp )
 {
-        MyTexturePacker *m = static_cast< MyTexturePacker *>( tp );
-        delete m;
+        delete tp;
 }
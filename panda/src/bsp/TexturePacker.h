@@ -151,6 +151,20 @@ private:
 class EXPCL_PANDABSP TexturePacker
 {
 PUBLISHED:
+        enum PackerType
+        {
+                // The original free-list packer described above.
+                PT_classic,
+
+                // A skyline bottom-left packer.  Packs tighter and supports
+                // incremental fit queries: once wouldTextureFit() has been
+                // called, each addNewTexture() is placed right away and
+                // later queries never re-pack the existing textures.
+                PT_skyline,
+        };
+
+        virtual ~TexturePacker() {}
+
         virtual int   getTextureCount( void ) = 0;
         virtual void  setTextureCount( int tcount ) = 0; // number of textures to consider..
         virtual void  addTexture( int wid, int hit ) = 0; // add textures 0 - n
@@ -165,7 +179,9 @@ PUBLISHED:
 
         virtual TextureLocation  getTextureLocation( int index ) = 0; // returns true if the texture has been rotated 90 degrees
 
-        static TexturePacker *createTexturePacker( void );
+        virtual float getPackingEfficiency( void ) = 0; // fraction of the last packed area covered by textures, 0 - 1
+
+        static TexturePacker *createTexturePacker( PackerType type = PT_classic );
         static void releaseTexturePacker( TexturePacker *tp );
 };
 
@@ -33,6 +33,12 @@
 #include <modelNode.h>
 #include <pstatTimer.h>
 #include <lineSegs.h>
+#include <jobSystem.h>
+#include <datagram.h>
+#include <datagramIterator.h>
+#include <compress_string.h>
+#include <configVariableBool.h>
+#include <bamCache.h>
 
 #include <bitset>
 
@@ -53,6 +59,8 @@ static PStatCollector ambientboost_collector( "AmbientProbes:UpdateNodes:BoostAm
 static PStatCollector xformlight_collector( "AmbientProbes:XformLight" );
 static PStatCollector loadcubemap_collector( "AmbientProbes:UpdateNodes:LoadCubemap" );
 static PStatCollector findcubemap_collector( "AmbientProbes:UpdateNodes:FindCubemap" );
+static PStatCollector loadcubemaps_collector( "AmbientProbes:LoadCubemaps" );
+static PStatCollector mipmapcubemaps_collector( "AmbientProbes:LoadCubemaps:GenerateMipmaps" );
 
 static ConfigVariableBool cfg_lightaverage
 ( "light-average", true, "Activates/deactivate light averaging" );
@@ -68,6 +76,24 @@ static ConfigVariableDouble r_ambientfraction
 static ConfigVariableDouble r_ambientfactor
 ( "r_ambientfactor", 5.0, "Boost ambient cube by no more than this factor." );
 
+static ConfigVariableBool cubemap_mipmaps
+( "cubemap-mipmaps", false,
+  "Generates mipmaps for the level's cubemaps when they are loaded, so that "
+  "rough surfaces can sample a blurrier reflection." );
+static ConfigVariableBool cubemap_cache
+( "cubemap-cache", true,
+  "Saves the decoded cubemaps to a .cmc file in the model cache directory the "
+  "first time a level is loaded, and reads them back from there on later "
+  "loads.  Nothing is cached if model-cache-dir is not set." );
+
+// Number of cubemap faces handed to each job when decoding the cubemaps.
+static const size_t faces_per_job = 1;
+
+// Identifies a cubemap cache file.
+// Bump the version whenever the layout of the file changes.
+static const std::string cmc_magic = "CMPC";
+static const uint16_t cmc_version = 1;
+
 using std::cos;
 using std::sin;
 
@@ -77,6 +103,12 @@ using std::sin;
 
 static light_t *dummy_light = new light_t;
 
+INLINE unsigned short texel_to_ushort( float val )
+{
+        val = std::max( 0.0f, std::min( val, 1.0f ) );
+        return (unsigned short)( val * USHRT_MAX + 0.5f );
+}
+
 AmbientProbeManager::AmbientProbeManager() :
         _loader( nullptr ),
         _sunlight( nullptr ),
@@ -318,14 +350,236 @@ void AmbientProbeManager::process_ambient_probes()
         
 }
 
+/**
+ * Returns a checksum of the cubemap data in the BSP file, used to tell if the
+ * cubemap cache is out of date.
+ */
+unsigned int AmbientProbeManager::calc_cubemap_checksum() const
+{
+        const bspdata_t *data = _loader->_bspdata;
+        unsigned int checksum = FastChecksum( data->cubemaps.data(), data->cubemaps.size() * sizeof( dcubemap_t ) );
+        checksum = checksum * 31 + FastChecksum( data->cubemapdata.data(), data->cubemapdata.size() * sizeof( colorrgbexp32_t ) );
+        return checksum;
+}
+
+/**
+ * Fills in the RAM images of the given cubemap textures, which must already
+ * be set up, from a cubemap cache file written by write_cubemap_cache().
+ * Returns true on success, or false if the file is missing, was written for
+ * different cubemap data or a different mipmap setting, or is damaged.  The
+ * textures may be partially filled in when this returns false.
+ */
+bool AmbientProbeManager::read_cubemap_cache( const Filename &filename, unsigned int checksum,
+                                              const TextureCollection &cubemaps )
+{
+        VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+        if ( filename.empty() || !vfs->exists( filename ) )
+        {
+                return false;
+        }
+
+        std::string contents;
+        if ( !vfs->read_file( filename, contents, true ) )
+        {
+                return false;
+        }
+#ifdef HAVE_ZLIB
+        contents = decompress_string( contents );
+#endif
+
+        Datagram dg( contents.data(), contents.size() );
+        DatagramIterator dgi( dg );
+        if ( dgi.get_remaining_size() < cmc_magic.size() + 11 ||
+             dgi.get_fixed_string( cmc_magic.size() ) != cmc_magic ||
+             dgi.get_uint16() != cmc_version ||
+             dgi.get_uint32() != checksum ||
+             dgi.get_bool() != cubemap_mipmaps.get_value() ||
+             dgi.get_uint32() != (uint32_t)cubemaps.get_num_textures() )
+        {
+                bspfile_cat.info()
+                        << "Cubemap cache " << filename << " is out of date\n";
+                return false;
+        }
+
+        for ( int i = 0; i < cubemaps.get_num_textures(); i++ )
+        {
+                Texture *tex = cubemaps.get_texture( i );
+                if ( dgi.get_remaining_size() < 5 ||
+                     dgi.get_int32() != tex->get_x_size() )
+                {
+                        bspfile_cat.warning()
+                                << "Cubemap cache " << filename << " is corrupt\n";
+                        return false;
+                }
+
+                int num_levels = dgi.get_uint8();
+                if ( num_levels < 1 || num_levels > tex->get_expected_num_mipmap_levels() )
+                {
+                        bspfile_cat.warning()
+                                << "Cubemap cache " << filename << " is corrupt\n";
+                        return false;
+                }
+
+                for ( int n = 0; n < num_levels; n++ )
+                {
+                        // Each level has to be exactly the size the texture
+                        // expects, or the renderer would read past its end.
+                        if ( dgi.get_remaining_size() < 4 )
+                        {
+                                bspfile_cat.warning()
+                                        << "Cubemap cache " << filename << " is corrupt\n";
+                                return false;
+                        }
+                        size_t size = dgi.get_uint32();
+                        if ( size != tex->get_expected_ram_mipmap_image_size( n ) ||
+                             size > dgi.get_remaining_size() )
+                        {
+                                bspfile_cat.warning()
+                                        << "Cubemap cache " << filename << " is corrupt\n";
+                                return false;
+                        }
+                        PTA_uchar image = PTA_uchar::empty_array( size );
+                        dgi.extract_bytes( image.p(), size );
+                        tex->set_ram_mipmap_image( n, image );
+                }
+        }
+
+        return true;
+}
+
+/**
+ * Saves the RAM images of the given cubemap textures, including any mipmap
+ * levels, to a cubemap cache file that read_cubemap_cache() can read back.
+ * Returns true on success.
+ */
+bool AmbientProbeManager::write_cubemap_cache( const Filename &filename, unsigned int checksum,
+                                               const TextureCollection &cubemaps )
+{
+        Datagram dg;
+        dg.append_data( cmc_magic.data(), cmc_magic.size() );
+        dg.add_uint16( cmc_version );
+        dg.add_uint32( checksum );
+        dg.add_bool( cubemap_mipmaps );
+        dg.add_uint32( cubemaps.get_num_textures() );
+
+        for ( int i = 0; i < cubemaps.get_num_textures(); i++ )
+        {
+                Texture *tex = cubemaps.get_texture( i );
+                dg.add_int32( tex->get_x_size() );
+
+                int num_levels = tex->get_num_ram_mipmap_images();
+                dg.add_uint8( num_levels );
+                for ( int n = 0; n < num_levels; n++ )
+                {
+                        CPTA_uchar image = tex->get_ram_mipmap_image( n );
+                        dg.add_uint32( image.size() );
+                        dg.append_data( image.p(), image.size() );
+                }
+        }
+
+        std::string contents = dg.get_message();
+#ifdef HAVE_ZLIB
+        contents = compress_string( contents, 6 );
+#endif
+
+        VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+        vfs->make_directory_full( filename.get_dirname() );
+        if ( !vfs->write_file( filename, contents, false ) )
+        {
+                bspfile_cat.warning()
+                        << "Unable to write cubemap cache " << filename << "\n";
+                return false;
+        }
+
+        if ( bspfile_cat.is_debug() )
+        {
+                bspfile_cat.debug()
+                        << "Wrote cubemap cache " << filename << "\n";
+        }
+        return true;
+}
+
+/**
+ * Decodes the RGBE texels of the given cubemap faces straight into the RAM
+ * images of the cubemap textures.  Each face is written by exactly one job,
+ * so the faces are decoded on the JobSystem's worker threads.
+ */
+void AmbientProbeManager::decode_cubemaps( const pvector<const dcubemap_t *> &sources )
+{
+        nassertv( sources.size() == _cubemaps.size() );
+
+        // The texture data pointers are looked up here, on the calling thread;
+        // the jobs only ever write through them.
+        pvector<unsigned short *> images;
+        images.reserve( _cubemaps.size() );
+        for ( size_t i = 0; i < _cubemaps.size(); i++ )
+        {
+                PTA_uchar image = _cubemaps[i]->cubemap_tex->make_ram_image();
+                images.push_back( (unsigned short *)image.p() );
+        }
+
+        const colorrgbexp32_t *cubemapdata = _loader->_bspdata->cubemapdata.data();
+        JobSystem::get_global_ptr()->parallel_process( _cubemaps.size() * 6, [&]( size_t begin, size_t end )
+        {
+                for ( size_t job = begin; job < end; job++ )
+                {
+                        size_t i = job / 6;
+                        int face = (int)( job % 6 );
+                        const dcubemap_t *dcm = sources[i];
+                        if ( dcm->imgofs[face] == -1 )
+                        {
+                                // Left black, same as a freshly made RAM image.
+                                continue;
+                        }
+
+                        int size = dcm->size;
+                        const colorrgbexp32_t *src = cubemapdata + dcm->imgofs[face];
+                        unsigned short *page = images[i] + (size_t)face * size * size * 3;
+                        for ( int y = 0; y < size; y++ )
+                        {
+                                // The cubemap data is stored top-down, Panda wants bottom-up BGR.
+                                unsigned short *row = page + (size_t)( size - 1 - y ) * size * 3;
+                                for ( int x = 0; x < size; x++ )
+                                {
+                                        LVector3 vcol;
+                                        ColorRGBExp32ToVector( *src++, vcol );
+                                        row[x * 3 + 0] = texel_to_ushort( vcol[2] );
+                                        row[x * 3 + 1] = texel_to_ushort( vcol[1] );
+                                        row[x * 3 + 2] = texel_to_ushort( vcol[0] );
+                                }
+                        }
+                }
+        }, faces_per_job );
+
+        if ( cubemap_mipmaps )
+        {
+                PStatTimer timer( mipmapcubemaps_collector );
+                JobSystem::get_global_ptr()->parallel_process( _cubemaps.size(), [&]( size_t begin, size_t end )
+                {
+                        for ( size_t i = begin; i < end; i++ )
+                        {
+                                _cubemaps[i]->cubemap_tex->generate_ram_mipmap_images();
+                        }
+                }, 1 );
+        }
+}
+
 void AmbientProbeManager::load_cubemaps()
 {
-        std::cout << _loader->_bspdata->cubemaps.size() << " cubemaps " << std::endl;
+        PStatTimer timer( loadcubemaps_collector );
+
+        if ( bspfile_cat.is_debug() )
+        {
+                bspfile_cat.debug()
+                        << _loader->_bspdata->cubemaps.size() << " cubemaps\n";
+        }
+
         _envmap_kdtree = new KDTree( 3 );
         vector<vector<double>> envmap_points;
+        pvector<const dcubemap_t *> sources;
         for ( size_t i = 0; i < _loader->_bspdata->cubemaps.size(); i++ )
         {
-                dcubemap_t *dcm = &_loader->_bspdata->cubemaps[i];
+                const dcubemap_t *dcm = &_loader->_bspdata->cubemaps[i];
                 PT( cubemap_t ) cm = new cubemap_t;
                 cm->pos = LVector3( dcm->pos[0] / 16.0, dcm->pos[1] / 16.0, dcm->pos[2] / 16.0 );
 
@@ -344,6 +598,18 @@ void AmbientProbeManager::load_cubemaps()
                 cm->leaf = _loader->find_leaf( cm->pos );
                 cm->size = dcm->size;
                 cm->has_full_cubemap = true;
+                for ( int j = 0; j < 6; j++ )
+                {
+                        if ( dcm->imgofs[j] == -1 )
+                        {
+                                if ( bspfile_cat.is_debug() )
+                                {
+                                        bspfile_cat.debug()
+                                                << "Cubemap " << i << " has no image on side " << j << "\n";
+                                }
+                                cm->has_full_cubemap = false;
+                        }
+                }
 
                 // insert into k-d tree
                 envmap_points.push_back( { cm->pos[0], cm->pos[1], cm->pos[2] } );
@@ -353,49 +619,52 @@ void AmbientProbeManager::load_cubemaps()
                 cm->cubemap_tex->setup_cube_map( dcm->size, Texture::T_unsigned_short, Texture::F_rgb );
                 cm->cubemap_tex->set_wrap_u( SamplerState::WM_clamp );
                 cm->cubemap_tex->set_wrap_v( SamplerState::WM_clamp );
-                cm->cubemap_tex->set_keep_ram_image( true );
-
-                for ( int j = 0; j < 6; j++ ) // for each side in the cubemap_tex
+                if ( cubemap_mipmaps )
                 {
-                        if ( dcm->imgofs[j] == -1 )
-                        {
-                                std::cout << "\tNo image on side " << j << std::endl;
-                                cm->has_full_cubemap = false;
-                                continue;
-                        }
+                        cm->cubemap_tex->set_minfilter( SamplerState::FT_linear_mipmap_linear );
+                }
+                cm->cubemap_tex->set_keep_ram_image( true );
 
-                        int xel = 0;
+                _cubemaps.push_back( cm );
+                sources.push_back( dcm );
+        }
 
-                        PNMImage img( dcm->size, dcm->size );
-			img.set_color_space( ColorSpace::CS_linear );
-			img.set_maxval( USHRT_MAX );
-                        img.fill( 0 );
+        if ( envmap_points.size() )
+        {
+                _envmap_kdtree->build( envmap_points );
+        }
 
-                        for ( int y = 0; y < dcm->size; y++ )
-                        {
-                                for ( int x = 0; x < dcm->size; x++ )
-                                {
-                                        colorrgbexp32_t *col = &_loader->_bspdata->cubemapdata[dcm->imgofs[j] + xel];
-                                        LVector3 vcol;
-                                        ColorRGBExp32ToVector( *col, vcol );
-                                        img.set_xel( x, y, vcol );
-                                        xel++;
-                                }
-                        }
+        if ( _cubemaps.empty() )
+        {
+                return;
+        }
 
-                        cm->cubemap_tex->load( img, j, 0 );
-                        cm->cubemap_images[j] = img;
+        // The cache lives in the model cache directory, so this is empty if
+        // there is none.
+        Filename cache_filename;
+        unsigned int checksum = 0;
+        TextureCollection cubemaps;
+        if ( cubemap_cache )
+        {
+                cache_filename = _loader->get_cache_filename( "cmc" );
+                checksum = calc_cubemap_checksum();
+                for ( size_t i = 0; i < _cubemaps.size(); i++ )
+                {
+                        cubemaps.add_texture( _cubemaps[i]->cubemap_tex );
                 }
 
-		cm->cubemap_tex->write( std::cout, 0 );
-
-                _cubemaps.push_back( cm );
+                if ( read_cubemap_cache( cache_filename, checksum, cubemaps ) )
+                {
+                        return;
+                }
         }
 
-        if ( envmap_points.size() )
+        decode_cubemaps( sources );
+
+        if ( !cache_filename.empty() && !BamCache::get_global_ptr()->get_read_only() )
         {
-                _envmap_kdtree->build( envmap_points );
-        }      
+                write_cubemap_cache( cache_filename, checksum, cubemaps );
+        }
 }
 
 INLINE bool AmbientProbeManager::is_sky_visible( const LPoint3 &point )
@@ -22,6 +22,8 @@
 #include <cullableObject.h>
 #include <shaderAttrib.h>
 #include <updateSeq.h>
+#include <filename.h>
+#include <textureCollection.h>
 
 #include <unordered_map>
 #include <bitset>
@@ -34,6 +36,7 @@ class BSPLoader;
 struct dleafambientindex_t;
 struct dleafambientlighting_t;
 class cubemap_t;
+struct dcubemap_t;
 
 enum
 {
@@ -192,6 +195,12 @@ class CNodeShaderInput;
 
 class EXPCL_PANDABSP AmbientProbeManager
 {
+PUBLISHED:
+        static bool read_cubemap_cache( const Filename &filename, unsigned int checksum,
+                                        const TextureCollection &cubemaps );
+        static bool write_cubemap_cache( const Filename &filename, unsigned int checksum,
+                                         const TextureCollection &cubemaps );
+
 public:
         AmbientProbeManager();
         AmbientProbeManager( BSPLoader *loader );
@@ -245,6 +254,9 @@ private:
         INLINE bool is_sky_visible( const LPoint3 &point );
         INLINE bool is_light_visible( const LPoint3 &point, const light_t *light );
 
+        void decode_cubemaps( const pvector<const dcubemap_t *> &sources );
+        unsigned int calc_cubemap_checksum() const;
+
 private:
         BSPLoader *_loader;
 
@@ -373,11 +373,9 @@ void BSPCullTraverser::traverse_below( CullTraverserData &data )
         int num_children = children.get_num_children();
         if ( !node->has_selective_visibility() )
         {
-                for ( int i = 0; i < num_children; ++i )
-                {
-                        CullTraverserData next_data( data, children.get_child( i ) );
-                        do_traverse( next_data );
-                }
+                // Wide nodes, like a level full of props, may be traversed
+                // in parallel if parallel-cull-traverse is enabled.
+                traverse_children( data, children );
         }
         else
         {
@@ -391,6 +389,15 @@ void BSPCullTraverser::traverse_below( CullTraverserData &data )
         }
 }
 
+/**
+ * Returns a BSPCullTraverser to continue a parallel traversal of wide nodes
+ * on a worker thread.
+ */
+PT( CullTraverser ) BSPCullTraverser::make_worker_traverser()
+{
+        return new BSPCullTraverser( this, _loader );
+}
+
 /**
 * Returns a RenderState for increasing the DepthOffset by one.
 */
@@ -27,6 +27,8 @@
 #include <math.h>
 
 #include <asyncTaskManager.h>
+#include <bamCache.h>
+#include <jobSystem.h>
 #include <eggData.h>
 #include <eggPolygon.h>
 #include <eggVertexUV.h>
@@ -80,6 +82,10 @@ static PT( InternalName ) static_vertex_lighting_name = InternalName::make( "sta
 
 static ConfigVariableBool dumpcubemaps( "dumpcubemaps", false );
 
+// Number of rows of a cubemap face handed to each job when merging exposures
+// and encoding the face while building cubemaps.
+static const size_t cubemap_rows_per_job = 16;
+
 static const pvector<std::string> world_entities =
 {
 	"worldspawn",
@@ -2023,27 +2029,34 @@ void BSPLoader::build_cubemaps()
 				ldr_map.set_maxval( USHRT_MAX );
 				buf->get_screenshot( ldr_map );
 
+				// Merge this exposure into the HDR image a few rows at a time on
+				// the job workers.  Each row keeps track of its own over exposed
+				// texels so the rows never write to the same memory.
 				float scale = 1.0f / exposure;
-				over_exposed_texels = false;
-
-				for ( int x = 0; x < hdr_map.get_x_size(); x++ )
+				pvector<unsigned char> row_over_exposed( hdr_map.get_y_size(), 0 );
+				JobSystem::get_global_ptr()->parallel_process( hdr_map.get_y_size(), [&]( size_t begin, size_t end )
 				{
-					for ( int y = 0; y < hdr_map.get_y_size(); y++ )
+					for ( int y = (int)begin; y < (int)end; y++ )
 					{
-						LRGBColorf ldr_col = ldr_map.get_xel( x, y );
-						LRGBColorf hdr_col = hdr_map.get_xel( x, y );
-						for ( int c = 0; c < 3; c++ )
+						for ( int x = 0; x < hdr_map.get_x_size(); x++ )
 						{
-							float texel = ldr_col[c];
-							if ( texel > 0.98f )
-								over_exposed_texels = true;
-							texel *= scale;
-							
-							hdr_col[c] = std::max( hdr_col[c], texel );
+							LRGBColorf ldr_col = ldr_map.get_xel( x, y );
+							LRGBColorf hdr_col = hdr_map.get_xel( x, y );
+							for ( int c = 0; c < 3; c++ )
+							{
+								float texel = ldr_col[c];
+								if ( texel > 0.98f )
+									row_over_exposed[y] = 1;
+								texel *= scale;
+
+								hdr_col[c] = std::max( hdr_col[c], texel );
+							}
+							hdr_map.set_xel( x, y, hdr_col );
 						}
-						hdr_map.set_xel( x, y, hdr_col );
 					}
-				}
+				}, cubemap_rows_per_job );
+
+				over_exposed_texels = std::find( row_over_exposed.begin(), row_over_exposed.end(), 1 ) != row_over_exposed.end();
 
 				exposure *= 0.75f;
 
@@ -2057,17 +2070,21 @@ void BSPLoader::build_cubemaps()
 			}
 
 			// save out the cubemap_tex face
+			int x_size = hdr_map.get_x_size();
 			cm->imgofs[j] = _bspdata->cubemapdata.size();
-			for ( int y = 0; y < hdr_map.get_y_size(); y++ )
+			_bspdata->cubemapdata.resize( _bspdata->cubemapdata.size() + x_size * hdr_map.get_y_size() );
+			colorrgbexp32_t *face_data = _bspdata->cubemapdata.data() + cm->imgofs[j];
+			JobSystem::get_global_ptr()->parallel_process( hdr_map.get_y_size(), [&]( size_t begin, size_t end )
 			{
-				for ( int x = 0; x < hdr_map.get_x_size(); x++ )
+				for ( int y = (int)begin; y < (int)end; y++ )
 				{
-					LRGBColor col = hdr_map.get_xel( x, y );
-					colorrgbexp32_t out;
-					VectorToColorRGBExp32( col, out );
-					_bspdata->cubemapdata.push_back( out );
+					for ( int x = 0; x < x_size; x++ )
+					{
+						LRGBColor col = hdr_map.get_xel( x, y );
+						VectorToColorRGBExp32( col, face_data[y * x_size + x] );
+					}
 				}
-			}
+			}, cubemap_rows_per_job );
 
 			//if ( dumpcubemaps )
 			//{
@@ -2094,6 +2111,36 @@ void BSPLoader::build_cubemaps()
         
 }
 
+/**
+ * Returns the name of a file in the model cache directory that can hold data
+ * derived from the currently loaded map, such as its decoded lightmaps or
+ * cubemaps.  Returns an empty filename if there is no map loaded or the model
+ * cache is disabled, in which case nothing should be cached.
+ *
+ * The name is made unique per map path, so that two maps with the same name
+ * in different directories don't share a cache file.
+ */
+Filename BSPLoader::get_cache_filename( const std::string &extension ) const
+{
+	BamCache *cache = BamCache::get_global_ptr();
+	if ( _map_file.empty() || !cache->get_active() )
+	{
+		return Filename();
+	}
+
+	Filename fullpath = _map_file;
+	fullpath.make_absolute();
+	std::string path = fullpath.get_fullpath();
+
+	std::ostringstream strm;
+	strm << _map_file.get_basename_wo_extension() << "_"
+	     << std::hex << (unsigned int)FastChecksum( path.data(), path.size() ) << "." << extension;
+
+	Filename filename( Filename( cache->get_root(), "bsp" ), strm.str() );
+	filename.set_binary();
+	return filename;
+}
+
 void BSPLoader::cleanup( bool is_transition )
 {
 	if ( !_active_level )
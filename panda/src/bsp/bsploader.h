@@ -374,6 +374,12 @@ public:
 	{
 		return &_lightmap_dir;
 	}
+	INLINE const Filename &get_map_file() const
+	{
+		return _map_file;
+	}
+
+	Filename get_cache_filename( const std::string &extension ) const;
 
 	INLINE const dmodel_t *dmodel_for_dface( const dface_t *dface ) const
 	{
@@ -20,7 +20,6 @@ class cubemap_t : public ReferenceCount
 public:
         LVector3 pos;
         PT( Texture ) cubemap_tex;
-        PNMImage cubemap_images[6];
         int leaf;
         int size;
 
@@ -14,79 +14,490 @@
 #include "bsploader.h"
 #include "TexturePacker.h"
 
+#include <jobSystem.h>
+#include <virtualFileSystem.h>
+#include <datagram.h>
+#include <datagramIterator.h>
+#include <compress_string.h>
+#include <configVariableBool.h>
+#include <bamCache.h>
+
+#include <algorithm>
 #include <bitset>
 #include <cstdio>
 
 NotifyCategoryDef( lightmapPalettizer, "" );
 
+static ConfigVariableBool lightmap_palette_cache
+( "lightmap-palette-cache", true,
+  "Saves the palettized lightmaps to a .lmp file in the model cache directory "
+  "the first time a level is loaded, and reads them back from there on later "
+  "loads.  Nothing is cached if model-cache-dir is not set." );
+
+static ConfigVariableBool lightmap_palette_rgb9e5
+( "lightmap-palette-rgb9e5", false,
+  "Stores lightmap palettes in the 32-bit RGB9_E5 shared-exponent format "
+  "instead of 16-bit RGB, halving the texture memory used by lightmaps.  "
+  "Note that the copy kept in system memory doubles in size instead, since "
+  "the driver only accepts RGB9_E5 texture data as 32-bit floats." );
+
 // Max size per palette before making a new one.
 static const int max_palette = 1024;
 
+// Largest palette we accept from a cache file.  Since all of the lightmaps
+// currently go into one palette, this is much larger than max_palette.
+static const int max_cached_palette = 16384;
+
+// Number of faces handed to each job when filling in the palettes.
+static const size_t faces_per_job = 16;
+
+// Identifies a lightmap palette cache file.
+// Bump the version whenever the layout of the file changes.
+static const std::string lmp_magic = "LMPC";
+static const uint16_t lmp_version = 1;
+
 // Currently we pack every single lightmap into one texture,
-// no matter how big. The way to split the lightmap palettes
-// is verrry slow atm.
+// no matter how big. Splitting is cheap now that the skyline
+// packer answers fit queries without re-packing, but decals
+// still assume there is only one palette.
 //#define LMPALETTE_SPLIT
 
+INLINE unsigned short luxel_to_ushort( float val )
+{
+        val = std::max( 0.0f, std::min( val, 1.0f ) );
+        return (unsigned short)( val * USHRT_MAX + 0.5f );
+}
+
+/**
+ * Packs a linear color into the layout of GL_RGB9_E5: three 9-bit mantissas
+ * sharing one 5-bit exponent.
+ */
+static uint32_t pack_rgb9e5( float r, float g, float b )
+{
+        static const int mantissa_bits = 9;
+        static const int exp_bias = 15;
+        static const float max_val = 511.0f / 512.0f * 65536.0f;
+
+        r = std::max( 0.0f, std::min( r, max_val ) );
+        g = std::max( 0.0f, std::min( g, max_val ) );
+        b = std::max( 0.0f, std::min( b, max_val ) );
+
+        float max_rgb = std::max( r, std::max( g, b ) );
+        if ( max_rgb <= 0.0f )
+        {
+                return 0;
+        }
+
+        int exp_shared = std::max( -exp_bias - 1, (int)floor( log2( max_rgb ) ) ) + 1 + exp_bias;
+        float denom = ldexp( 1.0f, exp_shared - exp_bias - mantissa_bits );
+        if ( (int)floor( max_rgb / denom + 0.5f ) == ( 1 << mantissa_bits ) )
+        {
+                denom *= 2.0f;
+                exp_shared++;
+        }
+
+        uint32_t rm = (uint32_t)floor( r / denom + 0.5f );
+        uint32_t gm = (uint32_t)floor( g / denom + 0.5f );
+        uint32_t bm = (uint32_t)floor( b / denom + 0.5f );
+
+        return rm | ( gm << 9 ) | ( bm << 18 ) | ( (uint32_t)exp_shared << 27 );
+}
+
+static void unpack_rgb9e5( uint32_t packed, float &r, float &g, float &b )
+{
+        float scale = ldexp( 1.0f, (int)( packed >> 27 ) - 15 - 9 );
+        r = ( packed & 0x1ff ) * scale;
+        g = ( ( packed >> 9 ) & 0x1ff ) * scale;
+        b = ( ( packed >> 18 ) & 0x1ff ) * scale;
+}
+
 LightmapPalettizer::LightmapPalettizer( const BSPLoader *loader ) :
-        _loader( loader )
+        _loader( loader ),
+        _shared_exponent( lightmap_palette_rgb9e5 )
+{
+}
+
+/**
+ * Creates an empty array texture for a palette of the indicated size, with a
+ * zeroed RAM image ready to be filled in.
+ */
+PT( Texture ) LightmapPalettizer::make_palette_texture( int width, int height ) const
 {
+        PT( Texture ) tex = new Texture;
+        if ( _shared_exponent )
+        {
+                // The RAM image holds floats, the driver converts them to
+                // 32 bits per texel on upload.
+                tex->setup_2d_texture_array( width, height, NUM_LIGHTMAPS, Texture::T_float, Texture::F_rgb9_e5 );
+        }
+        else
+        {
+                tex->setup_2d_texture_array( width, height, NUM_LIGHTMAPS, Texture::T_unsigned_short, Texture::F_rgb );
+        }
+        tex->set_minfilter( SamplerState::FT_linear_mipmap_linear );
+        tex->set_magfilter( SamplerState::FT_linear );
+        tex->make_ram_image();
+        return tex;
 }
 
-INLINE PNMImage lightmap_img_for_face( const BSPLoader *loader, const dface_t *face, int lmnum = 0, bool bounced = false )
+/**
+ * Decodes the lightmaps of a single face directly into their spot in the
+ * palette's RAM image.  Each face owns a disjoint region of the palette, so
+ * this may be called for many faces at once from different threads.
+ */
+void LightmapPalettizer::blit_source( const LightmapSource *src, Texture *tex,
+                                      unsigned char *ram_image, int xshift, int yshift,
+                                      int lmwidth, int lmheight, bool rotated ) const
 {
-        int width = face->lightmap_size[0] + 1;
-        int height = face->lightmap_size[1] + 1;
-        int num_luxels = width * height;
+        bspdata_t *data = _loader->get_bspdata();
+        const dface_t *face = data->dfaces + src->facenum;
 
-        if ( num_luxels <= 0 )
+        if ( src->width * src->height <= 0 )
         {
                 lightmapPalettizer_cat.warning()
                         << "Face has 0 size lightmap, will appear fullbright" << std::endl;
-                PNMImage img( 16, 16 );
-                img.fill( 1.0 );
-                return img;
+                return;
         }
 
-        PNMImage img( width, height );
-	img.fill( 0 );
-	img.set_color_space( ColorSpace::CS_linear );
-	img.set_maxval( USHRT_MAX ); // ensure we get 16-bit color depth
+        int pal_width = tex->get_x_size();
+        int pal_height = tex->get_y_size();
+        size_t page_size = tex->get_expected_ram_page_size();
+        size_t pixel_width = 3 * tex->get_component_width();
 
-        int luxel = 0;
+        // Layer 0 is the bounced lightmap, followed by the flat or bumped
+        // direct lightmaps.
+        int num_layers = face->bumped_lightmap ? NUM_BUMP_VECTS + 2 : 2;
 
-        for ( int y = 0; y < height; y++ )
+        for ( int n = 0; n < num_layers; n++ )
         {
-                for ( int x = 0; x < width; x++ )
+                unsigned char *page = ram_image + page_size * n;
+
+                for ( int y = 0; y < lmheight; y++ )
                 {
-                        colorrgbexp32_t *sample;
-                        if ( !bounced )
-                                sample = SampleLightmap( loader->get_bspdata(), face, luxel, 0, lmnum );
-                        else
-                                sample = SampleBouncedLightmap( loader->get_bspdata(), face, luxel );
-
-			// Luxel is in linear-space.
-			LVector3 luxel_col;
-			ColorRGBExp32ToVector( *sample, luxel_col );
-			luxel_col /= 255.0f;
-
-                        img.set_xel( x, y, luxel_col );
-                        luxel++;
+                        // RAM images are stored bottom-up.
+                        unsigned char *row = page + (size_t)( pal_height - 1 - ( y + yshift ) ) * pal_width * pixel_width;
+
+                        for ( int x = 0; x < lmwidth; x++ )
+                        {
+                                int luxel = rotated ? ( x * src->width + y ) : ( y * src->width + x );
+
+                                colorrgbexp32_t *sample;
+                                if ( n == 0 )
+                                        sample = SampleBouncedLightmap( data, face, luxel );
+                                else
+                                        sample = SampleLightmap( data, face, luxel, 0, n - 1 );
+
+                                // Luxel is in linear-space.
+                                LVector3 luxel_col;
+                                ColorRGBExp32ToVector( *sample, luxel_col );
+                                luxel_col /= 255.0f;
+
+                                unsigned char *pixel = row + (size_t)( x + xshift ) * pixel_width;
+                                if ( _shared_exponent )
+                                {
+                                        float *fpixel = (float *)pixel;
+                                        fpixel[0] = std::max( 0.0f, std::min( (float)luxel_col[2], 1.0f ) );
+                                        fpixel[1] = std::max( 0.0f, std::min( (float)luxel_col[1], 1.0f ) );
+                                        fpixel[2] = std::max( 0.0f, std::min( (float)luxel_col[0], 1.0f ) );
+                                }
+                                else
+                                {
+                                        unsigned short *spixel = (unsigned short *)pixel;
+                                        spixel[0] = luxel_to_ushort( luxel_col[2] );
+                                        spixel[1] = luxel_to_ushort( luxel_col[1] );
+                                        spixel[2] = luxel_to_ushort( luxel_col[0] );
+                                }
+                        }
                 }
         }
+}
+
+/**
+ * Returns a checksum of everything in the BSP file that goes into the
+ * lightmap palettes, used to tell whether a cache file is still valid.
+ */
+unsigned int LightmapPalettizer::calc_lighting_checksum() const
+{
+        const bspdata_t *data = _loader->get_bspdata();
+
+        pvector<int> face_info;
+        face_info.reserve( data->numfaces * 6 );
+        for ( int facenum = 0; facenum < data->numfaces; facenum++ )
+        {
+                const dface_t *face = data->dfaces + facenum;
+                face_info.push_back( face->lightofs );
+                face_info.push_back( face->bouncedlightofs );
+                face_info.push_back( face->lightmap_size[0] );
+                face_info.push_back( face->lightmap_size[1] );
+                face_info.push_back( face->bumped_lightmap );
+        }
 
-        return img;
+        unsigned int checksum = FastChecksum( face_info.data(), face_info.size() * sizeof( int ) );
+        checksum = checksum * 31 + FastChecksum( data->lightdata.data(), data->lightdata.size() * sizeof( colorrgbexp32_t ) );
+        checksum = checksum * 31 + FastChecksum( data->bouncedlightdata.data(), data->bouncedlightdata.size() * sizeof( colorrgbexp32_t ) );
+        return checksum;
+}
+
+/**
+ * Fills in the directory from the palette cache, if there is one and it was
+ * built from the same lighting data with the same format.  Returns true on
+ * success.
+ *
+ * Everything read from the file is checked against the size of the file and
+ * against the loaded BSP file before it is used, since the cache lives
+ * outside of the game data and may be truncated or damaged.
+ */
+bool LightmapPalettizer::read_cache( LightmapPaletteDirectory &dir, unsigned int checksum ) const
+{
+        Filename filename = _loader->get_cache_filename( "lmp" );
+        VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+        if ( filename.empty() || !vfs->exists( filename ) )
+        {
+                return false;
+        }
+
+        std::string contents;
+        if ( !vfs->read_file( filename, contents, true ) )
+        {
+                return false;
+        }
+#ifdef HAVE_ZLIB
+        contents = decompress_string( contents );
+#endif
+
+        Datagram dg( contents.data(), contents.size() );
+        DatagramIterator dgi( dg );
+        if ( dgi.get_remaining_size() < lmp_magic.size() + 7 ||
+             dgi.get_fixed_string( lmp_magic.size() ) != lmp_magic ||
+             dgi.get_uint16() != lmp_version ||
+             dgi.get_uint32() != checksum ||
+             dgi.get_bool() != _shared_exponent )
+        {
+                lightmapPalettizer_cat.info()
+                        << "Lightmap palette cache " << filename << " is out of date\n";
+                return false;
+        }
+
+        const bspdata_t *data = _loader->get_bspdata();
+
+        // Each texel is stored as a packed uint32 in the shared exponent
+        // format, or as three uint16s otherwise.
+        size_t texel_size = _shared_exponent ? 4 : 6;
+
+        if ( dgi.get_remaining_size() < 2 )
+        {
+                lightmapPalettizer_cat.warning()
+                        << "Lightmap palette cache " << filename << " is corrupt\n";
+                return false;
+        }
+        int num_palettes = dgi.get_uint16();
+        for ( int i = 0; i < num_palettes; i++ )
+        {
+                if ( dgi.get_remaining_size() < 8 )
+                {
+                        lightmapPalettizer_cat.warning()
+                                << "Lightmap palette cache " << filename << " is corrupt\n";
+                        return false;
+                }
+                int width = dgi.get_int32();
+                int height = dgi.get_int32();
+
+                // Don't allocate anything before we know that the file really
+                // holds that many texels.
+                if ( width <= 0 || height <= 0 ||
+                     width > max_cached_palette || height > max_cached_palette ||
+                     (size_t)width * height * ( NUM_LIGHTMAPS ) * texel_size > dgi.get_remaining_size() )
+                {
+                        lightmapPalettizer_cat.warning()
+                                << "Lightmap palette cache " << filename << " is corrupt\n";
+                        return false;
+                }
+
+                PT( LightmapPaletteDirectory::LightmapPaletteEntry ) entry = new LightmapPaletteDirectory::LightmapPaletteEntry;
+                entry->palette_tex = make_palette_texture( width, height );
+
+                PTA_uchar image = entry->palette_tex->modify_ram_image();
+                size_t num_texels = (size_t)width * height * ( NUM_LIGHTMAPS );
+                if ( _shared_exponent )
+                {
+                        nassertr( image.size() == num_texels * 3 * sizeof( float ), false );
+                        float *texels = (float *)image.p();
+                        for ( size_t j = 0; j < num_texels; j++ )
+                        {
+                                unpack_rgb9e5( dgi.get_uint32(), texels[j * 3], texels[j * 3 + 1], texels[j * 3 + 2] );
+                        }
+                        entry->palette_tex->generate_ram_mipmap_images();
+                }
+                else
+                {
+                        nassertr( image.size() == num_texels * texel_size, false );
+                        dgi.extract_bytes( image.p(), image.size() );
+                }
+
+                dir.entries.push_back( entry );
+        }
+
+        // facenum, palette, xshift, yshift, flipped
+        static const size_t face_entry_size = 4 + 2 + 4 + 4 + 1;
+
+        if ( dgi.get_remaining_size() < 4 )
+        {
+                lightmapPalettizer_cat.warning()
+                        << "Lightmap palette cache " << filename << " is corrupt\n";
+                return false;
+        }
+        size_t num_faces = dgi.get_uint32();
+        if ( num_faces > (size_t)data->numfaces ||
+             num_faces * face_entry_size > dgi.get_remaining_size() )
+        {
+                lightmapPalettizer_cat.warning()
+                        << "Lightmap palette cache " << filename << " is corrupt\n";
+                return false;
+        }
+
+        for ( size_t i = 0; i < num_faces; i++ )
+        {
+                int facenum = dgi.get_int32();
+                int palette = dgi.get_uint16();
+                int xshift = dgi.get_int32();
+                int yshift = dgi.get_int32();
+                bool flipped = dgi.get_bool();
+
+                if ( facenum < 0 || facenum >= data->numfaces || palette >= (int)dir.entries.size() )
+                {
+                        lightmapPalettizer_cat.warning()
+                                << "Lightmap palette cache " << filename << " is corrupt\n";
+                        return false;
+                }
+
+                // The face's lightmap has to lie entirely within its palette.
+                const dface_t *face = data->dfaces + facenum;
+                Texture *tex = dir.entries[palette]->palette_tex;
+                int lmwidth = face->lightmap_size[flipped ? 1 : 0] + 1;
+                int lmheight = face->lightmap_size[flipped ? 0 : 1] + 1;
+                if ( xshift < 0 || yshift < 0 ||
+                     xshift + lmwidth > tex->get_x_size() ||
+                     yshift + lmheight > tex->get_y_size() )
+                {
+                        lightmapPalettizer_cat.warning()
+                                << "Lightmap palette cache " << filename << " is corrupt\n";
+                        return false;
+                }
+
+                PT( LightmapPaletteDirectory::LightmapFacePaletteEntry ) face_entry = new LightmapPaletteDirectory::LightmapFacePaletteEntry;
+                face_entry->palette = dir.entries[palette];
+                face_entry->xshift = xshift;
+                face_entry->yshift = yshift;
+                face_entry->flipped = flipped;
+                face_entry->palette_size[0] = tex->get_x_size();
+                face_entry->palette_size[1] = tex->get_y_size();
+
+                dir.face_index[facenum] = face_entry;
+                dir.face_entries.push_back( face_entry );
+        }
+
+        return true;
+}
+
+/**
+ * Saves the palettes to the model cache directory so that the next load of
+ * the same level can skip palettizing altogether.
+ */
+void LightmapPalettizer::write_cache( const LightmapPaletteDirectory &dir, unsigned int checksum ) const
+{
+        Filename filename = _loader->get_cache_filename( "lmp" );
+        if ( filename.empty() || BamCache::get_global_ptr()->get_read_only() )
+        {
+                return;
+        }
+
+        Datagram dg;
+        dg.append_data( lmp_magic.data(), lmp_magic.size() );
+        dg.add_uint16( lmp_version );
+        dg.add_uint32( checksum );
+        dg.add_bool( _shared_exponent );
+
+        pmap<const LightmapPaletteDirectory::LightmapPaletteEntry *, int> palette_indices;
+
+        dg.add_uint16( dir.entries.size() );
+        for ( size_t i = 0; i < dir.entries.size(); i++ )
+        {
+                Texture *tex = dir.entries[i]->palette_tex;
+                palette_indices[dir.entries[i]] = (int)i;
+
+                dg.add_int32( tex->get_x_size() );
+                dg.add_int32( tex->get_y_size() );
+
+                // Only the base level is stored, the mipmaps are regenerated on load.
+                CPTA_uchar image = tex->get_ram_mipmap_image( 0 );
+                if ( _shared_exponent )
+                {
+                        const float *texels = (const float *)image.p();
+                        size_t num_texels = image.size() / ( 3 * sizeof( float ) );
+                        for ( size_t j = 0; j < num_texels; j++ )
+                        {
+                                dg.add_uint32( pack_rgb9e5( texels[j * 3], texels[j * 3 + 1], texels[j * 3 + 2] ) );
+                        }
+                }
+                else
+                {
+                        dg.append_data( image.p(), image.size() );
+                }
+        }
+
+        dg.add_uint32( dir.face_index.size() );
+        for ( auto itr = dir.face_index.begin(); itr != dir.face_index.end(); ++itr )
+        {
+                const LightmapPaletteDirectory::LightmapFacePaletteEntry *face_entry = itr->second;
+                dg.add_int32( itr->first );
+                dg.add_uint16( palette_indices[face_entry->palette] );
+                dg.add_int32( face_entry->xshift );
+                dg.add_int32( face_entry->yshift );
+                dg.add_bool( face_entry->flipped );
+        }
+
+        std::string contents = dg.get_message();
+#ifdef HAVE_ZLIB
+        contents = compress_string( contents, 6 );
+#endif
+
+        VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+        vfs->make_directory_full( filename.get_dirname() );
+        if ( !vfs->write_file( filename, contents, false ) )
+        {
+                lightmapPalettizer_cat.warning()
+                        << "Unable to write lightmap palette cache " << filename << "\n";
+        }
+        else if ( lightmapPalettizer_cat.is_debug() )
+        {
+                lightmapPalettizer_cat.debug()
+                        << "Wrote lightmap palette cache " << filename << "\n";
+        }
 }
 
 LightmapPaletteDirectory LightmapPalettizer::palettize_lightmaps()
 {
         LightmapPaletteDirectory dir;
 
+        unsigned int checksum = 0;
+        if ( lightmap_palette_cache )
+        {
+                checksum = calc_lighting_checksum();
+                if ( read_cache( dir, checksum ) )
+                {
+                        return dir;
+                }
+                dir = LightmapPaletteDirectory();
+        }
+
         pvector<Palette> result_vec;
         Palette pal;
-        pal.packer = TexturePacker::createTexturePacker();
+        pal.packer = TexturePacker::createTexturePacker( TexturePacker::PT_skyline );
         result_vec.push_back( pal );
 
-        // First step, build sources.
+        // First step, build sources.  We only need the lightmap sizes to
+        // pack the palettes, the luxels are decoded straight into the palettes
+        // once we know where each lightmap goes.
         for ( int facenum = 0; facenum < _loader->get_bspdata()->numfaces; facenum++ )
         {
                 dface_t *face = _loader->get_bspdata()->dfaces + facenum;
@@ -98,25 +509,23 @@ LightmapPaletteDirectory LightmapPalettizer::palettize_lightmaps()
 
                 LightmapSource src;
                 src.facenum = facenum;
-                src.lightmap_img[0] = lightmap_img_for_face( _loader, face, 0, true ); // bounced lightmap
-                if ( face->bumped_lightmap )
-                {
-                        for ( int n = 0; n < NUM_BUMP_VECTS + 1; n++ )
-                        {
-                                src.lightmap_img[n + 1] = lightmap_img_for_face( _loader, face, n );
-                        }
-                }
-                else
-                {
-                        src.lightmap_img[1] = lightmap_img_for_face( _loader, face, 0 );
-                }
-                
+                src.width = face->lightmap_size[0] + 1;
+                src.height = face->lightmap_size[1] + 1;
                 _sources.push_back( src );
         }
 
+#ifdef LMPALETTE_SPLIT
+        // Insert the biggest lightmaps first so the palettes fill up with
+        // the hard-to-place ones and the small ones go in the gaps.
+        std::stable_sort( _sources.begin(), _sources.end(), []( const LightmapSource &a, const LightmapSource &b )
+        {
+                return std::max( a.width, a.height ) > std::max( b.width, b.height );
+        } );
+#endif
+
         for ( size_t i = 0; i < _sources.size(); i++ )
         {
-                dface_t *face = _loader->get_bspdata()->dfaces + _sources[i].facenum;
+                LightmapSource *src = &_sources[i];
 
 #ifdef LMPALETTE_SPLIT
                 bool any_fit = false;
@@ -125,10 +534,10 @@ LightmapPaletteDirectory LightmapPalettizer::palettize_lightmaps()
                 {
                         Palette *ppal = &result_vec[j];
                             
-                        if ( ppal->packer->wouldTextureFit( face->lightmap_size[0] + 1, face->lightmap_size[1] + 1, true, false, max_palette, max_palette ) )
+                        if ( ppal->packer->wouldTextureFit( src->width, src->height, true, false, max_palette, max_palette ) )
                         {
-                                ppal->packer->addNewTexture( face->lightmap_size[0] + 1, face->lightmap_size[1] + 1 );
-                                ppal->sources.push_back( &_sources[i] );
+                                ppal->packer->addNewTexture( src->width, src->height );
+                                ppal->sources.push_back( src );
                                 any_fit = true;
                                 break;
                         }
@@ -138,17 +547,18 @@ LightmapPaletteDirectory LightmapPalettizer::palettize_lightmaps()
                 {
                         // We need to make a new palette for this lightmap, it won't fit in the current ones.
                         Palette newpal;
-                        newpal.packer = TexturePacker::createTexturePacker();
-                        newpal.packer->addNewTexture( face->lightmap_size[0] + 1, face->lightmap_size[1] + 1 );
-                        newpal.sources.push_back( &_sources[i] );
+                        newpal.packer = TexturePacker::createTexturePacker( TexturePacker::PT_skyline );
+                        newpal.packer->addNewTexture( src->width, src->height );
+                        newpal.sources.push_back( src );
                         result_vec.push_back( newpal );
                 }
 #else
-                result_vec[0].packer->addNewTexture( face->lightmap_size[0] + 1, face->lightmap_size[1] + 1 );
-                result_vec[0].sources.push_back( &_sources[i] );
+                result_vec[0].packer->addNewTexture( src->width, src->height );
+                result_vec[0].sources.push_back( src );
 #endif
         }
 
+        JobSystem *jobs = JobSystem::get_global_ptr();
 
         // We've found a palette for each lightmap to fit in. Now we need to create the palette and remember
         // the offset into the palette for each face's lightmap.
@@ -161,91 +571,46 @@ LightmapPaletteDirectory LightmapPalettizer::palettize_lightmaps()
                 height = presult.get_height();
 
                 PT( LightmapPaletteDirectory::LightmapPaletteEntry ) entry = new LightmapPaletteDirectory::LightmapPaletteEntry;
+                entry->palette_tex = make_palette_texture( width, height );
 
-                for ( int n = 0; n < NUM_LIGHTMAPS; n++ )
-                {
-                        pal->palette_img[n] = PNMImage( width, height );
-			pal->palette_img[n].set_color_space( ColorSpace::CS_linear );
-			pal->palette_img[n].set_maxval( USHRT_MAX );
-                        pal->palette_img[n].fill( 0.0 );
-                }
-
-                entry->palette_tex = new Texture;
-                entry->palette_tex->setup_2d_texture_array( width, height, NUM_LIGHTMAPS, Texture::T_unsigned_short, Texture::F_rgb );
-                entry->palette_tex->set_minfilter( SamplerState::FT_linear_mipmap_linear );
-                entry->palette_tex->set_magfilter( SamplerState::FT_linear );
-
+                pvector<TextureLocation> locations;
+                locations.reserve( pal->sources.size() );
                 for ( size_t j = 0; j < pal->sources.size(); j++ )
                 {
-                        LightmapSource *src = pal->sources[j];
-                        int xshift, yshift, lmwidth, lmheight;
-                        bool rotated;
                         TextureLocation tloc = pal->packer->getTextureLocation( j );
-                        xshift = tloc.get_x();
-                        yshift = tloc.get_y();
-                        lmwidth = tloc.get_width();
-                        lmheight = tloc.get_height();
-                        rotated = tloc.get_rotated();
+                        locations.push_back( tloc );
 
                         PT( LightmapPaletteDirectory::LightmapFacePaletteEntry ) face_entry = new LightmapPaletteDirectory::LightmapFacePaletteEntry;
                         face_entry->palette = entry;
-                        face_entry->flipped = rotated;
-                        face_entry->xshift = xshift;
-                        face_entry->yshift = yshift;
+                        face_entry->flipped = tloc.get_rotated();
+                        face_entry->xshift = tloc.get_x();
+                        face_entry->yshift = tloc.get_y();
                         face_entry->palette_size[0] = width;
                         face_entry->palette_size[1] = height;
 
-                        // Bounced
-                        for ( int y = 0; y < lmheight; y++ )
-                        {
-                                for ( int x = 0; x < lmwidth; x++ )
-                                {
-                                        pal->palette_img[0].set_xel( x + xshift, y + yshift,
-                                                rotated ? src->lightmap_img[0].get_xel( y, x ) :
-                                                src->lightmap_img[0].get_xel( x, y ) );
-                                }
-                        }
+                        dir.face_index[pal->sources[j]->facenum] = face_entry;
+                        dir.face_entries.push_back( face_entry );
+                }
 
-                        if ( _loader->get_bspdata()->dfaces[src->facenum].bumped_lightmap )
-                        {
-                                for ( int n = 0; n < NUM_BUMP_VECTS + 1; n++ )
-                                {
-                                        for ( int y = 0; y < lmheight; y++ )
-                                        {
-                                                for ( int x = 0; x < lmwidth; x++ )
-                                                {
-                                                        pal->palette_img[n + 1].set_xel( x + xshift, y + yshift,
-                                                                                     rotated ? src->lightmap_img[n + 1].get_xel( y, x ) :
-                                                                                     src->lightmap_img[n + 1].get_xel( x, y ) );
-                                                }
-                                        }
-                                }
-                                
-                        }
-                        else
+                // Now decode every face's lightmaps into the palette.
+                Texture *tex = entry->palette_tex;
+                PTA_uchar image = tex->modify_ram_image();
+                unsigned char *ram_image = image.p();
+                jobs->parallel_process( pal->sources.size(), [&]( size_t begin, size_t end )
+                {
+                        for ( size_t j = begin; j < end; j++ )
                         {
-                                for ( int y = 0; y < lmheight; y++ )
-                                {
-                                        for ( int x = 0; x < lmwidth; x++ )
-                                        {
-                                                pal->palette_img[1].set_xel( x + xshift, y + yshift,
-                                                                             rotated ? src->lightmap_img[1].get_xel( y, x ) :
-                                                                             src->lightmap_img[1].get_xel( x, y ) );
-                                        }
-                                }
+                                const TextureLocation &tloc = locations[j];
+                                blit_source( pal->sources[j], tex, ram_image, tloc.get_x(), tloc.get_y(),
+                                             tloc.get_width(), tloc.get_height(), tloc.get_rotated() );
                         }
-                        
-                        
+                }, faces_per_job );
 
-                        
-                        dir.face_index[src->facenum] = face_entry;
-                        dir.face_entries.push_back( face_entry );
-                }
-
-                // load all palette images into our array texture
-                for ( int n = 0; n < NUM_LIGHTMAPS; n++ )
+                if ( _shared_exponent )
                 {
-                        entry->palette_tex->load( pal->palette_img[n], n, 0 );
+                        // The GPU can't generate mipmaps for a shared-exponent
+                        // texture since it isn't renderable.
+                        tex->generate_ram_mipmap_images();
                 }
 
                 dir.entries.push_back( entry );
@@ -254,5 +619,10 @@ LightmapPaletteDirectory LightmapPalettizer::palettize_lightmaps()
                 pal->packer = nullptr;
         }
 
+        if ( lightmap_palette_cache )
+        {
+                write_cache( dir, checksum );
+        }
+
         return dir;
 }
@@ -16,6 +16,8 @@
 #include <pvector.h>
 #include <notifyCategoryProxy.h>
 #include <aa_luse.h>
+#include <texture.h>
+#include <filename.h>
 
 #include "TexturePacker.h"
 #include "mathlib.h"
@@ -51,29 +53,20 @@ struct LightmapPaletteDirectory
 struct LightmapSource
 {
         int facenum;
-        PNMImage lightmap_img[NUM_LIGHTMAPS];
+        int width, height;
 
-        LightmapSource()
+        LightmapSource() :
+                facenum( -1 ),
+                width( 0 ),
+                height( 0 )
         {
-                for ( int i = 0; i < NUM_LIGHTMAPS; i++ )
-                {
-                        lightmap_img[i] = PNMImage( 1, 1 );
-                }
         }
 };
 
 struct Palette
 {
         pvector<LightmapSource *> sources;
-        PNMImage palette_img[NUM_LIGHTMAPS];
         TexturePacker *packer;
-        Palette()
-        {
-                for ( int i = 0; i < NUM_LIGHTMAPS; i++ )
-                {
-                        palette_img[i] = PNMImage( 1, 1 );
-                }
-        }
 };
 
 NotifyCategoryDeclNoExport(lightmapPalettizer);
@@ -99,9 +92,20 @@ public:
         LightmapPalettizer( const BSPLoader *loader );
         LightmapPaletteDirectory palettize_lightmaps();
 
+private:
+        PT( Texture ) make_palette_texture( int width, int height ) const;
+        void blit_source( const LightmapSource *src, Texture *tex,
+                          unsigned char *ram_image, int xshift, int yshift,
+                          int lmwidth, int lmheight, bool rotated ) const;
+
+        unsigned int calc_lighting_checksum() const;
+        bool read_cache( LightmapPaletteDirectory &dir, unsigned int checksum ) const;
+        void write_cache( const LightmapPaletteDirectory &dir, unsigned int checksum ) const;
+
 private:
         const BSPLoader *_loader;
         pvector<LightmapSource> _sources;
+        bool _shared_exponent;
 };
 
 #endif // LIGHTMAP_PALETTES_H
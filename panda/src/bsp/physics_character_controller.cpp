@@ -17,6 +17,85 @@
 
 #include "bsploader.h"
 
+#include <algorithm>
+
+/**
+ * Fills in the properties of the object that was hit.  This reads straight
+ * from the Bullet object, so it is safe to call while the BulletWorld lock is
+ * held.
+ */
+void CharacterHit::set_object( const btCollisionObject *obj )
+{
+	node = obj != nullptr ? (PandaNode *)obj->getUserPointer() : nullptr;
+	collision_response = obj != nullptr && obj->hasContactResponse();
+	mass = 0.0f;
+
+	const btRigidBody *body = obj != nullptr ? btRigidBody::upcast( obj ) : nullptr;
+	if ( body != nullptr && body->getInvMass() != 0.0f )
+		mass = 1.0f / body->getInvMass();
+}
+
+BulletWorldQueries::BulletWorldQueries( BulletWorld *world ) :
+	_world( world )
+{
+}
+
+bool BulletWorldQueries::ray_test_closest( const LPoint3 &from, const LPoint3 &to, const BitMask32 &mask,
+					   CharacterHit &hit ) const
+{
+	BulletClosestHitRayResult result = _world->ray_test_closest( from, to, mask );
+	if ( !result.has_hit() )
+		return false;
+
+	hit.set_object( BulletWorld::get_collision_object( result.get_node() ) );
+	hit.hit_pos = result.get_hit_pos();
+	hit.hit_normal = result.get_hit_normal();
+	hit.hit_fraction = result.get_hit_fraction();
+	hit.triangle_index = result.get_triangle_index();
+	return true;
+}
+
+void BulletWorldQueries::ray_test_all( const LPoint3 &from, const LPoint3 &to, const BitMask32 &mask,
+				       CharacterHits &hits ) const
+{
+	hits.clear();
+
+	BulletAllHitsRayResult result = _world->ray_test_all( from, to, mask );
+	for ( int i = 0; i < result.get_num_hits(); i++ )
+	{
+		BulletRayHit rh = result.get_hit( i );
+		CharacterHit hit;
+		hit.set_object( BulletWorld::get_collision_object( rh.get_node() ) );
+		hit.hit_pos = rh.get_hit_pos();
+		hit.hit_normal = rh.get_hit_normal();
+		hit.hit_fraction = rh.get_hit_fraction();
+		hit.triangle_index = rh.get_triangle_index();
+		hits.push_back( hit );
+	}
+
+	std::stable_sort( hits.begin(), hits.end(), []( const CharacterHit &a, const CharacterHit &b )
+	{
+		return ( a.hit_fraction < b.hit_fraction );
+	} );
+}
+
+bool BulletWorldQueries::sweep_test_closest( BulletShape *shape, const LPoint3 &from, const LPoint3 &to,
+					     const BitMask32 &mask, float penetration, CharacterHit &hit ) const
+{
+	CPT( TransformState ) from_ts = TransformState::make_pos( from );
+	CPT( TransformState ) to_ts = TransformState::make_pos( to );
+	BulletClosestHitSweepResult result = _world->sweep_test_closest( shape, *from_ts, *to_ts, mask, penetration );
+	if ( !result.has_hit() )
+		return false;
+
+	hit.set_object( BulletWorld::get_collision_object( result.get_node() ) );
+	hit.hit_pos = result.get_hit_pos();
+	hit.hit_normal = result.get_hit_normal();
+	hit.hit_fraction = result.get_hit_fraction();
+	hit.triangle_index = -1;
+	return true;
+}
+
 PhysicsCharacterController::PhysicsCharacterController( BSPLoader *loader, BulletWorld *world, const NodePath &render,
 							const NodePath &parent, float walk_height,
 							float crouch_height, float step_height, float radius,
@@ -111,6 +190,8 @@ void PhysicsCharacterController::setup_capsule( CapsuleData *data, bool attach )
 {
 	// Setup walk capsule
 	data->capsule = new BulletCapsuleShape( data->radius, data->height );
+	data->sweep_capsule = new BulletCapsuleShape( data->radius, data->height );
+	data->sweep_capsule->set_margin( data->sweep_capsule->get_margin() + 0.02f );
 	data->capsule_node = new BulletRigidBodyNode( "capsule" );
 	data->capsule_np = _movement_parent.attach_new_node( data->capsule_node );
 	data->capsule_node->add_shape( data->capsule );
@@ -164,25 +245,54 @@ void PhysicsCharacterController::place_on_ground()
 }
 
 void PhysicsCharacterController::update( float frametime )
+{
+	BulletWorldQueries queries( _world );
+
+	begin_update( frametime );
+	update_contacts( queries );
+	process_movement();
+	resolve_movement( queries );
+	end_update( queries );
+}
+
+/**
+ * Reads the current position of the character from the scene graph and
+ * dispatches the event sphere callbacks.
+ */
+void PhysicsCharacterController::begin_update( float frametime )
 {
 	_current_pos = _movement_parent.get_pos( _render );
 	_target_pos = LVector3( _current_pos );
+	_capsule_pos = _capsule_data->capsule_np.get_pos( _render );
 
+	_timestep = frametime;
+
+	update_event_sphere();
+	update_eye_ray();
+}
+
+/**
+ * Finds the ground and the ceiling around the character.
+ */
+void PhysicsCharacterController::update_contacts( const CharacterQueries &queries )
+{
 	// Check if there is a ground below us.
-	LPoint3 from = _capsule_data->capsule_np.get_pos( _render ) + LPoint3( 0, 0, 0.1f );
+	LPoint3 from = _capsule_pos + LPoint3( 0, 0, 0.1f );
 	LPoint3 to = from - LPoint3( 0, 0, 2000 );
-	BulletClosestHitRayResult result = _world->ray_test_closest( from, to, _floor_mask );
+	CharacterHit hit;
 	// Only fall is there is a ground for us to fall onto.
 	// Prevents the character from falling out of the world.
-	_above_ground = result.has_hit();
-
-	_timestep = frametime;
+	_above_ground = queries.ray_test_closest( from, to, _floor_mask, hit );
 
-	update_event_sphere();
-	update_eye_ray();
-	update_foot_contact();
-	update_head_contact();
+	update_foot_contact( queries );
+	update_head_contact( queries );
+}
 
+/**
+ * Runs the movement state machine.
+ */
+void PhysicsCharacterController::process_movement()
+{
 	switch ( _movement_state )
 	{
 	case MOVEMENTSTATE_GROUND:
@@ -198,14 +308,27 @@ void PhysicsCharacterController::update( float frametime )
 		process_swimming();
 		break;
 	}
+}
 
-	apply_linear_velocity();
-	prevent_penetration();
+/**
+ * Moves the target position along the linear velocity, and pushes it out of
+ * any walls along the way.
+ */
+void PhysicsCharacterController::resolve_movement( const CharacterQueries &queries )
+{
+	apply_linear_velocity( queries );
+	prevent_penetration( queries );
+}
 
+/**
+ * Moves the character to the new position in the scene graph.
+ */
+void PhysicsCharacterController::end_update( const CharacterQueries &queries )
+{
 	update_capsule();
 
 	if ( _is_crouching && !_enabled_crouch )
-		stand_up();
+		stand_up( queries );
 }
 
 void PhysicsCharacterController::apply_gravity( const LVector3 &normal )
@@ -213,11 +336,11 @@ void PhysicsCharacterController::apply_gravity( const LVector3 &normal )
 	_target_pos -= LVector3( normal[0], normal[1], 0.0f ) * _gravity * _timestep * 0.1f;
 }
 
-void PhysicsCharacterController::apply_linear_velocity()
+void PhysicsCharacterController::apply_linear_velocity( const CharacterQueries &queries )
 {
 	LVector3 global_vel = _linear_velocity * _timestep;
 
-	if ( _predict_future_space && !check_future_space( global_vel ) )
+	if ( _predict_future_space && !check_future_space( queries, global_vel ) )
 		return;
 
 	if ( _foot_contact.has_contact && _min_slope_dot != -1 && _movement_state != MOVEMENTSTATE_SWIMMING )
@@ -282,7 +405,7 @@ struct ShoveData
 	BulletContact contact;
 };
 
-void PhysicsCharacterController::prevent_penetration()
+void PhysicsCharacterController::prevent_penetration( const CharacterQueries &queries )
 {
 	if ( _no_clip )
 		return;
@@ -294,23 +417,20 @@ void PhysicsCharacterController::prevent_penetration()
 	LVector3 collisions( 0 );
 	LPoint3 offset( 0, 0, _capsule_offset );
 
-	float old_margin = _capsule_data->capsule->get_margin();
-	_capsule_data->capsule->set_margin( _capsule_data->capsule->get_margin() + 0.02f );
-
 	while ( fraction > 0.01f && max_itr > 0 )
 	{
 		LPoint3 current_target = _target_pos + collisions;
-		CPT( TransformState ) from = TransformState::make_pos( _current_pos + offset );
-		CPT( TransformState ) to = TransformState::make_pos( current_target + offset );
-		BulletClosestHitSweepResult result = _world->sweep_test_closest( _capsule_data->capsule, *from, *to, _wall_mask, 1e-7 );
-		if ( result.has_hit() && !result.get_node()->is_of_type( BulletGhostNode::get_class_type() ) )
+		LPoint3 from = _current_pos + offset;
+		LPoint3 to = current_target + offset;
+		CharacterHit hit;
+		if ( queries.sweep_test_closest( _capsule_data->sweep_capsule, from, to, _wall_mask, 1e-7, hit ) &&
+		     !hit.node->is_of_type( BulletGhostNode::get_class_type() ) )
 		{
-			BulletRigidBodyNode *node = DCAST( BulletRigidBodyNode, result.get_node() );
-			if ( node->get_collision_response() )
+			if ( hit.collision_response )
 			{
-				fraction -= result.get_hit_fraction();
-				LVector3 normal = result.get_hit_normal();
-				LVector3 direction = result.get_to_pos() - result.get_from_pos();
+				fraction -= hit.hit_fraction;
+				LVector3 normal = hit.hit_normal;
+				LVector3 direction = to - from;
 				float distance = direction.length();
 				direction.normalize();
 				if ( distance != 0.0f )
@@ -325,7 +445,6 @@ void PhysicsCharacterController::prevent_penetration()
 
 		max_itr -= 1;
 	}
-	_capsule_data->capsule->set_margin( old_margin );
 	collisions[2] = 0.0f;
 	_target_pos += collisions;
 #else // NEW_METHOD
@@ -355,24 +474,22 @@ void PhysicsCharacterController::prevent_penetration()
 #endif // NEW_METHOD
 }
 
-bool PhysicsCharacterController::check_future_space( const LVector3 &gv )
+bool PhysicsCharacterController::check_future_space( const CharacterQueries &queries, const LVector3 &gv )
 {
 	LVector3 global_vel = gv * _future_space_prediction_distance;
-	LPoint3 from = _capsule_data->capsule_np.get_pos( _render ) + global_vel;
+	LPoint3 from = _capsule_pos + global_vel;
 	LPoint3 up = from + LPoint3( 0, 0, _capsule_data->height * 2.0f );
 	LPoint3 down = from - LPoint3( 0, 0, _capsule_data->height * 2.0f + _capsule_data->levitation );
 
-	BulletClosestHitRayResult up_test = _world->ray_test_closest( from, up, _wall_mask );
-	BulletClosestHitRayResult down_test = _world->ray_test_closest( from, down, _floor_mask );
-
-	if ( !( up_test.has_hit() && down_test.has_hit() ) )
+	CharacterHit up_test, down_test;
+	if ( !queries.ray_test_closest( from, up, _wall_mask, up_test ) ||
+	     !queries.ray_test_closest( from, down, _floor_mask, down_test ) )
 		return true;
 
-	BulletRigidBodyNode *up_node = DCAST( BulletRigidBodyNode, up_test.get_node() );
-	if ( up_node->get_mass() > 0.0f )
+	if ( up_test.mass > 0.0f )
 		return true;
 
-	float space = std::fabsf( up_test.get_hit_pos()[2] - down_test.get_hit_pos()[2] );
+	float space = std::fabsf( up_test.hit_pos[2] - down_test.hit_pos[2] );
 
 	if ( space < _capsule_data->levitation + _capsule_data->height + _capsule_data->radius )
 		return false;
@@ -449,7 +566,7 @@ void PhysicsCharacterController::update_event_sphere()
 	_prev_overlapping = overlapping;
 }
 
-void PhysicsCharacterController::update_foot_contact()
+void PhysicsCharacterController::update_foot_contact( const CharacterQueries &queries )
 {
 	BSPLoader *loader = _bsp_loader;
 
@@ -458,55 +575,43 @@ void PhysicsCharacterController::update_foot_contact()
 		// If we aren't above a ground, check if we are below a ground.
 		// If we are below a ground, snap up to the ground.
 
-		LPoint3 from = _capsule_data->capsule_np.get_pos( _render );
+		LPoint3 from = _capsule_pos;
 		LPoint3 to = from + LPoint3( 0, 0, 2000 );
-		BulletClosestHitRayResult result = _world->ray_test_closest( from, to, _floor_mask );
-		if ( result.has_hit() )
+		CharacterHit hit;
+		if ( queries.ray_test_closest( from, to, _floor_mask, hit ) )
 		{
 			// We are below a ground, snap ourselves up to it.
-			_foot_contact.set_contact( DCAST( BulletRigidBodyNode, result.get_node() ),
-						   result.get_hit_pos(), result.get_hit_normal() );
+			_foot_contact.set_contact( DCAST( BulletRigidBodyNode, hit.node ),
+						   hit.hit_pos, hit.hit_normal );
 			_target_pos[2] = _foot_contact.hit_pos[2];
 			_movement_state = MOVEMENTSTATE_GROUND;
 			return;
 		}
 	}
 
-	LPoint3 from = _capsule_data->capsule_np.get_pos( _render );
+	LPoint3 from = _capsule_pos;
 	LPoint3 to = from - LPoint3( 0, 0, _foot_distance );
-	BulletAllHitsRayResult result = _world->ray_test_all( from, to, _wall_mask | _floor_mask );
-	if ( !result.has_hits() )
+	CharacterHits sorted_hits;
+	queries.ray_test_all( from, to, _wall_mask | _floor_mask, sorted_hits );
+	if ( sorted_hits.empty() )
 	{
 		_foot_contact.clear_contact();
 		return;
 	}
 
-	pvector<BulletRayHit> sorted_hits;
-
-	for ( int i = 0; i < result.get_num_hits(); i++ )
-	{
-		BulletRayHit hit = result.get_hit( i );
-		sorted_hits.push_back( hit );
-	}
-
-	std::sort( sorted_hits.begin(), sorted_hits.end(), []( const BulletRayHit &a, const BulletRayHit &b )
-	{
-		return ( a.get_hit_fraction() < b.get_hit_fraction() );
-	} );
-
 	for ( auto itr = sorted_hits.begin(); itr != sorted_hits.end(); itr++ )
 	{
-		BulletRayHit hit = *itr;
-		if ( hit.get_node()->is_of_type( BulletGhostNode::get_class_type() ) )
+		const CharacterHit &hit = *itr;
+		if ( hit.node->is_of_type( BulletGhostNode::get_class_type() ) )
 			continue;
 
-		BulletRigidBodyNode *node = DCAST( BulletRigidBodyNode, hit.get_node() );
+		BulletRigidBodyNode *node = DCAST( BulletRigidBodyNode, hit.node );
 
-		int triangle_idx = hit.get_triangle_index();
+		int triangle_idx = hit.triangle_index;
 		if ( _movement_state != MOVEMENTSTATE_SWIMMING && !_touching_water )
 		{
 			std::string mat = _default_material;
-			if ( loader->has_brush_collision_node( node ) )
+			if ( loader != nullptr && loader->has_brush_collision_node( node ) )
 			{
 				if ( loader->has_brush_collision_triangle( node, triangle_idx ) )
 				{
@@ -516,44 +621,32 @@ void PhysicsCharacterController::update_foot_contact()
 			_current_material = mat;
 		}
 
-		_foot_contact.set_contact( node, hit.get_hit_pos(), hit.get_hit_normal() );
+		_foot_contact.set_contact( node, hit.hit_pos, hit.hit_normal );
 		break;
 	}
 }
 
-void PhysicsCharacterController::update_head_contact()
+void PhysicsCharacterController::update_head_contact( const CharacterQueries &queries )
 {
-	LPoint3 from = _capsule_data->capsule_np.get_pos( _render );
+	LPoint3 from = _capsule_pos;
 	LPoint3 to = from + LPoint3( 0, 0, _capsule_data->height * 20.0f );
-	BulletAllHitsRayResult result = _world->ray_test_all( from, to, _wall_mask );
+	CharacterHits sorted_hits;
+	queries.ray_test_all( from, to, _wall_mask, sorted_hits );
 
-	if ( !result.has_hits() )
+	if ( sorted_hits.empty() )
 	{
 		_head_contact.clear_contact();
 		return;
 	}
 
-	pvector<BulletRayHit> sorted_hits;
-
-	for ( int i = 0; i < result.get_num_hits(); i++ )
-	{
-		BulletRayHit hit = result.get_hit( i );
-		sorted_hits.push_back( hit );
-	}
-
-	std::sort( sorted_hits.begin(), sorted_hits.end(), []( const BulletRayHit &a, const BulletRayHit &b )
-	{
-		return ( a.get_hit_fraction() < b.get_hit_fraction() );
-	} );
-
 	for ( auto itr = sorted_hits.begin(); itr != sorted_hits.end(); itr++ )
 	{
-		BulletRayHit hit = *itr;
-		if ( hit.get_node()->is_of_type( BulletGhostNode::get_class_type() ) )
+		const CharacterHit &hit = *itr;
+		if ( hit.node->is_of_type( BulletGhostNode::get_class_type() ) )
 			continue;
 
-		BulletRigidBodyNode *node = DCAST( BulletRigidBodyNode, hit.get_node() );
-		_head_contact.set_contact( node, hit.get_hit_pos(), hit.get_hit_normal() );
+		BulletRigidBodyNode *node = DCAST( BulletRigidBodyNode, hit.node );
+		_head_contact.set_contact( node, hit.hit_pos, hit.hit_normal );
 		break;
 	}
 }
@@ -621,9 +714,11 @@ void PhysicsCharacterController::jump( float max_height )
 	evh->dispatch_event( new Event( "jumpStart" ) );
 }
 
-void PhysicsCharacterController::stand_up()
+void PhysicsCharacterController::stand_up( const CharacterQueries &queries )
 {
-	update_head_contact();
+	// We may have moved since the contacts were last updated.
+	_capsule_pos = _capsule_data->capsule_np.get_pos( _render );
+	update_head_contact( queries );
 
 	if ( _head_contact.has_contact )
 	{
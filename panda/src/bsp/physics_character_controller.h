@@ -61,12 +61,66 @@ struct ContactData
 	}
 };
 
+// The result of a ray or sweep test, as far as the character controller cares.
+struct CharacterHit
+{
+	PandaNode *node;
+	LPoint3 hit_pos;
+	LVector3 hit_normal;
+	float hit_fraction;
+	int triangle_index;
+	float mass;
+	bool collision_response;
+
+	void set_object( const btCollisionObject *obj );
+};
+
+typedef pvector<CharacterHit> CharacterHits;
+
+/**
+ * The ray and sweep tests a character controller needs to do its work.  The
+ * default implementation goes through the BulletWorld, one query at a time.
+ * PhysicsCharacterControllerGroup supplies one that runs on worker threads.
+ */
+class CharacterQueries
+{
+public:
+	virtual ~CharacterQueries() {}
+
+	virtual bool ray_test_closest( const LPoint3 &from, const LPoint3 &to, const BitMask32 &mask,
+				       CharacterHit &hit ) const = 0;
+	// Fills in all hits along the ray, sorted by hit fraction.
+	virtual void ray_test_all( const LPoint3 &from, const LPoint3 &to, const BitMask32 &mask,
+				   CharacterHits &hits ) const = 0;
+	virtual bool sweep_test_closest( BulletShape *shape, const LPoint3 &from, const LPoint3 &to,
+					 const BitMask32 &mask, float penetration, CharacterHit &hit ) const = 0;
+};
+
+class BulletWorldQueries : public CharacterQueries
+{
+public:
+	BulletWorldQueries( BulletWorld *world );
+
+	virtual bool ray_test_closest( const LPoint3 &from, const LPoint3 &to, const BitMask32 &mask,
+				       CharacterHit &hit ) const;
+	virtual void ray_test_all( const LPoint3 &from, const LPoint3 &to, const BitMask32 &mask,
+				   CharacterHits &hits ) const;
+	virtual bool sweep_test_closest( BulletShape *shape, const LPoint3 &from, const LPoint3 &to,
+					 const BitMask32 &mask, float penetration, CharacterHit &hit ) const;
+
+private:
+	BulletWorld *_world;
+};
+
 struct CapsuleData
 {
 	float height;
 	float levitation;
 	float radius;
 	PT( BulletCapsuleShape ) capsule;
+	// A copy of the capsule with a slightly bigger margin, used when sweeping
+	// the character through the world.
+	PT( BulletCapsuleShape ) sweep_capsule;
 	PT( BulletRigidBodyNode ) capsule_node;
 	NodePath capsule_np;
 };
@@ -195,25 +249,42 @@ PUBLISHED:
 
 	void remove_capsules();
 
+public:
+	// update() is split up into these phases, so that
+	// PhysicsCharacterControllerGroup can run the ones that only do
+	// queries against the world for many controllers at once.
+	// update_contacts() and resolve_movement() don't touch the scene graph
+	// or call into Python.
+	void begin_update( float frametime );
+	void update_contacts( const CharacterQueries &queries );
+	void process_movement();
+	void resolve_movement( const CharacterQueries &queries );
+	void end_update( const CharacterQueries &queries );
+
+	INLINE BulletWorld *get_world() const
+	{
+		return _world;
+	}
+
 private:
 	void update_event_sphere();
 	void update_eye_ray();
-	void update_foot_contact();
-	void update_head_contact();
+	void update_foot_contact( const CharacterQueries &queries );
+	void update_head_contact( const CharacterQueries &queries );
 	void update_capsule();
-	void apply_linear_velocity();
-	void prevent_penetration();
+	void apply_linear_velocity( const CharacterQueries &queries );
+	void prevent_penetration( const CharacterQueries &queries );
 	void setup( float walk_height, float crouch_height, float step_height, float radius );
 	void add_elements();
 	void land();
 	void fall();
-	void stand_up();
+	void stand_up( const CharacterQueries &queries );
 	void jump( float max_z = 3.0f );
 	void process_ground();
 	void process_falling();
 	void process_jumping();
 	void process_swimming();
-	bool check_future_space( const LVector3 &global_vel );
+	bool check_future_space( const CharacterQueries &queries, const LVector3 &global_vel );
 
 	void apply_gravity( const LVector3 &floor_normal );
 
@@ -229,6 +300,7 @@ private:
 	float _timestep;
 	LVector3 _target_pos;
 	LVector3 _current_pos;
+	LPoint3 _capsule_pos;
 
 	CapsuleData _walk_capsule_data;
 	CapsuleData _crouch_capsule_data;
@@ -0,0 +1,333 @@
+/**
+ * PANDA3D BSP LIBRARY
+ *
+ * Copyright (c) Brian Lach <brianlach72@gmail.com>
+ * All rights reserved.
+ *
+ * @file physics_character_controller_group.cpp
+ * @author Brian Lach
+ * @date October 16, 2026
+ */
+
+#include "physics_character_controller_group.h"
+
+#include <jobSystem.h>
+#include <lightMutexHolder.h>
+#include <pStatTimer.h>
+#include <configVariableInt.h>
+
+#include <algorithm>
+
+static ConfigVariableInt character_controllers_per_job( "character-controllers-per-job", 8,
+							"The number of character controllers that a single worker "
+							"thread handles at a time in PhysicsCharacterControllerGroup." );
+
+PStatCollector PhysicsCharacterControllerGroup::_update_collector( "App:CharacterControllers" );
+PStatCollector PhysicsCharacterControllerGroup::_begin_collector( "App:CharacterControllers:Begin" );
+PStatCollector PhysicsCharacterControllerGroup::_contacts_collector( "App:CharacterControllers:Contacts" );
+PStatCollector PhysicsCharacterControllerGroup::_process_collector( "App:CharacterControllers:Process" );
+PStatCollector PhysicsCharacterControllerGroup::_resolve_collector( "App:CharacterControllers:Resolve" );
+PStatCollector PhysicsCharacterControllerGroup::_end_collector( "App:CharacterControllers:End" );
+
+/**
+ * Collects the collision objects whose bounding boxes overlap a box and whose
+ * into-collide mask matches, in the same way the BulletWorld query results
+ * filter them.
+ */
+class CandidateCollector : public btBroadphaseAabbCallback
+{
+public:
+	CandidateCollector( const BitMask32 &mask, pvector<const btCollisionObject *> &objects ) :
+		_mask( mask ),
+		_objects( objects )
+	{
+	}
+
+	virtual bool process( const btBroadphaseProxy *proxy )
+	{
+		const btCollisionObject *obj = (const btCollisionObject *)proxy->m_clientObject;
+		PandaNode *node = (PandaNode *)obj->getUserPointer();
+		if ( node != nullptr && ( node->get_into_collide_mask() & _mask ) != 0 )
+			_objects.push_back( obj );
+		return true;
+	}
+
+private:
+	BitMask32 _mask;
+	pvector<const btCollisionObject *> &_objects;
+};
+
+class ClosestRayCallback : public btCollisionWorld::ClosestRayResultCallback
+{
+public:
+	ClosestRayCallback( const btVector3 &from, const btVector3 &to ) :
+		btCollisionWorld::ClosestRayResultCallback( from, to ),
+		_triangle_index( -1 )
+	{
+	}
+
+	virtual btScalar addSingleResult( btCollisionWorld::LocalRayResult &result, bool normal_in_world_space )
+	{
+		_triangle_index = result.m_localShapeInfo ? result.m_localShapeInfo->m_triangleIndex : -1;
+		return btCollisionWorld::ClosestRayResultCallback::addSingleResult( result, normal_in_world_space );
+	}
+
+	int _triangle_index;
+};
+
+class AllHitsRayCallback : public btCollisionWorld::AllHitsRayResultCallback
+{
+public:
+	AllHitsRayCallback( const btVector3 &from, const btVector3 &to ) :
+		btCollisionWorld::AllHitsRayResultCallback( from, to )
+	{
+	}
+
+	virtual btScalar addSingleResult( btCollisionWorld::LocalRayResult &result, bool normal_in_world_space )
+	{
+		_triangle_indices.push_back( result.m_localShapeInfo ? result.m_localShapeInfo->m_triangleIndex : -1 );
+		return btCollisionWorld::AllHitsRayResultCallback::addSingleResult( result, normal_in_world_space );
+	}
+
+	pvector<int> _triangle_indices;
+};
+
+/**
+ * Runs queries directly against the Bullet collision world, bypassing the
+ * BulletWorld lock, so that they can be issued from several threads at once.
+ *
+ * The broadphase ray test keeps its traversal stack in the broadphase itself
+ * unless Bullet was built with BT_THREADSAFE, so candidates are gathered with
+ * an AABB test instead, which uses a local stack.  The narrowphase tests are
+ * stateless.  The caller must hold the BulletWorld lock for as long as these
+ * queries may run, so that nobody modifies the world in the meantime.
+ */
+class ParallelQueries : public CharacterQueries
+{
+public:
+	ParallelQueries( BulletWorld *world ) :
+		_broadphase( world->get_broadphase() )
+	{
+	}
+
+	virtual bool ray_test_closest( const LPoint3 &from, const LPoint3 &to, const BitMask32 &mask,
+				       CharacterHit &hit ) const
+	{
+		btVector3 bt_from = LVecBase3_to_btVector3( from );
+		btVector3 bt_to = LVecBase3_to_btVector3( to );
+
+		pvector<const btCollisionObject *> candidates;
+		collect_ray_candidates( bt_from, bt_to, mask, candidates );
+
+		ClosestRayCallback cb( bt_from, bt_to );
+		btTransform from_trans( btMatrix3x3::getIdentity(), bt_from );
+		btTransform to_trans( btMatrix3x3::getIdentity(), bt_to );
+		for ( size_t i = 0; i < candidates.size(); i++ )
+		{
+			const btCollisionObject *obj = candidates[i];
+			btCollisionWorld::rayTestSingle( from_trans, to_trans, (btCollisionObject *)obj,
+							 obj->getCollisionShape(), obj->getWorldTransform(), cb );
+		}
+
+		if ( !cb.hasHit() )
+			return false;
+
+		hit.set_object( cb.m_collisionObject );
+		hit.hit_pos = btVector3_to_LPoint3( cb.m_hitPointWorld );
+		hit.hit_normal = btVector3_to_LVector3( cb.m_hitNormalWorld );
+		hit.hit_fraction = cb.m_closestHitFraction;
+		hit.triangle_index = cb._triangle_index;
+		return true;
+	}
+
+	virtual void ray_test_all( const LPoint3 &from, const LPoint3 &to, const BitMask32 &mask,
+				   CharacterHits &hits ) const
+	{
+		hits.clear();
+
+		btVector3 bt_from = LVecBase3_to_btVector3( from );
+		btVector3 bt_to = LVecBase3_to_btVector3( to );
+
+		pvector<const btCollisionObject *> candidates;
+		collect_ray_candidates( bt_from, bt_to, mask, candidates );
+
+		AllHitsRayCallback cb( bt_from, bt_to );
+		btTransform from_trans( btMatrix3x3::getIdentity(), bt_from );
+		btTransform to_trans( btMatrix3x3::getIdentity(), bt_to );
+		for ( size_t i = 0; i < candidates.size(); i++ )
+		{
+			const btCollisionObject *obj = candidates[i];
+			btCollisionWorld::rayTestSingle( from_trans, to_trans, (btCollisionObject *)obj,
+							 obj->getCollisionShape(), obj->getWorldTransform(), cb );
+		}
+
+		hits.reserve( cb.m_collisionObjects.size() );
+		for ( int i = 0; i < cb.m_collisionObjects.size(); i++ )
+		{
+			CharacterHit hit;
+			hit.set_object( cb.m_collisionObjects[i] );
+			hit.hit_pos = btVector3_to_LPoint3( cb.m_hitPointWorld[i] );
+			hit.hit_normal = btVector3_to_LVector3( cb.m_hitNormalWorld[i] );
+			hit.hit_fraction = cb.m_hitFractions[i];
+			hit.triangle_index = cb._triangle_indices[i];
+			hits.push_back( hit );
+		}
+
+		std::stable_sort( hits.begin(), hits.end(), []( const CharacterHit &a, const CharacterHit &b )
+		{
+			return ( a.hit_fraction < b.hit_fraction );
+		} );
+	}
+
+	virtual bool sweep_test_closest( BulletShape *shape, const LPoint3 &from, const LPoint3 &to,
+					 const BitMask32 &mask, float penetration, CharacterHit &hit ) const
+	{
+		const btConvexShape *convex = (const btConvexShape *)shape->ptr();
+		nassertr( convex->isConvex(), false );
+
+		btVector3 bt_from = LVecBase3_to_btVector3( from );
+		btVector3 bt_to = LVecBase3_to_btVector3( to );
+		btTransform from_trans( btMatrix3x3::getIdentity(), bt_from );
+		btTransform to_trans( btMatrix3x3::getIdentity(), bt_to );
+
+		// The shape only translates, so the swept volume is bounded by the
+		// union of its boxes at both ends.
+		btVector3 aabb_min, aabb_max, end_min, end_max;
+		convex->getAabb( from_trans, aabb_min, aabb_max );
+		convex->getAabb( to_trans, end_min, end_max );
+		aabb_min.setMin( end_min );
+		aabb_max.setMax( end_max );
+
+		pvector<const btCollisionObject *> candidates;
+		CandidateCollector collector( mask, candidates );
+		_broadphase->aabbTest( aabb_min, aabb_max, collector );
+
+		btCollisionWorld::ClosestConvexResultCallback cb( bt_from, bt_to );
+		for ( size_t i = 0; i < candidates.size(); i++ )
+		{
+			const btCollisionObject *obj = candidates[i];
+			btCollisionWorld::objectQuerySingle( convex, from_trans, to_trans, (btCollisionObject *)obj,
+							     obj->getCollisionShape(), obj->getWorldTransform(),
+							     cb, penetration );
+		}
+
+		if ( !cb.hasHit() )
+			return false;
+
+		hit.set_object( cb.m_hitCollisionObject );
+		hit.hit_pos = btVector3_to_LPoint3( cb.m_hitPointWorld );
+		hit.hit_normal = btVector3_to_LVector3( cb.m_hitNormalWorld );
+		hit.hit_fraction = cb.m_closestHitFraction;
+		hit.triangle_index = -1;
+		return true;
+	}
+
+private:
+	void collect_ray_candidates( const btVector3 &from, const btVector3 &to, const BitMask32 &mask,
+				     pvector<const btCollisionObject *> &candidates ) const
+	{
+		btVector3 aabb_min = from;
+		btVector3 aabb_max = from;
+		aabb_min.setMin( to );
+		aabb_max.setMax( to );
+
+		CandidateCollector collector( mask, candidates );
+		_broadphase->aabbTest( aabb_min, aabb_max, collector );
+	}
+
+	btBroadphaseInterface *_broadphase;
+};
+
+PhysicsCharacterControllerGroup::PhysicsCharacterControllerGroup( BulletWorld *world ) :
+	_world( world )
+{
+	nassertv( world != nullptr );
+}
+
+/**
+ * Adds a controller to the group.  It should no longer be updated on its own.
+ * The controller must live in the same BulletWorld as the group.
+ */
+void PhysicsCharacterControllerGroup::add_controller( PhysicsCharacterController *controller )
+{
+	nassertv( controller != nullptr );
+	nassertv( controller->get_world() == _world );
+
+	if ( std::find( _controllers.begin(), _controllers.end(), controller ) == _controllers.end() )
+		_controllers.push_back( controller );
+}
+
+void PhysicsCharacterControllerGroup::remove_controller( PhysicsCharacterController *controller )
+{
+	Controllers::iterator it = std::find( _controllers.begin(), _controllers.end(), controller );
+	if ( it != _controllers.end() )
+		_controllers.erase( it );
+}
+
+void PhysicsCharacterControllerGroup::clear_controllers()
+{
+	_controllers.clear();
+}
+
+/**
+ * Runs the given query phase for every controller, spread across the worker
+ * threads.  The world is locked for the duration.
+ */
+void PhysicsCharacterControllerGroup::run_queries( void ( PhysicsCharacterController::*phase )( const CharacterQueries & ) )
+{
+	LightMutexHolder holder( BulletWorld::get_global_lock() );
+
+	ParallelQueries queries( _world );
+	JobSystem::get_global_ptr()->parallel_process( _controllers.size(), [&]( size_t begin, size_t end )
+	{
+		for ( size_t i = begin; i < end; i++ )
+		{
+			( _controllers[i]->*phase )( queries );
+		}
+	}, std::max( (int)character_controllers_per_job, 1 ) );
+}
+
+/**
+ * Steps all of the controllers in the group.  This has the same effect as
+ * calling update() on each controller, except that the controllers don't see
+ * each other's movement until the next frame.
+ */
+void PhysicsCharacterControllerGroup::update( float frametime )
+{
+	PStatTimer timer( _update_collector );
+
+	{
+		PStatTimer timer2( _begin_collector );
+		for ( size_t i = 0; i < _controllers.size(); i++ )
+		{
+			_controllers[i]->begin_update( frametime );
+		}
+	}
+
+	{
+		PStatTimer timer2( _contacts_collector );
+		run_queries( &PhysicsCharacterController::update_contacts );
+	}
+
+	{
+		PStatTimer timer2( _process_collector );
+		for ( size_t i = 0; i < _controllers.size(); i++ )
+		{
+			_controllers[i]->process_movement();
+		}
+	}
+
+	{
+		PStatTimer timer2( _resolve_collector );
+		run_queries( &PhysicsCharacterController::resolve_movement );
+	}
+
+	{
+		PStatTimer timer2( _end_collector );
+		BulletWorldQueries queries( _world );
+		for ( size_t i = 0; i < _controllers.size(); i++ )
+		{
+			_controllers[i]->end_update( queries );
+		}
+	}
+}
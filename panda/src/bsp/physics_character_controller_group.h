@@ -0,0 +1,74 @@
+/**
+ * PANDA3D BSP LIBRARY
+ *
+ * Copyright (c) Brian Lach <brianlach72@gmail.com>
+ * All rights reserved.
+ *
+ * @file physics_character_controller_group.h
+ * @author Brian Lach
+ * @date October 16, 2026
+ */
+
+#ifndef PHYSICS_CHARACTER_CONTROLLER_GROUP_H
+#define PHYSICS_CHARACTER_CONTROLLER_GROUP_H
+
+#include "physics_character_controller.h"
+
+#include <pvector.h>
+#include <pointerTo.h>
+#include <pStatCollector.h>
+
+/**
+ * Steps a set of PhysicsCharacterControllers that share a BulletWorld
+ * together.
+ *
+ * The controllers are updated in phases.  The phases that only query the
+ * world (finding the ground and ceiling, and sweeping the capsule along its
+ * velocity) are run for all controllers at once on the JobSystem's worker
+ * threads, while the world is locked against modification.  The phases that
+ * touch the scene graph or call back into Python are still run one
+ * controller at a time on the calling thread, in the order the controllers
+ * were added.
+ *
+ * All queries in a phase see the world as it was at the start of that
+ * phase, so the results do not depend on the number of worker threads.
+ */
+class EXPCL_PANDABSP PhysicsCharacterControllerGroup : public ReferenceCount
+{
+PUBLISHED:
+	PhysicsCharacterControllerGroup( BulletWorld *world );
+
+	void add_controller( PhysicsCharacterController *controller );
+	void remove_controller( PhysicsCharacterController *controller );
+	void clear_controllers();
+
+	INLINE int get_num_controllers() const
+	{
+		return (int)_controllers.size();
+	}
+	INLINE PhysicsCharacterController *get_controller( int n ) const
+	{
+		nassertr( n >= 0 && n < (int)_controllers.size(), nullptr );
+		return _controllers[n];
+	}
+
+	void update( float frametime );
+
+private:
+	void run_queries( void ( PhysicsCharacterController::*phase )( const CharacterQueries & ) );
+
+private:
+	PT( BulletWorld ) _world;
+
+	typedef pvector<PT( PhysicsCharacterController )> Controllers;
+	Controllers _controllers;
+
+	static PStatCollector _update_collector;
+	static PStatCollector _begin_collector;
+	static PStatCollector _contacts_collector;
+	static PStatCollector _process_collector;
+	static PStatCollector _resolve_collector;
+	static PStatCollector _end_collector;
+};
+
+#endif // PHYSICS_CHARACTER_CONTROLLER_GROUP_H
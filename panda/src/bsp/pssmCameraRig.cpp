@@ -41,9 +41,16 @@
 #include <collisionNode.h>
 #include <collisionPlane.h>
 #include <meshDrawer.h>
+#include <geometricBoundingVolume.h>
 
 PStatCollector PSSMCameraRig::_update_collector( "App:CSM:Update" );
+PStatCollector PSSMCameraRig::_cull_casters_collector( "App:CSM:Update:CullCasters" );
 static PStatCollector create_union_collector( "App:CSM:Update:MakeCullBounds" );
+static PStatCollector recomputed_cascades_collector( "CSM cascades:Recomputed" );
+static PStatCollector held_cascades_collector( "CSM cascades:Held" );
+static PStatCollector dirty_cascades_collector( "CSM cascades:Dirty" );
+static PStatCollector rendered_passes_collector( "CSM passes:Rendered" );
+static PStatCollector skipped_passes_collector( "CSM passes:Skipped" );
 
 static LightMutex csm_mutex( "CSMMutex" );
 
@@ -79,6 +86,10 @@ PSSMCameraRig::PSSMCameraRig( size_t num_splits, BSPShaderGenerator *gen )
         _camera_nearfar = PTA_LVecBase2::empty_array( num_splits );
         _camera_viewmatrix = PTA_LMatrix4::empty_array( num_splits );
         _sun_vector = PTA_LVecBase3f::empty_array( 1 );
+        _last_light_vector.fill( 0 );
+        _force_dirty = true;
+        _skip_clean_passes = false;
+        _is_setup = false;
         _gen = gen;
         init_cam_nodes();
 }
@@ -103,6 +114,7 @@ void PSSMCameraRig::init_cam_nodes()
         _cam_nodes.reserve( _num_splits );
         _max_film_sizes.resize( _num_splits );
         _cameras.resize( _num_splits );
+        _cascades.resize( _num_splits );
         for ( size_t i = 0; i < _num_splits; ++i )
         {
                 // Construct a new lens
@@ -116,6 +128,13 @@ void PSSMCameraRig::init_cam_nodes()
                 //_cameras[i]->show_frustum();
                 _cam_nodes.push_back( NodePath( _cameras[i] ) );
                 _max_film_sizes[i].fill( 0 );
+
+                CascadeState &cascade = _cascades[i];
+                cascade.policy = CUP_every_frame;
+                cascade.interval = 1;
+                cascade.frames_since_update = 0;
+                cascade.has_mvp = false;
+                cascade.dirty = true;
         }
 }
 
@@ -137,10 +156,18 @@ void PSSMCameraRig::reparent_to( NodePath parent )
                 _cam_nodes[i].reparent_to( parent );
         }
         _parent = parent;
-        dbg_draw.set_budget( 1000 );
-        dbg_root = dbg_draw.get_root();
-        dbg_root.reparent_to( _gen->_render );
-        dbg_root.set_two_sided( true );
+        mark_all_cascades_dirty();
+
+        if ( _gen != nullptr )
+        {
+                dbg_draw.set_budget( 1000 );
+                dbg_root = dbg_draw.get_root();
+                dbg_root.reparent_to( _gen->_render );
+                dbg_root.set_two_sided( true );
+        }
+
+        LightMutexHolder holder( csm_mutex );
+        _is_setup = true;
 }
 
 /**
@@ -649,9 +676,51 @@ void PSSMCameraRig::compute_pssm_splits( const LMatrix4& transform, float max_di
 
         float filmsize_bias = 1.0 + _border_bias;
 
+        // A rotated sun invalidates everything we have held on to.
+        if ( !light_vector.almost_equal( _last_light_vector ) )
+        {
+                _last_light_vector = light_vector;
+                _force_dirty = true;
+        }
+
+        // Any change in the snapped matrix of a stable split is a whole
+        // number of texels, so this is plenty to tell apart real changes from
+        // floating point noise.
+        float snap_threshold = 0.5f / (float)std::max( _resolution, (size_t)1 );
+
+        int recomputed = 0;
+
         // Compute the positions of all cameras
         for ( size_t i = 0; i < _cam_nodes.size(); ++i )
         {
+                CascadeState &cascade = _cascades[i];
+                cascade.frames_since_update++;
+                cascade.dirty = false;
+
+                bool forced = _force_dirty || !cascade.has_mvp;
+                if ( cascade.policy == CUP_interval && !forced &&
+                     cascade.frames_since_update < cascade.interval )
+                {
+                        // Hold on to the matrices from the last update.  The
+                        // shadow map may still get re-rendered this frame, but
+                        // from the same point of view as before.
+                        continue;
+                }
+
+                if ( forced && cascade.policy == CUP_interval )
+                {
+                        // Every split gets recomputed on a forced pass.  Stagger
+                        // the interval splits from here on, so that splits
+                        // sharing an interval don't all come due on the same
+                        // frame again.
+                        cascade.frames_since_update = (int)( i % cascade.interval );
+                }
+                else
+                {
+                        cascade.frames_since_update = 0;
+                }
+                recomputed++;
+
                 float split_start = get_split_start( i ) * max_distance;
                 float split_end = get_split_start( i + 1 ) * max_distance;
 
@@ -727,10 +796,33 @@ void PSSMCameraRig::compute_pssm_splits( const LMatrix4& transform, float max_di
                         mvp = compute_mvp( i );
                 }
 
-                _camera_viewmatrix.set_element( i, merged_transform );
-                _camera_mvps.set_element( i, mvp );
+                bool changed = !cascade.has_mvp || _force_dirty ||
+                        !mvp.almost_equal( _camera_mvps[i], snap_threshold );
+                cascade.dirty = changed || cascade.policy == CUP_every_frame;
+
+                if ( changed )
+                {
+                        _camera_viewmatrix.set_element( i, merged_transform );
+                        _camera_mvps.set_element( i, mvp );
+                        cascade.has_mvp = true;
+                }
+
+                PT( BoundingVolume ) bounds = cam->get_lens()->make_bounds();
+                if ( bounds != nullptr && bounds->is_of_type( GeometricBoundingVolume::get_class_type() ) )
+                {
+                        cascade.bounds = DCAST( GeometricBoundingVolume, bounds );
+                        cascade.bounds->xform( _cam_nodes[i].get_transform( _parent )->get_mat() );
+                }
+                else
+                {
+                        cascade.bounds = nullptr;
+                }
         }
 
+        _force_dirty = false;
+        recomputed_cascades_collector.set_level( recomputed );
+        held_cascades_collector.set_level( (double)_cam_nodes.size() - recomputed );
+
 #if CSM_TIGHT_BOUNDS
         create_union_collector.start();
         
@@ -845,9 +937,282 @@ void PSSMCameraRig::update( NodePath cam_node, const LVecBase3 &light_vector )
         // Do the actual PSSM
         compute_pssm_splits( transform, _pssm_distance / lens->get_far(), light_vector, cam );
 
+        // Find out which of the remaining splits have casters moving around in
+        // them.
+        cull_dynamic_casters();
+
+        int num_dirty = get_num_dirty_cascades();
+        dirty_cascades_collector.set_level( num_dirty );
+
+        if ( _skip_clean_passes && _shadow_dr != nullptr )
+        {
+                // All of the splits are rendered in a single layered pass, so we
+                // can only skip it when none of them changed.
+                _shadow_dr->set_active( num_dirty > 0 );
+                rendered_passes_collector.set_level( num_dirty > 0 ? 1 : 0 );
+                skipped_passes_collector.set_level( num_dirty > 0 ? 0 : 1 );
+        }
+        else
+        {
+                rendered_passes_collector.set_level( 1 );
+                skipped_passes_collector.set_level( 0 );
+        }
+
         _update_collector.stop();
 }
 
+/**
+* @brief Internal method to find the splits affected by moving casters
+* @details This checks every registered dynamic caster for a changed transform
+*   or bounding volume. The volumes it covered before and after the change are
+*   tested against the volume of each split, and each split that intersects
+*   either of them is marked dirty.
+*/
+void PSSMCameraRig::cull_dynamic_casters()
+{
+        if ( _dynamic_casters.empty() || _parent.is_empty() )
+                return;
+
+        _cull_casters_collector.start();
+
+        pvector<PT( GeometricBoundingVolume )> changed_volumes;
+
+        for ( size_t i = 0; i < _dynamic_casters.size(); )
+        {
+                DynamicCaster &caster = _dynamic_casters[i];
+                if ( caster.np.was_deleted() )
+                {
+                        // The caster went away, so its old shadow has to go too.
+                        if ( caster.last_bounds != nullptr )
+                                changed_volumes.push_back( caster.last_bounds );
+                        _dynamic_casters.erase( _dynamic_casters.begin() + i );
+                        continue;
+                }
+
+                NodePath np = caster.np.get_node_path();
+
+                // Both of these are cached by the scene graph, so a pointer
+                // comparison is enough to tell whether anything moved.
+                CPT( TransformState ) transform = np.get_transform( _parent );
+                CPT( BoundingVolume ) node_bounds = np.node()->get_bounds();
+                if ( transform == caster.last_transform && node_bounds == caster.last_node_bounds )
+                {
+                        i++;
+                        continue;
+                }
+
+                if ( caster.last_bounds != nullptr )
+                        changed_volumes.push_back( caster.last_bounds );
+
+                caster.last_transform = transform;
+                caster.last_node_bounds = node_bounds;
+                caster.last_bounds = nullptr;
+                if ( !node_bounds->is_empty() &&
+                     node_bounds->is_of_type( GeometricBoundingVolume::get_class_type() ) )
+                {
+                        PT( BoundingVolume ) copy = node_bounds->make_copy();
+                        caster.last_bounds = DCAST( GeometricBoundingVolume, copy );
+                        caster.last_bounds->xform( transform->get_mat() );
+                        changed_volumes.push_back( caster.last_bounds );
+                }
+
+                i++;
+        }
+
+        for ( size_t i = 0; i < _cascades.size() && !changed_volumes.empty(); i++ )
+        {
+                CascadeState &cascade = _cascades[i];
+                if ( cascade.dirty )
+                        continue;
+
+                if ( cascade.bounds == nullptr )
+                {
+                        cascade.dirty = true;
+                        continue;
+                }
+
+                for ( size_t j = 0; j < changed_volumes.size(); j++ )
+                {
+                        if ( cascade.bounds->contains( changed_volumes[j] ) != BoundingVolume::IF_no_intersection )
+                        {
+                                cascade.dirty = true;
+                                break;
+                        }
+                }
+        }
+
+        _cull_casters_collector.stop();
+}
+
+/**
+* @brief Sets the update policy of a split
+* @details This controls how often the given split gets recomputed, and when it
+*   is considered changed. Far splits cover a large area with few texels, so
+*   they can usually get away with being updated every few frames.
+*
+*   If an invalid index is passed, an assertion is thrown.
+*
+* @param split Index of the split
+* @param policy The update policy
+* @param interval Number of frames between updates, for CUP_interval
+*/
+void PSSMCameraRig::set_cascade_update_policy( size_t split, CascadeUpdatePolicy policy, int interval )
+{
+        LightMutexHolder holder( csm_mutex );
+
+        nassertv( split < _cascades.size() );
+        nassertv( interval >= 1 );
+        _cascades[split].policy = policy;
+        _cascades[split].interval = interval;
+        _cascades[split].frames_since_update = (int)( split % interval );
+        _cascades[split].dirty = true;
+}
+
+/**
+* @brief Returns the update policy of a split
+*
+* @param split Index of the split
+* @return The update policy
+*/
+PSSMCameraRig::CascadeUpdatePolicy PSSMCameraRig::get_cascade_update_policy( size_t split ) const
+{
+        nassertr( split < _cascades.size(), CUP_every_frame );
+        return _cascades[split].policy;
+}
+
+/**
+* @brief Sets whether to skip the shadow pass when nothing changed
+* @details When this is enabled and a display region has been set with
+*   set_shadow_display_region, that display region is deactivated on frames
+*   where no split is dirty, so the shadow maps from the previous pass are
+*   reused.
+*
+*   Only casters registered with add_dynamic_caster are checked for movement.
+*   Other moving casters will leave stale shadows behind.
+*
+* @param flag Whether to skip clean shadow passes
+*/
+void PSSMCameraRig::set_skip_clean_passes( bool flag )
+{
+        LightMutexHolder holder( csm_mutex );
+
+        _skip_clean_passes = flag;
+        if ( !flag && _shadow_dr != nullptr )
+                _shadow_dr->set_active( true );
+}
+
+/**
+* @brief Sets the display region that renders the shadow maps
+*
+* @param dr The display region of the shadow pass
+*/
+void PSSMCameraRig::set_shadow_display_region( DisplayRegion *dr )
+{
+        LightMutexHolder holder( csm_mutex );
+
+        _shadow_dr = dr;
+}
+
+/**
+* @brief Registers a moving shadow caster
+* @details Whenever the transform or bounds of a registered caster change, the
+*   splits that it covered before and after the change are marked dirty.
+*
+* @param np The shadow caster
+*/
+void PSSMCameraRig::add_dynamic_caster( const NodePath &np )
+{
+        nassertv( !np.is_empty() );
+        LightMutexHolder holder( csm_mutex );
+
+        for ( size_t i = 0; i < _dynamic_casters.size(); i++ )
+        {
+                if ( _dynamic_casters[i].np == np )
+                        return;
+        }
+
+        _dynamic_casters.push_back( DynamicCaster( np ) );
+}
+
+/**
+* @brief Unregisters a moving shadow caster
+* @details The splits that the caster was last seen in are marked dirty, so
+*   that its shadow goes away if the caster was removed from the scene.
+*
+* @param np The shadow caster
+*/
+void PSSMCameraRig::remove_dynamic_caster( const NodePath &np )
+{
+        LightMutexHolder holder( csm_mutex );
+
+        for ( size_t i = 0; i < _dynamic_casters.size(); i++ )
+        {
+                if ( _dynamic_casters[i].np == np )
+                {
+                        _dynamic_casters.erase( _dynamic_casters.begin() + i );
+                        _force_dirty = true;
+                        return;
+                }
+        }
+}
+
+/**
+* @brief Unregisters all moving shadow casters
+*/
+void PSSMCameraRig::clear_dynamic_casters()
+{
+        LightMutexHolder holder( csm_mutex );
+
+        _dynamic_casters.clear();
+        _force_dirty = true;
+}
+
+/**
+* @brief Forces every split to be recomputed and re-rendered
+* @details Call this after a change to the scene that isn't tracked by a
+*   dynamic caster, like loading a new level.
+*/
+void PSSMCameraRig::mark_all_cascades_dirty()
+{
+        LightMutexHolder holder( csm_mutex );
+
+        _force_dirty = true;
+}
+
+/**
+* @brief Returns whether a split changed during the last update
+*
+* @param split Index of the split
+* @return Whether the split needs to be re-rendered
+*/
+bool PSSMCameraRig::is_cascade_dirty( size_t split ) const
+{
+        nassertr( split < _cascades.size(), true );
+        return _cascades[split].dirty;
+}
+
+/**
+* @brief Returns the number of splits that changed during the last update
+*/
+int PSSMCameraRig::get_num_dirty_cascades() const
+{
+        int count = 0;
+        for ( size_t i = 0; i < _cascades.size(); i++ )
+        {
+                if ( _cascades[i].dirty )
+                        count++;
+        }
+        return count;
+}
+
+/**
+* @brief Returns whether the shadow maps have to be re-rendered this frame
+*/
+bool PSSMCameraRig::needs_shadow_render() const
+{
+        return get_num_dirty_cascades() > 0;
+}
+
 /**
 * @brief Sets the maximum pssm distance.
 * @details This sets the maximum distance in world space until which shadows
@@ -860,7 +1225,13 @@ void PSSMCameraRig::update( NodePath cam_node, const LVecBase3 &light_vector )
 void PSSMCameraRig::set_pssm_distance( float distance )
 {
         nassertv( distance > 0.0 && distance < 100000.0 );
-        _pssm_distance = distance;
+
+        LightMutexHolder holder( csm_mutex );
+        if ( _pssm_distance != distance )
+        {
+                _pssm_distance = distance;
+                _force_dirty = true;
+        }
 }
 
 /**
@@ -880,7 +1251,13 @@ void PSSMCameraRig::set_pssm_distance( float distance )
 void PSSMCameraRig::set_sun_distance( float distance )
 {
         nassertv( distance > 0.0 && distance < 100000.0 );
-        _sun_distance = distance;
+
+        LightMutexHolder holder( csm_mutex );
+        if ( _sun_distance != distance )
+        {
+                _sun_distance = distance;
+                _force_dirty = true;
+        }
 }
 
 /**
@@ -902,7 +1279,13 @@ void PSSMCameraRig::set_sun_distance( float distance )
 void PSSMCameraRig::set_logarithmic_factor( float factor )
 {
         nassertv( factor > 0.0 );
-        _logarithmic_factor = factor;
+
+        LightMutexHolder holder( csm_mutex );
+        if ( _logarithmic_factor != factor )
+        {
+                _logarithmic_factor = factor;
+                _force_dirty = true;
+        }
 }
 
 /**
@@ -918,7 +1301,13 @@ void PSSMCameraRig::set_logarithmic_factor( float factor )
 */
 void PSSMCameraRig::set_use_fixed_film_size( bool flag )
 {
-        _use_fixed_film_size = flag;
+        LightMutexHolder holder( csm_mutex );
+
+        if ( _use_fixed_film_size != flag )
+        {
+                _use_fixed_film_size = flag;
+                _force_dirty = true;
+        }
 }
 
 /**
@@ -935,7 +1324,13 @@ void PSSMCameraRig::set_use_fixed_film_size( bool flag )
 void PSSMCameraRig::set_resolution( size_t resolution )
 {
         nassertv( resolution >= 0 && resolution < 65535 );
-        _resolution = resolution;
+
+        LightMutexHolder holder( csm_mutex );
+        if ( _resolution != resolution )
+        {
+                _resolution = resolution;
+                _force_dirty = true;
+        }
 }
 
 /**
@@ -949,7 +1344,13 @@ void PSSMCameraRig::set_resolution( size_t resolution )
 */
 void PSSMCameraRig::set_use_stable_csm( bool flag )
 {
-        _use_stable_csm = flag;
+        LightMutexHolder holder( csm_mutex );
+
+        if ( _use_stable_csm != flag )
+        {
+                _use_stable_csm = flag;
+                _force_dirty = true;
+        }
 }
 
 /**
@@ -967,7 +1368,13 @@ void PSSMCameraRig::set_use_stable_csm( bool flag )
 void PSSMCameraRig::set_border_bias( float bias )
 {
         nassertv( bias >= 0.0 );
-        _border_bias = bias;
+
+        LightMutexHolder holder( csm_mutex );
+        if ( _border_bias != bias )
+        {
+                _border_bias = bias;
+                _force_dirty = true;
+        }
 }
 
 /**
@@ -985,10 +1392,13 @@ void PSSMCameraRig::set_border_bias( float bias )
 */
 void PSSMCameraRig::reset_film_size_cache()
 {
+        LightMutexHolder holder( csm_mutex );
+
         for ( size_t i = 0; i < _max_film_sizes.size(); ++i )
         {
                 _max_film_sizes[i].fill( 0 );
         }
+        _force_dirty = true;
 }
 
 /**
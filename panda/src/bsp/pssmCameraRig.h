@@ -32,6 +32,9 @@
 #include "camera.h"
 #include "nodePath.h"
 #include "pStatCollector.h"
+#include "weakNodePath.h"
+#include "boundingVolume.h"
+#include "displayRegion.h"
 
 #include "config_bsp.h"
 
@@ -63,7 +66,21 @@ class BSPShaderGenerator;
 class EXPCL_PANDABSP PSSMCameraRig
 {
 PUBLISHED:
-        PSSMCameraRig( size_t num_splits, BSPShaderGenerator *gen );
+        // Controls how often the frustum and view-projection matrix of a
+        // split get recomputed, and when the split is considered changed.
+        enum CascadeUpdatePolicy
+        {
+                // Recompute every frame, and always consider the split changed.
+                CUP_every_frame,
+                // Recompute every N frames, and hold the previous matrices in
+                // between.
+                CUP_interval,
+                // Recompute every frame, but only consider the split changed
+                // when it moved by at least one snapped texel.
+                CUP_on_snap_change,
+        };
+
+        PSSMCameraRig( size_t num_splits, BSPShaderGenerator *gen = nullptr );
         ~PSSMCameraRig();
 
         void set_pssm_distance( float distance );
@@ -74,9 +91,24 @@ PUBLISHED:
         void set_logarithmic_factor( float factor );
         void set_border_bias( float bias );
 
+        void set_cascade_update_policy( size_t split, CascadeUpdatePolicy policy, int interval = 1 );
+        CascadeUpdatePolicy get_cascade_update_policy( size_t split ) const;
+
+        void set_skip_clean_passes( bool flag );
+        void set_shadow_display_region( DisplayRegion *dr );
+
+        void add_dynamic_caster( const NodePath &np );
+        void remove_dynamic_caster( const NodePath &np );
+        void clear_dynamic_casters();
+        void mark_all_cascades_dirty();
+
         void update( NodePath cam_node, const LVecBase3 &light_vector );
         void reset_film_size_cache();
 
+        bool is_cascade_dirty( size_t split ) const;
+        int get_num_dirty_cascades() const;
+        bool needs_shadow_render() const;
+
         NodePath get_camera( size_t index );
 
         void reparent_to( NodePath parent );
@@ -104,6 +136,40 @@ protected:
         LMatrix4 compute_mvp( size_t cam_index );
         inline LPoint3 get_interpolated_point( CoordinateOrigin origin, float depth );
         LVecBase3 get_snap_offset( const LMatrix4& mat, size_t resolution );
+        void cull_dynamic_casters();
+
+        struct CascadeState
+        {
+                CascadeUpdatePolicy policy;
+                int interval;
+                int frames_since_update;
+                bool has_mvp;
+                bool dirty;
+
+                // The volume covered by the split's camera, relative to the rig
+                // parent.  Kept around for held splits.
+                PT( GeometricBoundingVolume ) bounds;
+        };
+
+        struct DynamicCaster
+        {
+                DynamicCaster( const NodePath &np ) :
+                        np( np )
+                {
+                }
+
+                WeakNodePath np;
+                CPT( TransformState ) last_transform;
+                CPT( BoundingVolume ) last_node_bounds;
+                PT( GeometricBoundingVolume ) last_bounds;
+        };
+
+        std::vector<CascadeState> _cascades;
+        std::vector<DynamicCaster> _dynamic_casters;
+        LVecBase3 _last_light_vector;
+        bool _force_dirty;
+        bool _skip_clean_passes;
+        PT( DisplayRegion ) _shadow_dr;
 
         std::vector<NodePath> _cam_nodes;
         std::vector<Camera*> _cameras;
@@ -134,6 +200,7 @@ protected:
         BSPShaderGenerator *_gen;
 
         static PStatCollector _update_collector;
+        static PStatCollector _cull_casters_collector;
 };
 
 #endif // PSSMCAMERARIG_H
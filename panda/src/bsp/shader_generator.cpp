@@ -68,6 +68,15 @@ ConfigVariableDouble normal_offset_scale( "pssm-normal-offset-scale", 1.0 );
 ConfigVariableDouble softness_factor( "pssm-softness-factor", 1.0 );
 ConfigVariableBool cache_shaders( "pssm-cache-shaders", true );
 ConfigVariableBool normal_offset_uv_space( "pssm-normal-offset-uv-space", true );
+static ConfigVariableInt pssm_far_cascade_interval( "pssm-far-cascade-interval", 1,
+                                                     "Recompute the PSSM splits beyond the first one only "
+                                                     "every this many frames." );
+static ConfigVariableBool pssm_skip_clean_passes( "pssm-skip-clean-passes", false,
+                                                  "Skip the PSSM shadow pass on frames where no split moved "
+                                                  "by a texel and no registered dynamic caster moved in any "
+                                                  "split.  Casters that are not registered with "
+                                                  "PSSMCameraRig::add_dynamic_caster() will leave stale "
+                                                  "shadows behind." );
 ConfigVariableColor ambient_light_identifier( "pssm-ambient-light-identifier", LColor( 0.5, 0.5, 0.5, 1 ) );
 ConfigVariableColor ambient_light_min( "pssm-ambient-light-min", LColor( 0, 0, 0, 1 ) );
 ConfigVariableDouble ambient_light_scale( "pssm-ambient-light-scale", 1.0 );
@@ -103,6 +112,19 @@ BSPShaderGenerator::BSPShaderGenerator( GraphicsOutput *output, GraphicsStateGua
         _pssm_rig->set_pssm_distance( pssm_max_distance );
         _pssm_rig->set_resolution( pssm_size );
         _pssm_rig->set_use_fixed_film_size( true );
+        _pssm_rig->set_skip_clean_passes( pssm_skip_clean_passes );
+        for ( int i = 0; i < pssm_splits; i++ )
+        {
+                if ( i > 0 && pssm_far_cascade_interval > 1 )
+                {
+                        _pssm_rig->set_cascade_update_policy( i, PSSMCameraRig::CUP_interval,
+                                                              pssm_far_cascade_interval );
+                }
+                else if ( pssm_skip_clean_passes )
+                {
+                        _pssm_rig->set_cascade_update_policy( i, PSSMCameraRig::CUP_on_snap_change );
+                }
+        }
 
         //BSPLoader::get_global_ptr()->set_shader_generator( this );
 
@@ -190,6 +212,7 @@ BSPShaderGenerator::BSPShaderGenerator( GraphicsOutput *output, GraphicsStateGua
                 dr->set_clear_depth_active( true );
                 dr->set_camera( _pssm_rig->get_camera( 0 ) );
                 dr->set_sort( -10000 );
+                _pssm_rig->set_shadow_display_region( dr );
         }
 }
 
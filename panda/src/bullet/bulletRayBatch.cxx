@@ -0,0 +1,24 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file bulletRayBatch.cxx
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#include "bulletRayBatch.h"
+
+/**
+ * Returns the result of the nth ray from the last call to
+ * BulletWorld::ray_test_batch().
+ */
+BulletClosestHitRayResult BulletRayBatch::
+get_result(size_t n) const {
+  nassertr(n < _results.size(), BulletClosestHitRayResult::empty());
+  return _results[n];
+}
@@ -0,0 +1,69 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file bulletRayBatch.h
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#ifndef BULLETRAYBATCH_H
+#define BULLETRAYBATCH_H
+
+#include "pandabase.h"
+
+#include "bullet_includes.h"
+#include "bulletClosestHitRayResult.h"
+
+#include "luse.h"
+#include "collideMask.h"
+#include "pvector.h"
+
+/**
+ * A list of rays to test against a BulletWorld all at once, with
+ * BulletWorld::ray_test_batch().  Each ray gets the same result that
+ * BulletWorld::ray_test_closest() would have given it.
+ *
+ * The batch may be filled once and tested again every frame.
+ */
+class EXPCL_PANDABULLET BulletRayBatch {
+PUBLISHED:
+  INLINE BulletRayBatch();
+
+  INLINE void add_ray(const LPoint3 &from_pos, const LPoint3 &to_pos,
+                      const CollideMask &mask=CollideMask::all_on());
+  INLINE void clear();
+  INLINE void reserve(size_t num_rays);
+
+  INLINE size_t get_num_rays() const;
+
+  INLINE size_t get_num_results() const;
+  BulletClosestHitRayResult get_result(size_t n) const;
+  MAKE_SEQ(get_results, get_num_results, get_result);
+
+  MAKE_PROPERTY(num_rays, get_num_rays);
+  MAKE_SEQ_PROPERTY(results, get_num_results, get_result);
+
+private:
+  class Ray {
+  public:
+    LPoint3 _from_pos;
+    LPoint3 _to_pos;
+    CollideMask _mask;
+  };
+  typedef pvector<Ray> Rays;
+  Rays _rays;
+
+  typedef pvector<BulletClosestHitRayResult> Results;
+  Results _results;
+
+  friend class BulletWorld;
+};
+
+#include "bulletRayBatch.I"
+
+#endif // BULLETRAYBATCH_H
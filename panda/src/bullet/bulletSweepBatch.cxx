@@ -0,0 +1,47 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file bulletSweepBatch.cxx
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#include "bulletSweepBatch.h"
+
+/**
+ * Adds a sweep of the given shape from from_ts to to_ts, which only hits
+ * objects whose into collide mask shares a bit with the given mask.  As with
+ * BulletWorld::sweep_test_closest(), the shape must be convex.
+ */
+void BulletSweepBatch::
+add_sweep(BulletShape *shape, const TransformState &from_ts,
+          const TransformState &to_ts, const CollideMask &mask,
+          PN_stdfloat penetration) {
+  nassertv(shape != nullptr);
+  nassertv(shape->ptr()->isConvex());
+  nassertv(!from_ts.is_invalid());
+  nassertv(!to_ts.is_invalid());
+
+  Sweep sweep;
+  sweep._shape = shape;
+  sweep._from_ts = &from_ts;
+  sweep._to_ts = &to_ts;
+  sweep._mask = mask;
+  sweep._penetration = penetration;
+  _sweeps.push_back(sweep);
+}
+
+/**
+ * Returns the result of the nth sweep from the last call to
+ * BulletWorld::sweep_test_batch().
+ */
+BulletClosestHitSweepResult BulletSweepBatch::
+get_result(size_t n) const {
+  nassertr(n < _results.size(), BulletClosestHitSweepResult::empty());
+  return _results[n];
+}
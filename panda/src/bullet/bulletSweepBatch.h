@@ -0,0 +1,75 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file bulletSweepBatch.h
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#ifndef BULLETSWEEPBATCH_H
+#define BULLETSWEEPBATCH_H
+
+#include "pandabase.h"
+
+#include "bullet_includes.h"
+#include "bulletClosestHitSweepResult.h"
+#include "bulletShape.h"
+
+#include "transformState.h"
+#include "collideMask.h"
+#include "pvector.h"
+
+/**
+ * A list of convex sweeps to test against a BulletWorld all at once, with
+ * BulletWorld::sweep_test_batch().  Each sweep gets the same result that
+ * BulletWorld::sweep_test_closest() would have given it.
+ *
+ * The batch may be filled once and tested again every frame.
+ */
+class EXPCL_PANDABULLET BulletSweepBatch {
+PUBLISHED:
+  INLINE BulletSweepBatch();
+
+  void add_sweep(BulletShape *shape,
+                 const TransformState &from_ts,
+                 const TransformState &to_ts,
+                 const CollideMask &mask=CollideMask::all_on(),
+                 PN_stdfloat penetration=0.0f);
+  INLINE void clear();
+  INLINE void reserve(size_t num_sweeps);
+
+  INLINE size_t get_num_sweeps() const;
+
+  INLINE size_t get_num_results() const;
+  BulletClosestHitSweepResult get_result(size_t n) const;
+  MAKE_SEQ(get_results, get_num_results, get_result);
+
+  MAKE_PROPERTY(num_sweeps, get_num_sweeps);
+  MAKE_SEQ_PROPERTY(results, get_num_results, get_result);
+
+private:
+  class Sweep {
+  public:
+    PT(BulletShape) _shape;
+    CPT(TransformState) _from_ts;
+    CPT(TransformState) _to_ts;
+    CollideMask _mask;
+    PN_stdfloat _penetration;
+  };
+  typedef pvector<Sweep> Sweeps;
+  Sweeps _sweeps;
+
+  typedef pvector<BulletClosestHitSweepResult> Results;
+  Results _results;
+
+  friend class BulletWorld;
+};
+
+#include "bulletSweepBatch.I"
+
+#endif // BULLETSWEEPBATCH_H
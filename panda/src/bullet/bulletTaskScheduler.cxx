@@ -0,0 +1,119 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file bulletTaskScheduler.cxx
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#include "bulletTaskScheduler.h"
+
+#if defined(HAVE_BULLET_MT) && !defined(CPPPARSER)
+
+#include "jobSystem.h"
+#include "pvector.h"
+
+#include <algorithm>
+
+BulletTaskScheduler *BulletTaskScheduler::_global_ptr = nullptr;
+
+/**
+ *
+ */
+BulletTaskScheduler::
+BulletTaskScheduler() : btITaskScheduler("Panda") {
+}
+
+/**
+ *
+ */
+int BulletTaskScheduler::
+getMaxNumThreads() const {
+  return BT_MAX_THREAD_COUNT;
+}
+
+/**
+ * Bullet keeps some scratch data per thread, indexed by a thread index that
+ * it hands out the first time it sees a thread.  Since any of the job
+ * workers, or the calling thread, may end up running a chunk of a loop, we
+ * have to claim the maximum here.
+ */
+int BulletTaskScheduler::
+getNumThreads() const {
+  return BT_MAX_THREAD_COUNT;
+}
+
+/**
+ * Does nothing; the number of threads is controlled by the JobSystem, see
+ * job-system-num-worker-threads.
+ */
+void BulletTaskScheduler::
+setNumThreads(int num_threads) {
+}
+
+/**
+ * Calls body.forLoop() on every index in [begin, end), in chunks of
+ * grain_size, spread over the job worker threads.  Returns when all of them
+ * are done.
+ */
+void BulletTaskScheduler::
+parallelFor(int begin, int end, int grain_size, const btIParallelForBody &body) {
+  if (end <= begin) {
+    return;
+  }
+
+  JobSystem::get_global_ptr()->parallel_process((size_t)(end - begin),
+    [&] (size_t first, size_t last) {
+      body.forLoop(begin + (int)first, begin + (int)last);
+    }, (size_t)std::max(grain_size, 1));
+}
+
+/**
+ * Like parallelFor(), but returns the sum of what body.sumLoop() returns for
+ * each chunk.  The partial sums are added up in order, so that the result
+ * does not depend on which thread ran which chunk.
+ */
+btScalar BulletTaskScheduler::
+parallelSum(int begin, int end, int grain_size, const btIParallelSumBody &body) {
+  if (end <= begin) {
+    return btScalar(0);
+  }
+
+  size_t count = (size_t)(end - begin);
+  size_t grain = (size_t)std::max(grain_size, 1);
+  size_t num_chunks = (count + grain - 1) / grain;
+
+  pvector<btScalar> sums(num_chunks, btScalar(0));
+  JobSystem::get_global_ptr()->parallel_process(num_chunks,
+    [&] (size_t first, size_t last) {
+      for (size_t ci = first; ci < last; ++ci) {
+        int chunk_begin = begin + (int)(ci * grain);
+        int chunk_end = std::min(chunk_begin + (int)grain, end);
+        sums[ci] = body.sumLoop(chunk_begin, chunk_end);
+      }
+    });
+
+  btScalar sum(0);
+  for (btScalar partial : sums) {
+    sum += partial;
+  }
+  return sum;
+}
+
+/**
+ * Makes the BulletTaskScheduler Bullet's task scheduler, if it isn't already.
+ */
+void BulletTaskScheduler::
+install() {
+  if (_global_ptr == nullptr) {
+    _global_ptr = new BulletTaskScheduler;
+    btSetTaskScheduler(_global_ptr);
+  }
+}
+
+#endif  // HAVE_BULLET_MT
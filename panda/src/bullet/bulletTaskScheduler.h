@@ -0,0 +1,54 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file bulletTaskScheduler.h
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#ifndef BULLETTASKSCHEDULER_H
+#define BULLETTASKSCHEDULER_H
+
+#include "pandabase.h"
+
+#include "bullet_includes.h"
+
+#if defined(HAVE_BULLET_MT) && !defined(CPPPARSER)
+
+/**
+ * An implementation of Bullet's task scheduler interface that runs Bullet's
+ * parallel loops on Panda's JobSystem, so that a multithreaded BulletWorld
+ * shares the job worker threads with the rest of the engine instead of
+ * starting threads of its own.
+ *
+ * Bullet only allows one task scheduler at a time; install() makes this the
+ * one.
+ */
+class EXPCL_PANDABULLET BulletTaskScheduler : public btITaskScheduler {
+private:
+  BulletTaskScheduler();
+
+public:
+  virtual int getMaxNumThreads() const;
+  virtual int getNumThreads() const;
+  virtual void setNumThreads(int num_threads);
+
+  virtual void parallelFor(int begin, int end, int grain_size,
+                           const btIParallelForBody &body);
+  virtual btScalar parallelSum(int begin, int end, int grain_size,
+                               const btIParallelSumBody &body);
+
+  static void install();
+
+private:
+  static BulletTaskScheduler *_global_ptr;
+};
+
+#endif  // HAVE_BULLET_MT
+
+#endif  // BULLETTASKSCHEDULER_H
@@ -19,10 +19,13 @@
 #include "bulletPersistentManifold.h"
 #include "bulletShape.h"
 #include "bulletSoftBodyWorldInfo.h"
+#include "bulletTaskScheduler.h"
 #include "bulletTickCallbackData.h"
 
 #include "collideMask.h"
 #include "lightMutexHolder.h"
+#include "jobSystem.h"
+#include "pStatTimer.h"
 
 #define clamp(x, x_min, x_max) std::max(std::min(x, x_max), x_min)
 
@@ -37,6 +40,57 @@ PStatCollector BulletWorld::_pstat_physics("App:Bullet:DoPhysics");
 PStatCollector BulletWorld::_pstat_simulation("App:Bullet:DoPhysics:Simulation");
 PStatCollector BulletWorld::_pstat_p2b("App:Bullet:DoPhysics:SyncP2B");
 PStatCollector BulletWorld::_pstat_b2p("App:Bullet:DoPhysics:SyncB2P");
+PStatCollector BulletWorld::_pstat_ray_batch("App:Bullet:RayTestBatch");
+PStatCollector BulletWorld::_pstat_sweep_batch("App:Bullet:SweepTestBatch");
+
+static PStatCollector substep_pcollector("App:Bullet:DoPhysics:Simulation:Substep");
+static PStatCollector predict_pcollector("App:Bullet:DoPhysics:Simulation:Substep:Predict");
+static PStatCollector collide_pcollector("App:Bullet:DoPhysics:Simulation:Substep:Collide");
+static PStatCollector solve_pcollector("App:Bullet:DoPhysics:Simulation:Substep:Solve");
+static PStatCollector integrate_pcollector("App:Bullet:DoPhysics:Simulation:Substep:Integrate");
+static PStatCollector actions_pcollector("App:Bullet:DoPhysics:Simulation:Substep:Actions");
+
+/**
+ * Wraps one of Bullet's dynamics world classes to time each substep, and the
+ * stages within it, in PStats.
+ */
+template<class WorldType>
+class InstrumentedWorld : public WorldType {
+public:
+  template<class... Args>
+  InstrumentedWorld(Args... args) : WorldType(args...) {}
+
+  virtual void performDiscreteCollisionDetection() {
+    PStatTimer timer(collide_pcollector);
+    WorldType::performDiscreteCollisionDetection();
+  }
+
+protected:
+  virtual void internalSingleStepSimulation(btScalar time_step) {
+    PStatTimer timer(substep_pcollector);
+    WorldType::internalSingleStepSimulation(time_step);
+  }
+
+  virtual void predictUnconstraintMotion(btScalar time_step) {
+    PStatTimer timer(predict_pcollector);
+    WorldType::predictUnconstraintMotion(time_step);
+  }
+
+  virtual void solveConstraints(btContactSolverInfo &solver_info) {
+    PStatTimer timer(solve_pcollector);
+    WorldType::solveConstraints(solver_info);
+  }
+
+  virtual void integrateTransforms(btScalar time_step) {
+    PStatTimer timer(integrate_pcollector);
+    WorldType::integrateTransforms(time_step);
+  }
+
+  virtual void updateActions(btScalar time_step) {
+    PStatTimer timer(actions_pcollector);
+    WorldType::updateActions(time_step);
+  }
+};
 
 PT(CallbackObject) bullet_contact_added_callback;
 
@@ -72,17 +126,56 @@ BulletWorld() {
   _configuration = new btSoftBodyRigidBodyCollisionConfiguration();
   nassertv(_configuration);
 
-  // Dispatcher
-  _dispatcher = new btCollisionDispatcher(_configuration);
-  nassertv(_dispatcher);
+  _solver_mt = nullptr;
+  _soft_world = nullptr;
+
+  bool multithreaded = bullet_multithreaded;
+#ifndef HAVE_BULLET_MT
+  if (multithreaded) {
+    bullet_cat.warning()
+      << "bullet-multithreaded requires a Bullet library built with "
+         "BT_THREADSAFE, and Panda built with HAVE_BULLET_MT.\n";
+    multithreaded = false;
+  }
+#endif
+
+  if (!multithreaded) {
+    // Dispatcher
+    _dispatcher = new btCollisionDispatcher(_configuration);
+    nassertv(_dispatcher);
+
+    // Solver
+    _solver = new btSequentialImpulseConstraintSolver;
+    nassertv(_solver);
+
+    // World
+    _soft_world = new InstrumentedWorld<btSoftRigidDynamicsWorld>(_dispatcher, _broadphase, _solver, _configuration);
+    _world = _soft_world;
+    nassertv(_world);
+  }
+#ifdef HAVE_BULLET_MT
+  else {
+    {
+      LightMutexHolder holder(get_global_lock());
+      BulletTaskScheduler::install();
+    }
+
+    // Narrowphase pairs are processed in parallel.
+    _dispatcher = new btCollisionDispatcherMt(_configuration);
+    nassertv(_dispatcher);
 
-  // Solver
-  _solver = new btSequentialImpulseConstraintSolver;
-  nassertv(_solver);
+    // Simulation islands are solved in parallel, each by one solver from the
+    // pool, except for large ones, which are handed to _solver_mt.
+    int num_threads = JobSystem::get_global_ptr()->get_num_workers() + 1;
+    btConstraintSolverPoolMt *pool = new btConstraintSolverPoolMt(num_threads);
+    _solver = pool;
+    _solver_mt = new btSequentialImpulseConstraintSolverMt;
 
-  // World
-  _world = new btSoftRigidDynamicsWorld(_dispatcher, _broadphase, _solver, _configuration);
-  nassertv(_world);
+    // World
+    _world = new InstrumentedWorld<btDiscreteDynamicsWorldMt>(_dispatcher, _broadphase, pool, _solver_mt, _configuration);
+    nassertv(_world);
+  }
+#endif
   nassertv(_world->getPairCache());
 
   _world->setWorldUserInfo(this);
@@ -551,9 +644,12 @@ do_attach_soft_body(BulletSoftBodyNode *node) {
   PT(BulletSoftBodyNode) ptnode = node;
   found = find(_softbodies.begin(), _softbodies.end(), ptnode);
 
-  if (found == _softbodies.end()) {
+  if (_soft_world == nullptr) {
+    bullet_cat.error() << "cannot attach soft bodies to a multithreaded world" << endl;
+  }
+  else if (found == _softbodies.end()) {
     _softbodies.push_back(node);
-    _world->addSoftBody(ptr, group, mask);
+    _soft_world->addSoftBody(ptr, group, mask);
   }
   else {
     bullet_cat.warning() << "soft body already attached" << endl;
@@ -579,7 +675,7 @@ do_remove_soft_body(BulletSoftBodyNode *node) {
   }
   else {
     _softbodies.erase(found);
-    _world->removeSoftBody(ptr);
+    _soft_world->removeSoftBody(ptr);
   }
 }
 
@@ -982,6 +1078,96 @@ sweep_test_closest(BulletShape *shape, const TransformState &from_ts, const Tran
   return cb;
 }
 
+/**
+ * Performs a closest-hit ray test for each of the rays in the batch, and
+ * stores the results in the batch.  This is equivalent to calling
+ * ray_test_closest() for each ray, but much cheaper for many rays.
+ *
+ * If Bullet was built with BT_THREADSAFE, the rays are tested in parallel on
+ * the job worker threads, since the broadphase is not modified by a ray test.
+ */
+void BulletWorld::
+ray_test_batch(BulletRayBatch &batch) const {
+  LightMutexHolder holder(get_global_lock());
+  PStatTimer timer(_pstat_ray_batch);
+
+  size_t num_rays = batch._rays.size();
+  batch._results.clear();
+  batch._results.reserve(num_rays);
+  for (const BulletRayBatch::Ray &ray : batch._rays) {
+    batch._results.push_back(BulletClosestHitRayResult(
+      LVecBase3_to_btVector3(ray._from_pos),
+      LVecBase3_to_btVector3(ray._to_pos), ray._mask));
+  }
+
+  BulletClosestHitRayResult *results = batch._results.data();
+  btCollisionWorld *world = _world;
+  auto test = [=] (size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      BulletClosestHitRayResult &cb = results[i];
+      world->rayTest(cb.m_rayFromWorld, cb.m_rayToWorld, cb);
+    }
+  };
+
+#ifdef HAVE_BULLET_MT
+  JobSystem::get_global_ptr()->parallel_process(num_rays, test, 16);
+#else
+  test(0, num_rays);
+#endif
+}
+
+/**
+ * Performs a closest-hit sweep test for each of the sweeps in the batch, and
+ * stores the results in the batch.  This is equivalent to calling
+ * sweep_test_closest() for each sweep, but much cheaper for many sweeps.
+ *
+ * If Bullet was built with BT_THREADSAFE, the sweeps are tested in parallel
+ * on the job worker threads, as with ray_test_batch().
+ */
+void BulletWorld::
+sweep_test_batch(BulletSweepBatch &batch) const {
+  LightMutexHolder holder(get_global_lock());
+  PStatTimer timer(_pstat_sweep_batch);
+
+  size_t num_sweeps = batch._sweeps.size();
+  batch._results.clear();
+  if (num_sweeps == 0) {
+    return;
+  }
+  batch._results.reserve(num_sweeps);
+
+  // Convert the transforms up front, so that the workers don't need to touch
+  // the TransformStates.
+  btAlignedObjectArray<btTransform> transforms;
+  transforms.resize((int)num_sweeps * 2);
+  for (size_t i = 0; i < num_sweeps; ++i) {
+    const BulletSweepBatch::Sweep &sweep = batch._sweeps[i];
+    batch._results.push_back(BulletClosestHitSweepResult(
+      LVecBase3_to_btVector3(sweep._from_ts->get_pos()),
+      LVecBase3_to_btVector3(sweep._to_ts->get_pos()), sweep._mask));
+    transforms[(int)i * 2] = LMatrix4_to_btTrans(sweep._from_ts->get_mat());
+    transforms[(int)i * 2 + 1] = LMatrix4_to_btTrans(sweep._to_ts->get_mat());
+  }
+
+  const BulletSweepBatch::Sweep *sweeps = batch._sweeps.data();
+  BulletClosestHitSweepResult *results = batch._results.data();
+  const btTransform *trans = &transforms[0];
+  btCollisionWorld *world = _world;
+  auto test = [=] (size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const btConvexShape *convex = (const btConvexShape *)sweeps[i]._shape->ptr();
+      world->convexSweepTest(convex, trans[i * 2], trans[i * 2 + 1],
+                             results[i], sweeps[i]._penetration);
+    }
+  };
+
+#ifdef HAVE_BULLET_MT
+  JobSystem::get_global_ptr()->parallel_process(num_sweeps, test, 4);
+#else
+  test(0, num_sweeps);
+#endif
+}
+
 /**
  * Performs a test if two bodies should collide or not, based on the collision
  * filter setting.
@@ -22,6 +22,8 @@
 #include "bulletClosestHitRayResult.h"
 #include "bulletAllHitsRayResult.h"
 #include "bulletClosestHitSweepResult.h"
+#include "bulletRayBatch.h"
+#include "bulletSweepBatch.h"
 #include "bulletContactResult.h"
 #include "bulletDebugNode.h"
 #include "bulletBaseCharacterControllerNode.h"
@@ -60,6 +62,8 @@ PUBLISHED:
 
   BLOCKING int do_physics(PN_stdfloat dt, int max_substeps=1, PN_stdfloat stepsize=1.0f/60.0f);
 
+  INLINE bool is_multithreaded() const;
+
   BulletSoftBodyWorldInfo get_world_info();
 
   // Debug
@@ -120,6 +124,9 @@ PUBLISHED:
     const CollideMask &mask=CollideMask::all_on(),
     PN_stdfloat penetration=0.0f) const;
 
+  BLOCKING void ray_test_batch(BulletRayBatch &batch) const;
+  BLOCKING void sweep_test_batch(BulletSweepBatch &batch) const;
+
   BulletContactResult contact_test(PandaNode *node, bool use_filter=false) const;
   BulletContactResult contact_test_pair(PandaNode *node0, PandaNode *node1) const;
 
@@ -161,6 +168,7 @@ PUBLISHED:
 
   MAKE_PROPERTY(gravity, get_gravity, set_gravity);
   MAKE_PROPERTY(world_info, get_world_info);
+  MAKE_PROPERTY(multithreaded, is_multithreaded);
   MAKE_PROPERTY2(debug_node, has_debug_node, get_debug_node, set_debug_node, clear_debug_node);
   MAKE_SEQ_PROPERTY(ghosts, get_num_ghosts, get_ghost);
   MAKE_SEQ_PROPERTY(rigid_bodies, get_num_rigid_bodies, get_rigid_body);
@@ -234,6 +242,8 @@ private:
   static PStatCollector _pstat_simulation;
   static PStatCollector _pstat_p2b;
   static PStatCollector _pstat_b2p;
+  static PStatCollector _pstat_ray_batch;
+  static PStatCollector _pstat_sweep_batch;
 
   struct btFilterCallback1 : public btOverlapFilterCallback {
     virtual bool needBroadphaseCollision(
@@ -261,7 +271,12 @@ private:
   btCollisionConfiguration *_configuration;
   btCollisionDispatcher *_dispatcher;
   btConstraintSolver *_solver;
-  btSoftRigidDynamicsWorld *_world;
+  btConstraintSolver *_solver_mt;
+  btDiscreteDynamicsWorld *_world;
+
+  // The same object as _world, unless this is a multithreaded world, which
+  // cannot have soft bodies.
+  btSoftRigidDynamicsWorld *_soft_world;
 
   btGhostPairCallback _ghost_cb;
 
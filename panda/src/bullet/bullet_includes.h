@@ -33,6 +33,18 @@
 #include <BulletSoftBody/btSoftBodyInternals.h>
 #include <BulletSoftBody/btSoftBodyRigidBodyCollisionConfiguration.h>
 #include <BulletSoftBody/btSoftRigidDynamicsWorld.h>
+
+// The multithreaded dynamics world is only usable if Bullet itself was built
+// to be thread-safe.  The installed Bullet headers don't record whether that
+// was the case, so BT_THREADSAFE has to be defined by our own build; this is
+// done by the HAVE_BULLET_MT option in CMake.
+#if BT_BULLET_VERSION >= 288 && defined(BT_THREADSAFE) && BT_THREADSAFE
+#define HAVE_BULLET_MT 1
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <LinearMath/btThreads.h>
+#endif
 #endif
 
 #endif // BULLET_INCLUDES_H
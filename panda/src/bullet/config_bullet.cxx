@@ -111,6 +111,16 @@ PRC_DESC("Specifies the number of iterations for the Bullet contact "
          "solver. This is the native Bullet property "
          "btContactSolverInfo::m_numIterations. Default value is 10."));
 
+ConfigVariableBool bullet_multithreaded
+("bullet-multithreaded", false,
+PRC_DESC("If true, new BulletWorlds are built on Bullet's multithreaded "
+         "dynamics world, which runs the narrowphase and the solving of "
+         "simulation islands on Panda's job worker threads.  This requires "
+         "a Bullet library built with BT_THREADSAFE, and Panda to be "
+         "built with HAVE_BULLET_MT; otherwise it is ignored.  Soft bodies "
+         "cannot be used in such a world, and contact callbacks may be "
+         "invoked from the worker threads."));
+
 ConfigVariableBool bullet_additional_damping
 ("bullet-additional-damping", false,
 PRC_DESC("Enables additional damping on eachrigid body, in order to reduce "
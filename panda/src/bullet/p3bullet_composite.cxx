@@ -28,12 +28,15 @@
 #include "bulletMultiSphereShape.cxx"
 #include "bulletPersistentManifold.cxx"
 #include "bulletPlaneShape.cxx"
+#include "bulletRayBatch.cxx"
 #include "bulletRigidBodyNode.cxx"
 #include "bulletRotationalLimitMotor.cxx"
 #include "bulletShape.cxx"
 #include "bulletSliderConstraint.cxx"
 #include "bulletSphereShape.cxx"
 #include "bulletSphericalConstraint.cxx"
+#include "bulletSweepBatch.cxx"
+#include "bulletTaskScheduler.cxx"
 #include "bulletSoftBodyNode.cxx"
 #include "bulletSoftBodyConfig.cxx"
 #include "bulletSoftBodyControl.cxx"
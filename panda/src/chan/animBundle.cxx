@@ -12,6 +12,7 @@
  */
 
 #include "animBundle.h"
+#include "animChannelMatrixXfmTable.h"
 
 #include "indent.h"
 #include "datagram.h"
@@ -47,6 +48,39 @@ copy_bundle() const {
   return DCAST(AnimBundle, group.p());
 }
 
+/**
+ * Quantizes all of the AnimChannelMatrixXfmTables in the bundle to within the
+ * indicated tolerance, which greatly reduces the memory they take up.  See
+ * AnimChannelMatrixXfmTable::quantize().  Returns the number of channels that
+ * were quantized.
+ *
+ * Copies of the bundle that were made earlier with copy_bundle() are not
+ * affected.
+ */
+int AnimBundle::
+quantize_channels(PN_stdfloat tolerance) {
+  return r_quantize_channels(this, tolerance);
+}
+
+/**
+ * The recursive implementation of quantize_channels().
+ */
+int AnimBundle::
+r_quantize_channels(AnimGroup *group, PN_stdfloat tolerance) {
+  int count = 0;
+  if (group->is_of_type(AnimChannelMatrixXfmTable::get_class_type())) {
+    if (((AnimChannelMatrixXfmTable *)group)->quantize(tolerance)) {
+      ++count;
+    }
+  }
+
+  int num_children = group->get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    count += r_quantize_channels(group->get_child(i), tolerance);
+  }
+  return count;
+}
+
 /**
  * Writes a one-line description of the bundle.
  */
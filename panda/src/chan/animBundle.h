@@ -41,6 +41,8 @@ PUBLISHED:
   MAKE_PROPERTY(base_frame_rate, get_base_frame_rate);
   MAKE_PROPERTY(num_frames, get_num_frames);
 
+  int quantize_channels(PN_stdfloat tolerance);
+
   virtual void output(std::ostream &out) const;
 
 protected:
@@ -48,6 +50,9 @@ protected:
 
   virtual AnimGroup *make_copy(AnimGroup *parent) const;
 
+private:
+  static int r_quantize_channels(AnimGroup *group, PN_stdfloat tolerance);
+
 private:
   PN_stdfloat _fps;
   int _num_frames;
@@ -24,6 +24,13 @@
 #include "fftCompressor.h"
 #include "config_linmath.h"
 
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define ANIMCHANNEL_USE_SSE2
+#endif
+
 TypeHandle AnimChannelMatrixXfmTable::_type_handle;
 
 /**
@@ -43,7 +50,8 @@ AnimChannelMatrixXfmTable() {
  */
 AnimChannelMatrixXfmTable::
 AnimChannelMatrixXfmTable(AnimGroup *parent, const AnimChannelMatrixXfmTable &copy) :
-  AnimChannelMatrix(parent, copy)
+  AnimChannelMatrix(parent, copy),
+  _quantized(copy._quantized)
 {
   for (int i = 0; i < num_matrix_components; i++) {
     _tables[i] = copy._tables[i];
@@ -78,6 +86,26 @@ AnimChannelMatrixXfmTable::
 bool AnimChannelMatrixXfmTable::
 has_changed(int last_frame, double last_frac,
             int this_frame, double this_frac) {
+  if (_quantized != nullptr) {
+    PN_stdfloat last_components[num_matrix_components];
+    PN_stdfloat this_components[num_matrix_components];
+    _quantized->sample(last_frame, last_components);
+
+    if (last_frame != this_frame) {
+      _quantized->sample(this_frame, this_components);
+      if (memcmp(last_components, this_components, sizeof(last_components)) != 0) {
+        return true;
+      }
+    }
+    if (last_frac != this_frac) {
+      _quantized->sample(this_frame + 1, this_components);
+      if (memcmp(last_components, this_components, sizeof(last_components)) != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   if (last_frame != this_frame) {
     for (int i = 0; i < num_matrix_components; i++) {
       if (_tables[i].size() > 1) {
@@ -112,6 +140,12 @@ void AnimChannelMatrixXfmTable::
 get_value(int frame, LMatrix4 &mat) {
   PN_stdfloat components[num_matrix_components];
 
+  if (_quantized != nullptr) {
+    _quantized->sample(frame, components);
+    compose_matrix(mat, components);
+    return;
+  }
+
   for (int i = 0; i < num_matrix_components; i++) {
     if (_tables[i].empty()) {
       components[i] = get_default_value(i);
@@ -130,6 +164,9 @@ get_value(int frame, LMatrix4 &mat) {
 void AnimChannelMatrixXfmTable::
 get_value_no_scale_shear(int frame, LMatrix4 &mat) {
   PN_stdfloat components[num_matrix_components];
+  if (_quantized != nullptr) {
+    _quantized->sample(frame, components);
+  }
   components[0] = 1.0f;
   components[1] = 1.0f;
   components[2] = 1.0f;
@@ -137,11 +174,13 @@ get_value_no_scale_shear(int frame, LMatrix4 &mat) {
   components[4] = 0.0f;
   components[5] = 0.0f;
 
-  for (int i = 6; i < num_matrix_components; i++) {
-    if (_tables[i].empty()) {
-      components[i] = get_default_value(i);
-    } else {
-      components[i] = _tables[i][frame % _tables[i].size()];
+  if (_quantized == nullptr) {
+    for (int i = 6; i < num_matrix_components; i++) {
+      if (_tables[i].empty()) {
+        components[i] = get_default_value(i);
+      } else {
+        components[i] = _tables[i][frame % _tables[i].size()];
+      }
     }
   }
 
@@ -153,6 +192,13 @@ get_value_no_scale_shear(int frame, LMatrix4 &mat) {
  */
 void AnimChannelMatrixXfmTable::
 get_scale(int frame, LVecBase3 &scale) {
+  if (_quantized != nullptr) {
+    PN_stdfloat components[num_matrix_components];
+    _quantized->sample(frame, components);
+    scale.set(components[0], components[1], components[2]);
+    return;
+  }
+
   for (int i = 0; i < 3; i++) {
     if (_tables[i].empty()) {
       scale[i] = 1.0f;
@@ -168,6 +214,13 @@ get_scale(int frame, LVecBase3 &scale) {
  */
 void AnimChannelMatrixXfmTable::
 get_hpr(int frame, LVecBase3 &hpr) {
+  if (_quantized != nullptr) {
+    PN_stdfloat components[num_matrix_components];
+    _quantized->sample(frame, components);
+    hpr.set(components[6], components[7], components[8]);
+    return;
+  }
+
   for (int i = 0; i < 3; i++) {
     if (_tables[i + 6].empty()) {
       hpr[i] = 0.0f;
@@ -185,6 +238,12 @@ get_hpr(int frame, LVecBase3 &hpr) {
 void AnimChannelMatrixXfmTable::
 get_quat(int frame, LQuaternion &quat) {
   LVecBase3 hpr;
+  if (_quantized != nullptr) {
+    get_hpr(frame, hpr);
+    quat.set_hpr(hpr);
+    return;
+  }
+
   for (int i = 0; i < 3; i++) {
     if (_tables[i + 6].empty()) {
       hpr[i] = 0.0f;
@@ -202,6 +261,13 @@ get_quat(int frame, LQuaternion &quat) {
  */
 void AnimChannelMatrixXfmTable::
 get_pos(int frame, LVecBase3 &pos) {
+  if (_quantized != nullptr) {
+    PN_stdfloat components[num_matrix_components];
+    _quantized->sample(frame, components);
+    pos.set(components[9], components[10], components[11]);
+    return;
+  }
+
   for (int i = 0; i < 3; i++) {
     if (_tables[i + 9].empty()) {
       pos[i] = 0.0f;
@@ -217,6 +283,13 @@ get_pos(int frame, LVecBase3 &pos) {
  */
 void AnimChannelMatrixXfmTable::
 get_shear(int frame, LVecBase3 &shear) {
+  if (_quantized != nullptr) {
+    PN_stdfloat components[num_matrix_components];
+    _quantized->sample(frame, components);
+    shear.set(components[3], components[4], components[5]);
+    return;
+  }
+
   for (int i = 0; i < 3; i++) {
     if (_tables[i + 3].empty()) {
       shear[i] = 0.0f;
@@ -248,6 +321,7 @@ set_table(char table_id, const CPTA_stdfloat &table) {
     return;
   }
 
+  dequantize();
   _tables[i] = table;
 }
 
@@ -261,6 +335,117 @@ clear_all_tables() {
   for (int i = 0; i < num_matrix_components; i++) {
     _tables[i] = CPTA_stdfloat(get_class_type());
   }
+  _quantized.clear();
+}
+
+/**
+ * Replaces the tables of this channel with a quantized, keyframe-reduced
+ * form, which typically takes a small fraction of the memory.  Each animated
+ * component is stored as a 16-bit value, and only on those frames that
+ * cannot be linearly interpolated from the surrounding keyframes to within
+ * the indicated tolerance.  Components that vary by less than the tolerance
+ * are collapsed to a constant.
+ *
+ * The tolerance is applied to each component in its own units, ie.  degrees
+ * for the rotation.  Note that the tolerance is in addition to the error
+ * introduced by quantizing a component to 1/65535 of its range.
+ *
+ * Returns true if the channel was quantized, or false if its tables could
+ * not be represented in the quantized form, in which case they are left
+ * unchanged.
+ */
+bool AnimChannelMatrixXfmTable::
+quantize(PN_stdfloat tolerance) {
+  if (_quantized != nullptr) {
+    // Quantizing the already-quantized values again would compound the
+    // error; start over from the decoded tables instead.
+    dequantize();
+  }
+
+  PT(QuantizedTable) quantized = make_quantized(_tables, tolerance);
+  if (quantized == nullptr) {
+    return false;
+  }
+
+  _quantized = quantized;
+  for (int i = 0; i < num_matrix_components; i++) {
+    _tables[i] = CPTA_stdfloat(get_class_type());
+  }
+  return true;
+}
+
+/**
+ * Converts the tables of this channel back from the quantized form to
+ * ordinary tables of floats.  This does not restore the precision that was
+ * lost when the channel was quantized.  Has no effect if the channel is not
+ * quantized.
+ */
+void AnimChannelMatrixXfmTable::
+dequantize() {
+  if (_quantized != nullptr) {
+    for (int i = 0; i < num_matrix_components; i++) {
+      _tables[i] = _quantized->decode_table(i);
+    }
+    _quantized.clear();
+  }
+}
+
+/**
+ * Returns the number of keyframes stored for this channel if it is
+ * quantized, or 0 if it is not.
+ */
+int AnimChannelMatrixXfmTable::
+get_num_keys() const {
+  if (_quantized == nullptr) {
+    return 0;
+  }
+  return (int)_quantized->_keys.size();
+}
+
+/**
+ * Evaluates the matrices of many channels at the same frame, which is
+ * typically all of the joints of a PartBundle that are playing the same
+ * animation.  The result for channels[n] is stored in mats[n].  This gives the
+ * same results as calling get_value() on each channel.
+ *
+ * The components of all of the channels are decoded first, four at a time
+ * for quantized channels, and then composed into matrices in a second pass,
+ * so that the decoding of the whole bundle runs as one tight loop.
+ */
+void AnimChannelMatrixXfmTable::
+sample_batch(int frame, AnimChannelMatrixXfmTable *const *channels,
+             size_t num_channels, LMatrix4 *mats) {
+  // Decode in blocks, so that the components stay in the cache until they
+  // are composed.
+  static const size_t block_size = 64;
+  PN_stdfloat components[block_size][num_matrix_components];
+
+  for (size_t begin = 0; begin < num_channels; begin += block_size) {
+    size_t end = std::min(begin + block_size, num_channels);
+
+    for (size_t n = begin; n < end; ++n) {
+      AnimChannelMatrixXfmTable *channel = channels[n];
+      PN_stdfloat *values = components[n - begin];
+
+      const QuantizedTable *quantized = channel->_quantized;
+      if (quantized != nullptr) {
+        quantized->sample(frame, values);
+      } else {
+        for (int i = 0; i < num_matrix_components; i++) {
+          const CPTA_stdfloat &table = channel->_tables[i];
+          if (table.empty()) {
+            values[i] = get_default_value(i);
+          } else {
+            values[i] = table[frame % table.size()];
+          }
+        }
+      }
+    }
+
+    for (size_t n = begin; n < end; ++n) {
+      compose_matrix(mats[n], components[n - begin]);
+    }
+  }
 }
 
 /**
@@ -271,17 +456,24 @@ write(std::ostream &out, int indent_level) const {
   indent(out, indent_level)
     << get_type() << " " << get_name() << " ";
 
-  // Write a list of all the sub-tables that have data.
-  bool found_any = false;
-  for (int i = 0; i < num_matrix_components; i++) {
-    if (!_tables[i].empty()) {
-      out << get_table_id(i) << _tables[i].size();
-      found_any = true;
+  if (_quantized != nullptr) {
+    out << "quantized, " << _quantized->_keys.size() << " keys of "
+        << _quantized->_num_frames << " frames, "
+        << _quantized->get_data_size() << " bytes";
+
+  } else {
+    // Write a list of all the sub-tables that have data.
+    bool found_any = false;
+    for (int i = 0; i < num_matrix_components; i++) {
+      if (!_tables[i].empty()) {
+        out << get_table_id(i) << _tables[i].size();
+        found_any = true;
+      }
     }
-  }
 
-  if (!found_any) {
-    out << "(no data)";
+    if (!found_any) {
+      out << "(no data)";
+    }
   }
 
   if (!_children.empty()) {
@@ -327,6 +519,26 @@ void AnimChannelMatrixXfmTable::
 write_datagram(BamWriter *manager, Datagram &me) {
   AnimChannelMatrix::write_datagram(manager, me);
 
+  if (manager->get_file_minor_ver() >= 46) {
+    // Newer bam files can store the quantized form.  We write it if the
+    // channel is already quantized, or if quantize-channels requests it.
+    CPT(QuantizedTable) quantized = _quantized;
+    if (quantized == nullptr && quantize_channels) {
+      quantized = make_quantized(_tables, quantize_chan_tolerance);
+    }
+    if (quantized != nullptr) {
+      me.add_bool(false);
+      me.add_bool(true);
+      me.add_bool(true);
+      quantized->write_datagram(me);
+      return;
+    }
+  }
+
+  // Otherwise, we need the tables as floats.
+  CPTA_stdfloat tables[num_matrix_components];
+  get_float_tables(tables);
+
   if (compress_channels) {
     chan_cat.warning()
       << "FFT compression of animations is deprecated.  For compatibility "
@@ -344,12 +556,17 @@ write_datagram(BamWriter *manager, Datagram &me) {
   // We now always use the new HPR conventions.
   me.add_bool(true);
 
+  if (manager->get_file_minor_ver() >= 46) {
+    // Not quantized.
+    me.add_bool(false);
+  }
+
   if (!compress_channels) {
     // Write out everything uncompressed, as a stream of floats.
     for (int i = 0; i < num_matrix_components; i++) {
-      me.add_uint16(_tables[i].size());
-      for(int j = 0; j < (int)_tables[i].size(); j++) {
-        me.add_stdfloat(_tables[i][j]);
+      me.add_uint16(tables[i].size());
+      for(int j = 0; j < (int)tables[i].size(); j++) {
+        me.add_stdfloat(tables[i][j]);
       }
     }
 
@@ -363,18 +580,18 @@ write_datagram(BamWriter *manager, Datagram &me) {
     // First, write out the scales and shears.
     int i;
     for (i = 0; i < 6; i++) {
-      compressor.write_reals(me, _tables[i], _tables[i].size());
+      compressor.write_reals(me, tables[i], tables[i].size());
     }
 
     // Now, write out the joint angles.  For these we need to build up a HPR
     // array.
     pvector<LVecBase3> hprs;
-    int hprs_length = std::max(std::max(_tables[6].size(), _tables[7].size()), _tables[8].size());
+    int hprs_length = std::max(std::max(tables[6].size(), tables[7].size()), tables[8].size());
     hprs.reserve(hprs_length);
     for (i = 0; i < hprs_length; i++) {
-      PN_stdfloat h = _tables[6].empty() ? 0.0f : _tables[6][i % _tables[6].size()];
-      PN_stdfloat p = _tables[7].empty() ? 0.0f : _tables[7][i % _tables[7].size()];
-      PN_stdfloat r = _tables[8].empty() ? 0.0f : _tables[8][i % _tables[8].size()];
+      PN_stdfloat h = tables[6].empty() ? 0.0f : tables[6][i % tables[6].size()];
+      PN_stdfloat p = tables[7].empty() ? 0.0f : tables[7][i % tables[7].size()];
+      PN_stdfloat r = tables[8].empty() ? 0.0f : tables[8][i % tables[8].size()];
       hprs.push_back(LVecBase3(h, p, r));
     }
     const LVecBase3 *hprs_array = nullptr;
@@ -385,7 +602,7 @@ write_datagram(BamWriter *manager, Datagram &me) {
 
     // And now the translations.
     for(i = 9; i < num_matrix_components; i++) {
-      compressor.write_reals(me, _tables[i], _tables[i].size());
+      compressor.write_reals(me, tables[i], tables[i].size());
     }
   }
 }
@@ -405,7 +622,23 @@ fillin(DatagramIterator &scan, BamReader *manager) {
   // have to convert the HPR values to the new convention.
   bool new_hpr = scan.get_bool();
 
-  if (!wrote_compressed) {
+  bool wrote_quantized = false;
+  if (manager->get_file_minor_ver() >= 46) {
+    wrote_quantized = scan.get_bool();
+  }
+
+  if (wrote_quantized) {
+    PT(QuantizedTable) quantized = new QuantizedTable;
+    if (quantized->fillin(scan)) {
+      _quantized = quantized;
+    } else {
+      chan_cat.error()
+        << "Ignoring invalid quantized table for " << get_name()
+        << ", is the bam file corrupt?\n";
+      clear_all_tables();
+    }
+
+  } else if (!wrote_compressed) {
     // Regular floats.
 
     for (int i = 0; i < num_matrix_components; i++) {
@@ -528,3 +761,318 @@ void AnimChannelMatrixXfmTable::
 register_with_read_factory() {
   BamReader::get_factory()->register_factory(get_class_type(), make_from_bam);
 }
+
+/**
+ * Builds the quantized form of the indicated tables, to within the given
+ * tolerance.  Returns NULL if the tables cannot be quantized, because the
+ * animated tables are not all the same length.
+ */
+PT(AnimChannelMatrixXfmTable::QuantizedTable) AnimChannelMatrixXfmTable::
+make_quantized(const CPTA_stdfloat *tables, PN_stdfloat tolerance) {
+  tolerance = std::max(tolerance, (PN_stdfloat)0);
+
+  size_t num_frames = 0;
+  for (int i = 0; i < num_matrix_components; i++) {
+    size_t size = tables[i].size();
+    if (size > 1) {
+      if (num_frames == 0) {
+        num_frames = size;
+      } else if (size != num_frames) {
+        return nullptr;
+      }
+    }
+  }
+  if (num_frames > 65535) {
+    return nullptr;
+  }
+
+  PT(QuantizedTable) quantized = new QuantizedTable;
+  quantized->_num_frames = (int)std::max(num_frames, (size_t)1);
+  quantized->_num_animated = 0;
+  quantized->_table_mask = 0;
+  quantized->_animated_mask = 0;
+
+  for (int i = 0; i < num_matrix_components; i++) {
+    quantized->_values[i] = get_default_value(i);
+    quantized->_components[i] = 0;
+    quantized->_base[i] = 0.0f;
+    quantized->_scale[i] = 0.0f;
+
+    const CPTA_stdfloat &table = tables[i];
+    if (table.empty()) {
+      continue;
+    }
+    quantized->_table_mask |= (1u << i);
+
+    PN_stdfloat min_value = table[0];
+    PN_stdfloat max_value = table[0];
+    for (size_t f = 1; f < table.size(); ++f) {
+      min_value = std::min(min_value, table[f]);
+      max_value = std::max(max_value, table[f]);
+    }
+
+    if (max_value - min_value <= tolerance * 2) {
+      // The midpoint is within the tolerance of every frame.
+      quantized->_values[i] = (min_value == max_value) ? min_value : (min_value + max_value) * 0.5f;
+      continue;
+    }
+
+    int slot = quantized->_num_animated++;
+    quantized->_animated_mask |= (1u << i);
+    quantized->_components[slot] = (unsigned char)i;
+    quantized->_base[slot] = (float)min_value;
+    quantized->_scale[slot] = (float)((max_value - min_value) / 65535);
+    quantized->_values[i] = table[0];
+  }
+
+  int num_animated = quantized->_num_animated;
+  if (num_animated == 0) {
+    return quantized;
+  }
+
+  // Quantize every frame first.
+  pvector<uint16_t> values(num_frames * num_animated);
+  for (int slot = 0; slot < num_animated; ++slot) {
+    const CPTA_stdfloat &table = tables[quantized->_components[slot]];
+    float base = quantized->_base[slot];
+    float scale = quantized->_scale[slot];
+    for (size_t f = 0; f < num_frames; ++f) {
+      float q = ((float)table[f] - base) / scale + 0.5f;
+      values[f * num_animated + slot] = (uint16_t)std::min(std::max(q, 0.0f), 65535.0f);
+    }
+  }
+
+  // Now pick the keyframes.  Starting from each keyframe, we extend the
+  // segment for as long as all of the frames in between can be interpolated
+  // from its endpoints within the tolerance.
+  auto segment_ok = [&] (size_t a, size_t b) {
+    const uint16_t *qa = &values[a * num_animated];
+    const uint16_t *qb = &values[b * num_animated];
+    for (size_t f = a + 1; f < b; ++f) {
+      float t = (float)(f - a) / (float)(b - a);
+      for (int slot = 0; slot < num_animated; ++slot) {
+        float q = (float)qa[slot] + ((float)qb[slot] - (float)qa[slot]) * t;
+        float value = quantized->_base[slot] + quantized->_scale[slot] * q;
+        PN_stdfloat orig = tables[quantized->_components[slot]][f];
+        if (std::fabs(value - orig) > tolerance) {
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+
+  pvector<uint16_t> &keys = quantized->_keys;
+  keys.push_back(0);
+  size_t a = 0;
+  while (a + 1 < num_frames) {
+    size_t b = a + 1;
+    while (b + 1 < num_frames && segment_ok(a, b + 1)) {
+      ++b;
+    }
+    keys.push_back((uint16_t)b);
+    a = b;
+  }
+
+  // Store the values at the keyframes, interleaved.  The padding at the end
+  // allows the sampler to read a full vector of values at the last key.
+  pvector<uint16_t> &data = quantized->_data;
+  data.reserve(keys.size() * num_animated + 3);
+  for (uint16_t key : keys) {
+    data.insert(data.end(), values.begin() + key * num_animated,
+                values.begin() + (key + 1) * num_animated);
+  }
+  data.insert(data.end(), 3, 0);
+
+  return quantized;
+}
+
+/**
+ * Fills the indicated array with the channel's tables as floats, decoding
+ * them if the channel is quantized.
+ */
+void AnimChannelMatrixXfmTable::
+get_float_tables(CPTA_stdfloat *tables) const {
+  for (int i = 0; i < num_matrix_components; i++) {
+    if (_quantized != nullptr) {
+      tables[i] = _quantized->decode_table(i);
+    } else {
+      tables[i] = _tables[i];
+    }
+  }
+}
+
+/**
+ * Evaluates all of the components at the indicated frame.
+ */
+void AnimChannelMatrixXfmTable::QuantizedTable::
+sample(int frame, PN_stdfloat components[num_matrix_components]) const {
+  for (int i = 0; i < num_matrix_components; i++) {
+    components[i] = _values[i];
+  }
+  if (_num_animated == 0) {
+    return;
+  }
+
+  frame %= _num_frames;
+  size_t k1 = std::upper_bound(_keys.begin(), _keys.end(), (uint16_t)frame) - _keys.begin();
+  size_t k0 = k1 - 1;
+  float t = 0.0f;
+  if (k1 < _keys.size()) {
+    t = (float)(frame - _keys[k0]) / (float)(_keys[k1] - _keys[k0]);
+  } else {
+    k1 = k0;
+  }
+
+  const uint16_t *q0 = &_data[k0 * _num_animated];
+  const uint16_t *q1 = &_data[k1 * _num_animated];
+  float result[num_matrix_components];
+
+#ifdef ANIMCHANNEL_USE_SSE2
+  // Four components at a time.  The last group may read past the last value
+  // of the key, which is why the data is padded.
+  const __m128i zero = _mm_setzero_si128();
+  const __m128 tv = _mm_set1_ps(t);
+  for (int slot = 0; slot < _num_animated; slot += 4) {
+    __m128 a = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(q0 + slot)), zero));
+    __m128 b = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(q1 + slot)), zero));
+    __m128 q = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), tv));
+    __m128 value = _mm_add_ps(_mm_loadu_ps(_base + slot), _mm_mul_ps(q, _mm_loadu_ps(_scale + slot)));
+    _mm_storeu_ps(result + slot, value);
+  }
+#else
+  for (int slot = 0; slot < _num_animated; ++slot) {
+    float q = (float)q0[slot] + ((float)q1[slot] - (float)q0[slot]) * t;
+    result[slot] = _base[slot] + _scale[slot] * q;
+  }
+#endif
+
+  for (int slot = 0; slot < _num_animated; ++slot) {
+    components[_components[slot]] = result[slot];
+  }
+}
+
+/**
+ * Returns a table of floats for the indicated component, as it would have
+ * been stored in the unquantized channel.
+ */
+CPTA_stdfloat AnimChannelMatrixXfmTable::QuantizedTable::
+decode_table(int table_index) const {
+  if ((_table_mask & (1u << table_index)) == 0) {
+    return CPTA_stdfloat(get_class_type());
+  }
+
+  if ((_animated_mask & (1u << table_index)) == 0) {
+    PTA_stdfloat table = PTA_stdfloat::empty_array(1, get_class_type());
+    table[0] = _values[table_index];
+    return table;
+  }
+
+  PTA_stdfloat table = PTA_stdfloat::empty_array(_num_frames, get_class_type());
+  PN_stdfloat components[num_matrix_components];
+  for (int f = 0; f < _num_frames; ++f) {
+    sample(f, components);
+    table[f] = components[table_index];
+  }
+  return table;
+}
+
+/**
+ * Returns the number of bytes taken up by the quantized values.
+ */
+size_t AnimChannelMatrixXfmTable::QuantizedTable::
+get_data_size() const {
+  return (_keys.size() + _data.size()) * sizeof(uint16_t);
+}
+
+/**
+ * Writes the quantized table to the indicated datagram.
+ */
+void AnimChannelMatrixXfmTable::QuantizedTable::
+write_datagram(Datagram &me) const {
+  me.add_uint16(_num_frames);
+  me.add_uint16(_table_mask);
+  me.add_uint16(_animated_mask);
+
+  for (int i = 0; i < num_matrix_components; i++) {
+    if ((_table_mask & (1u << i)) != 0) {
+      me.add_stdfloat(_values[i]);
+    }
+  }
+  for (int slot = 0; slot < _num_animated; ++slot) {
+    me.add_float32(_base[slot]);
+    me.add_float32(_scale[slot]);
+  }
+
+  if (_num_animated != 0) {
+    me.add_uint16(_keys.size());
+    for (uint16_t key : _keys) {
+      me.add_uint16(key);
+    }
+    size_t num_values = _keys.size() * _num_animated;
+    for (size_t n = 0; n < num_values; ++n) {
+      me.add_uint16(_data[n]);
+    }
+  }
+}
+
+/**
+ * Reads a quantized table written by write_datagram().  Returns false if the
+ * data does not describe a valid table, in which case the table must not be
+ * used.
+ */
+bool AnimChannelMatrixXfmTable::QuantizedTable::
+fillin(DatagramIterator &scan) {
+  _num_frames = std::max((int)scan.get_uint16(), 1);
+  _table_mask = scan.get_uint16();
+  _animated_mask = scan.get_uint16();
+  _num_animated = 0;
+
+  for (int i = 0; i < num_matrix_components; i++) {
+    _components[i] = 0;
+    _base[i] = 0.0f;
+    _scale[i] = 0.0f;
+    if ((_table_mask & (1u << i)) != 0) {
+      _values[i] = scan.get_stdfloat();
+    } else {
+      _values[i] = get_default_value(i);
+    }
+    if ((_animated_mask & (1u << i)) != 0) {
+      _components[_num_animated++] = (unsigned char)i;
+    }
+  }
+  for (int slot = 0; slot < _num_animated; ++slot) {
+    _base[slot] = scan.get_float32();
+    _scale[slot] = scan.get_float32();
+  }
+
+  if (_num_animated != 0) {
+    // Check the number of keys against the size of the data that remains
+    // before allocating anything.
+    size_t num_keys = scan.get_uint16();
+    if (num_keys == 0 ||
+        num_keys > scan.get_remaining_size() / (sizeof(uint16_t) * (_num_animated + 1))) {
+      return false;
+    }
+
+    // The sampler relies on the keys being strictly increasing, starting at
+    // the first frame, and staying within the animation.
+    _keys.resize(num_keys);
+    for (size_t k = 0; k < num_keys; ++k) {
+      _keys[k] = scan.get_uint16();
+      if (k == 0 ? (_keys[k] != 0) : (_keys[k] <= _keys[k - 1])) {
+        return false;
+      }
+    }
+    if (_keys.back() >= _num_frames) {
+      return false;
+    }
+
+    size_t num_values = num_keys * _num_animated;
+    _data.resize(num_values + 3, 0);
+    for (size_t n = 0; n < num_values; ++n) {
+      _data[n] = scan.get_uint16();
+    }
+  }
+  return true;
+}
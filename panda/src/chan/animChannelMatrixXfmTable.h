@@ -21,12 +21,17 @@
 #include "pointerToArray.h"
 #include "pta_stdfloat.h"
 #include "compose_matrix.h"
+#include "referenceCount.h"
+#include "pointerTo.h"
 
 /**
  * An animation channel that issues a matrix each frame, read from a table
  * such as might have been read from an egg file.  The table actually consists
  * of nine sub-tables, each representing one component of the transform:
  * scale, rotate, translate.
+ *
+ * The tables may optionally be quantized, see quantize(), in which case they
+ * are replaced with a much smaller keyframe-reduced table of 16-bit values.
  */
 class EXPCL_PANDA_CHAN AnimChannelMatrixXfmTable : public AnimChannelMatrix {
 protected:
@@ -61,9 +66,19 @@ PUBLISHED:
 
   MAKE_MAP_PROPERTY(tables, has_table, get_table, set_table, clear_table);
 
+  bool quantize(PN_stdfloat tolerance);
+  void dequantize();
+  INLINE bool is_quantized() const;
+  int get_num_keys() const;
+
+  MAKE_PROPERTY(quantized, is_quantized);
+
 public:
   virtual void write(std::ostream &out, int indent_level) const;
 
+  static void sample_batch(int frame, AnimChannelMatrixXfmTable *const *channels,
+                           size_t num_channels, LMatrix4 *mats);
+
 protected:
   virtual AnimGroup *make_copy(AnimGroup *parent) const;
 
@@ -73,6 +88,44 @@ protected:
 
   CPTA_stdfloat _tables[num_matrix_components];
 
+  /**
+   * The quantized form of the tables.  Each animated component is stored as
+   * a 16-bit fraction of its range, and only at the keyframes from which the
+   * remaining frames can be linearly interpolated within the tolerance.  The
+   * values of all animated components at one keyframe are adjacent.
+   */
+  class QuantizedTable : public ReferenceCount {
+  public:
+    void sample(int frame, PN_stdfloat components[num_matrix_components]) const;
+    CPTA_stdfloat decode_table(int table_index) const;
+    size_t get_data_size() const;
+
+    void write_datagram(Datagram &me) const;
+    bool fillin(DatagramIterator &scan);
+
+    int _num_frames;
+    int _num_animated;
+    unsigned int _table_mask;
+    unsigned int _animated_mask;
+
+    // These are indexed by component.
+    PN_stdfloat _values[num_matrix_components];
+
+    // These are indexed by animated slot.
+    unsigned char _components[num_matrix_components];
+    float _base[num_matrix_components];
+    float _scale[num_matrix_components];
+
+    pvector<uint16_t> _keys;
+    pvector<uint16_t> _data;
+  };
+
+  static PT(QuantizedTable) make_quantized(const CPTA_stdfloat *tables,
+                                           PN_stdfloat tolerance);
+  void get_float_tables(CPTA_stdfloat *tables) const;
+
+  CPT(QuantizedTable) _quantized;
+
 public:
   static void register_with_read_factory();
   virtual void write_datagram(BamWriter* manager, Datagram &me);
@@ -71,6 +71,7 @@ public:
 
   bool channel_has_changed(AnimChannelBase *channel, bool frame_blend_flag) const;
   void mark_channels(bool frame_blend_flag);
+  INLINE bool has_frame_changed() const;
 
 protected:
   virtual void animation_activated();
@@ -78,6 +78,23 @@ PRC_DESC("Set this false to disable reading of compressed animation channels, "
          "might want to do this would be to speed load time when you don't "
          "care about what the animation looks like."));
 
+ConfigVariableBool quantize_channels
+("quantize-channels", false,
+PRC_DESC("Set this true to write matrix animation channels to the bam file "
+         "in the quantized, keyframe-reduced form, which also reduces the "
+         "memory footprint of the channels when the bam file is loaded.  "
+         "This requires a bam-version of at least 6 46; older bam files "
+         "always store the channels as floats.  Channels that have "
+         "already been quantized with AnimBundle::quantize_channels() are "
+         "always written quantized when the bam version allows."));
+
+ConfigVariableDouble quantize_chan_tolerance
+("quantize-chan-tolerance", 0.001,
+PRC_DESC("The largest error that quantize-channels may introduce when "
+         "dropping frames that can be interpolated from the neighboring "
+         "keyframes.  This applies to each component in its own units, so "
+         "for the rotation it is specified in degrees."));
+
 ConfigVariableBool interpolate_frames
 ("interpolate-frames", false,
 PRC_DESC("Set this true to interpolate character animations between frames, "
@@ -109,6 +109,32 @@ bool MovingPartBase::
 do_update(PartBundle *root, const CycleData *root_cdata, PartGroup *parent,
           bool parent_changed, bool anim_changed,
           Thread *current_thread) {
+  bool any_changed = do_update_self(root, root_cdata, parent, parent_changed,
+                                    anim_changed, current_thread);
+
+  // Now recurse.
+  Children::iterator ci;
+  for (ci = _children.begin(); ci != _children.end(); ++ci) {
+    if ((*ci)->do_update(root, root_cdata, this, parent_changed,
+                         anim_changed, current_thread)) {
+      any_changed = true;
+    }
+  }
+
+  return any_changed;
+}
+
+/**
+ * Updates this particular part for the current frame, without recursing to
+ * its children.  On return, parent_changed is true if this part or any of its
+ * ancestors changed.
+ *
+ * The return value is true if this part has changed, false otherwise.
+ */
+bool MovingPartBase::
+do_update_self(PartBundle *root, const CycleData *root_cdata, PartGroup *parent,
+               bool &parent_changed, bool anim_changed,
+               Thread *current_thread) {
   bool any_changed = false;
   bool needs_update = anim_changed;
 
@@ -152,16 +178,7 @@ do_update(PartBundle *root, const CycleData *root_cdata, PartGroup *parent,
                                    current_thread);
   }
 
-  // Now recurse.
-  Children::iterator ci;
-  for (ci = _children.begin(); ci != _children.end(); ++ci) {
-    if ((*ci)->do_update(root, root_cdata, this,
-                         parent_changed || needs_update,
-                         anim_changed, current_thread)) {
-      any_changed = true;
-    }
-  }
-
+  parent_changed = parent_changed || needs_update;
   return any_changed;
 }
 
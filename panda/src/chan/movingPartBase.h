@@ -56,6 +56,9 @@ public:
   virtual bool do_update(PartBundle *root, const CycleData *root_cdata,
                          PartGroup *parent, bool parent_changed,
                          bool anim_changed, Thread *current_thread);
+  virtual bool do_update_self(PartBundle *root, const CycleData *root_cdata,
+                              PartGroup *parent, bool &parent_changed,
+                              bool anim_changed, Thread *current_thread);
 
   virtual void get_blend_value(const PartBundle *root)=0;
   virtual bool update_internals(PartBundle *root, PartGroup *parent,
@@ -14,6 +14,7 @@
 #include "movingPartMatrix.h"
 #include "animChannelMatrixDynamic.h"
 #include "animChannelMatrixFixed.h"
+#include "animChannelMatrixXfmTable.h"
 #include "compose_matrix.h"
 #include "datagram.h"
 #include "datagramIterator.h"
@@ -44,6 +45,22 @@ make_default_channel() const {
   return new AnimChannelMatrixFixed(get_name(), pos, hpr, scale);
 }
 
+/**
+ * Returns the table channel that this part takes its value from, if that
+ * value comes from the indicated control alone, and may therefore be sampled
+ * by AnimChannelMatrixXfmTable::sample_batch() instead of get_blend_value().
+ * Returns NULL otherwise.
+ */
+AnimChannelMatrixXfmTable *MovingPartMatrix::
+get_batch_channel(AnimControl *control) const {
+  if (_forced_channel != nullptr || _effective_control != control ||
+      _effective_channel == nullptr ||
+      !_effective_channel->is_exact_type(AnimChannelMatrixXfmTable::get_class_type())) {
+    return nullptr;
+  }
+  return (AnimChannelMatrixXfmTable *)_effective_channel.p();
+}
+
 /**
  * Attempts to blend the various matrix values indicated, and sets the _value
  * member to the resulting matrix.
@@ -70,8 +87,13 @@ get_blend_value(const PartBundle *root) {
   } else if (_effective_control != nullptr &&
              !cdata->_frame_blend_flag) {
     // A single value, the normal case.
-    ChannelType *channel = DCAST(ChannelType, _effective_channel);
-    channel->get_value(_effective_control->get_frame(), _value);
+    if (root->_batch_value != nullptr) {
+      // The bundle has already sampled it, together with the other joints.
+      _value = *root->_batch_value;
+    } else {
+      ChannelType *channel = DCAST(ChannelType, _effective_channel);
+      channel->get_value(_effective_control->get_frame(), _value);
+    }
 
   } else {
     // A blend of two or more values, either between multiple different
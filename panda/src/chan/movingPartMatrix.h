@@ -23,6 +23,8 @@
 
 EXPORT_TEMPLATE_CLASS(EXPCL_PANDA_CHAN, EXPTP_PANDA_CHAN, MovingPart<ACMatrixSwitchType>);
 
+class AnimChannelMatrixXfmTable;
+
 /**
  * This is a particular kind of MovingPart that accepts a matrix each frame.
  */
@@ -38,6 +40,8 @@ public:
   virtual AnimChannelBase *make_default_channel() const;
   virtual void get_blend_value(const PartBundle *root);
 
+  AnimChannelMatrixXfmTable *get_batch_channel(AnimControl *control) const;
+
   virtual bool apply_freeze_matrix(const LVecBase3 &pos, const LVecBase3 &hpr, const LVecBase3 &scale);
   virtual bool apply_control(PandaNode *node);
 
@@ -15,6 +15,8 @@
 #include "animBundle.h"
 #include "animBundleNode.h"
 #include "animControl.h"
+#include "animChannelMatrixXfmTable.h"
+#include "movingPartMatrix.h"
 #include "loader.h"
 #include "animPreloadTable.h"
 #include "config_chan.h"
@@ -55,6 +57,8 @@ PartBundle(const PartBundle &copy) :
 {
   _anim_preload = copy._anim_preload;
   _update_delay = 0.0;
+  _flat_parts_modified = 0;
+  _batch_value = nullptr;
 
   CDWriter cdata(_cycler, true);
   CDReader cdata_from(copy._cycler);
@@ -73,6 +77,8 @@ PartBundle(const string &name) :
   PartGroup(name)
 {
   _update_delay = 0.0;
+  _flat_parts_modified = 0;
+  _batch_value = nullptr;
 }
 
 /**
@@ -483,8 +489,7 @@ update() {
     bool anim_changed = cdata->_anim_changed;
     bool frame_blend_flag = cdata->_frame_blend_flag;
 
-    any_changed = do_update(this, cdata, nullptr, false, anim_changed,
-                            current_thread);
+    any_changed = do_flat_update(cdata, false, anim_changed, current_thread);
 
     // Now update all the controls for next time.
     ChannelBlend::const_iterator cbi;
@@ -508,7 +513,7 @@ bool PartBundle::
 force_update() {
   Thread *current_thread = Thread::get_current_thread();
   CDWriter cdata(_cycler, false, current_thread);
-  bool any_changed = do_update(this, cdata, nullptr, true, true, current_thread);
+  bool any_changed = do_flat_update(cdata, true, true, current_thread);
 
   // Now update all the controls for next time.
   ChannelBlend::const_iterator cbi;
@@ -523,6 +528,108 @@ force_update() {
 }
 
 
+/**
+ * Updates all of the parts in the bundle by walking the flattened list of
+ * parts, rather than recursing through the hierarchy.  Each part is handed
+ * the changed flag of its parent by index, so the parts are visited in the
+ * same order and with the same flags as do_update() would.  Assumes the
+ * cycler is locked for writing.
+ */
+bool PartBundle::
+do_flat_update(CData *cdata, bool parent_changed, bool anim_changed,
+               Thread *current_thread) {
+  unsigned int hierarchy_modified = get_hierarchy_modified();
+  if (_flat_parts_modified != hierarchy_modified) {
+    _flat_parts_modified = hierarchy_modified;
+    _flat_parts.clear();
+    r_flatten_parts(this, -1);
+    _flat_changed.resize(_flat_parts.size());
+    _batch_slots.resize(_flat_parts.size());
+  }
+
+  sample_batch(cdata, anim_changed);
+
+  bool any_changed = false;
+  size_t num_parts = _flat_parts.size();
+  for (size_t i = 0; i < num_parts; ++i) {
+    const FlatPart &fp = _flat_parts[i];
+    bool changed = (fp._parent_index >= 0) ? (_flat_changed[fp._parent_index] != 0) : parent_changed;
+    int slot = _batch_slots[i];
+    _batch_value = (slot >= 0) ? &_batch_values[slot] : nullptr;
+    if (fp._part->do_update_self(this, cdata, fp._parent, changed,
+                                 anim_changed, current_thread)) {
+      any_changed = true;
+    }
+    _flat_changed[i] = changed;
+  }
+  _batch_value = nullptr;
+
+  return any_changed;
+}
+
+/**
+ * In the normal case, where every joint follows the same animation without
+ * frame blending, samples the matrices of all of the joints that take their
+ * value from a table channel at once, with
+ * AnimChannelMatrixXfmTable::sample_batch().  Fills in _batch_slots for
+ * do_flat_update().  Assumes the cycler is locked for writing.
+ */
+void PartBundle::
+sample_batch(CData *cdata, bool anim_changed) {
+  std::fill(_batch_slots.begin(), _batch_slots.end(), -1);
+  if (cdata->_blend.size() != 1 || cdata->_frame_blend_flag) {
+    return;
+  }
+
+  // If the frame hasn't moved, the joints won't need a new value, unless the
+  // animation itself has changed.
+  AnimControl *control = (*cdata->_blend.begin()).first;
+  if (!anim_changed && !control->has_frame_changed()) {
+    return;
+  }
+
+  _batch_channels.clear();
+  size_t num_parts = _flat_parts.size();
+  for (size_t i = 0; i < num_parts; ++i) {
+    MovingPartMatrix *part = _flat_parts[i]._matrix_part;
+    if (part != nullptr) {
+      AnimChannelMatrixXfmTable *channel = part->get_batch_channel(control);
+      if (channel != nullptr) {
+        _batch_slots[i] = (int)_batch_channels.size();
+        _batch_channels.push_back(channel);
+      }
+    }
+  }
+
+  if (!_batch_channels.empty()) {
+    _batch_values.resize(_batch_channels.size());
+    AnimChannelMatrixXfmTable::sample_batch(control->get_frame(),
+                                            &_batch_channels[0],
+                                            _batch_channels.size(),
+                                            &_batch_values[0]);
+  }
+}
+
+/**
+ * Appends the descendants of the indicated part to _flat_parts in depth-first
+ * order, so that each part comes after its parent.
+ */
+void PartBundle::
+r_flatten_parts(PartGroup *parent, int parent_index) {
+  for (PartGroup *child : parent->_children) {
+    FlatPart fp;
+    fp._part = child;
+    fp._parent = parent;
+    fp._matrix_part = nullptr;
+    if (child->is_of_type(MovingPartMatrix::get_class_type())) {
+      fp._matrix_part = (MovingPartMatrix *)child;
+    }
+    fp._parent_index = parent_index;
+    _flat_parts.push_back(fp);
+    r_flatten_parts(child, (int)_flat_parts.size() - 1);
+  }
+}
+
 /**
  * Called by the AnimControl whenever it starts an animation.  This is just a
  * hook so the bundle can do something, if necessary, before the animation
@@ -28,6 +28,7 @@
 #include "cycleDataWriter.h"
 #include "luse.h"
 #include "pvector.h"
+#include "epvector.h"
 #include "transformState.h"
 #include "weakPointerTo.h"
 #include "copyOnWritePointer.h"
@@ -38,6 +39,8 @@ class PartBundleNode;
 class PartBundleNode;
 class TransformState;
 class AnimPreloadTable;
+class AnimChannelMatrixXfmTable;
+class MovingPartMatrix;
 
 /**
  * This is the root of a MovingPart hierarchy.  It defines the hierarchy of
@@ -165,6 +168,10 @@ private:
   void do_set_control_effect(AnimControl *control, PN_stdfloat effect, CData *cdata);
   PN_stdfloat do_get_control_effect(AnimControl *control, const CData *cdata) const;
   void clear_and_stop_intersecting(AnimControl *control, CData *cdata);
+  bool do_flat_update(CData *cdata, bool parent_changed, bool anim_changed,
+                      Thread *current_thread);
+  void sample_batch(CData *cdata, bool anim_changed);
+  void r_flatten_parts(PartGroup *parent, int parent_index);
 
   COWPT(AnimPreloadTable) _anim_preload;
 
@@ -176,6 +183,32 @@ private:
 
   double _update_delay;
 
+  // The parts of the bundle in depth-first order, each with the index of its
+  // parent in the same list, so that update() does not need to recurse.
+  // These are rebuilt whenever the part hierarchy changes, and are protected
+  // by the cycler lock.
+  class FlatPart {
+  public:
+    PartGroup *_part;
+    PartGroup *_parent;
+    MovingPartMatrix *_matrix_part;
+    int _parent_index;
+  };
+  typedef pvector<FlatPart> FlatParts;
+  FlatParts _flat_parts;
+  pvector<unsigned char> _flat_changed;
+  unsigned int _flat_parts_modified;
+
+  // The joints that take their matrix from a table channel, and whose
+  // matrices are sampled in one batch when all of them follow the same
+  // animation.  _batch_slots maps each flat part to its sampled matrix, or
+  // -1.  _batch_value points to the matrix of the part that is being updated,
+  // if it was sampled, for MovingPartMatrix::get_blend_value().
+  pvector<AnimChannelMatrixXfmTable *> _batch_channels;
+  epvector<LMatrix4> _batch_values;
+  pvector<int> _batch_slots;
+  const LMatrix4 *_batch_value;
+
   // This is the data that must be cycled between pipeline stages.
   class CData : public CycleData {
   public:
@@ -22,6 +22,7 @@
 #include "thread.h"
 #include "plist.h"
 #include "luse.h"
+#include "patomic.h"
 
 class AnimControl;
 class AnimGroup;
@@ -96,6 +97,9 @@ public:
   virtual bool do_update(PartBundle *root, const CycleData *root_cdata,
                          PartGroup *parent, bool parent_changed,
                          bool anim_changed, Thread *current_thread);
+  virtual bool do_update_self(PartBundle *root, const CycleData *root_cdata,
+                              PartGroup *parent, bool &parent_changed,
+                              bool anim_changed, Thread *current_thread);
   virtual void do_xform(const LMatrix4 &mat, const LMatrix4 &inv_mat);
   virtual void determine_effective_channels(const CycleData *root_cdata);
 
@@ -115,6 +119,14 @@ protected:
   typedef pvector< PT(PartGroup) > Children;
   Children _children;
 
+  INLINE static void mark_hierarchy_modified();
+  INLINE static unsigned int get_hierarchy_modified();
+
+  // Incremented whenever the children of any PartGroup change, so that
+  // PartBundle knows when to rebuild its flattened list of parts.  This may
+  // be bumped from several threads at once, so it is atomic.
+  static patomic<unsigned int> _hierarchy_modified;
+
 public:
   static void register_with_read_factory();
   virtual void write_datagram(BamWriter* manager, Datagram &me);
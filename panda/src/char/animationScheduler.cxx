@@ -0,0 +1,139 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animationScheduler.cxx
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#include "animationScheduler.h"
+#include "config_char.h"
+#include "clockObject.h"
+#include "lightMutexHolder.h"
+#include "mutexHolder.h"
+#include "pStatTimer.h"
+#include "jobSystem.h"
+#include "genericAsyncTask.h"
+#include "asyncTaskManager.h"
+
+patomic<AnimationScheduler *> AnimationScheduler::_global_ptr { nullptr };
+Mutex AnimationScheduler::_global_lock("AnimationScheduler::_global_lock");
+PStatCollector AnimationScheduler::_update_pcollector("*:Animation:Scheduler");
+
+/**
+ *
+ */
+AnimationScheduler::
+AnimationScheduler() :
+  _lock("AnimationScheduler::_lock"),
+  _first_frame(0),
+  _num_updated(0)
+{
+}
+
+/**
+ * Animates all of the Characters that have been scheduled since the last
+ * call, in parallel.  This is normally called once per frame by the task that
+ * the scheduler adds to the global task manager, but it may also be called
+ * explicitly by an application that runs its own main loop.
+ */
+void AnimationScheduler::
+update() {
+  Characters characters;
+  {
+    LightMutexHolder holder(_lock);
+    characters.swap(_scheduled);
+  }
+  _num_updated = (int)characters.size();
+  if (characters.empty()) {
+    return;
+  }
+
+  PStatTimer timer(_update_pcollector);
+
+  // Each Character locks itself while it updates, and does nothing if it has
+  // already been animated for the current frame time, so it does not matter
+  // if the same PartBundle is shared between several of them.
+  JobSystem::get_global_ptr()->parallel_process(characters.size(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      characters[i]->update();
+    }
+  });
+}
+
+/**
+ * Returns the global AnimationScheduler, creating it the first time this is
+ * called.  If animation-scheduler is enabled, this also adds the task that
+ * runs the scheduler every frame.
+ */
+AnimationScheduler *AnimationScheduler::
+get_global_ptr() {
+  AnimationScheduler *ptr = _global_ptr.load(std::memory_order_acquire);
+  if (ptr == nullptr) {
+    // The first call may come from several cull threads at once, so take a
+    // lock to make sure that only one scheduler and one task are created.
+    MutexHolder holder(_global_lock);
+    ptr = _global_ptr.load(std::memory_order_relaxed);
+    if (ptr == nullptr) {
+      ptr = new AnimationScheduler;
+
+      if (animation_scheduler) {
+        PT(GenericAsyncTask) task =
+          new GenericAsyncTask("animationScheduler", &st_update_task, ptr);
+        task->set_sort(animation_scheduler_sort);
+        AsyncTaskManager::get_global_ptr()->add(task);
+      }
+      _global_ptr.store(ptr, std::memory_order_release);
+    }
+  }
+  return ptr;
+}
+
+/**
+ * Queues up the indicated Character to be animated by the next call to
+ * update().  This is called by the Character during the cull traversal when
+ * animation-scheduler is enabled.  A Character that is scheduled more than
+ * once in the same frame is only queued once.
+ *
+ * The queue only holds on to the Characters scheduled in this frame and the
+ * previous one.  If nothing has called update() in the meantime, the older
+ * ones are dropped, so that an application without a running task manager
+ * doesn't keep its Characters alive in an ever-growing queue.  The cull
+ * traversal animates those Characters itself when it reaches them again.
+ */
+void AnimationScheduler::
+schedule(Character *character) {
+  int frame = ClockObject::get_global_clock()->get_frame_count();
+
+  LightMutexHolder holder(_lock);
+  if (character->_scheduled_frame != frame) {
+    character->_scheduled_frame = frame;
+    if (_scheduled.empty()) {
+      _first_frame = frame;
+
+    } else if (frame - _first_frame > 1) {
+      if (char_cat.is_debug()) {
+        char_cat.debug()
+          << "Dropping " << _scheduled.size() << " characters scheduled in "
+          << "frame " << _first_frame << " that were never updated\n";
+      }
+      _scheduled.clear();
+      _first_frame = frame;
+    }
+    _scheduled.push_back(character);
+  }
+}
+
+/**
+ * The task function that runs the scheduler once per frame.
+ */
+AsyncTask::DoneStatus AnimationScheduler::
+st_update_task(GenericAsyncTask *, void *data) {
+  ((AnimationScheduler *)data)->update();
+  return AsyncTask::DS_cont;
+}
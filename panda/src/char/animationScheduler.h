@@ -0,0 +1,83 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animationScheduler.h
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#ifndef ANIMATIONSCHEDULER_H
+#define ANIMATIONSCHEDULER_H
+
+#include "pandabase.h"
+#include "character.h"
+#include "lightMutexHolder.h"
+#include "pmutex.h"
+#include "patomic.h"
+#include "pStatCollector.h"
+#include "pvector.h"
+#include "pointerTo.h"
+#include "asyncTask.h"
+
+class GenericAsyncTask;
+
+/**
+ * Animates many Characters together, once per frame, on the JobSystem's
+ * worker threads.
+ *
+ * Normally, each Character updates its joints when the cull traversal reaches
+ * it, one character at a time.  When animation-scheduler is enabled, every
+ * Character that is visible in one frame is handed to the scheduler, and
+ * update() animates all of them at once before the next frame is rendered, so
+ * that the cull traversal finds them already up-to-date and only has to read
+ * the results.  A task that calls update() is added to the global task
+ * manager automatically.
+ *
+ * Characters that come into view for the first time are still animated by the
+ * cull traversal, in the frame in which they are first seen.  Applications may
+ * also schedule characters explicitly, for instance to keep animating
+ * characters that are out of view.
+ *
+ * Note that the joints of a scheduled Character are then animated on a worker
+ * thread, so the set_transform() calls that move the nodes of exposed joints
+ * happen there as well, at the same time as other Characters are animated.
+ */
+class EXPCL_PANDA_CHAR AnimationScheduler {
+protected:
+  AnimationScheduler();
+
+PUBLISHED:
+  void schedule(Character *character);
+  void update();
+
+  INLINE int get_num_scheduled() const;
+  INLINE int get_num_updated() const;
+
+  MAKE_PROPERTY(num_scheduled, get_num_scheduled);
+  MAKE_PROPERTY(num_updated, get_num_updated);
+
+  static AnimationScheduler *get_global_ptr();
+
+private:
+  static AsyncTask::DoneStatus st_update_task(GenericAsyncTask *task, void *data);
+
+  mutable LightMutex _lock;
+
+  typedef pvector<PT(Character)> Characters;
+  Characters _scheduled;
+  int _first_frame;
+  int _num_updated;
+
+  static patomic<AnimationScheduler *> _global_ptr;
+  static Mutex _global_lock;
+  static PStatCollector _update_pcollector;
+};
+
+#include "animationScheduler.I"
+
+#endif
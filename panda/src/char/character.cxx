@@ -27,6 +27,7 @@
 #include "camera.h"
 #include "cullTraverser.h"
 #include "cullTraverserData.h"
+#include "animationScheduler.h"
 
 TypeHandle Character::_type_handle;
 
@@ -41,6 +42,7 @@ Character(const Character &copy, bool copy_bundles) :
   _last_auto_update(-1.0),
   _view_frame(-1),
   _view_distance2(0.0f),
+  _scheduled_frame(-1),
   _lod_center(copy._lod_center),
   _lod_far_distance(copy._lod_far_distance),
   _lod_near_distance(copy._lod_near_distance),
@@ -78,6 +80,7 @@ Character(const std::string &name) :
   _last_auto_update(-1.0),
   _view_frame(-1),
   _view_distance2(0.0f),
+  _scheduled_frame(-1),
   _joints_pcollector(PStatCollector(_animation_pcollector, name), "Joints"),
   _skinning_pcollector(PStatCollector(_animation_pcollector, name), "Vertices")
 {
@@ -198,6 +201,12 @@ cull_callback(CullTraverser *trav, CullTraverserData &data) {
   }
 
   update();
+
+  if (animation_scheduler) {
+    // Have the scheduler animate us together with the other visible
+    // characters next frame, before we are culled again.
+    AnimationScheduler::get_global_ptr()->schedule(this);
+  }
   return true;
 }
 
@@ -707,6 +716,7 @@ r_merge_bundles(Character::JointMap &joint_map,
   }
 
   new_group->_children.swap(new_children);
+  PartGroup::mark_hierarchy_modified();
 }
 
 /**
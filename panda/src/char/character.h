@@ -134,6 +134,10 @@ private:
   int _view_frame;
   double _view_distance2;
 
+  // The last frame in which this Character was handed to the
+  // AnimationScheduler.  Protected by the scheduler's lock.
+  int _scheduled_frame;
+
   LPoint3 _lod_center;
   PN_stdfloat _lod_far_distance;
   PN_stdfloat _lod_near_distance;
@@ -174,6 +178,8 @@ public:
 
 private:
   static TypeHandle _type_handle;
+
+  friend class AnimationScheduler;
 };
 
 #include "character.I"
@@ -40,6 +40,23 @@ ConfigVariableBool even_animation
           "The default is to compute vertices only when they need to be "
           "computed, which can lead to an uneven frame rate."));
 
+ConfigVariableBool animation_scheduler
+("animation-scheduler", false,
+ PRC_DESC("When this is true, the Characters that were visible in the "
+          "previous frame are animated all at once, on the job system's "
+          "worker threads, by a task that runs before the frame is rendered, "
+          "rather than one at a time as the cull traversal reaches them.  "
+          "This can greatly reduce the time spent animating large crowds "
+          "of characters on machines with several cores.  Note that the "
+          "nodes of exposed joints are then also moved on those threads."));
+
+ConfigVariableInt animation_scheduler_sort
+("animation-scheduler-sort", 45,
+ PRC_DESC("The sort value of the task that runs the AnimationScheduler "
+          "when animation-scheduler is enabled.  It should run after the "
+          "tasks that start and stop animations, and before the scene is "
+          "rendered."));
+
 
 /**
  * Initializes the library.  This must be called at least once before any of
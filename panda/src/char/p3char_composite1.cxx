@@ -1,4 +1,5 @@
 #include "config_char.cxx"
+#include "animationScheduler.cxx"
 #include "character.cxx"
 #include "characterJoint.cxx"
 #include "characterJointBundle.cxx"
@@ -0,0 +1,405 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionBVH.cxx
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#include "collisionBVH.h"
+#include "boundingLine.h"
+#include "finiteBoundingVolume.h"
+#include "datagram.h"
+#include "datagramIterator.h"
+
+#include <algorithm>
+
+/**
+ * Starts building a new hierarchy over the indicated number of items.  Each
+ * item should then be given its box with set_item(), after which end_build()
+ * should be called.  Items that are not given a box are never culled.
+ */
+void CollisionBVH::
+begin_build(size_t num_items) {
+  clear();
+  _num_items = (uint32_t)num_items;
+
+  Item item;
+  item._bounded = false;
+  _build_items.assign(num_items, item);
+}
+
+/**
+ * Sets the box of the nth item to the box around the indicated bounding
+ * volume.  If the volume is not finite, the item is never culled.  This may
+ * only be called between begin_build() and end_build().
+ */
+void CollisionBVH::
+set_item(size_t n, const BoundingVolume *bounds) {
+  nassertv(n < _build_items.size());
+  const FiniteBoundingVolume *fbv = bounds->as_finite_bounding_volume();
+  if (fbv != nullptr && !fbv->is_empty() && !fbv->is_infinite()) {
+    set_item(n, fbv->get_min(), fbv->get_max());
+  } else {
+    _build_items[n]._bounded = false;
+  }
+}
+
+/**
+ * Builds the hierarchy from the boxes given to set_item().
+ */
+void CollisionBVH::
+end_build() {
+  nassertv(_build_items.size() == _num_items);
+
+  _indices.reserve(_num_items);
+  for (uint32_t i = 0; i < _num_items; ++i) {
+    Item &item = _build_items[i];
+    if (item._bounded) {
+      // Pad the box a little, so that the culling errs on the side of
+      // testing a solid that it could have skipped.
+      LVector3 pad = (item._max - item._min) * 1.0e-5f + LVector3(1.0e-5f);
+      item._min -= pad;
+      item._max += pad;
+      _indices.push_back(i);
+    } else {
+      _unbounded.push_back(i);
+    }
+  }
+
+  if (!_indices.empty()) {
+    _nodes.reserve((_indices.size() / max_leaf_items + 1) * 2);
+    r_build(0, _indices.size());
+
+    _boxes.reserve(_indices.size());
+    for (uint32_t index : _indices) {
+      Box box;
+      box._min = _build_items[index]._min;
+      box._max = _build_items[index]._max;
+      _boxes.push_back(box);
+    }
+  }
+
+  _build_items.clear();
+  _build_items.shrink_to_fit();
+}
+
+/**
+ * Fills result with the indices of the items whose boxes overlap the
+ * indicated box, and of the items that have no box, in ascending order.  Any
+ * previous contents of result are preserved.
+ */
+void CollisionBVH::
+find_overlaps(const LPoint3 &min_point, const LPoint3 &max_point,
+              Indices &result) const {
+  size_t first_result = result.size();
+
+  if (!_nodes.empty()) {
+    uint32_t stack[64];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0) {
+      uint32_t ni = stack[--stack_size];
+      const Node &node = _nodes[ni];
+      if (!overlaps(node, min_point, max_point)) {
+        continue;
+      }
+      if (node._count != 0) {
+        for (uint32_t i = node._first; i < node._first + node._count; ++i) {
+          if (overlaps(_boxes[i], min_point, max_point)) {
+            result.push_back(_indices[i]);
+          }
+        }
+      } else {
+        nassertv(stack_size + 2 <= 64);
+        stack[stack_size++] = node._first;
+        stack[stack_size++] = ni + 1;
+      }
+    }
+  }
+
+  finish_query(result, first_result);
+}
+
+/**
+ * Fills result with the indices of the items whose boxes are crossed by the
+ * infinite line through origin along direction, and of the items that have
+ * no box, in ascending order.  Any previous contents of result are preserved.
+ */
+void CollisionBVH::
+find_line_overlaps(const LPoint3 &origin, const LVector3 &direction,
+                   Indices &result) const {
+  size_t first_result = result.size();
+
+  if (!_nodes.empty()) {
+    uint32_t stack[64];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0) {
+      uint32_t ni = stack[--stack_size];
+      const Node &node = _nodes[ni];
+      if (!overlaps_line(node, origin, direction)) {
+        continue;
+      }
+      if (node._count != 0) {
+        for (uint32_t i = node._first; i < node._first + node._count; ++i) {
+          if (overlaps_line(_boxes[i], origin, direction)) {
+            result.push_back(_indices[i]);
+          }
+        }
+      } else {
+        nassertv(stack_size + 2 <= 64);
+        stack[stack_size++] = node._first;
+        stack[stack_size++] = ni + 1;
+      }
+    }
+  }
+
+  finish_query(result, first_result);
+}
+
+/**
+ * Fills result with the indices of the items that might intersect the
+ * indicated bounding volume, in ascending order.  Returns false if this kind
+ * of volume cannot be used to cull the items, in which case all items should
+ * be considered.
+ */
+bool CollisionBVH::
+find_volume_overlaps(const GeometricBoundingVolume *volume,
+                     Indices &result) const {
+  if (volume->is_infinite()) {
+    return false;
+  }
+  if (volume->is_empty()) {
+    // Nothing can intersect an empty volume, but let the caller decide for
+    // the items without a box.
+    size_t first_result = result.size();
+    finish_query(result, first_result);
+    return true;
+  }
+
+  const FiniteBoundingVolume *fbv = volume->as_finite_bounding_volume();
+  if (fbv != nullptr) {
+    find_overlaps(fbv->get_min(), fbv->get_max(), result);
+    return true;
+  }
+
+  if (volume->is_exact_type(BoundingLine::get_class_type())) {
+    const BoundingLine *line = (const BoundingLine *)volume;
+    find_line_overlaps(line->get_point_a(),
+                       line->get_point_b() - line->get_point_a(), result);
+    return true;
+  }
+
+  return false;
+}
+
+/**
+ * Writes the hierarchy to the indicated datagram.
+ */
+void CollisionBVH::
+write_datagram(Datagram &dg) const {
+  dg.add_uint32(_num_items);
+
+  dg.add_uint32(_nodes.size());
+  for (const Node &node : _nodes) {
+    node._min.write_datagram(dg);
+    node._max.write_datagram(dg);
+    dg.add_uint32(node._first);
+    dg.add_uint32(node._count);
+  }
+
+  dg.add_uint32(_indices.size());
+  for (size_t i = 0; i < _indices.size(); ++i) {
+    dg.add_uint32(_indices[i]);
+    _boxes[i]._min.write_datagram(dg);
+    _boxes[i]._max.write_datagram(dg);
+  }
+
+  dg.add_uint32(_unbounded.size());
+  for (uint32_t index : _unbounded) {
+    dg.add_uint32(index);
+  }
+}
+
+/**
+ * Reads a hierarchy written by write_datagram(), which should have been built
+ * for the indicated number of items.  If the data does not describe a valid
+ * hierarchy over that many items, this returns false and leaves the
+ * hierarchy empty, so that it will be rebuilt.
+ */
+bool CollisionBVH::
+fillin(DatagramIterator &scan, size_t num_items) {
+  clear();
+  _num_items = scan.get_uint32();
+
+  // Check each count against the size of the data that remains before
+  // allocating anything, assuming the smallest size of each entry.
+  size_t num_nodes = scan.get_uint32();
+  if (num_nodes > scan.get_remaining_size() / (sizeof(float) * 6 + 8)) {
+    clear();
+    return false;
+  }
+  _nodes.resize(num_nodes);
+  for (Node &node : _nodes) {
+    node._min.read_datagram(scan);
+    node._max.read_datagram(scan);
+    node._first = scan.get_uint32();
+    node._count = scan.get_uint32();
+  }
+
+  size_t num_indices = scan.get_uint32();
+  if (num_indices > scan.get_remaining_size() / (sizeof(float) * 6 + 4)) {
+    clear();
+    return false;
+  }
+  _indices.resize(num_indices);
+  _boxes.resize(num_indices);
+  for (size_t i = 0; i < num_indices; ++i) {
+    _indices[i] = scan.get_uint32();
+    _boxes[i]._min.read_datagram(scan);
+    _boxes[i]._max.read_datagram(scan);
+  }
+
+  size_t num_unbounded = scan.get_uint32();
+  if (num_unbounded > scan.get_remaining_size() / 4) {
+    clear();
+    return false;
+  }
+  _unbounded.resize(num_unbounded);
+  for (uint32_t &index : _unbounded) {
+    index = scan.get_uint32();
+  }
+
+  if (!validate(num_items)) {
+    clear();
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Recursively builds the node for the items in the indicated range of
+ * _indices, which is reordered as needed.
+ */
+void CollisionBVH::
+r_build(size_t begin, size_t end) {
+  size_t node_index = _nodes.size();
+  _nodes.push_back(Node());
+
+  const Item &first = _build_items[_indices[begin]];
+  LPoint3 min_point = first._min;
+  LPoint3 max_point = first._max;
+  LPoint3 min_center = (first._min + first._max) * 0.5f;
+  LPoint3 max_center = min_center;
+  for (size_t i = begin + 1; i < end; ++i) {
+    const Item &item = _build_items[_indices[i]];
+    LPoint3 center = (item._min + item._max) * 0.5f;
+    for (int a = 0; a < 3; ++a) {
+      min_point[a] = std::min(min_point[a], item._min[a]);
+      max_point[a] = std::max(max_point[a], item._max[a]);
+      min_center[a] = std::min(min_center[a], center[a]);
+      max_center[a] = std::max(max_center[a], center[a]);
+    }
+  }
+
+  Node &node = _nodes[node_index];
+  node._min = min_point;
+  node._max = max_point;
+
+  // Split along the axis in which the centers are spread out the most.
+  LVector3 extent = max_center - min_center;
+  int axis = 0;
+  if (extent[1] > extent[axis]) {
+    axis = 1;
+  }
+  if (extent[2] > extent[axis]) {
+    axis = 2;
+  }
+
+  if (end - begin <= max_leaf_items || extent[axis] <= 0) {
+    node._first = (uint32_t)begin;
+    node._count = (uint32_t)(end - begin);
+    return;
+  }
+
+  // Split at the median, which keeps the tree balanced.
+  size_t middle = begin + (end - begin) / 2;
+  const pvector<Item> &items = _build_items;
+  std::nth_element(_indices.begin() + begin, _indices.begin() + middle,
+                   _indices.begin() + end,
+    [&items, axis] (uint32_t a, uint32_t b) {
+      return (items[a]._min[axis] + items[a]._max[axis]) <
+             (items[b]._min[axis] + items[b]._max[axis]);
+    });
+
+  r_build(begin, middle);
+  _nodes[node_index]._first = (uint32_t)_nodes.size();
+  _nodes[node_index]._count = 0;
+  r_build(middle, end);
+}
+
+/**
+ * Returns true if the hierarchy is consistent, and only refers to items
+ * below num_items.  This is used to check a hierarchy read from a bam file.
+ */
+bool CollisionBVH::
+validate(size_t num_items) const {
+  if (_num_items != num_items) {
+    return false;
+  }
+
+  size_t num_nodes = _nodes.size();
+  size_t num_indices = _indices.size();
+  pvector<int> depths(num_nodes, 0);
+  for (size_t ni = 0; ni < num_nodes; ++ni) {
+    const Node &node = _nodes[ni];
+    if (node._count != 0) {
+      if ((size_t)node._first + (size_t)node._count > num_indices) {
+        return false;
+      }
+    } else {
+      // Both children must come after this node, so that the walk always
+      // moves forward through the array and cannot loop.
+      if (ni + 1 >= num_nodes || node._first <= ni + 1 ||
+          node._first >= num_nodes) {
+        return false;
+      }
+      if (depths[ni] >= max_depth) {
+        return false;
+      }
+      depths[ni + 1] = std::max(depths[ni + 1], depths[ni] + 1);
+      depths[node._first] = std::max(depths[node._first], depths[ni] + 1);
+    }
+  }
+
+  for (uint32_t index : _indices) {
+    if (index >= num_items) {
+      return false;
+    }
+  }
+  for (uint32_t index : _unbounded) {
+    if (index >= num_items) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Adds the items without a box to the results added since first_result, and
+ * sorts those results, so that the items are visited in their original
+ * order.
+ */
+void CollisionBVH::
+finish_query(Indices &result, size_t first_result) const {
+  result.insert(result.end(), _unbounded.begin(), _unbounded.end());
+  std::sort(result.begin() + first_result, result.end());
+}
@@ -0,0 +1,122 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionBVH.h
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#ifndef COLLISIONBVH_H
+#define COLLISIONBVH_H
+
+#include "pandabase.h"
+#include "luse.h"
+#include "pvector.h"
+
+#include <algorithm>
+#include <limits>
+
+class BoundingVolume;
+class GeometricBoundingVolume;
+class Datagram;
+class DatagramIterator;
+
+/**
+ * A bounding-volume hierarchy over a list of items, each of which is
+ * represented by an axis-aligned box.  This is used internally by
+ * CollisionNode, to quickly find the solids that a collider might intersect
+ * when there are very many solids in one node, and by CollisionFloorMesh, to
+ * find the triangles under a point.
+ *
+ * The items are referred to by their index in the list the hierarchy was
+ * built from.  Items without a finite bounding volume are never culled.  The
+ * hierarchy is stored as a flat array of nodes, so that it is cheap to copy
+ * and to write to a bam file.
+ */
+class EXPCL_PANDA_COLLIDE CollisionBVH {
+public:
+  typedef pvector<uint32_t> Indices;
+
+  INLINE CollisionBVH();
+
+  INLINE bool is_empty() const;
+  INLINE size_t get_num_items() const;
+  INLINE void clear();
+
+  void begin_build(size_t num_items);
+  INLINE void set_item(size_t n, const LPoint3 &min_point, const LPoint3 &max_point);
+  void set_item(size_t n, const BoundingVolume *bounds);
+  void end_build();
+
+  void find_overlaps(const LPoint3 &min_point, const LPoint3 &max_point,
+                     Indices &result) const;
+  void find_line_overlaps(const LPoint3 &origin, const LVector3 &direction,
+                          Indices &result) const;
+  bool find_volume_overlaps(const GeometricBoundingVolume *volume,
+                            Indices &result) const;
+
+  void write_datagram(Datagram &dg) const;
+  bool fillin(DatagramIterator &scan, size_t num_items);
+
+private:
+  class Item {
+  public:
+    LPoint3 _min;
+    LPoint3 _max;
+    bool _bounded;
+  };
+
+  class Box {
+  public:
+    LPoint3 _min;
+    LPoint3 _max;
+  };
+
+  class Node : public Box {
+  public:
+
+    // For a leaf, the range of _indices it contains.  For an interior node,
+    // _count is 0, its first child follows it directly, and _first is the
+    // index of its second child.
+    uint32_t _first;
+    uint32_t _count;
+  };
+
+  void r_build(size_t begin, size_t end);
+  bool validate(size_t num_items) const;
+  void finish_query(Indices &result, size_t first_result) const;
+
+  INLINE static bool overlaps(const Box &box, const LPoint3 &min_point,
+                              const LPoint3 &max_point);
+  INLINE static bool overlaps_line(const Box &box, const LPoint3 &origin,
+                                   const LVector3 &direction);
+
+  typedef pvector<Node> Nodes;
+  Nodes _nodes;
+
+  // The items in the leaves, in the order of the leaves, with their boxes.
+  Indices _indices;
+  typedef pvector<Box> Boxes;
+  Boxes _boxes;
+
+  Indices _unbounded;
+  uint32_t _num_items;
+
+  // Only used while building.
+  pvector<Item> _build_items;
+
+  static const uint32_t max_leaf_items = 4;
+
+  // The queries walk the tree with a fixed-size stack, which limits its
+  // depth.
+  static const int max_depth = 62;
+};
+
+#include "collisionBVH.I"
+
+#endif
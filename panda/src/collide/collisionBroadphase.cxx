@@ -0,0 +1,482 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionBroadphase.cxx
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#include "collisionBroadphase.h"
+#include "config_collide.h"
+#include "finiteBoundingVolume.h"
+#include "boundingLine.h"
+#include "lightMutexHolder.h"
+#include "pStatTimer.h"
+#include "datagram.h"
+#include "datagramIterator.h"
+#include "bamReader.h"
+#include "bamWriter.h"
+
+#include <algorithm>
+
+TypeHandle CollisionBroadphase::_type_handle;
+
+PStatCollector CollisionBroadphase::_update_pcollector("App:Collisions:Broadphase update");
+
+/**
+ * Creates a CollisionBroadphase with the cell size given by the config
+ * variable collision-broadphase-cell-size.
+ */
+CollisionBroadphase::
+CollisionBroadphase(const std::string &name) :
+  PandaNode(name),
+  _cell_size(1),
+  _inv_cell_size(1),
+  _stale(true)
+{
+  set_cell_size((PN_stdfloat)collision_broadphase_cell_size);
+}
+
+/**
+ *
+ */
+CollisionBroadphase::
+CollisionBroadphase(const std::string &name, PN_stdfloat cell_size) :
+  PandaNode(name),
+  _cell_size(1),
+  _inv_cell_size(1),
+  _stale(true)
+{
+  set_cell_size(cell_size);
+}
+
+/**
+ * The grid is not copied; the copy builds its own when it is traversed.
+ */
+CollisionBroadphase::
+CollisionBroadphase(const CollisionBroadphase &copy) :
+  PandaNode(copy),
+  _cell_size(copy._cell_size),
+  _inv_cell_size(copy._inv_cell_size),
+  _stale(true)
+{
+}
+
+/**
+ * Returns a newly-allocated Node that is a shallow copy of this one.  It will
+ * be a different Node pointer, but its internal data may or may not be shared
+ * with that of the original Node.
+ */
+PandaNode *CollisionBroadphase::
+make_copy() const {
+  return new CollisionBroadphase(*this);
+}
+
+/**
+ * Changes the size of each cell of the grid, in the coordinate space of this
+ * node.  The grid will be rebuilt the next time it is traversed.
+ */
+void CollisionBroadphase::
+set_cell_size(PN_stdfloat cell_size) {
+  nassertv(cell_size > 0);
+  LightMutexHolder holder(_lock);
+  _cell_size = cell_size;
+  _inv_cell_size = 1 / cell_size;
+  _stale = true;
+}
+
+/**
+ * Returns the number of cells of the grid that contain at least one child.
+ * This brings the grid up to date first.
+ */
+size_t CollisionBroadphase::
+get_num_cells() const {
+  LightMutexHolder holder(_lock);
+  update(Thread::get_current_thread());
+  return _cells.get_num_entries();
+}
+
+/**
+ * Fills result with the indices of the children that might intersect at least
+ * one of the indicated bounding volumes, which are in the coordinate space of
+ * this node, in increasing order.  This is called by the CollisionTraverser.
+ *
+ * Returns false if one of the bounding volumes is null or of a kind that
+ * cannot be looked up in the grid, in which case all of the children should
+ * be visited.
+ */
+bool CollisionBroadphase::
+find_children(Indices &result, const GeometricBoundingVolume *const *bounds,
+              size_t num_bounds, Thread *current_thread) const {
+  LightMutexHolder holder(_lock);
+  update(current_thread);
+
+  result.clear();
+  size_t num_cells = _cells.get_num_entries();
+
+  for (size_t i = 0; i < num_bounds && num_cells > 0; ++i) {
+    const GeometricBoundingVolume *bound = bounds[i];
+    if (bound == nullptr || bound->is_infinite()) {
+      return false;
+    }
+    if (bound->is_empty()) {
+      continue;
+    }
+
+    CellRange range;
+    const BoundingLine *line = bound->as_bounding_line();
+    if (line != nullptr) {
+      // The line is infinite, but we only need the part of it that passes
+      // through the occupied part of the grid.
+      LPoint3 lo, hi;
+      for (int k = 0; k < 3; ++k) {
+        lo[k] = _occupied._min[k] * _cell_size;
+        hi[k] = (_occupied._max[k] + 1) * _cell_size;
+      }
+      LPoint3 a = line->get_point_a();
+      LVector3 d = line->get_point_b() - a;
+      PN_stdfloat t0 = -std::numeric_limits<PN_stdfloat>::infinity();
+      PN_stdfloat t1 = std::numeric_limits<PN_stdfloat>::infinity();
+      bool miss = false;
+      for (int k = 0; k < 3 && !miss; ++k) {
+        if (IS_NEARLY_ZERO(d[k])) {
+          miss = (a[k] < lo[k] - _cell_size || a[k] > hi[k] + _cell_size);
+        } else {
+          PN_stdfloat ta = (lo[k] - a[k]) / d[k];
+          PN_stdfloat tb = (hi[k] - a[k]) / d[k];
+          t0 = std::max(t0, std::min(ta, tb));
+          t1 = std::min(t1, std::max(ta, tb));
+          miss = (t0 > t1);
+        }
+      }
+      if (miss) {
+        continue;
+      }
+      if (t0 == -std::numeric_limits<PN_stdfloat>::infinity()) {
+        // The line is parallel to all three axes; it can only be degenerate.
+        return false;
+      }
+      LPoint3 p0 = a + d * t0;
+      LPoint3 p1 = a + d * t1;
+      PN_stdfloat pad = _cell_size * 0.01f;
+      for (int k = 0; k < 3; ++k) {
+        range._min[k] = get_cell(std::min(p0[k], p1[k]) - pad);
+        range._max[k] = get_cell(std::max(p0[k], p1[k]) + pad);
+      }
+
+    } else {
+      // Allow for some roundoff error in the bounding volumes, so that we
+      // don't miss a child that is just touching the collider.
+      if (!get_range(range, bound, _cell_size * 0.01f)) {
+        return false;
+      }
+    }
+
+    // Only the occupied part of the grid needs to be searched.
+    uint64_t count = 1;
+    for (int k = 0; k < 3; ++k) {
+      range._min[k] = std::max(range._min[k], _occupied._min[k]);
+      range._max[k] = std::min(range._max[k], _occupied._max[k]);
+      if (range._min[k] > range._max[k]) {
+        count = 0;
+        break;
+      }
+      count *= (uint64_t)(range._max[k] - range._min[k] + 1);
+    }
+    if (count == 0) {
+      continue;
+    }
+
+    if (count > num_cells) {
+      // There are fewer occupied cells than cells in the range; it is
+      // quicker to check each of them.
+      for (size_t n = 0; n < num_cells; ++n) {
+        uint64_t key = _cells.get_key(n);
+        int x = (int)(key & 0x1fffff) - 0x100000;
+        int y = (int)((key >> 21) & 0x1fffff) - 0x100000;
+        int z = (int)((key >> 42) & 0x1fffff) - 0x100000;
+        if (x >= range._min[0] && x <= range._max[0] &&
+            y >= range._min[1] && y <= range._max[1] &&
+            z >= range._min[2] && z <= range._max[2]) {
+          const Indices &cell = _cells.get_data(n);
+          result.insert(result.end(), cell.begin(), cell.end());
+        }
+      }
+    } else {
+      for (int z = range._min[2]; z <= range._max[2]; ++z) {
+        for (int y = range._min[1]; y <= range._max[1]; ++y) {
+          for (int x = range._min[0]; x <= range._max[0]; ++x) {
+            int n = _cells.find(make_key(x, y, z));
+            if (n != -1) {
+              const Indices &cell = _cells.get_data(n);
+              result.insert(result.end(), cell.begin(), cell.end());
+            }
+          }
+        }
+      }
+    }
+  }
+
+  result.insert(result.end(), _always.begin(), _always.end());
+
+  // Visit the children in their usual order, and each only once.
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return true;
+}
+
+/**
+ *
+ */
+void CollisionBroadphase::
+output(std::ostream &out) const {
+  PandaNode::output(out);
+  out << " cell_size " << _cell_size;
+}
+
+/**
+ * Called after a scene graph update that either adds or remove children from
+ * this node.
+ */
+void CollisionBroadphase::
+children_changed() {
+  _stale = true;
+}
+
+/**
+ * Computes the range of cells covered by the indicated bounding volume, grown
+ * by pad on each side.  Returns false if the volume is not finite.
+ */
+bool CollisionBroadphase::
+get_range(CellRange &range, const GeometricBoundingVolume *bounds,
+          PN_stdfloat pad) const {
+  if (bounds->is_empty() || bounds->is_infinite()) {
+    return false;
+  }
+  const FiniteBoundingVolume *fbv = bounds->as_finite_bounding_volume();
+  if (fbv == nullptr) {
+    return false;
+  }
+
+  LPoint3 min_point = fbv->get_min();
+  LPoint3 max_point = fbv->get_max();
+  for (int k = 0; k < 3; ++k) {
+    range._min[k] = get_cell(min_point[k] - pad);
+    range._max[k] = get_cell(max_point[k] + pad);
+  }
+  return true;
+}
+
+/**
+ * Brings the grid up to date with the children's bounding volumes.  Assumes
+ * the lock is held.
+ */
+void CollisionBroadphase::
+update(Thread *current_thread) const {
+  // This also brings the bounding volumes cached on each child connection up
+  // to date.  The sequence number changes whenever one of them might have.
+  UpdateSeq seq;
+  get_bounds(seq, current_thread);
+  bool stale = _stale.exchange(false);
+  if (!stale && seq == _last_seq) {
+    return;
+  }
+
+  PStatTimer timer(_update_pcollector, current_thread);
+
+  Children children = get_children(current_thread);
+  size_t num_children = children.get_num_children();
+  if (stale || num_children != _entries.size()) {
+    rebuild(children);
+
+  } else {
+    for (size_t i = 0; i < num_children; ++i) {
+      const DownConnection &child = children.get_child_connection(i);
+      ChildEntry &entry = _entries[i];
+      if (entry._child != child.get_child()) {
+        // The children have been shuffled around.
+        rebuild(children);
+        break;
+      }
+      if (entry._bounds != child.get_bounds()) {
+        // This child has moved, or changed shape.  We hold on to the old
+        // bounding volume, so a new one can't have the same address.
+        remove_child((int)i);
+        entry._bounds = child.get_bounds();
+        insert_child((int)i);
+      }
+    }
+  }
+
+  _last_seq = seq;
+}
+
+/**
+ * Builds the grid from scratch.  Assumes the lock is held.
+ */
+void CollisionBroadphase::
+rebuild(const Children &children) const {
+  _cells.clear();
+  _always.clear();
+  for (int k = 0; k < 3; ++k) {
+    _occupied._min[k] = 0x100000;
+    _occupied._max[k] = -0x100000;
+  }
+
+  size_t num_children = children.get_num_children();
+  _entries.clear();
+  _entries.resize(num_children);
+  for (size_t i = 0; i < num_children; ++i) {
+    const DownConnection &child = children.get_child_connection(i);
+    ChildEntry &entry = _entries[i];
+    entry._child = child.get_child();
+    entry._bounds = child.get_bounds();
+    entry._placement = ChildEntry::P_none;
+    insert_child((int)i);
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "Rebuilt grid for " << *this << ": " << _cells.get_num_entries()
+      << " cells, " << _always.size() << " of " << num_children
+      << " children always visited\n";
+  }
+}
+
+/**
+ * Adds the indicated child to the cells covered by its bounding volume.
+ * Assumes the lock is held.
+ */
+void CollisionBroadphase::
+insert_child(int index) const {
+  ChildEntry &entry = _entries[index];
+  const GeometricBoundingVolume *bounds = entry._bounds;
+
+  if (bounds != nullptr && bounds->is_empty()) {
+    // This can't collide with anything.
+    entry._placement = ChildEntry::P_none;
+    return;
+  }
+
+  CellRange &range = entry._range;
+  uint64_t count = 0;
+  if (bounds != nullptr && get_range(range, bounds, 0)) {
+    count = 1;
+    for (int k = 0; k < 3; ++k) {
+      count *= (uint64_t)(range._max[k] - range._min[k] + 1);
+    }
+  }
+
+  if (count == 0 || count > (uint64_t)max_child_cells) {
+    entry._placement = ChildEntry::P_always;
+    _always.push_back(index);
+    return;
+  }
+
+  entry._placement = ChildEntry::P_grid;
+  for (int z = range._min[2]; z <= range._max[2]; ++z) {
+    for (int y = range._min[1]; y <= range._max[1]; ++y) {
+      for (int x = range._min[0]; x <= range._max[0]; ++x) {
+        _cells[make_key(x, y, z)].push_back(index);
+      }
+    }
+  }
+  for (int k = 0; k < 3; ++k) {
+    _occupied._min[k] = std::min(_occupied._min[k], range._min[k]);
+    _occupied._max[k] = std::max(_occupied._max[k], range._max[k]);
+  }
+}
+
+/**
+ * Removes the indicated child from the cells it was added to.  Assumes the
+ * lock is held.
+ */
+void CollisionBroadphase::
+remove_child(int index) const {
+  ChildEntry &entry = _entries[index];
+
+  if (entry._placement == ChildEntry::P_always) {
+    Indices::iterator it = std::find(_always.begin(), _always.end(), index);
+    nassertv(it != _always.end());
+    *it = _always.back();
+    _always.pop_back();
+
+  } else if (entry._placement == ChildEntry::P_grid) {
+    const CellRange &range = entry._range;
+    for (int z = range._min[2]; z <= range._max[2]; ++z) {
+      for (int y = range._min[1]; y <= range._max[1]; ++y) {
+        for (int x = range._min[0]; x <= range._max[0]; ++x) {
+          uint64_t key = make_key(x, y, z);
+          int n = _cells.find(key);
+          nassertd(n != -1) continue;
+
+          Indices &cell = _cells.modify_data(n);
+          Indices::iterator it = std::find(cell.begin(), cell.end(), index);
+          nassertd(it != cell.end()) continue;
+          *it = cell.back();
+          cell.pop_back();
+          if (cell.empty()) {
+            _cells.remove(key);
+          }
+        }
+      }
+    }
+  }
+
+  // The occupied range is only ever grown until the next rebuild, which is
+  // fine, since it is only used to limit the search.
+  entry._placement = ChildEntry::P_none;
+}
+
+/**
+ * Tells the BamReader how to create objects of type CollisionBroadphase.
+ */
+void CollisionBroadphase::
+register_with_read_factory() {
+  BamReader::get_factory()->register_factory(get_class_type(), make_from_bam);
+}
+
+/**
+ * Writes the contents of this object to the datagram for shipping out to a
+ * Bam file.
+ */
+void CollisionBroadphase::
+write_datagram(BamWriter *manager, Datagram &dg) {
+  PandaNode::write_datagram(manager, dg);
+  dg.add_stdfloat(_cell_size);
+}
+
+/**
+ * This function is called by the BamReader's factory when a new object of
+ * type CollisionBroadphase is encountered in the Bam file.  It should create
+ * the CollisionBroadphase and extract its information from the file.
+ */
+TypedWritable *CollisionBroadphase::
+make_from_bam(const FactoryParams &params) {
+  CollisionBroadphase *node = new CollisionBroadphase("");
+  DatagramIterator scan;
+  BamReader *manager;
+
+  parse_params(params, scan, manager);
+  node->fillin(scan, manager);
+
+  return node;
+}
+
+/**
+ * This internal function is called by make_from_bam to read in all of the
+ * relevant data from the BamFile for the new CollisionBroadphase.
+ */
+void CollisionBroadphase::
+fillin(DatagramIterator &scan, BamReader *manager) {
+  PandaNode::fillin(scan, manager);
+  PN_stdfloat cell_size = scan.get_stdfloat();
+  if (cell_size > 0) {
+    set_cell_size(cell_size);
+  }
+}
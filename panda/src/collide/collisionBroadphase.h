@@ -0,0 +1,169 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionBroadphase.h
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#ifndef COLLISIONBROADPHASE_H
+#define COLLISIONBROADPHASE_H
+
+#include "pandabase.h"
+
+#include "pandaNode.h"
+#include "geometricBoundingVolume.h"
+#include "simpleHashMap.h"
+#include "updateSeq.h"
+#include "lightMutex.h"
+#include "pStatCollector.h"
+#include "pvector.h"
+#include "patomic.h"
+
+/**
+ * A node that keeps its children in a uniform grid, by their bounding
+ * volumes, so that the CollisionTraverser only needs to visit the children
+ * that are near one of its colliders.  Parent many small "into" objects to one
+ * of these, e.g.  the pickup items, triggers or hitboxes spread across a
+ * level, instead of a plain PandaNode; it is otherwise the same as a
+ * PandaNode, and has no effect on rendering.
+ *
+ * The grid is updated lazily when it is next traversed.  Only the children
+ * whose bounding volumes have changed since then are moved to their new
+ * cells, so it is fine for the children to move around every frame.  Adding
+ * or removing children rebuilds the whole grid.
+ *
+ * The cell size should be about the size of the typical child, or a little
+ * larger.  Children that are too large to fit in a few cells are always
+ * visited, as are the children with an infinite bounding volume.
+ */
+class EXPCL_PANDA_COLLIDE CollisionBroadphase : public PandaNode {
+PUBLISHED:
+  explicit CollisionBroadphase(const std::string &name);
+  explicit CollisionBroadphase(const std::string &name, PN_stdfloat cell_size);
+
+protected:
+  CollisionBroadphase(const CollisionBroadphase &copy);
+
+public:
+  virtual PandaNode *make_copy() const;
+
+PUBLISHED:
+  void set_cell_size(PN_stdfloat cell_size);
+  INLINE PN_stdfloat get_cell_size() const;
+  MAKE_PROPERTY(cell_size, get_cell_size, set_cell_size);
+
+  size_t get_num_cells() const;
+
+public:
+  typedef pvector<int> Indices;
+
+  bool find_children(Indices &result,
+                     const GeometricBoundingVolume *const *bounds,
+                     size_t num_bounds,
+                     Thread *current_thread = Thread::get_current_thread()) const;
+
+  virtual void output(std::ostream &out) const;
+
+protected:
+  virtual void children_changed();
+
+private:
+  // The range of cells covered by a bounding volume, inclusive.
+  class CellRange {
+  public:
+    int _min[3];
+    int _max[3];
+  };
+
+  // The key of a cell in the grid, with the three indices packed into 21
+  // bits each.
+  class CellHash {
+  public:
+    INLINE size_t operator () (const uint64_t &key) const;
+    INLINE bool operator () (const uint64_t &a, const uint64_t &b) const;
+    INLINE bool is_equal(const uint64_t &a, const uint64_t &b) const;
+  };
+
+  // What we remember about each child, to find out whether it has moved.
+  class ChildEntry {
+  public:
+    PandaNode *_child;
+    CPT(GeometricBoundingVolume) _bounds;
+    CellRange _range;
+
+    enum Placement {
+      P_none,
+      P_grid,
+      P_always,
+    };
+    Placement _placement;
+  };
+
+  INLINE static uint64_t make_key(int x, int y, int z);
+  INLINE int get_cell(PN_stdfloat v) const;
+  bool get_range(CellRange &range, const GeometricBoundingVolume *bounds,
+                 PN_stdfloat pad) const;
+
+  void update(Thread *current_thread) const;
+  void rebuild(const Children &children) const;
+  void insert_child(int index) const;
+  void remove_child(int index) const;
+
+  PN_stdfloat _cell_size;
+  PN_stdfloat _inv_cell_size;
+
+  // The grid is a cache of the children's bounding volumes, so it is built
+  // on demand by the traverser, which may be running in several threads.
+  typedef pvector<ChildEntry> ChildEntries;
+  typedef SimpleHashMap<uint64_t, Indices, CellHash> Cells;
+
+  mutable LightMutex _lock;
+  mutable ChildEntries _entries;
+  mutable Cells _cells;
+  mutable Indices _always;
+  mutable CellRange _occupied;
+  mutable UpdateSeq _last_seq;
+
+  // This is set without the lock held, by children_changed(), which may be
+  // called while the scene graph is locked.
+  mutable patomic<bool> _stale;
+
+  static const int max_child_cells = 64;
+
+  static PStatCollector _update_pcollector;
+
+public:
+  static void register_with_read_factory();
+  virtual void write_datagram(BamWriter *manager, Datagram &dg);
+
+protected:
+  static TypedWritable *make_from_bam(const FactoryParams &params);
+  void fillin(DatagramIterator &scan, BamReader *manager);
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    PandaNode::init_type();
+    register_type(_type_handle, "CollisionBroadphase",
+                  PandaNode::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "collisionBroadphase.I"
+
+#endif
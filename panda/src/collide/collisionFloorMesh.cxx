@@ -32,7 +32,9 @@
 #include "geomTriangles.h"
 #include "geomLinestrips.h"
 #include "geomVertexWriter.h"
+#include "lightMutexHolder.h"
 #include <algorithm>
+#include <limits>
 
 using std::max;
 using std::min;
@@ -61,16 +63,10 @@ xform(const LMatrix4 &mat) {
   }
   Triangles::iterator ti;
   for (ti=_triangles.begin();ti!=_triangles.end();++ti) {
-    CollisionFloorMesh::TriangleIndices tri = *ti;
-    LPoint3 v1 = _vertices[tri.p1];
-    LPoint3 v2 = _vertices[tri.p2];
-    LPoint3 v3 = _vertices[tri.p3];
-
-    tri.min_x=min(min(v1[0],v2[0]),v3[0]);
-    tri.max_x=max(max(v1[0],v2[0]),v3[0]);
-    tri.min_y=min(min(v1[1],v2[1]),v3[1]);
-    tri.max_y=max(max(v1[1],v2[1]),v3[1]);
+    CollisionFloorMesh::TriangleIndices &tri = *ti;
+    compute_bounds(tri, _vertices[tri.p1], _vertices[tri.p2], _vertices[tri.p3]);
   }
+  mark_bvh_stale();
   CollisionSolid::xform(mat);
 }
 
@@ -135,9 +131,10 @@ test_intersection_from_ray(const CollisionEntry &entry) const {
   double fx = from_origin[0];
   double fy = from_origin[1];
 
-  CollisionFloorMesh::Triangles::const_iterator ti;
-  for (ti = _triangles.begin(); ti < _triangles.end(); ++ti) {
-    TriangleIndices tri = *ti;
+  CollisionBVH::Indices candidates;
+  find_triangles(fx, fy, candidates);
+  for (uint32_t ti : candidates) {
+    const TriangleIndices &tri = _triangles[ti];
     // First do a naive bounding box check on the triangle
     if (fx < tri.min_x || fx >= tri.max_x || fy < tri.min_y || fy >= tri.max_y) {
       continue;
@@ -202,9 +199,10 @@ test_intersection_from_sphere(const CollisionEntry &entry) const {
 
   PN_stdfloat  fz = PN_stdfloat(from_origin[2]);
   PN_stdfloat rad = sphere->get_radius();
-  CollisionFloorMesh::Triangles::const_iterator ti;
-  for (ti = _triangles.begin(); ti < _triangles.end(); ++ti) {
-    TriangleIndices tri = *ti;
+  CollisionBVH::Indices candidates;
+  find_triangles(fx, fy, candidates);
+  for (uint32_t ti : candidates) {
+    const TriangleIndices &tri = _triangles[ti];
     // First do a naive bounding box check on the triangle
     if (fx < tri.min_x || fx >= tri.max_x || fy < tri.min_y || fy >= tri.max_y) {
       continue;
@@ -349,6 +347,16 @@ write_datagram(BamWriter *manager, Datagram &me)
     me.add_stdfloat(_triangles[i].max_y);
 
   }
+
+  if (manager->get_file_minor_ver() >= 47) {
+    const CollisionBVH *bvh = get_bvh();
+    if (bvh != nullptr) {
+      me.add_bool(true);
+      bvh->write_datagram(me);
+    } else {
+      me.add_bool(false);
+    }
+  }
 }
 
 /**
@@ -381,6 +389,19 @@ fillin(DatagramIterator& scan, BamReader* manager)
     tri.max_y=scan.get_stdfloat();
     _triangles.push_back(tri);
   }
+
+  if (manager->get_file_minor_ver() >= 47) {
+    if (scan.get_bool()) {
+      if (_bvh.fillin(scan, _triangles.size())) {
+        _bvh_stale = false;
+      } else {
+        collide_cat.error()
+          << "Ignoring invalid triangle hierarchy for CollisionFloorMesh, "
+          << "is the bam file corrupt?\n";
+        _bvh_stale = true;
+      }
+    }
+  }
 }
 
 /**
@@ -422,14 +443,72 @@ add_triangle(unsigned int pointA, unsigned int pointB, unsigned int pointC) {
   tri.p1 = pointA;
   tri.p2 = pointB;
   tri.p3 = pointC;
-  LPoint3 v1 = _vertices[pointA];
-  LPoint3 v2 = _vertices[pointB];
-  LPoint3 v3 = _vertices[pointC];
+  compute_bounds(tri, _vertices[pointA], _vertices[pointB], _vertices[pointC]);
 
+  _triangles.push_back(tri);
+  mark_bvh_stale();
+}
+
+/**
+ * Returns the hierarchy over the triangles, which is used to quickly find the
+ * triangles under a point.  The hierarchy is built the first time this is
+ * called after the triangles have changed.  Returns NULL if there are too few
+ * triangles for this to be worthwhile; see collision-bvh-min-solids.
+ */
+const CollisionBVH *CollisionFloorMesh::
+get_bvh() const {
+  int min_triangles = collision_bvh_min_solids;
+  if (min_triangles <= 0 || _triangles.size() < (size_t)min_triangles) {
+    return nullptr;
+  }
+
+  LightMutexHolder holder(_bvh_lock);
+  if (_bvh_stale || _bvh.get_num_items() != _triangles.size()) {
+    size_t num_triangles = _triangles.size();
+    _bvh.begin_build(num_triangles);
+    for (size_t i = 0; i < num_triangles; ++i) {
+      const TriangleIndices &tri = _triangles[i];
+      const LPoint3 &v1 = _vertices[tri.p1];
+      const LPoint3 &v2 = _vertices[tri.p2];
+      const LPoint3 &v3 = _vertices[tri.p3];
+      _bvh.set_item(i, LPoint3(tri.min_x, tri.min_y, min(min(v1[2], v2[2]), v3[2])),
+                       LPoint3(tri.max_x, tri.max_y, max(max(v1[2], v2[2]), v3[2])));
+    }
+    _bvh.end_build();
+    _bvh_stale = false;
+  }
+  return &_bvh;
+}
+
+/**
+ * Fills result with the indices of the triangles whose bounding rectangle
+ * might contain the indicated point, in ascending order.  If there is no
+ * hierarchy, this is simply all of the triangles.
+ */
+void CollisionFloorMesh::
+find_triangles(double fx, double fy, CollisionBVH::Indices &result) const {
+  const CollisionBVH *bvh = get_bvh();
+  if (bvh != nullptr) {
+    PN_stdfloat inf = std::numeric_limits<PN_stdfloat>::infinity();
+    bvh->find_overlaps(LPoint3(fx, fy, -inf), LPoint3(fx, fy, inf), result);
+  } else {
+    size_t num_triangles = _triangles.size();
+    result.reserve(num_triangles);
+    for (size_t i = 0; i < num_triangles; ++i) {
+      result.push_back((uint32_t)i);
+    }
+  }
+}
+
+/**
+ * Stores the bounding rectangle of the triangle with the indicated vertices
+ * on the triangle.
+ */
+void CollisionFloorMesh::
+compute_bounds(TriangleIndices &tri, const LPoint3 &v1,
+               const LPoint3 &v2, const LPoint3 &v3) {
   tri.min_x=min(min(v1[0],v2[0]),v3[0]);
   tri.max_x=max(max(v1[0],v2[0]),v3[0]);
   tri.min_y=min(min(v1[1],v2[1]),v3[1]);
   tri.max_y=max(max(v1[1],v2[1]),v3[1]);
-
-  _triangles.push_back(tri);
 }
@@ -17,6 +17,9 @@
 #include "pandabase.h"
 
 #include "collisionPlane.h"
+#include "collisionBVH.h"
+#include "lightMutex.h"
+#include "lightMutexHolder.h"
 #include "clipPlaneAttrib.h"
 #include "look_at.h"
 #include "pvector.h"
@@ -85,12 +88,24 @@ protected:
   virtual void fill_viz_geom();
 
 private:
+  INLINE void mark_bvh_stale();
+  const CollisionBVH *get_bvh() const;
+  void find_triangles(double fx, double fy, CollisionBVH::Indices &result) const;
+  static void compute_bounds(TriangleIndices &tri, const LPoint3 &v1,
+                             const LPoint3 &v2, const LPoint3 &v3);
+
   typedef pvector<LPoint3> Vertices;
   typedef pvector<TriangleIndices> Triangles;
 
   Vertices _vertices;
   Triangles _triangles;
 
+  // A hierarchy over the triangles, built on demand if there are enough
+  // triangles.
+  mutable LightMutex _bvh_lock;
+  mutable CollisionBVH _bvh;
+  mutable bool _bvh_stale = true;
+
   static PStatCollector _volume_pcollector;
   static PStatCollector _test_pcollector;
 
@@ -76,6 +76,8 @@ public:
   INLINE void set_include_mask(CollideMask include_mask);
   INLINE CollideMask get_include_mask() const;
 
+  INLINE void set_node_volume_level(int *level);
+
 protected:
   WorkingNodePath _node_path;
 
@@ -89,6 +91,13 @@ protected:
   BoundingVolumes _local_bounds;
   BoundingVolumes _parent_bounds;
 
+  // If this is not NULL, the bounding volume tests are counted here instead
+  // of in _node_volume_pcollector, which may not be touched by the worker
+  // threads of a parallel traversal.
+  int *_node_volume_level = nullptr;
+
+  INLINE void count_node_volume() const;
+
   static PStatCollector _node_volume_pcollector;
 
 public:
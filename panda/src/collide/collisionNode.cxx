@@ -29,6 +29,7 @@
 #include "boundingSphere.h"
 #include "boundingBox.h"
 #include "config_mathutil.h"
+#include "lightMutexHolder.h"
 
 TypeHandle CollisionNode::_type_handle;
 
@@ -41,6 +42,7 @@ CollisionNode(const std::string &name) :
   PandaNode(name),
   _from_collide_mask(get_default_collide_mask()),
   _collider_sort(0),
+  _cache_lock("CollisionNode::_cache_lock"),
   _owner(nullptr),
   _owner_callback(nullptr)
 {
@@ -63,9 +65,15 @@ CollisionNode(const CollisionNode &copy) :
   _from_collide_mask(copy._from_collide_mask),
   _collider_sort(copy._collider_sort),
   _solids(copy._solids),
+  _cache_lock("CollisionNode::_cache_lock"),
   _owner(nullptr),
   _owner_callback(nullptr)
 {
+  LightMutexHolder holder(copy._cache_lock);
+  _bvh = copy._bvh;
+  _bvh_stale = copy._bvh_stale;
+  _polygon_batch = copy._polygon_batch;
+  _polygon_batch_stale = copy._polygon_batch_stale;
 }
 
 /**
@@ -116,6 +124,7 @@ xform(const LMatrix4 &mat) {
     solid->xform(mat);
   }
   mark_internal_bounds_stale();
+  mark_caches_stale();
 }
 
 /**
@@ -144,6 +153,7 @@ combine_with(PandaNode *other) {
         const COWPT(CollisionSolid) *solids_end = solids_begin + cother->_solids.size();
         _solids.insert(_solids.end(), solids_begin, solids_end);
         mark_internal_bounds_stale();
+        mark_caches_stale();
         return this;
       }
 
@@ -326,6 +336,76 @@ compute_internal_bounds(CPT(BoundingVolume) &internal_bounds,
   internal_vertices = 0;
 }
 
+/**
+ * Returns the hierarchy over the bounding volumes of the solids, which the
+ * CollisionTraverser uses to find the solids that a collider might intersect
+ * without testing each solid's bounding volume in turn.  The hierarchy is
+ * built the first time this is called after the solids have changed.
+ *
+ * Returns NULL if there are too few solids for this to be worthwhile; see
+ * collision-bvh-min-solids.
+ *
+ * Note that the hierarchy only notices changes made through the methods on
+ * this node, such as modify_solid().  This is also true of the node's own
+ * bounding volume.
+ */
+const CollisionBVH *CollisionNode::
+get_bvh() const {
+  int min_solids = collision_bvh_min_solids;
+  if (min_solids <= 0 || _solids.size() < (size_t)min_solids) {
+    return nullptr;
+  }
+
+  LightMutexHolder holder(_cache_lock);
+  if (_bvh_stale || _bvh.get_num_items() != _solids.size()) {
+    build_bvh();
+  }
+  return &_bvh;
+}
+
+/**
+ * Rebuilds the hierarchy over the solids.  Assumes the lock is held.
+ */
+void CollisionNode::
+build_bvh() const {
+  size_t num_solids = _solids.size();
+  _bvh.begin_build(num_solids);
+  for (size_t i = 0; i < num_solids; ++i) {
+    CPT(CollisionSolid) solid = _solids[i].get_read_pointer();
+    CPT(BoundingVolume) bounds = solid->get_bounds();
+    _bvh.set_item(i, bounds);
+  }
+  _bvh.end_build();
+  _bvh_stale = false;
+}
+
+/**
+ * Returns a packed copy of the polygons among the solids, which the
+ * CollisionTraverser uses to test a ray, segment or sphere against several
+ * polygons at once.  It is built the first time this is called after the
+ * solids have changed.
+ *
+ * Returns NULL if there are too few polygons for this to be worthwhile; see
+ * collision-batch-min-polygons.
+ */
+const CollisionPolygonBatch *CollisionNode::
+get_polygon_batch() const {
+  int min_polygons = collision_batch_min_polygons;
+  if (min_polygons <= 0 || _solids.size() < (size_t)min_polygons) {
+    return nullptr;
+  }
+
+  LightMutexHolder holder(_cache_lock);
+  if (_polygon_batch_stale || _polygon_batch.get_num_solids() != _solids.size()) {
+    _polygon_batch.clear();
+    for (const COWPT(CollisionSolid) &solid : _solids) {
+      _polygon_batch.add_solid(solid.get_read_pointer());
+    }
+    _polygon_batch_stale = false;
+  }
+  return &_polygon_batch;
+}
+
 /**
  * Returns a RenderState for rendering the ghosted collision solid that
  * represents the previous frame's position, for those collision nodes that
@@ -374,6 +454,18 @@ write_datagram(BamWriter *manager, Datagram &dg) {
   }
 
   dg.add_uint32(_from_collide_mask.get_word());
+
+  if (manager->get_file_minor_ver() >= 47) {
+    // Write the hierarchy as well, if there is one, so that it need not be
+    // rebuilt when the node is loaded.
+    const CollisionBVH *bvh = get_bvh();
+    if (bvh != nullptr) {
+      dg.add_bool(true);
+      bvh->write_datagram(dg);
+    } else {
+      dg.add_bool(false);
+    }
+  }
 }
 
 /**
@@ -430,4 +522,17 @@ fillin(DatagramIterator &scan, BamReader *manager) {
   }
 
   _from_collide_mask.set_word(scan.get_uint32());
+
+  if (manager->get_file_minor_ver() >= 47) {
+    if (scan.get_bool()) {
+      if (_bvh.fillin(scan, (size_t)num_solids)) {
+        _bvh_stale = false;
+      } else {
+        collide_cat.error()
+          << "Ignoring invalid collision hierarchy for " << get_name()
+          << ", is the bam file corrupt?\n";
+        _bvh_stale = true;
+      }
+    }
+  }
 }
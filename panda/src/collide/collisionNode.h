@@ -17,6 +17,8 @@
 #include "pandabase.h"
 
 #include "collisionSolid.h"
+#include "collisionBVH.h"
+#include "collisionPolygonBatch.h"
 
 #include "collideMask.h"
 #include "pandaNode.h"
@@ -102,6 +104,11 @@ protected:
 private:
   CPT(RenderState) get_last_pos_state();
 
+  INLINE void mark_caches_stale();
+  const CollisionBVH *get_bvh() const;
+  void build_bvh() const;
+  const CollisionPolygonBatch *get_polygon_batch() const;
+
   // This data is not cycled, for now.  We assume the collision traversal will
   // take place in App only.  Perhaps we will revisit this later.
   CollideMask _from_collide_mask;
@@ -110,6 +117,17 @@ private:
   typedef pvector< COWPT(CollisionSolid) > Solids;
   Solids _solids;
 
+  // A hierarchy over the bounding volumes of the solids, built on demand if
+  // there are enough solids.  See get_bvh().
+  mutable LightMutex _cache_lock;
+  mutable CollisionBVH _bvh;
+  mutable bool _bvh_stale = true;
+
+  // A packed copy of the polygons, for testing many of them at once.  See
+  // get_polygon_batch().
+  mutable CollisionPolygonBatch _polygon_batch;
+  mutable bool _polygon_batch_stale = true;
+
   void *_owner = nullptr;
   OwnerCallback *_owner_callback = nullptr;
 
@@ -150,6 +150,8 @@ private:
   static PStatCollector _volume_pcollector;
   static PStatCollector _test_pcollector;
 
+  friend class CollisionPolygonBatch;
+
 public:
   static void register_with_read_factory();
   virtual void write_datagram(BamWriter* manager, Datagram &me);
@@ -0,0 +1,382 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionPolygonBatch.cxx
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#include "collisionPolygonBatch.h"
+#include "collisionPolygon.h"
+#include "collisionSphere.h"
+#include "collisionRay.h"
+#include "collisionSegment.h"
+#include "collisionEntry.h"
+
+#include <string.h>
+#include <limits>
+
+#if defined(__SSE__) || (_M_IX86_FP >= 1) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define COLLISION_BATCH_SSE 1
+#endif
+
+using std::max;
+
+/**
+ * Removes all solids from the batch.
+ */
+void CollisionPolygonBatch::
+clear() {
+  _blocks.clear();
+  _edges.clear();
+  _num_solids = 0;
+}
+
+/**
+ * Adds the indicated solid to the end of the batch.  If it is a
+ * CollisionPolygon, its data is copied into the batch; any other solid always
+ * passes the tests.
+ */
+void CollisionPolygonBatch::
+add_solid(const CollisionSolid *solid) {
+  if (solid->is_exact_type(CollisionPolygon::get_class_type())) {
+    add_polygon((const CollisionPolygon *)solid);
+  } else {
+    add_passthrough();
+  }
+}
+
+/**
+ * Prepares the query for testing the "from" solid of the indicated entry
+ * against the polygons, which are assumed to be in the space of the "into"
+ * node.  Returns false if the solid is not of a type that can be tested in
+ * batches, in which case every solid should be tested normally.
+ */
+bool CollisionPolygonBatch::
+setup_query(Query &query, const CollisionEntry &entry) {
+  const CollisionSolid *from = entry.get_from();
+  TypeHandle type = from->get_type();
+
+  LPoint3 origin;
+  LVector3 direction = LVector3::zero();
+  PN_stdfloat radius = 0.0f;
+
+  query._sphere = false;
+  query._t_min = 0.0f;
+  query._t_max = std::numeric_limits<float>::infinity();
+
+  if (type == CollisionRay::get_class_type()) {
+    const CollisionRay *ray = (const CollisionRay *)from;
+    const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+    origin = ray->get_origin() * wrt_mat;
+    direction = ray->get_direction() * wrt_mat;
+
+  } else if (type == CollisionSegment::get_class_type()) {
+    const CollisionSegment *segment = (const CollisionSegment *)from;
+    const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+    origin = segment->get_point_a() * wrt_mat;
+    direction = segment->get_point_b() * wrt_mat - origin;
+    query._t_max = 1.0f;
+
+  } else if (type == CollisionSphere::get_class_type()) {
+    // A sphere that has moved since the last frame is tested somewhere along
+    // its path, rather than at its current position.  Leave that to the full
+    // test.
+    CPT(TransformState) wrt_space = entry.get_wrt_space();
+    if (entry.get_wrt_prev_space() != wrt_space) {
+      return false;
+    }
+
+    const CollisionSphere *sphere = (const CollisionSphere *)from;
+    const LMatrix4 &wrt_mat = wrt_space->get_mat();
+    origin = sphere->get_center() * wrt_mat;
+    radius = (LVector3(sphere->get_radius(), 0.0f, 0.0f) * wrt_mat).length();
+    query._sphere = true;
+
+  } else {
+    return false;
+  }
+
+  PN_stdfloat origin_extent = max(max(cabs(origin[0]), cabs(origin[1])), cabs(origin[2]));
+  PN_stdfloat direction_extent = max(max(cabs(direction[0]), cabs(direction[1])), cabs(direction[2]));
+  for (int i = 0; i < 3; ++i) {
+    query._origin[i] = (float)origin[i];
+    query._direction[i] = (float)direction[i];
+  }
+  query._radius = (float)radius;
+  query._direction_extent = (float)direction_extent;
+  query._origin_tol = (float)((origin_extent + radius) * 1.0e-5f);
+  query._direction_tol = (float)(direction_extent * 1.0e-5f);
+  return true;
+}
+
+/**
+ * Adds the indicated polygon to the end of the batch.
+ */
+void CollisionPolygonBatch::
+add_polygon(const CollisionPolygon *polygon) {
+  const CollisionPolygon::Points &points = polygon->_points;
+  if (points.size() < 3) {
+    // The full test rejects these right away.
+    add_passthrough();
+    return;
+  }
+
+  size_t lane = _num_solids % block_size;
+  if (lane == 0) {
+    Block block;
+    memset(&block, 0, sizeof(Block));
+    block._first_edge = (uint32_t)_edges.size();
+    _blocks.push_back(block);
+  }
+  Block &block = _blocks.back();
+  ++_num_solids;
+
+  LPlane plane = polygon->get_plane();
+  block._nx[lane] = (float)plane[0];
+  block._ny[lane] = (float)plane[1];
+  block._nz[lane] = (float)plane[2];
+  block._nd[lane] = (float)plane[3];
+
+  // CollisionPolygon::to_2d() takes the x and z of the transformed point.
+  const LMatrix4 &to_2d_mat = polygon->_to_2d_mat;
+  block._ux[lane] = (float)to_2d_mat(0, 0);
+  block._uy[lane] = (float)to_2d_mat(1, 0);
+  block._uz[lane] = (float)to_2d_mat(2, 0);
+  block._uw[lane] = (float)to_2d_mat(3, 0);
+  block._vx[lane] = (float)to_2d_mat(0, 2);
+  block._vy[lane] = (float)to_2d_mat(1, 2);
+  block._vz[lane] = (float)to_2d_mat(2, 2);
+  block._vw[lane] = (float)to_2d_mat(3, 2);
+
+  size_t num_points = points.size();
+  PN_stdfloat extent = cabs(plane[3]);
+  PN_stdfloat area = 0.0f;
+  for (size_t i = 0; i < num_points; ++i) {
+    const LPoint2 &p = points[i]._p;
+    const LPoint2 &q = points[(i + 1) % num_points]._p;
+    extent = max(extent, max(cabs(p[0]), cabs(p[1])));
+    area += p[0] * q[1] - q[0] * p[1];
+  }
+  block._tol[lane] = (float)((extent + 1.0f) * 1.0e-5f);
+
+  if (area <= 0.0f || polygon->is_concave()) {
+    // The edge tests below only work for a convex polygon that winds the
+    // usual way around.  Let the full test deal with any other polygon.
+    return;
+  }
+
+  // Make room for this polygon's edges; the other polygons in the block get
+  // edges that every point is inside of.
+  while (block._num_edges < num_points) {
+    EdgeBlock edges;
+    for (size_t i = 0; i < block_size; ++i) {
+      edges._a[i] = 0.0f;
+      edges._b[i] = 0.0f;
+      edges._c[i] = -1.0f;
+    }
+    _edges.push_back(edges);
+    ++block._num_edges;
+  }
+
+  EdgeBlock *edges = &_edges[block._first_edge];
+  for (size_t i = 0; i < num_points; ++i) {
+    // This is the same as CollisionPolygon::is_right(), with the distance
+    // scaled to the length of the edge, and the threshold folded into c.
+    const LPoint2 &p = points[i]._p;
+    LVector2 e = points[(i + 1) % num_points]._p - p;
+    PN_stdfloat length = e.length();
+    if (length == 0.0f) {
+      continue;
+    }
+    edges[i]._a[lane] = (float)(e[1] / length);
+    edges[i]._b[lane] = (float)(-e[0] / length);
+    edges[i]._c[lane] = (float)((p[1] * e[0] - p[0] * e[1] - 1.0e-6f) / length);
+  }
+}
+
+/**
+ * Adds a solid that always passes the tests.
+ */
+void CollisionPolygonBatch::
+add_passthrough() {
+  size_t lane = _num_solids % block_size;
+  if (lane == 0) {
+    Block block;
+    memset(&block, 0, sizeof(Block));
+    block._first_edge = (uint32_t)_edges.size();
+    _blocks.push_back(block);
+  }
+  _blocks.back()._passthrough |= (1 << lane);
+  ++_num_solids;
+}
+
+/**
+ * Tests a ray or segment against the nth block.  This follows
+ * CollisionPolygon::test_intersection_from_ray() and _from_segment().
+ */
+int CollisionPolygonBatch::
+test_line_block(size_t n, const Query &query) const {
+  const Block &block = _blocks[n];
+  const EdgeBlock *edges = _edges.data() + block._first_edge;
+
+#ifdef COLLISION_BATCH_SSE
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  __m128 ox = _mm_set1_ps(query._origin[0]);
+  __m128 oy = _mm_set1_ps(query._origin[1]);
+  __m128 oz = _mm_set1_ps(query._origin[2]);
+  __m128 dx = _mm_set1_ps(query._direction[0]);
+  __m128 dy = _mm_set1_ps(query._direction[1]);
+  __m128 dz = _mm_set1_ps(query._direction[2]);
+
+  __m128 nx = _mm_loadu_ps(block._nx);
+  __m128 ny = _mm_loadu_ps(block._ny);
+  __m128 nz = _mm_loadu_ps(block._nz);
+  __m128 nd = _mm_loadu_ps(block._nd);
+
+  // Where does the line cross the plane?  If it is nearly parallel to the
+  // plane, we can't say for sure whether the full test would find it.
+  __m128 denom = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, dx), _mm_mul_ps(ny, dy)), _mm_mul_ps(nz, dz));
+  __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, ox), _mm_mul_ps(ny, oy)), _mm_mul_ps(nz, oz)), nd);
+  __m128 abs_denom = _mm_andnot_ps(sign, denom);
+  __m128 parallel = _mm_cmple_ps(abs_denom, _mm_set1_ps(1.0e-5f + query._direction_tol));
+  __m128 t = _mm_div_ps(_mm_sub_ps(_mm_setzero_ps(), dist), denom);
+
+  __m128 tol = _mm_add_ps(_mm_loadu_ps(block._tol), _mm_set1_ps(query._origin_tol));
+  __m128 t_tol = _mm_add_ps(_mm_div_ps(tol, abs_denom), _mm_set1_ps(1.0e-6f));
+  __m128 hit = _mm_and_ps(
+    _mm_cmpge_ps(t, _mm_sub_ps(_mm_set1_ps(query._t_min), t_tol)),
+    _mm_cmple_ps(t, _mm_add_ps(_mm_set1_ps(query._t_max), t_tol)));
+
+  // Project the point on the plane into each polygon's 2-d space.
+  __m128 px = _mm_add_ps(ox, _mm_mul_ps(t, dx));
+  __m128 py = _mm_add_ps(oy, _mm_mul_ps(t, dy));
+  __m128 pz = _mm_add_ps(oz, _mm_mul_ps(t, dz));
+  __m128 x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(block._ux), px), _mm_mul_ps(_mm_loadu_ps(block._uy), py)),
+                        _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(block._uz), pz), _mm_loadu_ps(block._uw)));
+  __m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(block._vx), px), _mm_mul_ps(_mm_loadu_ps(block._vy), py)),
+                        _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(block._vz), pz), _mm_loadu_ps(block._vw)));
+
+  // An error in t moves the point along the line, which matters more the
+  // closer the line is to parallel with the plane.
+  __m128 edge_tol = _mm_add_ps(_mm_add_ps(tol, _mm_mul_ps(_mm_andnot_ps(sign, t), _mm_set1_ps(query._direction_tol))),
+                               _mm_mul_ps(t_tol, _mm_set1_ps(query._direction_extent)));
+  for (uint32_t i = 0; i < block._num_edges && _mm_movemask_ps(hit) != 0; ++i) {
+    const EdgeBlock &edge = edges[i];
+    __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(edge._a), x), _mm_mul_ps(_mm_loadu_ps(edge._b), y)), _mm_loadu_ps(edge._c));
+    hit = _mm_andnot_ps(_mm_cmpgt_ps(d, edge_tol), hit);
+  }
+
+  return _mm_movemask_ps(_mm_or_ps(hit, parallel)) | block._passthrough;
+
+#else
+  const float *o = query._origin;
+  const float *d = query._direction;
+  int result = block._passthrough;
+  for (size_t lane = 0; lane < block_size; ++lane) {
+    float denom = block._nx[lane] * d[0] + block._ny[lane] * d[1] + block._nz[lane] * d[2];
+    float dist = block._nx[lane] * o[0] + block._ny[lane] * o[1] + block._nz[lane] * o[2] + block._nd[lane];
+    float abs_denom = fabsf(denom);
+    if (abs_denom <= 1.0e-5f + query._direction_tol) {
+      result |= (1 << lane);
+      continue;
+    }
+    float t = -dist / denom;
+
+    float tol = block._tol[lane] + query._origin_tol;
+    float t_tol = tol / abs_denom + 1.0e-6f;
+    if (!(t >= query._t_min - t_tol && t <= query._t_max + t_tol)) {
+      continue;
+    }
+
+    float px = o[0] + t * d[0];
+    float py = o[1] + t * d[1];
+    float pz = o[2] + t * d[2];
+    float x = block._ux[lane] * px + block._uy[lane] * py + block._uz[lane] * pz + block._uw[lane];
+    float y = block._vx[lane] * px + block._vy[lane] * py + block._vz[lane] * pz + block._vw[lane];
+
+    float edge_tol = tol + fabsf(t) * query._direction_tol + t_tol * query._direction_extent;
+    bool inside = true;
+    for (uint32_t i = 0; i < block._num_edges && inside; ++i) {
+      const EdgeBlock &edge = edges[i];
+      inside = !(edge._a[lane] * x + edge._b[lane] * y + edge._c[lane] > edge_tol);
+    }
+    if (inside) {
+      result |= (1 << lane);
+    }
+  }
+  return result;
+#endif  // COLLISION_BATCH_SSE
+}
+
+/**
+ * Tests a sphere against the nth block.  This follows
+ * CollisionPolygon::test_intersection_from_sphere(), for a sphere that has not
+ * moved: the sphere must be within its radius of the plane, and its center
+ * must be within its radius of the inside of each edge.
+ */
+int CollisionPolygonBatch::
+test_sphere_block(size_t n, const Query &query) const {
+  const Block &block = _blocks[n];
+  const EdgeBlock *edges = _edges.data() + block._first_edge;
+
+#ifdef COLLISION_BATCH_SSE
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  __m128 cx = _mm_set1_ps(query._origin[0]);
+  __m128 cy = _mm_set1_ps(query._origin[1]);
+  __m128 cz = _mm_set1_ps(query._origin[2]);
+
+  __m128 dist = _mm_add_ps(
+    _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(block._nx), cx), _mm_mul_ps(_mm_loadu_ps(block._ny), cy)),
+    _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(block._nz), cz), _mm_loadu_ps(block._nd)));
+
+  __m128 reach = _mm_add_ps(_mm_set1_ps(query._radius + query._origin_tol), _mm_loadu_ps(block._tol));
+  __m128 hit = _mm_cmple_ps(_mm_andnot_ps(sign, dist), reach);
+
+  // Since the projection into 2-d space is rigid, and the plane maps onto the
+  // plane y = 0, the center projects to the same point as its projection onto
+  // the plane does.
+  __m128 x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(block._ux), cx), _mm_mul_ps(_mm_loadu_ps(block._uy), cy)),
+                        _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(block._uz), cz), _mm_loadu_ps(block._uw)));
+  __m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(block._vx), cx), _mm_mul_ps(_mm_loadu_ps(block._vy), cy)),
+                        _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(block._vz), cz), _mm_loadu_ps(block._vw)));
+
+  for (uint32_t i = 0; i < block._num_edges && _mm_movemask_ps(hit) != 0; ++i) {
+    const EdgeBlock &edge = edges[i];
+    __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(edge._a), x), _mm_mul_ps(_mm_loadu_ps(edge._b), y)), _mm_loadu_ps(edge._c));
+    hit = _mm_andnot_ps(_mm_cmpgt_ps(d, reach), hit);
+  }
+
+  return _mm_movemask_ps(hit) | block._passthrough;
+
+#else
+  const float *c = query._origin;
+  int result = block._passthrough;
+  for (size_t lane = 0; lane < block_size; ++lane) {
+    float dist = block._nx[lane] * c[0] + block._ny[lane] * c[1] + block._nz[lane] * c[2] + block._nd[lane];
+    float reach = query._radius + query._origin_tol + block._tol[lane];
+    if (!(fabsf(dist) <= reach)) {
+      continue;
+    }
+
+    float x = block._ux[lane] * c[0] + block._uy[lane] * c[1] + block._uz[lane] * c[2] + block._uw[lane];
+    float y = block._vx[lane] * c[0] + block._vy[lane] * c[1] + block._vz[lane] * c[2] + block._vw[lane];
+
+    bool inside = true;
+    for (uint32_t i = 0; i < block._num_edges && inside; ++i) {
+      const EdgeBlock &edge = edges[i];
+      inside = !(edge._a[lane] * x + edge._b[lane] * y + edge._c[lane] > reach);
+    }
+    if (inside) {
+      result |= (1 << lane);
+    }
+  }
+  return result;
+#endif  // COLLISION_BATCH_SSE
+}
@@ -0,0 +1,124 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionPolygonBatch.h
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#ifndef COLLISIONPOLYGONBATCH_H
+#define COLLISIONPOLYGONBATCH_H
+
+#include "pandabase.h"
+#include "luse.h"
+#include "pvector.h"
+
+class CollisionSolid;
+class CollisionPolygon;
+class CollisionEntry;
+
+/**
+ * A packed copy of the CollisionPolygons in a CollisionNode, stored in blocks
+ * of four, so that a ray, segment or sphere can be tested against four
+ * polygons at once with SIMD instructions.  This is used internally by the
+ * CollisionTraverser when a node holds many polygons.
+ *
+ * Each polygon is stored as its plane, the projection into its 2-d space, and
+ * the lines through its edges in that space.  The tests are conservative: they
+ * are done in single precision, with some margin, and only rule out the
+ * polygons that the full test in CollisionPolygon would reject anyway.  The
+ * polygons that pass are then tested normally, so that the results are
+ * exactly the same.  Solids that are not polygons always pass.
+ */
+class EXPCL_PANDA_COLLIDE CollisionPolygonBatch {
+public:
+  static const size_t block_size = 4;
+
+  /**
+   * The "from" solid of a test, transformed into the space of the polygons,
+   * as prepared by setup_query().
+   */
+  class Query {
+  public:
+    bool _sphere;
+    float _origin[3];
+    float _direction[3];
+    float _t_min;
+    float _t_max;
+    float _radius;
+    float _direction_extent;
+    float _origin_tol;
+    float _direction_tol;
+  };
+
+  INLINE CollisionPolygonBatch();
+
+  INLINE size_t get_num_solids() const;
+  INLINE size_t get_num_blocks() const;
+
+  void clear();
+  void add_solid(const CollisionSolid *solid);
+
+  static bool setup_query(Query &query, const CollisionEntry &entry);
+  INLINE int test_block(size_t n, const Query &query) const;
+
+private:
+  void add_polygon(const CollisionPolygon *polygon);
+  void add_passthrough();
+
+  int test_line_block(size_t n, const Query &query) const;
+  int test_sphere_block(size_t n, const Query &query) const;
+
+  // The lines through the edges of the polygons in one block, in the 2-d
+  // space of each polygon.  A point is outside of an edge if
+  // _a * x + _b * y + _c > 0.
+  class EdgeBlock {
+  public:
+    float _a[block_size];
+    float _b[block_size];
+    float _c[block_size];
+  };
+
+  class Block {
+  public:
+    // The plane of each polygon.
+    float _nx[block_size];
+    float _ny[block_size];
+    float _nz[block_size];
+    float _nd[block_size];
+
+    // The projection of a point into the 2-d space of each polygon.
+    float _ux[block_size];
+    float _uy[block_size];
+    float _uz[block_size];
+    float _uw[block_size];
+    float _vx[block_size];
+    float _vy[block_size];
+    float _vz[block_size];
+    float _vw[block_size];
+
+    // The margin of error for each polygon, given its size.
+    float _tol[block_size];
+
+    uint32_t _first_edge;
+    uint32_t _num_edges;
+
+    // The lanes that hold something other than a polygon we can test.
+    int _passthrough;
+  };
+
+  typedef pvector<Block> Blocks;
+  typedef pvector<EdgeBlock> EdgeBlocks;
+  Blocks _blocks;
+  EdgeBlocks _edges;
+  size_t _num_solids;
+};
+
+#include "collisionPolygonBatch.I"
+
+#endif
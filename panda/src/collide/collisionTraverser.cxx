@@ -13,6 +13,9 @@
 
 #include "collisionTraverser.h"
 #include "collisionNode.h"
+#include "collisionBroadphase.h"
+#include "collisionBVH.h"
+#include "collisionPolygonBatch.h"
 #include "collisionEntry.h"
 #include "collisionPolygon.h"
 #include "collisionGeom.h"
@@ -35,17 +38,47 @@
 #include "lodNode.h"
 #include "nodePath.h"
 #include "pStatTimer.h"
+#include "jobSystem.h"
 #include "indent.h"
 
 #include <algorithm>
 
+using std::max;
 using std::min;
 
+/**
+ * Asks the CollisionBroadphase for the children that are near at least one of
+ * the colliders still active in the level state.  If it can't tell, fills in
+ * all of the children.
+ */
+template<class LevelState>
+static void
+find_broadphase_children(CollisionBroadphase::Indices &indices,
+                         const CollisionBroadphase *node,
+                         const LevelState &level_state, int num_children) {
+  pvector<const GeometricBoundingVolume *> bounds;
+  int num_colliders = level_state.get_num_colliders();
+  bounds.reserve(num_colliders);
+  for (int c = 0; c < num_colliders; ++c) {
+    if (level_state.has_collider(c)) {
+      bounds.push_back(level_state.get_local_bound(c));
+    }
+  }
+
+  if (!node->find_children(indices, bounds.data(), bounds.size())) {
+    indices.resize(num_children);
+    for (int i = 0; i < num_children; ++i) {
+      indices[i] = i;
+    }
+  }
+}
+
 PStatCollector CollisionTraverser::_collisions_pcollector("App:Collisions");
 
 PStatCollector CollisionTraverser::_cnode_volume_pcollector("Collision Volumes:CollisionNode");
 PStatCollector CollisionTraverser::_gnode_volume_pcollector("Collision Volumes:GeomNode");
 PStatCollector CollisionTraverser::_geom_volume_pcollector("Collision Volumes:Geom");
+PStatCollector CollisionTraverser::_batch_pcollector("Collision Volumes:CollisionPolygon batch");
 
 TypeHandle CollisionTraverser::_type_handle;
 
@@ -72,9 +105,12 @@ public:
 CollisionTraverser::
 CollisionTraverser(const std::string &name) :
   Namable(name),
-  _this_pcollector(_collisions_pcollector, name)
+  _this_pcollector(_collisions_pcollector, name),
+  _parallel_pcollector(_this_pcollector, "Parallel"),
+  _deliver_pcollector(_this_pcollector, "Deliver")
 {
   _respect_prev_transform = respect_prev_transform;
+  _parallel_traverse = parallel_collision_traverse;
   #ifdef DO_COLLISION_RECORDING
   _recorder = nullptr;
   #endif
@@ -273,12 +309,18 @@ traverse(const NodePath &root) {
   }
 
   bool traversal_done = false;
-  if ((int)_colliders.size() <= CollisionLevelStateSingle::get_max_colliders() ||
-      !allow_collider_multiple) {
+  if (_parallel_traverse) {
+    traversal_done = traverse_parallel(root);
+  }
+
+  if (!traversal_done &&
+      ((int)_colliders.size() <= CollisionLevelStateSingle::get_max_colliders() ||
+       !allow_collider_multiple)) {
     // Use the single-word-at-a-time traverser, which might need to make lots
     // of passes.
     LevelStatesSingle level_states;
-    prepare_colliders_single(level_states, root);
+    prepare_colliders_single(level_states, root,
+                             CollisionLevelStateSingle::get_max_colliders());
 
     if (level_states.size() == 1 || !allow_collider_multiple) {
       traversal_done = true;
@@ -349,6 +391,7 @@ traverse(const NodePath &root) {
   _cnode_volume_pcollector.flush_level();
   _gnode_volume_pcollector.flush_level();
   _geom_volume_pcollector.flush_level();
+  _batch_pcollector.flush_level();
 
   CollisionSphere::flush_level();
   CollisionCapsule::flush_level();
@@ -490,13 +533,15 @@ write(std::ostream &out, int indent_level) const {
  * use.
  *
  * This flavor uses a CollisionLevelStateSingle, which is limited to a certain
- * number of colliders per pass (typically 32).
+ * number of colliders per pass (typically 32).  A smaller limit may be given
+ * in max_colliders, to split the colliders into more passes.
  */
 void CollisionTraverser::
 prepare_colliders_single(CollisionTraverser::LevelStatesSingle &level_states,
-                         const NodePath &root) {
+                         const NodePath &root, int max_colliders) {
   int num_colliders = _colliders.size();
-  int max_colliders = CollisionLevelStateSingle::get_max_colliders();
+  nassertv(max_colliders > 0 &&
+           max_colliders <= CollisionLevelStateSingle::get_max_colliders());
 
   CollisionLevelStateSingle level_state(root);
   // This reserve() call is only correct if there is exactly one solid per
@@ -599,7 +644,8 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              level_state.get_node_bound());
+              level_state.get_node_bound(),
+              pass);
         }
       }
     }
@@ -638,7 +684,8 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              level_state.get_node_bound());
+              level_state.get_node_bound(),
+              pass);
         }
       }
     }
@@ -680,6 +727,24 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
       }
     }
 
+  } else if (node->is_of_type(CollisionBroadphase::get_class_type())) {
+    // If it's a CollisionBroadphase, visit only the children that it finds
+    // near one of the colliders.  The rest would fail the bounds test anyway.
+    PandaNode::Children children = node->get_children();
+    int num_children = children.get_num_children();
+    CollisionBroadphase::Indices indices;
+    find_broadphase_children(indices, (CollisionBroadphase *)node,
+                             level_state, num_children);
+    for (int i : indices) {
+      nassertd(i < num_children) continue;
+      const PandaNode::DownConnection &child = children.get_child_connection(i);
+      CollisionLevelStateSingle::CurrentMask mask = level_state.get_child_mask(child);
+      if (!mask.is_zero()) {
+        CollisionLevelStateSingle next_state(level_state, child, mask);
+        r_traverse_single(next_state, pass);
+      }
+    }
+
   } else {
     // Otherwise, visit all the children.
     PandaNode::Children children = node->get_children();
@@ -808,7 +873,8 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              level_state.get_node_bound());
+              level_state.get_node_bound(),
+              pass);
         }
       }
     }
@@ -847,7 +913,8 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              level_state.get_node_bound());
+              level_state.get_node_bound(),
+              pass);
         }
       }
     }
@@ -889,6 +956,24 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
       }
     }
 
+  } else if (node->is_of_type(CollisionBroadphase::get_class_type())) {
+    // If it's a CollisionBroadphase, visit only the children that it finds
+    // near one of the colliders.  The rest would fail the bounds test anyway.
+    PandaNode::Children children = node->get_children();
+    int num_children = children.get_num_children();
+    CollisionBroadphase::Indices indices;
+    find_broadphase_children(indices, (CollisionBroadphase *)node,
+                             level_state, num_children);
+    for (int i : indices) {
+      nassertd(i < num_children) continue;
+      const PandaNode::DownConnection &child = children.get_child_connection(i);
+      CollisionLevelStateDouble::CurrentMask mask = level_state.get_child_mask(child);
+      if (!mask.is_zero()) {
+        CollisionLevelStateDouble next_state(level_state, child, mask);
+        r_traverse_double(next_state, pass);
+      }
+    }
+
   } else {
     // Otherwise, visit all the children.
     PandaNode::Children children = node->get_children();
@@ -1017,7 +1102,8 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              level_state.get_node_bound());
+              level_state.get_node_bound(),
+              pass);
         }
       }
     }
@@ -1056,7 +1142,8 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              level_state.get_node_bound());
+              level_state.get_node_bound(),
+              pass);
         }
       }
     }
@@ -1098,6 +1185,24 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
       }
     }
 
+  } else if (node->is_of_type(CollisionBroadphase::get_class_type())) {
+    // If it's a CollisionBroadphase, visit only the children that it finds
+    // near one of the colliders.  The rest would fail the bounds test anyway.
+    PandaNode::Children children = node->get_children();
+    int num_children = children.get_num_children();
+    CollisionBroadphase::Indices indices;
+    find_broadphase_children(indices, (CollisionBroadphase *)node,
+                             level_state, num_children);
+    for (int i : indices) {
+      nassertd(i < num_children) continue;
+      const PandaNode::DownConnection &child = children.get_child_connection(i);
+      CollisionLevelStateQuad::CurrentMask mask = level_state.get_child_mask(child);
+      if (!mask.is_zero()) {
+        CollisionLevelStateQuad next_state(level_state, child, mask);
+        r_traverse_quad(next_state, pass);
+      }
+    }
+
   } else {
     // Otherwise, visit all the children.
     PandaNode::Children children = node->get_children();
@@ -1113,6 +1218,93 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
   }
 }
 
+/**
+ * Performs the traversal on the JobSystem's worker threads, as described in
+ * set_parallel_traverse().  The colliders are split into groups of
+ * parallel-collision-group-size solids, each of which is traversed in a
+ * separate pass.  The entries detected by each pass are saved, and passed to
+ * the handlers afterwards, in pass order, so that the order in which the
+ * handlers see them does not depend on the number of threads.
+ *
+ * Returns true if the traversal has been performed, or false if it could not
+ * be done in parallel, in which case the caller should do it serially.
+ */
+bool CollisionTraverser::
+traverse_parallel(const NodePath &root) {
+#ifdef DO_COLLISION_RECORDING
+  if (has_recorder()) {
+    // The recorder is not prepared to be called from several threads.
+    return false;
+  }
+#endif  // DO_COLLISION_RECORDING
+
+  JobSystem *jobs = JobSystem::get_global_ptr();
+  if (jobs->get_num_workers() == 0) {
+    return false;
+  }
+
+  int group_size = max(min((int)parallel_collision_group_size,
+                           CollisionLevelStateSingle::get_max_colliders()), 1);
+
+  LevelStatesSingle level_states;
+  prepare_colliders_single(level_states, root, group_size);
+
+  size_t num_passes = level_states.size();
+  if (num_passes <= 1) {
+    // Nothing to split up; just do it on this thread.
+    if (num_passes == 1 && level_states[0].any_in_bounds()) {
+#ifdef DO_PSTATS
+      PStatTimer pass_timer(get_pass_collector(0));
+#endif
+      r_traverse_single(level_states[0], 0);
+    }
+    return true;
+  }
+
+  // Make sure the collectors for all passes exist before we start, since
+  // get_pass_collector() may not be called from the worker threads.
+  get_pass_collector(num_passes - 1);
+
+  _pass_states.resize(num_passes);
+#ifdef DO_PSTATS
+  for (size_t pass = 0; pass < num_passes; ++pass) {
+    level_states[pass].set_node_volume_level(&_pass_states[pass]._node_volume_level);
+  }
+#endif
+  {
+    PStatTimer timer(_parallel_pcollector);
+    jobs->parallel_process(num_passes, [this, &level_states] (size_t begin, size_t end) {
+      for (size_t pass = begin; pass < end; ++pass) {
+        // Each pass is timed on the thread that runs it, so PStats shows
+        // how the passes were spread over the threads.
+#ifdef DO_PSTATS
+        PStatTimer pass_timer(_pass_collectors[pass]);
+#endif
+        if (level_states[pass].any_in_bounds()) {
+          r_traverse_single(level_states[pass], pass);
+        }
+      }
+    });
+  }
+
+  PassStates pass_states;
+  pass_states.swap(_pass_states);
+
+  PStatTimer timer(_deliver_pcollector);
+  for (const PassState &state : pass_states) {
+    for (const DeferredEntry &deferred : state._entries) {
+      deferred._handler->add_entry(deferred._entry);
+    }
+#ifdef DO_PSTATS
+    CollisionLevelStateBase::_node_volume_pcollector.add_level(state._node_volume_level);
+    for (const auto &item : state._levels) {
+      item.first->add_level(item.second);
+    }
+#endif
+  }
+  return true;
+}
+
 /**
  *
  */
@@ -1120,12 +1312,13 @@ void CollisionTraverser::
 compare_collider_to_node(CollisionEntry &entry,
                          const GeometricBoundingVolume *from_parent_gbv,
                          const GeometricBoundingVolume *from_node_gbv,
-                         const GeometricBoundingVolume *into_node_gbv) {
+                         const GeometricBoundingVolume *into_node_gbv,
+                         size_t pass) {
   bool within_node_bounds = true;
   if (from_parent_gbv != nullptr &&
       into_node_gbv != nullptr) {
     within_node_bounds = (into_node_gbv->contains(from_parent_gbv) != 0);
-    _cnode_volume_pcollector.add_level(1);
+    add_level(_cnode_volume_pcollector, pass);
   }
 
   if (within_node_bounds) {
@@ -1150,20 +1343,55 @@ compare_collider_to_node(CollisionEntry &entry,
       Colliders::const_iterator ci;
       ci = _colliders.find(entry.get_from_node_path());
       nassertv(ci != _colliders.end());
-      entry.test_intersection((*ci).second, this);
+      test_intersection(entry, (*ci).second, pass);
     } else {
-      CollisionNode::Solids::const_iterator si;
-      for (si = cnode->_solids.begin(); si != cnode->_solids.end(); ++si) {
-        entry._into = (*si).get_read_pointer(current_thread);
+      // If the node has enough solids to have a BVH, we can use it to find
+      // the handful of solids that are worth testing.  They are returned in
+      // ascending order, so the collisions are found in the same order.
+      const CollisionBVH *bvh = nullptr;
+      CollisionBVH::Indices candidates;
+      if (from_node_gbv != nullptr) {
+        bvh = cnode->get_bvh();
+        if (bvh != nullptr && !bvh->find_volume_overlaps(from_node_gbv, candidates)) {
+          bvh = nullptr;
+        }
+      }
+
+      // If there are enough polygons, a ray, segment or sphere is first
+      // tested against a block of polygons at a time, to rule out most of
+      // them quickly.
+      const CollisionPolygonBatch *batch = cnode->get_polygon_batch();
+      CollisionPolygonBatch::Query query;
+      if (batch != nullptr && !CollisionPolygonBatch::setup_query(query, entry)) {
+        batch = nullptr;
+      }
+      size_t block = (size_t)-1;
+      int block_mask = 0;
+
+      size_t num_candidates = (bvh != nullptr) ? candidates.size() : cnode->_solids.size();
+      for (size_t ci = 0; ci < num_candidates; ++ci) {
+        size_t index = (bvh != nullptr) ? candidates[ci] : ci;
+        if (batch != nullptr) {
+          size_t bi = index / CollisionPolygonBatch::block_size;
+          if (bi != block) {
+            block = bi;
+            block_mask = batch->test_block(bi, query);
+            add_level(_batch_pcollector, pass);
+          }
+          if ((block_mask & (1 << (index % CollisionPolygonBatch::block_size))) == 0) {
+            continue;
+          }
+        }
 
         // We should allow a collision test for solid into itself, because the
         // solid might be simply instanced into multiple different
         // CollisionNodes.  We are already filtering out tests for a
         // CollisionNode into itself.
+        entry._into = cnode->_solids[index].get_read_pointer(current_thread);
         CPT(BoundingVolume) solid_bv = entry._into->get_bounds();
         const GeometricBoundingVolume *solid_gbv = solid_bv->as_geometric_bounding_volume();
 
-        compare_collider_to_solid(entry, from_node_gbv, solid_gbv);
+        compare_collider_to_solid(entry, from_node_gbv, solid_gbv, pass);
       }
     }
   }
@@ -1176,12 +1404,13 @@ void CollisionTraverser::
 compare_collider_to_geom_node(CollisionEntry &entry,
                               const GeometricBoundingVolume *from_parent_gbv,
                               const GeometricBoundingVolume *from_node_gbv,
-                              const GeometricBoundingVolume *into_node_gbv) {
+                              const GeometricBoundingVolume *into_node_gbv,
+                              size_t pass) {
   bool within_node_bounds = true;
   if (from_parent_gbv != nullptr &&
       into_node_gbv != nullptr) {
     within_node_bounds = (into_node_gbv->contains(from_parent_gbv) != 0);
-    _gnode_volume_pcollector.add_level(1);
+    add_level(_gnode_volume_pcollector, pass);
   }
 
   if (within_node_bounds) {
@@ -1203,7 +1432,7 @@ compare_collider_to_geom_node(CollisionEntry &entry,
           geom_gbv = geom_bv->as_geometric_bounding_volume();
         }
 
-        compare_collider_to_geom(entry, geom, from_node_gbv, geom_gbv);
+        compare_collider_to_geom(entry, geom, from_node_gbv, geom_gbv, pass);
       }
     }
   }
@@ -1215,13 +1444,14 @@ compare_collider_to_geom_node(CollisionEntry &entry,
 void CollisionTraverser::
 compare_collider_to_solid(CollisionEntry &entry,
                           const GeometricBoundingVolume *from_node_gbv,
-                          const GeometricBoundingVolume *solid_gbv) {
+                          const GeometricBoundingVolume *solid_gbv,
+                          size_t pass) {
   bool within_solid_bounds = true;
   if (from_node_gbv != nullptr &&
       solid_gbv != nullptr) {
     within_solid_bounds = (solid_gbv->contains(from_node_gbv) != 0);
     #ifdef DO_PSTATS
-    ((CollisionSolid *)entry.get_into())->get_volume_pcollector().add_level(1);
+    add_level(((CollisionSolid *)entry.get_into())->get_volume_pcollector(), pass);
     #endif  // DO_PSTATS
 #ifndef NDEBUG
     if (collide_cat.is_spam()) {
@@ -1236,7 +1466,7 @@ compare_collider_to_solid(CollisionEntry &entry,
     Colliders::const_iterator ci;
     ci = _colliders.find(entry.get_from_node_path());
     nassertv(ci != _colliders.end());
-    entry.test_intersection((*ci).second, this);
+    test_intersection(entry, (*ci).second, pass);
   }
 }
 
@@ -1246,12 +1476,13 @@ compare_collider_to_solid(CollisionEntry &entry,
 void CollisionTraverser::
 compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
                          const GeometricBoundingVolume *from_node_gbv,
-                         const GeometricBoundingVolume *geom_gbv) {
+                         const GeometricBoundingVolume *geom_gbv,
+                         size_t pass) {
   bool within_geom_bounds = true;
   if (from_node_gbv != nullptr &&
       geom_gbv != nullptr) {
     within_geom_bounds = (geom_gbv->contains(from_node_gbv) != 0);
-    _geom_volume_pcollector.add_level(1);
+    add_level(_geom_volume_pcollector, pass);
   }
   if (within_geom_bounds) {
     Colliders::const_iterator ci;
@@ -1291,13 +1522,13 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
                 sphere.around(v, v + 3);
                 within_solid_bounds = (sphere.contains(from_node_gbv) != 0);
 #ifdef DO_PSTATS
-                CollisionGeom::_volume_pcollector.add_level(1);
+                add_level(CollisionGeom::_volume_pcollector, pass);
 #endif  // DO_PSTATS
               }
               if (within_solid_bounds) {
                 PT(CollisionGeom) cgeom = new CollisionGeom(v[0], v[1], v[2]);
                 entry._into = cgeom;
-                entry.test_intersection((*ci).second, this);
+                test_intersection(entry, (*ci).second, pass);
               }
             }
           }
@@ -1321,13 +1552,13 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
                 sphere.around(v, v + 3);
                 within_solid_bounds = (sphere.contains(from_node_gbv) != 0);
 #ifdef DO_PSTATS
-                CollisionGeom::_volume_pcollector.add_level(1);
+                add_level(CollisionGeom::_volume_pcollector, pass);
 #endif  // DO_PSTATS
               }
               if (within_solid_bounds) {
                 PT(CollisionGeom) cgeom = new CollisionGeom(v[0], v[1], v[2]);
                 entry._into = cgeom;
-                entry.test_intersection((*ci).second, this);
+                test_intersection(entry, (*ci).second, pass);
               }
             }
           }
@@ -1337,6 +1568,40 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
   }
 }
 
+/**
+ * Tests the entry's from solid against its into solid, and passes the
+ * resulting entry, if any, to the indicated handler.  During a parallel
+ * traversal, the entry is instead saved in the list for the indicated pass,
+ * to be passed to the handler once all passes have finished.
+ */
+void CollisionTraverser::
+test_intersection(CollisionEntry &entry, CollisionHandler *handler,
+                  size_t pass) {
+  if (_pass_states.empty()) {
+    entry.test_intersection(handler, this);
+    return;
+  }
+
+  // This is the same as CollisionEntry::test_intersection(), except for what
+  // is done with the result.  There is no recorder during a parallel
+  // traversal.
+  PT(CollisionEntry) result = entry.get_from()->test_intersection(entry);
+#ifdef DO_PSTATS
+  add_level(((CollisionSolid *)entry.get_into())->get_test_pcollector(), pass);
+#endif  // DO_PSTATS
+  if (handler->wants_all_potential_collidees() && result == nullptr) {
+    result = new CollisionEntry(entry);
+    result->reset_collided();
+  }
+  if (result != nullptr) {
+    nassertv(pass < _pass_states.size());
+    DeferredEntry deferred;
+    deferred._handler = handler;
+    deferred._entry = std::move(result);
+    _pass_states[pass]._entries.push_back(std::move(deferred));
+  }
+}
+
 /**
  * Removes the indicated CollisionHandler from the list of handlers to be
  * processed, and returns the iterator to the next handler in the list.  This
@@ -53,6 +53,11 @@ PUBLISHED:
   MAKE_PROPERTY(respect_prev_transform, get_respect_prev_transform,
                                         set_respect_prev_transform);
 
+  INLINE void set_parallel_traverse(bool flag);
+  INLINE bool get_parallel_traverse() const;
+  MAKE_PROPERTY(parallel_traverse, get_parallel_traverse,
+                                   set_parallel_traverse);
+
   void add_collider(const NodePath &collider, CollisionHandler *handler);
   bool remove_collider(const NodePath &collider);
   bool has_collider(const NodePath &collider) const;
@@ -85,7 +90,8 @@ PUBLISHED:
 
 private:
   typedef pvector<CollisionLevelStateSingle> LevelStatesSingle;
-  void prepare_colliders_single(LevelStatesSingle &level_states, const NodePath &root);
+  void prepare_colliders_single(LevelStatesSingle &level_states, const NodePath &root,
+                                int max_colliders);
   void r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass);
 
   typedef pvector<CollisionLevelStateDouble> LevelStatesDouble;
@@ -96,21 +102,30 @@ private:
   void prepare_colliders_quad(LevelStatesQuad &level_states, const NodePath &root);
   void r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass);
 
+  bool traverse_parallel(const NodePath &root);
+
   void compare_collider_to_node(CollisionEntry &entry,
                                 const GeometricBoundingVolume *from_parent_gbv,
                                 const GeometricBoundingVolume *from_node_gbv,
-                                const GeometricBoundingVolume *into_node_gbv);
+                                const GeometricBoundingVolume *into_node_gbv,
+                                size_t pass);
   void compare_collider_to_geom_node(CollisionEntry &entry,
                                      const GeometricBoundingVolume *from_parent_gbv,
                                      const GeometricBoundingVolume *from_node_gbv,
-                                     const GeometricBoundingVolume *into_node_gbv);
+                                     const GeometricBoundingVolume *into_node_gbv,
+                                     size_t pass);
   void compare_collider_to_solid(CollisionEntry &entry,
                                  const GeometricBoundingVolume *from_node_gbv,
-                                 const GeometricBoundingVolume *solid_gbv);
+                                 const GeometricBoundingVolume *solid_gbv,
+                                 size_t pass);
   void compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
                                 const GeometricBoundingVolume *from_node_gbv,
-                                const GeometricBoundingVolume *solid_gbv);
+                                const GeometricBoundingVolume *solid_gbv,
+                                size_t pass);
+  void test_intersection(CollisionEntry &entry, CollisionHandler *handler,
+                         size_t pass);
 
+  INLINE void add_level(PStatCollector &collector, size_t pass);
   PStatCollector &get_pass_collector(int pass);
 
 private:
@@ -133,6 +148,30 @@ private:
   Handlers::iterator remove_handler(Handlers::iterator hi);
 
   bool _respect_prev_transform;
+  bool _parallel_traverse;
+
+  // During a parallel traversal, the entries detected by each pass are saved
+  // here, to be passed to the handlers after all passes have finished.  The
+  // same goes for the levels of the PStatCollectors, which may not be touched
+  // by the worker threads.  This is empty during a serial traversal.
+  class DeferredEntry {
+  public:
+    CollisionHandler *_handler;
+    PT(CollisionEntry) _entry;
+  };
+  typedef pvector<DeferredEntry> DeferredEntries;
+  class PassState {
+  public:
+    DeferredEntries _entries;
+#ifdef DO_PSTATS
+    typedef pmap<PStatCollector *, int> Levels;
+    Levels _levels;
+    int _node_volume_level = 0;
+#endif
+  };
+  typedef pvector<PassState> PassStates;
+  PassStates _pass_states;
+
 #ifdef DO_COLLISION_RECORDING
   CollisionRecorder *_recorder;
   NodePath _collision_visualizer_np;
@@ -147,8 +186,11 @@ private:
   static PStatCollector _cnode_volume_pcollector;
   static PStatCollector _gnode_volume_pcollector;
   static PStatCollector _geom_volume_pcollector;
+  static PStatCollector _batch_pcollector;
 
   PStatCollector _this_pcollector;
+  PStatCollector _parallel_pcollector;
+  PStatCollector _deliver_pcollector;
   typedef pvector<PStatCollector> PassCollectors;
   PassCollectors _pass_collectors;
   // pstats category for actual collision detection (vs.  bounding heirarchy
@@ -13,6 +13,7 @@
 
 #include "config_collide.h"
 #include "collisionBox.h"
+#include "collisionBroadphase.h"
 #include "collisionCapsule.h"
 #include "collisionEntry.h"
 #include "collisionHandler.h"
@@ -112,6 +113,44 @@ ConfigVariableBool pushers_horizontal
           "set_horizontal() flag by default, false to let the move "
           "in three dimensions by default."));
 
+ConfigVariableBool parallel_collision_traverse
+("parallel-collision-traverse", false,
+ PRC_DESC("Set this true to have CollisionTraversers split their colliders "
+          "into groups, which are traversed on the JobSystem's worker "
+          "threads.  The collisions found are passed to the handlers "
+          "afterwards, on the calling thread, in an order that does not "
+          "depend on the number of threads.  This may also be enabled for "
+          "a particular traverser with set_parallel_traverse()."));
+
+ConfigVariableInt parallel_collision_group_size
+("parallel-collision-group-size", 4,
+ PRC_DESC("The number of collision solids that are traversed together, in "
+          "one group, by a parallel CollisionTraverser.  Smaller groups "
+          "spread the work over more threads; larger groups share more of "
+          "the scene graph traversal between the solids in the group."));
+
+ConfigVariableInt collision_bvh_min_solids
+("collision-bvh-min-solids", 16,
+ PRC_DESC("A CollisionNode with at least this many solids, or a "
+          "CollisionFloorMesh with at least this many triangles, builds a "
+          "bounding volume hierarchy over them the first time it is "
+          "traversed, so that the solids that cannot be touched by a "
+          "collider can be skipped quickly.  Set this to 0 to disable it."));
+
+ConfigVariableInt collision_batch_min_polygons
+("collision-batch-min-polygons", 8,
+ PRC_DESC("A CollisionNode with at least this many solids keeps a packed "
+          "copy of its CollisionPolygons, so that rays, segments and spheres "
+          "can be tested against four polygons at a time.  Only the "
+          "polygons that pass this quick test are tested in full.  Set this "
+          "to 0 to disable it."));
+
+ConfigVariableDouble collision_broadphase_cell_size
+("collision-broadphase-cell-size", 10.0,
+ PRC_DESC("The default size of each cell of the grid that a "
+          "CollisionBroadphase sorts its children into.  This should be "
+          "about the size of a typical child, or a little larger."));
+
 /**
  * Initializes the library.  This must be called at least once before any of
  * the functions or classes in this library can be used.  Normally it will be
@@ -127,6 +166,7 @@ init_libcollide() {
   initialized = true;
 
   CollisionBox::init_type();
+  CollisionBroadphase::init_type();
   CollisionCapsule::init_type();
   CollisionEntry::init_type();
   CollisionHandler::init_type();
@@ -164,6 +204,7 @@ init_libcollide() {
                                        "CollisionTube", 6, 44);
 
   CollisionBox::register_with_read_factory();
+  CollisionBroadphase::register_with_read_factory();
   CollisionCapsule::register_with_read_factory();
   CollisionInvSphere::register_with_read_factory();
   CollisionHeightfield::register_with_read_factory();
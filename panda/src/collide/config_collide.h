@@ -30,6 +30,11 @@ extern EXPCL_PANDA_COLLIDE ConfigVariableDouble collision_parabola_bounds_thresh
 extern EXPCL_PANDA_COLLIDE ConfigVariableInt collision_parabola_bounds_sample;
 extern EXPCL_PANDA_COLLIDE ConfigVariableInt fluid_cap_amount;
 extern EXPCL_PANDA_COLLIDE ConfigVariableBool pushers_horizontal;
+extern EXPCL_PANDA_COLLIDE ConfigVariableBool parallel_collision_traverse;
+extern EXPCL_PANDA_COLLIDE ConfigVariableInt parallel_collision_group_size;
+extern EXPCL_PANDA_COLLIDE ConfigVariableInt collision_bvh_min_solids;
+extern EXPCL_PANDA_COLLIDE ConfigVariableInt collision_batch_min_polygons;
+extern EXPCL_PANDA_COLLIDE ConfigVariableDouble collision_broadphase_cell_size;
 
 extern EXPCL_PANDA_COLLIDE void init_libcollide();
 
@@ -1,5 +1,7 @@
 #include "config_collide.cxx"
 #include "collisionBox.cxx"
+#include "collisionBroadphase.cxx"
+#include "collisionBVH.cxx"
 #include "collisionCapsule.cxx"
 #include "collisionEntry.cxx"
 #include "collisionGeom.cxx"
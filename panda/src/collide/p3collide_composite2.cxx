@@ -5,6 +5,7 @@
 #include "collisionParabola.cxx"
 #include "collisionPlane.cxx"
 #include "collisionPolygon.cxx"
+#include "collisionPolygonBatch.cxx"
 #include "collisionFloorMesh.cxx"
 #include "collisionRay.cxx"
 #include "collisionRecorder.cxx"
@@ -32,6 +32,17 @@ make_bin(const std::string &name, GraphicsStateGuardianBase *gsg,
   return new CullBinBackToFront(name, gsg, draw_region_pcollector);
 }
 
+/**
+ * Returns a new, empty bin to use for the next frame.  This bin's sort buffer
+ * is handed on to it, so that it does not need to be allocated again.
+ */
+PT(CullBin) CullBinBackToFront::
+make_next() const {
+  PT(CullBinBackToFront) next = new CullBinBackToFront(*this);
+  next->_sort_scratch.swap(_sort_scratch);
+  return next;
+}
+
 /**
  * Adds a geom, along with its associated state, to the bin for rendering.
  */
@@ -52,7 +63,7 @@ add_object(CullableObject *object, Thread *current_thread) {
   center = center * object->_internal_transform->get_mat();
 
   PN_stdfloat distance = _gsg->compute_distance_to(center);
-  _objects.push_back(ObjectData(object, distance));
+  _objects.push_back(SortedObject(object, ~get_float_sort_key(distance)));
 }
 
 /**
@@ -63,7 +74,7 @@ add_object(CullableObject *object, Thread *current_thread) {
 void CullBinBackToFront::
 finish_cull(SceneSetup *, Thread *current_thread) {
   PStatTimer timer(_cull_this_pcollector, current_thread);
-  sort(_objects.begin(), _objects.end());
+  sort_objects(_objects);
 }
 
 /**
@@ -73,7 +84,7 @@ void CullBinBackToFront::
 draw(bool force, Thread *current_thread) {
   PStatTimer timer(_draw_this_pcollector, current_thread);
 
-  for (const ObjectData &data : _objects) {
+  for (const SortedObject &data : _objects) {
     data._object->draw(_gsg, force, current_thread);
   }
 }
@@ -84,7 +95,7 @@ draw(bool force, Thread *current_thread) {
  */
 void CullBinBackToFront::
 fill_result_graph(CullBin::ResultGraphBuilder &builder) {
-  Objects::const_iterator oi;
+  SortedObjects::const_iterator oi;
   for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
     CullableObject *object = (*oi)._object;
     builder.add_object(object);
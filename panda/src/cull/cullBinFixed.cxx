@@ -32,13 +32,24 @@ make_bin(const std::string &name, GraphicsStateGuardianBase *gsg,
   return new CullBinFixed(name, gsg, draw_region_pcollector);
 }
 
+/**
+ * Returns a new, empty bin to use for the next frame.  This bin's sort buffer
+ * is handed on to it, so that it does not need to be allocated again.
+ */
+PT(CullBin) CullBinFixed::
+make_next() const {
+  PT(CullBinFixed) next = new CullBinFixed(*this);
+  next->_sort_scratch.swap(_sort_scratch);
+  return next;
+}
+
 /**
  * Adds a geom, along with its associated state, to the bin for rendering.
  */
 void CullBinFixed::
 add_object(CullableObject *object, Thread *current_thread) {
   int draw_order = object->_state->get_draw_order();
-  _objects.push_back(ObjectData(object, draw_order));
+  _objects.push_back(SortedObject(object, (uint64_t)((uint32_t)draw_order ^ 0x80000000u) << 32));
 }
 
 /**
@@ -49,7 +60,7 @@ add_object(CullableObject *object, Thread *current_thread) {
 void CullBinFixed::
 finish_cull(SceneSetup *, Thread *current_thread) {
   PStatTimer timer(_cull_this_pcollector, current_thread);
-  std::stable_sort(_objects.begin(), _objects.end());
+  sort_objects(_objects);
 }
 
 /**
@@ -59,7 +70,7 @@ void CullBinFixed::
 draw(bool force, Thread *current_thread) {
   PStatTimer timer(_draw_this_pcollector, current_thread);
 
-  for (const ObjectData &data : _objects) {
+  for (const SortedObject &data : _objects) {
     data._object->draw(_gsg, force, current_thread);
   }
 }
@@ -70,7 +81,7 @@ draw(bool force, Thread *current_thread) {
  */
 void CullBinFixed::
 fill_result_graph(CullBin::ResultGraphBuilder &builder) {
-  Objects::const_iterator oi;
+  SortedObjects::const_iterator oi;
   for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
     CullableObject *object = (*oi)._object;
     builder.add_object(object);
@@ -39,25 +39,18 @@ public:
                            GraphicsStateGuardianBase *gsg,
                            const PStatCollector &draw_region_pcollector);
 
+  virtual PT(CullBin) make_next() const;
   virtual void add_object(CullableObject *object, Thread *current_thread);
   virtual void finish_cull(SceneSetup *scene_setup, Thread *current_thread);
   virtual void draw(bool force, Thread *current_thread);
 
 protected:
+  INLINE CullBinFrontToBack(const CullBinFrontToBack &copy);
+
   virtual void fill_result_graph(ResultGraphBuilder &builder);
 
 private:
-  class ObjectData {
-  public:
-    INLINE ObjectData(CullableObject *object, PN_stdfloat dist);
-    INLINE bool operator < (const ObjectData &other) const;
-
-    CullableObject *_object;
-    PN_stdfloat _dist;
-  };
-
-  typedef pvector<ObjectData> Objects;
-  Objects _objects;
+  SortedObjects _objects;
 
 public:
   static TypeHandle get_class_type() {
@@ -16,6 +16,7 @@
 #include "cullableObject.h"
 #include "cullHandler.h"
 #include "pStatTimer.h"
+#include "simpleHashMap.h"
 
 #include <algorithm>
 
@@ -31,12 +32,25 @@ make_bin(const std::string &name, GraphicsStateGuardianBase *gsg,
   return new CullBinStateSorted(name, gsg, draw_region_pcollector);
 }
 
+/**
+ * Returns a new, empty bin to use for the next frame.  This bin's sort buffer
+ * is handed on to it, so that it does not need to be allocated again.
+ */
+PT(CullBin) CullBinStateSorted::
+make_next() const {
+  PT(CullBinStateSorted) next = new CullBinStateSorted(*this);
+  next->_sort_scratch.swap(_sort_scratch);
+  return next;
+}
+
 /**
  * Adds a geom, along with its associated state, to the bin for rendering.
  */
 void CullBinStateSorted::
 add_object(CullableObject *object, Thread *current_thread) {
-  _objects.push_back(ObjectData(object));
+  // The sort key is filled in by finish_cull(), once all of the states in
+  // the bin are known.
+  _objects.push_back(SortedObject(object, 0));
 }
 
 /**
@@ -47,7 +61,60 @@ add_object(CullableObject *object, Thread *current_thread) {
 void CullBinStateSorted::
 finish_cull(SceneSetup *, Thread *current_thread) {
   PStatTimer timer(_cull_this_pcollector, current_thread);
-  sort(_objects.begin(), _objects.end());
+
+  // Number the distinct states, vertex formats, vertex datas and transforms in
+  // the bin.
+  // There are usually far fewer of these than there are objects, so it is
+  // cheaper to order these by rank once than to compare them for every pair
+  // of objects.
+  SimpleHashMap<const RenderState *, std::nullptr_t, pointer_hash> states;
+  SimpleHashMap<const GeomVertexFormat *, std::nullptr_t, pointer_hash> formats;
+  SimpleHashMap<const GeomVertexData *, std::nullptr_t, pointer_hash> datas;
+  SimpleHashMap<const TransformState *, std::nullptr_t, pointer_hash> transforms;
+
+  size_t num_objects = _objects.size();
+  pvector<uint32_t> ranks(num_objects * 4);
+  for (size_t i = 0; i < num_objects; ++i) {
+    const CullableObject *object = _objects[i]._object;
+    const GeomVertexData *data = object->_munged_data;
+    const GeomVertexFormat *format = (data != nullptr) ? data->get_format() : nullptr;
+    ranks[i * 4] = states.store(object->_state, nullptr);
+    ranks[i * 4 + 1] = formats.store(format, nullptr);
+    ranks[i * 4 + 2] = datas.store(data, nullptr);
+    ranks[i * 4 + 3] = transforms.store(object->_internal_transform, nullptr);
+  }
+
+  // Group by state changes, in approximate order from heaviest change to
+  // lightest change.  The formats, vertex datas and transforms only need to
+  // be grouped together, not ordered, so the order in which they were
+  // encountered will do.
+  size_t num_states = states.get_num_entries();
+  pvector<uint32_t> order(num_states);
+  for (size_t i = 0; i < num_states; ++i) {
+    order[i] = (uint32_t)i;
+  }
+  std::sort(order.begin(), order.end(), [&states] (uint32_t a, uint32_t b) {
+    return states.get_key(a)->compare_sort(*states.get_key(b)) < 0;
+  });
+  pvector<uint32_t> state_ranks(num_states);
+  for (size_t i = 0; i < num_states; ++i) {
+    state_ranks[order[i]] = (uint32_t)i;
+  }
+
+  // The key is made up of 20 bits of state, 8 bits of vertex format, 20 bits
+  // of vertex data and 16 bits of transform, the last of which saves only
+  // uniform updates.  Ranks beyond these limits share the highest value, and
+  // are only grouped less tightly.  Objects with identical keys are drawn in
+  // the order they were culled.
+  for (size_t i = 0; i < num_objects; ++i) {
+    uint64_t state = std::min(state_ranks[ranks[i * 4]], 0xfffffu);
+    uint64_t format = std::min(ranks[i * 4 + 1], 0xffu);
+    uint64_t data = std::min(ranks[i * 4 + 2], 0xfffffu);
+    uint64_t transform = std::min(ranks[i * 4 + 3], 0xffffu);
+    _objects[i]._sort_key = (state << 44) | (format << 36) | (data << 16) | transform;
+  }
+
+  sort_objects(_objects);
 }
 
 
@@ -58,7 +125,7 @@ void CullBinStateSorted::
 draw(bool force, Thread *current_thread) {
   PStatTimer timer(_draw_this_pcollector, current_thread);
 
-  for (const ObjectData &data : _objects) {
+  for (const SortedObject &data : _objects) {
     data._object->draw(_gsg, force, current_thread);
   }
 }
@@ -69,7 +136,7 @@ draw(bool force, Thread *current_thread) {
  */
 void CullBinStateSorted::
 fill_result_graph(CullBin::ResultGraphBuilder &builder) {
-  Objects::const_iterator oi;
+  SortedObjects::const_iterator oi;
   for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
     CullableObject *object = (*oi)._object;
     builder.add_object(object);
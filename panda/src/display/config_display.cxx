@@ -57,6 +57,15 @@ ConfigVariableBool pstats_unused_states
           "graph for TransformState and RenderState counts.  This adds a bit "
           "of per-frame overhead to count these things up."));
 
+ConfigVariableBool parallel_cull
+("parallel-cull", false,
+ PRC_DESC("Set this true to cull the DisplayRegions of all windows in "
+          "parallel on the JobSystem's worker threads, rather than one at "
+          "a time on the cull thread.  This helps when the same scene is "
+          "culled by many cameras every frame, as with shadow cascades or "
+          "reflection cameras.  Be sure that your cull callbacks are safe "
+          "to be called from several threads at once before enabling this."));
+
 
 // Warning!  The code that uses this is currently experimental and incomplete,
 // and will almost certainly crash!  Do not set threading-model to anything
@@ -35,6 +35,7 @@ NotifyCategoryDecl(gsg, EXPCL_PANDA_DISPLAY, EXPTP_PANDA_DISPLAY);
 
 extern EXPCL_PANDA_DISPLAY ConfigVariableBool view_frustum_cull;
 extern EXPCL_PANDA_DISPLAY ConfigVariableBool pstats_unused_states;
+extern EXPCL_PANDA_DISPLAY ConfigVariableBool parallel_cull;
 
 extern EXPCL_PANDA_DISPLAY ConfigVariableString threading_model;
 extern EXPCL_PANDA_DISPLAY ConfigVariableBool allow_nonpipeline_threads;
@@ -12,6 +12,7 @@
  */
 
 #include "graphicsEngine.h"
+#include "jobSystem.h"
 #include "graphicsPipe.h"
 #include "parasiteBuffer.h"
 #include "config_gobj.h"
@@ -82,6 +83,7 @@ PStatCollector GraphicsEngine::_yield_pcollector("App:Yield");
 PStatCollector GraphicsEngine::_cull_pcollector("Cull");
 PStatCollector GraphicsEngine::_cull_setup_pcollector("Cull:Setup");
 PStatCollector GraphicsEngine::_cull_sort_pcollector("Cull:Sort");
+PStatCollector GraphicsEngine::_cull_job_pcollector("Cull:Job");
 PStatCollector GraphicsEngine::_draw_pcollector("Draw");
 PStatCollector GraphicsEngine::_sync_pcollector("Draw:Sync");
 PStatCollector GraphicsEngine::_flip_pcollector("Wait:Flip");
@@ -1446,9 +1448,25 @@ cull_to_bins(GraphicsEngine::Windows wlist, Thread *current_thread) {
   _singular_warning_last_frame = _singular_warning_this_frame;
   _singular_warning_this_frame = false;
 
+  // First, we set up the scene for each DisplayRegion and decide which of
+  // them need to be culled.  Each cull is recorded as a CullJob, which is
+  // then performed, serially or in parallel, after all of the jobs have been
+  // collected.  The results are saved in the order the jobs were created.
+  struct CullJob {
+    GraphicsOutput *_win;
+    PT(DisplayRegion) _dr;
+    PT(SceneSetup) _scene_setup;
+    PT(CullResult) _cull_result;
+
+    // If this is not -1, the DisplayRegion shares the cull result of the
+    // indicated job, rather than being culled itself.
+    int _shared_job;
+  };
+  pvector<CullJob> jobs;
+
   // Keep track of the cameras we have already used in this thread to render
-  // DisplayRegions.
-  typedef pmap<CullKey, DisplayRegion *> AlreadyCulled;
+  // DisplayRegions, by the index of the job that culls them.
+  typedef pmap<CullKey, int> AlreadyCulled;
   AlreadyCulled already_culled;
 
   // We cull shadow passes last; whether we cull them depends on whether their
@@ -1466,13 +1484,11 @@ cull_to_bins(GraphicsEngine::Windows wlist, Thread *current_thread) {
       }
 
       GraphicsStateGuardian *gsg = win->get_gsg();
-      PStatTimer timer(win->get_cull_window_pcollector(), current_thread);
       int num_display_regions = win->get_num_active_display_regions();
       for (int i = 0; i < num_display_regions; ++i) {
         PT(DisplayRegion) dr = win->get_active_display_region(i);
         if (dr != nullptr) {
           PT(SceneSetup) scene_setup;
-          PT(CullResult) cull_result;
           CullKey key;
           {
             PStatTimer timer(_cull_setup_pcollector, current_thread);
@@ -1508,19 +1524,24 @@ cull_to_bins(GraphicsEngine::Windows wlist, Thread *current_thread) {
             }
           }
 
-          AlreadyCulled::iterator aci = already_culled.insert(AlreadyCulled::value_type(std::move(key), nullptr)).first;
-          if ((*aci).second == nullptr) {
+          CullJob job;
+          job._win = win;
+          job._dr = dr;
+          job._scene_setup = std::move(scene_setup);
+          job._shared_job = -1;
+
+          AlreadyCulled::iterator aci = already_culled.insert(AlreadyCulled::value_type(std::move(key), -1)).first;
+          if ((*aci).second == -1) {
             // We have not used this camera already in this thread.  Perform
             // the cull operation.
-            cull_result = dr->get_cull_result(current_thread);
-            if (cull_result != nullptr) {
-              cull_result = cull_result->make_next();
+            job._cull_result = dr->get_cull_result(current_thread);
+            if (job._cull_result != nullptr) {
+              job._cull_result = job._cull_result->make_next();
             } else {
               // This DisplayRegion has no cull results; draw it.
-              cull_result = new CullResult(gsg, dr->get_draw_region_pcollector());
+              job._cull_result = new CullResult(gsg, dr->get_draw_region_pcollector());
             }
-            (*aci).second = dr;
-            cull_to_bins(win, gsg, dr, scene_setup, cull_result, current_thread);
+            (*aci).second = (int)jobs.size();
 
           } else {
             // We have already culled a scene using this camera in this
@@ -1529,12 +1550,9 @@ cull_to_bins(GraphicsEngine::Windows wlist, Thread *current_thread) {
             // DisplayRegions for the left and right channels of a stereo
             // image.)  Of course, the cull result will be the same, so just
             // use the result from the other DisplayRegion.
-            DisplayRegion *other_dr = (*aci).second;
-            cull_result = other_dr->get_cull_result(current_thread);
+            job._shared_job = (*aci).second;
           }
-
-          // Save the results for next frame.
-          dr->set_cull_result(std::move(cull_result), std::move(scene_setup), current_thread);
+          jobs.push_back(std::move(job));
         }
       }
     }
@@ -1545,24 +1563,23 @@ cull_to_bins(GraphicsEngine::Windows wlist, Thread *current_thread) {
   // only one output per GSG+light combination.
   for (PT(SceneSetup) &scene_setup : shadow_passes) {
     DisplayRegion *dr = scene_setup->get_display_region();
-    GraphicsOutput *win = dr->get_window();
-    PStatTimer timer(win->get_cull_window_pcollector(), current_thread);
 
-    PT(CullResult) cull_result;
+    CullJob job;
+    job._win = dr->get_window();
+    job._dr = dr;
+    job._shared_job = -1;
 
     // Are the cull bounds in view of another camera?
     GeometricBoundingVolume *frustum = scene_setup->get_view_frustum();
     if (frustum == nullptr ||
         non_shadow_bounds[scene_setup->get_scene_root()].contains(frustum)) {
-      GraphicsStateGuardian *gsg = win->get_gsg();
-      cull_result = dr->get_cull_result(current_thread);
-      if (cull_result != nullptr) {
-        cull_result = cull_result->make_next();
+      job._cull_result = dr->get_cull_result(current_thread);
+      if (job._cull_result != nullptr) {
+        job._cull_result = job._cull_result->make_next();
       } else {
         // This DisplayRegion has no cull results; draw it.
-        cull_result = new CullResult(gsg, dr->get_draw_region_pcollector());
+        job._cull_result = new CullResult(job._win->get_gsg(), dr->get_draw_region_pcollector());
       }
-      cull_to_bins(win, gsg, dr, scene_setup, cull_result, current_thread);
     }
     else if (display_cat.is_spam()) {
       display_cat.spam()
@@ -1572,7 +1589,57 @@ cull_to_bins(GraphicsEngine::Windows wlist, Thread *current_thread) {
 
     // Even save the results if null, to tell the draw pass that we don't want
     // to draw this at all.
-    dr->set_cull_result(std::move(cull_result), std::move(scene_setup), current_thread);
+    job._scene_setup = std::move(scene_setup);
+    jobs.push_back(std::move(job));
+  }
+
+  // Now perform the culls.
+  auto run_job = [this] (CullJob &job, Thread *thread) {
+    if (job._shared_job == -1 && job._cull_result != nullptr) {
+      PStatTimer timer(job._win->get_cull_window_pcollector(), thread);
+      cull_to_bins(job._win, job._win->get_gsg(), job._dr, job._scene_setup,
+                   job._cull_result, thread);
+    }
+  };
+
+  size_t num_jobs = jobs.size();
+  if (parallel_cull && num_jobs > 1) {
+    // Each DisplayRegion has its own CullTraverser and CullResult, so the
+    // culls are independent of each other.  The workers need to read the
+    // scene graph from the same pipeline stage as this thread.
+    int pipeline_stage = current_thread->get_pipeline_stage();
+    JobSystem::get_global_ptr()->parallel_process(num_jobs,
+      [&] (size_t begin, size_t end) {
+        Thread *thread = Thread::get_current_thread();
+        int prev_stage = thread->get_pipeline_stage();
+        if (prev_stage != pipeline_stage) {
+          thread->set_pipeline_stage(pipeline_stage);
+        }
+
+        PStatTimer timer(_cull_job_pcollector, thread);
+        for (size_t ji = begin; ji < end; ++ji) {
+          run_job(jobs[ji], thread);
+        }
+
+        if (prev_stage != pipeline_stage) {
+          thread->set_pipeline_stage(prev_stage);
+        }
+      });
+  } else {
+    for (CullJob &job : jobs) {
+      run_job(job, current_thread);
+    }
+  }
+
+  // Save the results for next frame, in the order in which the jobs were
+  // created.
+  for (CullJob &job : jobs) {
+    if (job._shared_job != -1) {
+      job._cull_result = jobs[job._shared_job]._cull_result;
+    }
+  }
+  for (CullJob &job : jobs) {
+    job._dr->set_cull_result(std::move(job._cull_result), std::move(job._scene_setup), current_thread);
   }
 }
 
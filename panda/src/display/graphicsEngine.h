@@ -389,6 +389,7 @@ private:
   static PStatCollector _cull_pcollector;
   static PStatCollector _cull_setup_pcollector;
   static PStatCollector _cull_sort_pcollector;
+  static PStatCollector _cull_job_pcollector;
   static PStatCollector _draw_pcollector;
   static PStatCollector _sync_pcollector;
   static PStatCollector _flip_pcollector;
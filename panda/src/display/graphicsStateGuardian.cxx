@@ -35,6 +35,7 @@
 #include "shader.h"
 #include "pnotify.h"
 #include "drawableRegion.h"
+#include "lightMutexHolder.h"
 #include "displayRegion.h"
 #include "graphicsOutput.h"
 #include "texturePool.h"
@@ -306,9 +307,9 @@ GraphicsStateGuardian::
   // Note that if uniquify-states is false, we can't iterate over all the
   // states, and some GSGs will linger.  Let's hope this isn't a problem.
   LightReMutexHolder holder(*RenderState::_states_lock);
-  size_t size = RenderState::_states.get_num_entries();
-  for (size_t si = 0; si < size; ++si) {
-    const RenderState *state = RenderState::_states.get_key(si);
+  pvector<const RenderState *> states;
+  RenderState::get_states_snapshot(states);
+  for (const RenderState *state : states) {
     state->_mungers.remove(_id);
     state->_munged_states.remove(_id);
   }
@@ -842,38 +843,47 @@ PT(GeomMunger) GraphicsStateGuardian::
 get_geom_munger(const RenderState *state, Thread *current_thread) {
   RenderState::Mungers &mungers = state->_mungers;
 
-  if (!mungers.is_empty()) {
-    // Before we even look up the map, see if the _last_mi value points to
-    // this GSG.  This is likely because we tend to visit the same state
-    // multiple times during a frame.  Also, this might well be the only GSG
-    // in the world anyway.
-    int mi = state->_last_mi;
-    if (mi >= 0 && (size_t)mi < mungers.get_num_entries() && mungers.get_key(mi) == _id) {
-      PT(GeomMunger) munger = mungers.get_data(mi);
-      if (munger->is_registered()) {
-        return munger;
+  {
+    // The same state may be looked up by several cull threads at once when
+    // parallel-cull is enabled, so the cache is protected by the state's lock.
+    LightMutexHolder holder(((RenderState *)state)->_lock);
+    if (!mungers.is_empty()) {
+      // Before we even look up the map, see if the _last_mi value points to
+      // this GSG.  This is likely because we tend to visit the same state
+      // multiple times during a frame.  Also, this might well be the only GSG
+      // in the world anyway.
+      int mi = state->_last_mi;
+      if (mi >= 0 && (size_t)mi < mungers.get_num_entries() && mungers.get_key(mi) == _id) {
+        PT(GeomMunger) munger = mungers.get_data(mi);
+        if (munger->is_registered()) {
+          return munger;
+        }
       }
-    }
 
-    // Nope, we have to look it up in the map.
-    mi = mungers.find(_id);
-    if (mi >= 0) {
-      PT(GeomMunger) munger = mungers.get_data(mi);
-      if (munger->is_registered()) {
-        state->_last_mi = mi;
-        return munger;
-      } else {
-        // This GeomMunger is no longer registered.  Remove it from the map.
-        mungers.remove_element(mi);
+      // Nope, we have to look it up in the map.
+      mi = mungers.find(_id);
+      if (mi >= 0) {
+        PT(GeomMunger) munger = mungers.get_data(mi);
+        if (munger->is_registered()) {
+          state->_last_mi = mi;
+          return munger;
+        } else {
+          // This GeomMunger is no longer registered.  Remove it from the map.
+          mungers.remove_element(mi);
+        }
       }
     }
   }
 
-  // Nothing in the map; create a new entry.
+  // Nothing in the map; create a new entry.  This is done without holding
+  // the lock, since making a munger may need to look at the state.  If
+  // another thread gets here first, the registry hands us back the same
+  // munger, so it does not matter which one is stored.
   PT(GeomMunger) munger = make_geom_munger(state, current_thread);
   nassertr(munger != nullptr && munger->is_registered(), munger);
   nassertr(munger->is_of_type(StateMunger::get_class_type()), munger);
 
+  LightMutexHolder holder(((RenderState *)state)->_lock);
   state->_last_mi = mungers.store(_id, munger);
   return munger;
 }
@@ -300,6 +300,22 @@ ConfigVariableBool vertex_animation_align_16
           "impacts only vertex formats created within Panda subsystems; custom "
           "vertex formats are not affected."));
 
+ConfigVariableBool vertex_animation_fast_path
+("vertex-animation-fast-path", true,
+ PRC_DESC("If this is true, vertices that are animated on the CPU are "
+          "transformed directly from the original vertex data into the "
+          "animated vertices using SIMD instructions, split across the "
+          "job system's worker threads, whenever the vertex format allows "
+          "it.  Set this false to always use the general-purpose path, which "
+          "copies the entire vertex data every frame before animating it."));
+
+ConfigVariableInt vertex_animation_rows_per_job
+("vertex-animation-rows-per-job", 2048,
+ PRC_DESC("The number of vertices of a single mesh that are handed to each "
+          "worker thread at a time when vertex-animation-fast-path is in "
+          "effect.  Meshes with fewer vertices than this are animated "
+          "entirely on the calling thread."));
+
 ConfigVariableBool vertex_colors_prefer_packed
 ("vertex-colors-prefer-packed",
 #ifdef _WIN32
@@ -21,6 +21,12 @@
 #include "bamWriter.h"
 #include "pset.h"
 #include "indent.h"
+#include "jobSystem.h"
+
+#if defined(__SSE__) || (_M_IX86_FP >= 1) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define SKINNING_SSE 1
+#endif
 
 using std::ostream;
 
@@ -1453,6 +1459,11 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
   }
   PT(GeomVertexData) new_data = cdata->_animated_vertices;
 
+  if (vertex_animation_fast_path && cdata->_slider_table == nullptr &&
+      do_animate_vertices_fast(cdata, new_data, current_thread)) {
+    return;
+  }
+
   // We have to make a complete copy of the data first so we can modify it.
   // If we were clever, we could maybe just figure out the subset of the data
   // that might have changed since last frame, but that's too much trouble
@@ -1751,6 +1762,284 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
   }
 }
 
+/**
+ * Computes the matrix that should be applied to normals that are being
+ * transformed by the indicated matrix, in order to preserve their
+ * perpendicularity to the surface.  Returns true if the transformed normals
+ * will also need to be normalized.
+ */
+bool GeomVertexData::
+calc_normal_transform(const LMatrix4 &mat, LMatrix4 &xform) {
+  LVecBase3 scale_sq(mat.get_row3(0).length_squared(),
+                     mat.get_row3(1).length_squared(),
+                     mat.get_row3(2).length_squared());
+  if (IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[1], 2.0e-3f) &&
+      IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[2], 2.0e-3f)) {
+    // There is a uniform scale.
+    LVecBase3 scale, shear, hpr;
+    if (IS_THRESHOLD_EQUAL(scale_sq[0], 1, 2.0e-3f)) {
+      // No scale to worry about.
+      xform = mat;
+    } else if (decompose_matrix(mat.get_upper_3(), scale, shear, hpr)) {
+      // Make a new matrix with scale/translate taken out of the equation.
+      compose_matrix(xform, LVecBase3(1, 1, 1), shear, hpr, LVecBase3::zero());
+    } else {
+      xform = mat;
+      return true;
+    }
+    return false;
+  }
+
+  // There is a non-uniform scale, so we need to do all this to preserve
+  // orthogonality to the surface.
+  xform.invert_from(mat);
+  xform.transpose_in_place();
+  return true;
+}
+
+/**
+ * An alternative to update_animated_vertices() for the common case of a
+ * soft-skinned mesh without morphs, whose blend indices are stored as a table
+ * of ushorts and whose points and vectors are all float32.
+ *
+ * Rather than copying the entire vertex data every frame and transforming it
+ * in place, this transforms the points and vectors straight from this object
+ * into the animated vertices.  The remaining columns, and the rows that are
+ * not affected by any blend, are only copied over when this object has been
+ * modified since the last time.  Large meshes are split up into ranges of
+ * rows that are processed on the JobSystem's worker threads.
+ *
+ * Returns false, without doing anything, if the vertex data does not qualify;
+ * the caller should fall back to the general path in that case.
+ */
+bool GeomVertexData::
+do_animate_vertices_fast(GeomVertexData::CData *cdata, GeomVertexData *new_data,
+                         Thread *current_thread) {
+  CPT(TransformBlendTable) tb_table = cdata->_transform_blend_table.get_read_pointer(current_thread);
+  if (tb_table == nullptr) {
+    return false;
+  }
+
+  const GeomVertexFormat *orig_format = cdata->_format;
+  const GeomVertexFormat *new_format = new_data->get_format();
+
+  int blend_array_index = orig_format->get_array_with(InternalName::get_transform_blend());
+  if (blend_array_index < 0) {
+    return false;
+  }
+  const GeomVertexArrayFormat *blend_array_format = orig_format->get_array(blend_array_index);
+  if (blend_array_format->get_stride() != 2 ||
+      blend_array_format->get_column(0)->get_component_bytes() != 2) {
+    return false;
+  }
+
+  // Every array of the animated format must have an identical counterpart in
+  // the original format, so that we can address the same column in both.
+  size_t num_arrays = new_format->get_num_arrays();
+  pvector<int> source_arrays(num_arrays, -1);
+  for (size_t ai = 0; ai < num_arrays; ++ai) {
+    const GeomVertexArrayFormat *array_format = new_format->get_array(ai);
+    for (size_t si = 0; si < orig_format->get_num_arrays(); ++si) {
+      if (orig_format->get_array(si) == array_format) {
+        source_arrays[ai] = (int)si;
+        break;
+      }
+    }
+    if (source_arrays[ai] < 0) {
+      return false;
+    }
+  }
+
+  // Collect the columns we have to transform, and make sure we have a kernel
+  // for each of them.
+  enum SkinKind {
+    SK_point3,
+    SK_point4,
+    SK_vector3,
+    SK_vector4,
+    SK_normal3,
+    SK_normal4,
+  };
+  struct SkinColumn {
+    SkinKind _kind;
+    int _array;
+    size_t _start;
+    size_t _stride;
+  };
+  pvector<SkinColumn> columns;
+  bool any_normals = false;
+
+  for (size_t ci = 0; ci < new_format->get_num_points(); ++ci) {
+    int array = new_format->get_array_with(new_format->get_point(ci));
+    const GeomVertexColumn *column = new_format->get_column(new_format->get_point(ci));
+    if (column->get_numeric_type() != NT_float32 ||
+        (column->get_num_values() != 3 && column->get_num_values() != 4)) {
+      return false;
+    }
+    SkinColumn sc;
+    sc._kind = (column->get_num_values() == 3) ? SK_point3 : SK_point4;
+    sc._array = array;
+    sc._start = column->get_start();
+    sc._stride = new_format->get_array(array)->get_stride();
+    columns.push_back(sc);
+  }
+
+  for (size_t ci = 0; ci < new_format->get_num_vectors(); ++ci) {
+    int array = new_format->get_array_with(new_format->get_vector(ci));
+    const GeomVertexColumn *column = new_format->get_column(new_format->get_vector(ci));
+    if (column->get_numeric_type() != NT_float32 ||
+        (column->get_num_values() != 3 && column->get_num_values() != 4)) {
+      return false;
+    }
+    SkinColumn sc;
+    if (column->get_contents() == C_normal) {
+      sc._kind = (column->get_num_values() == 3) ? SK_normal3 : SK_normal4;
+      any_normals = true;
+    } else {
+      sc._kind = (column->get_num_values() == 3) ? SK_vector3 : SK_vector4;
+    }
+    sc._array = array;
+    sc._start = column->get_start();
+    sc._stride = new_format->get_array(array)->get_stride();
+    columns.push_back(sc);
+  }
+
+  // From here on, we are committed to the fast path.
+  int num_rows = cdata->_arrays[0].get_read_pointer(current_thread)->get_num_rows();
+
+  // Recompute all the blends up front, and look up the matrices for each of
+  // them, so the worker threads only have to read from a table.
+  struct SkinMatrices {
+    LMatrix4f _point;
+    LMatrix4f _normal;
+    bool _normalize;
+  };
+  int num_blends = tb_table->get_num_blends();
+  pvector<SkinMatrices> matrices(num_blends);
+  {
+    PStatTimer timer(_blends_pcollector, current_thread);
+    for (int bi = 0; bi < num_blends; ++bi) {
+      const TransformBlend &blend = tb_table->get_blend(bi);
+      blend.update_blend(current_thread);
+
+      LMatrix4 mat;
+      blend.get_blend(mat, current_thread);
+      matrices[bi]._point = LCAST(float, mat);
+      matrices[bi]._normalize = false;
+      if (any_normals) {
+        LMatrix4 xform;
+        matrices[bi]._normalize = calc_normal_transform(mat, xform);
+        matrices[bi]._normal = LCAST(float, xform);
+      }
+    }
+  }
+
+  PStatTimer timer(_skinning_pcollector, current_thread);
+
+  // The columns that are not animated, and the rows that are not affected by
+  // any blend, only need to be copied when they have changed.
+  UpdateSeq source_modified = cdata->_modified;
+  for (size_t si = 0; si < cdata->_arrays.size(); ++si) {
+    source_modified = std::max(source_modified, cdata->_arrays[si].get_read_pointer(current_thread)->get_modified());
+  }
+  if (cdata->_animated_vertices_source_modified != source_modified ||
+      new_data->get_num_rows() != num_rows) {
+    new_data->copy_from(this, true, current_thread);
+    cdata->_animated_vertices_source_modified = source_modified;
+  }
+
+  // Look up all the data pointers on this thread; the jobs only read from the
+  // source arrays and write to disjoint rows of the destination arrays.
+  pvector<CPT(GeomVertexArrayDataHandle)> from_handles;
+  pvector<PT(GeomVertexArrayDataHandle)> to_handles;
+  pvector<const unsigned char *> from_data;
+  pvector<unsigned char *> to_data;
+  for (size_t ai = 0; ai < num_arrays; ++ai) {
+    CPT(GeomVertexArrayDataHandle) from_handle =
+      new GeomVertexArrayDataHandle(cdata->_arrays[source_arrays[ai]].get_read_pointer(current_thread), current_thread);
+    PT(GeomVertexArrayDataHandle) to_handle = new_data->modify_array_handle(ai);
+    from_data.push_back(from_handle->get_read_pointer(true));
+    to_data.push_back(to_handle->get_write_pointer());
+    from_handles.push_back(from_handle);
+    to_handles.push_back(to_handle);
+  }
+
+  CPT(GeomVertexArrayDataHandle) blend_array_handle =
+    new GeomVertexArrayDataHandle(cdata->_arrays[blend_array_index].get_read_pointer(current_thread), current_thread);
+  const unsigned short *blendt = (const unsigned short *)blend_array_handle->get_read_pointer(true);
+
+  // Break the animated rows up into jobs.
+  const SparseArray &rows = tb_table->get_rows();
+  size_t rows_per_job = (size_t)std::max((int)vertex_animation_rows_per_job, 1);
+  pvector<std::pair<int, int> > ranges;
+  int num_subranges = rows.get_num_subranges();
+  for (int i = 0; i < num_subranges; ++i) {
+    int begin = rows.get_subrange_begin(i);
+    int end = std::min(rows.get_subrange_end(i), num_rows);
+    while (begin < end) {
+      int next = (int)std::min((size_t)end, begin + rows_per_job);
+      ranges.push_back(std::make_pair(begin, next));
+      begin = next;
+    }
+  }
+
+  JobSystem::get_global_ptr()->parallel_process(ranges.size(), [&](size_t begin_range, size_t end_range) {
+    for (size_t ri = begin_range; ri < end_range; ++ri) {
+      int first_vertex = ranges[ri].first;
+      int end = ranges[ri].second;
+
+      while (first_vertex < end) {
+        // Find the series of vertices that shares this blend index, and
+        // transform all those vertices as a block.
+        int bi = blendt[first_vertex];
+        int next_vertex = first_vertex + 1;
+        while (next_vertex < end && blendt[next_vertex] == bi) {
+          ++next_vertex;
+        }
+        nassertv(bi < num_blends);
+        const SkinMatrices &mats = matrices[bi];
+        size_t count = next_vertex - first_vertex;
+
+        for (const SkinColumn &sc : columns) {
+          size_t offset = sc._start + first_vertex * sc._stride;
+          const unsigned char *from = from_data[sc._array] + offset;
+          unsigned char *to = to_data[sc._array] + offset;
+          switch (sc._kind) {
+          case SK_point3:
+            skin_point3f(from, to, count, sc._stride, mats._point);
+            break;
+          case SK_point4:
+            skin_vecbase4f(from, to, count, sc._stride, mats._point);
+            break;
+          case SK_vector3:
+            skin_vector3f(from, to, count, sc._stride, mats._point, false);
+            break;
+          case SK_vector4:
+            skin_vecbase4f(from, to, count, sc._stride, mats._point);
+            break;
+          case SK_normal3:
+            skin_vector3f(from, to, count, sc._stride, mats._normal, mats._normalize);
+            break;
+          case SK_normal4:
+            // As in do_transform_vector_column(), a normal that needs to be
+            // renormalized only has its first three components transformed.
+            if (mats._normalize) {
+              skin_vector3f(from, to, count, sc._stride, mats._normal, true);
+            } else {
+              skin_vecbase4f(from, to, count, sc._stride, mats._normal);
+            }
+            break;
+          }
+        }
+
+        first_vertex = next_vertex;
+      }
+    }
+  });
+
+  return true;
+}
+
 
 /**
  * Transforms a range of vertices for one particular column, as a point.
@@ -1811,30 +2100,7 @@ do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &d
   LMatrix4 xform;
   bool normalize = false;
   if (data_column->get_contents() == C_normal) {
-    // This is to preserve perpendicularity to the surface.
-    LVecBase3 scale_sq(mat.get_row3(0).length_squared(),
-                       mat.get_row3(1).length_squared(),
-                       mat.get_row3(2).length_squared());
-    if (IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[1], 2.0e-3f) &&
-        IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[2], 2.0e-3f)) {
-      // There is a uniform scale.
-      LVecBase3 scale, shear, hpr;
-      if (IS_THRESHOLD_EQUAL(scale_sq[0], 1, 2.0e-3f)) {
-        // No scale to worry about.
-        xform = mat;
-      } else if (decompose_matrix(mat.get_upper_3(), scale, shear, hpr)) {
-        // Make a new matrix with scale/translate taken out of the equation.
-        compose_matrix(xform, LVecBase3(1, 1, 1), shear, hpr, LVecBase3::zero());
-      } else {
-        normalize = true;
-      }
-    } else {
-      // There is a non-uniform scale, so we need to do all this to preserve
-      // orthogonality to the surface.
-      xform.invert_from(mat);
-      xform.transpose_in_place();
-      normalize = true;
-    }
+    normalize = calc_normal_transform(mat, xform);
   } else {
     xform = mat;
   }
@@ -1955,6 +2221,102 @@ table_xform_vecbase4f(unsigned char *datat, size_t num_rows, size_t stride,
   }
 }
 
+/**
+ * Writes each of the LPoint3f objects in the "from" table, transformed by the
+ * indicated matrix, to the same row of the "to" table.
+ */
+void GeomVertexData::
+skin_point3f(const unsigned char *from, unsigned char *to, size_t num_rows,
+             size_t stride, const LMatrix4f &matf) {
+#ifdef SKINNING_SSE
+  const float *m = matf.get_data();
+  __m128 r0 = _mm_loadu_ps(m);
+  __m128 r1 = _mm_loadu_ps(m + 4);
+  __m128 r2 = _mm_loadu_ps(m + 8);
+  __m128 r3 = _mm_loadu_ps(m + 12);
+  for (size_t i = 0; i < num_rows; ++i) {
+    const float *v = (const float *)(from + i * stride);
+    float *out = (float *)(to + i * stride);
+    __m128 p = _mm_mul_ps(_mm_set1_ps(v[0]), r0);
+    p = _mm_add_ps(p, _mm_mul_ps(_mm_set1_ps(v[1]), r1));
+    p = _mm_add_ps(p, _mm_mul_ps(_mm_set1_ps(v[2]), r2));
+    p = _mm_add_ps(p, r3);
+    _mm_storel_pi((__m64 *)out, p);
+    _mm_store_ss(out + 2, _mm_movehl_ps(p, p));
+  }
+#else
+  for (size_t i = 0; i < num_rows; ++i) {
+    *(LPoint3f *)(to + i * stride) = *(const LPoint3f *)(from + i * stride) * matf;
+  }
+#endif
+}
+
+/**
+ * Writes each of the LVector3f objects in the "from" table, transformed by
+ * the indicated matrix and optionally normalized, to the same row of the "to"
+ * table.
+ */
+void GeomVertexData::
+skin_vector3f(const unsigned char *from, unsigned char *to, size_t num_rows,
+              size_t stride, const LMatrix4f &matf, bool normalize) {
+#ifdef SKINNING_SSE
+  const float *m = matf.get_data();
+  __m128 r0 = _mm_loadu_ps(m);
+  __m128 r1 = _mm_loadu_ps(m + 4);
+  __m128 r2 = _mm_loadu_ps(m + 8);
+  for (size_t i = 0; i < num_rows; ++i) {
+    const float *v = (const float *)(from + i * stride);
+    float *out = (float *)(to + i * stride);
+    __m128 p = _mm_mul_ps(_mm_set1_ps(v[0]), r0);
+    p = _mm_add_ps(p, _mm_mul_ps(_mm_set1_ps(v[1]), r1));
+    p = _mm_add_ps(p, _mm_mul_ps(_mm_set1_ps(v[2]), r2));
+    _mm_storel_pi((__m64 *)out, p);
+    _mm_store_ss(out + 2, _mm_movehl_ps(p, p));
+  }
+#else
+  for (size_t i = 0; i < num_rows; ++i) {
+    *(LVector3f *)(to + i * stride) = *(const LVector3f *)(from + i * stride) * matf;
+  }
+#endif
+
+  if (normalize) {
+    for (size_t i = 0; i < num_rows; ++i) {
+      ((LVector3f *)(to + i * stride))->normalize();
+    }
+  }
+}
+
+/**
+ * Writes each of the LVecBase4f objects in the "from" table, transformed by
+ * the indicated matrix, to the same row of the "to" table.  Unlike the
+ * table_xform functions, this does not require the table to be aligned.
+ */
+void GeomVertexData::
+skin_vecbase4f(const unsigned char *from, unsigned char *to, size_t num_rows,
+               size_t stride, const LMatrix4f &matf) {
+#ifdef SKINNING_SSE
+  const float *m = matf.get_data();
+  __m128 r0 = _mm_loadu_ps(m);
+  __m128 r1 = _mm_loadu_ps(m + 4);
+  __m128 r2 = _mm_loadu_ps(m + 8);
+  __m128 r3 = _mm_loadu_ps(m + 12);
+  for (size_t i = 0; i < num_rows; ++i) {
+    const float *v = (const float *)(from + i * stride);
+    __m128 p = _mm_mul_ps(_mm_set1_ps(v[0]), r0);
+    p = _mm_add_ps(p, _mm_mul_ps(_mm_set1_ps(v[1]), r1));
+    p = _mm_add_ps(p, _mm_mul_ps(_mm_set1_ps(v[2]), r2));
+    p = _mm_add_ps(p, _mm_mul_ps(_mm_set1_ps(v[3]), r3));
+    _mm_storeu_ps((float *)(to + i * stride), p);
+  }
+#else
+  for (size_t i = 0; i < num_rows; ++i) {
+    const float *v = (const float *)(from + i * stride);
+    LVecBase4f p = LVecBase4f(v[0], v[1], v[2], v[3]) * matf;
+    memcpy(to + i * stride, p.get_data(), sizeof(float) * 4);
+  }
+#endif
+}
+
 /**
  * Tells the BamReader how to create objects of type GeomVertexData.
  */
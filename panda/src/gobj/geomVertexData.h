@@ -312,6 +312,7 @@ private:
     CPT(SliderTable) _slider_table;
     PT(GeomVertexData) _animated_vertices;
     UpdateSeq _animated_vertices_modified;
+    UpdateSeq _animated_vertices_source_modified;
     UpdateSeq _modified;
 
   public:
@@ -338,6 +339,9 @@ private:
 
 private:
   void update_animated_vertices(CData *cdata, Thread *current_thread);
+  bool do_animate_vertices_fast(CData *cdata, GeomVertexData *new_data,
+                                Thread *current_thread);
+  static bool calc_normal_transform(const LMatrix4 &mat, LMatrix4 &xform);
   void do_transform_point_column(const GeomVertexFormat *format, GeomVertexRewriter &data,
                                  const LMatrix4 &mat, int begin_row, int end_row);
   void do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &data,
@@ -350,6 +354,15 @@ private:
                                    size_t stride, const LMatrix4f &matf);
   static void table_xform_vecbase4f(unsigned char *datat, size_t num_rows,
                                     size_t stride, const LMatrix4f &matf);
+  static void skin_point3f(const unsigned char *from, unsigned char *to,
+                           size_t num_rows, size_t stride,
+                           const LMatrix4f &matf);
+  static void skin_vector3f(const unsigned char *from, unsigned char *to,
+                            size_t num_rows, size_t stride,
+                            const LMatrix4f &matf, bool normalize);
+  static void skin_vecbase4f(const unsigned char *from, unsigned char *to,
+                             size_t num_rows, size_t stride,
+                             const LMatrix4f &matf);
 
   static PStatCollector _convert_pcollector;
   static PStatCollector _scale_color_pcollector;
@@ -65,6 +65,30 @@ populate_particle(BaseParticle *bp) {
   populate_child_particle(bp);
 }
 
+/**
+ * Returns true if the particles this factory makes have no state or behavior
+ * beyond that of a plain point particle, so that a ParticleSystem may keep
+ * them in a ParticlePool instead.
+ */
+bool BaseParticleFactory::
+can_use_pool() const {
+  return false;
+}
+
+/**
+ * The ParticlePool equivalent of populate_particle(): fills in the lifespan,
+ * mass and terminal velocity of the nth particle in the pool.
+ */
+void BaseParticleFactory::
+populate_pool_particle(ParticlePool &pool, size_t n) {
+  pool.set_lifespan(n, _lifespan_base + SPREAD(_lifespan_spread));
+  pool.set_mass(n, _mass_base + SPREAD(_mass_spread));
+  pool.set_terminal_velocity(n, _terminal_velocity_base + SPREAD(_terminal_velocity_spread));
+
+  pool.set_age(n, 0.0f);
+  pool.set_index(n, -1);
+}
+
 /**
  * Write a string representation of this instance to <out>.
  */
@@ -18,6 +18,7 @@
 #include "referenceCount.h"
 
 #include "baseParticle.h"
+#include "particlePool.h"
 #include "particleCommonFuncs.h"
 
 #include <stdlib.h>
@@ -50,6 +51,10 @@ PUBLISHED:
   virtual void output(std::ostream &out) const;
   virtual void write(std::ostream &out, int indent=0) const;
 
+public:
+  virtual bool can_use_pool() const;
+  void populate_pool_particle(ParticlePool &pool, size_t n);
+
 protected:
   BaseParticleFactory();
   BaseParticleFactory(const BaseParticleFactory &copy);
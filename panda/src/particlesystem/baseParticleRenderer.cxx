@@ -131,3 +131,105 @@ disable_alpha() {
   _render_state = RenderState::make(TransparencyAttrib::make(TransparencyAttrib::M_none),
                                     ColorAttrib::make_vertex());
 }
+
+/**
+ * Returns true if this renderer can draw a ParticleSystem whose particles are
+ * kept in a ParticlePool, by way of render_pool().
+ */
+bool BaseParticleRenderer::
+can_use_pool() const {
+  return false;
+}
+
+/**
+ * Renders the living particles of a ParticlePool.  Only called if
+ * can_use_pool() returns true.  The renderer doesn't get birth_particle() or
+ * kill_particle() calls for pooled particles; a particle it hasn't seen yet
+ * has an index of -1.
+ */
+void BaseParticleRenderer::
+render_pool(ParticlePool &) {
+}
+
+/**
+ *
+ */
+BaseParticleRenderer::RowWriter::
+RowWriter() :
+  _data(nullptr),
+  _stride(0),
+  _vertex(-1),
+  _color(-1),
+  _rotate(-1),
+  _size(-1),
+  _aspect_ratio(-1),
+  _packed_color(false)
+{
+}
+
+/**
+ * Sizes the first array of the vertex data to the indicated number of rows
+ * and prepares to write them.  Returns false if the array doesn't have the
+ * layout described above, in which case nothing should be written, and the
+ * vertex data is left alone for the caller to write some other way.
+ */
+bool BaseParticleRenderer::RowWriter::
+begin(GeomVertexData *vdata, int num_rows) {
+  _data = nullptr;
+  _handle.clear();
+
+  if (vdata->get_format()->get_num_arrays() != 1) {
+    return false;
+  }
+  const GeomVertexArrayFormat *format = vdata->get_format()->get_array(0);
+  const GeomVertexColumn *vertex = format->get_column(InternalName::get_vertex());
+  const GeomVertexColumn *color = format->get_column(InternalName::get_color());
+  if (vertex == nullptr || color == nullptr ||
+      vertex->get_numeric_type() != GeomEnums::NT_stdfloat ||
+      vertex->get_num_components() != 3) {
+    return false;
+  }
+
+  if (color->get_numeric_type() == GeomEnums::NT_packed_dabc) {
+    _packed_color = true;
+  } else if (color->get_numeric_type() == GeomEnums::NT_uint8 &&
+             color->get_num_components() == 4) {
+    _packed_color = false;
+  } else {
+    return false;
+  }
+
+  _vertex = vertex->get_start();
+  _color = color->get_start();
+  _rotate = -1;
+  _size = -1;
+  _aspect_ratio = -1;
+
+  const GeomVertexColumn *column = format->get_column(InternalName::get_rotate());
+  if (column != nullptr) {
+    if (column->get_numeric_type() != GeomEnums::NT_stdfloat) {
+      return false;
+    }
+    _rotate = column->get_start();
+  }
+  column = format->get_column(InternalName::get_size());
+  if (column != nullptr) {
+    if (column->get_numeric_type() != GeomEnums::NT_stdfloat) {
+      return false;
+    }
+    _size = column->get_start();
+  }
+  column = format->get_column(InternalName::get_aspect_ratio());
+  if (column != nullptr) {
+    if (column->get_numeric_type() != GeomEnums::NT_stdfloat) {
+      return false;
+    }
+    _aspect_ratio = column->get_start();
+  }
+
+  _handle = vdata->modify_array_handle(0);
+  _stride = format->get_stride();
+  _handle->unclean_set_num_rows(num_rows);
+  _data = _handle->get_write_pointer();
+  return true;
+}
@@ -23,6 +23,8 @@
 #include "nodePath.h"
 #include "particleCommonFuncs.h"
 #include "baseParticle.h"
+#include "particlePool.h"
+#include "geomVertexData.h"
 
 #include "pvector.h"
 
@@ -85,6 +87,41 @@ protected:
 
   CPT(RenderState) _render_state;
 
+  /**
+   * Writes rows straight into the first array of a renderer's vertex data, for
+   * render_pool().  This handles the formats the renderers make: a vertex
+   * column, a color column of four uint8s or one packed_dabc, and optional
+   * rotate, size and aspect_ratio columns, all in one array.
+   */
+  class EXPCL_PANDA_PARTICLESYSTEM RowWriter {
+  public:
+    RowWriter();
+
+    bool begin(GeomVertexData *vdata, int num_rows);
+
+    INLINE unsigned char *get_row(int n) const;
+    INLINE void set_vertex(unsigned char *row, PN_stdfloat x, PN_stdfloat y, PN_stdfloat z) const;
+    INLINE void set_color(unsigned char *row, const LColor &color) const;
+    INLINE void set_rotate(unsigned char *row, PN_stdfloat rotate) const;
+    INLINE void set_size(unsigned char *row, PN_stdfloat size) const;
+    INLINE void set_aspect_ratio(unsigned char *row, PN_stdfloat aspect_ratio) const;
+
+    INLINE bool has_rotate() const;
+    INLINE bool has_size() const;
+    INLINE bool has_aspect_ratio() const;
+
+  private:
+    PT(GeomVertexArrayDataHandle) _handle;
+    unsigned char *_data;
+    int _stride;
+    int _vertex;
+    int _color;
+    int _rotate;
+    int _size;
+    int _aspect_ratio;
+    bool _packed_color;
+  };
+
 private:
   PT(GeomNode) _render_node;
   NodePath _render_node_path;
@@ -106,6 +143,9 @@ private:
   virtual void render(pvector< PT(PhysicsObject) >& po_vector,
                       int ttl_particles) = 0;
 
+  virtual bool can_use_pool() const;
+  virtual void render_pool(ParticlePool &pool);
+
   friend class ParticleSystem;
 };
 
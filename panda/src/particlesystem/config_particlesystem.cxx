@@ -23,6 +23,16 @@
 ConfigureDef(config_particlesystem);
 NotifyCategoryDef(particlesystem, "");
 
+ConfigVariableBool particle_system_pool
+("particle-system-pool", true,
+ PRC_DESC("Set this true to let a ParticleSystem keep its particles in a "
+          "ParticlePool, a structure of arrays that is integrated and "
+          "rendered without touching a PhysicsObject per particle.  This "
+          "only happens when the factory makes point particles, the "
+          "renderer is a PointParticleRenderer or SpriteParticleRenderer, "
+          "and the system doesn't spawn on death or use physical "
+          "orientation.  Set it false to always use BaseParticles."));
+
 ConfigureFn(config_particlesystem) {
   ColorInterpolationFunction::init_type();
   ColorInterpolationFunctionConstant::init_type();
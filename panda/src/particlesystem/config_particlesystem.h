@@ -17,10 +17,13 @@
 #include "pandabase.h"
 #include "notifyCategoryProxy.h"
 #include "dconfig.h"
+#include "configVariableBool.h"
 
 ConfigureDecl(config_particlesystem, EXPCL_PANDA_PARTICLESYSTEM, EXPTP_PANDA_PARTICLESYSTEM);
 NotifyCategoryDecl(particlesystem, EXPCL_PANDA_PARTICLESYSTEM, EXPTP_PANDA_PARTICLESYSTEM);
 
+extern EXPCL_PANDA_PARTICLESYSTEM ConfigVariableBool particle_system_pool;
+
 extern EXPCL_PANDA_PARTICLESYSTEM void init_libparticlesystem();
 
 #endif // CONFIG_PARTICLESYSTEM_H
@@ -11,6 +11,7 @@
 // oriented particles unimplemented
 //#include "orientedParticle.cxx"
 //#include "orientedParticleFactory.cxx"
+#include "particlePool.cxx"
 #include "particleSystem.cxx"
 #include "particleSystemManager.cxx"
 
@@ -0,0 +1,81 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file particlePool.cxx
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#include "particlePool.h"
+
+/**
+ *
+ */
+ParticlePool::
+ParticlePool() {
+}
+
+/**
+ *
+ */
+ParticlePool::
+~ParticlePool() {
+}
+
+/**
+ * Makes room for the indicated number of particles.
+ */
+void ParticlePool::
+reserve(size_t num_particles) {
+  PhysicsObjectPool::reserve(num_particles);
+  _age.reserve(num_particles);
+  _lifespan.reserve(num_particles);
+  _index.reserve(num_particles);
+}
+
+/**
+ * Adds dt to the age of every particle.
+ */
+void ParticlePool::
+add_age(PN_stdfloat dt) {
+  size_t num_particles = get_num_objects();
+  PN_stdfloat *age = _age.data();
+
+  size_t i = 0;
+#ifdef PHYSICS_POOL_SSE
+  __m128 step = _mm_set1_ps(dt);
+  for (; i + 4 <= num_particles; i += 4) {
+    _mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), step));
+  }
+#endif
+  for (; i < num_particles; ++i) {
+    age[i] += dt;
+  }
+}
+
+/**
+ *
+ */
+void ParticlePool::
+resize_objects(size_t num_particles) {
+  PhysicsObjectPool::resize_objects(num_particles);
+  _age.resize(num_particles, 0.0f);
+  _lifespan.resize(num_particles, 1.0f);
+  _index.resize(num_particles, -1);
+}
+
+/**
+ *
+ */
+void ParticlePool::
+move_object(size_t from, size_t to) {
+  PhysicsObjectPool::move_object(from, to);
+  _age[to] = _age[from];
+  _lifespan[to] = _lifespan[from];
+  _index[to] = _index[from];
+}
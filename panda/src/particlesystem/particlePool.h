@@ -0,0 +1,63 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file particlePool.h
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#ifndef PARTICLEPOOL_H
+#define PARTICLEPOOL_H
+
+#include "pandabase.h"
+#include "physicsObjectPool.h"
+#include "pvector.h"
+#include "nearly_zero.h"
+
+/**
+ * The living particles of a ParticleSystem, stored as a structure of arrays.
+ * A system keeps its particles in one of these instead of as BaseParticles
+ * when its factory makes plain point particles and its renderer can draw
+ * straight from the arrays; see ParticleSystem::is_pooled().
+ *
+ * Besides what a PhysicsObjectPool stores, each particle has an age and a
+ * lifespan in seconds, and an index for the renderer, which is -1 until the
+ * renderer has seen the particle.
+ */
+class EXPCL_PANDA_PARTICLESYSTEM ParticlePool : public PhysicsObjectPool {
+public:
+  ParticlePool();
+  virtual ~ParticlePool();
+
+  virtual void reserve(size_t num_particles);
+
+  INLINE PN_stdfloat get_age(size_t n) const;
+  INLINE void set_age(size_t n, PN_stdfloat age);
+  INLINE PN_stdfloat get_lifespan(size_t n) const;
+  INLINE void set_lifespan(size_t n, PN_stdfloat lifespan);
+  INLINE int get_index(size_t n) const;
+  INLINE void set_index(size_t n, int index);
+
+  INLINE PN_stdfloat get_parameterized_age(size_t n) const;
+  INLINE PN_stdfloat get_parameterized_vel(size_t n) const;
+
+  void add_age(PN_stdfloat dt);
+
+protected:
+  virtual void resize_objects(size_t num_particles);
+  virtual void move_object(size_t from, size_t to);
+
+private:
+  pvector<PN_stdfloat> _age;
+  pvector<PN_stdfloat> _lifespan;
+  pvector<int> _index;
+};
+
+#include "particlePool.I"
+
+#endif // PARTICLEPOOL_H
@@ -136,6 +136,7 @@ ParticleSystem::
 bool ParticleSystem::
 birth_particle() {
   int pool_index;
+  BaseParticle *bp = nullptr;
 
   // make sure there's room for a new particle
   if (_living_particles >= _particle_pool_size) {
@@ -147,25 +148,30 @@ birth_particle() {
     return false;
   }
 
-  #ifdef PSDEBUG
-  if (0 == _free_particle_fifo.size()) {
-    cout << "Error: _free_particle_fifo is empty, but _living_particles < _particle_pool_size" << endl;
-    return false;
-  }
-  #endif
+  if (is_pooled()) {
+    pool_index = _pool.add_object();
+    _factory->populate_pool_particle(_pool, pool_index);
+  } else {
+    #ifdef PSDEBUG
+    if (0 == _free_particle_fifo.size()) {
+      cout << "Error: _free_particle_fifo is empty, but _living_particles < _particle_pool_size" << endl;
+      return false;
+    }
+    #endif
 
-  pool_index = _free_particle_fifo.back();
-  _free_particle_fifo.pop_back();
+    pool_index = _free_particle_fifo.back();
+    _free_particle_fifo.pop_back();
 
-  // get a handle on our particle.
-  BaseParticle *bp = (BaseParticle *) _physics_objects[pool_index].p();
+    // get a handle on our particle.
+    bp = (BaseParticle *) _physics_objects[pool_index].p();
 
-  // start filling out the variables.
-  _factory->populate_particle(bp);
+    // start filling out the variables.
+    _factory->populate_particle(bp);
 
-  bp->set_alive(true);
-  bp->set_active(true);
-  bp->init();
+    bp->set_alive(true);
+    bp->set_active(true);
+    bp->init();
+  }
 
   // get the location of the new particle.
   LPoint3 new_pos, world_pos;
@@ -187,6 +193,13 @@ birth_particle() {
   if (_local_velocity_flag == false)
     new_vel = new_vel * birth_to_render_xform;
 
+  if (is_pooled()) {
+    _pool.reset_position(pool_index, world_pos);
+    _pool.set_velocity(pool_index, new_vel);
+    ++_living_particles;
+    return true;
+  }
+
   bp->reset_position(world_pos/* + (NORMALIZED_RAND() * new_vel)*/);
   if (_physical_orientation) {
     // This particle should match the orientation of our physical_np.
@@ -326,8 +339,6 @@ kill_particle(int pool_index) {
 void ParticleSystem::
 resize_pool(int size) {
   int i;
-  int delta = size - _particle_pool_size;
-  int po_delta = _particle_pool_size - _physics_objects.size();
 
   #ifdef PARTICLE_SYSTEM_RESIZE_POOL_SENTRIES
   cout << "resizing particle pool from " << _particle_pool_size
@@ -346,6 +357,24 @@ resize_pool(int size) {
     return;
   }
 
+  update_pool_mode();
+
+  if (is_pooled()) {
+    // The pool holds only the living particles, so there is nothing to
+    // allocate; just make sure the excess ones die.
+    _particle_pool_size = size;
+    while ((int)_pool.get_num_objects() > size) {
+      _pool.remove_object(_pool.get_num_objects() - 1);
+      _living_particles--;
+    }
+    _pool.reserve(size);
+    _renderer->resize_pool(_particle_pool_size);
+    return;
+  }
+
+  int delta = size - _particle_pool_size;
+  int po_delta = _particle_pool_size - _physics_objects.size();
+
   _particle_pool_size = size;
 
   // make sure the physics_objects array is OK
@@ -455,6 +484,110 @@ resize_pool(int size) {
   #endif
 }
 
+/**
+ * Called when the system is attached to a PhysicsManager, or the manager gets
+ * a new integrator, which may not be able to integrate the particle pool.
+ */
+void ParticleSystem::
+linear_integrator_changed() {
+  update_pool_mode();
+}
+
+/**
+ * Moves the particles into or out of the ParticlePool, according to whether
+ * the current factory, renderer, integrator and flags allow the system to be
+ * pooled.
+ */
+void ParticleSystem::
+update_pool_mode() {
+  if (_factory.is_null() || _renderer.is_null()) {
+    return;
+  }
+
+  // Until the system is attached to a PhysicsManager with an integrator, we
+  // can't tell; linear_integrator_changed() will be called when it is.
+  PhysicsManager *manager = get_physics_manager();
+  LinearIntegrator *integrator = (manager != nullptr) ? manager->get_linear_integrator() : nullptr;
+
+  bool pooled = particle_system_pool &&
+    _factory->can_use_pool() && _renderer->can_use_pool() &&
+    (integrator == nullptr || integrator->can_use_pool()) &&
+    !_spawn_on_death_flag && !_physical_orientation;
+  if (pooled == is_pooled()) {
+    return;
+  }
+
+  int i;
+
+  if (pooled) {
+    _pool.clear();
+    _pool.reserve(_particle_pool_size);
+
+    for (i = 0; i < (int)_physics_objects.size(); ++i) {
+      BaseParticle *bp = (BaseParticle *) _physics_objects[i].p();
+      if (!bp->get_alive()) {
+        continue;
+      }
+
+      int n = _pool.add_object();
+      _pool.reset_position(n, bp->get_last_position());
+      _pool.set_position(n, bp->get_position());
+      _pool.set_velocity(n, bp->get_velocity());
+      _pool.set_mass(n, bp->get_mass());
+      _pool.set_terminal_velocity(n, bp->get_terminal_velocity());
+      _pool.set_age(n, bp->get_age());
+      _pool.set_lifespan(n, bp->get_lifespan());
+      _pool.set_index(n, bp->get_index());
+    }
+
+    _living_particles = (int)_pool.get_num_objects();
+    clear_physics_objects();
+    _free_particle_fifo.clear();
+    _object_pool = &_pool;
+
+  } else {
+    _object_pool = nullptr;
+
+    int num_particles = (int)_pool.get_num_objects();
+    for (i = 0; i < _particle_pool_size; ++i) {
+      BaseParticle *new_particle = _factory->alloc_particle();
+      if (new_particle) {
+        _factory->populate_particle(new_particle);
+        _physics_objects.push_back(new_particle);
+      }
+    }
+
+    for (i = 0; i < (int)_physics_objects.size(); ++i) {
+      if (i >= num_particles) {
+        _free_particle_fifo.push_back(i);
+        continue;
+      }
+
+      BaseParticle *bp = (BaseParticle *) _physics_objects[i].p();
+      bp->set_lifespan(_pool.get_lifespan(i));
+      bp->set_mass(_pool.get_mass(i));
+      bp->set_terminal_velocity(_pool.get_terminal_velocity(i));
+      bp->set_alive(true);
+      bp->set_active(true);
+      bp->init();
+
+      bp->reset_position(_pool.get_last_position(i));
+      bp->set_position(_pool.get_position(i));
+      bp->set_velocity(_pool.get_velocity(i));
+      bp->set_age(_pool.get_age(i));
+
+      if (_pool.get_index(i) < 0) {
+        _renderer->birth_particle(i);
+      } else {
+        bp->set_index(_pool.get_index(i));
+      }
+    }
+
+    _living_particles = std::min(num_particles, (int)_physics_objects.size());
+    _pool.clear();
+  }
+}
+
 /**
  * Updates the particle system.  Call once per frame.
  */
@@ -472,7 +605,7 @@ update(PN_stdfloat dt) {
 
   #ifdef PSSANITYCHECK
   // check up on things
-  if (sanity_check()) return;
+  if (!is_pooled() && sanity_check()) return;
   #endif
 
   #ifdef PARTICLE_SYSTEM_UPDATE_SENTRIES
@@ -480,55 +613,58 @@ update(PN_stdfloat dt) {
        << ", live particles: " << _living_particles << endl;
   #endif
 
-  // run through the particle array
-  while (ttl_updates_left) {
-    current_index = index_counter;
-    index_counter++;
+  if (is_pooled()) {
+    update_pool(dt);
+  } else {
+    // run through the particle array
+    while (ttl_updates_left) {
+      current_index = index_counter;
+      index_counter++;
 
-    #ifdef PSDEBUG
-    if (current_index >= _particle_pool_size) {
-      cout << "ERROR: _living_particles is out of sync (too large)" << endl;
-      cout << "pool size: " << _particle_pool_size
-           << ", live particles: " << _living_particles
-           << ", updates left: " << ttl_updates_left << endl;
-      break;
-    }
-    #endif
+      #ifdef PSDEBUG
+      if (current_index >= _particle_pool_size) {
+        cout << "ERROR: _living_particles is out of sync (too large)" << endl;
+        cout << "pool size: " << _particle_pool_size
+             << ", live particles: " << _living_particles
+             << ", updates left: " << ttl_updates_left << endl;
+        break;
+      }
+      #endif
 
-    // get the current particle.
-    bp = (BaseParticle *) _physics_objects[current_index].p();
+      // get the current particle.
+      bp = (BaseParticle *) _physics_objects[current_index].p();
 
-    #ifdef PSDEBUG
-    if (!bp) {
-      cout << "NULL ptr at index " << current_index << endl;
-      continue;
-    }
-    #endif
+      #ifdef PSDEBUG
+      if (!bp) {
+        cout << "NULL ptr at index " << current_index << endl;
+        continue;
+      }
+      #endif
 
-    if (bp->get_alive() == false)
-      continue;
+      if (bp->get_alive() == false)
+        continue;
+
+      age = bp->get_age() + dt;
+      bp->set_age(age);
+
+      // cerr<<"bp->get_position().get_z() returning
+      // "<<bp->get_position().get_z()<<endl;
+      if (age >= bp->get_lifespan()) {
+        kill_particle(current_index);
+      } else if (get_floor_z() != -HUGE_VAL
+              && bp->get_position().get_z() <= get_floor_z()) {
+        // ...the particle is going under the floor.  Maybe tell the particle to
+        // bounce: bp->bounce()?
+        kill_particle(current_index);
+      } else {
+        bp->update();
+      }
 
-    age = bp->get_age() + dt;
-    bp->set_age(age);
-
-    // cerr<<"bp->get_position().get_z() returning
-    // "<<bp->get_position().get_z()<<endl;
-    if (age >= bp->get_lifespan()) {
-      kill_particle(current_index);
-    } else if (get_floor_z() != -HUGE_VAL
-            && bp->get_position().get_z() <= get_floor_z()) {
-      // ...the particle is going under the floor.  Maybe tell the particle to
-      // bounce: bp->bounce()?
-      kill_particle(current_index);
-    } else {
-      bp->update();
+      // break out early if we're lucky
+      ttl_updates_left--;
     }
-
-    // break out early if we're lucky
-    ttl_updates_left--;
   }
 
-
   // generate new particles if necessary.
   _tics_since_birth += dt;
 
@@ -543,6 +679,29 @@ update(PN_stdfloat dt) {
 
 }
 
+/**
+ * The update() of a pooled system.  The pool holds only living particles, and
+ * point particles have nothing to do in BaseParticle::update(), so this only
+ * needs to age the particles and remove the ones that die.
+ */
+void ParticleSystem::
+update_pool(PN_stdfloat dt) {
+  _pool.add_age(dt);
+
+  bool have_floor = (get_floor_z() != -HUGE_VAL);
+  size_t i = 0;
+  while (i < _pool.get_num_objects()) {
+    if (_pool.get_age(i) >= _pool.get_lifespan(i) ||
+        (have_floor && _pool.get_position(i).get_z() <= get_floor_z())) {
+      // The last particle is moved into this slot, so look at it again.
+      _pool.remove_object(i);
+      _living_particles--;
+    } else {
+      ++i;
+    }
+  }
+}
+
 #ifdef PSSANITYCHECK
 /**
  * Checks consistency of live particle count, free particle list, etc.
@@ -25,6 +25,7 @@
 #include "baseParticleRenderer.h"
 #include "baseParticleEmitter.h"
 #include "baseParticleFactory.h"
+#include "particlePool.h"
 
 class ParticleSystemManager;
 
@@ -86,6 +87,7 @@ PUBLISHED:
   INLINE PN_stdfloat get_floor_z() const;
   INLINE bool get_physical_orientation_flag() const;
   INLINE PN_stdfloat get_tics_since_birth() const;
+  INLINE bool is_pooled() const;
 
   // particle template vector
 
@@ -108,6 +110,9 @@ PUBLISHED:
 
   void birth_litter();
 
+protected:
+  virtual void linear_integrator_changed();
+
 private:
   #ifdef PSSANITYCHECK
   int sanity_check();
@@ -116,8 +121,11 @@ private:
   bool birth_particle();
   void kill_particle(int pool_index);
   void resize_pool(int size);
+  void update_pool_mode();
+  void update_pool(PN_stdfloat dt);
 
   pdeque< int > _free_particle_fifo;
+  ParticlePool _pool;
 
   int _particle_pool_size;
   int _living_particles;
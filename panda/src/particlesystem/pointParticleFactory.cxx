@@ -55,6 +55,15 @@ alloc_particle() const {
   return new PointParticle;
 }
 
+/**
+ * Point particles don't do anything in update(), so they can be kept in a
+ * ParticlePool.
+ */
+bool PointParticleFactory::
+can_use_pool() const {
+  return true;
+}
+
 /**
  * Write a string representation of this instance to <out>.
  */
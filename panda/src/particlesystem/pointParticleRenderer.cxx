@@ -119,10 +119,21 @@ kill_particle(int) {
  */
 LColor PointParticleRenderer::
 create_color(const BaseParticle *p) {
+  PN_stdfloat vel_t = 0.0f;
+  if (_blend_type == PP_BLEND_VEL) {
+    vel_t = p->get_parameterized_vel();
+  }
+  return create_color(p->get_parameterized_age(), vel_t);
+}
+
+/**
+ * Generates the point color based on the render_type, given the particle's
+ * parameterized age and velocity.  vel_t is only used for PP_BLEND_VEL.
+ */
+LColor PointParticleRenderer::
+create_color(PN_stdfloat parameterized_age, PN_stdfloat vel_t) {
   LColor color;
-  PN_stdfloat life_t, vel_t;
-  PN_stdfloat parameterized_age = 1.0f;
-  bool have_alpha_t = false;
+  PN_stdfloat life_t;
 
   switch (_blend_type) {
   case PP_ONE_COLOR:
@@ -132,9 +143,7 @@ create_color(const BaseParticle *p) {
 
   case PP_BLEND_LIFE:
     // Blending colors based on life
-    parameterized_age = p->get_parameterized_age();
     life_t = parameterized_age;
-    have_alpha_t = true;
 
     if (_blend_method == PP_BLEND_CUBIC) {
       life_t = CUBIC_T(life_t);
@@ -145,8 +154,6 @@ create_color(const BaseParticle *p) {
 
   case PP_BLEND_VEL:
     // Blending colors based on vel
-    vel_t = p->get_parameterized_vel();
-
     if (_blend_method == PP_BLEND_CUBIC) {
       vel_t = CUBIC_T(vel_t);
     }
@@ -160,10 +167,6 @@ create_color(const BaseParticle *p) {
     if (_alpha_mode == PR_ALPHA_USER) {
       parameterized_age = 1.0;
     } else {
-      if (!have_alpha_t) {
-        parameterized_age = p->get_parameterized_age();
-      }
-
       if (_alpha_mode == PR_ALPHA_OUT) {
         parameterized_age = 1.0f - parameterized_age;
       } else if (_alpha_mode == PR_ALPHA_IN_OUT) {
@@ -253,6 +256,78 @@ render(pvector< PT(PhysicsObject) >& po_vector, int ttl_particles) {
   get_render_node()->mark_internal_bounds_stale();
 }
 
+/**
+ * Point particles can be drawn straight from a ParticlePool.
+ */
+bool PointParticleRenderer::
+can_use_pool() const {
+  return true;
+}
+
+/**
+ * renders the particles of a ParticlePool out to the GeomNode, writing the
+ * vertex data directly from the pool's arrays.
+ */
+void PointParticleRenderer::
+render_pool(ParticlePool &pool) {
+  PStatTimer t1(_render_collector);
+
+  int num_particles = (int)pool.get_num_objects();
+
+  // If the vertex data isn't laid out the way RowWriter expects, write the
+  // rows one column at a time instead, as render() does.
+  RowWriter writer;
+  GeomVertexWriter vertex, color;
+  bool direct = writer.begin(_vdata, num_particles);
+  if (!direct) {
+    vertex = GeomVertexWriter(_vdata, InternalName::get_vertex());
+    color = GeomVertexWriter(_vdata, InternalName::get_color());
+  }
+
+  const PN_stdfloat *x = pool.get_position_array(0);
+  const PN_stdfloat *y = pool.get_position_array(1);
+  const PN_stdfloat *z = pool.get_position_array(2);
+
+  // init the aabb
+
+  _aabb_min.set(99999.0f, 99999.0f, 99999.0f);
+  _aabb_max.set(-99999.0f, -99999.0f, -99999.0f);
+
+  for (int i = 0; i < num_particles; ++i) {
+    _aabb_min.set(std::min(_aabb_min[0], x[i]),
+                  std::min(_aabb_min[1], y[i]),
+                  std::min(_aabb_min[2], z[i]));
+    _aabb_max.set(std::max(_aabb_max[0], x[i]),
+                  std::max(_aabb_max[1], y[i]),
+                  std::max(_aabb_max[2], z[i]));
+
+    PN_stdfloat vel_t = 0.0f;
+    if (_blend_type == PP_BLEND_VEL) {
+      vel_t = pool.get_parameterized_vel(i);
+    }
+
+    LColor c = create_color(pool.get_parameterized_age(i), vel_t);
+    if (direct) {
+      unsigned char *row = writer.get_row(i);
+      writer.set_vertex(row, x[i], y[i], z[i]);
+      writer.set_color(row, c);
+    } else {
+      vertex.add_data3(x[i], y[i], z[i]);
+      color.add_data4(c);
+    }
+  }
+
+  _points->clear_vertices();
+  _points->add_next_vertices(num_particles);
+
+  LPoint3 aabb_center = _aabb_min + ((_aabb_max - _aabb_min) * 0.5f);
+  PN_stdfloat radius = (aabb_center - _aabb_min).length();
+
+  BoundingSphere sphere(aabb_center, radius);
+  _point_primitive->set_bounds(&sphere);
+  get_render_node()->mark_internal_bounds_stale();
+}
+
 /**
  * Write a string representation of this instance to <out>.
  */
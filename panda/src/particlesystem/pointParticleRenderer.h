@@ -86,6 +86,7 @@ private:
   LPoint3 _aabb_max;
 
   LColor create_color(const BaseParticle *p);
+  LColor create_color(PN_stdfloat parameterized_age, PN_stdfloat vel_t);
 
   virtual void birth_particle(int index);
   virtual void kill_particle(int index);
@@ -94,6 +95,9 @@ private:
                       int ttl_particles);
   virtual void resize_pool(int new_size) final;
 
+  virtual bool can_use_pool() const;
+  virtual void render_pool(ParticlePool &pool);
+
   static PStatCollector _render_collector;
 };
 
@@ -541,7 +541,7 @@ render(pvector< PT(PhysicsObject) >& po_vector, int ttl_particles) {
 
   BaseParticle *cur_particle;
   int remaining_particles = ttl_particles;
-  int i,j;                                  // loop counters
+  int i;                                    // loop counter
   int anim_count = _anims.size();           // number of animations
   int frame;                                // frame index, used in indicating which frame to use when not animated
   // First, since this is the only time we have access to the actual
@@ -576,16 +576,10 @@ render(pvector< PT(PhysicsObject) >& po_vector, int ttl_particles) {
   // changed to only create writers for geoms that would be used according to
   // the animation configuration.
   for (i = 0; i < anim_count; ++i) {
-    for (j = 0; j < _anim_size[i]; ++j) {
-      // Set the particle per frame counts to 0.
-      memset(_ttl_count[i], 0, _anim_size[i]*sizeof(int));
-      _sprite_writer[i][j].vertex = GeomVertexWriter(_vdata[i][j], InternalName::get_vertex());
-      _sprite_writer[i][j].color = GeomVertexWriter(_vdata[i][j], InternalName::get_color());
-      _sprite_writer[i][j].rotate = GeomVertexWriter(_vdata[i][j], InternalName::get_rotate());
-      _sprite_writer[i][j].size = GeomVertexWriter(_vdata[i][j], InternalName::get_size());
-      _sprite_writer[i][j].aspect_ratio = GeomVertexWriter(_vdata[i][j], InternalName::get_aspect_ratio());
-    }
+    // Set the particle per frame counts to 0.
+    memset(_ttl_count[i], 0, _anim_size[i]*sizeof(int));
   }
+  init_writers();
 
   // init the aabb
   _aabb_min.set(99999.0f, 99999.0f, 99999.0f);
@@ -631,61 +625,15 @@ render(pvector< PT(PhysicsObject) >& po_vector, int ttl_particles) {
       cur_particle->set_index(anim_index);
     }
 
-    // Find the frame
-    if (_animate_frames) {
-      if (_animate_frames_rate == 0.0f) {
-        frame = (int)(t*_anim_size[anim_index]);
-      } else {
-        frame = (int)fmod(cur_particle->get_age()*_animate_frames_rate+1,_anim_size[anim_index]);
-      }
-    } else {
-      frame = _animate_frames_index;
-    }
-
-    // Quick check make sure our math above didn't result in an invalid frame.
-    frame = (frame < _anim_size[anim_index]) ? frame : (_anim_size[anim_index]-1);
+    frame = choose_frame(anim_index, t, cur_particle->get_age());
     ++_ttl_count[anim_index][frame];
 
-    // Calculate the color This is where we'll want to give the renderer the
-    // new color
-    LColor c = _color_interpolation_manager->generateColor(t);
-
-    int alphamode=get_alpha_mode();
-    if (alphamode != PR_ALPHA_NONE) {
-      if (alphamode == PR_ALPHA_OUT)
-        c[3] *= (1.0f - t) * get_user_alpha();
-      else if (alphamode == PR_ALPHA_IN)
-        c[3] *= t * get_user_alpha();
-      else if (alphamode == PR_ALPHA_IN_OUT) {
-        c[3] *= 2.0f * min(t, 1.0f - t) * get_user_alpha();
-      }
-      else {
-        assert(alphamode == PR_ALPHA_USER);
-        c[3] *= get_user_alpha();
-      }
-    }
-
     // Send the data on its way...
     _sprite_writer[anim_index][frame].vertex.add_data3(position);
-    _sprite_writer[anim_index][frame].color.add_data4(c);
-
-    PN_stdfloat current_x_scale = _initial_x_scale;
-    PN_stdfloat current_y_scale = _initial_y_scale;
+    _sprite_writer[anim_index][frame].color.add_data4(create_color(t));
 
-    if (_animate_x_ratio || _animate_y_ratio) {
-      if (_blend_method == PP_BLEND_CUBIC) {
-        t = CUBIC_T(t);
-      }
-
-      if (_animate_x_ratio) {
-        current_x_scale = (_initial_x_scale +
-                           (t * (_final_x_scale - _initial_x_scale)));
-      }
-      if (_animate_y_ratio) {
-        current_y_scale = (_initial_y_scale +
-                           (t * (_final_y_scale - _initial_y_scale)));
-      }
-    }
+    PN_stdfloat current_x_scale, current_y_scale;
+    get_scale(t, current_x_scale, current_y_scale);
 
     if (_sprite_writer[anim_index][frame].size.has_column()) {
       _sprite_writer[anim_index][frame].size.add_data1f(current_y_scale * _height);
@@ -705,6 +653,249 @@ render(pvector< PT(PhysicsObject) >& po_vector, int ttl_particles) {
       break;
     }
   }
+
+  update_geoms();
+}
+
+/**
+ * Renders the particles of a ParticlePool out to the GeomNode, writing the
+ * vertex data directly from the pool's arrays.
+ */
+void SpriteParticleRenderer::
+render_pool(ParticlePool &pool) {
+  PStatTimer t1(_render_collector);
+  // There is no texture data available, exit.
+  if (_anims.empty()) {
+    return;
+  }
+
+  int i, j, k;
+  int anim_count = _anims.size();
+  int num_particles = (int)pool.get_num_objects();
+
+  // Pooled particles aren't put on the birth list; a particle we haven't seen
+  // yet has an index of -1.  Give it a random animation, as render() does.
+  _birth_list.clear();
+  for (k = 0; k < num_particles; ++k) {
+    if (pool.get_index(k) < 0) {
+      i = int(NORMALIZED_RAND()*anim_count);
+      pool.set_index(k, i < anim_count?i:i-1);
+
+      if (_animate_frames) {
+        pool.set_age(k, pool.get_age(k)+i/10.0*pool.get_lifespan(k));
+      }
+    }
+  }
+
+  for (i = 0; i < anim_count; ++i) {
+    memset(_ttl_count[i], 0, _anim_size[i]*sizeof(int));
+  }
+
+  const PN_stdfloat *x = pool.get_position_array(0);
+  const PN_stdfloat *y = pool.get_position_array(1);
+  const PN_stdfloat *z = pool.get_position_array(2);
+
+  // init the aabb
+  _aabb_min.set(99999.0f, 99999.0f, 99999.0f);
+  _aabb_max.set(-99999.0f, -99999.0f, -99999.0f);
+
+  // First pass: find the geom each particle goes into, so that we know how
+  // many rows each one needs.
+  _pool_frame.resize(num_particles);
+  for (k = 0; k < num_particles; ++k) {
+    _aabb_min.set(std::min(_aabb_min[0], x[k]),
+                  std::min(_aabb_min[1], y[k]),
+                  std::min(_aabb_min[2], z[k]));
+    _aabb_max.set(std::max(_aabb_max[0], x[k]),
+                  std::max(_aabb_max[1], y[k]),
+                  std::max(_aabb_max[2], z[k]));
+
+    int anim_index = pool.get_index(k);
+    if (_animation_removed && (anim_index >= anim_count)) {
+      anim_index = int(NORMALIZED_RAND()*anim_count);
+      anim_index = anim_index<anim_count?anim_index:anim_index-1;
+      pool.set_index(k, anim_index);
+    }
+
+    int frame = choose_frame(anim_index, pool.get_parameterized_age(k), pool.get_age(k));
+    _pool_frame[k] = frame;
+    ++_ttl_count[anim_index][frame];
+  }
+
+  bool written = true;
+  {
+    // Second pass: write the rows.  The writers must be gone before
+    // update_geoms() hands the vertex datas back to the Geoms.
+    pvector<RowWriter> writers;
+    vector_int first_geom(anim_count);
+    int num_geoms = 0;
+    for (i = 0; i < anim_count; ++i) {
+      first_geom[i] = num_geoms;
+      num_geoms += _anim_size[i];
+    }
+    writers.resize(num_geoms);
+    vector_int num_rows(num_geoms, 0);
+
+    for (i = 0; i < anim_count && written; ++i) {
+      for (j = 0; j < _anim_size[i] && written; ++j) {
+        written = writers[first_geom[i] + j].begin(_vdata[i][j], _ttl_count[i][j]);
+      }
+    }
+
+    for (k = 0; k < num_particles && written; ++k) {
+      int anim_index = pool.get_index(k);
+      int frame = _pool_frame[k];
+      int geom = first_geom[anim_index] + frame;
+      const RowWriter &writer = writers[geom];
+      unsigned char *row = writer.get_row(num_rows[geom]++);
+
+      PN_stdfloat t = pool.get_parameterized_age(k);
+      writer.set_vertex(row, x[k], y[k], z[k]);
+      writer.set_color(row, create_color(t));
+
+      PN_stdfloat current_x_scale, current_y_scale;
+      get_scale(t, current_x_scale, current_y_scale);
+
+      if (writer.has_size()) {
+        writer.set_size(row, current_y_scale * _height);
+      }
+      if (writer.has_aspect_ratio()) {
+        writer.set_aspect_ratio(row, _aspect_ratio * current_x_scale / current_y_scale);
+      }
+      if (writer.has_rotate()) {
+        // Pooled particles are point particles, which don't spin.
+        writer.set_rotate(row, _animate_theta ? 0.0f : _theta);
+      }
+    }
+  }
+
+  if (!written) {
+    // The vertex data isn't laid out the way RowWriter expects, so write the
+    // rows one column at a time, as render() does.
+    init_writers();
+    for (k = 0; k < num_particles; ++k) {
+      SpriteWriter &writer = _sprite_writer[pool.get_index(k)][_pool_frame[k]];
+
+      PN_stdfloat t = pool.get_parameterized_age(k);
+      writer.vertex.add_data3(x[k], y[k], z[k]);
+      writer.color.add_data4(create_color(t));
+
+      PN_stdfloat current_x_scale, current_y_scale;
+      get_scale(t, current_x_scale, current_y_scale);
+
+      if (writer.size.has_column()) {
+        writer.size.add_data1f(current_y_scale * _height);
+      }
+      if (writer.aspect_ratio.has_column()) {
+        writer.aspect_ratio.add_data1f(_aspect_ratio * current_x_scale / current_y_scale);
+      }
+      if (writer.rotate.has_column()) {
+        writer.rotate.add_data1f(_animate_theta ? 0.0f : _theta);
+      }
+    }
+  }
+
+  update_geoms();
+}
+
+/**
+ * Returns the frame of the indicated animation to draw a particle with, given
+ * its parameterized age and its age in seconds.
+ */
+int SpriteParticleRenderer::
+choose_frame(int anim_index, PN_stdfloat t, PN_stdfloat age) const {
+  int frame;
+  if (_animate_frames) {
+    if (_animate_frames_rate == 0.0f) {
+      frame = (int)(t*_anim_size[anim_index]);
+    } else {
+      frame = (int)fmod(age*_animate_frames_rate+1,_anim_size[anim_index]);
+    }
+  } else {
+    frame = _animate_frames_index;
+  }
+
+  // Quick check make sure our math above didn't result in an invalid frame.
+  return (frame < _anim_size[anim_index]) ? frame : (_anim_size[anim_index]-1);
+}
+
+/**
+ * Calculates the color of a particle with the indicated parameterized age,
+ * including the alpha mode.
+ */
+LColor SpriteParticleRenderer::
+create_color(PN_stdfloat t) {
+  LColor c = _color_interpolation_manager->generateColor(t);
+
+  int alphamode=get_alpha_mode();
+  if (alphamode != PR_ALPHA_NONE) {
+    if (alphamode == PR_ALPHA_OUT)
+      c[3] *= (1.0f - t) * get_user_alpha();
+    else if (alphamode == PR_ALPHA_IN)
+      c[3] *= t * get_user_alpha();
+    else if (alphamode == PR_ALPHA_IN_OUT) {
+      c[3] *= 2.0f * min(t, 1.0f - t) * get_user_alpha();
+    }
+    else {
+      assert(alphamode == PR_ALPHA_USER);
+      c[3] *= get_user_alpha();
+    }
+  }
+  return c;
+}
+
+/**
+ * Calculates the x and y scale of a particle with the indicated parameterized
+ * age.
+ */
+void SpriteParticleRenderer::
+get_scale(PN_stdfloat t, PN_stdfloat &x_scale, PN_stdfloat &y_scale) const {
+  x_scale = _initial_x_scale;
+  y_scale = _initial_y_scale;
+
+  if (_animate_x_ratio || _animate_y_ratio) {
+    if (_blend_method == PP_BLEND_CUBIC) {
+      t = CUBIC_T(t);
+    }
+
+    if (_animate_x_ratio) {
+      x_scale = (_initial_x_scale +
+                 (t * (_final_x_scale - _initial_x_scale)));
+    }
+    if (_animate_y_ratio) {
+      y_scale = (_initial_y_scale +
+                 (t * (_final_y_scale - _initial_y_scale)));
+    }
+  }
+}
+
+/**
+ * Creates a GeomVertexWriter for each column of each of the geoms, starting
+ * at the first row.
+ */
+void SpriteParticleRenderer::
+init_writers() {
+  int anim_count = _anims.size();
+  for (int i = 0; i < anim_count; ++i) {
+    for (int j = 0; j < _anim_size[i]; ++j) {
+      _sprite_writer[i][j].vertex = GeomVertexWriter(_vdata[i][j], InternalName::get_vertex());
+      _sprite_writer[i][j].color = GeomVertexWriter(_vdata[i][j], InternalName::get_color());
+      _sprite_writer[i][j].rotate = GeomVertexWriter(_vdata[i][j], InternalName::get_rotate());
+      _sprite_writer[i][j].size = GeomVertexWriter(_vdata[i][j], InternalName::get_size());
+      _sprite_writer[i][j].aspect_ratio = GeomVertexWriter(_vdata[i][j], InternalName::get_aspect_ratio());
+    }
+  }
+}
+
+/**
+ * Hands the filled vertex datas back to the Geoms, sets up the primitives
+ * from the per-frame counts, and updates the bounds.  Called at the end of
+ * render() and render_pool().
+ */
+void SpriteParticleRenderer::
+update_geoms() {
+  int i, j;
+  int anim_count = _anims.size();
   int n = 0;
   GeomNode *render_node = get_render_node();
 
@@ -752,6 +943,14 @@ render(pvector< PT(PhysicsObject) >& po_vector, int ttl_particles) {
   _animation_removed = false;
 }
 
+/**
+ * Sprites can be drawn straight from a ParticlePool.
+ */
+bool SpriteParticleRenderer::
+can_use_pool() const {
+  return true;
+}
+
 /**
  * Write a string representation of this instance to <out>.
  */
@@ -263,11 +263,19 @@ private:
   virtual void render(pvector< PT(PhysicsObject) > &po_vector,
                       int ttl_particles);
   virtual void resize_pool(int new_size);
+  virtual bool can_use_pool() const;
+  virtual void render_pool(ParticlePool &pool);
+  int choose_frame(int anim_index, PN_stdfloat t, PN_stdfloat age) const;
+  LColor create_color(PN_stdfloat t);
+  void get_scale(PN_stdfloat t, PN_stdfloat &x_scale, PN_stdfloat &y_scale) const;
+  void init_writers();
+  void update_geoms();
   int extract_textures_from_node(const NodePath &node_path, NodePathCollection &np_col, TextureCollection &tex_col);
 
   vector_int _anim_size;   // Holds the number of frames in each animation.
   pvector<int*> _ttl_count;  // _ttl_count[i][j] holds the number of particles attached to animation 'i' at frame 'j'.
   vector_int _birth_list;  // Holds the list of particles that need a new random animation to start on.
+  vector_int _pool_frame;  // Scratch space for render_pool(), holds the frame of each pooled particle.
 
   static PStatCollector _render_collector;
 };
@@ -132,6 +132,40 @@ ConfigVariableBool debug_portal_cull
           "(You first need to enable portal culling, using the allow-portal-cull"
           "variable.)"));
 
+ConfigVariableBool parallel_cull_traverse
+("parallel-cull-traverse", false,
+ PRC_DESC("Set this true to let the CullTraverser split the children of "
+          "nodes with very many children into chunks, which are traversed "
+          "on the JobSystem's worker threads.  The objects found are still "
+          "passed to the CullHandler in the same order as in a serial "
+          "traversal.  Be sure that your cull callbacks are safe to be "
+          "called from several threads at once before enabling this."));
+
+ConfigVariableInt parallel_cull_min_children
+("parallel-cull-min-children", 256,
+ PRC_DESC("The number of children a node must have before its children are "
+          "traversed in parallel, when parallel-cull-traverse is enabled."));
+
+ConfigVariableInt parallel_cull_chunk_size
+("parallel-cull-chunk-size", 64,
+ PRC_DESC("The number of children that make up one job of a parallel cull "
+          "traversal.  See parallel-cull-traverse."));
+
+ConfigVariableInt cull_bin_radix_sort_threshold
+("cull-bin-radix-sort-threshold", 128,
+ PRC_DESC("The sorting cull bins (state_sorted, back_to_front, front_to_back "
+          "and fixed) sort their objects with a radix sort on a 64-bit key "
+          "once they contain at least this many objects.  Smaller bins use a "
+          "comparison sort.  Set this to a very large number to disable the "
+          "radix sort altogether."));
+
+ConfigVariableInt cull_result_cache_pages
+("cull-result-cache-pages", 256,
+ PRC_DESC("The maximum number of pages of CullableObjects that are kept "
+          "around after a frame has been drawn, to be reused for the cull "
+          "results of a subsequent frame rather than freed and allocated "
+          "anew.  Each page holds 64 objects."));
+
 ConfigVariableBool show_occluder_volumes
 ("show-occluder-volumes", false,
  PRC_DESC("Set this true to enable debug visualization of the volumes used "
@@ -206,6 +240,47 @@ ConfigVariableDouble garbage_collect_states_rate
           "performance if states accumulate faster than they can be "
           "cleaned up."));
 
+ConfigVariableInt garbage_collect_states_shards
+("garbage-collect-states-shards", 0,
+ PRC_DESC("The table of unique TransformStates (and RenderStates) is split "
+          "into a number of shards, each with its own lock.  This is the "
+          "number of those shards that are visited by each garbage "
+          "collection step; the next step picks up where the previous one "
+          "left off.  Set this to 1 to collect only one shard per frame, "
+          "which spreads the cost of garbage collection over several "
+          "frames.  The default, 0, visits all of the shards every time."));
+
+ConfigVariableDouble garbage_collect_states_budget
+("garbage-collect-states-budget", 0.0,
+ PRC_DESC("The maximum amount of time, in milliseconds, that a single call to "
+          "TransformState::garbage_collect() or RenderState::garbage_collect() "
+          "may spend.  When the time runs out, the collector stops and "
+          "continues where it left off the next frame, so that releasing a "
+          "large number of states at once does not cause a frame spike.  "
+          "Set this to 0 to let each collection step run to completion."));
+
+ConfigVariableInt garbage_collect_states_old_age
+("garbage-collect-states-old-age", 8,
+ PRC_DESC("The number of garbage collection sweeps a TransformState or "
+          "RenderState must survive before it is considered long-lived.  "
+          "Long-lived states are only examined once every "
+          "garbage-collect-states-old-interval sweeps, since they are "
+          "unlikely to be released soon.  Set this to 0 to examine every "
+          "state on every sweep."));
+
+ConfigVariableInt garbage_collect_states_old_interval
+("garbage-collect-states-old-interval", 4,
+ PRC_DESC("See garbage-collect-states-old-age."));
+
+ConfigVariableBool thread_composition_cache
+("thread-composition-cache", true,
+ PRC_DESC("Set this true to let each thread keep a small cache of the "
+          "TransformState and RenderState compositions it has recently "
+          "computed, which is checked before the global composition cache.  "
+          "This avoids grabbing the global state lock for the most common "
+          "compositions, which reduces lock contention when several threads "
+          "are composing states at the same time."));
+
 ConfigVariableBool transform_cache
 ("transform-cache", true,
  PRC_DESC("Set this true to enable the cache of TransformState objects.  "
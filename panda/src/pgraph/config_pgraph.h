@@ -34,6 +34,11 @@ extern EXPCL_PANDA_PGRAPH ConfigVariableBool fake_view_frustum_cull;
 extern ConfigVariableBool clip_plane_cull;
 extern ConfigVariableBool allow_portal_cull;
 extern ConfigVariableBool debug_portal_cull;
+extern ConfigVariableBool parallel_cull_traverse;
+extern ConfigVariableInt parallel_cull_min_children;
+extern ConfigVariableInt parallel_cull_chunk_size;
+extern ConfigVariableInt cull_bin_radix_sort_threshold;
+extern ConfigVariableInt cull_result_cache_pages;
 extern ConfigVariableBool show_occluder_volumes;
 extern ConfigVariableBool unambiguous_graph;
 extern ConfigVariableBool detect_graph_cycles;
@@ -45,6 +50,11 @@ extern ConfigVariableBool paranoid_const;
 extern ConfigVariableBool auto_break_cycles;
 extern EXPCL_PANDA_PGRAPH ConfigVariableBool garbage_collect_states;
 extern ConfigVariableDouble garbage_collect_states_rate;
+extern ConfigVariableInt garbage_collect_states_shards;
+extern ConfigVariableDouble garbage_collect_states_budget;
+extern ConfigVariableInt garbage_collect_states_old_age;
+extern ConfigVariableInt garbage_collect_states_old_interval;
+extern ConfigVariableBool thread_composition_cache;
 extern ConfigVariableBool transform_cache;
 extern ALIGN_16BYTE EXPCL_PANDA_PGRAPH ConfigVariableBool state_cache;
 extern ConfigVariableBool uniquify_transforms;
@@ -19,6 +19,8 @@
 #include "decalEffect.h"
 #include "string_utils.h"
 
+#include <algorithm>
+
 PStatCollector CullBin::_cull_bin_pcollector("Cull:Sort");
 
 TypeHandle CullBin::_type_handle;
@@ -53,6 +55,75 @@ void CullBin::
 finish_cull(SceneSetup *, Thread *) {
 }
 
+/**
+ * Sorts the objects in ascending order of their sort keys.  This is a stable
+ * sort: objects with the same key remain in the order in which they were
+ * added to the bin.
+ */
+void CullBin::
+sort_objects(SortedObjects &objects) {
+  if (objects.size() < (size_t)std::max(cull_bin_radix_sort_threshold.get_value(), 2)) {
+    std::stable_sort(objects.begin(), objects.end());
+  } else {
+    radix_sort(objects);
+  }
+}
+
+/**
+ * Implements sort_objects() for larger bins.  This is a least-significant
+ * digit radix sort on 8-bit digits.  The histograms for all digits are
+ * counted in a single pass up front, so that digits which are the same for
+ * all objects (which is typically most of them) can be skipped entirely.
+ */
+void CullBin::
+radix_sort(SortedObjects &objects) {
+  static const int num_digits = sizeof(uint64_t);
+  size_t size = objects.size();
+
+  uint32_t counts[num_digits][256];
+  memset(counts, 0, sizeof(counts));
+
+  for (const SortedObject &object : objects) {
+    uint64_t key = object._sort_key;
+    for (int d = 0; d < num_digits; ++d) {
+      ++counts[d][(key >> (d * 8)) & 0xff];
+    }
+  }
+
+  _sort_scratch.resize(size, SortedObject(nullptr, 0));
+  SortedObject *from = objects.data();
+  SortedObject *to = _sort_scratch.data();
+
+  for (int d = 0; d < num_digits; ++d) {
+    uint32_t *digit_counts = counts[d];
+    int shift = d * 8;
+    if (digit_counts[(from[0]._sort_key >> shift) & 0xff] == size) {
+      // All objects have the same value for this digit.
+      continue;
+    }
+
+    // Turn the counts into starting offsets.
+    uint32_t offset = 0;
+    for (int i = 0; i < 256; ++i) {
+      uint32_t count = digit_counts[i];
+      digit_counts[i] = offset;
+      offset += count;
+    }
+
+    for (size_t i = 0; i < size; ++i) {
+      const SortedObject &object = from[i];
+      to[digit_counts[(object._sort_key >> shift) & 0xff]++] = object;
+    }
+    std::swap(from, to);
+  }
+
+  if (from != objects.data()) {
+    // We did an odd number of passes, so the result is in the scratch array.
+    // The old array becomes the scratch array for next time.
+    objects.swap(_sort_scratch);
+  }
+}
+
 /**
  * Returns a special scene graph constructed to represent the results of the
  * cull.  This will be a single node with a list of GeomNode children, which
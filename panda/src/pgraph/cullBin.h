@@ -65,6 +65,30 @@ protected:
   class ResultGraphBuilder;
   virtual void fill_result_graph(ResultGraphBuilder &builder)=0;
 
+  // An object along with the 64-bit key that determines its place in the
+  // sorted bin.  Objects are drawn in ascending order of their key; objects
+  // with an identical key are kept in the order in which they were added.
+  class SortedObject {
+  public:
+    INLINE SortedObject(CullableObject *object, uint64_t sort_key);
+    INLINE bool operator < (const SortedObject &other) const;
+
+    CullableObject *_object;
+    uint64_t _sort_key;
+  };
+  typedef pvector<SortedObject> SortedObjects;
+
+  void sort_objects(SortedObjects &objects);
+  INLINE static uint64_t get_float_sort_key(PN_stdfloat value);
+
+  // Used by radix_sort().  This is kept from one sort to the next, and
+  // handed on to the bin that replaces this one in the next frame, so that
+  // it does not need to be reallocated for every sort.
+  mutable SortedObjects _sort_scratch;
+
+private:
+  void radix_sort(SortedObjects &objects);
+
 private:
   void check_flash_color();
 
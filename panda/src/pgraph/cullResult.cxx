@@ -29,6 +29,11 @@
 #include "depthOffsetAttrib.h"
 #include "colorBlendAttrib.h"
 #include "shaderAttrib.h"
+#include "lightMutexHolder.h"
+
+CullResult::AllocationPage *CullResult::_free_pages = nullptr;
+size_t CullResult::_num_free_pages = 0;
+LightMutex CullResult::_free_pages_lock("CullResult::_free_pages_lock");
 
 TypeHandle CullResult::_type_handle;
 
@@ -365,29 +370,84 @@ make_new_bin(int bin_index) {
 }
 
 /**
- * Creates a new AllocationPage replacing the old one.
+ * Creates a new AllocationPage replacing the old one.  If another CullResult
+ * has left a page behind, that one is reused instead of allocating a new one.
  */
 CullResult::AllocationPage *CullResult::
 new_page() {
-  AllocationPage *page = new AllocationPage;
+  AllocationPage *page;
+  {
+    LightMutexHolder holder(_free_pages_lock);
+    page = _free_pages;
+    if (page != nullptr) {
+      _free_pages = page->_next;
+      --_num_free_pages;
+    }
+  }
+  if (page == nullptr) {
+    page = new AllocationPage;
+  }
   page->_next = _page;
   _page = page;
   return page;
 }
 
 /**
- *
+ * Destructs the objects on the indicated page and all the pages following
+ * it.  The pages other than the first page are handed back to the pool of
+ * free pages, up to the limit set by cull-result-cache-pages.
  */
 void CullResult::
 delete_page(AllocationPage *page) {
-  size_t size = std::exchange(page->_size, 0);
-  for (size_t i = 0; i < size; ++i) {
-    ((CullableObject *)page->_memory)[i].~CullableObject();
+  AllocationPage *released = nullptr;
+  AllocationPage *last_released = nullptr;
+  size_t num_released = 0;
+
+  while (page != nullptr) {
+    size_t size = std::exchange(page->_size, 0);
+    for (size_t i = 0; i < size; ++i) {
+      ((CullableObject *)page->_memory)[i].~CullableObject();
+    }
+    AllocationPage *next = page->_next;
+    if (next != nullptr) {
+      // Every page but the last one in the chain was allocated by new_page().
+      page->_next = released;
+      if (released == nullptr) {
+        last_released = page;
+      }
+      released = page;
+      ++num_released;
+    }
+    page = next;
   }
-  AllocationPage *next = page->_next;
-  if (next != nullptr) {
-    delete_page(next);
-    delete page;
+
+  if (released == nullptr) {
+    return;
+  }
+
+  {
+    LightMutexHolder holder(_free_pages_lock);
+    size_t max_pages = (size_t)std::max(cull_result_cache_pages.get_value(), 0);
+    if (_num_free_pages + num_released <= max_pages) {
+      last_released->_next = _free_pages;
+      _free_pages = released;
+      _num_free_pages += num_released;
+      return;
+    }
+
+    while (_num_free_pages < max_pages) {
+      AllocationPage *next = released->_next;
+      released->_next = _free_pages;
+      _free_pages = released;
+      ++_num_free_pages;
+      released = next;
+    }
+  }
+
+  while (released != nullptr) {
+    AllocationPage *next = released->_next;
+    delete released;
+    released = next;
   }
 }
 
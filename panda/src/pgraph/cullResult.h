@@ -26,6 +26,7 @@
 #include "pset.h"
 #include "pmap.h"
 #include "rescaleNormalAttrib.h"
+#include "lightMutex.h"
 
 class CullTraverser;
 class GraphicsStateGuardianBase;
@@ -104,6 +105,12 @@ private:
   AllocationPage *_page;
   AllocationPage _first_page;
 
+  // Pages released by CullResults that have been drawn, waiting to be reused
+  // by the CullResult of a subsequent frame.
+  static AllocationPage *_free_pages;
+  static size_t _num_free_pages;
+  static LightMutex _free_pages_lock;
+
 public:
   static TypeHandle get_class_type() {
     return _type_handle;
@@ -35,6 +35,21 @@
 #include "geomLinestrips.h"
 #include "geomLines.h"
 #include "geomVertexWriter.h"
+#include "jobSystem.h"
+
+/**
+ * Collects the objects found by one chunk of a parallel traversal, so that
+ * they can be passed on to the real CullHandler in the right order.
+ */
+class CullHandlerBuffer : public CullHandler {
+public:
+  virtual void record_object(CullableObject &&object,
+                             const CullTraverser *traverser) {
+    _objects.push_back(std::move(object));
+  }
+
+  pvector<CullableObject> _objects;
+};
 
 PStatCollector CullTraverser::_nodes_pcollector("Nodes");
 PStatCollector CullTraverser::_geom_nodes_pcollector("Nodes:GeomNodes");
@@ -233,11 +248,96 @@ do_traverse(CullTraverserData &data) {
   // Now visit all the node's children.
   PandaNode::Children children = node_reader->get_children();
   node_reader->release();
+  traverse_children(data, children);
+}
+
+/**
+ * Calls traverse_down on each of the indicated children of the given
+ * node/data.  If parallel-cull-traverse is enabled and there are enough
+ * children, they are traversed in parallel.
+ */
+void CullTraverser::
+traverse_children(const CullTraverserData &data,
+                  const PandaNode::Children &children) {
   int num_children = children.get_num_children();
+  if (parallel_cull_traverse && num_children >= parallel_cull_min_children &&
+      _portal_clipper == nullptr && make_worker_traverser() != nullptr) {
+    traverse_children_parallel(data, children);
+    return;
+  }
+
   for (int i = 0; i < num_children; ++i) {
-    const PandaNode::DownConnection &child = children.get_child_connection(i);
-    traverse_down(data, child, data._state);
+    traverse_down(data, children.get_child_connection(i), data._state);
+  }
+}
+
+/**
+ * Traverses the indicated children of the given node/data on the JobSystem's
+ * worker threads, in chunks of parallel-cull-chunk-size children.  Each chunk
+ * is traversed by a copy of this traverser that records its objects into its
+ * own buffer.  The buffers are then passed on to this traverser's CullHandler
+ * in chunk order, so the CullHandler sees exactly the same sequence of
+ * objects that a serial traversal would have produced.
+ */
+void CullTraverser::
+traverse_children_parallel(const CullTraverserData &data,
+                           const PandaNode::Children &children) {
+  int num_children = children.get_num_children();
+  int chunk_size = std::max((int)parallel_cull_chunk_size, 1);
+  int num_chunks = (num_children + chunk_size - 1) / chunk_size;
+
+  pvector<CullHandlerBuffer> buffers(num_chunks);
+  int pipeline_stage = _current_thread->get_pipeline_stage();
+
+  JobSystem::get_global_ptr()->parallel_process(num_chunks,
+    [&] (size_t begin, size_t end) {
+      PT(CullTraverser) worker = make_worker_traverser();
+      nassertv(worker != nullptr);
+
+      Thread *thread = Thread::get_current_thread();
+      int prev_stage = thread->get_pipeline_stage();
+      if (prev_stage != pipeline_stage) {
+        thread->set_pipeline_stage(pipeline_stage);
+      }
+      worker->_current_thread = thread;
+
+      for (size_t ci = begin; ci < end; ++ci) {
+        worker->_cull_handler = &buffers[ci];
+        int first = (int)ci * chunk_size;
+        int last = std::min(first + chunk_size, num_children);
+        for (int i = first; i < last; ++i) {
+          worker->traverse_down(data, children.get_child_connection(i), data._state);
+        }
+      }
+
+      if (prev_stage != pipeline_stage) {
+        thread->set_pipeline_stage(prev_stage);
+      }
+    });
+
+  for (CullHandlerBuffer &buffer : buffers) {
+    for (CullableObject &object : buffer._objects) {
+      _cull_handler->record_object(std::move(object), this);
+    }
+  }
+}
+
+/**
+ * Returns a new traverser that continues this traversal on another thread,
+ * or NULL if this traverser cannot be split up, in which case the children
+ * are traversed serially.
+ *
+ * Subclasses may carry state through the traversal or change the way the
+ * scene is traversed, which a plain copy of the CullTraverser would lose, so
+ * this returns NULL for any subclass.  A subclass that can be traversed in
+ * parallel should override this to return a copy of the same type.
+ */
+PT(CullTraverser) CullTraverser::
+make_worker_traverser() {
+  if (get_type() != CullTraverser::get_class_type()) {
+    return nullptr;
   }
+  return new CullTraverser(*this);
 }
 
 /**
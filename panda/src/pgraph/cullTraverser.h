@@ -104,6 +104,12 @@ public:
                     const TransformState *net_transform,
                     const RenderState *state);
 
+  void traverse_children(const CullTraverserData &data,
+                         const PandaNode::Children &children);
+
+protected:
+  virtual PT(CullTraverser) make_worker_traverser();
+
 public:
   // Statistics
   static PStatCollector _nodes_pcollector;
@@ -113,6 +119,9 @@ public:
   static PStatCollector _geoms_occluded_pcollector;
 
 private:
+  void traverse_children_parallel(const CullTraverserData &data,
+                                  const PandaNode::Children &children);
+
   void show_bounds(CullTraverserData &data, bool tight);
   static PT(Geom) make_bounds_viz(const BoundingVolume *vol);
   PT(Geom) make_tight_bounds_viz(PandaNode *node) const;
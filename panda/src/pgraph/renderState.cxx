@@ -35,14 +35,17 @@
 #include "lightMutexHolder.h"
 #include "thread.h"
 #include "renderAttribRegistry.h"
+#include "threadCompositionCache.h"
+#include "trueClock.h"
 
 using std::ostream;
 
 LightReMutex *RenderState::_states_lock = nullptr;
-RenderState::States RenderState::_states;
+RenderState::StateShard *RenderState::_shards = nullptr;
+RenderState::FreeList *RenderState::_free_list = nullptr;
 const RenderState *RenderState::_empty_state = nullptr;
 UpdateSeq RenderState::_last_cycle_detect;
-size_t RenderState::_garbage_index = 0;
+size_t RenderState::_garbage_shard = 0;
 
 PStatCollector RenderState::_cache_update_pcollector("*:State Cache:Update");
 PStatCollector RenderState::_garbage_collect_pcollector("*:State Cache:Garbage Collect");
@@ -50,6 +53,9 @@ PStatCollector RenderState::_state_compose_pcollector("*:State Cache:Compose Sta
 PStatCollector RenderState::_state_invert_pcollector("*:State Cache:Invert State");
 PStatCollector RenderState::_node_counter("RenderStates:On nodes");
 PStatCollector RenderState::_cache_counter("RenderStates:Cached");
+PStatCollector RenderState::_freed_counter("RenderStates:Freed");
+PStatCollector RenderState::_pending_free_counter("RenderStates:Pending free");
+PStatCollector RenderState::_collect_time_counter("RenderStates:Collect time");
 PStatCollector RenderState::_state_break_cycles_pcollector("*:State Cache:Break Cycles");
 PStatCollector RenderState::_state_validate_pcollector("*:State Cache:Validate");
 
@@ -358,6 +364,13 @@ compose(const RenderState *other) const {
     return do_compose(other);
   }
 
+  // Check this thread's own cache first, which doesn't need the lock.
+  CPT(RenderState) cached =
+    ThreadCompositionCache<RenderState>::find(this, other, false);
+  if (cached != nullptr) {
+    return cached;
+  }
+
   LightReMutexHolder holder(*_states_lock);
 
   // Is this composition already cached?
@@ -379,6 +392,7 @@ compose(const RenderState *other) const {
     }
     // Here's the cache!
     _cache_stats.inc_hits();
+    ThreadCompositionCache<RenderState>::store(this, other, false, comp._result);
     return comp._result;
   }
   _cache_stats.inc_misses();
@@ -415,6 +429,7 @@ compose(const RenderState *other) const {
 
   _cache_stats.maybe_report("RenderState");
 
+  ThreadCompositionCache<RenderState>::store(this, other, false, result);
   return result;
 }
 
@@ -447,6 +462,12 @@ invert_compose(const RenderState *other) const {
     return do_invert_compose(other);
   }
 
+  CPT(RenderState) cached =
+    ThreadCompositionCache<RenderState>::find(this, other, true);
+  if (cached != nullptr) {
+    return cached;
+  }
+
   LightReMutexHolder holder(*_states_lock);
 
   // Is this composition already cached?
@@ -468,6 +489,7 @@ invert_compose(const RenderState *other) const {
     }
     // Here's the cache!
     _cache_stats.inc_hits();
+    ThreadCompositionCache<RenderState>::store(this, other, true, comp._result);
     return comp._result;
   }
   _cache_stats.inc_misses();
@@ -501,6 +523,7 @@ invert_compose(const RenderState *other) const {
     // referential leak.)
   }
 
+  ThreadCompositionCache<RenderState>::store(this, other, true, result);
   return result;
 }
 
@@ -716,8 +739,16 @@ get_max_priority() {
  */
 int RenderState::
 get_num_states() {
-  LightReMutexHolder holder(*_states_lock);
-  return _states.get_num_entries();
+  if (_states_lock == nullptr) {
+    init_states();
+  }
+  size_t num_states = 0;
+  for (size_t n = 0; n < num_shards; ++n) {
+    StateShard &shard = _shards[n];
+    LightReMutexHolder holder(shard._lock);
+    num_states += shard._states.get_num_entries();
+  }
+  return (int)num_states;
 }
 
 /**
@@ -742,9 +773,9 @@ get_num_unused_states() {
   typedef pmap<const RenderState *, int> StateCount;
   StateCount state_count;
 
-  size_t size = _states.get_num_entries();
-  for (size_t si = 0; si < size; ++si) {
-    const RenderState *state = _states.get_key(si);
+  pvector<const RenderState *> states;
+  get_states_snapshot(states);
+  for (const RenderState *state : states) {
 
     std::pair<StateCount::iterator, bool> ir =
       state_count.insert(StateCount::value_type(state, 1));
@@ -826,20 +857,23 @@ clear_cache() {
   LightReMutexHolder holder(*_states_lock);
 
   PStatTimer timer(_cache_update_pcollector);
-  int orig_size = _states.get_num_entries();
+  int orig_size = get_num_states();
+
+  // The threads' own caches hold references too.
+  ThreadCompositionCache<RenderState>::flush();
 
   // First, we need to copy the entire set of states to a temporary vector,
   // reference-counting each object.  That way we can walk through the copy,
   // without fear of dereferencing (and deleting) the objects in the map as we
   // go.
   {
+    pvector<const RenderState *> states;
+    get_states_snapshot(states);
+
     typedef pvector< CPT(RenderState) > TempStates;
     TempStates temp_states;
-    temp_states.reserve(orig_size);
-
-    size_t size = _states.get_num_entries();
-    for (size_t si = 0; si < size; ++si) {
-      const RenderState *state = _states.get_key(si);
+    temp_states.reserve(states.size());
+    for (const RenderState *state : states) {
       temp_states.push_back(state);
     }
 
@@ -878,7 +912,10 @@ clear_cache() {
     // the various objects' caches will go away.
   }
 
-  int new_size = _states.get_num_entries();
+  // Also destroy the states that the garbage collector has left over.
+  free_unused_states(0.0);
+
+  int new_size = get_num_states();
   return orig_size - new_size;
 }
 
@@ -898,21 +935,93 @@ garbage_collect() {
     return num_attribs;
   }
 
-  LightReMutexHolder holder(*_states_lock);
-
   PStatTimer timer(_garbage_collect_pcollector);
-  size_t orig_size = _states.get_num_entries();
+
+  // If we have a time budget, we stop when it runs out, and continue where
+  // we left off on the next call.
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double start_time = clock->get_short_time();
+  double deadline = 0.0;
+  if (garbage_collect_states_budget > 0.0) {
+    deadline = start_time + garbage_collect_states_budget * 0.001;
+  }
+
+  int num_collected = 0;
+  {
+    LightReMutexHolder holder(*_states_lock);
+
+    // Release the states that are only still referenced by some thread's
+    // composition cache, so that they can be collected below.
+    ThreadCompositionCache<RenderState>::flush();
+
+    bool break_and_uniquify = (auto_break_cycles && uniquify_transforms);
+
+    // How many shards to visit this pass?  We continue where the last pass
+    // left off.
+    size_t num_shards_this_pass = num_shards;
+    int shards_per_pass = garbage_collect_states_shards;
+    if (shards_per_pass > 0 && (size_t)shards_per_pass < num_shards) {
+      num_shards_this_pass = (size_t)shards_per_pass;
+    }
+
+    for (size_t i = 0; i < num_shards_this_pass; ++i) {
+      StateShard &shard = _shards[_garbage_shard];
+      bool finished = true;
+      num_collected += garbage_collect_shard(shard, break_and_uniquify,
+                                             deadline, finished);
+      if (!finished) {
+        // Out of time; we'll pick up in the middle of this shard.
+        break;
+      }
+      _garbage_shard = (_garbage_shard + 1) % num_shards;
+    }
+  }
+
+  // The states we removed above are destroyed without holding the lock, so
+  // that other threads can go on making states in the meantime.
+  int num_freed = free_unused_states(deadline);
+
+  _freed_counter.set_level(num_freed);
+  _collect_time_counter.set_level((clock->get_short_time() - start_time) * 1000.0);
+
+  return num_collected + num_attribs;
+}
+
+/**
+ * Performs a garbage-collection step on one shard of the state table.  The
+ * states that are found to be unused are removed from the table and added to
+ * the free list.  Returns the number of states that were removed.
+ *
+ * If deadline is nonzero, this stops when the clock reaches it, and sets
+ * finished to false; the next call continues at the same place.
+ *
+ * You must already be holding _states_lock before you call this method.
+ */
+int RenderState::
+garbage_collect_shard(StateShard &shard, bool break_and_uniquify,
+                      double deadline, bool &finished) {
+  LightReMutexHolder holder(shard._lock);
+
+  size_t orig_size = shard._states.get_num_entries();
 
   // How many elements to process this pass?
   size_t size = orig_size;
   size_t num_this_pass = std::max(0, int(size * garbage_collect_states_rate));
   if (num_this_pass <= 0) {
-    return num_attribs;
+    return 0;
   }
 
-  bool break_and_uniquify = (auto_break_cycles && uniquify_transforms);
+  // States that have survived a number of sweeps are likely to stay around
+  // for a good while longer, so we only look at them every so often.
+  unsigned int old_age = (unsigned int)std::max(0, (int)garbage_collect_states_old_age);
+  int old_interval = garbage_collect_states_old_interval;
+  bool skip_old = (old_age > 0 && old_interval > 1 &&
+                   (shard._num_sweeps % (unsigned int)old_interval) != 0);
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  size_t num_visited = 0;
 
-  size_t si = _garbage_index;
+  size_t si = shard._garbage_index;
   if (si >= size) {
     si = 0;
   }
@@ -921,7 +1030,23 @@ garbage_collect() {
   size_t stop_at_element = (si + num_this_pass) % size;
 
   do {
-    RenderState *state = (RenderState *)_states.get_key(si);
+    // Checking the clock isn't free, so we only do it every so often.
+    if (deadline != 0.0 && (++num_visited & 0x3f) == 0 &&
+        clock->get_short_time() >= deadline) {
+      finished = false;
+      break;
+    }
+
+    RenderState *state = (RenderState *)shard._states.get_key(si);
+    if (skip_old && state->_gc_age >= old_age) {
+      // A long-lived state; leave it for a later sweep.
+      if (si + 1 == size) {
+        ++shard._num_sweeps;
+      }
+      si = (si + 1) % size;
+      continue;
+    }
+
     if (break_and_uniquify) {
       if (state->get_cache_ref_count() > 0 &&
           state->get_ref_count() == state->get_cache_ref_count()) {
@@ -936,7 +1061,7 @@ garbage_collect() {
     if (!state->unref_if_one()) {
       // This state has recently been unreffed to 1 (the one we added when
       // we stored it in the cache).  Now it's time to delete it.  This is
-      // safe, because we're holding the _states_lock, so it's not possible
+      // safe, because we're holding the shard's lock, so it's not possible
       // for some other thread to find the state in the cache and ref it
       // while we're doing this.  Also, we've just made sure to unref it to 0,
       // to ensure that another thread can't get it via a weak pointer.
@@ -944,7 +1069,7 @@ garbage_collect() {
       state->release_new();
       state->remove_cache_pointers();
       state->cache_unref_only();
-      delete state;
+      _free_list->push_back(state);
 
       // When we removed it from the hash map, it swapped the last element
       // with the one we just removed.  So the current index contains one we
@@ -954,23 +1079,67 @@ garbage_collect() {
       if (stop_at_element > 0) {
         --stop_at_element;
       }
+      if (size == 0) {
+        // That was the last one in this shard.
+        si = 0;
+        ++shard._num_sweeps;
+        break;
+      }
+    } else if (state->_gc_age < old_age) {
+      ++state->_gc_age;
     }
 
+    if (si + 1 == size) {
+      ++shard._num_sweeps;
+    }
     si = (si + 1) % size;
   } while (si != stop_at_element);
-  _garbage_index = si;
+  shard._garbage_index = si;
 
-  nassertr(_states.get_num_entries() == size, 0);
+  nassertr(shard._states.get_num_entries() == size, 0);
 
 #ifdef _DEBUG
-  nassertr(_states.validate(), 0);
+  nassertr(shard._states.validate(), 0);
 #endif
 
   // If we just cleaned up a lot of states, see if we can reduce the table in
   // size.  This will help reduce iteration overhead in the future.
-  _states.consider_shrink_table();
+  shard._states.consider_shrink_table();
+
+  return (int)orig_size - (int)size;
+}
+
+/**
+ * Destroys the states that garbage collection has removed from the cache, as
+ * many as fit in the time budget (if deadline is nonzero).  The rest are left
+ * for the next call.  Returns the number of states that were destroyed.
+ */
+int RenderState::
+free_unused_states(double deadline) {
+  FreeList free_list;
+  {
+    LightReMutexHolder holder(*_states_lock);
+    free_list.swap(*_free_list);
+  }
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  size_t num_freed = 0;
+  while (num_freed < free_list.size()) {
+    if (deadline != 0.0 && num_freed != 0 && (num_freed & 0x3f) == 0 &&
+        clock->get_short_time() >= deadline) {
+      break;
+    }
+    delete free_list[num_freed++];
+  }
 
-  return (int)orig_size - (int)size + num_attribs;
+  LightReMutexHolder holder(*_states_lock);
+  if (num_freed < free_list.size()) {
+    _free_list->insert(_free_list->end(), free_list.begin() + num_freed,
+                       free_list.end());
+  }
+  _pending_free_counter.set_level((double)_free_list->size());
+
+  return (int)num_freed;
 }
 
 /**
@@ -981,9 +1150,9 @@ void RenderState::
 clear_munger_cache() {
   LightReMutexHolder holder(*_states_lock);
 
-  size_t size = _states.get_num_entries();
-  for (size_t si = 0; si < size; ++si) {
-    RenderState *state = (RenderState *)(_states.get_key(si));
+  pvector<const RenderState *> states;
+  get_states_snapshot(states);
+  for (const RenderState *state : states) {
     state->_mungers.clear();
     state->_munged_states.clear();
     state->_last_mi = -1;
@@ -1011,10 +1180,9 @@ list_cycles(ostream &out) {
   VisitedStates visited;
   CompositionCycleDesc cycle_desc;
 
-  size_t size = _states.get_num_entries();
-  for (size_t si = 0; si < size; ++si) {
-    const RenderState *state = _states.get_key(si);
-
+  pvector<const RenderState *> states;
+  get_states_snapshot(states);
+  for (const RenderState *state : states) {
     bool inserted = visited.insert(state).second;
     if (inserted) {
       ++_last_cycle_detect;
@@ -1081,10 +1249,10 @@ void RenderState::
 list_states(ostream &out) {
   LightReMutexHolder holder(*_states_lock);
 
-  size_t size = _states.get_num_entries();
-  out << size << " states:\n";
-  for (size_t si = 0; si < size; ++si) {
-    const RenderState *state = _states.get_key(si);
+  pvector<const RenderState *> states;
+  get_states_snapshot(states);
+  out << states.size() << " states:\n";
+  for (const RenderState *state : states) {
     state->write(out, 2);
   }
 }
@@ -1100,26 +1268,33 @@ validate_states() {
   PStatTimer timer(_state_validate_pcollector);
 
   LightReMutexHolder holder(*_states_lock);
-  if (_states.is_empty()) {
-    return true;
+
+  for (size_t n = 0; n < num_shards; ++n) {
+    StateShard &shard = _shards[n];
+    LightReMutexHolder shard_holder(shard._lock);
+    if (!shard._states.validate()) {
+      pgraph_cat.error()
+        << "RenderState::_states cache is invalid!\n";
+      return false;
+    }
   }
 
-  if (!_states.validate()) {
-    pgraph_cat.error()
-      << "RenderState::_states cache is invalid!\n";
-    return false;
+  pvector<const RenderState *> states;
+  get_states_snapshot(states);
+  if (states.empty()) {
+    return true;
   }
 
-  size_t size = _states.get_num_entries();
+  size_t size = states.size();
   size_t si = 0;
   nassertr(si < size, false);
-  nassertr(_states.get_key(si)->get_ref_count() >= 0, false);
+  nassertr(states[si]->get_ref_count() >= 0, false);
   size_t snext = si;
   ++snext;
   while (snext < size) {
-    nassertr(_states.get_key(snext)->get_ref_count() >= 0, false);
-    const RenderState *ssi = _states.get_key(si);
-    const RenderState *ssnext = _states.get_key(snext);
+    nassertr(states[snext]->get_ref_count() >= 0, false);
+    const RenderState *ssi = states[si];
+    const RenderState *ssnext = states[snext];
     int c = ssi->compare_to(*ssnext);
     int ci = ssnext->compare_to(*ssi);
     if ((ci < 0) != (c > 0) ||
@@ -1286,11 +1461,26 @@ return_unique(RenderState *state) {
   }
 #endif
 
-  LightReMutexHolder holder(*_states_lock);
+  if (!garbage_collect_states) {
+    // Without garbage collection, unref() may pull a state out of the table
+    // at any time, which it does while holding _states_lock.
+    LightReMutexHolder holder(*_states_lock);
+    return do_return_unique(state);
+  }
+
+  return do_return_unique(state);
+}
 
+/**
+ * The private implementation of return_unique().  This needs only to grab the
+ * lock of the shard that the state belongs in.
+ */
+CPT(RenderState) RenderState::
+do_return_unique(RenderState *state) {
   if (state->_saved_entry != -1) {
-    // This state is already in the cache.
-    //nassertr(_states.find(state) == state->_saved_entry, pt_state);
+    // This state is already in the cache.  Its _saved_entry was set before
+    // any other thread could get hold of it, so we can safely check it
+    // without holding a lock.
     return state;
   }
 
@@ -1308,7 +1498,10 @@ return_unique(RenderState *state) {
     }
   }
 
-  int si = _states.find(state);
+  StateShard &shard = get_shard(state);
+  LightReMutexHolder holder(shard._lock);
+
+  int si = shard._states.find(state);
   if (si != -1) {
     // There's an equivalent state already in the set.  Return it.  The state
     // that was passed may be newly created and therefore may not be
@@ -1316,7 +1509,7 @@ return_unique(RenderState *state) {
     if (state->get_ref_count() == 0) {
       delete state;
     }
-    return _states.get_key(si);
+    return shard._states.get_key(si);
   }
 
   // Not already in the set; add it.
@@ -1326,7 +1519,7 @@ return_unique(RenderState *state) {
     // deleted while it's in it.
     state->cache_ref();
   }
-  si = _states.store(state, nullptr);
+  si = shard._states.store(state, nullptr);
 
   // Save the index and return the input state.
   state->_saved_entry = si;
@@ -1601,8 +1794,10 @@ release_new() {
   nassertv(_states_lock->debug_is_locked());
 
   if (_saved_entry != -1) {
+    StateShard &shard = get_shard(this);
+    LightReMutexHolder holder(shard._lock);
     _saved_entry = -1;
-    nassertv_always(_states.remove(this));
+    nassertv_always(shard._states.remove(this));
   }
 }
 
@@ -1843,6 +2038,8 @@ init_states() {
   // _states_lock without a startup race condition.  For the meantime, this is
   // OK because we guarantee that this method is called at static init time,
   // presumably when there is still only one thread in the world.
+  _shards = new StateShard[num_shards];
+  _free_list = new FreeList;
   _states_lock = new LightReMutex("RenderState::_states_lock");
   _cache_stats.init();
   nassertv(Thread::get_current_thread() == Thread::get_main_thread());
@@ -1852,10 +2049,32 @@ init_states() {
   RenderState *state = new RenderState;
   state->local_object();
   state->cache_ref_only();
-  state->_saved_entry = _states.store(state, nullptr);
+  state->_saved_entry = get_shard(state)._states.store(state, nullptr);
   _empty_state = state;
 }
 
+/**
+ * Fills the indicated vector with all of the states in the global state
+ * table, in no particular order.
+ *
+ * The caller must be holding _states_lock, which guarantees that none of the
+ * states can be removed from the table (and hence deleted) while it is still
+ * looking at them, although new states may be added in the meantime.
+ */
+void RenderState::
+get_states_snapshot(pvector<const RenderState *> &states) {
+  nassertv(_states_lock->debug_is_locked());
+
+  for (size_t n = 0; n < num_shards; ++n) {
+    StateShard &shard = _shards[n];
+    LightReMutexHolder holder(shard._lock);
+    size_t size = shard._states.get_num_entries();
+    for (size_t si = 0; si < size; ++si) {
+      states.push_back(shard._states.get_key(si));
+    }
+  }
+}
+
 /**
  * Tells the BamReader how to create objects of type RenderState.
  */
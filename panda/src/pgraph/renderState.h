@@ -201,6 +201,7 @@ private:
 
   static CPT(RenderState) return_new(RenderState *state);
   static CPT(RenderState) return_unique(RenderState *state);
+  static CPT(RenderState) do_return_unique(RenderState *state);
   CPT(RenderState) do_compose(const RenderState *other) const;
   CPT(RenderState) do_invert_compose(const RenderState *other) const;
   void detect_and_break_cycles();
@@ -228,6 +229,7 @@ private:
 
 public:
   static void init_states();
+  static void get_states_snapshot(pvector<const RenderState *> &states);
 
   // If this state contains an "auto" ShaderAttrib, then an explicit
   // ShaderAttrib will be synthesized by the runtime and stored here.  I can't
@@ -242,9 +244,39 @@ private:
   // _invert_composition_cache.
   static LightReMutex *_states_lock;
   typedef SimpleHashMap<const RenderState *, std::nullptr_t, indirect_compare_to_hash<const RenderState *> > States;
-  static States _states;
   static const RenderState *_empty_state;
 
+  // The set of unique states is divided by hash into a number of shards, so
+  // that threads making unrelated states don't have to wait for each other.
+  // Each shard is protected by its own lock.  States are only ever removed
+  // from a shard while _states_lock is also held, and _states_lock must be
+  // grabbed first when both are needed.
+  class StateShard {
+  public:
+    INLINE StateShard();
+
+    LightReMutex _lock;
+    States _states;
+
+    // This keeps track of our current position through the garbage
+    // collection cycle within this shard.
+    size_t _garbage_index;
+
+    // The number of complete garbage collection sweeps through this shard.
+    unsigned int _num_sweeps;
+  };
+  static const size_t num_shards = 16;
+  static StateShard *_shards;
+  INLINE static StateShard &get_shard(const RenderState *state);
+  static int garbage_collect_shard(StateShard &shard, bool break_and_uniquify,
+                                   double deadline, bool &finished);
+  static int free_unused_states(double deadline);
+
+  // The states that the garbage collector has removed from the cache, but
+  // not yet destroyed.  Protected by _states_lock.
+  typedef pvector<RenderState *> FreeList;
+  static FreeList *_free_list;
+
   // This iterator records the entry corresponding to this RenderState object
   // in the above global set.  We keep the index around so we can remove it
   // when the RenderState destructs.
@@ -286,11 +318,14 @@ private:
 
   // This is used to mark nodes as we visit them to detect cycles.
   UpdateSeq _cycle_detect;
+
+  // The number of garbage collection sweeps this state has survived, up to
+  // garbage-collect-states-old-age.  Protected by the shard's lock.
+  unsigned int _gc_age = 0;
   static UpdateSeq _last_cycle_detect;
 
-  // This keeps track of our current position through the garbage collection
-  // cycle.
-  static size_t _garbage_index;
+  // This is the shard that the next garbage collection step starts in.
+  static size_t _garbage_shard;
 
   static PStatCollector _cache_update_pcollector;
   static PStatCollector _garbage_collect_pcollector;
@@ -301,6 +336,9 @@ private:
 
   static PStatCollector _node_counter;
   static PStatCollector _cache_counter;
+  static PStatCollector _freed_counter;
+  static PStatCollector _pending_free_counter;
+  static PStatCollector _collect_time_counter;
 
 private:
   // This is the actual data within the RenderState: a set of max_slots
@@ -174,13 +174,14 @@ get_states() {
   extern struct Dtool_PyTypedObject Dtool_RenderState;
   LightReMutexHolder holder(*RenderState::_states_lock);
 
-  size_t num_states = RenderState::_states.get_num_entries();
+  pvector<const RenderState *> states;
+  RenderState::get_states_snapshot(states);
+
+  size_t num_states = states.size();
   PyObject *list = PyList_New(num_states);
   size_t i = 0;
 
-  size_t size = RenderState::_states.get_num_entries();
-  for (size_t si = 0; si < size; ++si) {
-    const RenderState *state = RenderState::_states.get_key(si);
+  for (const RenderState *state : states) {
     state->ref();
     PyObject *a =
       DTool_CreatePyInstanceTyped((void *)state, Dtool_RenderState,
@@ -202,10 +203,11 @@ get_unused_states() {
   extern struct Dtool_PyTypedObject Dtool_RenderState;
   LightReMutexHolder holder(*RenderState::_states_lock);
 
+  pvector<const RenderState *> states;
+  RenderState::get_states_snapshot(states);
+
   PyObject *list = PyList_New(0);
-  size_t size = RenderState::_states.get_num_entries();
-  for (size_t si = 0; si < size; ++si) {
-    const RenderState *state = RenderState::_states.get_key(si);
+  for (const RenderState *state : states) {
     if (state->get_cache_ref_count() == state->get_ref_count()) {
       state->ref();
       PyObject *a =
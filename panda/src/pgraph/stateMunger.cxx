@@ -12,6 +12,7 @@
  */
 
 #include "stateMunger.h"
+#include "lightMutexHolder.h"
 
 TypeHandle StateMunger::_type_handle;
 
@@ -30,16 +31,22 @@ munge_state(const RenderState *state) {
   RenderState::MungedStates &munged_states = state->_munged_states;
 
   int id = get_gsg()->_id;
-  int mi = munged_states.find(id);
-  if (mi != -1) {
-    if (auto munged_state = munged_states.get_data(mi).lock()) {
-      return munged_state;
-    } else {
-      munged_states.remove_element(mi);
+  {
+    // This may be called by several cull threads at once for the same state.
+    LightMutexHolder holder(((RenderState *)state)->_lock);
+    int mi = munged_states.find(id);
+    if (mi != -1) {
+      if (auto munged_state = munged_states.get_data(mi).lock()) {
+        return munged_state;
+      } else {
+        munged_states.remove_element(mi);
+      }
     }
   }
 
   CPT(RenderState) result = munge_state_impl(state);
+
+  LightMutexHolder holder(((RenderState *)state)->_lock);
   munged_states.store(id, result);
 
   return result;
@@ -0,0 +1,83 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file threadCompositionCache.h
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#ifndef THREADCOMPOSITIONCACHE_H
+#define THREADCOMPOSITIONCACHE_H
+
+#include "pandabase.h"
+#include "pointerTo.h"
+#include "lightMutex.h"
+#include "lightMutexHolder.h"
+#include "pvector.h"
+
+#include <algorithm>
+#include "config_pgraph.h"
+
+/**
+ * A small, direct-mapped cache of recent compositions of RenderStates or
+ * TransformStates, kept separately by each thread.  It is consulted by
+ * compose() and invert_compose() before they grab the global _states_lock,
+ * so that threads that keep composing the same handful of states (as the cull
+ * traversal does) need not contend for the lock at all.
+ *
+ * The cache holds a reference to both operands and to the result, so that a
+ * cached pointer can never be reused by another state.  Each thread's cache
+ * is listed in a global registry, and flush() empties all of them right
+ * away, which happens when the states are garbage collected or the caches
+ * are cleared, so that the states are not kept alive by them.  Each cache
+ * has its own lock for this purpose, which is only ever contended by flush().
+ *
+ * This is only used in true-threaded builds; otherwise it does nothing.
+ */
+template<class State>
+class ThreadCompositionCache {
+public:
+  INLINE static CPT(State) find(const State *a, const State *b, bool invert);
+  INLINE static void store(const State *a, const State *b, bool invert,
+                           const State *result);
+  INLINE static void flush();
+
+#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
+private:
+  INLINE ThreadCompositionCache();
+  INLINE ~ThreadCompositionCache();
+
+  INLINE void clear();
+
+  INLINE static size_t get_slot(const State *a, const State *b, bool invert);
+  INLINE static ThreadCompositionCache *get_local_cache();
+
+  static const size_t num_entries = 64;
+
+  class Entry {
+  public:
+    CPT(State) _a;
+    CPT(State) _b;
+    CPT(State) _result;
+    bool _invert = false;
+  };
+  LightMutex _lock;
+  Entry _entries[num_entries];
+
+  // The caches of all threads that have one, so that flush() can get to
+  // them.  These are created on first use, to avoid static init ordering
+  // issues with the thread_local caches.
+  typedef pvector<ThreadCompositionCache *> Caches;
+  INLINE static LightMutex &get_caches_lock();
+  INLINE static Caches &get_caches();
+#endif
+};
+
+#include "threadCompositionCache.I"
+
+#endif
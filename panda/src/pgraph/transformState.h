@@ -225,6 +225,7 @@ PUBLISHED:
 
 public:
   static void init_states();
+  static void get_states_snapshot(pvector<const TransformState *> &states);
 
   INLINE static void flush_level();
 
@@ -251,6 +252,7 @@ private:
 
   static CPT(TransformState) return_new(TransformState *state);
   static CPT(TransformState) return_unique(TransformState *state);
+  static CPT(TransformState) do_return_unique(TransformState *state);
 
   CPT(TransformState) do_compose(const TransformState *other) const;
   CPT(TransformState) do_invert_compose(const TransformState *other) const;
@@ -273,7 +275,35 @@ private:
   // _invert_composition_cache.
   static LightReMutex *_states_lock;
   typedef SimpleHashMap<const TransformState *, std::nullptr_t, indirect_equals_hash<const TransformState *> > States;
-  static States _states;
+
+  // The set of unique states is divided by hash into a number of shards, so
+  // that threads making unrelated states don't have to wait for each other.
+  // See the similar logic in RenderState.
+  class StateShard {
+  public:
+    INLINE StateShard();
+
+    LightReMutex _lock;
+    States _states;
+
+    // This keeps track of our current position through the garbage
+    // collection cycle within this shard.
+    size_t _garbage_index;
+
+    // The number of complete garbage collection sweeps through this shard.
+    unsigned int _num_sweeps;
+  };
+  static const size_t num_shards = 16;
+  static StateShard *_shards;
+  INLINE static StateShard &get_shard(const TransformState *state);
+  static int garbage_collect_shard(StateShard &shard, bool break_and_uniquify,
+                                   double deadline, bool &finished);
+  static int free_unused_states(double deadline);
+
+  // The states that the garbage collector has removed from the cache, but
+  // not yet destroyed.  Protected by _states_lock.
+  typedef pvector<TransformState *> FreeList;
+  static FreeList *_free_list;
   static CPT(TransformState) _identity_state;
   static CPT(TransformState) _invalid_state;
 
@@ -305,11 +335,14 @@ private:
 
   // This is used to mark nodes as we visit them to detect cycles.
   UpdateSeq _cycle_detect;
+
+  // The number of garbage collection sweeps this state has survived, up to
+  // garbage-collect-states-old-age.  Protected by the shard's lock.
+  unsigned int _gc_age = 0;
   static UpdateSeq _last_cycle_detect;
 
-  // This keeps track of our current position through the garbage collection
-  // cycle.
-  static size_t _garbage_index;
+  // This is the shard that the next garbage collection step starts in.
+  static size_t _garbage_shard;
 
   static bool _uniquify_matrix;
 
@@ -325,6 +358,9 @@ private:
 
   static PStatCollector _node_counter;
   static PStatCollector _cache_counter;
+  static PStatCollector _freed_counter;
+  static PStatCollector _pending_free_counter;
+  static PStatCollector _collect_time_counter;
 
 private:
   // This is the actual data within the TransformState.
@@ -44,6 +44,17 @@ BaseForce::
 ~BaseForce() {
 }
 
+/**
+ * Returns true if this force may be evaluated for several objects on
+ * different threads at once, and gives the same vectors when it is.  A
+ * PhysicsManager in parallel mode integrates the Physicals that are acted on
+ * by any force that returns false on the main thread, in order.
+ */
+bool BaseForce::
+is_parallel_safe() const {
+  return true;
+}
+
 /**
  * Write a string representation of this instance to <out>.
  */
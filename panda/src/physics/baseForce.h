@@ -40,6 +40,9 @@ PUBLISHED:
   virtual void output(std::ostream &out) const;
   virtual void write(std::ostream &out, int indent_level=0) const;
 
+public:
+  virtual bool is_parallel_safe() const;
+
 protected:
   BaseForce(bool active = true);
   BaseForce(const BaseForce &copy);
@@ -40,6 +40,20 @@ BaseIntegrator::
 void BaseIntegrator::
 precompute_linear_matrices(Physical *physical,
                            const LinearForceVector &forces) {
+  _precomputed_linear_matrices.clear();
+  compute_linear_matrices(physical, forces, _precomputed_linear_matrices);
+}
+
+/**
+ * Appends the xform matrices between the physical's node and every force
+ * acting on it to the indicated vector: first the global forces, then the
+ * physical's own.  This is what precompute_linear_matrices() does, but into a
+ * vector owned by the caller, so that the matrices for several physicals can
+ * be computed up front and kept side by side.
+ */
+void BaseIntegrator::
+compute_linear_matrices(Physical *physical, const LinearForceVector &forces,
+                        MatrixVector &matrices) {
   nassertv(physical);
   // make sure the physical's in the scene graph, somewhere.
   nassertv(physical->get_physical_node() != nullptr);
@@ -51,8 +65,7 @@ precompute_linear_matrices(Physical *physical,
   size_t local_force_vec_size = physical->get_linear_forces().size();
 
   // prepare the vector
-  _precomputed_linear_matrices.clear();
-  _precomputed_linear_matrices.reserve(
+  matrices.reserve(matrices.size() +
       global_force_vec_size + local_force_vec_size);
 
   NodePath physical_np(physical->get_physical_node_path());
@@ -65,7 +78,7 @@ precompute_linear_matrices(Physical *physical,
     nassertv((*fi)->get_force_node() != nullptr);
 
     NodePath force_np = (*fi)->get_force_node_path();
-    _precomputed_linear_matrices.push_back(
+    matrices.push_back(
         force_np.get_transform(parent_physical_np)->get_mat());
   }
 
@@ -75,7 +88,7 @@ precompute_linear_matrices(Physical *physical,
     nassertv((*fi)->get_force_node() != nullptr);
 
     NodePath force_np = (*fi)->get_force_node_path();
-    _precomputed_linear_matrices.push_back(
+    matrices.push_back(
         force_np.get_transform(parent_physical_np)->get_mat());
   }
 }
@@ -39,6 +39,10 @@ public:
 
   virtual ~BaseIntegrator();
 
+  static void compute_linear_matrices(Physical *physical,
+                                      const LinearForceVector &forces,
+                                      MatrixVector &matrices);
+
 PUBLISHED:
   virtual void output(std::ostream &out) const;
   virtual void write_precomputed_linear_matrices(std::ostream &out,
@@ -33,6 +33,13 @@
 ConfigureDef(config_physics);
 NotifyCategoryDef(physics, "");
 
+ConfigVariableBool physics_parallel
+("physics-parallel", false,
+ PRC_DESC("Set this true to make new PhysicsManagers integrate their "
+          "Physicals on the JobSystem's worker threads.  The result is the "
+          "same as integrating them one after another; see "
+          "PhysicsManager::set_parallel()."));
+
 ConfigureFn(config_physics) {
   init_libphysics();
 }
@@ -17,10 +17,13 @@
 #include "pandabase.h"
 #include "notifyCategoryProxy.h"
 #include "dconfig.h"
+#include "configVariableBool.h"
 
 ConfigureDecl(config_physics, EXPCL_PANDA_PHYSICS, EXPTP_PANDA_PHYSICS);
 NotifyCategoryDecl(physics, EXPCL_PANDA_PHYSICS, EXPTP_PANDA_PHYSICS);
 
+extern EXPCL_PANDA_PHYSICS ConfigVariableBool physics_parallel;
+
 extern EXPCL_PANDA_PHYSICS void init_libphysics();
 
 // These macros get stripped out in a non-debug build (like asserts). Use them
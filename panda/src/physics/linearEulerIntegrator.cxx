@@ -36,23 +36,22 @@ LinearEulerIntegrator::
  *
  * physical, The objects being acted upon and the set of local forces that are
  * applied after the global forces.  forces, Global forces to be applied
- * first.  dt, The delta time of this integration step.
+ * first.  matrices, The force-to-physical xforms from
+ * compute_linear_matrices().  dt, The delta time of this integration step.
  */
 void LinearEulerIntegrator::
 child_integrate(Physical *physical,
                 LinearForceVector& forces,
+                const LMatrix4 *matrices,
                 PN_stdfloat dt) {
-  // perform the precomputation.  Note that the vector returned by
-  // get_precomputed_matrices() has the matrices loaded in order of force
-  // type: first global, then local.  If you're using this as a guide to write
-  // another integrator, be sure to process your forces global, then local.
-  // otherwise your transforms will be VERY bad.
-  precompute_linear_matrices(physical, forces);
-  const MatrixVector &matrices = get_precomputed_linear_matrices();
+  // Note that the matrices are loaded in order of force type: first global,
+  // then local.  If you're using this as a guide to write another integrator,
+  // be sure to process your forces global, then local.  otherwise your
+  // transforms will be VERY bad.
 #ifndef NDEBUG
-  MatrixVector::const_iterator mi;
-  for (mi = matrices.begin(); mi != matrices.end(); ++mi) {
-    nassertv(!(*mi).is_nan());
+  size_t num_matrices = forces.size() + physical->get_linear_forces().size();
+  for (size_t mi = 0; mi < num_matrices; ++mi) {
+    nassertv(!matrices[mi].is_nan());
   }
 #endif  // NDEBUG
 
@@ -185,6 +184,128 @@ child_integrate(Physical *physical,
   }
 }
 
+/**
+ * Returns true, since this integrator is able to move the objects of a
+ * PhysicsObjectPool.
+ */
+bool LinearEulerIntegrator::
+can_use_pool() const {
+  return true;
+}
+
+/**
+ * Integrates a step of motion for all of the objects in a pool at once.  This
+ * applies the same forces and the same step as child_integrate(), but each
+ * force adds its vectors for all of the objects in one call, and the step is
+ * then taken four objects at a time where SSE is available.
+ */
+void LinearEulerIntegrator::
+child_integrate_pool(Physical *physical,
+                     LinearForceVector &forces,
+                     PhysicsObjectPool &pool,
+                     const LMatrix4 *matrices,
+                     PN_stdfloat dt) {
+  size_t num_objects = pool.get_num_objects();
+  if (num_objects == 0) {
+    return;
+  }
+
+  // As in child_integrate(), the matrices are in order of the global forces,
+  // then the local forces.
+  pool.clear_forces();
+  PN_stdfloat *md_force[3], *force[3];
+  for (int i = 0; i < 3; ++i) {
+    md_force[i] = pool.modify_force_array(true, i);
+    force[i] = pool.modify_force_array(false, i);
+  }
+
+  int index = 0;
+  const LinearForceVector *force_vectors[2] = {
+    &forces, &physical->get_linear_forces()
+  };
+  for (const LinearForceVector *force_vector : force_vectors) {
+    LinearForceVector::const_iterator f_cur;
+    for (f_cur = force_vector->begin(); f_cur != force_vector->end(); ++f_cur) {
+      LinearForce *cur_force = *f_cur;
+      if (cur_force->get_active() == false) {
+        continue;
+      }
+
+      PN_stdfloat **accum = cur_force->get_mass_dependent() ? md_force : force;
+      cur_force->add_vectors(pool, matrices[index++], accum[0], accum[1], accum[2]);
+    }
+  }
+
+  PN_stdfloat viscosity_damper = 1.0f - physical->get_viscosity();
+  const PN_stdfloat *mass = pool.get_mass_array();
+  PN_stdfloat *pos[3], *vel[3];
+  for (int i = 0; i < 3; ++i) {
+    pos[i] = pool.modify_position_array(i);
+    vel[i] = pool.modify_velocity_array(i);
+  }
+
+  size_t n = 0;
+#ifdef PHYSICS_POOL_SSE
+  __m128 one = _mm_set1_ps(1.0f);
+  __m128 half = _mm_set1_ps(0.5f);
+  __m128 step = _mm_set1_ps(dt);
+  __m128 damper = _mm_set1_ps(viscosity_damper);
+  for (; n + 4 <= num_objects; n += 4) {
+    __m128 recip_mass = _mm_div_ps(one, _mm_loadu_ps(mass + n));
+    __m128 p[3], v[3], nan_mask = _mm_setzero_ps();
+    for (int i = 0; i < 3; ++i) {
+      // a = (F_md / m + F) * damper
+      __m128 a = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(md_force[i] + n), recip_mass),
+                                       _mm_loadu_ps(force[i] + n)), damper);
+      // x = x + v * t + 0.5 * a * t * t
+      v[i] = _mm_loadu_ps(vel[i] + n);
+      p[i] = _mm_loadu_ps(pos[i] + n);
+      p[i] = _mm_add_ps(p[i], _mm_add_ps(_mm_mul_ps(v[i], step),
+                                         _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(half, a), step), step)));
+      // v = v + a * t
+      v[i] = _mm_add_ps(v[i], _mm_mul_ps(a, step));
+      nan_mask = _mm_or_ps(nan_mask, _mm_cmpunord_ps(p[i], p[i]));
+    }
+
+    // Don't store a position with a NaN in it, as child_integrate() doesn't.
+    // The velocity is left alone in the same way, below.
+    __m128 vel_nan_mask = _mm_or_ps(_mm_or_ps(_mm_cmpunord_ps(v[0], v[0]),
+                                              _mm_cmpunord_ps(v[1], v[1])),
+                                    _mm_cmpunord_ps(v[2], v[2]));
+    for (int i = 0; i < 3; ++i) {
+      __m128 old_p = _mm_loadu_ps(pos[i] + n);
+      __m128 old_v = _mm_loadu_ps(vel[i] + n);
+      _mm_storeu_ps(pos[i] + n, _mm_or_ps(_mm_and_ps(nan_mask, old_p),
+                                          _mm_andnot_ps(nan_mask, p[i])));
+      _mm_storeu_ps(vel[i] + n, _mm_or_ps(_mm_and_ps(vel_nan_mask, old_v),
+                                          _mm_andnot_ps(vel_nan_mask, v[i])));
+    }
+  }
+#endif
+  for (; n < num_objects; ++n) {
+    LVector3 accel_vec(md_force[0][n], md_force[1][n], md_force[2][n]);
+    accel_vec /= mass[n];
+    accel_vec += LVector3(force[0][n], force[1][n], force[2][n]);
+    accel_vec *= viscosity_damper;
+
+    LPoint3 p(pos[0][n], pos[1][n], pos[2][n]);
+    LVector3 v(vel[0][n], vel[1][n], vel[2][n]);
+    p += v * dt + 0.5 * accel_vec * dt * dt;
+    v += accel_vec * dt;
+
+    if (!p.is_nan()) {
+      pos[0][n] = p[0];
+      pos[1][n] = p[1];
+      pos[2][n] = p[2];
+    }
+    if (!v.is_nan()) {
+      vel[0][n] = v[0];
+      vel[1][n] = v[1];
+      vel[2][n] = v[2];
+    }
+  }
+}
+
 /**
  * Write a string representation of this instance to <out>.
  */
@@ -28,10 +28,19 @@ PUBLISHED:
   virtual void output(std::ostream &out) const;
   virtual void write(std::ostream &out, int indent=0) const;
 
+public:
+  virtual bool can_use_pool() const;
+
 private:
   virtual void child_integrate(Physical *physical,
                                LinearForceVector& forces,
+                               const LMatrix4 *matrices,
                                PN_stdfloat dt);
+  virtual void child_integrate_pool(Physical *physical,
+                                    LinearForceVector &forces,
+                                    PhysicsObjectPool &pool,
+                                    const LMatrix4 *matrices,
+                                    PN_stdfloat dt);
 };
 
 #endif // EULERINTEGRATOR_H
@@ -70,6 +70,34 @@ get_vector(const PhysicsObject *po) {
   return child_vector;
 }
 
+/**
+ * Adds the vector of this force acting on each object in the pool,
+ * transformed by xform, to the indicated arrays.  This is what the integrator
+ * calls for a Physical that keeps its objects in a PhysicsObjectPool.
+ *
+ * The default implementation calls get_vector() once per object; the common
+ * forces override it to process the arrays directly.
+ */
+void LinearForce::
+add_vectors(const PhysicsObjectPool &pool, const LMatrix4 &xform,
+            PN_stdfloat *x, PN_stdfloat *y, PN_stdfloat *z) {
+  PT(PhysicsObject) po = new PhysicsObject;
+
+  size_t num_objects = pool.get_num_objects();
+  for (size_t i = 0; i < num_objects; ++i) {
+    po->set_mass(pool.get_mass(i));
+    po->set_terminal_velocity(pool.get_terminal_velocity(i));
+    po->set_last_position(pool.get_last_position(i));
+    po->set_position(pool.get_position(i));
+    po->set_velocity(pool.get_velocity(i));
+
+    LVector3 f = get_vector(po) * xform;
+    x[i] += f[0];
+    y[i] += f[1];
+    z[i] += f[2];
+  }
+}
+
 /**
 
  */
@@ -15,6 +15,7 @@
 #define LINEARFORCE_H
 
 #include "baseForce.h"
+#include "physicsObjectPool.h"
 
 /**
  * A force that acts on a PhysicsObject by way of an Integrator.  This is a
@@ -42,6 +43,10 @@ PUBLISHED:
   virtual void output(std::ostream &out) const;
   virtual void write(std::ostream &out, int indent=0) const;
 
+public:
+  virtual void add_vectors(const PhysicsObjectPool &pool, const LMatrix4 &xform,
+                           PN_stdfloat *x, PN_stdfloat *y, PN_stdfloat *z);
+
 protected:
   LinearForce(PN_stdfloat a, bool mass);
   LinearForce(const LinearForce& copy);
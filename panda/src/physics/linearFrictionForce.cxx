@@ -68,6 +68,53 @@ get_child_vector(const PhysicsObject* po) {
   return friction;
 }
 
+/**
+ * Adds the friction acting on each object in the pool to the indicated
+ * arrays.
+ */
+void LinearFrictionForce::
+add_vectors(const PhysicsObjectPool &pool, const LMatrix4 &xform,
+            PN_stdfloat *x, PN_stdfloat *y, PN_stdfloat *z) {
+  nassertv(_coef >= 0.0f && _coef <= 1.0f);
+
+  // The force is linear in the velocity, so the coefficient, the amplitude,
+  // the masks and the transform all fold into one 3x3 matrix.
+  LVector3 masks = get_vector_masks();
+  PN_stdfloat scale = -_coef * get_amplitude();
+  LMatrix3 m = xform.get_upper_3();
+  for (int r = 0; r < 3; ++r) {
+    m.set_row(r, m.get_row(r) * (scale * masks[r]));
+  }
+
+  const PN_stdfloat *vx = pool.get_velocity_array(0);
+  const PN_stdfloat *vy = pool.get_velocity_array(1);
+  const PN_stdfloat *vz = pool.get_velocity_array(2);
+
+  size_t num_objects = pool.get_num_objects();
+  size_t i = 0;
+#ifdef PHYSICS_POOL_SSE
+  __m128 m00 = _mm_set1_ps(m(0, 0)), m01 = _mm_set1_ps(m(0, 1)), m02 = _mm_set1_ps(m(0, 2));
+  __m128 m10 = _mm_set1_ps(m(1, 0)), m11 = _mm_set1_ps(m(1, 1)), m12 = _mm_set1_ps(m(1, 2));
+  __m128 m20 = _mm_set1_ps(m(2, 0)), m21 = _mm_set1_ps(m(2, 1)), m22 = _mm_set1_ps(m(2, 2));
+  for (; i + 4 <= num_objects; i += 4) {
+    __m128 a = _mm_loadu_ps(vx + i);
+    __m128 b = _mm_loadu_ps(vy + i);
+    __m128 c = _mm_loadu_ps(vz + i);
+    __m128 fx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, m00), _mm_mul_ps(b, m10)), _mm_mul_ps(c, m20));
+    __m128 fy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, m01), _mm_mul_ps(b, m11)), _mm_mul_ps(c, m21));
+    __m128 fz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, m02), _mm_mul_ps(b, m12)), _mm_mul_ps(c, m22));
+    _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), fx));
+    _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), fy));
+    _mm_storeu_ps(z + i, _mm_add_ps(_mm_loadu_ps(z + i), fz));
+  }
+#endif
+  for (; i < num_objects; ++i) {
+    x[i] += vx[i] * m(0, 0) + vy[i] * m(1, 0) + vz[i] * m(2, 0);
+    y[i] += vx[i] * m(0, 1) + vy[i] * m(1, 1) + vz[i] * m(2, 1);
+    z[i] += vx[i] * m(0, 2) + vy[i] * m(1, 2) + vz[i] * m(2, 2);
+  }
+}
+
 /**
  * Write a string representation of this instance to <out>.
  */
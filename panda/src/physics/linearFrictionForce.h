@@ -31,6 +31,10 @@ PUBLISHED:
   virtual void output(std::ostream &out) const;
   virtual void write(std::ostream &out, int indent=0) const;
 
+public:
+  virtual void add_vectors(const PhysicsObjectPool &pool, const LMatrix4 &xform,
+                           PN_stdfloat *x, PN_stdfloat *y, PN_stdfloat *z);
+
 private:
   PN_stdfloat _coef;
 
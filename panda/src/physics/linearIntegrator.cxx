@@ -40,12 +40,33 @@ LinearIntegrator::
 void LinearIntegrator::
 integrate(Physical *physical, LinearForceVector &forces,
           PN_stdfloat dt) {
+  precompute_linear_matrices(physical, forces);
+  integrate(physical, forces, get_precomputed_linear_matrices().data(), dt);
+}
+
+/**
+ * As above, but with the force matrices already computed by
+ * compute_linear_matrices().  This doesn't touch any state of the integrator,
+ * so it may be called for different physicals from several threads at once,
+ * as long as the forces are safe to evaluate that way.
+ */
+void LinearIntegrator::
+integrate(Physical *physical, LinearForceVector &forces,
+          const LMatrix4 *matrices, PN_stdfloat dt) {
 /* <-- darren, 2000.10.06
   // cap dt so physics don't go flying off on lags
   if (dt > _max_linear_dt)
     dt = _max_linear_dt;
 */
 
+  // A Physical that keeps its objects in a pool has all of them there.
+  PhysicsObjectPool *pool = physical->get_object_pool();
+  if (pool != nullptr) {
+    pool->save_last_positions();
+    child_integrate_pool(physical, forces, *pool, matrices, dt);
+    return;
+  }
+
   PhysicsObject::Vector::const_iterator current_object_iter;
   current_object_iter = physical->get_object_vector().begin();
   for (; current_object_iter != physical->get_object_vector().end();
@@ -61,7 +82,34 @@ integrate(Physical *physical, LinearForceVector &forces,
     // it
     current_object->set_last_position(current_object->get_position());
   }
-  child_integrate(physical, forces, dt);
+  child_integrate(physical, forces, matrices, dt);
+}
+
+/**
+ * Returns true if this integrator is able to move the objects of a Physical
+ * that keeps them in a PhysicsObjectPool, ie. if it overrides
+ * child_integrate_pool().  A Physical should not keep its objects in a pool
+ * unless its PhysicsManager's integrator can do this.
+ */
+bool LinearIntegrator::
+can_use_pool() const {
+  return false;
+}
+
+/**
+ * Integrates a step of motion for a Physical that keeps its objects in a
+ * PhysicsObjectPool.  An integrator that doesn't override this can't move
+ * such objects; see can_use_pool().
+ */
+void LinearIntegrator::
+child_integrate_pool(Physical *, LinearForceVector &, PhysicsObjectPool &,
+                     const LMatrix4 *, PN_stdfloat) {
+  static bool warned = false;
+  if (!warned) {
+    warned = true;
+    physics_cat.warning()
+      << "This LinearIntegrator does not support PhysicsObjectPools.\n";
+  }
 }
 
 /**
@@ -15,6 +15,7 @@
 #define LINEARINTEGRATOR_H
 
 #include "physicsObject.h"
+#include "physicsObjectPool.h"
 #include "baseIntegrator.h"
 #include "linearForce.h"
 #include "configVariableDouble.h"
@@ -30,6 +31,10 @@ public:
 
   void integrate(Physical *physical, LinearForceVector &forces,
                  PN_stdfloat dt);
+  void integrate(Physical *physical, LinearForceVector &forces,
+                 const LMatrix4 *matrices, PN_stdfloat dt);
+
+  virtual bool can_use_pool() const;
 
 PUBLISHED:
   virtual void output(std::ostream &out) const;
@@ -45,7 +50,13 @@ private:
   // integration function receives.
   virtual void child_integrate(Physical *physical,
                                LinearForceVector &forces,
+                               const LMatrix4 *matrices,
                                PN_stdfloat dt) = 0;
+  virtual void child_integrate_pool(Physical *physical,
+                                    LinearForceVector &forces,
+                                    PhysicsObjectPool &pool,
+                                    const LMatrix4 *matrices,
+                                    PN_stdfloat dt);
 };
 
 #endif // LINEARINTEGRATOR_H
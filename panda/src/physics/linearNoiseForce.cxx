@@ -81,6 +81,15 @@ make_copy() {
   return new LinearNoiseForce(*this);
 }
 
+/**
+ * The noise tables are only random when they are made, so this force only
+ * depends on the object's position.
+ */
+bool LinearNoiseForce::
+is_parallel_safe() const {
+  return true;
+}
+
 /**
  * Returns the noise value based on the object's position.
  */
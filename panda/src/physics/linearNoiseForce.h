@@ -31,6 +31,8 @@ PUBLISHED:
   virtual void write(std::ostream &out, int indent=0) const;
 
 public:
+  virtual bool is_parallel_safe() const;
+
   static ConfigVariableInt _random_seed;
   static void init_noise_tables();
 
@@ -46,6 +46,15 @@ bounded_rand() {
   return ((PN_stdfloat)rand() / (PN_stdfloat)RAND_MAX);
 }
 
+/**
+ * Random forces draw from rand(), so they must be evaluated in order, on one
+ * thread.
+ */
+bool LinearRandomForce::
+is_parallel_safe() const {
+  return false;
+}
+
 /**
  * Write a string representation of this instance to <out>.
  */
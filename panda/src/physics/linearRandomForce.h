@@ -29,6 +29,9 @@ PUBLISHED:
   virtual void output(std::ostream &out) const;
   virtual void write(std::ostream &out, int indent=0) const;
 
+public:
+  virtual bool is_parallel_safe() const;
+
 protected:
   static PN_stdfloat bounded_rand();
   static LVector3 random_unit_vector();
@@ -58,6 +58,15 @@ get_child_vector(const PhysicsObject *po) {
   return _proc(po);
 }
 
+/**
+ * There is no telling what the evaluator function does, so it is only called
+ * on the main thread.
+ */
+bool LinearUserDefinedForce::
+is_parallel_safe() const {
+  return false;
+}
+
 /**
  * Write a string representation of this instance to <out>.
  */
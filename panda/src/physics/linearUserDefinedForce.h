@@ -31,6 +31,9 @@ PUBLISHED:
   virtual void output(std::ostream &out) const;
   virtual void write(std::ostream &out, int indent=0) const;
 
+public:
+  virtual bool is_parallel_safe() const;
+
 private:
   LVector3 (*_proc)(const PhysicsObject *po);
 
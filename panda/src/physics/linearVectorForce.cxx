@@ -70,6 +70,34 @@ get_child_vector(const PhysicsObject *) {
   return _fvec;
 }
 
+/**
+ * Adds the vector of this force, which is the same for every object in the
+ * pool, to the indicated arrays.
+ */
+void LinearVectorForce::
+add_vectors(const PhysicsObjectPool &pool, const LMatrix4 &xform,
+            PN_stdfloat *x, PN_stdfloat *y, PN_stdfloat *z) {
+  LVector3 f = get_vector(nullptr) * xform;
+
+  size_t num_objects = pool.get_num_objects();
+  size_t i = 0;
+#ifdef PHYSICS_POOL_SSE
+  __m128 fx = _mm_set1_ps(f[0]);
+  __m128 fy = _mm_set1_ps(f[1]);
+  __m128 fz = _mm_set1_ps(f[2]);
+  for (; i + 4 <= num_objects; i += 4) {
+    _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), fx));
+    _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), fy));
+    _mm_storeu_ps(z + i, _mm_add_ps(_mm_loadu_ps(z + i), fz));
+  }
+#endif
+  for (; i < num_objects; ++i) {
+    x[i] += f[0];
+    y[i] += f[1];
+    z[i] += f[2];
+  }
+}
+
 /**
  * Write a string representation of this instance to <out>.
  */
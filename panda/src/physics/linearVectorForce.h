@@ -37,6 +37,9 @@ PUBLISHED:
   virtual void write(std::ostream &out, int indent=0) const;
 
 public:
+  virtual void add_vectors(const PhysicsObjectPool &pool, const LMatrix4 &xform,
+                           PN_stdfloat *x, PN_stdfloat *y, PN_stdfloat *z);
+
   INLINE LinearVectorForce& operator += (const LinearVectorForce &other);
 
 private:
@@ -13,3 +13,4 @@
 #include "physicsManager.cxx"
 #include "physicsObject.cxx"
 #include "physicsObjectCollection.cxx"
+#include "physicsObjectPool.cxx"
@@ -34,6 +34,7 @@ TypeHandle Physical::_type_handle;
 Physical::
 Physical(int total_objects, bool pre_alloc) :
   _viscosity(0.0),
+  _object_pool(nullptr),
   _physics_manager(nullptr),
   _physical_node(nullptr) {
 
@@ -58,6 +59,7 @@ Physical(int total_objects, bool pre_alloc) :
  */
 Physical::
 Physical(const Physical& copy) :
+  _object_pool(nullptr),
   _physics_manager(nullptr),
   _physical_node(nullptr) {
 
@@ -106,6 +108,16 @@ Physical::
   }
 }
 
+/**
+ * Called by the PhysicsManager when this Physical is attached to it, and when
+ * the manager is given a new linear integrator.  A derived class that keeps
+ * its objects in a PhysicsObjectPool may need to move them out again if the
+ * new integrator can't integrate the pool.
+ */
+void Physical::
+linear_integrator_changed() {
+}
+
 /**
 
  */
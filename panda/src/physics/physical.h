@@ -23,6 +23,7 @@
 
 #include "physicsObject.h"
 #include "physicsObjectCollection.h"
+#include "physicsObjectPool.h"
 #include "linearForce.h"
 #include "angularForce.h"
 #include "nodePath.h"
@@ -88,6 +89,7 @@ PUBLISHED:
 
 public:
   INLINE const PhysicsObject::Vector &get_object_vector() const;
+  INLINE PhysicsObjectPool *get_object_pool() const;
   INLINE const LinearForceVector &get_linear_forces() const;
   INLINE const AngularForceVector &get_angular_forces() const;
 
@@ -108,6 +110,13 @@ protected:
   // way there.
   PhysicsObject *_phys_body;
 
+  // A derived class may keep its objects in a PhysicsObjectPool instead of in
+  // _physics_objects, by pointing this at the pool.  The pool belongs to the
+  // derived class.
+  PhysicsObjectPool *_object_pool;
+
+  virtual void linear_integrator_changed();
+
 private:
   PhysicsManager *_physics_manager;
   PhysicalNode *_physical_node;
@@ -13,9 +13,12 @@
 
 #include "physicsManager.h"
 #include "actorNode.h"
+#include "config_physics.h"
+#include "jobSystem.h"
 
 #include <algorithm>
 #include "pvector.h"
+#include "pset.h"
 
 using std::ostream;
 
@@ -30,6 +33,7 @@ PhysicsManager() {
   _linear_integrator.clear();
   _angular_integrator.clear();
   _viscosity=0.0;
+  _parallel = physics_parallel;
 }
 
 /**
@@ -120,9 +124,18 @@ remove_physical_node(PhysicalNode *p) {
 /**
  * This is the main high-level API call.  Performs integration on every
  * attached Physical.
+ *
+ * Each Physical's forces act from where the ActorNodes ahead of it in the
+ * list have moved them to during this step, in parallel mode (see
+ * set_parallel()) as well as serially.
  */
 void PhysicsManager::
 do_physics(PN_stdfloat dt) {
+  if (_parallel && _physicals.size() > 1) {
+    do_physics_parallel(dt);
+    return;
+  }
+
   // now, run through each physics object in the set.
   PhysicalsVector::iterator p_cur = _physicals.begin();
   for (; p_cur != _physicals.end(); ++p_cur) {
@@ -174,6 +187,186 @@ do_physics(PN_stdfloat dt, Physical *physical) {
   }
 }
 
+/**
+ * Returns true if none of the active forces in the vector mind being
+ * evaluated on several threads at once.
+ */
+template<class ForceVector>
+static bool
+is_parallel_safe(const ForceVector &forces) {
+  for (const auto &force : forces) {
+    if (force->get_active() && !force->is_parallel_safe()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Returns true if the transform between the two NodePaths depends on any of
+ * the indicated nodes.  The ancestors they have in common don't count, since
+ * moving one of those moves both of them alike.
+ */
+static bool
+is_moved_by(const NodePath &a, const NodePath &b,
+            const pset<PandaNode *> &nodes) {
+  pvector<PandaNode *> a_nodes, b_nodes;
+  for (NodePath np = a; !np.is_empty(); np = np.get_parent()) {
+    a_nodes.push_back(np.node());
+  }
+  for (NodePath np = b; !np.is_empty(); np = np.get_parent()) {
+    b_nodes.push_back(np.node());
+  }
+  while (!a_nodes.empty() && !b_nodes.empty() && a_nodes.back() == b_nodes.back()) {
+    a_nodes.pop_back();
+    b_nodes.pop_back();
+  }
+
+  for (PandaNode *node : a_nodes) {
+    if (nodes.count(node)) {
+      return true;
+    }
+  }
+  for (PandaNode *node : b_nodes) {
+    if (nodes.count(node)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Returns true if the transform from any of the forces in the vector to the
+ * indicated Physical depends on any of the indicated nodes.
+ */
+template<class ForceVector>
+static bool
+is_moved_by(const ForceVector &forces, const NodePath &parent_physical_np,
+            const pset<PandaNode *> &nodes) {
+  for (const auto &force : forces) {
+    if (force->get_force_node() != nullptr &&
+        is_moved_by(force->get_force_node_path(), parent_physical_np, nodes)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * The parallel version of do_physics(dt).  This works in three passes:
+ *
+ * First, the force matrices of every Physical are computed on this thread,
+ * into one array.  This is the only part that reads the scene graph.  This
+ * happens before any ActorNode is updated, so a Physical that is below an
+ * ActorNode ahead of it in the list, or that has a force below one, would
+ * not get the same matrices as in serial.  Those are left for the last pass.
+ *
+ * Then the other Physicals are integrated on the JobSystem's worker threads.
+ * Each one only touches its own objects.
+ *
+ * Last, back on this thread and in order, the ActorNodes are updated, and the
+ * Physicals that were left out are integrated: those with a force that isn't
+ * parallel-safe, and those that depend on an ActorNode ahead of them, whose
+ * matrices are computed afresh at this point.  The random forces are among
+ * the former, so they draw the same numbers from rand() as they would in
+ * serial.
+ */
+void PhysicsManager::
+do_physics_parallel(PN_stdfloat dt) {
+  size_t num_physicals = _physicals.size();
+  _steps.resize(num_physicals);
+  _linear_matrices.clear();
+
+  bool global_safe = is_parallel_safe(_linear_forces) &&
+                     is_parallel_safe(_angular_forces);
+
+  // The ActorNodes of the physicals ahead of the current one, which will have
+  // moved by the time it is integrated.
+  pset<PandaNode *> earlier_actors;
+
+  for (size_t i = 0; i < num_physicals; ++i) {
+    Physical *physical = _physicals[i];
+    nassertv(physical);
+
+    PhysicalStep &step = _steps[i];
+    step._first_matrix = _linear_matrices.size();
+    step._parallel_safe = global_safe &&
+      is_parallel_safe(physical->get_linear_forces()) &&
+      is_parallel_safe(physical->get_angular_forces());
+
+    PhysicalNode *pn = physical->get_physical_node();
+    step._late_matrices = false;
+    if (!earlier_actors.empty() && pn != nullptr) {
+      NodePath parent_np = physical->get_physical_node_path().get_parent();
+      step._late_matrices =
+        is_moved_by(_linear_forces, parent_np, earlier_actors) ||
+        is_moved_by(physical->get_linear_forces(), parent_np, earlier_actors) ||
+        is_moved_by(_angular_forces, parent_np, earlier_actors) ||
+        is_moved_by(physical->get_angular_forces(), parent_np, earlier_actors);
+    }
+
+    if (_linear_integrator) {
+      if (!step._late_matrices) {
+        BaseIntegrator::compute_linear_matrices(physical, _linear_forces, _linear_matrices);
+      }
+
+      // Keep the physicals lined up, even if one isn't in the scene graph.
+      size_t num_matrices = _linear_forces.size() + physical->get_linear_forces().size();
+      _linear_matrices.resize(step._first_matrix + num_matrices, LMatrix4::ident_mat());
+    }
+
+    if (pn != nullptr && pn->is_of_type(ActorNode::get_class_type())) {
+      earlier_actors.insert(pn);
+    }
+  }
+
+  JobSystem::get_global_ptr()->parallel_process(num_physicals, [&] (size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      if (_steps[i]._parallel_safe && !_steps[i]._late_matrices) {
+        integrate_physical(_physicals[i], _linear_matrices.data() + _steps[i]._first_matrix, dt);
+      }
+    }
+  });
+
+  for (size_t i = 0; i < num_physicals; ++i) {
+    Physical *physical = _physicals[i];
+    if (_steps[i]._late_matrices) {
+      // The ActorNodes ahead of this one have moved now, so this gets the
+      // same matrices as in serial.
+      if (_linear_integrator) {
+        _linear_integrator->integrate(physical, _linear_forces, dt);
+      }
+      if (_angular_integrator) {
+        _angular_integrator->integrate(physical, _angular_forces, dt);
+      }
+    } else if (!_steps[i]._parallel_safe) {
+      integrate_physical(physical, _linear_matrices.data() + _steps[i]._first_matrix, dt);
+    }
+
+    // if it's an actor node, tell it to update itself.
+    PhysicalNode *pn = physical->get_physical_node();
+    if (pn && pn->is_of_type(ActorNode::get_class_type())) {
+      ActorNode *an = (ActorNode *) pn;
+      an->update_transform();
+    }
+  }
+}
+
+/**
+ * Runs the integrators on one physical for do_physics_parallel(), given its
+ * precomputed force matrices.
+ */
+void PhysicsManager::
+integrate_physical(Physical *physical, const LMatrix4 *matrices,
+                   PN_stdfloat dt) {
+  if (_linear_integrator) {
+    _linear_integrator->integrate(physical, _linear_forces, matrices, dt);
+  }
+  if (_angular_integrator) {
+    _angular_integrator->integrate(physical, _angular_forces, dt);
+  }
+}
+
 /**
  * Write a string representation of this instance to <out>.
  */
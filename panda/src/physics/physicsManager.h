@@ -63,6 +63,10 @@ PUBLISHED:
   INLINE void set_viscosity(PN_stdfloat viscosity);
   INLINE PN_stdfloat get_viscosity() const;
 
+  INLINE void set_parallel(bool parallel);
+  INLINE bool get_parallel() const;
+  MAKE_PROPERTY(parallel, get_parallel, set_parallel);
+
   void remove_physical(Physical *p);
   void remove_physical_node(PhysicalNode *p);
   void remove_linear_force(LinearForce *f);
@@ -80,10 +84,16 @@ PUBLISHED:
   virtual void debug_output(std::ostream &out, int indent=0) const;
 
 public:
+  INLINE LinearIntegrator *get_linear_integrator() const;
+
   friend class Physical;
   static ConfigVariableInt _random_seed;
 
 private:
+  void do_physics_parallel(PN_stdfloat dt);
+  void integrate_physical(Physical *physical, const LMatrix4 *matrices,
+                          PN_stdfloat dt);
+
   PN_stdfloat _viscosity;
   PhysicalsVector _physicals;
   LinearForceVector _linear_forces;
@@ -91,6 +101,22 @@ private:
 
   PT(LinearIntegrator) _linear_integrator;
   PT(AngularIntegrator) _angular_integrator;
+
+  bool _parallel;
+
+  // Scratch space for do_physics_parallel(): the force matrices of all of the
+  // physicals, back to back, and where each physical's matrices start.  A
+  // physical with _late_matrices set depends on an ActorNode ahead of it, so
+  // its matrices are only computed once that has moved.
+  class PhysicalStep {
+  public:
+    size_t _first_matrix;
+    bool _parallel_safe;
+    bool _late_matrices;
+  };
+  typedef pvector<PhysicalStep> PhysicalSteps;
+  PhysicalSteps _steps;
+  BaseIntegrator::MatrixVector _linear_matrices;
 };
 
 #include "physicsManager.I"
@@ -0,0 +1,139 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file physicsObjectPool.cxx
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#include "physicsObjectPool.h"
+#include "physicsObject.h"
+
+#include <algorithm>
+#include <string.h>
+
+/**
+ *
+ */
+PhysicsObjectPool::
+PhysicsObjectPool() :
+  _num_objects(0)
+{
+}
+
+/**
+ *
+ */
+PhysicsObjectPool::
+~PhysicsObjectPool() {
+}
+
+/**
+ * Adds a new object at the end of the pool, at the origin and at rest, and
+ * returns its index.
+ */
+size_t PhysicsObjectPool::
+add_object() {
+  size_t n = _num_objects;
+  resize_objects(n + 1);
+  return n;
+}
+
+/**
+ * Removes the nth object.  The last object is moved into its place.
+ */
+void PhysicsObjectPool::
+remove_object(size_t n) {
+  nassertv(n < _num_objects);
+  size_t last = _num_objects - 1;
+  if (n != last) {
+    move_object(last, n);
+  }
+  resize_objects(last);
+}
+
+/**
+ * Removes all of the objects.
+ */
+void PhysicsObjectPool::
+clear() {
+  resize_objects(0);
+}
+
+/**
+ * Makes room for the indicated number of objects, so that adding them doesn't
+ * need to reallocate the arrays.
+ */
+void PhysicsObjectPool::
+reserve(size_t num_objects) {
+  for (int i = 0; i < 3; ++i) {
+    _position[i].reserve(num_objects);
+    _last_position[i].reserve(num_objects);
+    _velocity[i].reserve(num_objects);
+  }
+  _mass.reserve(num_objects);
+  _terminal_velocity.reserve(num_objects);
+}
+
+/**
+ * Sets the last position of every object to its current position, before the
+ * integrator moves them.
+ */
+void PhysicsObjectPool::
+save_last_positions() {
+  if (_num_objects != 0) {
+    for (int i = 0; i < 3; ++i) {
+      memcpy(_last_position[i].data(), _position[i].data(),
+             _num_objects * sizeof(PN_stdfloat));
+    }
+  }
+}
+
+/**
+ * Sizes the force arrays to the number of objects and sets them to zero.
+ */
+void PhysicsObjectPool::
+clear_forces() {
+  for (int i = 0; i < 3; ++i) {
+    _md_force[i].assign(_num_objects, 0.0f);
+    _force[i].assign(_num_objects, 0.0f);
+  }
+}
+
+/**
+ * Grows or shrinks all of the arrays to the indicated number of objects.  New
+ * objects are at the origin and at rest.  A derived class that keeps arrays of
+ * its own should resize those too.
+ */
+void PhysicsObjectPool::
+resize_objects(size_t num_objects) {
+  for (int i = 0; i < 3; ++i) {
+    _position[i].resize(num_objects, 0.0f);
+    _last_position[i].resize(num_objects, 0.0f);
+    _velocity[i].resize(num_objects, 0.0f);
+  }
+  _mass.resize(num_objects, 1.0f);
+  _terminal_velocity.resize(num_objects,
+                            (PN_stdfloat)PhysicsObject::_default_terminal_velocity);
+  _num_objects = num_objects;
+}
+
+/**
+ * Copies the object at index from over the one at index to.  A derived class
+ * that keeps arrays of its own should copy those too.
+ */
+void PhysicsObjectPool::
+move_object(size_t from, size_t to) {
+  for (int i = 0; i < 3; ++i) {
+    _position[i][to] = _position[i][from];
+    _last_position[i][to] = _last_position[i][from];
+    _velocity[i][to] = _velocity[i][from];
+  }
+  _mass[to] = _mass[from];
+  _terminal_velocity[to] = _terminal_velocity[from];
+}
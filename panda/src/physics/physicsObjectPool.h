@@ -0,0 +1,93 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file physicsObjectPool.h
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#ifndef PHYSICSOBJECTPOOL_H
+#define PHYSICSOBJECTPOOL_H
+
+#include "pandabase.h"
+#include "luse.h"
+#include "pvector.h"
+
+// The integrator and the common forces process a pool four objects at a time
+// when the compiler targets SSE.
+#if !defined(STDFLOAT_DOUBLE) && !defined(CPPPARSER) && \
+  (defined(__SSE__) || (_M_IX86_FP >= 1) || defined(_M_X64) || defined(_M_AMD64))
+#include <xmmintrin.h>
+#define PHYSICS_POOL_SSE 1
+#endif
+
+/**
+ * A set of unoriented point masses, stored as a structure of arrays rather
+ * than as one PhysicsObject each.  A Physical may keep its objects in one of
+ * these instead of in its PhysicsObject vector, in which case the
+ * LinearIntegrator moves all of them at once, and the forces compute their
+ * vectors for all of them at once, without a virtual call per object.
+ *
+ * The objects are always packed into the first get_num_objects() elements of
+ * the arrays.  Removing an object moves the last one into its place.
+ */
+class EXPCL_PANDA_PHYSICS PhysicsObjectPool {
+public:
+  PhysicsObjectPool();
+  virtual ~PhysicsObjectPool();
+
+  INLINE size_t get_num_objects() const;
+  size_t add_object();
+  void remove_object(size_t n);
+  void clear();
+  virtual void reserve(size_t num_objects);
+
+  INLINE LPoint3 get_position(size_t n) const;
+  INLINE void set_position(size_t n, const LPoint3 &pos);
+  INLINE void reset_position(size_t n, const LPoint3 &pos);
+  INLINE LPoint3 get_last_position(size_t n) const;
+  INLINE LVector3 get_velocity(size_t n) const;
+  INLINE void set_velocity(size_t n, const LVector3 &vel);
+  INLINE PN_stdfloat get_mass(size_t n) const;
+  INLINE void set_mass(size_t n, PN_stdfloat mass);
+  INLINE PN_stdfloat get_terminal_velocity(size_t n) const;
+  INLINE void set_terminal_velocity(size_t n, PN_stdfloat tv);
+
+  INLINE const PN_stdfloat *get_position_array(int axis) const;
+  INLINE PN_stdfloat *modify_position_array(int axis);
+  INLINE const PN_stdfloat *get_velocity_array(int axis) const;
+  INLINE PN_stdfloat *modify_velocity_array(int axis);
+  INLINE const PN_stdfloat *get_mass_array() const;
+
+  void save_last_positions();
+  void clear_forces();
+  INLINE PN_stdfloat *modify_force_array(bool mass_dependent, int axis);
+
+protected:
+  virtual void resize_objects(size_t num_objects);
+  virtual void move_object(size_t from, size_t to);
+
+private:
+  size_t _num_objects;
+
+  pvector<PN_stdfloat> _position[3];
+  pvector<PN_stdfloat> _last_position[3];
+  pvector<PN_stdfloat> _velocity[3];
+  pvector<PN_stdfloat> _mass;
+  pvector<PN_stdfloat> _terminal_velocity;
+
+  // The sums of the mass-dependent and the other forces acting on each
+  // object, which the integrator fills in with clear_forces() and the forces'
+  // add_vectors().
+  pvector<PN_stdfloat> _md_force[3];
+  pvector<PN_stdfloat> _force[3];
+};
+
+#include "physicsObjectPool.I"
+
+#endif // PHYSICSOBJECTPOOL_H
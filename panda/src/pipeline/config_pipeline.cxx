@@ -57,6 +57,14 @@ ConfigVariableInt thread_stack_size
           "created for each newly-created thread.  Not all thread "
           "implementations respect this value."));
 
+ConfigVariableInt job_system_num_worker_threads
+("job-system-num-worker-threads", -1,
+ PRC_DESC("Specifies the number of worker threads that the global JobSystem "
+          "spawns for splitting up data-parallel work.  The default, -1, "
+          "means to use one fewer than the number of CPU cores, since the "
+          "calling thread also participates.  Set this to 0 to do all such "
+          "work serially on the calling thread."));
+
 /**
  * Initializes the library.  This must be called at least once before any of
  * the functions or classes in this library can be used.  Normally it will be
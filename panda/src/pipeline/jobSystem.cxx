@@ -0,0 +1,219 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file jobSystem.cxx
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#include "jobSystem.h"
+#include "config_pipeline.h"
+#include "mutexHolder.h"
+
+#include <algorithm>
+#include <thread>
+
+patomic<JobSystem *> JobSystem::_global_ptr { nullptr };
+Mutex JobSystem::_global_lock("JobSystem::_global_lock");
+
+/**
+ *
+ */
+JobSystem::
+JobSystem(int num_workers) :
+  _lock("JobSystem::_lock"),
+  _work_cvar(_lock),
+  _done_cvar(_lock),
+  _shutdown(false)
+{
+  start_workers(num_workers);
+}
+
+/**
+ *
+ */
+JobSystem::
+~JobSystem() {
+  {
+    MutexHolder holder(_lock);
+    _shutdown = true;
+    _work_cvar.notify_all();
+  }
+
+  for (GenericThread *worker : _workers) {
+    worker->join();
+  }
+  _workers.clear();
+}
+
+/**
+ * Calls func() on every index in the range [0, count), split up into chunks
+ * of grain_size indices, and blocks until all of them have been processed.
+ * The chunks are handed out to the worker threads and to the calling thread
+ * on a first-come, first-served basis, so the order in which they are
+ * processed is not defined.  If there is nobody to share the work with, func
+ * is called just once, on the whole range.
+ *
+ * It is legal to call this recursively from within a work function.
+ */
+void JobSystem::
+parallel_process(size_t count, const RangeFunc &func, size_t grain_size) {
+  if (count == 0) {
+    return;
+  }
+  grain_size = std::max(grain_size, (size_t)1);
+
+  if (_workers.empty() || count <= grain_size) {
+    // Not worth waking anybody up for.
+    func(0, count);
+    return;
+  }
+
+  Batch batch(count, grain_size, func);
+  {
+    MutexHolder holder(_lock);
+    _batches.push_back(&batch);
+    ++batch._active_workers;
+    _work_cvar.notify_all();
+  }
+
+  // Do our share of the work.  When this returns, all chunks have at least
+  // been claimed by someone.
+  size_t finished = batch.process();
+
+  MutexHolder holder(_lock);
+  release_batch(&batch, finished);
+  while (batch._finished_chunks < batch._num_chunks ||
+         batch._active_workers > 0) {
+    _done_cvar.wait();
+  }
+}
+
+/**
+ * Returns the global JobSystem, creating it the first time this is called.
+ * The number of workers is controlled by job-system-num-worker-threads.
+ */
+JobSystem *JobSystem::
+get_global_ptr() {
+  JobSystem *ptr = _global_ptr.load(std::memory_order_acquire);
+  if (ptr == nullptr) {
+    // The first call may well come from several threads at once, so take a
+    // lock to make sure that we only ever spawn one set of workers.
+    MutexHolder holder(_global_lock);
+    ptr = _global_ptr.load(std::memory_order_relaxed);
+    if (ptr == nullptr) {
+      int num_workers = job_system_num_worker_threads;
+      if (num_workers < 0) {
+        num_workers = (int)std::thread::hardware_concurrency() - 1;
+      }
+#ifdef SIMPLE_THREADS
+      // Simple threads never run concurrently, so there is nothing to gain.
+      num_workers = 0;
+#endif
+      if (!Thread::is_threading_supported()) {
+        num_workers = 0;
+      }
+      ptr = new JobSystem(std::max(num_workers, 0));
+      _global_ptr.store(ptr, std::memory_order_release);
+    }
+  }
+  return ptr;
+}
+
+/**
+ * Claims and runs chunks of the batch until there are none left.  Returns the
+ * number of chunks this thread completed.
+ */
+size_t JobSystem::Batch::
+process() {
+  size_t finished = 0;
+  while (true) {
+    size_t chunk = _next.fetch_add(1);
+    if (chunk >= _num_chunks) {
+      break;
+    }
+    size_t begin = chunk * _grain_size;
+    size_t end = std::min(begin + _grain_size, _count);
+    _func(begin, end);
+    ++finished;
+  }
+  return finished;
+}
+
+/**
+ * Spawns the indicated number of worker threads.
+ */
+void JobSystem::
+start_workers(int num_workers) {
+  if (num_workers <= 0) {
+    return;
+  }
+
+  if (pipeline_cat.is_debug()) {
+    pipeline_cat.debug()
+      << "Spawning " << num_workers << " job worker threads.\n";
+  }
+
+  _workers.reserve(num_workers);
+  for (int i = 0; i < num_workers; ++i) {
+    std::ostringstream strm;
+    strm << "JobWorker-" << i;
+    PT(GenericThread) worker = new GenericThread(strm.str(), "JobWorkers",
+                                                 [this] { worker_loop(); });
+    if (!worker->start(TP_normal, true)) {
+      pipeline_cat.warning()
+        << "Unable to start job worker thread " << i << "\n";
+      break;
+    }
+    _workers.push_back(worker);
+  }
+}
+
+/**
+ * The main loop of each worker thread.  Picks up the oldest batch that still
+ * has unclaimed chunks and helps out with it.
+ */
+void JobSystem::
+worker_loop() {
+  MutexHolder holder(_lock);
+  while (!_shutdown) {
+    if (_batches.empty()) {
+      _work_cvar.wait();
+      continue;
+    }
+
+    Batch *batch = _batches.front();
+    ++batch->_active_workers;
+
+    _lock.release();
+    size_t finished = batch->process();
+    _lock.acquire();
+
+    release_batch(batch, finished);
+  }
+}
+
+/**
+ * Records that the current thread is done with the batch, and removes it from
+ * the queue since all of its chunks have been claimed by now.  Assumes the
+ * lock is held.
+ */
+void JobSystem::
+release_batch(Batch *batch, size_t finished_chunks) {
+  Batches::iterator bi = std::find(_batches.begin(), _batches.end(), batch);
+  if (bi != _batches.end()) {
+    _batches.erase(bi);
+  }
+
+  batch->_finished_chunks += finished_chunks;
+  --batch->_active_workers;
+  if (batch->_finished_chunks == batch->_num_chunks &&
+      batch->_active_workers == 0) {
+    _done_cvar.notify_all();
+  }
+}
@@ -0,0 +1,103 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file jobSystem.h
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include "pandabase.h"
+#include "genericThread.h"
+#include "pmutex.h"
+#include "conditionVar.h"
+#include "pdeque.h"
+#include "pvector.h"
+#include "patomic.h"
+#include "pointerTo.h"
+
+#include <functional>
+
+/**
+ * A small pool of worker threads that can be used to split up a data-parallel
+ * loop across all of the available CPU cores.  The calling thread always
+ * participates in the work, so a JobSystem with no worker threads (for
+ * instance, when Panda was compiled without true threading support) simply
+ * runs the loop serially.
+ *
+ * The work function is handed contiguous, non-overlapping index ranges, so
+ * it is safe for it to write into disjoint slots of a shared output array
+ * without any locking.
+ */
+class EXPCL_PANDA_PIPELINE JobSystem {
+protected:
+  JobSystem(int num_workers);
+
+public:
+  ~JobSystem();
+
+  typedef std::function<void(size_t begin, size_t end)> RangeFunc;
+
+  void parallel_process(size_t count, const RangeFunc &func,
+                        size_t grain_size = 1);
+
+PUBLISHED:
+  EXTENSION(void parallel_process(size_t count, PyObject *func,
+                                  size_t grain_size = 1));
+
+  INLINE int get_num_workers() const;
+  MAKE_PROPERTY(num_workers, get_num_workers);
+
+  static JobSystem *get_global_ptr();
+
+private:
+  /**
+   * One call to parallel_process().  Lives on the stack of the calling
+   * thread; the caller does not return until every worker has let go of it.
+   */
+  class Batch {
+  public:
+    INLINE Batch(size_t count, size_t grain_size, const RangeFunc &func);
+
+    size_t process();
+
+    const RangeFunc &_func;
+    size_t _count;
+    size_t _grain_size;
+    size_t _num_chunks;
+    patomic<size_t> _next;
+
+    // Protected by JobSystem::_lock.
+    size_t _finished_chunks;
+    int _active_workers;
+  };
+
+  void start_workers(int num_workers);
+  void worker_loop();
+  void release_batch(Batch *batch, size_t finished_chunks);
+
+private:
+  Mutex _lock;
+  ConditionVar _work_cvar;
+  ConditionVar _done_cvar;
+  typedef pdeque<Batch *> Batches;
+  Batches _batches;
+  bool _shutdown;
+
+  typedef pvector<PT(GenericThread)> Workers;
+  Workers _workers;
+
+  static patomic<JobSystem *> _global_ptr;
+  static Mutex _global_lock;
+};
+
+#include "jobSystem.I"
+
+#endif  // JOBSYSTEM_H
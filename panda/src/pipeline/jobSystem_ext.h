@@ -0,0 +1,40 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file jobSystem_ext.h
+ * @author Brian Lach
+ * @date 2026-10-17
+ */
+
+#ifndef JOBSYSTEM_EXT_H
+#define JOBSYSTEM_EXT_H
+
+#include "dtoolbase.h"
+
+#ifdef HAVE_PYTHON
+
+#include "extension.h"
+#include "jobSystem.h"
+#include "py_panda.h"
+
+/**
+ * This class defines the extension methods for JobSystem, which are called
+ * instead of any C++ methods with the same prototype.
+ */
+template<>
+class Extension<JobSystem> : public ExtensionBase<JobSystem> {
+public:
+  INLINE void parallel_process(size_t count, PyObject *func,
+                               size_t grain_size);
+};
+
+#include "jobSystem_ext.I"
+
+#endif  // HAVE_PYTHON
+
+#endif  // JOBSYSTEM_EXT_H
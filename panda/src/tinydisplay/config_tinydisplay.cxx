@@ -57,6 +57,34 @@ ConfigVariableBool td_perspective_textures
             "textures on the tinydisplay software renderer, for a small "
             "performance gain."));
 
+ConfigVariableBool td_tile_rasterizer
+  ("td-tile-rasterizer", false,
+   PRC_DESC("Configure this true to have the tinydisplay software renderer "
+            "collect the triangles of each Geom, sort them into horizontal "
+            "bands of the screen, and draw the bands in parallel on the "
+            "job system's worker threads.  The result is identical to "
+            "drawing the triangles one at a time.  See also "
+            "job-system-num-worker-threads."));
+
+ConfigVariableInt td_tile_rows
+  ("td-tile-rows", 32,
+   PRC_DESC("The height, in pixels, of each band of the screen drawn by "
+            "td-tile-rasterizer."));
+
+ConfigVariableInt td_tile_min_triangles
+  ("td-tile-min-triangles", 64,
+   PRC_DESC("Geoms with fewer triangles than this are drawn in the usual "
+            "way, even if td-tile-rasterizer is true, since they are not "
+            "worth handing off to the worker threads."));
+
+ConfigVariableBool td_simd_vertices
+  ("td-simd-vertices", true,
+   PRC_DESC("Configure this false to have the tinydisplay software renderer "
+            "transform, light and clip the vertices one at a time, rather "
+            "than four at a time with SSE instructions.  The results are "
+            "the same either way; this is only useful for comparing the "
+            "performance."));
+
 /**
  * Initializes the library.  This must be called at least once before any of
  * the functions or classes in this library can be used.  Normally it will be
@@ -29,5 +29,9 @@ extern ConfigVariableInt td_texture_ram;
 extern ConfigVariableBool td_ignore_mipmaps;
 extern ConfigVariableBool td_ignore_clamp;
 extern ConfigVariableBool td_perspective_textures;
+extern ConfigVariableBool td_tile_rasterizer;
+extern ConfigVariableInt td_tile_rows;
+extern ConfigVariableInt td_tile_min_triangles;
+extern ConfigVariableBool td_simd_vertices;
 
 #endif
@@ -1,6 +1,10 @@
 #include "zgl.h"
 #include <math.h>
 
+#ifdef TGL_FEATURE_SSE
+#include <xmmintrin.h>
+#endif
+
 static inline PN_stdfloat clampf(PN_stdfloat a,PN_stdfloat min,PN_stdfloat max)
 {
   if (a<min) return min;
@@ -8,8 +12,10 @@ static inline PN_stdfloat clampf(PN_stdfloat a,PN_stdfloat min,PN_stdfloat max)
   else return a;
 }
 
-/* non optimized lighting model */
-void gl_shade_vertex(GLContext *c,GLVertex *v)
+/* non optimized lighting model; ambient and diffuse are the material colors
+   to use for this vertex */
+static inline void
+shade_vertex(GLContext *c, GLVertex *v, const V4 *ambient, const V4 *diffuse)
 {
   PN_stdfloat R,G,B,A;
   GLMaterial *m;
@@ -24,18 +30,18 @@ void gl_shade_vertex(GLContext *c,GLVertex *v)
   n.v[1]=v->normal.v[1];
   n.v[2]=v->normal.v[2];
 
-  R=m->emission.v[0]+m->ambient.v[0]*c->ambient_light_model.v[0];
-  G=m->emission.v[1]+m->ambient.v[1]*c->ambient_light_model.v[1];
-  B=m->emission.v[2]+m->ambient.v[2]*c->ambient_light_model.v[2];
-  A=clampf(m->diffuse.v[3],0,1);
+  R=m->emission.v[0]+ambient->v[0]*c->ambient_light_model.v[0];
+  G=m->emission.v[1]+ambient->v[1]*c->ambient_light_model.v[1];
+  B=m->emission.v[2]+ambient->v[2]*c->ambient_light_model.v[2];
+  A=clampf(diffuse->v[3],0,1);
 
   for(l=c->first_light;l!=nullptr;l=l->next) {
     PN_stdfloat lR,lB,lG;
     
     /* ambient */
-    lR=l->ambient.v[0] * m->ambient.v[0];
-    lG=l->ambient.v[1] * m->ambient.v[1];
-    lB=l->ambient.v[2] * m->ambient.v[2];
+    lR=l->ambient.v[0] * ambient->v[0];
+    lG=l->ambient.v[1] * ambient->v[1];
+    lB=l->ambient.v[2] * ambient->v[2];
 
     if (l->position.v[3] == 0) {
       /* light at infinity */
@@ -62,9 +68,9 @@ void gl_shade_vertex(GLContext *c,GLVertex *v)
     if (twoside && dot < 0) dot = -dot;
     if (dot>0) {
       /* diffuse light */
-      lR+=dot * l->diffuse.v[0] * m->diffuse.v[0];
-      lG+=dot * l->diffuse.v[1] * m->diffuse.v[1];
-      lB+=dot * l->diffuse.v[2] * m->diffuse.v[2];
+      lR+=dot * l->diffuse.v[0] * diffuse->v[0];
+      lG+=dot * l->diffuse.v[1] * diffuse->v[1];
+      lB+=dot * l->diffuse.v[2] * diffuse->v[2];
 
       /* spot light */
       if (l->spot_cutoff != 180) {
@@ -137,3 +143,250 @@ void gl_shade_vertex(GLContext *c,GLVertex *v)
   //v->color.v[3]=clampf(A*v->color.v[3],0,1);
 }
 
+void gl_shade_vertex(GLContext *c,GLVertex *v)
+{
+  shade_vertex(c, v, &c->materials[0].ambient, &c->materials[0].diffuse);
+}
+
+#ifdef TGL_FEATURE_SSE
+
+/* Returns a where mask is set, b elsewhere. */
+static inline __m128
+sse_select(__m128 mask, __m128 a, __m128 b) {
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+/* The same as clampf(a, 0, 1), including for NaN. */
+static inline __m128
+sse_clamp01(__m128 a) {
+  a = sse_select(_mm_cmplt_ps(a, _mm_setzero_ps()), _mm_setzero_ps(), a);
+  return sse_select(_mm_cmpgt_ps(a, _mm_set1_ps(1.0f)), _mm_set1_ps(1.0f), a);
+}
+
+static inline __m128
+sse_abs(__m128 a) {
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+}
+
+#define SSE_GATHER(v, member, i) \
+  _mm_setr_ps((v)[0].member.v[i], (v)[1].member.v[i], (v)[2].member.v[i], (v)[3].member.v[i])
+
+/* Lights four vertices at once, with the vertices' values in SoA form.  This
+   performs the same operations in the same order as shade_vertex(), so that
+   the results are the same, bit for bit.  The operations that need a table
+   lookup or pow() are done one lane at a time. */
+static void
+shade_vertex_sse(GLContext *c, GLVertex *v, int color_ambient, int color_diffuse)
+{
+  GLMaterial *m = &c->materials[0];
+  int twoside = c->light_model_two_side;
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  const __m128 epsilon = _mm_set1_ps(1E-3f);
+
+  __m128 nx = SSE_GATHER(v, normal, 0);
+  __m128 ny = SSE_GATHER(v, normal, 1);
+  __m128 nz = SSE_GATHER(v, normal, 2);
+  __m128 ex = SSE_GATHER(v, ec, 0);
+  __m128 ey = SSE_GATHER(v, ec, 1);
+  __m128 ez = SSE_GATHER(v, ec, 2);
+
+  /* with color material, the vertex color replaces the material color */
+  __m128 ar, ag, ab;
+  if (color_ambient) {
+    ar = SSE_GATHER(v, color, 0);
+    ag = SSE_GATHER(v, color, 1);
+    ab = SSE_GATHER(v, color, 2);
+  } else {
+    ar = _mm_set1_ps(m->ambient.v[0]);
+    ag = _mm_set1_ps(m->ambient.v[1]);
+    ab = _mm_set1_ps(m->ambient.v[2]);
+  }
+  __m128 dr, dg, db, da;
+  if (color_diffuse) {
+    dr = SSE_GATHER(v, color, 0);
+    dg = SSE_GATHER(v, color, 1);
+    db = SSE_GATHER(v, color, 2);
+    da = SSE_GATHER(v, color, 3);
+  } else {
+    dr = _mm_set1_ps(m->diffuse.v[0]);
+    dg = _mm_set1_ps(m->diffuse.v[1]);
+    db = _mm_set1_ps(m->diffuse.v[2]);
+    da = _mm_set1_ps(m->diffuse.v[3]);
+  }
+
+  __m128 R = _mm_add_ps(_mm_set1_ps(m->emission.v[0]), _mm_mul_ps(ar, _mm_set1_ps(c->ambient_light_model.v[0])));
+  __m128 G = _mm_add_ps(_mm_set1_ps(m->emission.v[1]), _mm_mul_ps(ag, _mm_set1_ps(c->ambient_light_model.v[1])));
+  __m128 B = _mm_add_ps(_mm_set1_ps(m->emission.v[2]), _mm_mul_ps(ab, _mm_set1_ps(c->ambient_light_model.v[2])));
+  __m128 A = sse_clamp01(da);
+
+  /* the normalized eye vector, for the local light model */
+  __m128 vcx = zero;
+  if (c->local_light_model) {
+    __m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)),
+                                        _mm_mul_ps(ez, ez)));
+    __m128 nonzero = _mm_cmpneq_ps(len, zero);
+    vcx = sse_select(nonzero, _mm_div_ps(ex, len), ex);
+  }
+
+  for (GLLight *l = c->first_light; l != nullptr; l = l->next) {
+    /* ambient */
+    __m128 lR = _mm_mul_ps(_mm_set1_ps(l->ambient.v[0]), ar);
+    __m128 lG = _mm_mul_ps(_mm_set1_ps(l->ambient.v[1]), ag);
+    __m128 lB = _mm_mul_ps(_mm_set1_ps(l->ambient.v[2]), ab);
+
+    __m128 dx, dy, dz, att;
+    if (l->position.v[3] == 0) {
+      /* light at infinity */
+      dx = _mm_set1_ps(l->position.v[0]);
+      dy = _mm_set1_ps(l->position.v[1]);
+      dz = _mm_set1_ps(l->position.v[2]);
+      att = _mm_set1_ps(1.0f);
+    } else {
+      /* distance attenuation */
+      dx = _mm_sub_ps(_mm_set1_ps(l->position.v[0]), ex);
+      dy = _mm_sub_ps(_mm_set1_ps(l->position.v[1]), ey);
+      dz = _mm_sub_ps(_mm_set1_ps(l->position.v[2]), ez);
+      __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                                           _mm_mul_ps(dz, dz)));
+      /* dist > 1E-3 (a double) is the same as dist >= 1E-3f */
+      __m128 far = _mm_cmpge_ps(dist, epsilon);
+      __m128 tmp = _mm_div_ps(_mm_set1_ps(1.0f), dist);
+      dx = sse_select(far, _mm_mul_ps(dx, tmp), dx);
+      dy = sse_select(far, _mm_mul_ps(dy, tmp), dy);
+      dz = sse_select(far, _mm_mul_ps(dz, tmp), dz);
+      __m128 denom = _mm_add_ps(_mm_set1_ps(l->attenuation[1]), _mm_mul_ps(dist, _mm_set1_ps(l->attenuation[2])));
+      denom = _mm_add_ps(_mm_set1_ps(l->attenuation[0]), _mm_mul_ps(dist, denom));
+      att = _mm_div_ps(_mm_set1_ps(1.0f), denom);
+    }
+
+    __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, nx), _mm_mul_ps(dy, ny)), _mm_mul_ps(dz, nz));
+    if (twoside) {
+      dot = sse_abs(dot);
+    }
+    __m128 lit = _mm_cmpgt_ps(dot, zero);
+
+    /* the lanes that receive no contribution from this light at all */
+    __m128 excluded = zero;
+
+    if (_mm_movemask_ps(lit) != 0) {
+      /* diffuse light */
+      lR = sse_select(lit, _mm_add_ps(lR, _mm_mul_ps(_mm_mul_ps(dot, _mm_set1_ps(l->diffuse.v[0])), dr)), lR);
+      lG = sse_select(lit, _mm_add_ps(lG, _mm_mul_ps(_mm_mul_ps(dot, _mm_set1_ps(l->diffuse.v[1])), dg)), lG);
+      lB = sse_select(lit, _mm_add_ps(lB, _mm_mul_ps(_mm_mul_ps(dot, _mm_set1_ps(l->diffuse.v[2])), db)), lB);
+
+      /* spot light */
+      if (l->spot_cutoff != 180) {
+        __m128 dot_spot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_set1_ps(l->norm_spot_direction.v[0])),
+                                                _mm_mul_ps(dy, _mm_set1_ps(l->norm_spot_direction.v[1]))),
+                                     _mm_mul_ps(dz, _mm_set1_ps(l->norm_spot_direction.v[2])));
+        dot_spot = _mm_xor_ps(dot_spot, sign);
+        if (twoside) {
+          dot_spot = sse_abs(dot_spot);
+        }
+        excluded = _mm_and_ps(lit, _mm_cmplt_ps(dot_spot, _mm_set1_ps(l->cos_spot_cutoff)));
+        lit = _mm_andnot_ps(excluded, lit);
+
+        if (l->spot_exponent > 0) {
+          int mask = _mm_movemask_ps(lit);
+          float att_lanes[4], dot_spot_lanes[4];
+          _mm_storeu_ps(att_lanes, att);
+          _mm_storeu_ps(dot_spot_lanes, dot_spot);
+          for (int i = 0; i < 4; ++i) {
+            if (mask & (1 << i)) {
+              PN_stdfloat a = att_lanes[i];
+              PN_stdfloat ds = dot_spot_lanes[i];
+              a = a * pow(ds, l->spot_exponent);
+              att_lanes[i] = a;
+            }
+          }
+          att = _mm_loadu_ps(att_lanes);
+        }
+      }
+
+      /* specular light */
+      __m128 sx, sy, sz;
+      if (c->local_light_model) {
+        /* the same vector as computed by shade_vertex() */
+        sx = _mm_sub_ps(dx, vcx);
+        sy = _mm_sub_ps(dy, vcx);
+        sz = _mm_sub_ps(dz, vcx);
+      } else {
+        sx = dx;
+        sy = dy;
+        sz = _mm_add_ps(dz, _mm_set1_ps(1.0f));
+      }
+      __m128 dot_spec = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, sx), _mm_mul_ps(ny, sy)), _mm_mul_ps(nz, sz));
+      if (twoside) {
+        dot_spec = sse_abs(dot_spec);
+      }
+      __m128 spec_lit = _mm_and_ps(lit, _mm_cmpgt_ps(dot_spec, zero));
+      int spec_mask = _mm_movemask_ps(spec_lit);
+      if (spec_mask != 0) {
+        __m128 tmp = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, sx), _mm_mul_ps(sy, sy)),
+                                            _mm_mul_ps(sz, sz)));
+        dot_spec = sse_select(_mm_cmpge_ps(tmp, epsilon), _mm_div_ps(dot_spec, tmp), dot_spec);
+
+        GLSpecBuf *specbuf = specbuf_get_buffer(c, m->shininess_i, m->shininess);
+        float spec_lanes[4];
+        _mm_storeu_ps(spec_lanes, dot_spec);
+        for (int i = 0; i < 4; ++i) {
+          if (spec_mask & (1 << i)) {
+            PN_stdfloat ds = spec_lanes[i];
+            int idx = (int)(ds*SPECULAR_BUFFER_SIZE);
+            if (idx > SPECULAR_BUFFER_SIZE) idx = SPECULAR_BUFFER_SIZE;
+            spec_lanes[i] = specbuf->buf[idx];
+          }
+        }
+        __m128 spec = _mm_loadu_ps(spec_lanes);
+        lR = sse_select(spec_lit, _mm_add_ps(lR, _mm_mul_ps(_mm_mul_ps(spec, _mm_set1_ps(l->specular.v[0])), _mm_set1_ps(m->specular.v[0]))), lR);
+        lG = sse_select(spec_lit, _mm_add_ps(lG, _mm_mul_ps(_mm_mul_ps(spec, _mm_set1_ps(l->specular.v[1])), _mm_set1_ps(m->specular.v[1]))), lG);
+        lB = sse_select(spec_lit, _mm_add_ps(lB, _mm_mul_ps(_mm_mul_ps(spec, _mm_set1_ps(l->specular.v[2])), _mm_set1_ps(m->specular.v[2]))), lB);
+      }
+    }
+
+    R = sse_select(excluded, R, _mm_add_ps(R, _mm_mul_ps(att, lR)));
+    G = sse_select(excluded, G, _mm_add_ps(G, _mm_mul_ps(att, lG)));
+    B = sse_select(excluded, B, _mm_add_ps(B, _mm_mul_ps(att, lB)));
+  }
+
+  R = sse_clamp01(R);
+  G = sse_clamp01(G);
+  B = sse_clamp01(B);
+  A = sse_clamp01(A);
+  _MM_TRANSPOSE4_PS(R, G, B, A);
+  _mm_storeu_ps(v[0].color.v, R);
+  _mm_storeu_ps(v[1].color.v, G);
+  _mm_storeu_ps(v[2].color.v, B);
+  _mm_storeu_ps(v[3].color.v, A);
+}
+
+#undef SSE_GATHER
+
+#endif  // TGL_FEATURE_SSE
+
+/* Lights count vertices.  If color_ambient or color_diffuse is set, each
+   vertex's own color is used in place of the material's ambient or diffuse
+   color, respectively.  If use_simd is true and SSE is available, the vertices
+   are processed four at a time; the results are the same either way. */
+void gl_shade_vertex_batch(GLContext *c, GLVertex *v, int count,
+                           int color_ambient, int color_diffuse, int use_simd)
+{
+  int i = 0;
+
+#ifdef TGL_FEATURE_SSE
+  if (use_simd) {
+    for (; i + 4 <= count; i += 4) {
+      shade_vertex_sse(c, v + i, color_ambient, color_diffuse);
+    }
+  }
+#endif
+
+  GLMaterial *m = &c->materials[0];
+  for (; i < count; ++i) {
+    V4 color = v[i].color;
+    shade_vertex(c, v + i,
+                 color_ambient ? &color : &m->ambient,
+                 color_diffuse ? &color : &m->diffuse);
+  }
+}
@@ -706,17 +706,6 @@ begin_draw_primitives(const GeomPipelineReader *geom_reader,
       _c->current_color.v[1] = max(d[1] * s[1], (PN_stdfloat)0);
       _c->current_color.v[2] = max(d[2] * s[2], (PN_stdfloat)0);
       _c->current_color.v[3] = max(d[3] * s[3], (PN_stdfloat)0);
-
-      if (_color_material_flags) {
-        if (_color_material_flags & CMF_ambient) {
-          _c->materials[0].ambient = _c->current_color;
-          _c->materials[1].ambient = _c->current_color;
-        }
-        if (_color_material_flags & CMF_diffuse) {
-          _c->materials[0].diffuse = _c->current_color;
-          _c->materials[1].diffuse = _c->current_color;
-        }
-      }
     }
 
     v->color = _c->current_color;
@@ -730,13 +719,40 @@ begin_draw_primitives(const GeomPipelineReader *geom_reader,
         _c->current_normal.v[3] = 0.0f;
       }
 
-      gl_vertex_transform(_c, v);
-      gl_shade_vertex(_c, v);
+      // This is replaced with the transformed normal below.
+      v->normal.v[0] = _c->current_normal.v[0];
+      v->normal.v[1] = _c->current_normal.v[1];
+      v->normal.v[2] = _c->current_normal.v[2];
+    }
+  }
 
-    } else {
-      gl_vertex_transform(_c, v);
+  // Now transform and light the vertices all at once, which lets us process
+  // several of them at a time with SIMD instructions.
+  gl_vertex_transform_batch(_c, _vertices, num_used_vertices, td_simd_vertices);
+
+  if (_c->lighting_enabled) {
+    // With a color material, each vertex's own color stands in for the
+    // material's ambient and/or diffuse color.
+    bool color_ambient = needs_color && (_color_material_flags & CMF_ambient) != 0;
+    bool color_diffuse = needs_color && (_color_material_flags & CMF_diffuse) != 0;
+    gl_shade_vertex_batch(_c, _vertices, num_used_vertices,
+                          color_ambient, color_diffuse, td_simd_vertices);
+  }
+
+  if (needs_color && _color_material_flags) {
+    // Leave the material as it would have been after the last vertex.
+    if (_color_material_flags & CMF_ambient) {
+      _c->materials[0].ambient = _c->current_color;
+      _c->materials[1].ambient = _c->current_color;
     }
+    if (_color_material_flags & CMF_diffuse) {
+      _c->materials[0].diffuse = _c->current_color;
+      _c->materials[1].diffuse = _c->current_color;
+    }
+  }
 
+  for (i = 0; i < num_used_vertices; ++i) {
+    GLVertex *v = &_vertices[i];
     if (v->clip_code == 0) {
       gl_transform_to_viewport(_c, v);
     }
@@ -937,6 +953,10 @@ begin_draw_primitives(const GeomPipelineReader *geom_reader,
   pixel_count_smooth_multitex3 = 0;
 #endif  // DO_PSTATS
 
+  // If requested, the triangles are collected and drawn in parallel by
+  // end_draw_primitives().
+  _c->tile_rasterizer = td_tile_rasterizer ? &_tile_rasterizer : nullptr;
+
   return true;
 }
 
@@ -1175,6 +1195,12 @@ draw_lines(const GeomPrimitivePipelineReader *reader, bool force) {
   }
 #endif  // NDEBUG
 
+  // These aren't collected by the tile rasterizer, so the triangles that came
+  // before must be drawn first.
+  if (_c->tile_rasterizer != nullptr) {
+    _tile_rasterizer.flush(_c->zb);
+  }
+
   int num_vertices = reader->get_num_vertices();
   _vertices_other_pcollector.add_level(num_vertices);
 
@@ -1252,6 +1278,12 @@ draw_points(const GeomPrimitivePipelineReader *reader, bool force) {
   }
 #endif  // NDEBUG
 
+  // These aren't collected by the tile rasterizer, so the triangles that came
+  // before must be drawn first.
+  if (_c->tile_rasterizer != nullptr) {
+    _tile_rasterizer.flush(_c->zb);
+  }
+
   int num_vertices = reader->get_num_vertices();
   _vertices_other_pcollector.add_level(num_vertices);
 
@@ -1319,6 +1351,10 @@ draw_points(const GeomPrimitivePipelineReader *reader, bool force) {
  */
 void TinyGraphicsStateGuardian::
 end_draw_primitives() {
+  if (_c->tile_rasterizer != nullptr) {
+    _tile_rasterizer.flush(_c->zb);
+    _c->tile_rasterizer = nullptr;
+  }
 
 #ifdef DO_PSTATS
   _pixel_count_white_untextured_pcollector.add_level(pixel_count_white_untextured);
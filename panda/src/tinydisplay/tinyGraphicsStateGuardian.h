@@ -22,6 +22,7 @@
 #include "zmath.h"
 #include "zbuffer.h"
 #include "zgl.h"
+#include "tinyTileRasterizer.h"
 #include "geomVertexReader.h"
 
 class TinyTextureContext;
@@ -154,6 +155,7 @@ private:
   ZBuffer *_aux_frame_buffer;
 
   GLContext *_c;
+  TinyTileRasterizer _tile_rasterizer;
 
   enum ColorMaterialFlags {
     CMF_ambient   = 0x001,
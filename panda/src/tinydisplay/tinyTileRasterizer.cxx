@@ -0,0 +1,134 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file tinyTileRasterizer.cxx
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#include "tinyTileRasterizer.h"
+#include "config_tinydisplay.h"
+#include "jobSystem.h"
+#include "pStatTimer.h"
+
+PStatCollector TinyTileRasterizer::_bin_pcollector("Draw:Tiles:Bin");
+PStatCollector TinyTileRasterizer::_raster_pcollector("Draw:Tiles:Rasterize");
+
+/**
+ *
+ */
+TinyTileRasterizer::
+TinyTileRasterizer() :
+  _band_height(1)
+{
+}
+
+/**
+ * Draws all of the triangles that have been recorded since the last call into
+ * the indicated ZBuffer, and empties the list.
+ */
+void TinyTileRasterizer::
+flush(ZBuffer *zb) {
+  if (_triangles.empty()) {
+    return;
+  }
+
+  _band_height = std::max((int)td_tile_rows, 1);
+  int num_bands = (zb->ysize + _band_height - 1) / _band_height;
+
+  JobSystem *jobs = JobSystem::get_global_ptr();
+  if (num_bands <= 1 || jobs->get_num_workers() == 0 ||
+      _triangles.size() < (size_t)std::max((int)td_tile_min_triangles, 1)) {
+    // Not worth the trouble; just draw them in order.
+    for (Triangle &tri : _triangles) {
+      (*tri._func)(zb, &tri._p0, &tri._p1, &tri._p2);
+    }
+    _triangles.clear();
+    return;
+  }
+
+  {
+    PStatTimer timer(_bin_pcollector);
+
+    if (_bins.size() < (size_t)num_bands) {
+      _bins.resize(num_bands);
+    }
+    for (int band = 0; band < num_bands; ++band) {
+      _bins[band].clear();
+    }
+
+    // A triangle covers the lines from its topmost to its bottommost vertex,
+    // inclusive.
+    int ylimit = zb->ysize - 1;
+    for (size_t i = 0; i < _triangles.size(); ++i) {
+      const Triangle &tri = _triangles[i];
+      int ymin = std::min(tri._p0.y, std::min(tri._p1.y, tri._p2.y));
+      int ymax = std::max(tri._p0.y, std::max(tri._p1.y, tri._p2.y));
+      ymin = std::max(ymin, 0);
+      ymax = std::min(ymax, ylimit);
+
+      for (int band = ymin / _band_height; band <= ymax / _band_height; ++band) {
+        _bins[band].push_back((uint32_t)i);
+      }
+    }
+  }
+
+  {
+    PStatTimer timer(_raster_pcollector);
+
+#ifdef DO_PSTATS
+    _pixel_counts.assign(num_bands, ZPixelCounts());
+    ZPixelCounts *counts = _pixel_counts.data();
+#else
+    ZPixelCounts *counts = nullptr;
+#endif
+
+    jobs->parallel_process(num_bands, [this, zb, counts] (size_t begin, size_t end) {
+      for (size_t band = begin; band < end; ++band) {
+        draw_band(zb, (int)band, (counts != nullptr) ? counts + band : nullptr);
+      }
+    });
+
+#ifdef DO_PSTATS
+    for (const ZPixelCounts &band_counts : _pixel_counts) {
+      ZB_addPixelCounts(&band_counts);
+    }
+#endif
+  }
+
+  _triangles.clear();
+}
+
+/**
+ * Draws the triangles in the indicated band, in the order in which they were
+ * recorded.  This is called by the worker threads.  The pixels drawn are
+ * counted in the indicated counters, if they are not NULL.
+ */
+void TinyTileRasterizer::
+draw_band(const ZBuffer *zb, int band, ZPixelCounts *counts) const {
+  const Bin &bin = _bins[band];
+  if (bin.empty()) {
+    return;
+  }
+
+  // Each band gets its own copy of the ZBuffer header, which differs only in
+  // the lines it is allowed to touch.  The triangle functions also scribble
+  // on the points, so we hand them a copy of those as well.
+  ZBuffer band_zb = *zb;
+  band_zb.band_ymin = band * _band_height;
+  band_zb.band_ymax = std::min(band_zb.band_ymin + _band_height, zb->ysize);
+  band_zb.pixel_counts = counts;
+
+  for (uint32_t index : bin) {
+    const Triangle &tri = _triangles[index];
+    ZBufferPoint p0 = tri._p0;
+    ZBufferPoint p1 = tri._p1;
+    ZBufferPoint p2 = tri._p2;
+    (*tri._func)(&band_zb, &p0, &p1, &p2);
+  }
+}
@@ -0,0 +1,73 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file tinyTileRasterizer.h
+ * @author Brian Lach
+ * @date 2026-10-16
+ */
+
+#ifndef TINYTILERASTERIZER_H
+#define TINYTILERASTERIZER_H
+
+#include "pandabase.h"
+#include "pvector.h"
+#include "pStatCollector.h"
+#include "zbuffer.h"
+
+/**
+ * Collects the triangles that are submitted to the tinydisplay renderer
+ * instead of drawing them right away, sorts them into horizontal bands of the
+ * screen, and then draws the bands in parallel on the JobSystem's worker
+ * threads.
+ *
+ * Each band draws its triangles in the order they were submitted, using the
+ * same triangle functions as the serial path, restricted to the lines within
+ * the band (see ZBuffer::band_ymin).  Since the bands do not overlap and the
+ * triangle functions step over the lines outside of the band exactly as they
+ * would otherwise, the result is identical to drawing the triangles one at a
+ * time.
+ */
+class EXPCL_TINYDISPLAY TinyTileRasterizer {
+public:
+  TinyTileRasterizer();
+
+  INLINE bool is_empty() const;
+  INLINE void add_triangle(ZB_fillTriangleFunc func, const ZBufferPoint *p0,
+                           const ZBufferPoint *p1, const ZBufferPoint *p2);
+  void flush(ZBuffer *zb);
+
+private:
+  void draw_band(const ZBuffer *zb, int band, ZPixelCounts *counts) const;
+
+  class Triangle {
+  public:
+    ZB_fillTriangleFunc _func;
+    ZBufferPoint _p0, _p1, _p2;
+  };
+  typedef pvector<Triangle> Triangles;
+  Triangles _triangles;
+
+  // The indices of the triangles that touch each band.
+  typedef pvector<uint32_t> Bin;
+  typedef pvector<Bin> Bins;
+  Bins _bins;
+  int _band_height;
+
+#ifdef DO_PSTATS
+  // The pixels drawn by each band, added into the global counts afterwards.
+  typedef pvector<ZPixelCounts> PixelCounts;
+  PixelCounts _pixel_counts;
+#endif
+
+  static PStatCollector _bin_pcollector;
+  static PStatCollector _raster_pcollector;
+};
+
+#include "tinyTileRasterizer.I"
+
+#endif
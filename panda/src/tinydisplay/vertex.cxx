@@ -1,6 +1,10 @@
 #include "zgl.h"
 #include <string.h>
 
+#ifdef TGL_FEATURE_SSE
+#include <xmmintrin.h>
+#endif
+
 void gl_eval_viewport(GLContext * c) {
   GLViewport *v = &c->viewport;
   GLScissor *s = &c->scissor;
@@ -20,12 +24,11 @@ void gl_eval_viewport(GLContext * c) {
   v->scale.v[2] = -((zsize - 0.5f) / 2.0f);
 }
 
-/* coords, tranformation , clip code and projection */
-/* TODO : handle all cases */
-void 
-gl_vertex_transform(GLContext * c, GLVertex * v) {
+/* coords, tranformation , clip code and projection; n is the normal to use
+   if lighting is enabled */
+static inline void
+vertex_transform(GLContext *c, GLVertex *v, const V3 *n) {
   PN_stdfloat *m;
-  V4 *n;
 
   if (c->lighting_enabled) {
     /* eye coordinates needed for lighting */
@@ -52,7 +55,6 @@ gl_vertex_transform(GLContext * c, GLVertex * v) {
                   v->ec.v[2] * m[14] + v->ec.v[3] * m[15]);
 
     m = &c->matrix_model_view_inv.m[0][0];
-    n = &c->current_normal;
 
     v->normal.v[0] = (n->v[0] * m[0] + n->v[1] * m[1] + n->v[2] * m[2]) * c->normal_scale;
     v->normal.v[1] = (n->v[0] * m[4] + n->v[1] * m[5] + n->v[2] * m[6]) * c->normal_scale;
@@ -82,3 +84,169 @@ gl_vertex_transform(GLContext * c, GLVertex * v) {
 
   v->clip_code = gl_clipcode(v->pc.v[0], v->pc.v[1], v->pc.v[2], v->pc.v[3]);
 }
+
+/* TODO : handle all cases */
+void
+gl_vertex_transform(GLContext * c, GLVertex * v) {
+  V3 n;
+  n.v[0] = c->current_normal.v[0];
+  n.v[1] = c->current_normal.v[1];
+  n.v[2] = c->current_normal.v[2];
+  vertex_transform(c, v, &n);
+}
+
+#ifdef TGL_FEATURE_SSE
+
+/* Returns a * m[0] + b * m[1] + c * m[2] + m[3], for four vertices at once,
+   with the operations in the same order as the scalar code. */
+static inline __m128
+sse_dot3_add(__m128 a, __m128 b, __m128 c, const PN_stdfloat *m) {
+  __m128 r = _mm_add_ps(_mm_mul_ps(a, _mm_set1_ps(m[0])),
+                        _mm_mul_ps(b, _mm_set1_ps(m[1])));
+  r = _mm_add_ps(r, _mm_mul_ps(c, _mm_set1_ps(m[2])));
+  return _mm_add_ps(r, _mm_set1_ps(m[3]));
+}
+
+/* Returns a * m[0] + b * m[1] + c * m[2] + d * m[3] for four vertices. */
+static inline __m128
+sse_dot4(__m128 a, __m128 b, __m128 c, __m128 d, const PN_stdfloat *m) {
+  __m128 r = _mm_add_ps(_mm_mul_ps(a, _mm_set1_ps(m[0])),
+                        _mm_mul_ps(b, _mm_set1_ps(m[1])));
+  r = _mm_add_ps(r, _mm_mul_ps(c, _mm_set1_ps(m[2])));
+  return _mm_add_ps(r, _mm_mul_ps(d, _mm_set1_ps(m[3])));
+}
+
+/* Returns a * m[0] + b * m[1] + c * m[2] for four vertices. */
+static inline __m128
+sse_dot3(__m128 a, __m128 b, __m128 c, const PN_stdfloat *m) {
+  __m128 r = _mm_add_ps(_mm_mul_ps(a, _mm_set1_ps(m[0])),
+                        _mm_mul_ps(b, _mm_set1_ps(m[1])));
+  return _mm_add_ps(r, _mm_mul_ps(c, _mm_set1_ps(m[2])));
+}
+
+/* Transforms four vertices at once.  This produces the same results as
+   vertex_transform(), bit for bit. */
+static void
+vertex_transform_sse(GLContext *c, GLVertex *v) {
+  // Load the coordinates and transpose them into one register per component.
+  __m128 x = _mm_loadu_ps(v[0].coord.v);
+  __m128 y = _mm_loadu_ps(v[1].coord.v);
+  __m128 z = _mm_loadu_ps(v[2].coord.v);
+  __m128 w = _mm_loadu_ps(v[3].coord.v);
+  _MM_TRANSPOSE4_PS(x, y, z, w);
+
+  __m128 px, py, pz, pw;
+  if (c->lighting_enabled) {
+    const PN_stdfloat *m = &c->matrix_model_view.m[0][0];
+    __m128 ex = sse_dot3_add(x, y, z, m);
+    __m128 ey = sse_dot3_add(x, y, z, m + 4);
+    __m128 ez = sse_dot3_add(x, y, z, m + 8);
+    __m128 ew = sse_dot3_add(x, y, z, m + 12);
+
+    m = &c->matrix_projection.m[0][0];
+    px = sse_dot4(ex, ey, ez, ew, m);
+    py = sse_dot4(ex, ey, ez, ew, m + 4);
+    pz = sse_dot4(ex, ey, ez, ew, m + 8);
+    pw = sse_dot4(ex, ey, ez, ew, m + 12);
+
+    _MM_TRANSPOSE4_PS(ex, ey, ez, ew);
+    _mm_storeu_ps(v[0].ec.v, ex);
+    _mm_storeu_ps(v[1].ec.v, ey);
+    _mm_storeu_ps(v[2].ec.v, ez);
+    _mm_storeu_ps(v[3].ec.v, ew);
+
+    // The normals are only three components, so we gather them by hand.
+    __m128 nx = _mm_setr_ps(v[0].normal.v[0], v[1].normal.v[0], v[2].normal.v[0], v[3].normal.v[0]);
+    __m128 ny = _mm_setr_ps(v[0].normal.v[1], v[1].normal.v[1], v[2].normal.v[1], v[3].normal.v[1]);
+    __m128 nz = _mm_setr_ps(v[0].normal.v[2], v[1].normal.v[2], v[2].normal.v[2], v[3].normal.v[2]);
+
+    m = &c->matrix_model_view_inv.m[0][0];
+    __m128 scale = _mm_set1_ps(c->normal_scale);
+    __m128 tx = _mm_mul_ps(sse_dot3(nx, ny, nz, m), scale);
+    __m128 ty = _mm_mul_ps(sse_dot3(nx, ny, nz, m + 4), scale);
+    __m128 tz = _mm_mul_ps(sse_dot3(nx, ny, nz, m + 8), scale);
+
+    if (c->normalize_enabled) {
+      // As gl_V3_Norm(), a zero-length normal is left alone.
+      __m128 len = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, tx), _mm_mul_ps(ty, ty)),
+                              _mm_mul_ps(tz, tz));
+      len = _mm_sqrt_ps(len);
+      __m128 nonzero = _mm_cmpneq_ps(len, _mm_setzero_ps());
+      tx = _mm_or_ps(_mm_and_ps(nonzero, _mm_div_ps(tx, len)), _mm_andnot_ps(nonzero, tx));
+      ty = _mm_or_ps(_mm_and_ps(nonzero, _mm_div_ps(ty, len)), _mm_andnot_ps(nonzero, ty));
+      tz = _mm_or_ps(_mm_and_ps(nonzero, _mm_div_ps(tz, len)), _mm_andnot_ps(nonzero, tz));
+    }
+
+    float out[3][4];
+    _mm_storeu_ps(out[0], tx);
+    _mm_storeu_ps(out[1], ty);
+    _mm_storeu_ps(out[2], tz);
+    for (int i = 0; i < 4; ++i) {
+      v[i].normal.v[0] = out[0][i];
+      v[i].normal.v[1] = out[1][i];
+      v[i].normal.v[2] = out[2][i];
+    }
+
+  } else {
+    /* NOTE: W = 1 is assumed */
+    const PN_stdfloat *m = &c->matrix_model_projection.m[0][0];
+    px = sse_dot3_add(x, y, z, m);
+    py = sse_dot3_add(x, y, z, m + 4);
+    pz = sse_dot3_add(x, y, z, m + 8);
+    if (c->matrix_model_projection_no_w_transform) {
+      pw = _mm_set1_ps(m[15]);
+    } else {
+      pw = sse_dot3_add(x, y, z, m + 12);
+    }
+  }
+
+  // Compute the clip codes with vector compares; see gl_clipcode().
+  __m128 pos_w = _mm_mul_ps(pw, _mm_set1_ps(1.0f + CLIP_EPSILON));
+  __m128 neg_w = _mm_xor_ps(pos_w, _mm_set1_ps(-0.0f));
+  int xmin = _mm_movemask_ps(_mm_cmplt_ps(px, neg_w));
+  int xmax = _mm_movemask_ps(_mm_cmpgt_ps(px, pos_w));
+  int ymin = _mm_movemask_ps(_mm_cmplt_ps(py, neg_w));
+  int ymax = _mm_movemask_ps(_mm_cmpgt_ps(py, pos_w));
+  int zmin = _mm_movemask_ps(_mm_cmplt_ps(pz, neg_w));
+  int zmax = _mm_movemask_ps(_mm_cmpgt_ps(pz, pos_w));
+
+  _MM_TRANSPOSE4_PS(px, py, pz, pw);
+  _mm_storeu_ps(v[0].pc.v, px);
+  _mm_storeu_ps(v[1].pc.v, py);
+  _mm_storeu_ps(v[2].pc.v, pz);
+  _mm_storeu_ps(v[3].pc.v, pw);
+
+  for (int i = 0; i < 4; ++i) {
+    v[i].clip_code = ((xmin >> i) & 1) |
+      (((xmax >> i) & 1) << 1) |
+      (((ymin >> i) & 1) << 2) |
+      (((ymax >> i) & 1) << 3) |
+      (((zmin >> i) & 1) << 4) |
+      (((zmax >> i) & 1) << 5);
+  }
+}
+
+#endif  // TGL_FEATURE_SSE
+
+/* Transforms count vertices, and computes their clip codes.  Unlike
+   gl_vertex_transform(), this takes the untransformed normal of each vertex
+   from its normal member, which is replaced with the transformed normal.  If
+   use_simd is true and SSE is available, the vertices are processed four at a
+   time; the results are the same either way. */
+void
+gl_vertex_transform_batch(GLContext *c, GLVertex *v, int count, int use_simd) {
+  int i = 0;
+
+#ifdef TGL_FEATURE_SSE
+  if (use_simd) {
+    for (; i + 4 <= count; i += 4) {
+      vertex_transform_sse(c, v + i);
+    }
+  }
+#endif
+
+  for (; i < count; ++i) {
+    V3 n = v[i].normal;
+    vertex_transform(c, v + i, &n);
+  }
+}
@@ -7,6 +7,7 @@
 #include <stdio.h>
 #include <assert.h>
 #include <string.h>
+#include <limits.h>
 #include "zbuffer.h"
 #include "pnotify.h"
 
@@ -22,6 +23,25 @@ int pixel_count_flat_perspective;
 int pixel_count_smooth_perspective;
 int pixel_count_smooth_multitex2;
 int pixel_count_smooth_multitex3;
+
+/*
+ * Adds the counts collected separately by one of the bands drawn by
+ * TinyTileRasterizer into the global pixel counts.
+ */
+void
+ZB_addPixelCounts(const ZPixelCounts *counts) {
+  pixel_count_white_untextured += counts->pixel_count_white_untextured;
+  pixel_count_flat_untextured += counts->pixel_count_flat_untextured;
+  pixel_count_smooth_untextured += counts->pixel_count_smooth_untextured;
+  pixel_count_white_textured += counts->pixel_count_white_textured;
+  pixel_count_flat_textured += counts->pixel_count_flat_textured;
+  pixel_count_smooth_textured += counts->pixel_count_smooth_textured;
+  pixel_count_white_perspective += counts->pixel_count_white_perspective;
+  pixel_count_flat_perspective += counts->pixel_count_flat_perspective;
+  pixel_count_smooth_perspective += counts->pixel_count_smooth_perspective;
+  pixel_count_smooth_multitex2 += counts->pixel_count_smooth_multitex2;
+  pixel_count_smooth_multitex3 += counts->pixel_count_smooth_multitex3;
+}
 #endif  // DO_PSTATS
 
 using std::max;
@@ -48,6 +68,9 @@ ZB_open(int xsize, int ysize, int mode,
   zb->ysize = ysize;
   zb->mode = mode;
   zb->linesize = (xsize * PSZB + 3) & ~3;
+  zb->band_ymin = 0;
+  zb->band_ymax = INT_MAX;
+  zb->pixel_counts = nullptr;
 
   switch (mode) {
 #ifdef TGL_FEATURE_8_BITS
@@ -174,6 +174,16 @@ struct ZBuffer {
   int reference_alpha;
   int blend_r, blend_g, blend_b, blend_a;
   ZB_storePixelFunc store_pix_func;
+
+  /* The triangle functions only draw the lines from band_ymin up to (but not
+     including) band_ymax.  This is used by TinyTileRasterizer to draw the
+     different bands of the screen in different threads. */
+  int band_ymin, band_ymax;
+
+  /* If this is not NULL, the triangle functions add the pixels they draw to
+     these counters instead of to the global ones, so that the bands drawn
+     by different threads don't race on them. */
+  struct ZPixelCounts *pixel_counts;
 };
 
 struct ZBufferPoint {
@@ -192,6 +202,21 @@ struct ZBufferPoint {
 
 /* zbuffer.c */
 
+/* A set of the pixel counters below, with the same names. */
+struct ZPixelCounts {
+  int pixel_count_white_untextured;
+  int pixel_count_flat_untextured;
+  int pixel_count_smooth_untextured;
+  int pixel_count_white_textured;
+  int pixel_count_flat_textured;
+  int pixel_count_smooth_textured;
+  int pixel_count_white_perspective;
+  int pixel_count_flat_perspective;
+  int pixel_count_smooth_perspective;
+  int pixel_count_smooth_multitex2;
+  int pixel_count_smooth_multitex3;
+};
+
 #ifdef DO_PSTATS
 extern int pixel_count_white_untextured;
 extern int pixel_count_flat_untextured;
@@ -205,8 +230,10 @@ extern int pixel_count_smooth_perspective;
 extern int pixel_count_smooth_multitex2;
 extern int pixel_count_smooth_multitex3;
 
+void ZB_addPixelCounts(const ZPixelCounts *counts);
+
 #define COUNT_PIXELS(pixel_count, p0, p1, p2) \
-  (pixel_count) += abs((p0)->x * ((p1)->y - (p2)->y) + (p1)->x * ((p2)->y - (p0)->y) + (p2)->x * ((p0)->y - (p1)->y)) / 2
+  (zb->pixel_counts != nullptr ? zb->pixel_counts->pixel_count : (pixel_count)) += abs((p0)->x * ((p1)->y - (p2)->y) + (p1)->x * ((p2)->y - (p0)->y) + (p2)->x * ((p0)->y - (p1)->y)) / 2
 
 #else
 
@@ -11,6 +11,14 @@
 #include "zmath.h"
 #include "zfeatures.h"
 
+/* The batch vertex functions use SSE where it is available.  They assume
+   single-precision floats. */
+#if !defined(STDFLOAT_DOUBLE) && \
+    (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || \
+     defined(_M_X64) || defined(_M_AMD64))
+#define TGL_FEATURE_SSE 1
+#endif
+
 /* initially # of allocated GLVertexes (will grow when necessary) */
 #define POLYGON_MAX_VERTEX 16
 
@@ -137,6 +145,7 @@ typedef struct GLTexture {
 } GLTexture;
 
 struct GLContext;
+class TinyTileRasterizer;
 
 typedef void (*gl_draw_triangle_func)(struct GLContext *c,
                                       GLVertex *p0,GLVertex *p1,GLVertex *p2);
@@ -185,6 +194,9 @@ typedef struct GLContext {
   gl_draw_triangle_func draw_triangle_front,draw_triangle_back;
   ZB_fillTriangleFunc zb_fill_tri;
 
+  /* if set, filled triangles are handed to this instead of drawn */
+  TinyTileRasterizer *tile_rasterizer;
+
   /* current vertex state */
   V4 current_color;
   V4 current_normal;
@@ -222,10 +234,14 @@ void gl_draw_triangle_fill(GLContext *c,
 /* light.c */
 void gl_enable_disable_light(GLContext *c,int light,int v);
 void gl_shade_vertex(GLContext *c,GLVertex *v);
+void gl_shade_vertex_batch(GLContext *c, GLVertex *v, int count,
+                           int color_ambient, int color_diffuse, int use_simd);
 
 /* vertex.c */
 void gl_eval_viewport(GLContext *c);
 void gl_vertex_transform(GLContext * c, GLVertex * v);
+void gl_vertex_transform_batch(GLContext *c, GLVertex *v, int count,
+                               int use_simd);
 
 /* image_util.c */
 void gl_convertRGB_to_5R6G5B(unsigned short *pixmap,unsigned char *rgb,
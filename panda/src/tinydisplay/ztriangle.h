@@ -16,6 +16,9 @@
   /* warning: x2 is multiplied by 2^16 */
   int x2, dx2dy2;
 
+  /* the scan line we are on; see band_ymin and band_ymax */
+  int band_y;
+
 #ifdef INTERP_Z
   int z1 = 0, dzdx = 0, dzdy = 0, dzdl_min = 0, dzdl_max = 0;
 #endif
@@ -53,8 +56,6 @@
 
   EARLY_OUT();
 
-  COUNT_PIXELS(PIXEL_COUNT, p0, p1, p2);
-
   /* we sort the vertex with increasing y */
   if (p1->y < p0->y) {
     t = p0;
@@ -72,6 +73,12 @@
     p2 = t;
   }
 
+  /* When the triangle is drawn in bands, it is only counted by the band that
+     contains its first line. */
+  if (p0->y >= zb->band_ymin) {
+    COUNT_PIXELS(PIXEL_COUNT, p0, p1, p2);
+  }
+
   /* we compute dXdx and dXdy for all interpolated values */
   
   fdx1 = (PN_stdfloat) (p1->x - p0->x);
@@ -216,6 +223,8 @@
 
   DRAW_INIT();
 
+  band_y = p0->y;
+
   for(part=0;part<2;part++) {
     if (part == 0) {
       if (fz > 0) {
@@ -341,6 +350,11 @@
 
     while (nb_lines>0) {
       nb_lines--;
+
+      /* Lines outside the band are not drawn, but we still have to step the
+         edges over them, so that the lines in the band come out exactly the
+         same as if the whole triangle were drawn at once. */
+      if (band_y >= zb->band_ymin) {
 #ifndef DRAW_LINE
       /* generic draw line */
       {
@@ -417,6 +431,7 @@
 #else
       DRAW_LINE();
 #endif
+      }
       
       /* left edge */
       error+=derror;
@@ -483,6 +498,12 @@
       /* screen coordinates */
       pp1=(PIXEL *)((char *)pp1 + zb->linesize);
       pz1+=zb->xsize;
+
+      band_y++;
+      if (band_y >= zb->band_ymax) {
+        /* the rest of the triangle is below the band */
+        return;
+      }
     }
   }
 }
@@ -105,6 +105,17 @@ EggToBam() :
      "written exactly as they are, losslessly.",
      &EggToBam::dispatch_none, &_compression_off);
 
+  add_option
+    ("QA", "tolerance", 0,
+     "Store the animation channels in the quantized, keyframe-reduced "
+     "form, which makes them much smaller both on disk and in memory.  "
+     "Frames that can be interpolated from the neighboring frames to within "
+     "the indicated tolerance are dropped; the tolerance applies to each "
+     "component in its own units, so it is in degrees for rotations.  This "
+     "takes precedence over -C, and requires writing a bam file of at least "
+     "version 6.46, which older versions of Panda cannot read.",
+     &EggToBam::dispatch_double, &_has_quantize_tolerance, &_quantize_tolerance);
+
   add_option
     ("rawtex", "", 0,
      "Record texture data directly in the bam file, instead of storing "
@@ -243,6 +254,15 @@ run() {
     compress_chan_quality = _compression_quality;
   }
 
+  if (_has_quantize_tolerance) {
+    // Quantized channels can only be stored in newer bam files.
+    quantize_channels = true;
+    quantize_chan_tolerance = _quantize_tolerance;
+    if (bam_version.get_num_words() != 2 || bam_version[1] < 46) {
+      load_prc_file_data("prc", "bam-version 6 46");
+    }
+  }
+
   if (_ctex_quality != "default") {
     // Override the user's config file with the command-line parameter for
     // texture compression.
@@ -0,0 +1,46 @@
+from panda3d import core
+
+
+def write_nav_mesh(path, size, holes=(), cell_size=10.0):
+    # Writes a navmesh.csv file, as read by AIBehaviors.init_path_find(), in
+    # which every cell but the holes is connected to its eight neighbors.
+    # The neighbors are listed anti-clockwise from the top left corner.
+    offsets = [(-1, 1), (-1, 0), (-1, -1), (0, -1), (1, -1), (1, 0), (1, 1), (0, 1)]
+
+    def row(null, node_type, x, y):
+        return "%d,%d,%d,%d,%g,%g,0,%g,%g,0\n" % (
+            null, node_type, x, y, cell_size, cell_size,
+            (x + 0.5) * cell_size, (y + 0.5) * cell_size)
+
+    with open(path, "w") as f:
+        f.write("Grid Size,%d\n" % size)
+        f.write("NULL,NodeType,GridX,GridY,Length,Width,Height,PosX,PosY,PosZ\n")
+        for y in range(size):
+            for x in range(size):
+                if (x, y) in holes:
+                    continue
+                f.write(row(0, 0, x, y))
+                for dx, dy in offsets:
+                    nx = x + dx
+                    ny = y + dy
+                    if 0 <= nx < size and 0 <= ny < size and (nx, ny) not in holes:
+                        f.write(row(0, 1, nx, ny))
+                    else:
+                        f.write(row(1, 1, nx, ny))
+
+
+def guide_path(render, cell_size=10.0):
+    # The path finding guide has one line for each step of the path, from the
+    # destination back to the source, each starting in the middle of a cell.
+    # Returns those cells, without the source, as (x, y) pairs.
+    guide = render.find("parent")
+    assert not guide.is_empty()
+    path = []
+    for line in guide.get_children():
+        geom = line.node().get_geom(0)
+        reader = core.GeomVertexReader(geom.get_vertex_data(), "vertex")
+        pos = reader.get_data3()
+        path.append((int(pos.x // cell_size), int(pos.y // cell_size)))
+    path.reverse()
+    return path
+
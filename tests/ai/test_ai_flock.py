@@ -0,0 +1,88 @@
+import pytest
+import random
+import time
+
+# Skip these tests if we can't import the ai module.
+ai = pytest.importorskip("panda3d.ai")
+from panda3d import core
+
+
+@pytest.fixture
+def parallel_update():
+    var = core.ConfigVariableBool("ai-parallel-update")
+    value = var.get_value()
+    yield var
+    var.set_value(value)
+
+
+def make_flock(num_agents, seed, spread=100.0, radius=10.0):
+    rng = random.Random(seed)
+    render = core.NodePath("render")
+    world = ai.AIWorld(render)
+    flock = ai.Flock(1, 270, radius, 2, 4, 1)
+
+    target = render.attach_new_node("target")
+    target.set_pos(spread, spread, 0)
+
+    agents = []
+    for i in range(num_agents):
+        np = render.attach_new_node("agent%d" % i)
+        np.set_pos(rng.uniform(0, spread), rng.uniform(0, spread), 0)
+        agent = ai.AICharacter("agent%d" % i, np, 60, 0.05, 5)
+        flock.add_ai_char(agent)
+        agents.append(agent)
+
+    world.add_flock(flock)
+    for agent in agents:
+        behaviors = agent.get_ai_behaviors()
+        behaviors.seek(target)
+        behaviors.flock(0.5)
+
+    return world, flock, agents
+
+
+def run(world, num_updates):
+    for i in range(num_updates):
+        world.update()
+
+
+def test_flock_parallel_matches_serial(parallel_update):
+    results = []
+    for parallel in (False, True):
+        parallel_update.set_value(parallel)
+        world, flock, agents = make_flock(300, 1)
+        run(world, 20)
+        results.append([tuple(agent.get_node_path().get_pos()) for agent in agents])
+        for agent in agents:
+            world.remove_ai_char(agent.get_name())
+
+    assert results[0] == results[1]
+
+
+def test_flock_moves_together(parallel_update):
+    world, flock, agents = make_flock(50, 2, spread=20.0)
+    start = [agent.get_node_path().get_pos() for agent in agents]
+    run(world, 10)
+    moved = sum((agent.get_node_path().get_pos() - pos).length() > 0
+                for agent, pos in zip(agents, start))
+    assert moved == len(agents)
+    for agent in agents:
+        world.remove_ai_char(agent.get_name())
+
+
+@pytest.mark.benchmark_test
+@pytest.mark.parametrize("parallel", [False, True])
+def test_flock_benchmark(parallel_update, parallel):
+    # Prints the time per update, serial or in parallel; run with -s.
+    parallel_update.set_value(parallel)
+    world, flock, agents = make_flock(2000, 3, spread=400.0)
+    run(world, 2)
+
+    num_updates = 10
+    start = time.perf_counter()
+    run(world, num_updates)
+    elapsed = time.perf_counter() - start
+
+    print("\n2000 flocking agents, %s: %.2f ms per update" % ("parallel" if parallel else "serial", elapsed * 1000.0 / num_updates))
+    for agent in agents:
+        world.remove_ai_char(agent.get_name())
@@ -0,0 +1,207 @@
+import pytest
+import heapq
+import random
+import time
+
+# Skip these tests if we can't import the ai module.
+ai = pytest.importorskip("panda3d.ai")
+from panda3d import core
+from .conftest import write_nav_mesh, guide_path
+
+
+def make_grid(size, seed, density=0.25):
+    rng = random.Random(seed)
+    grid = ai.AINavGrid(size, size)
+    for cell in range(grid.get_num_cells()):
+        if rng.random() < density:
+            grid.set_walkable(cell, False)
+    return grid
+
+
+def step_cost(grid, a, b):
+    dx = grid.get_cell_x(a) != grid.get_cell_x(b)
+    dy = grid.get_cell_y(a) != grid.get_cell_y(b)
+    return 14 if dx and dy else 10
+
+
+def path_cost(grid, path):
+    return sum(step_cost(grid, a, b) for a, b in zip(path, path[1:]))
+
+
+def dijkstra(grid, src, dst):
+    # The reference: a plain Dijkstra search over the eight neighbors.
+    size_x = grid.get_size_x()
+    size_y = grid.get_size_y()
+    best = {src: 0}
+    queue = [(0, src)]
+    while queue:
+        cost, cell = heapq.heappop(queue)
+        if cell == dst:
+            return cost
+        if cost > best[cell]:
+            continue
+        x = grid.get_cell_x(cell)
+        y = grid.get_cell_y(cell)
+        for dx in (-1, 0, 1):
+            for dy in (-1, 0, 1):
+                if (dx or dy) and 0 <= x + dx < size_x and 0 <= y + dy < size_y:
+                    next = grid.get_cell(x + dx, y + dy)
+                    if not grid.is_walkable(next):
+                        continue
+                    next_cost = cost + (14 if dx and dy else 10)
+                    if next_cost < best.get(next, next_cost + 1):
+                        best[next] = next_cost
+                        heapq.heappush(queue, (next_cost, next))
+    return None
+
+
+def test_nav_grid_straight_path():
+    grid = ai.AINavGrid(16, 16)
+    path = list(grid.find_path(grid.get_cell(1, 2), grid.get_cell(9, 2)))
+    assert path == [grid.get_cell(x, 2) for x in range(1, 10)]
+
+    path = list(grid.find_path(grid.get_cell(0, 0), grid.get_cell(5, 5)))
+    assert path == [grid.get_cell(i, i) for i in range(6)]
+
+    cell = grid.get_cell(3, 3)
+    assert list(grid.find_path(cell, cell)) == [cell]
+
+
+def test_nav_grid_find_cell():
+    grid = ai.AINavGrid(8, 4, 2.0)
+    assert grid.find_cell(core.Point3(0.5, 0.5, 0)) == grid.get_cell(0, 0)
+    assert grid.find_cell(core.Point3(15.5, 7.5, 3)) == grid.get_cell(7, 3)
+    assert grid.find_cell(core.Point3(5, 3, 0)) == grid.get_cell(2, 1)
+    assert grid.get_cell_position(grid.get_cell(2, 1)) == core.Point3(5, 3, 0)
+    assert grid.find_cell(core.Point3(-1, 0, 0)) == -1
+    assert grid.find_cell(core.Point3(0, 9, 0)) == -1
+
+
+@pytest.mark.parametrize("seed", range(4))
+def test_nav_grid_optimal(seed):
+    grid = make_grid(48, seed)
+    rng = random.Random(seed + 100)
+    found = 0
+    for i in range(20):
+        src = rng.randrange(grid.get_num_cells())
+        dst = rng.randrange(grid.get_num_cells())
+        grid.set_walkable(src, True)
+        grid.set_walkable(dst, True)
+
+        path = list(grid.find_path(src, dst))
+        expected = dijkstra(grid, src, dst)
+        if expected is None:
+            assert path == []
+            continue
+
+        found += 1
+        assert path[0] == src
+        assert path[-1] == dst
+        for a, b in zip(path, path[1:]):
+            assert abs(grid.get_cell_x(a) - grid.get_cell_x(b)) <= 1
+            assert abs(grid.get_cell_y(a) - grid.get_cell_y(b)) <= 1
+            assert grid.is_walkable(b)
+        assert path_cost(grid, path) == expected
+
+    assert found > 0
+
+
+def test_nav_grid_unreachable():
+    grid = ai.AINavGrid(10, 10)
+    for y in range(10):
+        grid.set_walkable(grid.get_cell(5, y), False)
+    assert list(grid.find_path(grid.get_cell(0, 0), grid.get_cell(9, 9))) == []
+
+    # The destination itself may not be blocked, but the source may be.
+    assert list(grid.find_path(grid.get_cell(0, 0), grid.get_cell(5, 0))) == []
+    path = grid.find_path(grid.get_cell(5, 0), grid.get_cell(9, 0))
+    assert len(path) == 5
+
+
+def test_nav_grid_path_cache():
+    grid = ai.AINavGrid(32, 32)
+    src = grid.get_cell(0, 16)
+    dst = grid.get_cell(31, 16)
+    grid.clear_path_cache()
+    assert grid.get_num_cached_paths() == 0
+
+    path = list(grid.find_path(src, dst))
+    assert grid.get_num_cached_paths() == 1
+    assert list(grid.find_path(src, dst)) == path
+    assert grid.get_num_cached_paths() == 1
+
+    # Blocking a cell on the path forgets it, and finds another way around.
+    version = grid.get_version()
+    grid.set_walkable(path[10], False)
+    assert grid.get_version() != version
+    assert grid.get_num_cached_paths() == 0
+    detour = list(grid.find_path(src, dst))
+    assert path[10] not in detour
+    assert detour[0] == src and detour[-1] == dst
+
+    # Setting it to what it already was changes nothing.
+    version = grid.get_version()
+    grid.set_walkable(path[10], False)
+    assert grid.get_version() == version
+
+
+def test_nav_grid_nav_mesh(tmp_path):
+    # A wall across the middle of the mesh, with a gap at the top.
+    size = 6
+    holes = set((3, y) for y in range(size - 1))
+    filename = str(tmp_path / "navmesh.csv")
+    write_nav_mesh(filename, size, holes)
+
+    render = core.NodePath("render")
+    world = ai.AIWorld(render)
+    np = render.attach_new_node("seeker")
+    np.set_pos(5, 5, 0)
+    seeker = ai.AICharacter("seeker", np, 60, 0.05, 5)
+    seeker.set_pf_guide(True)
+    world.add_ai_char(seeker)
+
+    behaviors = seeker.get_ai_behaviors()
+    behaviors.init_path_find(filename)
+    behaviors.path_find_to(core.Point3(55, 5, 0))
+
+    path = [(0, 0)] + guide_path(render)
+    assert path[-1] == (5, 0)
+    for a, b in zip(path, path[1:]):
+        assert abs(a[0] - b[0]) <= 1 and abs(a[1] - b[1]) <= 1
+        assert b not in holes
+
+    # It is as short as a path around the same wall on a regular grid.
+    grid = ai.AINavGrid(size, size)
+    for x, y in holes:
+        grid.set_walkable(grid.get_cell(x, y), False)
+    cells = [grid.get_cell(x, y) for x, y in path]
+    assert path_cost(grid, cells) == dijkstra(grid, cells[0], cells[-1])
+
+    world.remove_ai_char("seeker")
+
+
+@pytest.mark.benchmark_test
+def test_nav_grid_benchmark():
+    # Prints the time per path, searched and from the cache; run with -s.
+    grid = make_grid(512, 1, 0.2)
+    rng = random.Random(2)
+    queries = []
+    while len(queries) < 20:
+        src = rng.randrange(grid.get_num_cells())
+        dst = rng.randrange(grid.get_num_cells())
+        if grid.is_walkable(src) and grid.is_walkable(dst):
+            queries.append((src, dst))
+
+    grid.clear_path_cache()
+    start = time.perf_counter()
+    lengths = [len(grid.find_path(src, dst)) for src, dst in queries]
+    searched = time.perf_counter() - start
+
+    start = time.perf_counter()
+    for src, dst in queries:
+        grid.find_path(src, dst)
+    cached = time.perf_counter() - start
+
+    print("\nA* on a 512x512 grid, 20%% blocked, %d paths of %d cells on average:" % (len(queries), sum(lengths) // len(lengths)))
+    print("  searched: %.3f ms per path" % (searched * 1000.0 / len(queries)))
+    print("  cached:   %.3f ms per path" % (cached * 1000.0 / len(queries)))
@@ -0,0 +1,133 @@
+import pytest
+import random
+
+# Skip these tests if we can't import the ai module.
+ai = pytest.importorskip("panda3d.ai")
+from panda3d import core
+
+
+def nearest(grid, center):
+    # The reference: look at every point.
+    best = -1
+    best_dist = None
+    for i in range(grid.get_num_points()):
+        point = grid.get_point(i)
+        if point == center:
+            continue
+        dist = (point - center).length_squared()
+        if best == -1 or dist < best_dist:
+            best = i
+            best_dist = dist
+    return best
+
+
+def test_neighbor_grid_nearest_empty():
+    grid = ai.AINeighborGrid()
+    grid.build(10)
+    assert grid.find_nearest(core.Point3(0, 0, 0)) == -1
+
+    # A point at the center itself doesn't count.
+    grid.add_point(core.Point3(1, 2, 3))
+    grid.build(10)
+    assert grid.find_nearest(core.Point3(1, 2, 3)) == -1
+    assert grid.find_nearest(core.Point3(0, 0, 0)) == 0
+
+
+@pytest.mark.parametrize("cell_size", [0.5, 4, 10, 1000])
+def test_neighbor_grid_nearest(cell_size):
+    rng = random.Random(1)
+    grid = ai.AINeighborGrid()
+    for i in range(300):
+        grid.add_point(core.Point3(rng.uniform(-50, 50), rng.uniform(-50, 50), rng.uniform(-5, 5)))
+    grid.build(cell_size)
+    assert grid.get_num_points() == 300
+    assert grid.get_cell_size() == cell_size
+
+    centers = [core.Point3(rng.uniform(-60, 60), rng.uniform(-60, 60), 0) for i in range(50)]
+
+    # Far outside the occupied cells, and on top of some of the points.
+    centers.append(core.Point3(500, -400, 30))
+    centers += [grid.get_point(i) for i in range(0, 300, 30)]
+
+    for center in centers:
+        assert grid.find_nearest(center) == nearest(grid, center)
+
+
+def test_neighbor_grid_nearest_tie():
+    grid = ai.AINeighborGrid()
+    grid.add_point(core.Point3(20, 0, 0))
+    grid.add_point(core.Point3(-5, 0, 0))
+    grid.add_point(core.Point3(0, 5, 0))
+    grid.add_point(core.Point3(-5, 0, 0))
+    grid.build(2)
+
+    # Of the points at the same distance, the first one added wins.
+    assert grid.find_nearest(core.Point3(0, 0, 0)) == 1
+    assert grid.find_nearest(core.Point3(-5, 0, 0)) == 2
+
+    grid.clear()
+    assert grid.get_num_points() == 0
+    grid.build(2)
+    assert grid.find_nearest(core.Point3(0, 0, 0)) == -1
+
+
+@pytest.fixture
+def obstacle_cell_size():
+    var = core.ConfigVariableDouble("ai-obstacle-cell-size")
+    value = var.get_value()
+    yield var
+    var.set_value(value)
+
+
+def make_sphere(parent, name, pos, radius):
+    np = parent.attach_new_node(core.CollisionNode(name))
+    np.node().add_solid(core.CollisionSphere(0, 0, 0, radius))
+    np.set_pos(pos)
+    return np
+
+
+def run_avoidance(avoid):
+    # A character heading straight through a row of obstacles, among many
+    # others that are out of its way.
+    rng = random.Random(2)
+    render = core.NodePath("render")
+    world = ai.AIWorld(render)
+    for i in range(100):
+        pos = core.Point3(rng.uniform(-100, 200), rng.uniform(20, 100), 0)
+        world.add_obstacle(make_sphere(render, "obstacle%d" % i, pos, 2))
+    for x in (20, 45, 70):
+        world.add_obstacle(make_sphere(render, "row%d" % x, (x, 0.5, 0), 2))
+
+    np = make_sphere(render, "walker", (0, 0, 0), 1)
+    walker = ai.AICharacter("walker", np, 1, 0.5, 1)
+    world.add_ai_char(walker)
+    behaviors = walker.get_ai_behaviors()
+    behaviors.seek(core.Point3(100, 0, 0))
+    if avoid:
+        behaviors.obstacle_avoidance(1.0)
+
+    positions = []
+    for i in range(80):
+        world.update()
+        positions.append(tuple(np.get_pos()))
+
+    world.remove_ai_char("walker")
+    return positions
+
+
+def test_neighbor_grid_obstacle_avoidance(obstacle_cell_size):
+    # Without obstacle avoidance, the character walks right through them.
+    straight = run_avoidance(False)
+    assert all(y == 0 for x, y, z in straight)
+
+    # The nearest obstacle is the same, however the world sorts them into
+    # cells, so the character takes the same way around them.
+    results = []
+    for cell_size in (0.5, 10, 1000):
+        obstacle_cell_size.set_value(cell_size)
+        results.append(run_avoidance(True))
+
+    assert results[0] != straight
+    assert any(abs(y) > 0.1 for x, y, z in results[0])
+    assert results[1] == results[0]
+    assert results[2] == results[0]
@@ -0,0 +1,244 @@
+import pytest
+import time
+
+# Skip these tests if we can't import the ai module.
+ai = pytest.importorskip("panda3d.ai")
+from panda3d import core
+from .conftest import write_nav_mesh, guide_path
+
+
+@pytest.fixture
+def render():
+    return core.NodePath("render")
+
+
+@pytest.fixture
+def world(render):
+    world = ai.AIWorld(render)
+    yield world
+
+
+@pytest.fixture
+def path_chain(world):
+    # Run the requests on the main thread, so that we decide when they are
+    # done, by polling the task manager.
+    chain = core.AsyncTaskManager.get_global_ptr().find_task_chain("ai_path")
+    num_threads = chain.get_num_threads()
+    chain.set_num_threads(0)
+    yield chain
+    chain.set_num_threads(num_threads)
+
+
+def wait(*requests):
+    end = time.time() + 10
+    while not all(request.done() for request in requests):
+        core.AsyncTaskManager.get_global_ptr().poll()
+        assert time.time() < end
+
+
+def wait_world(world):
+    end = time.time() + 10
+    while world.get_num_path_requests() > 0:
+        core.AsyncTaskManager.get_global_ptr().poll()
+        assert time.time() < end
+
+
+def make_seeker(world, render, tmp_path, size=6):
+    # A character in the corner cell of a navigation mesh of 10x10 cells.
+    filename = str(tmp_path / "navmesh.csv")
+    write_nav_mesh(filename, size)
+
+    np = render.attach_new_node("seeker")
+    np.set_pos(5, 5, 0)
+    seeker = ai.AICharacter("seeker", np, 60, 0.05, 5)
+    seeker.set_pf_guide(True)
+    world.add_ai_char(seeker)
+    seeker.get_ai_behaviors().init_path_find(filename)
+    return seeker
+
+
+def update_follower(world):
+    # The path follower only looks at the target and the obstacles again
+    # every half a second.
+    time.sleep(0.6)
+    world.update()
+
+
+def test_path_request(world, path_chain):
+    grid = ai.AINavGrid(16, 16)
+    src = grid.get_cell(1, 2)
+    dst = grid.get_cell(12, 9)
+
+    request = world.request_path(grid, src, dst)
+    assert request.src == src and request.dst == dst
+    assert request.version == grid.get_version()
+    assert not request.done()
+    assert world.get_num_path_requests() == 1
+
+    wait(request)
+    assert request.is_ready()
+    path = request.get_path()
+    assert list(request.result().cells) == list(path.cells)
+    assert path.found
+    assert path.src == src and path.dst == dst
+    assert list(path.cells) == list(grid.find_path(src, dst))
+    assert world.get_num_path_requests() == 0
+
+
+def test_path_request_coalesced(world, path_chain):
+    grid = ai.AINavGrid(16, 16)
+    other = ai.AINavGrid(16, 16)
+    src = grid.get_cell(0, 0)
+    dst = grid.get_cell(15, 15)
+
+    first = world.request_path(grid, src, dst)
+    assert world.request_path(grid, src, dst).get_task_id() == first.get_task_id()
+    assert world.request_path(grid, dst, src).get_task_id() != first.get_task_id()
+    assert world.request_path(other, src, dst).get_task_id() != first.get_task_id()
+    assert world.get_num_path_requests() == 3
+
+    # A new version of the grid is a different request.
+    grid.set_walkable(grid.get_cell(5, 9), False)
+    second = world.request_path(grid, src, dst)
+    assert second.get_task_id() != first.get_task_id()
+    assert second.version != first.version
+    assert world.get_num_path_requests() == 4
+
+    # Once it is done, asking again makes a new request.
+    wait(second)
+    assert world.request_path(grid, src, dst).get_task_id() != second.get_task_id()
+    wait(first)
+
+
+def test_path_request_snapshot(world, path_chain):
+    grid = ai.AINavGrid(10, 10)
+    src = grid.get_cell(0, 5)
+    dst = grid.get_cell(9, 5)
+
+    before = world.request_path(grid, src, dst)
+    version = grid.get_version()
+
+    # Wall off the destination while the request is pending.
+    for y in range(10):
+        grid.set_walkable(grid.get_cell(5, y), False)
+    assert grid.get_version() != version
+    after = world.request_path(grid, src, dst)
+
+    wait(before, after)
+
+    # The first search still saw the cells as they were.
+    assert before.get_path().found
+    assert before.get_path().version == version
+    assert list(before.get_path().cells) == [grid.get_cell(x, 5) for x in range(10)]
+
+    assert not after.get_path().found
+    assert after.get_path().version == grid.get_version()
+    assert list(after.get_path().cells) == []
+
+    # The grid itself doesn't remember the path of the old version.
+    assert list(grid.find_path(src, dst)) == []
+
+
+def test_path_request_threaded(world):
+    grid = ai.AINavGrid(64, 64)
+    for y in range(60):
+        grid.set_walkable(grid.get_cell(32, y), False)
+
+    requests = []
+    for y in range(0, 64, 4):
+        requests.append(world.request_path(grid, grid.get_cell(0, y), grid.get_cell(63, 63 - y)))
+
+    wait(*requests)
+    for request in requests:
+        path = request.get_path()
+        assert path.found
+        assert list(path.cells) == list(grid.find_path(path.src, path.dst))
+
+
+def test_path_request_follow(world, render, path_chain, tmp_path):
+    seeker = make_seeker(world, render, tmp_path)
+    behaviors = seeker.get_ai_behaviors()
+    target = render.attach_new_node("target")
+    target.set_pos(55, 5, 0)
+    behaviors.path_find_to(target)
+    assert guide_path(render) == [(x, 0) for x in range(1, 6)]
+    assert world.get_num_path_requests() == 0
+
+    # When the target moves, the new path is found on the world's thread, and
+    # the follower keeps following the old one until it is done.
+    target.set_pos(55, 55, 0)
+    update_follower(world)
+    assert world.get_num_path_requests() == 1
+    world.update()
+    assert guide_path(render) == [(x, 0) for x in range(1, 6)]
+
+    # The next update hands the new path to the follower, which heads for the
+    # first step along it.
+    wait_world(world)
+    world.update()
+    assert guide_path(render) == [(i, i) for i in range(1, 6)]
+    assert render.find("dummy").get_pos() == core.Point3(15, 15, 0)
+
+    world.remove_ai_char("seeker")
+
+
+def test_path_request_dynamic_obstacle(world, render, path_chain, tmp_path):
+    seeker = make_seeker(world, render, tmp_path)
+    behaviors = seeker.get_ai_behaviors()
+    grid = behaviors.get_nav_grid()
+    assert grid.get_size_x() == 6 and grid.get_size_y() == 6
+
+    def blocked():
+        return set((grid.get_cell_x(cell), grid.get_cell_y(cell))
+                   for cell in range(grid.get_num_cells())
+                   if not grid.is_walkable(cell))
+
+    obstacle = render.attach_new_node(core.CollisionNode("obstacle"))
+    obstacle.node().add_solid(core.CollisionSphere(0, 0, 0, 12))
+    obstacle.set_pos(25, 25, 0)
+    behaviors.add_dynamic_obstacle(obstacle)
+
+    target = render.attach_new_node("target")
+    target.set_pos(55, 55, 0)
+    behaviors.path_find_to(target)
+    assert blocked() == set()
+
+    # The cells under the obstacle are blocked all at once, with a single
+    # change to the version of the grid.
+    version = grid.get_version()
+    update_follower(world)
+    assert blocked() == set((x, y) for x in range(1, 4) for y in range(1, 4))
+    assert grid.get_version() == version + 1
+    wait_world(world)
+    world.update()
+    path = guide_path(render)
+    assert path[-1] == (5, 5)
+    assert not set(path) & blocked()
+
+    # Moving it over by one cell clears one column and blocks another, still
+    # as one change.  A search that was asked for before still sees the cells
+    # as they were.
+    src = grid.get_cell(0, 2)
+    dst = grid.get_cell(5, 2)
+    before = world.request_path(grid, src, dst)
+    version = grid.get_version()
+    obstacle.set_x(35)
+    update_follower(world)
+    assert blocked() == set((x, y) for x in range(2, 5) for y in range(1, 4))
+    assert grid.get_version() == version + 1
+
+    wait(before)
+    assert before.get_path().version == version
+    cells = [(grid.get_cell_x(cell), grid.get_cell_y(cell)) for cell in before.get_path().cells]
+    assert cells[0] == (0, 2) and cells[-1] == (5, 2)
+    assert not set(cells) & set((x, y) for x in range(1, 4) for y in range(1, 4))
+    assert set(cells) & blocked()
+
+    # If it doesn't move, nothing changes.
+    wait_world(world)
+    version = grid.get_version()
+    update_follower(world)
+    assert grid.get_version() == version
+
+    wait_world(world)
+    world.remove_ai_char("seeker")
@@ -0,0 +1,112 @@
+import random
+import time
+
+import pytest
+
+bsp = pytest.importorskip("panda3d.bsp")
+bullet = pytest.importorskip("panda3d.bullet")
+from panda3d import core
+
+WALL_MASK = core.BitMask32.bit(1)
+FLOOR_MASK = core.BitMask32.bit(2)
+EVENT_MASK = core.BitMask32.bit(3)
+
+# Controllers are placed on a grid with this spacing, far enough apart that
+# they never run into each other.
+SPACING = 16
+
+
+def make_scene(count, seed):
+    """
+    Builds a deterministic benchmark scene: a floor with a low wall in every
+    grid cell, and a controller in every cell walking in a random direction.
+    Returns the world, the scene root and the controllers.
+    """
+
+    world = bullet.BulletWorld()
+    render = core.NodePath("render")
+    rng = random.Random(seed)
+
+    floor = bullet.BulletRigidBodyNode("floor")
+    floor.add_shape(bullet.BulletPlaneShape(core.Vec4(0, 0, 1, 0)))
+    floor_np = render.attach_new_node(floor)
+    floor_np.set_collide_mask(WALL_MASK | FLOOR_MASK)
+    world.attach(floor)
+
+    side = int(count ** 0.5 + 0.999)
+    controllers = []
+    for i in range(count):
+        x = (i % side) * SPACING
+        y = (i // side) * SPACING
+
+        wall = bullet.BulletRigidBodyNode("wall")
+        wall.add_shape(bullet.BulletBoxShape(core.Vec3(0.5, 3, 2)))
+        wall_np = render.attach_new_node(wall)
+        wall_np.set_pos(x + 4, y, 2)
+        wall_np.set_collide_mask(WALL_MASK)
+        world.attach(wall)
+
+        parent = render.attach_new_node("controller")
+        controller = bsp.PhysicsCharacterController(
+            None, world, render, parent, 4.0, 2.0, 0.5, 1.0, -32.174,
+            WALL_MASK, FLOOR_MASK, EVENT_MASK)
+        controller.get_movement_parent().set_pos(render, x, y, 0)
+        controller.set_linear_movement(
+            core.Vec3(rng.uniform(-1, 1), rng.uniform(-1, 1), 0).normalized() * 4)
+        controllers.append(controller)
+
+    return world, render, controllers
+
+
+def simulate(count, use_group, frames=60, seed=1, times=None):
+    world, render, controllers = make_scene(count, seed)
+
+    if use_group:
+        group = bsp.PhysicsCharacterControllerGroup(world)
+        for controller in controllers:
+            group.add_controller(controller)
+        update = lambda dt: group.update(dt)
+    else:
+        def update(dt):
+            for controller in controllers:
+                controller.update(dt)
+
+    dt = 1.0 / 60
+    start = time.perf_counter()
+    for frame in range(frames):
+        update(dt)
+        world.do_physics(dt)
+    if times is not None:
+        times.append(time.perf_counter() - start)
+
+    return [c.get_movement_parent().get_pos(render) for c in controllers]
+
+
+def test_group_deterministic():
+    first = simulate(64, True)
+    second = simulate(64, True)
+    assert first == second
+
+
+def test_group_matches_serial():
+    serial = simulate(64, False)
+    grouped = simulate(64, True)
+
+    for a, b in zip(serial, grouped):
+        assert a.almost_equal(b, 1e-3)
+
+
+
+@pytest.mark.benchmark_test
+def test_group_benchmark():
+    # Prints the time taken with and without the group; run with -s.
+    count = 256
+    serial_time = []
+    group_time = []
+    serial = simulate(count, False, times=serial_time)
+    grouped = simulate(count, True, times=group_time)
+    print("%d controllers, 60 frames: serial %.1f ms, grouped %.1f ms" % (
+        count, serial_time[0] * 1000, group_time[0] * 1000))
+
+    for a, b in zip(serial, grouped):
+        assert a.almost_equal(b, 1e-3)
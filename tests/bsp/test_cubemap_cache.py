@@ -0,0 +1,75 @@
+import random
+
+import pytest
+
+bsp = pytest.importorskip("panda3d.bsp")
+from panda3d import core
+
+AmbientProbeManager = bsp.AmbientProbeManager
+
+
+def make_cubemaps(sizes, seed=None):
+    cubemaps = core.TextureCollection()
+    rng = random.Random(seed)
+    for size in sizes:
+        tex = core.Texture("cubemap_tex")
+        tex.setup_cube_map(size, core.Texture.T_unsigned_short, core.Texture.F_rgb)
+        if seed is None:
+            tex.make_ram_image()
+        else:
+            data = bytes(rng.getrandbits(8) for i in range(tex.get_expected_ram_image_size()))
+            tex.set_ram_image(data)
+        cubemaps.add_texture(tex)
+    return cubemaps
+
+
+@pytest.fixture
+def cache_file(tmp_path):
+    return core.Filename.from_os_specific(str(tmp_path / "test.cmc"))
+
+
+def test_cubemap_cache_round_trip(cache_file):
+    sizes = [4, 8, 16]
+    original = make_cubemaps(sizes, seed=1)
+    assert AmbientProbeManager.write_cubemap_cache(cache_file, 1234, original)
+
+    loaded = make_cubemaps(sizes)
+    assert AmbientProbeManager.read_cubemap_cache(cache_file, 1234, loaded)
+    for i in range(len(sizes)):
+        assert bytes(loaded[i].get_ram_image()) == bytes(original[i].get_ram_image())
+
+
+def test_cubemap_cache_stale_checksum(cache_file):
+    original = make_cubemaps([8], seed=2)
+    assert AmbientProbeManager.write_cubemap_cache(cache_file, 1234, original)
+
+    loaded = make_cubemaps([8])
+    assert not AmbientProbeManager.read_cubemap_cache(cache_file, 1235, loaded)
+
+
+def test_cubemap_cache_mismatch(cache_file):
+    original = make_cubemaps([8, 8], seed=3)
+    assert AmbientProbeManager.write_cubemap_cache(cache_file, 1234, original)
+
+    # A different number of cubemaps.
+    assert not AmbientProbeManager.read_cubemap_cache(cache_file, 1234, make_cubemaps([8]))
+
+    # A different cubemap size.
+    assert not AmbientProbeManager.read_cubemap_cache(cache_file, 1234, make_cubemaps([8, 16]))
+
+
+def test_cubemap_cache_missing(cache_file):
+    assert not AmbientProbeManager.read_cubemap_cache(cache_file, 1234, make_cubemaps([8]))
+
+
+def test_cubemap_cache_truncated(cache_file):
+    original = make_cubemaps([8], seed=4)
+    assert AmbientProbeManager.write_cubemap_cache(cache_file, 1234, original)
+
+    path = cache_file.to_os_specific()
+    with open(path, "rb") as f:
+        data = f.read()
+    with open(path, "wb") as f:
+        f.write(data[:len(data) // 2])
+
+    assert not AmbientProbeManager.read_cubemap_cache(cache_file, 1234, make_cubemaps([8]))
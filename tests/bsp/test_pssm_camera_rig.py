@@ -0,0 +1,148 @@
+import pytest
+
+bsp = pytest.importorskip("panda3d.bsp")
+from panda3d import core
+
+PSSMCameraRig = bsp.PSSMCameraRig
+
+LIGHT_VECTOR = core.Vec3(0.3, 0.4, -0.8).normalized()
+
+
+@pytest.fixture
+def scene():
+    render = core.NodePath("render")
+    lens = core.PerspectiveLens()
+    lens.set_near_far(1, 1000)
+    cam = render.attach_new_node(core.Camera("cam", lens))
+    return render, cam
+
+
+def make_rig(render, num_splits):
+    rig = PSSMCameraRig(num_splits)
+    rig.set_pssm_distance(200)
+    rig.reparent_to(render)
+    return rig
+
+
+def dirty_splits(rig, num_splits):
+    return [i for i in range(num_splits) if rig.is_cascade_dirty(i)]
+
+
+def test_pssm_interval_stagger(scene):
+    render, cam = scene
+    rig = make_rig(render, 4)
+    rig.set_cascade_update_policy(2, PSSMCameraRig.CUP_interval, 4)
+    rig.set_cascade_update_policy(3, PSSMCameraRig.CUP_interval, 4)
+
+    # The first update is a forced pass that recomputes everything.
+    rig.update(cam, LIGHT_VECTOR)
+    assert dirty_splits(rig, 4) == [0, 1, 2, 3]
+
+    # Keep the camera moving, so that each recomputed split really changes.
+    updated = {2: [], 3: []}
+    for frame in range(1, 13):
+        cam.set_x(frame * 10)
+        rig.update(cam, LIGHT_VECTOR)
+        assert rig.is_cascade_dirty(0)
+        assert rig.is_cascade_dirty(1)
+        for split in updated:
+            if rig.is_cascade_dirty(split):
+                updated[split].append(frame)
+
+    # Both splits come due every four frames, but never on the same frame.
+    for frames in updated.values():
+        assert len(frames) == 3
+        assert frames[1] - frames[0] == 4
+        assert frames[2] - frames[1] == 4
+    assert not set(updated[2]) & set(updated[3])
+
+    # A forced pass recomputes both, after which they are staggered again.
+    rig.mark_all_cascades_dirty()
+    cam.set_x(200)
+    rig.update(cam, LIGHT_VECTOR)
+    assert dirty_splits(rig, 4) == [0, 1, 2, 3]
+
+    frames = {2: [], 3: []}
+    for frame in range(1, 5):
+        cam.set_x(200 + frame * 10)
+        rig.update(cam, LIGHT_VECTOR)
+        for split in frames:
+            if rig.is_cascade_dirty(split):
+                frames[split].append(frame)
+    assert len(frames[2]) == 1
+    assert len(frames[3]) == 1
+    assert frames[2] != frames[3]
+
+
+def test_pssm_clean_pass(scene):
+    render, cam = scene
+    rig = make_rig(render, 3)
+    for i in range(3):
+        rig.set_cascade_update_policy(i, PSSMCameraRig.CUP_on_snap_change)
+    rig.set_skip_clean_passes(True)
+
+    rig.update(cam, LIGHT_VECTOR)
+    assert rig.get_num_dirty_cascades() == 3
+    assert rig.needs_shadow_render()
+
+    # Nothing moved, so there is nothing to re-render.
+    rig.update(cam, LIGHT_VECTOR)
+    assert rig.get_num_dirty_cascades() == 0
+    assert not rig.needs_shadow_render()
+
+    # Turning the sun invalidates every split.
+    rig.update(cam, core.Vec3(-0.3, 0.4, -0.8).normalized())
+    assert rig.get_num_dirty_cascades() == 3
+
+    rig.update(cam, core.Vec3(-0.3, 0.4, -0.8).normalized())
+    assert not rig.needs_shadow_render()
+
+    rig.mark_all_cascades_dirty()
+    rig.update(cam, core.Vec3(-0.3, 0.4, -0.8).normalized())
+    assert rig.get_num_dirty_cascades() == 3
+
+
+def test_pssm_setters_force_update(scene):
+    render, cam = scene
+    rig = make_rig(render, 3)
+    for i in range(3):
+        rig.set_cascade_update_policy(i, PSSMCameraRig.CUP_interval, 8)
+    rig.update(cam, LIGHT_VECTOR)
+
+    setters = [
+        (rig.set_pssm_distance, 300),
+        (rig.set_sun_distance, 800),
+        (rig.set_logarithmic_factor, 2),
+        (rig.set_use_fixed_film_size, True),
+        (rig.set_resolution, 1024),
+        (rig.set_use_stable_csm, False),
+        (rig.set_border_bias, 0.1),
+    ]
+    for setter, value in setters:
+        # Let the splits settle into holding their old matrices.
+        for i in range(2):
+            rig.update(cam, LIGHT_VECTOR)
+        assert rig.get_num_dirty_cascades() < 3
+
+        # A changed parameter makes every split recompute at once, rather than
+        # when its interval comes up.
+        setter(value)
+        rig.update(cam, LIGHT_VECTOR)
+        assert rig.get_num_dirty_cascades() == 3
+
+        # Setting the same value again changes nothing.
+        rig.update(cam, LIGHT_VECTOR)
+        setter(value)
+        rig.update(cam, LIGHT_VECTOR)
+        assert rig.get_num_dirty_cascades() < 3
+
+
+def test_pssm_every_frame(scene):
+    render, cam = scene
+    rig = make_rig(render, 2)
+
+    # The default policy re-renders every split on every frame.
+    for i in range(3):
+        rig.update(cam, LIGHT_VECTOR)
+        assert rig.get_num_dirty_cascades() == 2
+        assert rig.needs_shadow_render()
@@ -0,0 +1,131 @@
+import random
+import time
+
+import pytest
+
+bsp = pytest.importorskip("panda3d.bsp")
+TexturePacker = bsp.TexturePacker
+
+
+def lightmap_sizes(count, seed):
+    # Roughly the distribution of lightmap sizes in our levels: mostly tiny
+    # lightmaps from small or distant faces, with a long tail of big floors
+    # and walls.
+    rng = random.Random(seed)
+
+    def size():
+        r = rng.random()
+        if r < 0.6:
+            return rng.randint(2, 9)
+        elif r < 0.9:
+            return rng.randint(8, 31)
+        elif r < 0.98:
+            return rng.randint(32, 63)
+        return rng.randint(64, 127)
+
+    return [(size(), size()) for i in range(count)]
+
+
+def assert_valid_packing(packer, sizes, result):
+    rects = []
+    for i, (wid, hit) in enumerate(sizes):
+        loc = packer.getTextureLocation(i)
+        if loc.get_rotated():
+            assert (loc.get_width(), loc.get_height()) == (hit, wid)
+        else:
+            assert (loc.get_width(), loc.get_height()) == (wid, hit)
+
+        x0, y0 = loc.get_x(), loc.get_y()
+        x1, y1 = x0 + loc.get_width(), y0 + loc.get_height()
+        assert x0 >= 0 and y0 >= 0
+        assert x1 <= result.get_width() and y1 <= result.get_height()
+        rects.append((x0, y0, x1, y1))
+
+    rects.sort()
+    for i, a in enumerate(rects):
+        for b in rects[i + 1:]:
+            if b[0] >= a[2]:
+                break
+            assert not (a[1] < b[3] and b[1] < a[3]), "overlapping textures"
+
+
+@pytest.mark.parametrize("count", [1, 50, 1000])
+@pytest.mark.parametrize("border", [False, True])
+def test_skyline_packer(count, border):
+    sizes = lightmap_sizes(count, count)
+
+    packer = TexturePacker.createTexturePacker(TexturePacker.PT_skyline)
+    for wid, hit in sizes:
+        packer.addNewTexture(wid, hit)
+    result = packer.packTextures(True, border)
+
+    assert packer.getTextureCount() == count
+    assert_valid_packing(packer, sizes, result)
+    assert 0.0 < packer.getPackingEfficiency() <= 1.0
+    TexturePacker.releaseTexturePacker(packer)
+
+
+def test_skyline_incremental_fit():
+    sizes = lightmap_sizes(2000, 1)
+    max_size = 256
+
+    palettes = []
+    for wid, hit in sorted(sizes, key=lambda s: -max(s)):
+        for packer, members in palettes:
+            if packer.wouldTextureFit(wid, hit, True, False, max_size, max_size):
+                packer.addNewTexture(wid, hit)
+                members.append((wid, hit))
+                break
+        else:
+            packer = TexturePacker.createTexturePacker(TexturePacker.PT_skyline)
+            packer.addNewTexture(wid, hit)
+            palettes.append((packer, [(wid, hit)]))
+
+    assert len(palettes) > 1
+    for packer, members in palettes:
+        result = packer.packTextures(True, False)
+        assert result.get_width() <= max_size
+        assert result.get_height() <= max_size
+        assert_valid_packing(packer, members, result)
+        TexturePacker.releaseTexturePacker(packer)
+
+
+def test_skyline_vs_classic():
+    # The skyline packer should never need a bigger palette than the classic
+    # one for the same set of lightmaps.
+    sizes = lightmap_sizes(3000, 3000)
+
+    areas = {}
+    for name, type in (("classic", TexturePacker.PT_classic),
+                       ("skyline", TexturePacker.PT_skyline)):
+        packer = TexturePacker.createTexturePacker(type)
+        for wid, hit in sizes:
+            packer.addNewTexture(wid, hit)
+        result = packer.packTextures(True, False)
+        if type == TexturePacker.PT_skyline:
+            assert_valid_packing(packer, sizes, result)
+
+        areas[name] = result.get_width() * result.get_height()
+        TexturePacker.releaseTexturePacker(packer)
+
+    assert areas["skyline"] <= areas["classic"]
+
+
+@pytest.mark.benchmark_test
+def test_skyline_vs_classic_benchmark():
+    # Prints the time and efficiency of both packers; run with -s.
+    sizes = lightmap_sizes(3000, 3000)
+
+    for name, type in (("classic", TexturePacker.PT_classic),
+                       ("skyline", TexturePacker.PT_skyline)):
+        packer = TexturePacker.createTexturePacker(type)
+        start = time.perf_counter()
+        for wid, hit in sizes:
+            packer.addNewTexture(wid, hit)
+        result = packer.packTextures(True, False)
+        elapsed = time.perf_counter() - start
+
+        print("%s: %dx%d, %.1f%% efficient, %.1f ms" % (
+            name, result.get_width(), result.get_height(),
+            packer.getPackingEfficiency() * 100, elapsed * 1000))
+        TexturePacker.releaseTexturePacker(packer)
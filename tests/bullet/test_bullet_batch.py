@@ -0,0 +1,129 @@
+import pytest
+
+# Skip these tests if we can't import bullet.
+bullet = pytest.importorskip("panda3d.bullet")
+from panda3d import core
+
+
+def make_boxes(world, mass=0):
+    root = core.NodePath("root")
+    shape = bullet.BulletBoxShape((0.5, 0.5, 0.5))
+    for i in range(20):
+        node = bullet.BulletRigidBodyNode("box%d" % i)
+        node.add_shape(shape)
+        node.set_mass(mass)
+        node.set_into_collide_mask(core.CollideMask.bit(i % 2))
+        np = root.attach_new_node(node)
+        np.set_pos(i * 2, 0, 0)
+        world.attach(node)
+    return root
+
+
+@pytest.fixture
+def boxes(world):
+    return make_boxes(world)
+
+
+@pytest.fixture
+def mt_world():
+    # A world built with bullet-multithreaded on, which only takes effect if
+    # Bullet itself was built with multithreading (HAVE_BULLET_MT).
+    var = core.ConfigVariableBool("bullet-multithreaded")
+    value = var.get_value()
+    var.set_value(True)
+    try:
+        world = bullet.BulletWorld()
+    finally:
+        var.set_value(value)
+
+    if not world.multithreaded:
+        pytest.skip("requires Bullet to be built with multithreading")
+    return world
+
+
+def check_ray_test_batch(world):
+    batch = bullet.BulletRayBatch()
+    rays = []
+    for i in range(50):
+        from_pos = core.Point3(i * 0.8, 0, 10)
+        to_pos = core.Point3(i * 0.8, 0, -10)
+        mask = core.CollideMask.bit(i % 3)
+        batch.add_ray(from_pos, to_pos, mask)
+        rays.append((from_pos, to_pos, mask))
+    assert batch.get_num_rays() == 50
+
+    world.ray_test_batch(batch)
+    assert batch.get_num_results() == 50
+
+    num_hits = 0
+    for (from_pos, to_pos, mask), result in zip(rays, batch.results):
+        expected = world.ray_test_closest(from_pos, to_pos, mask)
+        assert result.has_hit() == expected.has_hit()
+        if expected.has_hit():
+            num_hits += 1
+            assert result.get_node() == expected.get_node()
+            assert result.get_hit_pos().almost_equal(expected.get_hit_pos())
+            assert result.get_hit_fraction() == pytest.approx(expected.get_hit_fraction())
+    assert num_hits > 0
+
+    batch.clear()
+    assert batch.get_num_rays() == 0
+    assert batch.get_num_results() == 0
+
+
+def check_sweep_test_batch(world):
+    shape = bullet.BulletSphereShape(0.25)
+    batch = bullet.BulletSweepBatch()
+    sweeps = []
+    for i in range(30):
+        from_ts = core.TransformState.make_pos((i * 1.3, 0, 10))
+        to_ts = core.TransformState.make_pos((i * 1.3, 0, -10))
+        batch.add_sweep(shape, from_ts, to_ts)
+        sweeps.append((from_ts, to_ts))
+
+    world.sweep_test_batch(batch)
+    assert batch.get_num_results() == 30
+
+    num_hits = 0
+    for (from_ts, to_ts), result in zip(sweeps, batch.results):
+        expected = world.sweep_test_closest(shape, from_ts, to_ts)
+        assert result.has_hit() == expected.has_hit()
+        if expected.has_hit():
+            num_hits += 1
+            assert result.get_node() == expected.get_node()
+            assert result.get_hit_fraction() == pytest.approx(expected.get_hit_fraction())
+    assert num_hits > 0
+
+
+def test_ray_test_batch(world, boxes):
+    check_ray_test_batch(world)
+
+
+def test_sweep_test_batch(world, boxes):
+    check_sweep_test_batch(world)
+
+
+def test_batch_multithreaded(mt_world):
+    # Let the boxes fall towards a floor first, so that the queries run
+    # against a world that the parallel solver has stepped.
+    world = mt_world
+    world.set_gravity((0, 0, -9.81))
+    floor = bullet.BulletRigidBodyNode("floor")
+    floor.add_shape(bullet.BulletPlaneShape((0, 0, 1), -5))
+    world.attach(floor)
+
+    root = make_boxes(world, mass=1)
+    for np in root.get_children():
+        np.set_z(2)
+
+    for i in range(30):
+        world.do_physics(1.0 / 60, 1, 1.0 / 60)
+    assert root.get_child(0).get_z() < 2
+
+    check_ray_test_batch(world)
+    check_sweep_test_batch(world)
+
+
+def test_multithreaded_flag(world):
+    # Off by default; see bullet-multithreaded.
+    assert not world.multithreaded
@@ -0,0 +1,244 @@
+from panda3d import core
+import math
+import struct
+import pytest
+
+
+NUM_FRAMES = 120
+TOLERANCE = 0.05
+
+
+def make_bundle():
+    bundle = core.AnimBundle("bundle", 24, NUM_FRAMES)
+    skeleton = core.AnimGroup(bundle, "<skeleton>")
+    channel = core.AnimChannelMatrixXfmTable(skeleton, "joint")
+
+    # A smoothly varying rotation, a linear translation, and a few constant
+    # and missing tables.
+    channel.set_table('h', core.PTA_float([math.sin(f * 0.02) * 45 for f in range(NUM_FRAMES)]))
+    channel.set_table('p', core.PTA_float([f * 0.5 for f in range(NUM_FRAMES)]))
+    channel.set_table('x', core.PTA_float([2.0 * f for f in range(NUM_FRAMES)]))
+    channel.set_table('y', core.PTA_float([3.0] * NUM_FRAMES))
+    channel.set_table('i', core.PTA_float([1.5]))
+    return bundle, channel
+
+
+def get_tables(channel):
+    return {id: list(channel.get_table(id)) for id in "ijkabchprxyz" if channel.has_table(id)}
+
+
+def assert_tables_close(tables, expected):
+    assert tables.keys() == expected.keys()
+    for id, table in expected.items():
+        if len(table) == 1 or len(set(table)) == 1:
+            assert tables[id][0] == pytest.approx(table[0], abs=TOLERANCE)
+            continue
+
+        assert len(tables[id]) == len(table)
+        # The error is the tolerance plus half a quantization step.
+        step = (max(table) - min(table)) / 65535.0
+        for value, orig in zip(tables[id], table):
+            assert value == pytest.approx(orig, abs=TOLERANCE + step)
+
+
+def test_quantize_channel():
+    bundle, channel = make_bundle()
+    expected = get_tables(channel)
+
+    assert not channel.is_quantized()
+    assert bundle.quantize_channels(TOLERANCE) == 1
+    assert channel.is_quantized()
+
+    # The keyframe reduction should have dropped most of the frames, but the
+    # first and the last frame are always kept.
+    assert 2 <= channel.get_num_keys() < NUM_FRAMES // 2
+
+    assert_tables_close(get_tables(channel), expected)
+
+    channel.dequantize()
+    assert not channel.is_quantized()
+    assert_tables_close(get_tables(channel), expected)
+
+
+def test_quantize_linear_channel():
+    bundle = core.AnimBundle("bundle", 24, NUM_FRAMES)
+    channel = core.AnimChannelMatrixXfmTable(bundle, "joint")
+    channel.set_table('z', core.PTA_float([f * 0.25 for f in range(NUM_FRAMES)]))
+
+    assert channel.quantize(TOLERANCE)
+    assert channel.get_num_keys() == 2
+
+
+def test_quantize_mismatched_tables():
+    bundle = core.AnimBundle("bundle", 24, 4)
+    channel = core.AnimChannelMatrixXfmTable(bundle, "joint")
+    channel.set_table('x', core.PTA_float([0, 1, 2, 3]))
+    channel.set_table('y', core.PTA_float([0, 1, 2, 3, 4]))
+
+    assert not channel.quantize(TOLERANCE)
+    assert not channel.is_quantized()
+
+
+def test_set_table_dequantizes():
+    bundle, channel = make_bundle()
+    channel.quantize(TOLERANCE)
+
+    channel.set_table('z', core.PTA_float([1.0]))
+    assert not channel.is_quantized()
+    assert tuple(channel.get_table('z')) == (1.0, )
+    assert len(channel.get_table('h')) == NUM_FRAMES
+
+
+def make_posed_character(num_joints):
+    # A character with a chain of joints, animated by channels that are
+    # alternately quantized and plain tables.
+    character = core.Character("character")
+    bundle = character.get_bundle(0)
+    skeleton = core.PartGroup(bundle, "<skeleton>")
+
+    anim = core.AnimBundle("character", 24, NUM_FRAMES)
+    anim_skeleton = core.AnimGroup(anim, "<skeleton>")
+
+    joints = []
+    channels = []
+    parent = skeleton
+    anim_parent = anim_skeleton
+    for i in range(num_joints):
+        joint = core.CharacterJoint(character, bundle, parent, "joint%d" % i, core.LMatrix4.ident_mat())
+        channel = core.AnimChannelMatrixXfmTable(anim_parent, "joint%d" % i)
+        channel.set_table('h', core.PTA_float([math.sin(f * 0.05 + i) * 30 for f in range(NUM_FRAMES)]))
+        channel.set_table('r', core.PTA_float([f * 0.1 * i for f in range(NUM_FRAMES)]))
+        channel.set_table('y', core.PTA_float([1.0 + i]))
+        channel.set_table('z', core.PTA_float([math.cos(f * 0.03) for f in range(NUM_FRAMES)]))
+        if i % 2 == 0:
+            assert channel.quantize(TOLERANCE)
+        joints.append(joint)
+        channels.append(channel)
+        parent = joint
+        anim_parent = channel
+
+    control = bundle.bind_anim(anim)
+    assert control is not None
+    return bundle, control, joints, channels
+
+
+def expected_matrix(channel, frame):
+    def value(id, default):
+        table = channel.get_table(id)
+        return table[frame % len(table)] if len(table) > 0 else default
+
+    mat = core.LMatrix4()
+    core.compose_matrix(mat,
+                        core.LVecBase3(*[value(id, 1) for id in "ijk"]),
+                        core.LVecBase3(*[value(id, 0) for id in "abc"]),
+                        core.LVecBase3(*[value(id, 0) for id in "hpr"]),
+                        core.LVecBase3(*[value(id, 0) for id in "xyz"]))
+    return mat
+
+
+def test_bundle_update_batch():
+    # A single animation without frame blending samples all of the joints in
+    # one batch, which must give the same matrices as sampling each channel.
+    bundle, control, joints, channels = make_posed_character(40)
+    assert not bundle.get_frame_blend_flag()
+
+    for frame in (0, 1, 17, 60, NUM_FRAMES - 1):
+        control.pose(frame)
+        bundle.force_update()
+        for joint, channel in zip(joints, channels):
+            assert joint.get_transform().almost_equal(expected_matrix(channel, frame), 1e-4)
+
+    # With frame blending, each joint is sampled on its own, which should give
+    # the same result on a whole frame.
+    bundle.set_frame_blend_flag(True)
+    control.pose(17)
+    bundle.force_update()
+    for joint, channel in zip(joints, channels):
+        assert joint.get_transform().almost_equal(expected_matrix(channel, 17), 1e-4)
+
+
+def write_bundle(bundle, minor_ver):
+    buffer = core.DatagramBuffer()
+    writer = core.BamWriter(buffer)
+    writer.set_file_minor_ver(minor_ver)
+    writer.init()
+    writer.write_object(bundle)
+    writer.flush()
+    return buffer.data
+
+
+def read_bundle(data):
+    reader = core.BamReader(core.DatagramBuffer(data))
+    reader.init()
+    bundle = reader.read_object()
+    reader.resolve()
+    return bundle
+
+
+@pytest.mark.parametrize("minor_ver", [44, 46])
+def test_quantized_bam_round_trip(minor_ver):
+    bundle, channel = make_bundle()
+    channel.quantize(TOLERANCE)
+    expected = get_tables(channel)
+
+    data = write_bundle(bundle, minor_ver)
+    result = read_bundle(data).find_child("joint")
+
+    # Older bam files can only store the tables as floats.
+    assert result.is_quantized() == (minor_ver >= 46)
+    assert get_tables(result) == pytest.approx(expected)
+
+
+def test_quantized_bam_smaller():
+    bundle, channel = make_bundle()
+    data = write_bundle(bundle, 46)
+
+    channel.quantize(TOLERANCE)
+    quantized_data = write_bundle(bundle, 46)
+
+    assert len(quantized_data) * 2 < len(data)
+
+
+def test_quantize_channels_config():
+    bundle, channel = make_bundle()
+    expected = get_tables(channel)
+
+    var = core.ConfigVariableBool("quantize-channels")
+    var.set_value(True)
+    try:
+        data = write_bundle(bundle, 46)
+    finally:
+        var.clear_local_value()
+
+    # The channel itself is left alone, only the written copy is quantized.
+    assert not channel.is_quantized()
+
+    result = read_bundle(data).find_child("joint")
+    assert result.is_quantized()
+    assert_tables_close(get_tables(result), expected)
+
+
+@pytest.mark.parametrize("num_keys,keys", [
+    (0, (0, NUM_FRAMES - 1)),       # no keys at all
+    (0xffff, (0, NUM_FRAMES - 1)),  # more keys than there is data
+    (2, (1, NUM_FRAMES - 1)),       # not starting at the first frame
+    (2, (0, 0)),                    # not increasing
+    (2, (0, NUM_FRAMES)),           # past the last frame
+])
+def test_quantized_bam_corrupt(num_keys, keys):
+    bundle = core.AnimBundle("bundle", 24, NUM_FRAMES)
+    channel = core.AnimChannelMatrixXfmTable(bundle, "joint")
+    channel.set_table('z', core.PTA_float([f * 0.25 for f in range(NUM_FRAMES)]))
+    assert channel.quantize(TOLERANCE)
+    assert channel.get_num_keys() == 2
+
+    # The key list is the only place where these values appear together.
+    data = bytearray(write_bundle(bundle, 46))
+    pos = data.find(struct.pack("<HHH", 2, 0, NUM_FRAMES - 1))
+    assert pos >= 0
+    data[pos:pos + 6] = struct.pack("<HHH", num_keys, *keys)
+
+    # The table is thrown away rather than sampled out of bounds.
+    result = read_bundle(bytes(data)).find_child("joint")
+    assert not result.is_quantized()
+    assert get_tables(result) == {}
@@ -0,0 +1,181 @@
+import math
+import pytest
+from panda3d import core
+
+# Skip these tests if we can't import egg.
+egg = pytest.importorskip("panda3d.egg")
+
+
+MODEL_EGG = b"""
+<CoordinateSystem> { Z-Up }
+<Group> model {
+  <Dart> { 1 }
+  <Joint> root {
+    <Joint> child {
+      <Transform> { <Translate> { 0 1 0 } }
+      <Joint> tip {
+        <Transform> { <Translate> { 0 0 1 } }
+      }
+    }
+  }
+}
+"""
+
+# The same skeleton, without the tip joint.
+SMALL_MODEL_EGG = b"""
+<CoordinateSystem> { Z-Up }
+<Group> model {
+  <Dart> { 1 }
+  <Joint> root {
+    <Joint> child {
+      <Transform> { <Translate> { 0 1 0 } }
+    }
+  }
+}
+"""
+
+ANIM_EGG = b"""
+<CoordinateSystem> { Z-Up }
+<Table> {
+  <Bundle> model {
+    <Table> "<skeleton>" {
+      <Table> root {
+        <Xfm$Anim_S$> xform {
+          <Scalar> fps { 24 }
+          <S$Anim> h { <V> { 0 10 20 30 } }
+        }
+        <Table> child {
+          <Xfm$Anim_S$> xform {
+            <Scalar> fps { 24 }
+            <S$Anim> y { <V> { 1 } }
+            <S$Anim> z { <V> { 0 1 2 3 } }
+          }
+          <Table> tip {
+            <Xfm$Anim_S$> xform {
+              <Scalar> fps { 24 }
+              <S$Anim> z { <V> { 1 } }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+"""
+
+
+def load_egg(text):
+    data = egg.EggData()
+    assert data.read(core.StringStream(text))
+    return core.NodePath(egg.load_egg_data(data))
+
+
+def make_character():
+    model = load_egg(MODEL_EGG)
+    anim = load_egg(ANIM_EGG)
+    anim.reparent_to(model)
+
+    controls = core.AnimControlCollection()
+    core.auto_bind(model.node(), controls, ~0)
+    assert controls.get_num_anims() == 1
+
+    character = model.find("**/+Character").node()
+    return character, controls
+
+
+def get_net_pos(character, joint_name):
+    mat = core.LMatrix4()
+    character.find_joint(joint_name).get_net_transform(mat)
+    return mat.get_row3(3)
+
+
+def expected_tip_pos(frame):
+    # The root spins around Z, the child is pushed up by one unit per frame,
+    # and the tip sits one unit above the child.
+    h = math.radians(frame * 10)
+    return (-math.sin(h), math.cos(h), frame + 1)
+
+
+@pytest.fixture
+def frame_clock():
+    clock = core.ClockObject.get_global_clock()
+    mode = clock.get_mode()
+    clock.set_mode(core.ClockObject.M_non_real_time)
+    yield clock
+    clock.set_mode(mode)
+
+
+def test_character_update(frame_clock):
+    character, controls = make_character()
+
+    for frame in range(4):
+        controls.pose(controls.get_anim_name(0), frame)
+        frame_clock.tick()
+        character.update()
+        assert tuple(get_net_pos(character, "tip")) == pytest.approx(expected_tip_pos(frame), abs=1e-4)
+
+
+def test_scheduler_update(frame_clock):
+    scheduler = core.AnimationScheduler.get_global_ptr()
+    characters = [make_character() for i in range(8)]
+
+    for frame in range(4):
+        for character, controls in characters:
+            controls.pose(controls.get_anim_name(0), frame)
+            scheduler.schedule(character)
+            # Scheduling a character twice in the same frame is harmless.
+            scheduler.schedule(character)
+
+        assert scheduler.get_num_scheduled() == len(characters)
+        frame_clock.tick()
+        scheduler.update()
+        assert scheduler.get_num_updated() == len(characters)
+        assert scheduler.get_num_scheduled() == 0
+
+        for character, controls in characters:
+            assert tuple(get_net_pos(character, "tip")) == pytest.approx(expected_tip_pos(frame), abs=1e-4)
+
+
+def test_scheduler_without_update(frame_clock):
+    scheduler = core.AnimationScheduler.get_global_ptr()
+    scheduler.update()
+    characters = [make_character() for i in range(4)]
+
+    # Without anything calling update(), only the characters scheduled in the
+    # last two frames are held on to.
+    for frame in range(10):
+        for character, controls in characters:
+            scheduler.schedule(character)
+        assert scheduler.get_num_scheduled() <= len(characters) * 2
+        frame_clock.tick()
+
+    scheduler.update()
+    assert scheduler.get_num_updated() <= len(characters) * 2
+    assert scheduler.get_num_scheduled() == 0
+
+
+def test_merge_bundles_update(frame_clock):
+    # Animate a character with a smaller skeleton first, so that its bundle
+    # has already flattened its list of parts.
+    small = load_egg(SMALL_MODEL_EGG).find("**/+Character").node()
+    small.force_update()
+
+    model = load_egg(MODEL_EGG)
+    anim = load_egg(ANIM_EGG)
+    character = model.find("**/+Character").node()
+
+    # Merging moves the character onto the small bundle, which gains the tip
+    # joint.  The next update must see the new joint.
+    character.merge_bundles(character.get_bundle_handle(0), small.get_bundle_handle(0))
+    assert character.get_bundle(0).this == small.get_bundle(0).this
+
+    anim.reparent_to(model)
+    controls = core.AnimControlCollection()
+    core.auto_bind(model.node(), controls, ~0)
+    assert controls.get_num_anims() == 1
+
+    for frame in range(4):
+        controls.pose(controls.get_anim_name(0), frame)
+        frame_clock.tick()
+        character.update()
+        assert tuple(get_net_pos(character, "tip")) == pytest.approx(expected_tip_pos(frame), abs=1e-4)
@@ -0,0 +1,147 @@
+from panda3d import core
+import random
+
+
+def make_items(rng, parent, count=400, size=100):
+    # Many small "into" objects spread across a flat area.
+    items = []
+    for i in range(count):
+        cnode = core.CollisionNode("item%d" % (i))
+        if i % 3 == 0:
+            cnode.add_solid(core.CollisionBox((0, 0, 0), 0.5, 0.5, 1))
+        else:
+            cnode.add_solid(core.CollisionSphere(0, 0, 0, rng.uniform(0.3, 1.0)))
+        np = parent.attach_new_node(cnode)
+        np.set_pos(rng.uniform(0, size), rng.uniform(0, size), rng.uniform(0, 2))
+        items.append(np)
+    return items
+
+
+def make_colliders(rng, root, count=40, size=100):
+    colliders = []
+    for i in range(count):
+        cnode = core.CollisionNode("collider%d" % (i))
+        kind = i % 3
+        if kind == 0:
+            cnode.add_solid(core.CollisionSphere(0, 0, 0, rng.uniform(0.5, 3)))
+        elif kind == 1:
+            cnode.add_solid(core.CollisionRay(0, 0, 5, 0, 0, -1))
+        else:
+            cnode.add_solid(core.CollisionSegment(0, 0, 0, rng.uniform(-4, 4), rng.uniform(-4, 4), 1))
+        cnode.set_into_collide_mask(0)
+        np = root.attach_new_node(cnode)
+        np.set_pos(rng.uniform(0, size), rng.uniform(0, size), rng.uniform(0, 2))
+        colliders.append(np)
+    return colliders
+
+
+def collide(root, colliders):
+    trav = core.CollisionTraverser()
+    queue = core.CollisionHandlerQueue()
+    for np in colliders:
+        trav.add_collider(np, queue)
+    trav.traverse(root)
+    return sorted((entry.get_from_node_path().name, entry.get_into_node_path().name)
+                  for entry in queue.entries)
+
+
+def make_scene(seed, broadphase, cell_size=4):
+    rng = random.Random(seed)
+    root = core.NodePath("root")
+    if broadphase:
+        parent = root.attach_new_node(core.CollisionBroadphase("items", cell_size))
+    else:
+        parent = root.attach_new_node("items")
+    parent.set_pos(-3, 2, 0)
+    items = make_items(rng, parent)
+    colliders = make_colliders(rng, root)
+    return root, parent, items, colliders
+
+
+def test_broadphase_matches_plain_node():
+    root, parent, items, colliders = make_scene(1, False)
+    expected = collide(root, colliders)
+    assert len(expected) > 0
+
+    for cell_size in (0.5, 4, 50):
+        root, parent, items, colliders = make_scene(1, True, cell_size)
+        assert collide(root, colliders) == expected
+
+
+def test_broadphase_moving_children():
+    # Move the children around between traversals, and add and remove some;
+    # the grid must keep up.
+    scenes = [make_scene(2, False), make_scene(2, True)]
+    rng = random.Random(3)
+    for frame in range(5):
+        moves = [(rng.randrange(400), rng.uniform(0, 100), rng.uniform(0, 100)) for i in range(50)]
+        results = []
+        for root, parent, items, colliders in scenes:
+            for index, x, y in moves:
+                items[index].set_pos(x, y, 0)
+            if frame == 2:
+                items[7].detach_node()
+                items[8].reparent_to(root)
+            if frame == 3:
+                items[7].reparent_to(parent)
+            if frame == 4:
+                parent.set_pos(5, 5, 0)
+            results.append(collide(root, colliders))
+
+        assert len(results[0]) > 0
+        assert results[1] == results[0]
+
+
+def test_broadphase_large_child():
+    # A child that covers the whole area is always visited.
+    root, parent, items, colliders = make_scene(4, True, 1)
+    floor = core.CollisionNode("floor")
+    floor.add_solid(core.CollisionPlane(core.Plane((0, 0, 1), (0, 0, 0))))
+    parent.attach_new_node(floor)
+    big = core.CollisionNode("big")
+    big.add_solid(core.CollisionBox((50, 50, 0), 60, 60, 0.1))
+    parent.attach_new_node(big)
+
+    names = set(into for from_, into in collide(root, colliders))
+    assert "floor" in names
+    assert "big" in names
+
+
+def test_broadphase_cell_size():
+    node = core.CollisionBroadphase("items", 2)
+    assert node.cell_size == 2
+    node.cell_size = 8
+    assert node.get_cell_size() == 8
+
+    parent = core.NodePath(node)
+    cnode = core.CollisionNode("item")
+    cnode.add_solid(core.CollisionSphere(0, 0, 0, 1))
+    parent.attach_new_node(cnode).set_pos(3, 3, 3)
+    assert node.get_num_cells() == 1
+    node.cell_size = 0.5
+    assert node.get_num_cells() > 1
+
+
+def test_broadphase_bam_round_trip():
+    root, parent, items, colliders = make_scene(6, True, 3.5)
+    expected = collide(root, colliders)
+    assert len(expected) > 0
+
+    buffer = core.DatagramBuffer()
+    writer = core.BamWriter(buffer)
+    writer.init()
+    writer.write_object(parent.node())
+    writer.flush()
+
+    reader = core.BamReader(core.DatagramBuffer(buffer.data))
+    reader.init()
+    node = reader.read_object()
+    reader.resolve()
+
+    assert isinstance(node, core.CollisionBroadphase)
+    assert node.cell_size == 3.5
+    assert node.get_num_children() == len(items)
+
+    parent.remove_node()
+    root.attach_new_node(node).set_pos(-3, 2, 0)
+    assert collide(root, colliders) == expected
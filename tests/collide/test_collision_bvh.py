@@ -0,0 +1,234 @@
+from panda3d import core
+import random
+import struct
+import pytest
+
+
+@pytest.fixture
+def bvh_min_solids():
+    var = core.ConfigVariableInt("collision-bvh-min-solids")
+    yield var
+    var.clear_local_value()
+
+
+def make_terrain(rng, size=40, name="terrain"):
+    # A bumpy grid of polygons, all in one CollisionNode.
+    heights = [[rng.uniform(0, 0.5) for y in range(size + 1)] for x in range(size + 1)]
+    cnode = core.CollisionNode(name)
+    for x in range(size):
+        for y in range(size):
+            cnode.add_solid(core.CollisionPolygon(
+                core.Point3(x, y, heights[x][y]),
+                core.Point3(x + 1, y, heights[x + 1][y]),
+                core.Point3(x + 1, y + 1, heights[x + 1][y + 1])))
+            cnode.add_solid(core.CollisionPolygon(
+                core.Point3(x, y, heights[x][y]),
+                core.Point3(x + 1, y + 1, heights[x + 1][y + 1]),
+                core.Point3(x, y + 1, heights[x][y + 1])))
+    return cnode
+
+
+def make_floor_mesh(rng, size=40):
+    mesh = core.CollisionFloorMesh()
+    for x in range(size + 1):
+        for y in range(size + 1):
+            mesh.add_vertex(core.Point3(x, y, rng.uniform(0, 0.5)))
+    for x in range(size):
+        for y in range(size):
+            a = x * (size + 1) + y
+            b = (x + 1) * (size + 1) + y
+            mesh.add_triangle(a, b, b + 1)
+            mesh.add_triangle(a, b + 1, a + 1)
+    return mesh
+
+
+def make_colliders(rng, root, count=64, size=40):
+    colliders = []
+    for i in range(count):
+        cnode = core.CollisionNode("collider%d" % (i))
+        if i % 4 == 0:
+            cnode.add_solid(core.CollisionRay(0, 0, 2, 0, 0, -1))
+        elif i % 4 == 1:
+            cnode.add_solid(core.CollisionSphere(0, 0, 0, 0.8))
+        elif i % 4 == 2:
+            cnode.add_solid(core.CollisionSegment(0, 0, 2, 0.5, 0.3, -1))
+        else:
+            cnode.add_solid(core.CollisionRay(0, 0, 1, 0.3, -0.2, -1))
+        cnode.set_into_collide_mask(0)
+        np = root.attach_new_node(cnode)
+        np.set_pos(rng.uniform(0, size), rng.uniform(0, size), rng.uniform(0, 1))
+        colliders.append(np)
+    return colliders
+
+
+def entry_key(entry):
+    point = entry.get_surface_point(entry.get_into_node_path().get_parent())
+    return (entry.get_from_node_path().name, entry.get_into_node_path().name,
+            repr(entry.get_into()),
+            round(point.x, 4), round(point.y, 4), round(point.z, 4))
+
+
+def traverse(root, colliders):
+    trav = core.CollisionTraverser()
+    queue = core.CollisionHandlerQueue()
+    for np in colliders:
+        trav.add_collider(np, queue)
+    trav.traverse(root)
+    return [entry_key(entry) for entry in queue.entries]
+
+
+def build_scene(seed, into):
+    rng = random.Random(seed)
+    root = core.NodePath("root")
+    if into == "terrain":
+        root.attach_new_node(make_terrain(rng))
+    else:
+        cnode = core.CollisionNode("floor")
+        cnode.add_solid(make_floor_mesh(rng))
+        root.attach_new_node(cnode)
+    colliders = make_colliders(rng, root)
+    return root, colliders
+
+
+@pytest.mark.parametrize("into", ["terrain", "floor"])
+def test_collision_bvh_matches_brute_force(bvh_min_solids, into):
+    results = []
+    for min_solids in (0, 1):
+        bvh_min_solids.set_value(min_solids)
+        root, colliders = build_scene(3, into)
+        results.append(traverse(root, colliders))
+
+    assert len(results[0]) > 0
+    assert results[1] == results[0]
+
+
+def test_collision_bvh_invalidated(bvh_min_solids):
+    bvh_min_solids.set_value(1)
+    rng = random.Random(4)
+    root = core.NodePath("root")
+    cnode = make_terrain(rng, 10)
+    root.attach_new_node(cnode)
+
+    ray_np = root.attach_new_node(core.CollisionNode("ray"))
+    ray_np.node().add_solid(core.CollisionRay(0, 0, 5, 0, 0, -1))
+    ray_np.node().set_into_collide_mask(0)
+    ray_np.set_pos(20.5, 20.5, 0)
+
+    # Nothing there yet; this builds the BVH.
+    assert traverse(root, [ray_np]) == []
+
+    # Adding a solid must make it visible to the traverser.
+    cnode.add_solid(core.CollisionPolygon(
+        core.Point3(20, 20, 1), core.Point3(21, 20, 1), core.Point3(21, 21, 1), core.Point3(20, 21, 1)))
+    assert len(traverse(root, [ray_np])) == 1
+
+    # And removing it must make it go away again.
+    cnode.remove_solid(cnode.get_num_solids() - 1)
+    assert traverse(root, [ray_np]) == []
+
+    # Changing a solid in place, too.
+    cnode.set_solid(0, core.CollisionPolygon(
+        core.Point3(20, 20, 1), core.Point3(21, 20, 1), core.Point3(21, 21, 1), core.Point3(20, 21, 1)))
+    assert len(traverse(root, [ray_np])) == 1
+
+
+def test_collision_floor_mesh_flatten(bvh_min_solids):
+    # Flattening a transform onto a floor mesh copies and transforms it, which
+    # must also move its BVH.
+    bvh_min_solids.set_value(1)
+    results = []
+    for flatten in (False, True):
+        root, colliders = build_scene(5, "floor")
+        floor = root.get_child(0)
+        floor.set_pos(-10, 5, 0.25)
+        floor.set_scale(1.5)
+        if flatten:
+            floor.flatten_light()
+            assert floor.get_mat() == core.Mat4.ident_mat()
+        results.append(traverse(root, colliders))
+
+    assert len(results[0]) > 0
+    assert results[1] == results[0]
+
+
+@pytest.mark.parametrize("minor_ver", [44, 47])
+@pytest.mark.parametrize("into", ["terrain", "floor"])
+def test_collision_bvh_bam(bvh_min_solids, minor_ver, into):
+    bvh_min_solids.set_value(1)
+    root, colliders = build_scene(6, into)
+    into_np = root.get_child(0)
+    expected = traverse(root, colliders)
+    assert len(expected) > 0
+
+    buffer = core.DatagramBuffer()
+    writer = core.BamWriter(buffer)
+    writer.set_file_minor_ver(minor_ver)
+    writer.init()
+    writer.write_object(into_np.node())
+    writer.flush()
+
+    reader = core.BamReader(core.DatagramBuffer(buffer.data))
+    reader.init()
+    assert reader.file_version == (6, minor_ver)
+    node = reader.read_object()
+    reader.resolve()
+
+    assert node.get_num_solids() == into_np.node().get_num_solids()
+    into_np.remove_node()
+    root.attach_new_node(node)
+    assert traverse(root, colliders) == expected
+
+
+def corrupt_bvh_index(data, pos, num_nodes):
+    # The first item index, after the nodes and the number of indices.
+    offset = pos + 4 + num_nodes * 32 + 4
+    data[offset:offset + 4] = struct.pack("<I", 0xffffffff)
+
+
+def corrupt_bvh_child(data, pos, num_nodes):
+    # The second child of the root node, pointing back at the root.
+    offset = pos + 4 + 24
+    data[offset:offset + 4] = struct.pack("<I", 0)
+
+
+def corrupt_bvh_node_count(data, pos, num_nodes):
+    data[pos:pos + 4] = struct.pack("<I", 0x7fffffff)
+
+
+@pytest.mark.parametrize("corrupt", [corrupt_bvh_index, corrupt_bvh_child, corrupt_bvh_node_count])
+def test_collision_bvh_bam_corrupt(bvh_min_solids, corrupt):
+    bvh_min_solids.set_value(1)
+    root, colliders = build_scene(6, "terrain")
+    into_np = root.get_child(0)
+    cnode = into_np.node()
+    expected = traverse(root, colliders)
+    assert len(expected) > 0
+
+    buffer = core.DatagramBuffer()
+    writer = core.BamWriter(buffer)
+    writer.set_file_minor_ver(47)
+    writer.init()
+    writer.write_object(cnode)
+    writer.flush()
+
+    # Find the stored hierarchy, which follows the from collide mask and a
+    # flag, and starts with the number of solids and the number of nodes.
+    data = bytearray(bytes(buffer.data))
+    prefix = struct.pack("<IBI", cnode.get_from_collide_mask().get_word(), 1, cnode.get_num_solids())
+    pos = data.find(prefix)
+    assert pos >= 0
+    pos += len(prefix)
+    num_nodes = struct.unpack_from("<I", data, pos)[0]
+    assert num_nodes > 1
+    corrupt(data, pos, num_nodes)
+
+    # The hierarchy is thrown away and rebuilt, giving the same results.
+    reader = core.BamReader(core.DatagramBuffer(bytes(data)))
+    reader.init()
+    node = reader.read_object()
+    reader.resolve()
+
+    assert node.get_num_solids() == cnode.get_num_solids()
+    into_np.remove_node()
+    root.attach_new_node(node)
+    assert traverse(root, colliders) == expected
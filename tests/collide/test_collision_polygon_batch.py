@@ -0,0 +1,173 @@
+from panda3d import core
+import random
+import time
+import pytest
+
+
+@pytest.fixture
+def config():
+    batch = core.ConfigVariableInt("collision-batch-min-polygons")
+    bvh = core.ConfigVariableInt("collision-bvh-min-solids")
+    yield batch, bvh
+    batch.clear_local_value()
+    bvh.clear_local_value()
+
+
+def make_mesh(rng, size=24, mixed=False):
+    # A tilted, bumpy grid of triangles and quads in one CollisionNode,
+    # optionally with a few other solids mixed in.
+    cnode = core.CollisionNode("mesh")
+    for x in range(size):
+        for y in range(size):
+            z = [rng.uniform(0, 0.4) for i in range(4)]
+            a = core.Point3(x, y, z[0] + x * 0.2)
+            b = core.Point3(x + 1, y, z[1] + x * 0.2 + 0.2)
+            c = core.Point3(x + 1, y + 1, z[2] + x * 0.2 + 0.2)
+            d = core.Point3(x, y + 1, z[3] + x * 0.2)
+            if (x + y) % 3 == 0:
+                # A flat quad.
+                cnode.add_solid(core.CollisionPolygon(a, b, c, a + (c - b)))
+            else:
+                cnode.add_solid(core.CollisionPolygon(a, b, c))
+                cnode.add_solid(core.CollisionPolygon(a, c, d))
+            if mixed and (x * size + y) % 37 == 0:
+                cnode.add_solid(core.CollisionSphere(x + 0.5, y + 0.5, x * 0.2, 0.3))
+    return cnode
+
+
+def make_colliders(rng, root, count=96, size=24):
+    colliders = []
+    for i in range(count):
+        cnode = core.CollisionNode("collider%d" % (i))
+        kind = i % 4
+        if kind == 0:
+            cnode.add_solid(core.CollisionRay(0, 0, 10, rng.uniform(-0.3, 0.3), rng.uniform(-0.3, 0.3), -1))
+        elif kind == 1:
+            cnode.add_solid(core.CollisionSegment(0, 0, 10, rng.uniform(-2, 2), rng.uniform(-2, 2), -2))
+        elif kind == 2:
+            cnode.add_solid(core.CollisionSphere(0, 0, 0, rng.uniform(0.2, 1.5)))
+        else:
+            # A ray nearly parallel to the slope.
+            cnode.add_solid(core.CollisionRay(0, 0, 0.5, 1, rng.uniform(-0.1, 0.1), 0.2))
+        cnode.set_into_collide_mask(0)
+        np = root.attach_new_node(cnode)
+        np.set_pos(rng.uniform(0, size), rng.uniform(0, size), rng.uniform(0, size * 0.2 + 0.5))
+        if i % 5 == 0:
+            np.set_scale(rng.uniform(0.5, 2))
+        colliders.append(np)
+    return colliders
+
+
+def entry_key(entry):
+    root = entry.get_into_node_path().get_parent()
+    point = entry.get_surface_point(root)
+    normal = entry.get_surface_normal(root)
+    return (entry.get_from_node_path().name, repr(entry.get_into()),
+            round(point.x, 4), round(point.y, 4), round(point.z, 4),
+            round(normal.x, 4), round(normal.y, 4), round(normal.z, 4))
+
+
+def run(seed, batch_min, bvh_min, config, mixed=False):
+    batch, bvh = config
+    batch.set_value(batch_min)
+    bvh.set_value(bvh_min)
+
+    rng = random.Random(seed)
+    root = core.NodePath("root")
+    mesh = root.attach_new_node(make_mesh(rng, mixed=mixed))
+    mesh.set_hpr(10, 5, 0)
+    colliders = make_colliders(rng, root)
+
+    trav = core.CollisionTraverser()
+    queue = core.CollisionHandlerQueue()
+    for np in colliders:
+        trav.add_collider(np, queue)
+    trav.traverse(root)
+    return [entry_key(entry) for entry in queue.entries]
+
+
+@pytest.mark.parametrize("bvh_min", [0, 1])
+@pytest.mark.parametrize("mixed", [False, True])
+def test_polygon_batch_matches_per_solid(config, bvh_min, mixed):
+    expected = run(11, 0, bvh_min, config, mixed)
+    assert len(expected) > 0
+    assert run(11, 1, bvh_min, config, mixed) == expected
+
+
+def test_polygon_batch_clip_planes(config):
+    # A clip plane on the mesh cuts the polygons, which the batch does not
+    # know about; it must still find the same collisions.
+    results = []
+    for batch_min in (0, 1):
+        config[0].set_value(batch_min)
+        config[1].set_value(0)
+        rng = random.Random(12)
+        root = core.NodePath("root")
+        mesh = root.attach_new_node(make_mesh(rng))
+        plane = root.attach_new_node(core.PlaneNode("clip", core.Plane((1, 1, 0), (12, 12, 0))))
+        mesh.set_clip_plane(plane)
+        colliders = make_colliders(rng, root)
+
+        trav = core.CollisionTraverser()
+        queue = core.CollisionHandlerQueue()
+        for np in colliders:
+            trav.add_collider(np, queue)
+        trav.traverse(root)
+        results.append([entry_key(entry) for entry in queue.entries])
+
+    assert len(results[0]) > 0
+    assert results[1] == results[0]
+
+
+def test_polygon_batch_invalidated(config):
+    config[0].set_value(1)
+    config[1].set_value(0)
+    root = core.NodePath("root")
+    cnode = make_mesh(random.Random(13), 4)
+    root.attach_new_node(cnode)
+
+    ray_np = root.attach_new_node(core.CollisionNode("ray"))
+    ray_np.node().add_solid(core.CollisionRay(0, 0, 5, 0, 0, -1))
+    ray_np.node().set_into_collide_mask(0)
+    ray_np.set_pos(10.5, 10.5, 0)
+
+    trav = core.CollisionTraverser()
+    queue = core.CollisionHandlerQueue()
+    trav.add_collider(ray_np, queue)
+    trav.traverse(root)
+    assert queue.get_num_entries() == 0
+
+    cnode.set_solid(0, core.CollisionPolygon(
+        core.Point3(10, 10, 1), core.Point3(11, 10, 1), core.Point3(11, 11, 1), core.Point3(10, 11, 1)))
+    trav.traverse(root)
+    assert queue.get_num_entries() == 1
+
+
+@pytest.mark.benchmark_test
+def test_polygon_batch_benchmark(config):
+    # Prints the traversal time with and without the batch; run with -s.
+    iterations = 10
+    timings = {}
+    for batch_min in (0, 1):
+        config[0].set_value(batch_min)
+        config[1].set_value(0)
+        rng = random.Random(14)
+        root = core.NodePath("root")
+        mesh = root.attach_new_node(make_mesh(rng, 48))
+        num_solids = mesh.node().get_num_solids()
+        colliders = make_colliders(rng, root, 96, 48)
+
+        trav = core.CollisionTraverser()
+        queue = core.CollisionHandlerQueue()
+        for np in colliders:
+            trav.add_collider(np, queue)
+
+        trav.traverse(root)
+        start = time.perf_counter()
+        for i in range(iterations):
+            trav.traverse(root)
+        timings[batch_min] = time.perf_counter() - start
+
+    print("\ntraverse, %d rays, segments and spheres against %d polygons in one node:" % (len(colliders), num_solids))
+    print("  per solid: %.3f ms" % (timings[0] * 1000.0 / iterations))
+    print("  batched:   %.3f ms" % (timings[1] * 1000.0 / iterations))
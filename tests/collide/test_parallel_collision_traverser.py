@@ -0,0 +1,118 @@
+from panda3d import core
+import random
+
+
+def make_level(rng, num_walls=200):
+    level = core.NodePath("level")
+
+    # A floor made of many polygons, and a few hundred walls scattered
+    # around, each in a CollisionNode of its own.
+    floor = core.CollisionNode("floor")
+    for x in range(-10, 10):
+        for y in range(-10, 10):
+            floor.add_solid(core.CollisionPolygon(
+                core.Point3(x * 5, y * 5, 0), core.Point3(x * 5 + 5, y * 5, 0),
+                core.Point3(x * 5 + 5, y * 5 + 5, 0), core.Point3(x * 5, y * 5 + 5, 0)))
+    level.attach_new_node(floor)
+
+    for i in range(num_walls):
+        wall = core.CollisionNode("wall%d" % (i))
+        wall.add_solid(core.CollisionBox(core.Point3(0, 0, 0), 1, 1, 2))
+        np = level.attach_new_node(wall)
+        np.set_pos(rng.uniform(-50, 50), rng.uniform(-50, 50), 0)
+
+    return level
+
+
+def make_colliders(rng, level, count=48):
+    colliders = []
+    for i in range(count):
+        cnode = core.CollisionNode("collider%d" % (i))
+        if i % 3 == 0:
+            cnode.add_solid(core.CollisionRay(0, 0, 2, 0, 0, -1))
+        elif i % 3 == 1:
+            cnode.add_solid(core.CollisionSphere(0, 0, 1, 1.5))
+        else:
+            # Two solids in one node.
+            cnode.add_solid(core.CollisionSphere(0, 0, 0.5, 0.5))
+            cnode.add_solid(core.CollisionSegment(0, 0, 3, 0, 0, -1))
+        cnode.set_into_collide_mask(0)
+        np = level.attach_new_node(cnode)
+        np.set_pos(rng.uniform(-45, 45), rng.uniform(-45, 45), rng.uniform(0, 1))
+        colliders.append(np)
+    return colliders
+
+
+def entry_key(entry):
+    point = entry.get_surface_point(entry.get_into_node_path().get_parent())
+    return (entry.get_from_node_path().name, repr(entry.get_from()),
+            entry.get_into_node_path().name, repr(entry.get_into()),
+            round(point.x, 4), round(point.y, 4), round(point.z, 4))
+
+
+def run_traversal(parallel, group_size=4):
+    rng = random.Random(5)
+    level = make_level(rng)
+    colliders = make_colliders(rng, level)
+
+    var = core.ConfigVariableInt("parallel-collision-group-size")
+    var.set_value(group_size)
+    try:
+        trav = core.CollisionTraverser("trav")
+        trav.parallel_traverse = parallel
+        queue = core.CollisionHandlerQueue()
+        for np in colliders:
+            trav.add_collider(np, queue)
+
+        trav.traverse(level)
+        return [entry_key(entry) for entry in queue.entries]
+    finally:
+        var.clear_local_value()
+
+
+def test_parallel_traverse_property():
+    trav = core.CollisionTraverser()
+    assert trav.parallel_traverse == core.ConfigVariableBool("parallel-collision-traverse").value
+
+    trav.parallel_traverse = True
+    assert trav.parallel_traverse is True
+    trav.parallel_traverse = False
+    assert trav.parallel_traverse is False
+
+
+def test_parallel_traverse_matches_serial():
+    serial = run_traversal(False)
+    parallel = run_traversal(True)
+    assert len(serial) > 0
+    assert sorted(parallel) == sorted(serial)
+
+
+def test_parallel_traverse_deterministic():
+    # The handler sees the entries in the same order every time, and
+    # regardless of how the colliders are grouped.
+    first = run_traversal(True, 4)
+    assert run_traversal(True, 4) == first
+    assert sorted(run_traversal(True, 1)) == sorted(first)
+    assert sorted(run_traversal(True, 32)) == sorted(first)
+
+
+def test_parallel_traverse_pusher():
+    # A pusher must push its colliders out of the walls the same way.
+    results = []
+    for parallel in (False, True):
+        rng = random.Random(7)
+        level = make_level(rng, 400)
+        colliders = make_colliders(rng, level, 64)
+
+        trav = core.CollisionTraverser()
+        trav.parallel_traverse = parallel
+        pusher = core.CollisionHandlerPusher()
+        for np in colliders:
+            if isinstance(np.node().get_solid(0), core.CollisionSphere):
+                pusher.add_collider(np, np)
+                trav.add_collider(np, pusher)
+
+        trav.traverse(level)
+        results.append([tuple(round(c, 4) for c in np.get_pos()) for np in colliders])
+
+    assert results[0] == results[1]
@@ -4,6 +4,28 @@ from panda3d import core
 from direct.showbase.ShowBase import ShowBase
 
 
+def pytest_addoption(parser):
+    parser.addoption('--run-benchmarks', action='store_true', default=False,
+                     help='run the tests marked as benchmarks, which print '
+                          'timings and are skipped by default')
+
+
+def pytest_configure(config):
+    config.addinivalue_line('markers',
+                            'benchmark_test: a timing benchmark, only run '
+                            'with --run-benchmarks')
+
+
+def pytest_collection_modifyitems(config, items):
+    if config.getoption('--run-benchmarks'):
+        return
+
+    skip = pytest.mark.skip(reason='benchmark; use --run-benchmarks to run')
+    for item in items:
+        if 'benchmark_test' in item.keywords:
+            item.add_marker(skip)
+
+
 @pytest.fixture
 def base():
     base = ShowBase(windowType='none')
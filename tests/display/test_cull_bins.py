@@ -0,0 +1,172 @@
+from panda3d import core
+import random
+import time
+import pytest
+
+
+@pytest.fixture(scope="module")
+def front_to_back_bin():
+    # There is no front_to_back bin by default.
+    bin_manager = core.CullBinManager.get_global_ptr()
+    if bin_manager.find_bin("front_to_back") < 0:
+        bin_manager.add_bin("front_to_back", core.CullBinManager.BT_front_to_back, 35)
+    return "front_to_back"
+
+
+def make_buffer(engine, graphics_pipe, size=32):
+    fbprops = core.FrameBufferProperties()
+    fbprops.force_hardware = True
+    fbprops.set_rgba_bits(8, 8, 8, 8)
+
+    buffer = engine.make_output(
+        graphics_pipe,
+        'buffer',
+        0,
+        fbprops,
+        core.WindowProperties.size(size, size),
+        core.GraphicsPipe.BF_refuse_window,
+    )
+    engine.open_windows()
+
+    if buffer is None:
+        pytest.skip("GraphicsPipe cannot make offscreen buffers")
+
+    tex = core.Texture()
+    buffer.add_render_texture(tex, core.GraphicsOutput.RTM_copy_ram)
+    buffer.set_clear_color_active(True)
+    buffer.set_clear_color((0, 0, 0, 1))
+    return buffer, tex
+
+
+def make_cards(scene, bin_name, count, seed=1):
+    """
+    Adds the given number of cards that all cover the center of the screen,
+    each at a different distance and with a different color.  Returns a list
+    of (distance, draw order, color) tuples.
+    """
+    rng = random.Random(seed)
+    cm = core.CardMaker("card")
+    cm.set_frame(-1, 1, -1, 1)
+    card_geom = cm.generate()
+
+    # Sharing a handful of states makes the state_sorted bin do some work.
+    colors = [(rng.random(), rng.random(), rng.random(), 1) for i in range(16)]
+
+    cards = []
+    for i in range(count):
+        distance = 5 + i * 0.01
+        draw_order = (i * 7919) % count - count // 2
+        color = colors[i % len(colors)]
+
+        card = scene.attach_new_node("card")
+        card_geom.instance_to(card)
+        card.set_y(distance)
+        card.set_scale(distance * 0.5 + rng.uniform(0, 0.1))
+        card.set_color(color)
+        card.set_bin(bin_name, draw_order)
+        cards.append((distance, draw_order, color))
+
+    rng.shuffle(cards)
+    return cards
+
+
+def render_cards(graphics_pipe, bin_name, threshold, count=300):
+    engine = core.GraphicsEngine()
+    engine.set_threading_model("")
+    buffer, tex = make_buffer(engine, graphics_pipe)
+
+    var = core.ConfigVariableInt("cull-bin-radix-sort-threshold")
+    var.set_value(threshold)
+    try:
+        scene = core.NodePath("root")
+        scene.set_depth_test(False)
+        scene.set_depth_write(False)
+        camera = scene.attach_new_node(core.Camera("camera"))
+        buffer.make_display_region().camera = camera
+
+        cards = make_cards(scene, bin_name, count)
+        engine.render_frame()
+        engine.render_frame()
+
+        peeker = tex.peek()
+        texel = core.LColor()
+        peeker.fetch_pixel(texel, tex.get_x_size() // 2, tex.get_y_size() // 2)
+        return cards, tuple(texel), tex.get_ram_image().get_data()
+    finally:
+        var.clear_local_value()
+        engine.remove_window(buffer)
+
+
+@pytest.mark.parametrize("threshold", [0, 1 << 30])
+def test_cull_bin_back_to_front(graphics_pipe, threshold):
+    cards, center, image = render_cards(graphics_pipe, "transparent", threshold)
+    nearest = min(cards)
+    assert center == pytest.approx(nearest[2], abs=0.01)
+
+
+@pytest.mark.parametrize("threshold", [0, 1 << 30])
+def test_cull_bin_front_to_back(graphics_pipe, front_to_back_bin, threshold):
+    cards, center, image = render_cards(graphics_pipe, front_to_back_bin, threshold)
+    farthest = max(cards)
+    assert center == pytest.approx(farthest[2], abs=0.01)
+
+
+@pytest.mark.parametrize("threshold", [0, 1 << 30])
+def test_cull_bin_fixed(graphics_pipe, threshold):
+    cards, center, image = render_cards(graphics_pipe, "fixed", threshold)
+    last = max(cards, key=lambda card: card[1])
+    assert center == pytest.approx(last[2], abs=0.01)
+
+
+@pytest.mark.parametrize("bin_name", ["opaque", "transparent", "fixed"])
+def test_cull_bin_radix_sort_matches(graphics_pipe, bin_name):
+    # The radix sort and the comparison sort must produce the same order.
+    radix = render_cards(graphics_pipe, bin_name, 0)[2]
+    compare = render_cards(graphics_pipe, bin_name, 1 << 30)[2]
+    assert radix == compare
+
+
+@pytest.mark.benchmark_test
+def test_cull_bin_sort_benchmark(graphics_pipe):
+    # Prints the time taken by the comparison and radix sorts; run with -s.
+    num_objects = 50000
+    frames = 10
+
+    engine = core.GraphicsEngine()
+    engine.set_threading_model("")
+    buffer, tex = make_buffer(engine, graphics_pipe)
+
+    try:
+        scene = core.NodePath("root")
+        camera = scene.attach_new_node(core.Camera("camera"))
+        buffer.make_display_region().camera = camera
+
+        # Tiny triangles spread out in front of the camera.
+        rng = random.Random(1)
+        cm = core.CardMaker("card")
+        cm.set_frame(-0.01, 0.01, -0.01, 0.01)
+        card_geom = cm.generate()
+        for i in range(num_objects):
+            card = scene.attach_new_node("card")
+            card_geom.instance_to(card)
+            card.set_pos(rng.uniform(-5, 5), rng.uniform(10, 100), rng.uniform(-5, 5))
+            card.set_bin("transparent", 0)
+
+        var = core.ConfigVariableInt("cull-bin-radix-sort-threshold")
+        timings = {}
+        try:
+            for threshold in (1 << 30, 0):
+                var.set_value(threshold)
+                engine.render_frame()
+                start = time.perf_counter()
+                for frame in range(frames):
+                    engine.render_frame()
+                timings[threshold] = time.perf_counter() - start
+        finally:
+            var.clear_local_value()
+    finally:
+        engine.remove_window(buffer)
+
+    print("\nrender_frame, %d objects in a back_to_front bin:" % (num_objects))
+    print("  comparison sort: %.3f ms/frame" % (timings[1 << 30] * 1000.0 / frames))
+    print("  radix sort:      %.3f ms/frame" % (timings[0] * 1000.0 / frames))
@@ -0,0 +1,266 @@
+from panda3d import core
+import random
+import pytest
+
+
+COLORS = [
+    (1, 0, 0, 1),
+    (0, 1, 0, 1),
+    (0, 0, 1, 1),
+    (1, 1, 0, 1),
+]
+
+
+@pytest.fixture(params=[False, True])
+def parallel_cull(request):
+    var = core.ConfigVariableBool("parallel-cull")
+    var.set_value(request.param)
+    yield request.param
+    var.clear_local_value()
+
+
+def make_scene(color):
+    scene = core.NodePath("root")
+    scene.set_depth_test(False)
+
+    camera = scene.attach_new_node(core.Camera("camera"))
+
+    cm = core.CardMaker("card")
+    cm.set_frame(-1, 1, -1, 1)
+    card = scene.attach_new_node(cm.generate())
+    card.set_pos(0, 2, 0)
+    card.set_scale(60)
+    card.set_color(color)
+    return scene, camera
+
+
+def make_buffer(engine, graphics_pipe, size=32):
+    fbprops = core.FrameBufferProperties()
+    fbprops.force_hardware = True
+    fbprops.set_rgba_bits(8, 8, 8, 8)
+
+    buffer = engine.make_output(
+        graphics_pipe,
+        'buffer',
+        0,
+        fbprops,
+        core.WindowProperties.size(size, size),
+        core.GraphicsPipe.BF_refuse_window,
+    )
+    engine.open_windows()
+
+    if buffer is None:
+        pytest.skip("GraphicsPipe cannot make offscreen buffers")
+
+    tex = core.Texture()
+    buffer.add_render_texture(tex, core.GraphicsOutput.RTM_copy_ram)
+    buffer.set_clear_color_active(True)
+    buffer.set_clear_color((0, 0, 0, 1))
+    return buffer, tex
+
+
+def test_parallel_cull_regions(graphics_pipe, parallel_cull):
+    engine = core.GraphicsEngine()
+    engine.set_threading_model("")
+    buffer, tex = make_buffer(engine, graphics_pipe)
+
+    try:
+        # One DisplayRegion per quadrant, each with its own scene, so that
+        # every region is culled separately.
+        scenes = []
+        for i, color in enumerate(COLORS):
+            left = (i % 2) * 0.5
+            bottom = (i // 2) * 0.5
+            dr = buffer.make_display_region(left, left + 0.5, bottom, bottom + 0.5)
+            scene, camera = make_scene(color)
+            dr.camera = camera
+            scenes.append(scene)
+
+        engine.render_frame()
+        engine.render_frame()
+
+        peeker = tex.peek()
+        assert peeker is not None
+
+        for i, color in enumerate(COLORS):
+            x = ((i % 2) * 0.5 + 0.25) * tex.get_x_size()
+            y = ((i // 2) * 0.5 + 0.25) * tex.get_y_size()
+            texel = core.LColor()
+            peeker.fetch_pixel(texel, int(x), int(y))
+            assert tuple(texel) == pytest.approx(color, abs=0.01)
+    finally:
+        engine.remove_window(buffer)
+
+
+def test_parallel_cull_shared_scene(graphics_pipe, parallel_cull):
+    engine = core.GraphicsEngine()
+    engine.set_threading_model("")
+    buffer, tex = make_buffer(engine, graphics_pipe, 64)
+
+    try:
+        # A single scene, with the same few states on many objects, seen by
+        # one camera per DisplayRegion.  The regions are culled at the same
+        # time, and they all look up the same states.
+        scene = core.NodePath("root")
+        scene.set_depth_test(False)
+
+        cm = core.CardMaker("card")
+        for i, color in enumerate(COLORS):
+            left = (i % 2) - 1
+            bottom = (i // 2) - 1
+            cm.set_frame(left, left + 1, bottom, bottom + 1)
+            for j in range(50):
+                card = scene.attach_new_node(cm.generate())
+                card.set_y(5)
+                card.set_color(color)
+
+        lens = core.OrthographicLens()
+        lens.set_film_size(2, 2)
+        for i in range(4):
+            left = (i % 2) * 0.5
+            bottom = (i // 2) * 0.5
+            dr = buffer.make_display_region(left, left + 0.5, bottom, bottom + 0.5)
+            dr.camera = scene.attach_new_node(core.Camera("camera%d" % i, lens))
+
+        for frame in range(3):
+            # Start each frame with empty munger caches, so that the regions
+            # fill them in at the same time.
+            core.RenderState.clear_munger_cache()
+            engine.render_frame()
+
+        peeker = tex.peek()
+        assert peeker is not None
+
+        # Every region shows the same four quadrants.
+        for region in range(4):
+            for i, color in enumerate(COLORS):
+                x = ((region % 2) * 0.5 + (i % 2) * 0.25 + 0.125) * tex.get_x_size()
+                y = ((region // 2) * 0.5 + (i // 2) * 0.25 + 0.125) * tex.get_y_size()
+                texel = core.LColor()
+                peeker.fetch_pixel(texel, int(x), int(y))
+                assert tuple(texel) == pytest.approx(color, abs=0.01)
+    finally:
+        engine.remove_window(buffer)
+
+
+def render_wide_scene(graphics_pipe, parallel):
+    engine = core.GraphicsEngine()
+    engine.set_threading_model("")
+    buffer, tex = make_buffer(engine, graphics_pipe, 64)
+
+    try:
+        scene = core.NodePath("root")
+        scene.set_depth_test(False)
+        scene.set_depth_write(False)
+        scene.set_bin("unsorted", 0)
+
+        camera = scene.attach_new_node(core.Camera("camera"))
+        lens = core.OrthographicLens()
+        lens.set_film_size(2, 2)
+        camera.node().set_lens(lens)
+        buffer.make_display_region().camera = camera
+
+        # Many overlapping cards under one parent.  Since they are drawn
+        # without depth test in the order in which they are culled, the
+        # image reveals the order in which they were recorded.
+        rng = random.Random(1)
+        wide = scene.attach_new_node("wide")
+        cm = core.CardMaker("card")
+        for i in range(1000):
+            x = rng.uniform(-1, 1)
+            z = rng.uniform(-1, 1)
+            cm.set_frame(x - 0.2, x + 0.2, z - 0.2, z + 0.2)
+            card = wide.attach_new_node(cm.generate())
+            card.set_y(5)
+            card.set_color(rng.random(), rng.random(), rng.random(), 1)
+            if i % 3 == 0:
+                # Put some of the cards one level further down.
+                card.wrt_reparent_to(wide.attach_new_node("group"))
+
+        variables = {
+            "parallel-cull-traverse": (core.ConfigVariableBool, parallel),
+            "parallel-cull-min-children": (core.ConfigVariableInt, 16),
+            "parallel-cull-chunk-size": (core.ConfigVariableInt, 7),
+        }
+        configs = []
+        for name, (cls, value) in variables.items():
+            var = cls(name)
+            var.set_value(value)
+            configs.append(var)
+
+        try:
+            engine.render_frame()
+            engine.render_frame()
+        finally:
+            for var in configs:
+                var.clear_local_value()
+
+        return tex.get_ram_image().get_data()
+    finally:
+        engine.remove_window(buffer)
+
+
+def test_parallel_cull_traverse_matches_serial(graphics_pipe):
+    serial = render_wide_scene(graphics_pipe, False)
+    parallel = render_wide_scene(graphics_pipe, True)
+    assert parallel == serial
+
+
+def test_parallel_cull_traverse_pgtop(graphics_pipe):
+    # A PGTop substitutes its own traverser, which carries the state that the
+    # PGItems need to register their regions.  A plain copy of that traverser
+    # would lose it, so the wide list of items must be traversed serially.
+    engine = core.GraphicsEngine()
+    engine.set_threading_model("")
+    buffer, tex = make_buffer(engine, graphics_pipe)
+
+    variables = {
+        "parallel-cull-traverse": (core.ConfigVariableBool, True),
+        "parallel-cull-min-children": (core.ConfigVariableInt, 16),
+        "parallel-cull-chunk-size": (core.ConfigVariableInt, 7),
+    }
+    configs = []
+    for name, (cls, value) in variables.items():
+        var = cls(name)
+        var.set_value(value)
+        configs.append(var)
+
+    try:
+        scene = core.NodePath("root")
+        camera = scene.attach_new_node(core.Camera("camera"))
+        lens = core.OrthographicLens()
+        lens.set_film_size(2, 2)
+        camera.node().set_lens(lens)
+        buffer.make_display_region().camera = camera
+
+        watcher = core.MouseWatcher("watcher")
+        top = scene.attach_new_node(core.PGTop("top"))
+        top.node().set_mouse_watcher(watcher)
+        top.set_y(5)
+        top.set_bin("unsorted", 0)
+
+        items = []
+        for i in range(100):
+            item = core.PGItem("item%d" % i)
+            x = (i % 10) * 0.2 - 1
+            z = (i // 10) * 0.2 - 1
+            item.set_frame(x, x + 0.2, z, z + 0.2)
+            top.attach_new_node(item)
+            items.append(item)
+
+        engine.render_frame()
+
+        regions = [item.get_region() for item in items]
+        assert watcher.get_num_groups() == 1
+        group = watcher.get_group(0)
+        for region in regions:
+            assert group.has_region(region)
+
+        # The regions are numbered in scene graph order.
+        sorts = [region.get_sort() for region in regions]
+        assert sorts == sorted(sorts)
+        assert len(set(sorts)) == len(sorts)
+    finally:
+        for var in configs:
+            var.clear_local_value()
+        engine.remove_window(buffer)
@@ -0,0 +1,153 @@
+from panda3d import core
+import random
+import time
+import pytest
+
+
+@pytest.fixture(scope="module")
+def tiny_pipe():
+    selection = core.GraphicsPipeSelection.get_global_ptr()
+    pipe = selection.make_pipe("TinyOffscreenGraphicsPipe", "p3tinydisplay")
+
+    if pipe is None or not pipe.is_valid():
+        pytest.skip("tinydisplay offscreen pipe is not available")
+
+    yield pipe
+
+
+def make_mesh(rng, count, name="mesh"):
+    # Triangles with a vertex color and a random normal each, some of them
+    # reaching past the edges of the screen, so that they get clipped.
+    vdata = core.GeomVertexData(name, core.GeomVertexFormat.get_v3n3c4(), core.Geom.UH_static)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    normal = core.GeomVertexWriter(vdata, "normal")
+    color = core.GeomVertexWriter(vdata, "color")
+    tris = core.GeomTriangles(core.Geom.UH_static)
+    for i in range(count):
+        cx = rng.uniform(-1.5, 1.5)
+        cz = rng.uniform(-1.5, 1.5)
+        cy = rng.uniform(0.5, 8)
+        for j in range(3):
+            vertex.add_data3(cx + rng.uniform(-0.4, 0.4), cy + rng.uniform(-0.5, 0.5), cz + rng.uniform(-0.4, 0.4))
+            normal.add_data3(core.LVector3(rng.uniform(-1, 1), rng.uniform(-1, -0.1), rng.uniform(-1, 1)).normalized())
+            color.add_data4(rng.random(), rng.random(), rng.random(), rng.uniform(0.5, 1))
+        tris.add_next_vertices(3)
+    geom = core.Geom(vdata)
+    geom.add_primitive(tris)
+    node = core.GeomNode(name)
+    node.add_geom(geom)
+    return core.NodePath(node)
+
+
+def make_scene(lit, count=500):
+    rng = random.Random(3)
+    scene = core.NodePath("root")
+    scene.attach_new_node(make_mesh(rng, count).node())
+
+    # Another copy, scaled unevenly, so that the normals need rescaling.
+    scaled = make_mesh(rng, count // 2, "scaled")
+    scaled.reparent_to(scene)
+    scaled.set_scale(1.5, 0.5, 0.8)
+
+    if lit:
+        material = core.Material()
+        material.set_specular((0.8, 0.8, 0.8, 1))
+        material.set_shininess(24)
+        scene.set_material(material)
+
+        alight = core.AmbientLight("ambient")
+        alight.set_color((0.1, 0.1, 0.2, 1))
+        scene.set_light(scene.attach_new_node(alight))
+
+        dlight = core.DirectionalLight("directional")
+        dlight.set_color((0.6, 0.5, 0.4, 1))
+        dlight_np = scene.attach_new_node(dlight)
+        dlight_np.set_hpr(30, -40, 0)
+        scene.set_light(dlight_np)
+
+        plight = core.PointLight("point")
+        plight.set_color((0.3, 0.6, 0.3, 1))
+        plight.set_attenuation((1, 0.1, 0.02))
+        plight_np = scene.attach_new_node(plight)
+        plight_np.set_pos(-1, 2, 1)
+        scene.set_light(plight_np)
+
+        slight = core.Spotlight("spot")
+        slight.set_color((0.5, 0.3, 0.9, 1))
+        slight.set_exponent(8)
+        slight.get_lens().set_fov(50)
+        slight_np = scene.attach_new_node(slight)
+        slight_np.set_pos(1, -2, 2)
+        slight_np.look_at(0, 4, 0)
+        scene.set_light(slight_np)
+
+    return scene
+
+
+def render_scene(pipe, simd, lit, size=(160, 120), frames=2, count=500):
+    engine = core.GraphicsEngine()
+    engine.set_threading_model("")
+
+    fbprops = core.FrameBufferProperties()
+    fbprops.set_rgba_bits(8, 8, 8, 8)
+    fbprops.set_depth_bits(16)
+
+    buffer = engine.make_output(
+        pipe,
+        'buffer',
+        0,
+        fbprops,
+        core.WindowProperties.size(*size),
+        core.GraphicsPipe.BF_refuse_window,
+    )
+    engine.open_windows()
+
+    if buffer is None:
+        pytest.skip("tinydisplay cannot make offscreen buffers")
+
+    var = core.ConfigVariableBool("td-simd-vertices")
+    var.set_value(simd)
+    try:
+        tex = core.Texture()
+        buffer.add_render_texture(tex, core.GraphicsOutput.RTM_copy_ram)
+        buffer.set_clear_color_active(True)
+        buffer.set_clear_color((0.1, 0.2, 0.3, 1))
+
+        scene = make_scene(lit, count)
+        camera = scene.attach_new_node(core.Camera("camera"))
+        buffer.make_display_region().camera = camera
+
+        engine.render_frame()
+        start = time.perf_counter()
+        for i in range(frames - 1):
+            engine.render_frame()
+        elapsed = time.perf_counter() - start
+        return tex.get_ram_image().get_data(), elapsed
+    finally:
+        var.clear_local_value()
+        engine.remove_window(buffer)
+
+
+@pytest.mark.parametrize("lit", [False, True])
+def test_simd_vertices_match_scalar(tiny_pipe, lit):
+    scalar = render_scene(tiny_pipe, False, lit)[0]
+    simd = render_scene(tiny_pipe, True, lit)[0]
+    assert len(scalar) > 0
+    assert simd == scalar
+
+
+@pytest.mark.benchmark_test
+def test_simd_vertices_benchmark(tiny_pipe):
+    # Prints the vertex throughput of both paths; run with -s.  A tiny window
+    # keeps the time spent rasterizing out of the measurement.
+    frames = 20
+    count = 4000
+    num_vertices = (count + count // 2) * 3
+    timings = {}
+    for simd in (False, True):
+        timings[simd] = render_scene(tiny_pipe, simd, True, size=(8, 8), frames=frames + 1, count=count)[1]
+
+    print("\ntinydisplay, %d lit vertices per frame:" % (num_vertices))
+    for simd, label in ((False, "scalar"), (True, "simd")):
+        rate = num_vertices * frames / timings[simd]
+        print("  %-7s %.3f ms/frame, %.2f M vertices/s" % (label + ":", timings[simd] * 1000.0 / frames, rate / 1e6))
@@ -0,0 +1,136 @@
+from panda3d import core
+import random
+import pytest
+
+
+@pytest.fixture(scope="module")
+def tiny_pipe():
+    selection = core.GraphicsPipeSelection.get_global_ptr()
+    pipe = selection.make_pipe("TinyOffscreenGraphicsPipe", "p3tinydisplay")
+
+    if pipe is None or not pipe.is_valid():
+        pytest.skip("tinydisplay offscreen pipe is not available")
+
+    yield pipe
+
+
+def make_texture():
+    image = core.PNMImage(16, 16, 4)
+    for y in range(16):
+        for x in range(16):
+            image.set_xel_a(x, y, x / 15.0, y / 15.0, ((x ^ y) & 1) * 1.0, 0.5 + (x % 4) / 8.0)
+
+    tex = core.Texture("checker")
+    tex.load(image)
+    return tex
+
+
+def make_scene():
+    scene = core.NodePath("root")
+
+    rng = random.Random(2)
+    tex = make_texture()
+    maker = core.CardMaker("card")
+
+    # A mix of opaque, textured and alpha-blended triangles crossing one
+    # another at random depths, so that any change in the drawing order
+    # or in the interpolation shows up in the image.
+    for i in range(300):
+        x = rng.uniform(-1.2, 1.2)
+        z = rng.uniform(-1.2, 1.2)
+        size = rng.uniform(0.05, 0.6)
+        maker.set_frame(x - size, x + size, z - size, z + size)
+        card = scene.attach_new_node(maker.generate())
+        card.set_y(rng.uniform(3, 6))
+        card.set_hpr(rng.uniform(-60, 60), rng.uniform(-60, 60), rng.uniform(0, 360))
+        card.set_color(rng.random(), rng.random(), rng.random(), rng.uniform(0.3, 1))
+        if i % 3 == 0:
+            card.set_texture(tex)
+        if i % 4 == 0:
+            card.set_transparency(core.TransparencyAttrib.M_alpha)
+
+    # One Geom with lots of small triangles, to exceed td-tile-min-triangles.
+    cloud = core.NodePath(core.GeomNode("cloud"))
+    vdata = core.GeomVertexData("cloud", core.GeomVertexFormat.get_v3c4(), core.Geom.UH_static)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    color = core.GeomVertexWriter(vdata, "color")
+    tris = core.GeomTriangles(core.Geom.UH_static)
+    for i in range(2000):
+        cx = rng.uniform(-1, 1)
+        cz = rng.uniform(-1, 1)
+        cy = rng.uniform(2, 7)
+        for j in range(3):
+            vertex.add_data3(cx + rng.uniform(-0.15, 0.15), cy, cz + rng.uniform(-0.15, 0.15))
+            color.add_data4(rng.random(), rng.random(), rng.random(), 1)
+        tris.add_next_vertices(3)
+    geom = core.Geom(vdata)
+    geom.add_primitive(tris)
+    cloud.node().add_geom(geom)
+    cloud.reparent_to(scene)
+
+    return scene
+
+
+def render_scene(pipe, tiled, rows=7, size=(160, 120)):
+    engine = core.GraphicsEngine()
+    engine.set_threading_model("")
+
+    fbprops = core.FrameBufferProperties()
+    fbprops.set_rgba_bits(8, 8, 8, 8)
+    fbprops.set_depth_bits(16)
+
+    buffer = engine.make_output(
+        pipe,
+        'buffer',
+        0,
+        fbprops,
+        core.WindowProperties.size(*size),
+        core.GraphicsPipe.BF_refuse_window,
+    )
+    engine.open_windows()
+
+    if buffer is None:
+        pytest.skip("tinydisplay cannot make offscreen buffers")
+
+    variables = {
+        "td-tile-rasterizer": (core.ConfigVariableBool, tiled),
+        "td-tile-rows": (core.ConfigVariableInt, rows),
+        "td-tile-min-triangles": (core.ConfigVariableInt, 1),
+    }
+    configs = []
+    for name, (cls, value) in variables.items():
+        var = cls(name)
+        var.set_value(value)
+        configs.append(var)
+
+    try:
+        tex = core.Texture()
+        buffer.add_render_texture(tex, core.GraphicsOutput.RTM_copy_ram)
+        buffer.set_clear_color_active(True)
+        buffer.set_clear_color((0.1, 0.2, 0.3, 1))
+
+        scene = make_scene()
+        camera = scene.attach_new_node(core.Camera("camera"))
+        buffer.make_display_region().camera = camera
+
+        engine.render_frame()
+        engine.render_frame()
+        return tex.get_ram_image().get_data()
+    finally:
+        for var in configs:
+            var.clear_local_value()
+        engine.remove_window(buffer)
+
+
+def test_tile_rasterizer_matches_serial(tiny_pipe):
+    serial = render_scene(tiny_pipe, False)
+    tiled = render_scene(tiny_pipe, True)
+    assert len(serial) > 0
+    assert tiled == serial
+
+
+@pytest.mark.parametrize("rows", [1, 16, 1000])
+def test_tile_rasterizer_band_sizes(tiny_pipe, rows):
+    serial = render_scene(tiny_pipe, False)
+    tiled = render_scene(tiny_pipe, True, rows=rows)
+    assert tiled == serial
@@ -0,0 +1,260 @@
+import socket
+import struct
+import sys
+import time
+import pytest
+
+pytest.importorskip("panda3d.direct")
+
+from panda3d.core import Datagram, StringStream, URLSpec
+from panda3d.direct import CConnectionRepository, DCFile
+
+
+DC_SOURCE = """
+dclass DistributedTestObject {
+  setValue(uint32 value) broadcast ram;
+  setOwnerValue(uint32 value) broadcast ownrecv;
+};
+"""
+
+# A message type that the repository hands back to the caller, sent after
+# the updates so that we know when they have all been dispatched.
+MSG_DONE = 9999
+
+
+class DummyObject:
+    neverDisable = 0
+
+
+class UpdateRecorder:
+    """ A distributed object that remembers the updates it receives. """
+
+    def __init__(self, dclass, neverDisable=0):
+        self.dclass = dclass
+        self.neverDisable = neverDisable
+        self.updates = []
+
+    def setValue(self, value):
+        self.updates.append(("setValue", value))
+
+    def setOwnerValue(self, value):
+        self.updates.append(("setOwnerValue", value))
+
+
+class PythonRepository:
+    """ Stands in for the ClientRepository, with its doId2do tables. """
+
+    def __init__(self):
+        self.doId2do = {}
+        self.doId2ownerView = {}
+        self.msgSender = 0
+
+
+@pytest.fixture
+def dclass():
+    dc = DCFile()
+    dc.read(StringStream(DC_SOURCE.encode("ascii")), "test.dc")
+    return dc.get_class_by_name("DistributedTestObject")
+
+
+def test_register_do(dclass):
+    repo = CConnectionRepository()
+    obj = DummyObject()
+    refs = sys.getrefcount(obj)
+
+    repo.register_do(1000, obj, dclass)
+    assert repo.get_num_registered_dos() == 1
+    assert repo.get_num_registered_dos(True) == 0
+    assert sys.getrefcount(obj) == refs + 1
+
+    # Registering again replaces the entry.
+    repo.register_do(1000, obj, dclass, CConnectionRepository.OF_never_disable)
+    assert repo.get_num_registered_dos() == 1
+    assert sys.getrefcount(obj) == refs + 1
+
+    repo.register_do(1000, obj, dclass, 0, True)
+    assert repo.get_num_registered_dos(True) == 1
+    assert sys.getrefcount(obj) == refs + 2
+
+    repo.unregister_do(1000)
+    assert repo.get_num_registered_dos() == 0
+    assert sys.getrefcount(obj) == refs + 1
+
+    # Unknown doIds are ignored.
+    repo.unregister_do(1001)
+
+    repo.clear_registered_dos()
+    assert repo.get_num_registered_dos(True) == 0
+    assert sys.getrefcount(obj) == refs
+
+
+def test_batch_updates():
+    repo = CConnectionRepository()
+    repo.set_batch_updates(True)
+    assert repo.get_batch_updates()
+    repo.set_batch_updates(False)
+    assert not repo.get_batch_updates()
+
+
+class Connection:
+    """ A repository connected to a socket on this machine, which stands in
+    for the server. """
+
+    def __init__(self, listener, has_owner_view=False):
+        self.repo = CConnectionRepository(has_owner_view)
+        if not hasattr(self.repo, "try_connect_net"):
+            pytest.skip("requires Panda3D to be built with networking")
+
+        self.repo.set_handle_datagrams_internally(True)
+        self.py_repo = PythonRepository()
+        self.repo.set_python_repository(self.py_repo)
+
+        port = listener.getsockname()[1]
+        assert self.repo.try_connect_net(URLSpec("http://127.0.0.1:%d" % port))
+        self.sock = listener.accept()[0]
+
+    def close(self):
+        self.repo.disconnect()
+        self.sock.close()
+
+    def send(self, dg):
+        data = dg.get_message()
+        self.sock.sendall(struct.pack("<H", len(data)) + data)
+
+    def deliver(self, *updates):
+        # Sends the updates, and lets the repository dispatch them.
+        for dg in updates:
+            assert dg.get_length() > 0
+            self.send(dg)
+
+        done = Datagram()
+        done.add_uint16(MSG_DONE)
+        self.send(done)
+
+        end = time.time() + 10
+        while not self.repo.check_datagram():
+            assert time.time() < end
+            time.sleep(0.001)
+        assert self.repo.get_msg_type() == MSG_DONE
+
+
+@pytest.fixture
+def connect():
+    listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    listener.bind(("127.0.0.1", 0))
+    listener.listen(1)
+    connections = []
+
+    def connect(has_owner_view=False):
+        connection = Connection(listener, has_owner_view)
+        connections.append(connection)
+        return connection
+
+    yield connect
+    for connection in connections:
+        connection.close()
+    listener.close()
+
+
+def test_update_registered(dclass, connect):
+    conn = connect()
+    obj = UpdateRecorder(dclass)
+    conn.repo.register_do(1000, obj, dclass)
+
+    # The registered object is found even though doId2do doesn't have it.
+    conn.deliver(dclass.client_format_update("setValue", 1000, [5]),
+                 dclass.client_format_update("setValue", 1000, [6]))
+    assert obj.updates == [("setValue", 5), ("setValue", 6)]
+
+    # Once it is unregistered, the updates don't reach it any more.
+    conn.repo.unregister_do(1000)
+    conn.deliver(dclass.client_format_update("setValue", 1000, [7]))
+    assert obj.updates == [("setValue", 5), ("setValue", 6)]
+
+
+def test_update_unregistered(dclass, connect):
+    conn = connect()
+    obj = UpdateRecorder(dclass)
+    conn.py_repo.doId2do[1000] = obj
+
+    conn.deliver(dclass.client_format_update("setValue", 1000, [5]))
+    assert obj.updates == [("setValue", 5)]
+
+    # The registered object takes precedence over doId2do.
+    other = UpdateRecorder(dclass)
+    conn.repo.register_do(1000, other, dclass)
+    conn.deliver(dclass.client_format_update("setValue", 1000, [6]))
+    assert obj.updates == [("setValue", 5)]
+    assert other.updates == [("setValue", 6)]
+
+    # An object that is in neither is ignored.
+    conn.deliver(dclass.client_format_update("setValue", 1001, [7]))
+
+
+def test_update_quiet_zone(dclass, connect):
+    conn = connect()
+    conn.repo.set_in_quiet_zone(True)
+
+    registered = UpdateRecorder(dclass)
+    conn.repo.register_do(1000, registered, dclass)
+    registered_never = UpdateRecorder(dclass, 1)
+    conn.repo.register_do(1001, registered_never, dclass,
+                          CConnectionRepository.OF_never_disable)
+    unregistered = UpdateRecorder(dclass)
+    conn.py_repo.doId2do[1002] = unregistered
+    unregistered_never = UpdateRecorder(dclass, 1)
+    conn.py_repo.doId2do[1003] = unregistered_never
+
+    updates = [dclass.client_format_update("setValue", do_id, [do_id])
+               for do_id in range(1000, 1004)]
+    conn.deliver(*updates)
+    assert registered.updates == []
+    assert registered_never.updates == [("setValue", 1001)]
+    assert unregistered.updates == []
+    assert unregistered_never.updates == [("setValue", 1003)]
+
+    # For a registered object, the flag it was registered with counts, not
+    # its neverDisable attribute.
+    registered.neverDisable = 1
+    conn.deliver(dclass.client_format_update("setValue", 1000, [1]))
+    assert registered.updates == []
+
+    conn.repo.set_in_quiet_zone(False)
+    conn.deliver(*updates)
+    assert registered.updates == [("setValue", 1000)]
+    assert unregistered.updates == [("setValue", 1002)]
+
+
+def test_update_owner_view(dclass, connect):
+    conn = connect(has_owner_view=True)
+
+    # One object with both views registered, and one with both only in the
+    # Python tables.
+    visible = UpdateRecorder(dclass)
+    owner = UpdateRecorder(dclass)
+    conn.repo.register_do(1000, visible, dclass)
+    conn.repo.register_do(1000, owner, dclass, 0, True)
+
+    py_visible = UpdateRecorder(dclass)
+    py_owner = UpdateRecorder(dclass)
+    conn.py_repo.doId2do[1001] = py_visible
+    conn.py_repo.doId2ownerView[1001] = py_owner
+
+    conn.deliver(dclass.client_format_update("setValue", 1000, [1]),
+                 dclass.client_format_update("setOwnerValue", 1000, [2]),
+                 dclass.client_format_update("setValue", 1001, [3]),
+                 dclass.client_format_update("setOwnerValue", 1001, [4]))
+
+    # Only the ownrecv field goes to the owner view; both go to the visible
+    # view.
+    assert visible.updates == [("setValue", 1), ("setOwnerValue", 2)]
+    assert owner.updates == [("setOwnerValue", 2)]
+    assert py_visible.updates == [("setValue", 3), ("setOwnerValue", 4)]
+    assert py_owner.updates == [("setOwnerValue", 4)]
+
+    # An owner view without a visible view still gets its ownrecv fields.
+    conn.repo.unregister_do(1000)
+    conn.deliver(dclass.client_format_update("setValue", 1000, [5]),
+                 dclass.client_format_update("setOwnerValue", 1000, [6]))
+    assert visible.updates == [("setValue", 1), ("setOwnerValue", 2)]
+    assert owner.updates == [("setOwnerValue", 2), ("setOwnerValue", 6)]
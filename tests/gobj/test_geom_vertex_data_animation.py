@@ -0,0 +1,156 @@
+from panda3d import core
+import random
+import time
+import pytest
+
+
+def make_skinned_data(num_rows, transforms, seed=1):
+    """
+    Creates a soft-skinned vertex data with a position, normal and texcoord
+    per vertex, where each vertex is blended between two of the given
+    transforms.
+    """
+    array = core.GeomVertexArrayFormat()
+    array.add_column("vertex", 3, core.Geom.NT_float32, core.Geom.C_point)
+    array.add_column("normal", 3, core.Geom.NT_float32, core.Geom.C_normal)
+    array.add_column("texcoord", 2, core.Geom.NT_float32, core.Geom.C_texcoord)
+
+    blend_array = core.GeomVertexArrayFormat()
+    blend_array.add_column(core.InternalName.get_transform_blend(), 1,
+                           core.Geom.NT_uint16, core.Geom.C_index)
+
+    format = core.GeomVertexFormat()
+    format.add_array(array)
+    format.add_array(blend_array)
+    spec = core.GeomVertexAnimationSpec()
+    spec.set_panda()
+    format.set_animation(spec)
+    format = core.GeomVertexFormat.register_format(format)
+
+    rng = random.Random(seed)
+    table = core.TransformBlendTable()
+    blends = []
+    for i in range(len(transforms)):
+        j = (i + 1) % len(transforms)
+        weight = rng.uniform(0.2, 0.8)
+        blends.append(table.add_blend(core.TransformBlend(transforms[i], weight, transforms[j], 1.0 - weight)))
+
+    vdata = core.GeomVertexData("skinned", format, core.Geom.UH_dynamic)
+    vdata.set_num_rows(num_rows)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    normal = core.GeomVertexWriter(vdata, "normal")
+    texcoord = core.GeomVertexWriter(vdata, "texcoord")
+    blend = core.GeomVertexWriter(vdata, core.InternalName.get_transform_blend())
+    for i in range(num_rows):
+        vertex.set_data3(rng.uniform(-1, 1), rng.uniform(-1, 1), rng.uniform(-1, 1))
+        normal.set_data3(core.LVector3(rng.uniform(-1, 1), rng.uniform(-1, 1), 1).normalized())
+        texcoord.set_data2(rng.random(), rng.random())
+        # Vertices come in runs that share a blend, as they do in real models.
+        blend.set_data1i(blends[(i // 7) % len(blends)])
+
+    table.set_rows(core.SparseArray.lower_on(num_rows))
+    vdata.set_transform_blend_table(table)
+    return vdata
+
+
+def make_transforms(count):
+    return [core.UserVertexTransform("joint%d" % (i)) for i in range(count)]
+
+
+def pose_transforms(transforms, t):
+    for i, transform in enumerate(transforms):
+        mat = core.LMatrix4.scale_mat(1.0 + 0.1 * i) * \
+              core.LMatrix4.rotate_mat(t * 30 + i * 10, core.LVector3(0, 0, 1)) * \
+              core.LMatrix4.translate_mat(i, t, -i)
+        transform.set_matrix(mat)
+
+
+def read_column(vdata, name, num_values):
+    reader = core.GeomVertexReader(vdata, name)
+    result = []
+    while not reader.is_at_end():
+        if num_values == 2:
+            result.append(tuple(reader.get_data2()))
+        else:
+            result.append(tuple(reader.get_data3()))
+    return result
+
+
+def animate(vdata, fast):
+    var = core.ConfigVariableBool("vertex-animation-fast-path")
+    var.set_value(fast)
+    try:
+        return vdata.animate_vertices(True, core.Thread.get_current_thread())
+    finally:
+        var.clear_local_value()
+
+
+def assert_columns_close(a, b):
+    assert len(a) == len(b)
+    for va, vb in zip(a, b):
+        assert va == pytest.approx(vb, abs=1e-4)
+
+
+@pytest.mark.parametrize("rows_per_job", [16, 2048])
+def test_animate_vertices_fast_matches_general(rows_per_job):
+    jobs_var = core.ConfigVariableInt("vertex-animation-rows-per-job")
+    jobs_var.set_value(rows_per_job)
+
+    try:
+        transforms = make_transforms(6)
+        fast_data = make_skinned_data(1000, transforms)
+        general_data = make_skinned_data(1000, transforms)
+
+        for frame in range(3):
+            pose_transforms(transforms, frame * 0.5)
+            fast = animate(fast_data, True)
+            general = animate(general_data, False)
+
+            assert_columns_close(read_column(fast, "vertex", 3), read_column(general, "vertex", 3))
+            assert_columns_close(read_column(fast, "normal", 3), read_column(general, "normal", 3))
+            assert read_column(fast, "texcoord", 2) == read_column(general, "texcoord", 2)
+    finally:
+        jobs_var.clear_local_value()
+
+
+def test_animate_vertices_fast_source_modified():
+    # Changing the unanimated columns of the source must show up in the
+    # animated vertices, even though they are not recopied every frame.
+    transforms = make_transforms(2)
+    vdata = make_skinned_data(50, transforms)
+
+    pose_transforms(transforms, 0)
+    animate(vdata, True)
+
+    writer = core.GeomVertexWriter(vdata, "texcoord")
+    writer.set_row(10)
+    writer.set_data2(0.25, 0.75)
+
+    pose_transforms(transforms, 1)
+    result = animate(vdata, True)
+
+    reader = core.GeomVertexReader(result, "texcoord")
+    reader.set_row(10)
+    assert tuple(reader.get_data2()) == pytest.approx((0.25, 0.75))
+
+
+@pytest.mark.benchmark_test
+def test_animate_vertices_benchmark():
+    # Prints the time taken by the general and fast paths; run with -s.
+    transforms = make_transforms(32)
+    meshes = 20
+    frames = 20
+
+    timings = {}
+    for fast in (False, True):
+        datas = [make_skinned_data(5000, transforms, seed=i) for i in range(meshes)]
+        start = time.perf_counter()
+        for frame in range(frames):
+            pose_transforms(transforms, frame * 0.1)
+            for vdata in datas:
+                animate(vdata, fast)
+        timings[fast] = time.perf_counter() - start
+
+    print("\nanimate_vertices, %d meshes x 5000 vertices x %d frames:" % (meshes, frames))
+    print("  general path: %.3f ms/frame" % (timings[False] * 1000.0 / frames))
+    print("  fast path:    %.3f ms/frame" % (timings[True] * 1000.0 / frames))
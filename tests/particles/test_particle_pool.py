@@ -0,0 +1,147 @@
+import pytest
+pytest.importorskip("panda3d.physics")
+
+from panda3d.core import ConfigVariableBool, GeomVertexReader, NodePath, Point3
+from panda3d.physics import (
+    ForceNode,
+    LinearDistanceForce,
+    LinearEulerIntegrator,
+    LinearFrictionForce,
+    LinearSinkForce,
+    LinearVectorForce,
+    ParticleSystem,
+    PhysicalNode,
+    PhysicsManager,
+    PointParticleFactory,
+    PointParticleRenderer,
+    SphereVolumeEmitter,
+)
+
+
+def make_system(pooled, pool_size):
+    var = ConfigVariableBool("particle-system-pool")
+    var.set_value(pooled)
+    try:
+        root = NodePath("root")
+
+        system = ParticleSystem(pool_size)
+        system.set_birth_rate(0.02)
+        system.set_litter_size(pool_size // 20)
+        system.set_render_parent(root)
+
+        factory = PointParticleFactory()
+        factory.set_lifespan_base(0.5)
+        factory.set_lifespan_spread(0.2)
+        factory.set_mass_base(2.0)
+        factory.set_mass_spread(0.5)
+        system.set_factory(factory)
+
+        emitter = SphereVolumeEmitter()
+        emitter.set_radius(2.0)
+        emitter.set_amplitude(3.0)
+        system.set_emitter(emitter)
+
+        system.set_renderer(PointParticleRenderer())
+
+        physical_node = PhysicalNode("physical")
+        physical_node.add_physical(system)
+        root.attach_new_node(physical_node)
+
+        force_node = ForceNode("forces")
+        root.attach_new_node(force_node)
+        forces = [
+            LinearVectorForce(0, 0, -9.8),
+            LinearFrictionForce(0.3),
+            LinearSinkForce(Point3(0, 0, 5), LinearDistanceForce.FT_ONE_OVER_R, 10.0, 2.0, True),
+        ]
+        for force in forces:
+            force_node.add_force(force)
+            system.add_linear_force(force)
+
+        manager = PhysicsManager()
+        manager.attach_linear_integrator(LinearEulerIntegrator())
+        manager.attach_physical(system)
+    finally:
+        var.clear_local_value()
+
+    return root, system, manager
+
+
+def step(system, manager, frames, dt=1.0 / 60):
+    for i in range(frames):
+        system.update(dt)
+        manager.do_physics(dt)
+
+
+def get_vertices(system):
+    system.render()
+    geom = system.get_renderer().get_render_node().get_geom(0)
+    reader = GeomVertexReader(geom.get_vertex_data(), "vertex")
+    return sorted(tuple(reader.get_data3()) for i in range(system.get_living_particles()))
+
+
+def test_particle_pool_used():
+    root, system, manager = make_system(True, 100)
+    assert system.is_pooled()
+    assert system.get_objects().get_num_physics_objects() == 0
+
+    root, system, manager = make_system(False, 100)
+    assert not system.is_pooled()
+    assert system.get_objects().get_num_physics_objects() == 100
+
+
+def test_particle_pool_matches_objects():
+    results = []
+    for pooled in (True, False):
+        root, system, manager = make_system(pooled, 400)
+        assert system.is_pooled() == pooled
+
+        manager.init_random_seed()
+        step(system, manager, 60)
+        assert system.get_living_particles() > 0
+        results.append((system.get_living_particles(), get_vertices(system)))
+
+    assert results[0][0] == results[1][0]
+    for a, b in zip(results[0][1], results[1][1]):
+        assert a == pytest.approx(b, abs=1e-4)
+
+
+def test_particle_pool_switch():
+    root, system, manager = make_system(True, 100)
+    step(system, manager, 20)
+    living = system.get_living_particles()
+    assert living > 0
+
+    # Physical orientation needs a BaseParticle per particle.
+    system.set_physical_orientation_flag(True)
+    assert not system.is_pooled()
+    assert system.get_living_particles() == living
+    assert system.get_objects().get_num_physics_objects() == 100
+    assert sum(obj.get_active() for obj in system.get_objects().get_physics_objects()) == living
+
+    system.set_physical_orientation_flag(False)
+    assert system.is_pooled()
+    assert system.get_living_particles() == living
+
+    step(system, manager, 20)
+    system.clear_to_initial()
+    assert system.get_living_particles() == 0
+
+
+def test_particle_pool_integrator_attached_later():
+    # The integrator is checked again when it is attached, and the pooled
+    # particles are moved by it.
+    root, system, manager = make_system(True, 100)
+    manager.remove_physical(system)
+    manager = PhysicsManager()
+    manager.attach_physical(system)
+    assert system.is_pooled()
+
+    manager.attach_linear_integrator(LinearEulerIntegrator())
+    assert system.is_pooled()
+
+    step(system, manager, 10)
+    before = get_vertices(system)
+    assert len(before) > 0
+    manager.do_physics(1.0 / 60)
+    assert get_vertices(system) != before
@@ -0,0 +1,334 @@
+"""
+Smoke tests for the sharded state tables and the per-thread composition
+caches.  The threads here are real OS threads, so each one gets its own
+composition cache, but the GIL lets only one of them call into Panda at a
+time.  These tests therefore check that the results are consistent when
+the threads are interleaved; they do not exercise truly concurrent access
+to the state tables.
+
+The tests further down render with parallel-cull-traverse, so that the
+states are composed in C++ from several JobSystem jobs at once, while
+another thread keeps clearing the caches.
+"""
+
+from panda3d import core
+import random
+import sys
+import threading
+import time
+import pytest
+
+
+NUM_THREADS = 4
+NUM_ITERATIONS = 2000
+
+
+def run_threads(func):
+    errors = []
+
+    def wrapper(index):
+        try:
+            func(index)
+        except Exception as ex:
+            errors.append(ex)
+
+    # Switch between the threads as often as possible, so that their calls
+    # are interleaved as finely as the GIL allows.
+    interval = sys.getswitchinterval()
+    sys.setswitchinterval(1e-6)
+    try:
+        threads = [threading.Thread(target=wrapper, args=(i, )) for i in range(NUM_THREADS)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+    finally:
+        sys.setswitchinterval(interval)
+
+    assert not errors
+
+
+def test_transform_state_unique_threads():
+    results = [None] * NUM_THREADS
+
+    def make_states(index):
+        states = []
+        for i in range(NUM_ITERATIONS):
+            states.append(core.TransformState.make_pos((i % 100, 0, 0)))
+        results[index] = states
+
+    run_threads(make_states)
+
+    # Every thread must have gotten the very same state pointers back.
+    for states in results[1:]:
+        for a, b in zip(results[0], states):
+            assert a.this == b.this
+
+
+def test_render_state_unique_threads():
+    results = [None] * NUM_THREADS
+
+    def make_states(index):
+        states = []
+        for i in range(NUM_ITERATIONS):
+            color = ((i % 50) / 50.0, 0, 0, 1)
+            states.append(core.RenderState.make(core.ColorAttrib.make_flat(color)))
+        results[index] = states
+
+    run_threads(make_states)
+
+    for states in results[1:]:
+        for a, b in zip(results[0], states):
+            assert a.this == b.this
+
+
+def test_transform_state_compose_threads():
+    a = core.TransformState.make_pos((1, 2, 3))
+    bs = [core.TransformState.make_hpr((i, 0, 0)) for i in range(20)]
+    expected = [a.compose(b) for b in bs]
+
+    def compose(index):
+        for i in range(NUM_ITERATIONS):
+            j = i % len(bs)
+            assert a.compose(bs[j]) == expected[j]
+            assert a.invert_compose(expected[j]).get_mat().almost_equal(bs[j].get_mat())
+
+    run_threads(compose)
+
+
+def test_state_garbage_collect_shards():
+    var = core.ConfigVariableInt("garbage-collect-states-shards")
+    var.set_value(1)
+    try:
+        states = [core.TransformState.make_pos((i, 1234.5, 0)) for i in range(100)]
+        num_states = core.TransformState.get_num_states()
+        assert num_states >= len(states)
+
+        del states
+
+        # Visiting one shard at a time, all of them must eventually be swept.
+        for i in range(32):
+            core.TransformState.garbage_collect()
+            core.RenderState.garbage_collect()
+
+        assert core.TransformState.get_num_states() <= num_states - 100
+    finally:
+        var.clear_local_value()
+
+
+def test_state_garbage_collect_budget():
+    variables = {
+        "garbage-collect-states-budget": (core.ConfigVariableDouble, 0.0001),
+        "garbage-collect-states-old-age": (core.ConfigVariableInt, 0),
+    }
+    configs = []
+    for name, (cls, value) in variables.items():
+        var = cls(name)
+        var.set_value(value)
+        configs.append(var)
+
+    try:
+        states = [core.TransformState.make_pos((i, 4321.5, 0)) for i in range(5000)]
+        num_states = core.TransformState.get_num_states()
+        del states
+
+        # A single step can't get through all of them in the time allowed,
+        # but repeated steps must eventually release all of them.
+        core.TransformState.garbage_collect()
+        for i in range(10000):
+            if core.TransformState.get_num_states() <= num_states - 5000:
+                break
+            core.TransformState.garbage_collect()
+
+        assert core.TransformState.get_num_states() <= num_states - 5000
+    finally:
+        for var in configs:
+            var.clear_local_value()
+
+
+
+@pytest.mark.parametrize("thread_cache", [False, True])
+def test_state_compose_threads_cache(thread_cache):
+    # Composing with and without the per-thread cache gives the same states.
+    var = core.ConfigVariableBool("thread-composition-cache")
+    var.set_value(thread_cache)
+    try:
+        a = core.TransformState.make_pos((1, 2, 3))
+        bs = [core.TransformState.make_hpr((i, 0, 0)) for i in range(8)]
+        expected = [a.compose(b) for b in bs]
+
+        def compose(index):
+            for i in range(NUM_ITERATIONS):
+                j = (i + index) % len(bs)
+                assert a.compose(bs[j]).this == expected[j].this
+
+        run_threads(compose)
+    finally:
+        var.clear_local_value()
+
+
+def test_state_clear_cache_releases_thread_cache():
+    # The per-thread cache must not keep the states alive after the caches
+    # have been cleared.
+    num_states = core.TransformState.get_num_states()
+
+    a = core.TransformState.make_pos((1, 5678.5, 0))
+    b = core.TransformState.make_hpr((5678.5, 0, 0))
+    c = a.compose(b)
+    assert a.compose(b) == c
+    del a, b, c
+
+    core.TransformState.clear_cache()
+    assert core.TransformState.get_num_states() <= num_states
+
+
+def make_buffer(engine, graphics_pipe, size=64):
+    fbprops = core.FrameBufferProperties()
+    fbprops.force_hardware = True
+    fbprops.set_rgba_bits(8, 8, 8, 8)
+
+    buffer = engine.make_output(
+        graphics_pipe,
+        'buffer',
+        0,
+        fbprops,
+        core.WindowProperties.size(size, size),
+        core.GraphicsPipe.BF_refuse_window,
+    )
+    engine.open_windows()
+
+    if buffer is None:
+        pytest.skip("GraphicsPipe cannot make offscreen buffers")
+
+    tex = core.Texture()
+    buffer.add_render_texture(tex, core.GraphicsOutput.RTM_copy_ram)
+    buffer.set_clear_color_active(True)
+    buffer.set_clear_color((0, 0, 0, 1))
+    return buffer, tex
+
+
+def make_wide_scene(num_cards):
+    scene = core.NodePath("root")
+    scene.set_depth_test(False)
+    scene.set_depth_write(False)
+    scene.set_bin("unsorted", 0)
+
+    camera = scene.attach_new_node(core.Camera("camera"))
+    lens = core.OrthographicLens()
+    lens.set_film_size(2, 2)
+    camera.node().set_lens(lens)
+
+    # Many cards under one parent, each under a group of its own, with the
+    # transforms and colors drawn from small pools so that the same
+    # compositions keep coming up in every worker.
+    rng = random.Random(1)
+    wide = scene.attach_new_node("wide")
+    wide.set_y(5)
+    cm = core.CardMaker("card")
+    cm.set_frame(-0.2, 0.2, -0.2, 0.2)
+    card_geom = cm.generate()
+    colors = [(rng.random(), rng.random(), rng.random(), 1) for i in range(8)]
+    for i in range(num_cards):
+        group = wide.attach_new_node("group")
+        group.set_pos(rng.choice((-0.5, 0, 0.5)), 0, rng.choice((-0.5, 0, 0.5)))
+        card = group.attach_new_node("card")
+        card_geom.instance_to(card)
+        card.set_pos(rng.choice((-0.3, 0, 0.3)), 0, rng.choice((-0.3, 0, 0.3)))
+        card.set_color(rng.choice(colors))
+    return scene, camera
+
+
+def set_variables(variables):
+    configs = []
+    for name, (cls, value) in variables.items():
+        var = cls(name)
+        var.set_value(value)
+        configs.append(var)
+    return configs
+
+
+def render_wide_scene(graphics_pipe, parallel, clear_caches):
+    engine = core.GraphicsEngine()
+    engine.set_threading_model("")
+    buffer, tex = make_buffer(engine, graphics_pipe)
+
+    configs = set_variables({
+        "parallel-cull-traverse": (core.ConfigVariableBool, parallel),
+        "parallel-cull-min-children": (core.ConfigVariableInt, 16),
+        "parallel-cull-chunk-size": (core.ConfigVariableInt, 7),
+    })
+    try:
+        scene, camera = make_wide_scene(1000)
+        buffer.make_display_region().camera = camera
+
+        done = threading.Event()
+
+        def clear():
+            # render_frame() releases the GIL, so this runs while the cull
+            # workers are composing states.
+            while not done.is_set():
+                core.TransformState.garbage_collect()
+                core.RenderState.garbage_collect()
+                core.TransformState.clear_cache()
+                core.RenderState.clear_cache()
+
+        thread = None
+        if clear_caches:
+            thread = threading.Thread(target=clear)
+            thread.start()
+        try:
+            for frame in range(10):
+                engine.render_frame()
+        finally:
+            done.set()
+            if thread is not None:
+                thread.join()
+
+        engine.render_frame()
+        return tex.get_ram_image().get_data()
+    finally:
+        for var in configs:
+            var.clear_local_value()
+        engine.remove_window(buffer)
+
+
+def test_state_compose_parallel_cull(graphics_pipe):
+    serial = render_wide_scene(graphics_pipe, False, False)
+    parallel = render_wide_scene(graphics_pipe, True, True)
+    assert parallel == serial
+
+
+@pytest.mark.benchmark_test
+def test_state_compose_contention_benchmark(graphics_pipe):
+    # Prints the cull time of a wide scene traversed on all the workers, with
+    # and without the per-thread composition caches; run with -s.
+    frames = 20
+    timings = {}
+
+    for thread_cache in (False, True):
+        engine = core.GraphicsEngine()
+        engine.set_threading_model("")
+        buffer, tex = make_buffer(engine, graphics_pipe)
+
+        configs = set_variables({
+            "thread-composition-cache": (core.ConfigVariableBool, thread_cache),
+            "parallel-cull-traverse": (core.ConfigVariableBool, True),
+            "parallel-cull-min-children": (core.ConfigVariableInt, 16),
+        })
+        try:
+            scene, camera = make_wide_scene(20000)
+            buffer.make_display_region().camera = camera
+
+            engine.render_frame()
+            start = time.perf_counter()
+            for frame in range(frames):
+                engine.render_frame()
+            timings[thread_cache] = time.perf_counter() - start
+        finally:
+            for var in configs:
+                var.clear_local_value()
+            engine.remove_window(buffer)
+
+    print("\nrender_frame, 20000 cards culled in parallel:")
+    print("  shared cache only: %.3f ms/frame" % (timings[False] * 1000.0 / frames))
+    print("  per-thread caches: %.3f ms/frame" % (timings[True] * 1000.0 / frames))
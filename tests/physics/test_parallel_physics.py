@@ -0,0 +1,165 @@
+import pytest
+pytest.importorskip("panda3d.physics")
+
+from panda3d.core import NodePath, Point3
+from panda3d.physics import (
+    ActorNode,
+    AngularEulerIntegrator,
+    AngularVectorForce,
+    ForceNode,
+    LinearDistanceForce,
+    LinearEulerIntegrator,
+    LinearFrictionForce,
+    LinearJitterForce,
+    LinearSinkForce,
+    LinearVectorForce,
+    ParticleSystem,
+    PhysicalNode,
+    PhysicsManager,
+)
+
+
+def make_scene(parallel):
+    root = NodePath("root")
+    manager = PhysicsManager()
+    manager.set_parallel(parallel)
+    manager.attach_linear_integrator(LinearEulerIntegrator())
+    manager.attach_angular_integrator(AngularEulerIntegrator())
+
+    force_node = ForceNode("forces")
+    force_np = root.attach_new_node(force_node)
+    force_np.set_pos(1, 2, 3)
+    force_np.set_h(30)
+
+    gravity = LinearVectorForce(0, 0, -9.8)
+    force_node.add_force(gravity)
+    manager.add_linear_force(gravity)
+
+    spin = AngularVectorForce(10, 0, 5)
+    force_node.add_force(spin)
+    manager.add_angular_force(spin)
+
+    friction = LinearFrictionForce(0.2)
+    sink = LinearSinkForce(Point3(0, 0, 0), LinearDistanceForce.FT_ONE_OVER_R, 20.0, 5.0, True)
+    jitter = LinearJitterForce(2.0)
+    for force in (friction, sink, jitter):
+        force_node.add_force(force)
+
+    actors = []
+    for i in range(12):
+        actor = ActorNode("actor%d" % i)
+        actor_np = root.attach_new_node(actor)
+        actor_np.set_pos(i, -i, i * 0.5)
+        obj = actor.get_physics_object()
+        obj.set_mass(1.0 + i * 0.25)
+        obj.set_velocity(i * 0.3, 1.0, 4.0 - i)
+        if i % 3 == 0:
+            actor.get_physical(0).add_linear_force(friction)
+        if i % 4 == 1:
+            actor.get_physical(0).add_linear_force(sink)
+        if i == 7:
+            # This one draws from rand(), so it is integrated on the main
+            # thread, in order.
+            actor.get_physical(0).add_linear_force(jitter)
+        manager.attach_physical_node(actor)
+        actors.append((actor_np, obj))
+
+    system = ParticleSystem(50)
+    system.set_render_parent(root)
+    system.set_birth_rate(0.05)
+    system.set_litter_size(5)
+    system.add_linear_force(sink)
+    physical_node = PhysicalNode("particles")
+    physical_node.add_physical(system)
+    root.attach_new_node(physical_node)
+    manager.attach_physical(system)
+
+    return root, manager, actors, system
+
+
+def run_scene(parallel, frames=90, dt=1.0 / 60):
+    root, manager, actors, system = make_scene(parallel)
+    manager.init_random_seed()
+    for i in range(frames):
+        system.update(dt)
+        manager.do_physics(dt)
+
+    state = []
+    for actor_np, obj in actors:
+        state.append(tuple(actor_np.get_pos()))
+        state.append(tuple(obj.get_velocity()))
+        state.append(tuple(obj.get_orientation()))
+    system.render()
+    state.append(system.get_living_particles())
+    return state
+
+
+def test_parallel_matches_serial():
+    serial = run_scene(False)
+    parallel = run_scene(True)
+    assert parallel == serial
+
+
+def run_hierarchy(parallel, frames=60, dt=1.0 / 60):
+    # Some of the actors, and a force, ride along on the first actor, which
+    # moves ahead of them in each step.
+    root = NodePath("root")
+    manager = PhysicsManager()
+    manager.set_parallel(parallel)
+    manager.attach_linear_integrator(LinearEulerIntegrator())
+    manager.attach_angular_integrator(AngularEulerIntegrator())
+
+    force_np = root.attach_new_node(ForceNode("forces"))
+    gravity = LinearVectorForce(0, 0, -9.8)
+    force_np.node().add_force(gravity)
+    manager.add_linear_force(gravity)
+
+    ship = ActorNode("ship")
+    ship_np = root.attach_new_node(ship)
+    ship.get_physics_object().set_velocity(5, 2, 8)
+    manager.attach_physical_node(ship)
+
+    ship_force_np = ship_np.attach_new_node(ForceNode("ship_forces"))
+    ship_force_np.set_pos(0, 3, 0)
+    sink = LinearSinkForce(Point3(0, 0, 0), LinearDistanceForce.FT_ONE_OVER_R, 20.0, 5.0, True)
+    spin = AngularVectorForce(0, 4, 2)
+    ship_force_np.node().add_force(sink)
+    ship_force_np.node().add_force(spin)
+
+    actors = [(ship_np, ship.get_physics_object())]
+    for i in range(8):
+        actor = ActorNode("actor%d" % i)
+        parent = ship_np if i % 2 == 0 else root
+        actor_np = parent.attach_new_node(actor)
+        actor_np.set_pos(i + 1, -i, 0)
+        obj = actor.get_physics_object()
+        obj.set_velocity(0, i * 0.5, 1)
+        actor.get_physical(0).add_linear_force(sink)
+        if i % 3 == 0:
+            actor.get_physical(0).add_angular_force(spin)
+        manager.attach_physical_node(actor)
+        actors.append((actor_np, obj))
+
+    for i in range(frames):
+        manager.do_physics(dt)
+
+    state = []
+    for actor_np, obj in actors:
+        state.append(tuple(actor_np.get_pos(root)))
+        state.append(tuple(obj.get_velocity()))
+        state.append(tuple(obj.get_orientation()))
+    return state
+
+
+def test_parallel_matches_serial_hierarchy():
+    serial = run_hierarchy(False)
+    parallel = run_hierarchy(True)
+    assert parallel == serial
+
+
+def test_parallel_property():
+    manager = PhysicsManager()
+    manager.parallel = True
+    assert manager.get_parallel()
+    manager.set_parallel(False)
+    assert not manager.parallel
@@ -0,0 +1,132 @@
+from panda3d.core import JobSystem
+import threading
+import pytest
+
+
+def run(count, grain_size=1):
+    js = JobSystem.get_global_ptr()
+    ranges = []
+    js.parallel_process(count, lambda begin, end: ranges.append((begin, end)), grain_size)
+    return sorted(ranges)
+
+
+def assert_covers(ranges, count, grain_size=1):
+    # The ranges must be non-empty, non-overlapping and cover [0, count).
+    pos = 0
+    for begin, end in ranges:
+        assert begin == pos
+        assert end > begin
+        pos = end
+    assert pos == count
+
+    if JobSystem.get_global_ptr().num_workers > 0 and count > grain_size:
+        for begin, end in ranges:
+            assert begin % grain_size == 0
+            assert end - begin <= grain_size
+
+
+def test_job_system_global_ptr():
+    js = JobSystem.get_global_ptr()
+    assert js is not None
+    assert js.num_workers >= 0
+    assert JobSystem.get_global_ptr().this == js.this
+
+
+def test_job_system_global_ptr_threads():
+    ptrs = []
+
+    def get_ptr():
+        ptrs.append(JobSystem.get_global_ptr().this)
+
+    threads = [threading.Thread(target=get_ptr) for i in range(8)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+    assert len(set(ptrs)) == 1
+
+
+@pytest.mark.parametrize("count", [0, 1, 2, 7, 100, 1001])
+@pytest.mark.parametrize("grain_size", [1, 3, 64, 5000])
+def test_job_system_coverage(count, grain_size):
+    assert_covers(run(count, grain_size), count, grain_size)
+
+
+def test_job_system_zero():
+    # Never called for an empty range.
+    assert run(0) == []
+    assert run(0, 16) == []
+
+
+def test_job_system_one():
+    assert run(1) == [(0, 1)]
+    assert run(1, 16) == [(0, 1)]
+
+
+def test_job_system_grain_zero():
+    # A grain size of 0 is treated as 1.
+    assert_covers(run(50, 0), 50, 1)
+
+
+def test_job_system_grain_exact():
+    # A count that is an exact multiple of the grain size, and one that
+    # leaves a partial chunk at the end.
+    assert_covers(run(64, 16), 64, 16)
+    assert_covers(run(65, 16), 65, 16)
+
+
+def test_job_system_nested():
+    js = JobSystem.get_global_ptr()
+    counts = [0] * 20
+    lock = threading.Lock()
+
+    def inner(i):
+        def func(begin, end):
+            with lock:
+                counts[i] += end - begin
+        return func
+
+    def outer(begin, end):
+        for i in range(begin, end):
+            js.parallel_process(30, inner(i), 4)
+
+    js.parallel_process(len(counts), outer)
+    assert counts == [30] * len(counts)
+
+
+def test_job_system_threads():
+    # Several threads handing work to the JobSystem at the same time.
+    results = {}
+
+    def work(n):
+        count = 500 + n
+        results[n] = (count, run(count, 7))
+
+    threads = [threading.Thread(target=work, args=(n,)) for n in range(6)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+    assert len(results) == 6
+    for count, ranges in results.values():
+        assert_covers(ranges, count, 7)
+
+
+def test_job_system_exception():
+    js = JobSystem.get_global_ptr()
+
+    def func(begin, end):
+        raise ValueError("job failed")
+
+    with pytest.raises(ValueError):
+        js.parallel_process(100, func, 10)
+
+    # The JobSystem is still usable afterwards.
+    assert_covers(run(100, 10), 100, 10)
+
+
+def test_job_system_not_callable():
+    with pytest.raises(TypeError):
+        JobSystem.get_global_ptr().parallel_process(10, None)